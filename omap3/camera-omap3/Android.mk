@@ -19,12 +19,15 @@ LOCAL_SHARED_LIBRARIES:= \
     libutils \
     libcutils \
     libcamera_client \
-    libsurfaceflinger_client
+    libsurfaceflinger_client \
+    libtiutils
 
 LOCAL_C_INCLUDES += \
     frameworks/base/include/camera \
     frameworks/base/include/binder \
-    hardware/ti/omap3/liboverlay
+    hardware/ti/omap3/liboverlay \
+    frameworks/base/include/utils \
+    $(LOCAL_PATH)/../libtiutils
 
 LOCAL_CFLAGS += -fno-short-enums 
 
@@ -130,6 +130,7 @@ CameraHal::CameraHal(int cameraId)
     isStart_FW3A_CAF = false;
     isStart_FW3A_AEWB = false;
     isStart_VPP = false;
+    mDspJobs = 0;
     isStart_JPEG = false;
     mPictureHeap = NULL;
     mIPPInitAlgoState = false;
@@ -2153,23 +2154,20 @@ int CameraHal::ICapturePerform(){
     } else{
         snapshot_buffer = data->ptr;
 
-        scale_init(image_width, image_height, preview_width, preview_height, PIX_YUV422I, PIX_YUV422I);
-
-        err = scale_process(yuv_buffer, image_width, image_height,
+        err = scaleFrame(yuv_buffer, image_width, image_height,
                              snapshot_buffer, preview_width, preview_height, 0, PIX_YUV422I, zoom_step[/*mZoomTargetIdx*/ 0], 0, 0, image_width, image_height);
 
 #ifdef DEBUG_LOG
        PPM("After vpp downscales:");
        if( err )
-            LOGE("scale_process() failed");
+            LOGE("scaleFrame() failed");
        else
-            LOGD("scale_process() OK");
+            LOGD("scaleFrame() OK");
 #endif
 
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
         PPM("Shot to Snapshot", &ppm_receiveCmdToTakePicture);
 #endif
-        scale_deinit();
 
         queueToOverlay(lastOverlayBufferDQ);
         dequeueFromOverlay();
@@ -2297,13 +2295,18 @@ int CameraHal::ICapturePerform(){
 
         PPM("BEFORE JPEG Encode Image");
         LOGE(" outbuffer = 0x%x, jpegSize = %d, yuv_buffer = 0x%x, yuv_len = %d, image_width = %d, image_height = %d, quality = %d, mippMode =%d", outBuffer , jpegSize, yuv_buffer, yuv_len, image_width, image_height, quality,mippMode);
-        jpegEncoder->encodeImage((uint8_t *)outBuffer , jpegSize, yuv_buffer, yuv_len,
+        android_atomic_inc(&mDspJobs);
+        ///A single shot, there is nothing to overlap the encoding with
+        if ( jpegEncoder->encodeImage((uint8_t *)outBuffer , jpegSize, yuv_buffer, yuv_len,
                 image_width, image_height, quality, exif_buf, jpegFormat, DEFAULT_THUMB_WIDTH, DEFAULT_THUMB_HEIGHT, image_width, image_height,
-                image_rotation, image_zoom, 0, 0, image_width, image_height);
+                image_rotation, image_zoom, 0, 0, image_width, image_height) ) {
+            mJPEGPictureMemBase = new MemoryBase(mJPEGPictureHeap, 128, jpegEncoder->jpegSize);
+        } else {
+            LOGE("JPEG Encoding failed");
+        }
+        android_atomic_dec(&mDspJobs);
         PPM("AFTER JPEG Encode Image");
 
-        mJPEGPictureMemBase = new MemoryBase(mJPEGPictureHeap, 128, jpegEncoder->jpegSize);
-
     if ( msgTypeEnabled(CAMERA_MSG_COMPRESSED_IMAGE) ){
         mDataCb(CAMERA_MSG_COMPRESSED_IMAGE,mJPEGPictureMemBase,mCallbackCookie);
     }
@@ -2453,14 +2456,7 @@ void CameraHal::snapshotThread()
 
                 LOGE("Snapshot buffer 0x%x, yuv_buffer = 0x%x, zoomTarget = %5.2f", ( unsigned int ) snapshot_buffer, ( unsigned int ) yuv_buffer, ZoomTarget);
 
-                status = scale_init(image_width, image_height, preview_width, preview_height, PIX_YUV422I, PIX_YUV422I);
-
-                if ( status < 0 ) {
-                    LOGE("VPP init failed");
-                    goto EXIT;
-                }
-
-                status = scale_process(yuv_buffer, image_width, image_height,
+                status = scaleFrame(yuv_buffer, image_width, image_height,
                          snapshot_buffer, preview_width, preview_height, 0, PIX_YUV422I, zoom_step[0], crop_top, crop_left, crop_width, crop_height);
 
 #ifdef DEBUG_LOG
@@ -2468,9 +2464,9 @@ void CameraHal::snapshotThread()
                PPM("After vpp downscales:");
 
                if( status )
-                   LOGE("scale_process() failed");
+                   LOGE("scaleFrame() failed");
                else
-                   LOGD("scale_process() OK");
+                   LOGD("scaleFrame() OK");
 
 #endif
 
@@ -2480,13 +2476,9 @@ void CameraHal::snapshotThread()
 
 #endif
 
-                scale_deinit();
-
                 queueToOverlay(lastOverlayBufferDQ);
                 dequeueFromOverlay();
 
-EXIT:
-
                 write(snapshotReadyPipe[1], &snapshotReadyMessage, sizeof(snapshotReadyMessage));
           } else if (snapshotMessage[0] == SNAPSHOT_THREAD_START_GEN) {
 
@@ -2659,8 +2651,6 @@ void CameraHal::procThread()
     unsigned int crop_top, crop_left, crop_width, crop_height;
     double image_zoom;
     bool ipp_to_enable;
-    sp<MemoryHeapBase> JPEGPictureHeap;
-    sp<MemoryBase> JPEGPictureMemBase;
     data_callback RawPictureCallback;
     data_callback JpegPictureCallback;
     void *yuv_buffer, *outBuffer, *PictureCallbackCookie;
@@ -2670,6 +2660,13 @@ void CameraHal::procThread()
 
     exif_buffer *exif_buf;
 
+#endif
+
+#if JPEG
+
+    ProcShot *shot;
+    struct pollfd procPending;
+
 #endif
 
     unsigned short EdgeEnhancementStrength, WeakEdgeThreshold, StrongEdgeThreshold,
@@ -2690,7 +2687,14 @@ void CameraHal::procThread()
     mJPEGLength  = MAX_THUMB_WIDTH*MAX_THUMB_HEIGHT + PICTURE_WIDTH*PICTURE_HEIGHT + ((2*PAGE) - 1);
     mJPEGLength &= ~((2*PAGE) - 1);
     mJPEGLength  += 2*PAGE;
-    JPEGPictureHeap = new MemoryHeapBase(mJPEGLength);
+
+#if JPEG
+
+    mProcFirstShot = 0;
+    mProcShotCount = 0;
+    mProcShots[0].heap = new MemoryHeapBase(mJPEGLength);
+
+#endif
 
     while(1){
 
@@ -2767,20 +2771,32 @@ void CameraHal::procThread()
 
 #endif
 
-                LOGD("JPEGPictureHeap->getStrongCount() = %d, base = 0x%x", JPEGPictureHeap->getStrongCount(), ( unsigned int ) JPEGPictureHeap->getBase());
                 jpegSize = mJPEGLength;
 
-                if(JPEGPictureHeap->getStrongCount() > 1 )
+#if JPEG
+
+                ///The encoder is full, hand the oldest shot to the app first
+                if ( JpegEncoder::PIPELINE_DEPTH == mProcShotCount ) {
+                    procDeliverShot();
+                }
+
+                shot = &mProcShots[(mProcFirstShot + mProcShotCount) % JpegEncoder::PIPELINE_DEPTH];
+
+                if( ( NULL == shot->heap.get() ) || ( shot->heap->getStrongCount() > 1 ) )
                 {
-                    JPEGPictureHeap.clear();
-                    JPEGPictureHeap = new MemoryHeapBase(jpegSize);
+                    shot->heap.clear();
+                    shot->heap = new MemoryHeapBase(jpegSize);
                 }
 
-                base = (unsigned long) JPEGPictureHeap->getBase();
+                LOGD("JPEGPictureHeap->getStrongCount() = %d, base = 0x%x", shot->heap->getStrongCount(), ( unsigned int ) shot->heap->getBase());
+
+                base = (unsigned long) shot->heap->getBase();
                 base = (base + 0xfff) & 0xfffff000;
-                offset = base - (unsigned long) JPEGPictureHeap->getBase();
+                offset = base - (unsigned long) shot->heap->getBase();
                 outBuffer = (void *) base;
 
+#endif
+
                 pixelFormat = PIX_YUV422I;
 
                 input_buffer = yuv_buffer;
@@ -2805,6 +2821,15 @@ void CameraHal::procThread()
 
                if( (ippMode == IPP_CromaSupression_Mode) || (ippMode == IPP_EdgeEnhancement_Mode) ){
 
+#if JPEG
+
+                    ///The IPP buffers may be the input of the shots still encoding
+                    if( ipp_to_enable || !(pIPP.ippconfig.isINPLACE) ) {
+                        procDrainShots();
+                    }
+
+#endif
+
                     if(ipp_to_enable) {
 
 #ifdef DEBUG_LOG
@@ -2885,47 +2910,38 @@ void CameraHal::procThread()
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
                 PPM("BEFORE JPEG Encode Image");
 #endif
-                if (!( jpegEncoder->encodeImage((uint8_t *)outBuffer , jpegSize, input_buffer, input_length,
+                shot->offset = offset;
+                shot->yuv_buffer = yuv_buffer;
+                shot->yuv_offset = yuv_offset;
+                shot->rotation = image_rotation;
+                shot->exif_buf = exif_buf;
+                shot->callback = JpegPictureCallback;
+                shot->cookie = PictureCallbackCookie;
+                shot->queued = jpegEncoder->queueImage((uint8_t *)outBuffer , jpegSize, input_buffer, input_length,
                                              capture_width, capture_height, jpegQuality, exif_buf, pixelFormat, thumb_width, thumb_height, image_width, image_height,
-                                             image_rotation, image_zoom, crop_top, crop_left, crop_width, crop_height)))
-                {
-                    err = -1;
+                                             image_rotation, image_zoom, crop_top, crop_left, crop_width, crop_height);
+                mProcShotCount++;
+
+                if ( !shot->queued ) {
                     LOGE("JPEG Encoding failed");
                 }
-#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
-                PPM("AFTER JPEG Encode Image");
-                if ( 0 != image_rotation )
-                    PPM("Shot to JPEG with %d deg rotation", &ppm_receiveCmdToTakePicture, image_rotation);
-                else
-                    PPM("Shot to JPEG", &ppm_receiveCmdToTakePicture);
-#endif
-
-                JPEGPictureMemBase = new MemoryBase(JPEGPictureHeap, offset, jpegEncoder->jpegSize);
-#endif
-                /* Disable the jpeg message enabled check for now */
-                if(/*JpegPictureCallback*/ true) {
 
-#if JPEG
-
-                    if ( mBurstShots > 1 ){
-                        JpegPictureCallback(CAMERA_MSG_BURST_IMAGE, JPEGPictureMemBase, PictureCallbackCookie);
-                    }
-                    else {
-                        JpegPictureCallback(CAMERA_MSG_COMPRESSED_IMAGE, JPEGPictureMemBase, PictureCallbackCookie);
-                    }
-#else
-
-                    JpegPictureCallback(CAMERA_MSG_COMPRESSED_IMAGE, NULL, PictureCallbackCookie);
-
-#endif
+                ///While the shot encodes, the next one of the burst goes through
+                ///IPP and is queued behind it. The last one is waited for.
+                procPending.fd = procPipe[0];
+                procPending.events = POLLIN;
+                procPending.revents = 0;
+                if ( !shot->queued || ( 0 >= poll(&procPending, 1, 0) ) ) {
+                    procDrainShots();
 
+                    // Release constraint to DSP OPP by setting lowest Hz
+                    SetDSPHz(DSP3630_HZ_MIN);
                 }
 
-#ifdef DEBUG_LOG
-
-                LOGD("jpegEncoder->jpegSize=%d jpegSize=%d", jpegEncoder->jpegSize, jpegSize);
+#else
 
-#endif
+                /* Disable the jpeg message enabled check for now */
+                JpegPictureCallback(CAMERA_MSG_COMPRESSED_IMAGE, NULL, PictureCallbackCookie);
 
 #ifdef HARDWARE_OMX
 
@@ -2934,25 +2950,87 @@ void CameraHal::procThread()
 
 #endif
 
-                JPEGPictureMemBase.clear();
                 free((void *) ( ((unsigned int) yuv_buffer) - yuv_offset) );
 
                 // Release constraint to DSP OPP by setting lowest Hz
                 SetDSPHz(DSP3630_HZ_MIN);
 
+#endif
+
             } else if( procMessage[0] == PROC_THREAD_EXIT ) {
                 LOGD("PROC_THREAD_EXIT_RECEIVED");
-                JPEGPictureHeap.clear();
                 break;
             }
         }
     }
 
-    JPEGPictureHeap.clear();
+#if JPEG
+
+    procDrainShots();
+
+    for ( int i = 0 ; i < JpegEncoder::PIPELINE_DEPTH ; i++ ) {
+        mProcShots[i].heap.clear();
+    }
+
+#endif
 
     LOG_FUNCTION_NAME_EXIT
 }
 
+#if JPEG
+
+///Waits for the oldest shot queued by procThread and hands its JPEG to the app
+void CameraHal::procDeliverShot()
+{
+    ProcShot *shot = &mProcShots[mProcFirstShot];
+    sp<MemoryBase> JPEGPictureMemBase;
+
+    if ( shot->queued && jpegEncoder->dequeueImage(NULL) ) {
+        JPEGPictureMemBase = new MemoryBase(shot->heap, shot->offset, jpegEncoder->jpegSize);
+    } else if ( shot->queued ) {
+        LOGE("JPEG Encoding failed");
+    }
+
+#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
+    PPM("AFTER JPEG Encode Image");
+    if ( 0 != shot->rotation )
+        PPM("Shot to JPEG with %d deg rotation", &ppm_receiveCmdToTakePicture, shot->rotation);
+    else
+        PPM("Shot to JPEG", &ppm_receiveCmdToTakePicture);
+#endif
+
+    if ( mBurstShots > 1 ){
+        shot->callback(CAMERA_MSG_BURST_IMAGE, JPEGPictureMemBase, shot->cookie);
+    }
+    else {
+        shot->callback(CAMERA_MSG_COMPRESSED_IMAGE, JPEGPictureMemBase, shot->cookie);
+    }
+
+#ifdef DEBUG_LOG
+
+    LOGD("jpegEncoder->jpegSize=%d", jpegEncoder->jpegSize);
+
+#endif
+
+    if((shot->exif_buf != NULL) && (shot->exif_buf->data != NULL))
+        exif_buf_free(shot->exif_buf);
+
+    JPEGPictureMemBase.clear();
+    free((void *) ( ((unsigned int) shot->yuv_buffer) - shot->yuv_offset) );
+
+    mProcFirstShot = ( mProcFirstShot + 1 ) % JpegEncoder::PIPELINE_DEPTH;
+    mProcShotCount--;
+}
+
+void CameraHal::procDrainShots()
+{
+    while ( 0 < mProcShotCount ) {
+        procDeliverShot();
+    }
+}
+
+#endif
+
 #ifdef ICAP_EXPERIMENTAL
 
 int CameraHal::allocatePictureBuffer(size_t length, int burstCount)
@@ -37,6 +37,7 @@
 #include <sys/stat.h>
 #include <utils/Log.h>
 #include <utils/threads.h>
+#include <cutils/atomic.h>
 #include <linux/videodev2.h>
 #include "binder/MemoryBase.h"
 #include "binder/MemoryHeapBase.h"
@@ -46,6 +47,7 @@
 #include "MessageQueue.h"
 #include "overlay_common.h"
 #include "CameraHalParams.h"
+#include "YuvScaler.h"
 
 #ifdef HARDWARE_OMX
 #include <JpegEncoderEXIF.h>
@@ -124,6 +126,11 @@ extern "C" {
 
 #define PIX_YUV422I 0
 #define PIX_YUV420P 1
+
+///Largest output scaled on the CPU while the DSP is free. Below it, loading
+///the VPP node costs more than scaling on the ARM
+#define SCALE_CPU_MAX_PIXELS ( 640 * 480 )
+
 #define KEY_ROTATION_TYPE       "rotation-type"
 #define ROTATION_PHYSICAL       0
 #define ROTATION_EXIF           1
@@ -381,6 +388,14 @@ public:
     void previewThread();
     bool validateSize(size_t width, size_t height, const supported_resolution *supRes, size_t count);
     void procThread();
+
+#if JPEG
+
+    void procDeliverShot();
+    void procDrainShots();
+
+#endif
+
     void shutterThread();
     void rawThread();
     void snapshotThread();
@@ -422,6 +437,7 @@ public:
 
     int CorrectPreview();
     int ZoomPerform(float zoom);
+    int scaleFrame(void* inBuffer, int inWidth, int inHeight, void* outBuffer, int outWidth, int outHeight, int rotation, int fmt, float zoom, int crop_top, int crop_left, int crop_width, int crop_height);
     void nextPreview();
     void queueToOverlay(int index);
     int dequeueFromOverlay();
@@ -474,6 +490,9 @@ public:
     int isStart_FW3A_CAF;
     int isStart_FW3A_AEWB;
     int isStart_VPP;
+    ///DSP jobs in flight, the snapshot goes to the CPU scaler while there are some
+    volatile int32_t mDspJobs;
+    YuvScaler mCpuScaler;
     int isStart_JPEG;
     int FW3A_AF_TimeOut;
 
@@ -568,6 +587,25 @@ public:
 
 #ifdef HARDWARE_OMX
     JpegEncoder*    jpegEncoder;
+
+    ///Burst shot queued to jpegEncoder by procThread, with what its callback needs
+    typedef struct
+    {
+        sp<MemoryHeapBase> heap;
+        unsigned int offset;
+        void *yuv_buffer;
+        unsigned int yuv_offset;
+        unsigned int rotation;
+        exif_buffer *exif_buf;
+        data_callback callback;
+        void *cookie;
+        bool queued;
+    } ProcShot;
+
+    ///Shots in queueing order, used by procThread only
+    ProcShot mProcShots[JpegEncoder::PIPELINE_DEPTH];
+    int mProcFirstShot;
+    int mProcShotCount;
 #endif    
     
 #ifdef FW3A
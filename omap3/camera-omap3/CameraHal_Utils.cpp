@@ -1322,6 +1322,63 @@ int CameraHal::ZoomPerform(float zoom)
     return 0;
 }
 
+/* Same arguments as scale_process(), input in YUV422I.
+ * The DSP VPP node scales large outputs when it is idle. The CPU takes the
+ * small ones, every output while the DSP encodes a JPEG, and the outputs the
+ * VPP node could not be loaded for. Only the DSP rotates.
+ */
+int CameraHal::scaleFrame(void* inBuffer, int inWidth, int inHeight, void* outBuffer, int outWidth, int outHeight, int rotation, int fmt, float zoom, int crop_top, int crop_left, int crop_width, int crop_height)
+{
+    bool small = ( outWidth * outHeight <= SCALE_CPU_MAX_PIXELS );
+    status_t cpuRet;
+    int ret = -1;
+
+    LOG_FUNCTION_NAME
+
+#ifdef HARDWARE_OMX
+
+    if ( ( 0 != rotation ) || ( !small && ( 0 == android_atomic_acquire_load(&mDspJobs) ) ) ) {
+
+        if ( scale_init(inWidth, inHeight, outWidth, outHeight, PIX_YUV422I, fmt) >= 0 ) {
+            android_atomic_inc(&mDspJobs);
+            ret = scale_process(inBuffer, inWidth, inHeight, outBuffer, outWidth, outHeight, rotation, fmt, zoom, crop_top, crop_left, crop_width, crop_height);
+            android_atomic_dec(&mDspJobs);
+            scale_deinit();
+            goto exit;
+        }
+
+        LOGE("VPP init failed");
+
+        if ( 0 != rotation ) {
+            goto exit;
+        }
+    }
+
+#endif
+
+    if ( 0 != rotation ) {
+        LOGE("CPU scaler does not rotate");
+        goto exit;
+    }
+
+    /* The 4-tap filter on previews, bilinear keeps large fallbacks short */
+    cpuRet = mCpuScaler.process(inBuffer, inWidth, inHeight, YuvScaler::FORMAT_YUV422I,
+                                outBuffer, outWidth, outHeight, fmt,
+                                crop_top, crop_left, crop_width, crop_height, zoom,
+                                small ? YuvScaler::FILTER_POLYPHASE : YuvScaler::FILTER_BILINEAR);
+    if ( NO_ERROR != cpuRet ) {
+        LOGE("CPU scaling failed %d", cpuRet);
+        goto exit;
+    }
+
+    ret = 0;
+
+exit:
+    LOG_FUNCTION_NAME_EXIT
+
+    return ret;
+}
+
 void CameraHal::SetDSPHz(unsigned int Hz)
 {
     char command[100];
@@ -33,33 +33,39 @@
 */
 
 #include "JpegEncoder.h"
+#include <time.h>
 #include <utils/Log.h>
 #include <OMX_JpegEnc_CustomCmd.h>
 
 #define PRINTF LOGD
 
 #define JPEG_ENCODER_DUMP_INPUT_AND_OUTPUT 0
-#define OPTIMIZE 1
 
 #if JPEG_ENCODER_DUMP_INPUT_AND_OUTPUT
 	int eOutputCount = 0;
 	int eInputCount = 0;
 #endif
 
+static int64_t JpegEncoderTimeUs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
 OMX_ERRORTYPE OMX_JPEGE_FillBufferDone (OMX_HANDLETYPE hComponent, OMX_PTR ptr, OMX_BUFFERHEADERTYPE* pBuffHead)
 {
     PRINTF("\nOMX_FillBufferDone: pBuffHead = %p, pBuffer = %p, n    FilledLen = %ld \n", pBuffHead, pBuffHead->pBuffer, pBuffHead->nFilledLen);
-    ((JpegEncoder *)ptr)->FillBufferDone(pBuffHead->pBuffer,  pBuffHead->nFilledLen);
+    ((JpegEncoder *)ptr)->FillBufferDone(pBuffHead);
     return OMX_ErrorNone;
 }
 
 
 OMX_ERRORTYPE OMX_JPEGE_EmptyBufferDone(OMX_HANDLETYPE hComponent, OMX_PTR ptr, OMX_BUFFERHEADERTYPE* pBuffer)
 {
-    JpegEncoder * ImgEnc = (JpegEncoder *)ptr;
-    ImgEnc->iLastState = ImgEnc->iState;
-    ImgEnc->iState = JpegEncoder::STATE_EMPTY_BUFFER_DONE_CALLED;
-    sem_post(ImgEnc->semaphore) ;
+    ((JpegEncoder *)ptr)->EmptyBufferDone(pBuffer);
     return OMX_ErrorNone;
 }
 
@@ -76,32 +82,59 @@ OMX_ERRORTYPE OMX_JPEGE_EventHandler(OMX_HANDLETYPE hComponent,
 
 JpegEncoder::JpegEncoder()
 {
+    pthread_mutexattr_t attr;
+
+    jpegSize = 0;
+    memset(&timing, 0, sizeof(timing));
     thumb_width = 0;
     thumb_height = 0;
     mexif_buf = NULL;
-    pInBuffHead = NULL;
-    pOutBuffHead = NULL;
+    memset(pInBuffHead, 0, sizeof(pInBuffHead));
+    memset(pOutBuffHead, 0, sizeof(pOutBuffHead));
+    memset(mShots, 0, sizeof(mShots));
+    mFirstShot = 0;
+    mShotCount = 0;
+    mShotNumber = 0;
+    iState = STATE_LOADED;
+    iLastState = STATE_LOADED;
     semaphore = NULL;
     pOMXHandle = NULL;
     semaphore = (sem_t*)malloc(sizeof(sem_t)) ;
     sem_init(semaphore, 0x00, 0x00);
+
+    ///Recursive, as components are allowed to call back from within
+    ///EmptyThisBuffer() and FillThisBuffer()
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    pthread_cond_init(&mShotDone, NULL);
+
+    mExit = false;
+    pthread_create(&mStartThread, NULL, StartThread, this);
 }
 
 JpegEncoder::~JpegEncoder()
 {
-    OMX_ERRORTYPE eError = OMX_ErrorNone;
-#if OPTIMIZE
-    if( ( iLastState || iState ) && ( NULL != pOMXHandle ) ){
-        eError = OMX_SendCommand(pOMXHandle,OMX_CommandStateSet, OMX_StateIdle, NULL);
-        if ( eError != OMX_ErrorNone ) {
-            PRINTF("\nError from SendCommand-Idle(nStop) State function\n");
-            iState = STATE_ERROR;
-            sem_post(semaphore) ;
+    ///Shots still in flight use buffers of the HAL, let them complete
+    pthread_mutex_lock(&mLock);
+    for ( int i = 0 ; i < mShotCount ; i++ ) {
+        JpegEncoderShot *shot = &mShots[(mFirstShot + i) % PIPELINE_DEPTH];
+        while ( !shot->failed && ( !shot->inputDone || !shot->outputDone ) ) {
+            pthread_cond_wait(&mShotDone, &mLock);
         }
-
-        Run();
     }
-#endif    
+    mShotCount = 0;
+    mExit = true;
+    pthread_cond_broadcast(&mShotDone);
+    pthread_mutex_unlock(&mLock);
+
+    pthread_join(mStartThread, NULL);
+
+    StopSession();
+
+    pthread_cond_destroy(&mShotDone);
+    pthread_mutex_destroy(&mLock);
     sem_destroy(semaphore);
     if (semaphore != NULL) {
         free(semaphore);
@@ -109,30 +142,70 @@ JpegEncoder::~JpegEncoder()
     }
 }
 
-void JpegEncoder::FillBufferDone(OMX_U8* pBuffer, OMX_U32 size)
+void JpegEncoder::FillBufferDone(OMX_BUFFERHEADERTYPE* pBuffHead)
 {
+    pthread_mutex_lock(&mLock);
+
+    for ( int i = 0 ; i < PIPELINE_DEPTH ; i++ ) {
+        JpegEncoderShot *shot = &mShots[i];
+
+        if ( ( pOutBuffHead[i] != pBuffHead ) || !shot->started || shot->outputDone ) {
+            continue;
+        }
 
 #if JPEG_ENCODER_DUMP_INPUT_AND_OUTPUT
-    
-    char path[50];
-    snprintf(path, sizeof(path), "/temp/JEO_%d.jpg", eOutputCount);
 
-    PRINTF("\nrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrr");
-    
-    SkFILEWStream tempFile(path);
-    if (tempFile.write(pBuffer, size) == false)
-        PRINTF("\nWriting to %s failed\n", path);
-    else
-        PRINTF("\nWriting to %s succeeded\n", path);
+        char path[50];
+        snprintf(path, sizeof(path), "/temp/JEO_%d.jpg", eOutputCount);
 
-    eOutputCount++;
-    PRINTF("\nrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrr");
+        PRINTF("\nrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrr");
+
+        SkFILEWStream tempFile(path);
+        if (tempFile.write(pBuffHead->pBuffer, pBuffHead->nFilledLen) == false)
+            PRINTF("\nWriting to %s failed\n", path);
+        else
+            PRINTF("\nWriting to %s succeeded\n", path);
+
+        eOutputCount++;
+        PRINTF("\nrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrr");
 #endif
 
-    iLastState = iState;
-    iState = STATE_FILL_BUFFER_DONE_CALLED;
-    jpegSize = size;
-   // sem_post(semaphore) ;
+        shot->size = pBuffHead->nFilledLen;
+        shot->outputDone = true;
+        if ( shot->inputDone ) {
+            shot->endTime = JpegEncoderTimeUs();
+        }
+
+        ///The encoder is free, this also wakes up the start thread for the
+        ///shot queued behind this one
+        pthread_cond_broadcast(&mShotDone);
+        break;
+    }
+
+    pthread_mutex_unlock(&mLock);
+}
+
+void JpegEncoder::EmptyBufferDone(OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    pthread_mutex_lock(&mLock);
+
+    for ( int i = 0 ; i < PIPELINE_DEPTH ; i++ ) {
+        JpegEncoderShot *shot = &mShots[i];
+
+        if ( ( pInBuffHead[i] != pBuffHead ) || !shot->started || shot->inputDone ) {
+            continue;
+        }
+
+        shot->inputDone = true;
+        if ( shot->outputDone ) {
+            shot->endTime = JpegEncoderTimeUs();
+        }
+
+        pthread_cond_broadcast(&mShotDone);
+        break;
+    }
+
+    pthread_mutex_unlock(&mLock);
 }
 
 
@@ -175,9 +248,14 @@ void JpegEncoder::EventHandler(OMX_HANDLETYPE hComponent,
 
         case OMX_EventError:
             //PRINTF ("\n\n\nOMX Component  reported an Error!!!!\n\n\n");
+            ///Invalidate the component before waking up the HAL, which
+            ///frees the buffers of the failed shots
+            OMX_SendCommand(hComponent, OMX_CommandStateSet, OMX_StateInvalid, NULL);
+            pthread_mutex_lock(&mLock);
             iLastState = iState;
             iState = STATE_ERROR;
-            OMX_SendCommand(hComponent, OMX_CommandStateSet, OMX_StateInvalid, NULL);
+            FailShots();
+            pthread_mutex_unlock(&mLock);
             sem_post(semaphore) ;
             break;
 
@@ -320,40 +398,60 @@ EXIT:
     return eError;
 }
 
-bool JpegEncoder::StartFromLoadedState()
+
+bool JpegEncoder::sessionMatches(int outBuffSize, int inBuffSize, int width, int height, int quality, int isPixelFmt420p,
+        int th_width, int th_height, int outWidth, int outHeight, int rotation)
+{
+    return (
+        (pOMXHandle != NULL) &&
+        (iState == STATE_EXECUTING) &&
+        (mOutWidth == outWidth) &&
+        (mOutHeight == outHeight) &&
+        (mInWidth == width) &&
+        (mInHeight == height) &&
+        (mQuality == quality) &&
+        (mIsPixelFmt420p == isPixelFmt420p) &&
+        (thumb_width == th_width) &&
+        (thumb_height == th_height) &&
+        (mRotation == rotation) && //TODO: could optimize by setting the rotation dynamically, but it complicates the code
+        (inBuffSize <= mInBuffSize) &&
+        (outBuffSize <= mOutBuffSize)
+    );
+}
+
+bool JpegEncoder::WaitForState(JPEGENC_State state)
+{
+    if (sem_wait(semaphore))
+    {
+        PRINTF("\nsem_wait returned the error");
+        return false;
+    }
+
+    return ( iState == state );
+}
+
+bool JpegEncoder::StartSession(void *outputBuffer, void *inputBuffer)
 {
 
-    int nRetval;
     int nIndex1;
     int nIndex2;
-    int bitsPerPixel;
-    int nMultFactor = 0;
-    int nHeightNew, nWidthNew;
     char strTIJpegEnc[] = "OMX.TI.JPEG.encoder";
     char strQFactor[] = "OMX.TI.JPEG.encoder.Config.QFactor";
 	char strConversionFlag[] = "OMX.TI.JPEG.encoder.Config.ConversionFlag";
-	char strPPLibEnable[] = "OMX.TI.JPEG.encoder.Config.PPLibEnable";
 
     OMX_S32 nCompId = 300;
     OMX_PORT_PARAM_TYPE PortType;
     OMX_ERRORTYPE eError = OMX_ErrorNone;
     OMX_IMAGE_PARAM_QFACTORTYPE QfactorType;
 	JPE_CONVERSION_FLAG_TYPE nConversionFlag = JPE_CONV_NONE;
-	OMX_BOOL bPPLibEnable;
     OMX_INDEXTYPE nCustomIndex = OMX_IndexMax;
     OMX_CALLBACKTYPE JPEGCallBack ={OMX_JPEGE_EventHandler, OMX_JPEGE_EmptyBufferDone, OMX_JPEGE_FillBufferDone};
 
-    if (pOMXHandle) { // we should not have more than one instance of JPEG encoder open
-
-        eError = TIOMX_Deinit();
-        if ( eError != OMX_ErrorNone ) {
-            PRINTF("\nError returned by TIOMX_Deinit()\n");
-        }
-        eError = TIOMX_FreeHandle(pOMXHandle);
-        if ( (eError != OMX_ErrorNone) )    {
-            PRINTF("\nError in Free Handle function\n");
-        }
-    }
+    ///Drop the completions of the previous session, an error may have been
+    ///posted without anybody waiting for it
+    while ( 0 == sem_trywait(semaphore) ) ;
+    iLastState = STATE_LOADED;
+    iState = STATE_LOADED;
 
     eError = TIOMX_Init();
     if ( eError != OMX_ErrorNone ) {
@@ -367,6 +465,8 @@ bool JpegEncoder::StartFromLoadedState()
     eError = TIOMX_GetHandle(&pOMXHandle, strTIJpegEnc, (void *)this, &JPEGCallBack);
     if ( (eError != OMX_ErrorNone) ||  (pOMXHandle == NULL) ) {
         PRINTF ("Error in Get Handle function\n");
+        pOMXHandle = NULL;
+        TIOMX_Deinit();
         goto EXIT;
     }
 
@@ -400,7 +500,7 @@ bool JpegEncoder::StartFromLoadedState()
     }
 
     InPortDef.eDir = OMX_DirInput;
-    InPortDef.nBufferCountActual =1;
+    InPortDef.nBufferCountActual = PIPELINE_DEPTH;
     InPortDef.nBufferCountMin = 1;
     InPortDef.bEnabled = OMX_TRUE;
     InPortDef.bPopulated = OMX_FALSE;
@@ -453,7 +553,7 @@ bool JpegEncoder::StartFromLoadedState()
     }
 
     OutPortDef.eDir = OMX_DirOutput;
-    OutPortDef.nBufferCountActual = 1;
+    OutPortDef.nBufferCountActual = PIPELINE_DEPTH;
     OutPortDef.nBufferCountMin = 1;
     OutPortDef.bEnabled = OMX_TRUE;
     OutPortDef.bPopulated = OMX_FALSE;
@@ -509,12 +609,6 @@ bool JpegEncoder::StartFromLoadedState()
 
 	if(mIsPixelFmt420p){
 		nConversionFlag = JPE_CONV_YUV420P_YUV422ILE;
-
-		eError = OMX_GetExtensionIndex(pOMXHandle, strConversionFlag, (OMX_INDEXTYPE*)&nCustomIndex);
-		if ( eError != OMX_ErrorNone ) {
-		    PRINTF("%d::APP_Error at function call: %x\n", __LINE__, eError);
-		    goto EXIT;
-		}
 	}else if(mRotation != 0){
         if(mRotation == 90)
             nConversionFlag = JPE_CONV_YUV422I_90ROT_YUV422I;
@@ -539,31 +633,44 @@ bool JpegEncoder::StartFromLoadedState()
         goto EXIT;
     }
 
-    SetPPLibDynamicParams();
-    SetExifBuffer();
+    ///The headers are bound to the first shot, StartShot() swaps the buffers
+    for ( int i = 0 ; i < PIPELINE_DEPTH ; i++ ) {
+        eError = OMX_UseBuffer(pOMXHandle, &pInBuffHead[i],  InPortDef.nPortIndex,  (void *)&nCompId, InPortDef.nBufferSize, (OMX_U8*)inputBuffer);
+        if ( eError != OMX_ErrorNone ) {
+            PRINTF ("JPEGEnc test:: %d:error= %x\n", __LINE__, eError);
+            pInBuffHead[i] = NULL;
+            goto EXIT;
+        }
 
-    eError = OMX_UseBuffer(pOMXHandle, &pInBuffHead,  InPortDef.nPortIndex,  (void *)&nCompId, InPortDef.nBufferSize, (OMX_U8*)mInputBuffer);
-    if ( eError != OMX_ErrorNone ) {
-        PRINTF ("JPEGEnc test:: %d:error= %x\n", __LINE__, eError);
-        goto EXIT;
+        eError = OMX_UseBuffer(pOMXHandle, &pOutBuffHead[i],  OutPortDef.nPortIndex,  (void *)&nCompId, OutPortDef.nBufferSize, (OMX_U8*)outputBuffer);
+        if ( eError != OMX_ErrorNone ) {
+            PRINTF ("JPEGEnc test:: %d:error= %x\n", __LINE__, eError);
+            pOutBuffHead[i] = NULL;
+            goto EXIT;
+        }
     }
 
-    eError = OMX_UseBuffer(pOMXHandle, &pOutBuffHead,  OutPortDef.nPortIndex,  (void *)&nCompId, OutPortDef.nBufferSize, (OMX_U8*)mOutputBuffer);
+    eError = OMX_SendCommand(pOMXHandle, OMX_CommandStateSet, OMX_StateIdle ,NULL);
     if ( eError != OMX_ErrorNone ) {
-        PRINTF ("JPEGEnc test:: %d:error= %x\n", __LINE__, eError);
+        PRINTF ("Error from SendCommand-Idle(Init) State function\n");
         goto EXIT;
     }
 
-    pInBuffHead->nFilledLen = pInBuffHead->nAllocLen;
-    //pInBuffHead->nFlags = OMX_BUFFERFLAG_EOS;
+    if ( !WaitForState(STATE_IDLE) ) {
+        PRINTF ("JPEG encoder failed to reach the Idle state\n");
+        goto EXIT;
+    }
 
-    eError = OMX_SendCommand(pOMXHandle, OMX_CommandStateSet, OMX_StateIdle ,NULL);
+    eError = OMX_SendCommand(pOMXHandle,OMX_CommandStateSet, OMX_StateExecuting, NULL);
     if ( eError != OMX_ErrorNone ) {
-        PRINTF ("Error from SendCommand-Idle(Init) State function\n");
+        PRINTF("\neError from SendCommand-Executing State function\n");
         goto EXIT;
     }
 
-    Run();
+    if ( !WaitForState(STATE_EXECUTING) ) {
+        PRINTF ("JPEG encoder failed to reach the Executing state\n");
+        goto EXIT;
+    }
 
     return true;
 
@@ -573,12 +680,193 @@ EXIT:
 
 }
 
+void JpegEncoder::StopSession()
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    bool unloading = false;
+
+    if ( NULL == pOMXHandle ) {
+        return;
+    }
+
+    if ( iState == STATE_EXECUTING ) {
+        eError = OMX_SendCommand(pOMXHandle,OMX_CommandStateSet, OMX_StateIdle, NULL);
+        if ( ( eError != OMX_ErrorNone ) || !WaitForState(STATE_IDLE) ) {
+            PRINTF("\nError from SendCommand-Idle(nStop) State function\n");
+            iState = STATE_ERROR;
+        }
+    }
+
+    if ( iState == STATE_IDLE ) {
+        eError = OMX_SendCommand(pOMXHandle,OMX_CommandStateSet, OMX_StateLoaded, NULL);
+        if ( eError != OMX_ErrorNone ) {
+            PRINTF("\nError from SendCommand-Loaded State function\n");
+            iState = STATE_ERROR;
+        } else {
+            unloading = true;
+        }
+    }
+
+    /* Free buffers */
+    for ( int i = 0 ; i < PIPELINE_DEPTH ; i++ ) {
+        if ( NULL != pInBuffHead[i] ) {
+            eError = OMX_FreeBuffer(pOMXHandle, InPortDef.nPortIndex, pInBuffHead[i]);
+            if ( eError != OMX_ErrorNone ) {
+                PRINTF("\nError from OMX_FreeBuffer. Input port.\n");
+            }
+            pInBuffHead[i] = NULL;
+        }
+
+        if ( NULL != pOutBuffHead[i] ) {
+            eError = OMX_FreeBuffer(pOMXHandle, OutPortDef.nPortIndex, pOutBuffHead[i]);
+            if ( eError != OMX_ErrorNone ) {
+                PRINTF("\nError from OMX_FreeBuffer. Output port.\n");
+            }
+            pOutBuffHead[i] = NULL;
+        }
+    }
+
+    if ( unloading && !WaitForState(STATE_LOADED) ) {
+        PRINTF("\nJPEG encoder failed to reach the Loaded state\n");
+    }
+
+    eError = TIOMX_FreeHandle(pOMXHandle);
+    if ( (eError != OMX_ErrorNone) )    {
+        PRINTF("\nError in Free Handle function\n");
+    }
+
+    eError = TIOMX_Deinit();
+    if ( eError != OMX_ErrorNone ) {
+        PRINTF("\nError returned by TIOMX_Deinit()\n");
+    }
+
+    pOMXHandle = NULL;
+    iLastState = iState;
+    iState = STATE_LOADED;
+}
+
+void *JpegEncoder::StartThread(void *arg)
+{
+    JpegEncoder *encoder = (JpegEncoder *) arg;
+    int index;
+
+    pthread_mutex_lock(&encoder->mLock);
+
+    while ( !encoder->mExit ) {
+        index = encoder->NextShot();
+        if ( 0 <= index ) {
+            encoder->StartShot(index);
+        } else {
+            pthread_cond_wait(&encoder->mShotDone, &encoder->mLock);
+        }
+    }
+
+    pthread_mutex_unlock(&encoder->mLock);
+
+    return NULL;
+}
+
+///The oldest queued shot that is not started yet, if the encoder is free for
+///it. -1 otherwise. Called with mLock held
+int JpegEncoder::NextShot()
+{
+    for ( int i = 0 ; i < mShotCount ; i++ ) {
+        int index = ( mFirstShot + i ) % PIPELINE_DEPTH;
+        JpegEncoderShot *shot = &mShots[index];
+
+        if ( shot->failed ) {
+            continue;
+        }
+
+        if ( !shot->started ) {
+            return index;
+        }
+
+        if ( !shot->outputDone ) {
+            return -1;
+        }
+    }
+
+    return -1;
+}
+
+void JpegEncoder::StartShot(int index)
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    JpegEncoderShot *shot = &mShots[index];
+
+    //update these parameters since they can updated dynamically
+    mZoom = shot->zoom;
+    mCrop_top = shot->crop_top;
+    mCrop_left = shot->crop_left;
+    mCrop_width = shot->crop_width;
+    mCrop_height = shot->crop_height;
+    SetPPLibDynamicParams();
+
+    mexif_buf = shot->exif_buf;
+    SetExifBuffer();
+
+    pInBuffHead[index]->pBuffer = (OMX_U8*)shot->inputBuffer;
+    pInBuffHead[index]->nFilledLen  = shot->inBuffSize;
+    //pInBuffHead[index]->nFlags = OMX_BUFFERFLAG_EOS;
+    pOutBuffHead[index]->pBuffer = (OMX_U8*)shot->outputBuffer;
+    pOutBuffHead[index]->nFilledLen = 0;
+
+    shot->started = true;
+    shot->startTime = JpegEncoderTimeUs();
+
+    eError = OMX_EmptyThisBuffer(pOMXHandle, pInBuffHead[index]);
+    if ( eError == OMX_ErrorNone ) {
+        eError = OMX_FillThisBuffer(pOMXHandle, pOutBuffHead[index]);
+    }
+
+    if ( eError != OMX_ErrorNone ) {
+        PRINTF("\nError %x while queueing the buffers of shot %d\n", eError, index);
+        iLastState = iState;
+        iState = STATE_ERROR;
+        FailShots();
+    }
+}
+
+void JpegEncoder::FailShots()
+{
+    for ( int i = 0 ; i < mShotCount ; i++ ) {
+        JpegEncoderShot *shot = &mShots[(mFirstShot + i) % PIPELINE_DEPTH];
+
+        if ( !shot->inputDone || !shot->outputDone ) {
+            shot->failed = true;
+        }
+    }
+
+    pthread_cond_broadcast(&mShotDone);
+}
+
 bool JpegEncoder::encodeImage(void* outputBuffer, int outBuffSize, void *inputBuffer, int inBuffSize, int width, int height, int quality,
         exif_buffer *exif_buf, int isPixelFmt420p, int th_width, int th_height, int outWidth, int outHeight,
         int rotation, float zoom, int crop_top, int crop_left, int crop_width, int crop_height)
 {
+    if ( 0 != pendingImages() ) {
+        PRINTF("\nencodeImage() called with images still queued");
+        return false;
+    }
 
-    bool ret = true;
+    if ( !queueImage(outputBuffer, outBuffSize, inputBuffer, inBuffSize, width, height, quality, exif_buf,
+                     isPixelFmt420p, th_width, th_height, outWidth, outHeight, rotation, zoom, crop_top,
+                     crop_left, crop_width, crop_height) ) {
+        return false;
+    }
+
+    return dequeueImage(NULL);
+}
+
+bool JpegEncoder::queueImage(void* outputBuffer, int outBuffSize, void *inputBuffer, int inBuffSize, int width, int height, int quality,
+        exif_buffer *exif_buf, int isPixelFmt420p, int th_width, int th_height, int outWidth, int outHeight,
+        int rotation, float zoom, int crop_top, int crop_left, int crop_width, int crop_height)
+{
+    int64_t queueTime = JpegEncoderTimeUs();
+    JpegEncoderShot *shot;
+    bool reconfigured = false;
+    int index;
 
     PRINTF("\niState = %d", iState);
     PRINTF("\nwidth = %d", width);
@@ -604,85 +892,149 @@ bool JpegEncoder::encodeImage(void* outputBuffer, int outBuffSize, void *inputBu
     eInputCount++;
     PRINTF("\nrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrrr");
 #endif
-#if OPTIMIZE
-    if (
-        (mOutWidth == outWidth) &&
-        (mOutHeight == outHeight) &&
-        (mInWidth == width) &&
-        (mInHeight == height) &&
-        (mQuality == quality) &&
-        (iState == STATE_EMPTY_BUFFER_DONE_CALLED) &&
-        (mIsPixelFmt420p == isPixelFmt420p) &&
-        (thumb_width == th_width) &&
-        (thumb_height == th_height) &&
-        (mRotation == rotation) //TODO: could optimize by setting the rotation dynamically, but it complicates the code
-    )
-    {
-        PRINTF("\nI am already in EXECUTE state and all input params are same as before.");
 
-        //update these parameters since they can updated dynamically
-        mInWidth = width;
-        mInHeight = height;
-        mZoom = zoom;
-        mCrop_top = crop_top;
-        mCrop_left = crop_left;
-        mCrop_width = crop_width;
-        mCrop_height = crop_height;
-        SetPPLibDynamicParams();
+    pthread_mutex_lock(&mLock);
 
-        mexif_buf = exif_buf;
-        SetExifBuffer();
+    if ( mShotCount == PIPELINE_DEPTH ) {
+        pthread_mutex_unlock(&mLock);
+        PRINTF("\n%d images already queued, dequeue one first", mShotCount);
+        return false;
+    }
 
-        iState = STATE_EXECUTING;
-        pInBuffHead->pBuffer = (OMX_U8*)inputBuffer;
-        pInBuffHead->nFilledLen  = inBuffSize;
-        //pInBuffHead->nFlags = OMX_BUFFERFLAG_EOS;
-        pOutBuffHead->pBuffer = (OMX_U8*)outputBuffer;
-        sem_post(semaphore);
-        Run();
+    if ( !sessionMatches(outBuffSize, inBuffSize, width, height, quality, isPixelFmt420p, th_width, th_height,
+                         outWidth, outHeight, rotation) ) {
+        PRINTF("\nReconfiguring the JPEG encoder session");
+
+        ///Ports can only change in the Loaded state, the shots in flight
+        ///complete with the current session
+        for ( int i = 0 ; i < mShotCount ; i++ ) {
+            shot = &mShots[(mFirstShot + i) % PIPELINE_DEPTH];
+            while ( !shot->failed && ( !shot->inputDone || !shot->outputDone ) ) {
+                pthread_cond_wait(&mShotDone, &mLock);
+            }
+        }
+
+        pthread_mutex_unlock(&mLock);
+
+        StopSession();
 
-    }
-    else
-#endif
-    {
-        mOutputBuffer = outputBuffer;
         mOutBuffSize = outBuffSize;
-        mInputBuffer = inputBuffer;
         mInBuffSize = inBuffSize;
         mInWidth = width;
         mInHeight = height;
         mQuality = quality;
 		mIsPixelFmt420p = isPixelFmt420p;
-		mexif_buf = exif_buf;
-        iLastState = STATE_LOADED;
-        iState = STATE_LOADED;
         thumb_width = th_width;
         thumb_height = th_height;
         mOutWidth = outWidth;
         mOutHeight = outHeight;
         mRotation = rotation;
-        mZoom = zoom;
-        mCrop_top = crop_top;
-        mCrop_left = crop_left;
-        mCrop_width = crop_width;
-        mCrop_height = crop_height;
-    
-        ret = StartFromLoadedState();
-        if (ret == false)
-        {
+
+        if ( !StartSession(outputBuffer, inputBuffer) ) {
             PRINTF("\nThe image cannot be encoded for some reason");
-            return  false;
+            StopSession();
+            return false;
         }
+
+        reconfigured = true;
+
+        pthread_mutex_lock(&mLock);
+    }
+
+    index = ( mFirstShot + mShotCount ) % PIPELINE_DEPTH;
+    shot = &mShots[index];
+    memset(shot, 0, sizeof(JpegEncoderShot));
+    shot->outputBuffer = outputBuffer;
+    shot->inputBuffer = inputBuffer;
+    shot->inBuffSize = inBuffSize;
+    shot->exif_buf = exif_buf;
+    shot->zoom = zoom;
+    shot->crop_top = crop_top;
+    shot->crop_left = crop_left;
+    shot->crop_width = crop_width;
+    shot->crop_height = crop_height;
+    shot->reconfigured = reconfigured;
+    shot->queueTime = queueTime;
+    if ( reconfigured ) {
+        shot->setup = (unsigned int) ( JpegEncoderTimeUs() - queueTime );
+    }
+
+    mShotCount++;
+
+    ///One shot is encoded at a time, a shot queued behind another one is
+    ///started by the start thread once the previous shot is done
+    if ( NextShot() == index ) {
+        StartShot(index);
     }
 
+    pthread_mutex_unlock(&mLock);
+
     return true;
+}
 
-EXIT:
+bool JpegEncoder::dequeueImage(void **outputBuffer)
+{
+    JpegEncoderShot *shot;
+    unsigned int number;
+    bool ret;
 
-    return false;
+    pthread_mutex_lock(&mLock);
+
+    if ( 0 == mShotCount ) {
+        pthread_mutex_unlock(&mLock);
+        PRINTF("\nNo image queued");
+        return false;
+    }
+
+    shot = &mShots[mFirstShot];
+    while ( !shot->failed && ( !shot->inputDone || !shot->outputDone ) ) {
+        pthread_cond_wait(&mShotDone, &mLock);
+    }
+
+    mFirstShot = ( mFirstShot + 1 ) % PIPELINE_DEPTH;
+    mShotCount--;
+    number = mShotNumber++;
+
+    ret = !shot->failed;
+    memset(&timing, 0, sizeof(timing));
+    timing.setup = shot->setup;
+    timing.reconfigured = shot->reconfigured;
+    if ( ret ) {
+        jpegSize = shot->size;
+        timing.pending = (unsigned int) ( shot->startTime - shot->queueTime ) - shot->setup;
+        timing.encode = (unsigned int) ( shot->endTime - shot->startTime );
+        timing.total = (unsigned int) ( shot->endTime - shot->queueTime );
+    } else {
+        jpegSize = 0;
+    }
 
+    if ( NULL != outputBuffer ) {
+        *outputBuffer = shot->outputBuffer;
+    }
+
+    pthread_mutex_unlock(&mLock);
+
+    if ( ret ) {
+        PRINTF("JPEG shot %u: %d bytes, setup %u us%s, pending %u us, encode %u us, total %u us",
+               number, jpegSize, timing.setup, timing.reconfigured ? " (reconfigured)" : "",
+               timing.pending, timing.encode, timing.total);
+    } else {
+        LOGE("JPEG shot %u failed", number);
+    }
+
+    return ret;
 }
 
+int JpegEncoder::pendingImages()
+{
+    int count;
+
+    pthread_mutex_lock(&mLock);
+    count = mShotCount;
+    pthread_mutex_unlock(&mLock);
+
+    return count;
+}
 
 
 void JpegEncoder::PrintState()
@@ -724,128 +1076,3 @@ void JpegEncoder::PrintState()
 
     }
 }
-
-void JpegEncoder::Run()
-{
-    int nRead;
-    OMX_ERRORTYPE eError = OMX_ErrorNone;
-
-while(1){
-    if (sem_wait(semaphore))
-    {
-        PRINTF("\nsem_wait returned the error");
-        continue;
-    }
-
-    PrintState();
-
-    switch(iState)
-    {
-        case STATE_IDLE:
-            if (iLastState == STATE_LOADED)
-            {
-                eError = OMX_SendCommand(pOMXHandle,OMX_CommandStateSet, OMX_StateExecuting, NULL);
-                if ( eError != OMX_ErrorNone ) {
-                    PRINTF("\neError from SendCommand-Executing State function\n");
-                    iState = STATE_ERROR;
-                    break;
-                }
-            }
-            else if (iLastState == STATE_EMPTY_BUFFER_DONE_CALLED)
-            {
-                    eError = OMX_SendCommand(pOMXHandle,OMX_CommandStateSet, OMX_StateLoaded, NULL);
-                    if ( eError != OMX_ErrorNone ) {
-                        PRINTF("\nError from SendCommand-Idle State function\n");
-                        iState = STATE_ERROR;
-                        break;
-                    }
-                    /*
-                    eError = OMX_SendCommand(pOMXHandle, OMX_CommandPortDisable, 0x0, NULL);
-                    if ( eError != OMX_ErrorNone ) {
-                        PRINTF("\nError from SendCommand-PortDisable function. Input port.\n");
-                        iState = STATE_ERROR;
-                        break;
-                    }
-
-                    eError = OMX_SendCommand(pOMXHandle, OMX_CommandPortDisable, 0x1, NULL);
-                    if ( eError != OMX_ErrorNone ) {
-                        PRINTF("\nError from SendCommand-PortDisable function. Output port.\n");
-                        iState = STATE_ERROR;
-                        break;
-                    }
-                    */
-                    /* Free buffers */
-                    eError = OMX_FreeBuffer(pOMXHandle, InPortDef.nPortIndex, pInBuffHead);
-                    if ( eError != OMX_ErrorNone ) {
-                        PRINTF("\nError from OMX_FreeBuffer. Input port.\n");
-                        iState = STATE_ERROR;
-                        break;
-                    }
-
-                    eError = OMX_FreeBuffer(pOMXHandle, OutPortDef.nPortIndex, pOutBuffHead);
-                    if ( eError != OMX_ErrorNone ) {
-                        PRINTF("\nError from OMX_FreeBuffer. Output port.\n");
-                        iState = STATE_ERROR;
-                        break;
-                    }
-            }
-            else
-            {
-                iState = STATE_ERROR;
-            }
-            break;
-
-        case STATE_EXECUTING:
-
-            OMX_EmptyThisBuffer(pOMXHandle, pInBuffHead);
-            OMX_FillThisBuffer(pOMXHandle, pOutBuffHead);
-            break;
-
-        case STATE_EMPTY_BUFFER_DONE_CALLED:
-#if OPTIMIZE
-            // do nothing
-#else
-            eError = OMX_SendCommand(pOMXHandle,OMX_CommandStateSet, OMX_StateIdle, NULL);
-            if ( eError != OMX_ErrorNone ) {
-                PRINTF("Error from SendCommand-Idle(nStop) State function\n");
-                iState = STATE_ERROR;
-            }
-#endif
-            break;
-
-        case STATE_LOADED:
-        case STATE_ERROR:
-            /*### Assume that the Bitmap object/file need not be closed. */
-            /*### More needs to be done here */
-            /*### Do different things based on iLastState */
-
-            if (pOMXHandle) {
-                eError = TIOMX_FreeHandle(pOMXHandle);
-                if ( (eError != OMX_ErrorNone) )    {
-                    PRINTF("\nError in Free Handle function\n");
-                }
-            }
-
-            eError = TIOMX_Deinit();
-            if ( eError != OMX_ErrorNone ) {
-                PRINTF("\nError returned by TIOMX_Deinit()\n");
-            }
-
-            iState = STATE_EXIT;
-            sem_post(semaphore) ;
-
-            break;
-
-        default:
-            break;
-    }
-
-    if (iState == STATE_EXIT) break;
-#if OPTIMIZE
-    if (iState == STATE_EMPTY_BUFFER_DONE_CALLED) break ;
-#endif
-
-    }
-
-}
-
@@ -36,6 +36,8 @@ Better Error handling
 
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
 #include <semaphore.h>
 
 #include <utils/Log.h>
@@ -47,6 +49,16 @@ extern "C" {
     #include "OMX_IVCommon.h"
 }
 
+///The encoder keeps one OMX session in the Executing state across captures.
+///Ports are only reconfigured when the geometry, the format, the rotation,
+///the thumbnail or the quality change, or when a buffer outgrows its port.
+///Each port has PIPELINE_DEPTH buffer headers, so a shot can be queued while
+///the previous one is still encoding. The EXIF and PPLib configs are latched
+///by the component and cannot travel with a buffer, so the queued shot is only
+///handed to the component once the previous one is done. FillBufferDone wakes
+///up the start thread of the encoder for this, the component is never called
+///from within its own callback.
+///queueImage() and dequeueImage() must be called from one thread.
 class JpegEncoder
 {
 
@@ -63,6 +75,12 @@ public:
         STATE_EXIT                                             // 6
     };
 
+    enum
+    {
+        ///Shots in flight: one encoding and one queued behind it
+        PIPELINE_DEPTH = 2
+    };
+
     typedef struct JpegEncoderParams
     {
         //nWidth;
@@ -80,7 +98,19 @@ public:
         //nCropHeight
     }JpegEncoderParams;
 
+    ///Latency breakdown of one shot, in microseconds
+    typedef struct JpegEncoderTiming
+    {
+        unsigned int setup;         ///< OMX session (re)configuration, 0 when the session is reused
+        unsigned int pending;       ///< waiting behind the previous shot
+        unsigned int encode;        ///< from EmptyThisBuffer to both buffers being returned
+        unsigned int total;         ///< from queueImage() to both buffers being returned
+        bool reconfigured;
+    }JpegEncoderTiming;
+
     int jpegSize;
+    ///Timing of the last dequeued shot
+    JpegEncoderTiming timing;
     sem_t *semaphore;
     JPEGENC_State iState;
     JPEGENC_State iLastState;
@@ -89,14 +119,30 @@ public:
 
     ~JpegEncoder();
     JpegEncoder();
+
+    ///Encodes one image synchronously, the size of the JPEG is left in jpegSize
     bool encodeImage(void* outputBuffer, int outBuffSize, void *inputBuffer, int inBuffSize, int width, int height,
             int quality, exif_buffer *exif_buf, int mIsPixelFmt420p, int thumb_width, int thumb_height, int outWidth, int outHeight,
             int rotation, float zoom, int crop_top, int crop_left, int crop_width, int crop_height);
+
+    ///Queues one image and returns without waiting for the encoder. Fails when
+    ///PIPELINE_DEPTH shots are already queued. The buffers and exif_buf belong
+    ///to the encoder until the shot is dequeued
+    bool queueImage(void* outputBuffer, int outBuffSize, void *inputBuffer, int inBuffSize, int width, int height,
+            int quality, exif_buffer *exif_buf, int mIsPixelFmt420p, int thumb_width, int thumb_height, int outWidth, int outHeight,
+            int rotation, float zoom, int crop_top, int crop_left, int crop_width, int crop_height);
+
+    ///Waits for the oldest queued shot, sets jpegSize and timing. outputBuffer
+    ///may be NULL. Returns false if that shot failed or nothing is queued
+    bool dequeueImage(void **outputBuffer);
+
+    ///Number of shots queued and not dequeued yet
+    int pendingImages();
+
     bool SetJpegEncodeParameters(JpegEncoderParams * jep) {memcpy(&jpegEncParams, jep, sizeof(JpegEncoderParams)); return true;}
-    void Run();
     void PrintState();
-    void FillBufferDone(OMX_U8* pBuffer, OMX_U32 size);
-    bool StartFromLoadedState();
+    void FillBufferDone(OMX_BUFFERHEADERTYPE* pBuffHead);
+    void EmptyBufferDone(OMX_BUFFERHEADERTYPE* pBuffHead);
     void EventHandler(OMX_HANDLETYPE hComponent,
                                             OMX_EVENTTYPE eEvent,
                                             OMX_U32 nData1,
@@ -105,15 +151,36 @@ public:
 
 private:
 
+    typedef struct JpegEncoderShot
+    {
+        void *outputBuffer;
+        void *inputBuffer;
+        int inBuffSize;
+        exif_buffer *exif_buf;
+        float zoom;
+        int crop_top;
+        int crop_left;
+        int crop_width;
+        int crop_height;
+        int size;
+        bool started;
+        bool inputDone;
+        bool outputDone;
+        bool failed;
+        bool reconfigured;
+        unsigned int setup;
+        int64_t queueTime;
+        int64_t startTime;
+        int64_t endTime;
+    }JpegEncoderShot;
+
     OMX_HANDLETYPE pOMXHandle;
-    OMX_BUFFERHEADERTYPE *pInBuffHead;
-    OMX_BUFFERHEADERTYPE *pOutBuffHead;
+    OMX_BUFFERHEADERTYPE *pInBuffHead[PIPELINE_DEPTH];
+    OMX_BUFFERHEADERTYPE *pOutBuffHead[PIPELINE_DEPTH];
     OMX_PARAM_PORTDEFINITIONTYPE InPortDef;
     OMX_PARAM_PORTDEFINITIONTYPE OutPortDef;
     JpegEncoderParams jpegEncParams;
-    void* mOutputBuffer;
     int mOutBuffSize;
-    void *mInputBuffer;
     int mInBuffSize;
     int mInWidth;
     int mInHeight;
@@ -127,6 +194,26 @@ private:
     int mCrop_left;
     int mCrop_width;
     int mCrop_height;
+
+    ///Shots in queueing order, mShots[i] uses pInBuffHead[i] and pOutBuffHead[i]
+    JpegEncoderShot mShots[PIPELINE_DEPTH];
+    int mFirstShot;
+    int mShotCount;
+    unsigned int mShotNumber;
+    pthread_mutex_t mLock;
+    pthread_cond_t mShotDone;
+    pthread_t mStartThread;
+    bool mExit;
+
+    bool sessionMatches(int outBuffSize, int inBuffSize, int width, int height, int quality, int isPixelFmt420p,
+            int th_width, int th_height, int outWidth, int outHeight, int rotation);
+    bool StartSession(void *outputBuffer, void *inputBuffer);
+    void StopSession();
+    bool WaitForState(JPEGENC_State state);
+    static void *StartThread(void *arg);
+    int NextShot();
+    void StartShot(int index);
+    void FailShots();
     OMX_ERRORTYPE SetPPLibDynamicParams(void);
     OMX_ERRORTYPE SetExifBuffer(void);
 };
@@ -147,6 +147,38 @@ protected:
     void setFrameRefCount(void* frameBuf, CameraFrame::FrameType frameType, int refCount);
     int getFrameRefCount(void* frameBuf, CameraFrame::FrameType frameType);
 
+    enum {
+        ///Maximum number of buffers registered per buffer type
+        MAX_FRAME_BUFFERS = 32,
+        ///Video references live in the upper half of the preview reference counters
+        VIDEO_REF_SHIFT = 16,
+        REF_COUNT_MASK = 0xFFFF
+    };
+
+    ///Buffers registered through CAMERA_USE_BUFFERS, each one with its own
+    ///reference counter. The index of a buffer in the table never changes until
+    ///the next CAMERA_USE_BUFFERS, so counters can be updated atomically
+    ///without any lock.
+    struct FrameBufferTable {
+        int buffers[MAX_FRAME_BUFFERS];
+        volatile int32_t refCounts[MAX_FRAME_BUFFERS];
+        volatile int32_t count;
+    };
+
+    ///Two tables per buffer type. CAMERA_USE_BUFFERS fills the inactive one and
+    ///then publishes it, so a lookup racing with it finds the buffer in either
+    ///the previous or the new table, never in a half filled one.
+    struct FrameBufferTables {
+        FrameBufferTable tables[2];
+        volatile int32_t active;
+    };
+
+    status_t setFrameBuffers(FrameBufferTables &tables, int *buffers, size_t count, int32_t refCount);
+    void clearFrameBuffers(FrameBufferTables &tables);
+    FrameBufferTable* getActiveFrameBuffers(FrameBufferTables &tables);
+    FrameBufferTable* getFrameBufferTable(CameraFrame::FrameType frameType, int &shift);
+    int getFrameIndex(FrameBufferTable *table, void *frameBuf);
+
     enum FrameState {
         STOPPED = 0,
         RUNNING
@@ -175,8 +207,6 @@ protected:
 
 #endif
 
-    mutable Mutex mReturnFrameLock;
-
     //Different frame subscribers get stored using these
     KeyedVector<int, frame_callback> mFrameSubscribers;
     KeyedVector<int, frame_callback> mFrameDataSubscribers;
@@ -192,26 +222,26 @@ protected:
     int *mPreviewBuffers;
     int mPreviewBufferCount;
     size_t mPreviewBuffersLength;
-    KeyedVector<int, int> mPreviewBuffersAvailable;
+    //Preview and video reference counts, video ones in the upper half
+    FrameBufferTables mPreviewBuffersAvailable;
     mutable Mutex mPreviewBufferLock;
 
     //Video buffer management data
     int *mVideoBuffers;
-    KeyedVector<int, int> mVideoBuffersAvailable;
     int mVideoBuffersCount;
     size_t mVideoBuffersLength;
     mutable Mutex mVideoBufferLock;
 
     //Image buffer management data
     int *mCaptureBuffers;
-    KeyedVector<int, bool> mCaptureBuffersAvailable;
+    FrameBufferTables mCaptureBuffersAvailable;
     int mCaptureBuffersCount;
     size_t mCaptureBuffersLength;
     mutable Mutex mCaptureBufferLock;
 
     //Metadata buffermanagement
     int *mPreviewDataBuffers;
-    KeyedVector<int, bool> mPreviewDataBuffersAvailable;
+    FrameBufferTables mPreviewDataBuffersAvailable;
     int mPreviewDataBuffersCount;
     size_t mPreviewDataBuffersLength;
     mutable Mutex mPreviewDataBufferLock;
@@ -227,6 +257,9 @@ protected:
     void *mEndCaptureData;
     bool mRecording;
 
+    //Shutter press of the last capture, adapters keeping a ZSL ring pick their frame around it
+    nsecs_t mShutterTimestamp;
+
 };
 
 };
@@ -71,8 +71,9 @@
 #define FLASH_VOLTAGE_THRESHOLD1 3700000 // intensity will be reduced to 50% below threshold1
 #define FLASH_VOLTAGE_THRESHOLD2 3300000 // flash disabled below threshold2
 
-//Enables Absolute PPM measurements in logcat
-#define PPM_INSTRUMENTATION_ABS 1
+//Enables Absolute PPM measurements in logcat, on top of the
+//trace points recorded when debug.camera.trace is set (CameraKPI.h)
+//#define PPM_INSTRUMENTATION_ABS 1
 
 //Uncomment to enable more verbose/debug logs
 #define DEBUG_LOG
@@ -110,6 +111,9 @@
     if(x > -1) \
         y = x
 
+///TILER buffer pool, see memmgr.h
+struct MemMgrPool;
+
 namespace android {
 
 
@@ -408,6 +412,7 @@ public:
     ///Constants
     static const int NOTIFIER_TIMEOUT;
     static const size_t EMPTY_RAW_SIZE;
+    static const size_t NOTIFIER_BATCH_SIZE = 8;
     static const int32_t MAX_BUFFERS = 8;
 
     enum NotifierCommands
@@ -510,14 +515,37 @@ public:
         MessageQueue &msgQ() { return mNotificationThreadQ;}
     };
 
+    ///Preview frame lent to the application without copying. The frame is
+    ///returned to the camera adapter when the last reference to it is dropped.
+    ///The application may hold the frame past the notifier, so only a weak
+    ///reference is kept and the frame is dropped if the notifier is gone
+    class PreviewFrameMemory : public MemoryBase
+    {
+    public:
+        PreviewFrameMemory(const sp<IMemoryHeap>& heap, size_t size, const wp<AppCallbackNotifier>& notifier,
+                           void *frameBuf, uint32_t generation)
+            : MemoryBase(heap, 0, size), mNotifier(notifier), mFrameBuf(frameBuf), mGeneration(generation) { }
+        virtual ~PreviewFrameMemory();
+
+    private:
+        wp<AppCallbackNotifier> mNotifier;
+        void *mFrameBuf;
+        uint32_t mGeneration;
+    };
+
     //Friend declarations
     friend class NotificationThread;
+    friend class PreviewFrameMemory;
 
 private:
     void notifyEvent();
     void notifyFrame();
+    void processEvent(Message &msg);
+    void processFrame(Message &msg);
     bool processMessage();
     void releaseSharedVideoBuffers();
+    sp<MemoryBase> lendPreviewFrame(CameraFrame *frame);
+    void releasePreviewFrame(void *frameBuf, uint32_t generation);
 
 private:
     mutable Mutex mLock;
@@ -553,6 +581,12 @@ private:
     KeyedVector<unsigned int, sp<MemoryBase> > mSharedPreviewBuffers;
     bool mAppSupportsStride;
 
+    //Zero-copy preview frames currently held by the application
+    mutable Mutex mLentFramesLock;
+    uint32_t mPreviewGeneration;
+    size_t mLentPreviewFrames;
+    size_t mMaxLentPreviewFrames;
+
     //Burst mode active
     bool mBurst;
     mutable Mutex mRecordingLock;
@@ -567,8 +601,11 @@ private:
 class MemoryManager : public BufferProvider, public virtual RefBase
 {
 public:
-    ///Initializes the display adapter creates any resources required
-    status_t initialize(){ return NO_ERROR; }
+    MemoryManager();
+    virtual ~MemoryManager();
+
+    ///Initializes the memory manager and creates the TILER buffer pool
+    status_t initialize();
 
     virtual status_t setErrorHandler(ErrorNotifier *errorNotifier);
     virtual void* allocateBuffer(int width, int height, const char* format, int &bytes, int numBufs);
@@ -579,6 +616,9 @@ public:
 private:
 
     sp<ErrorNotifier> mErrorNotifier;
+
+    ///Keeps released TILER buffers for reuse across preview/capture sessions
+    MemMgrPool *mPool;
 };
 
 
@@ -1019,12 +1059,16 @@ private:
 
             //Check if a given resolution is supported by the current camera
             //instance
-            bool isResolutionValid(unsigned int width, unsigned int height, const char *supportedResolutions);
+            bool isResolutionValid(unsigned int width, unsigned int height, CameraProperties::CameraPropertyIndex supported);
 
             //Check if a given parameter is supported by the current camera
             // instance
-            bool isParameterValid(const char *param, const char *supportedParams);
-            bool isParameterValid(int param, const char *supportedParams);
+            bool isParameterValid(const char *param, CameraProperties::CameraPropertyIndex supported);
+            bool isParameterValid(int param, CameraProperties::CameraPropertyIndex supported);
+
+            //Check if the application passes back the value already applied
+            //for a key, which was validated when it was first set
+            bool isParameterUnchanged(const CameraParameters &params, const char *key);
 
             /** Initialize default parameters */
             void initDefaultParameters();
@@ -1101,6 +1145,8 @@ public:
 #endif
 
     static CameraKPI mCameraKPI;
+    //Shutter press of the last takePicture, ZSL frames are picked around it
+    nsecs_t mShutterTimestamp;
     bool mAfterCapture;
     bool mIsCafEnabled;
 
@@ -3,6 +3,7 @@
 
 #include <utils/Timers.h>
 #include <utils/Log.h>
+#include "TraceRing.h"
 
 //#define CAM_PERF
 
@@ -20,6 +21,25 @@ typedef enum {
     ,CAMKPI_Construct
     }CameraKPIType;
 
+///Trace point ids, the KPI ones follow the CameraKPIType order
+typedef enum {
+     CAMTRACE_KPI_AF
+    ,CAMTRACE_KPI_Shutter
+    ,CAMTRACE_KPI_Raw
+    ,CAMTRACE_KPI_JPG
+    ,CAMTRACE_KPI_Postview
+    ,CAMTRACE_KPI_Preview
+    ,CAMTRACE_KPI_JPGToPreview
+    ,CAMTRACE_KPI_RestartPreview
+    ,CAMTRACE_KPI_Construct
+    ,CAMTRACE_StandbyToShot
+    ,CAMTRACE_ShotToSnapshot
+    ,CAMTRACE_ShotToShot
+    ,CAMTRACE_ShotToJpeg
+    ,CAMTRACE_FramesWithDisplay
+    ,CAMTRACE_Max
+    }CameraTraceType;
+
 typedef enum {
      CAMKPI_StatusNone
     ,CAMKPI_StatusFailure
@@ -39,6 +59,10 @@ public:
     void stopKPITimer(CameraKPIType type,
                       CameraKPIStatusType status);
 
+    /* binary tracing, see TraceRing.h */
+    static void startTrace();
+    static void stopTrace();
+
 
 private:
     bool bBlurLoggingEnabled;
@@ -204,19 +204,55 @@ public:
     static const char FRAMERATE_RANGE[];
     static const char FRAMERATE_RANGE_SUPPORTED[];
 
+    ///Hashed set of the PARAMS_DELIMITER separated values of a property
+    ///Built once when the property is loaded, so that checking a parameter
+    ///against a supported list is a lookup instead of a substring search.
+    ///Only exact values match, "40x480" is not found in "640x480".
+    class ValueSet
+        {
+        public:
+            ValueSet();
+            ~ValueSet();
+
+            ///Splits values and hashes every entry, values must outlive the set
+            status_t compile(const char *values);
+            bool contains(const char *value) const;
+            unsigned int count() const { return mCount; }
+
+        private:
+            ValueSet(const ValueSet &);
+            ValueSet &operator=(const ValueSet &);
+
+            static uint32_t hash(const char *value, size_t length);
+
+            struct Entry
+                {
+                uint32_t mHash;
+                uint16_t mOffset;
+                uint16_t mLength;
+                };
+
+            const char *mValues;
+            Entry *mEntries;
+            uint32_t mMask;
+            unsigned int mCount;
+        };
+
     class CameraProperty
         {
         public:
             CameraProperty(const char *propName, const char *propValue)
                 {
                   strncpy(mPropName, propName, sizeof(mPropName)-1);
-                  strncpy(mPropValue, propValue, sizeof(mPropValue)-1);
+                  mPropName[sizeof(mPropName)-1] = '\0';
+                  setValue(propValue);
                 }
             status_t setValue(const char * value);
 
         public:
             char mPropName[MAX_PROP_NAME_LENGTH];
             char mPropValue[MAX_PROP_VALUE_LENGTH];
+            ValueSet mValueSet;
 
         };
 
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef FACE_TRACKER_H
+#define FACE_TRACKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace android {
+
+///Temporal filter of face detection results
+///The detections of a frame are matched to the faces tracked so far by their
+///overlap (intersection over union). A matched face keeps its id, and its box
+///follows the detections through an exponential filter, so that neither the
+///application nor 3A see the detector jitter. A new face is reported once it
+///was detected on a few frames in a row, and a reported face survives a few
+///frames without detection. The tracker is not locked, and update() does not
+///allocate.
+class FaceTracker
+{
+public:
+
+    enum
+        {
+        ///Faces reported by the Ducati face detection
+        MAX_FACES = 35,
+        MAX_TRACKS = 16
+        };
+
+    struct Face
+        {
+        int32_t mLeft;
+        int32_t mTop;
+        int32_t mWidth;
+        int32_t mHeight;
+        int32_t mRoll;
+        uint32_t mScore;
+        };
+
+    struct Track
+        {
+        ///Never reused while the tracker runs
+        uint32_t mId;
+        ///Filtered box, in the coordinates of the detections
+        Face mFace;
+        unsigned int mHits;
+        unsigned int mMisses;
+        };
+
+    struct Config
+        {
+        ///Smallest overlap, in percent, for a detection to continue a track
+        unsigned int mMinOverlap;
+        ///Weight, in percent, of a new detection in the filtered box
+        unsigned int mSmoothing;
+        ///Move of the filtered box, in percent of its width, before the reported one follows
+        unsigned int mDeadBand;
+        ///Frames a face has to be detected on before it is reported
+        unsigned int mConfirmFrames;
+        ///Frames a reported face survives without a detection
+        unsigned int mHoldFrames;
+        ///Move or resize of the region, in percent of its size, before it is updated
+        unsigned int mRegionThreshold;
+        };
+
+    FaceTracker();
+
+    void setConfig(const Config &config);
+
+    ///Drops every track
+    void reset();
+
+    ///Feeds the detections of one frame
+    ///Returns true when the reported faces, or their rounded boxes, changed
+    bool update(const Face *faces, unsigned int count);
+
+    ///Reported faces, in the order they were first detected
+    unsigned int getCount() const;
+    const Track& getTrack(unsigned int index) const;
+
+    ///Region of interest for focus and exposure: the box of the largest face,
+    ///kept for as long as that face is reported. Returns true when the region
+    ///appeared, vanished, or moved or resized past the threshold since the
+    ///last region it returned. valid is false when no face is reported
+    bool getRegion(Face &region, bool &valid);
+
+    ///Writes the reported faces as "roll,leftxtop,widthxheight," entries
+    ///The string is always terminated, faces that do not fit are dropped
+    ///Returns the length of the string
+    size_t encode(char *buffer, size_t size) const;
+
+private:
+
+    struct Slot
+        {
+        Track mTrack;
+        ///Filtered box in Q8: left, top, width and height
+        int32_t mBox[4];
+        bool mUsed;
+        };
+
+    void filter(Slot &slot, const Face &face);
+
+    Config mConfig;
+    Slot mSlots[MAX_TRACKS];
+    uint32_t mNextId;
+
+    ///Slots of the reported faces
+    unsigned int mReported[MAX_TRACKS];
+    unsigned int mReportedCount;
+
+    ///Matching scratch, overlap in percent of every slot and detection
+    uint8_t mOverlap[MAX_TRACKS][MAX_FACES];
+
+    ///Last region returned by getRegion()
+    Face mRegion;
+    uint32_t mRegionId;
+    bool mRegionValid;
+};
+
+};
+
+#endif //FACE_TRACKER_H
@@ -23,6 +23,7 @@
 #define FAKE_CAMERA_ADAPTER_H
 
 #include "BaseCameraAdapter.h"
+#include "ZslRing.h"
 
 namespace android {
 
@@ -91,6 +92,13 @@ protected:
     void setBuffer(void *previewBuffer, int index, int width, int height, int pixelFormat, PreviewFrameType frame);
     virtual void sendNextFrame(PreviewFrameType frame);
     status_t startImageCapture();
+    //Keeps a capture buffer in the ZSL ring for every sensor frame
+    void storeZslFrame();
+    void flushZslFrames();
+    //Takes the ZSL frame closest to the last shutter press as the captured image
+    status_t getZslFrame(CameraFrame &frame);
+    //Queues a buffer returned by the subscribers on its free list
+    void queueFreeBuffer(void *frameBuf, int frameType);
 
 //Internal class definitions
 
@@ -145,6 +153,8 @@ class FramePreview : public Thread {
     int mPreviewWidth, mPreviewHeight, mPreviewFormat;
     int mCaptureWidth, mCaptureHeight, mCaptureFormat;
     int mFrameRate;
+    //Zero shutter lag frames, one capture buffer per sensor frame while ZSL is on
+    ZslRing mZslRing;
     CameraParameters mParameters;
     MessageQueue mCallbackQ;
     MessageQueue mFrameQ;
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef OMX_3A_TRANSACTION_H
+#define OMX_3A_TRANSACTION_H
+
+#include <pthread.h>
+#include <utils/threads.h>
+#include "OMX_Types.h"
+#include "OMX_Core.h"
+#include "OMX_Component.h"
+
+namespace android {
+
+///Batches the OMX configs written while applying 3A settings
+///Every OMX_SetConfig()/OMX_GetConfig() is a synchronous RPC to Ducati. Between
+///begin() and commit(), the configs read and written by the thread that opened
+///the transaction stay local: a write replaces an earlier write of the same
+///config, a read after a read or a write is served from the local copy, and a
+///write of the value just read from the component is dropped. commit() sends
+///every config that changed once, in the order the settings first touched it.
+///A read that has to go to the component first sends the writes staged so
+///far, so it sees what they changed there.
+///Outside a transaction, and from other threads, the calls go straight to the
+///component.
+class OMX3ATransaction
+{
+public:
+
+    enum
+        {
+        MAX_CONFIGS = 16,
+        MAX_CONFIG_SIZE = 256
+        };
+
+    ///A config the component rejected while the transaction was sent
+    struct Error
+        {
+        OMX_INDEXTYPE mIndex;
+        OMX_ERRORTYPE mError;
+        };
+
+    OMX3ATransaction();
+
+    ///Opens a transaction on the component, blocks while another thread has one open
+    void begin(OMX_HANDLETYPE handle);
+
+    ///Sends the staged configs and closes the transaction
+    ///Returns the first error reported by the component. errors, when not NULL,
+    ///receives up to MAX_CONFIGS of the configs the component rejected since
+    ///begin(), and count their number
+    OMX_ERRORTYPE commit(Error *errors = NULL, unsigned int *count = NULL);
+
+    ///Same contract as OMX_GetConfig()/OMX_SetConfig()
+    OMX_ERRORTYPE getConfig(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config);
+    OMX_ERRORTYPE setConfig(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config);
+
+    ///Round trips asked for inside transactions, and the ones actually sent
+    unsigned int requested() const { return mRequested; }
+    unsigned int issued() const { return mIssued; }
+
+private:
+
+    struct Config
+        {
+        OMX_INDEXTYPE mIndex;
+        OMX_U32 mPortIndex;
+        OMX_U32 mSize;
+        bool mDirty;
+        OMX_U8 mData[MAX_CONFIG_SIZE];
+        };
+
+    bool isStaging() const;
+    Config *find(OMX_INDEXTYPE index, OMX_PTR config);
+    Config *add(OMX_INDEXTYPE index, OMX_PTR config);
+    ///Whether a write other than the one to except is staged
+    bool isPending(const Config *except) const;
+    OMX_ERRORTYPE flush();
+    OMX_ERRORTYPE send(OMX_INDEXTYPE index, OMX_PTR config);
+
+    Mutex mLock;
+    volatile bool mOpen;
+    pthread_t mOwner;
+    OMX_HANDLETYPE mHandle;
+    Config mConfigs[MAX_CONFIGS];
+    unsigned int mCount;
+    Error mErrors[MAX_CONFIGS];
+    unsigned int mErrorCount;
+    unsigned int mRequested;
+    unsigned int mIssued;
+};
+
+};
+
+#endif //OMX_3A_TRANSACTION_H
@@ -35,6 +35,8 @@
 #include "OMX_TI_Common.h"
 #include "OMX_TI_Image.h"
 #include "General3A_Settings.h"
+#include "OMX3ATransaction.h"
+#include "FaceTracker.h"
 
 #include "BaseCameraAdapter.h"
 #include "DebugUtils.h"
@@ -483,6 +485,7 @@ private:
     status_t setFaceDetection(bool enable);
     status_t detectFaces(OMX_BUFFERHEADERTYPE* pBuffHeader);
     status_t encodeFaceCoordinates(const OMX_FACEDETECTIONTYPE *faceData, char *faceString, size_t faceStringSize);
+    status_t setFaceRegion(const FaceTracker::Face &region, bool valid);
 
     //3A Algorithms priority configuration
     status_t setAlgoPriority(AlgoPriority priority, Algorithm3A algo, bool enable);
@@ -519,6 +522,9 @@ private:
     status_t insertFocusModes(CameraParameters &params, OMX_TI_CAPTYPE &caps);
     status_t insertFlickerModes(CameraParameters &params, OMX_TI_CAPTYPE &caps);
 
+    //Returns true if key differs from the parameters applied by the previous setParameters()
+    bool isParameterChanged(const CameraParameters &params, const char *key);
+
     //Exposure Bracketing
     status_t setExposureBracketing(int *evValues, size_t evCount, size_t frameCount);
     status_t parseExpRange(const char *rangeStr, int * expRange, size_t count, size_t &validEntries);
@@ -679,6 +685,10 @@ private:
     //Face detection threshold
     static const uint32_t FACE_THRESHOLD_DEFAULT = 100;
     uint32_t mFaceDetectionThreshold;
+    //Tracked faces, reported instead of the raw detections
+    FaceTracker mFaceTracker;
+    //Focus and exposure follow the tracked face region instead of the Ducati face priority
+    bool mFaceRegionActive;
 
     //Geo-tagging
     EXIFData mEXIFData;
@@ -720,6 +730,7 @@ private:
 
     unsigned int mPending3Asettings;
     Gen3A_settings mParameters3A;
+    OMX3ATransaction m3ATransaction;
 
     CameraParameters mParams;
     unsigned int mPictureRotation;
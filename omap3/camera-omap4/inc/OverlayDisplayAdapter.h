@@ -166,14 +166,15 @@ private:
 
     const char *mPixelFormat;
 
-#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
     //Used for calculating standby to first shot
-    struct timeval mStandbyToShot;
     bool mMeasureStandby;
     //Used for shot to snapshot/shot calculation
-    struct timeval mStartCapture;
     bool mShotToShot;
 
+#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
+    struct timeval mStandbyToShot;
+    struct timeval mStartCapture;
+
 #endif
 
     bool mFirstFrame;
@@ -46,6 +46,7 @@ static const char  KEY_FACE_DETECTION_ENABLE[];
 static const char  KEY_FACE_DETECTION_DATA[];
 static const char  KEY_FACE_DETECTION_THRESHOLD[];
 static const char  KEY_BURST[];
+static const char  KEY_ZSL_DEPTH[];
 static const  char KEY_CAP_MODE[];
 static const  char KEY_VSTAB[];
 static const  char KEY_VSTAB_VALUES[];
@@ -75,8 +76,8 @@ static const char  KEY_MEASUREMENT_ENABLE[];
 static const char  KEY_INITIAL_VALUES[];
 static const char  KEY_GBCE[];
 static const char  KEY_GLBCE[];
-static const char  KEY_MINFRAMERATE[];
-static const char  KEY_MAXFRAMERATE[];
+static const char  KEY_MINFRAMERATE[];
+static const char  KEY_MAXFRAMERATE[];
 
 static const char  KEY_CURRENT_ISO[];
 
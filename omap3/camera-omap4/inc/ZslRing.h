@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ZSL_RING_H
+#define ZSL_RING_H
+
+#include <stdint.h>
+#include <utils/threads.h>
+#include <utils/Timers.h>
+#include <Errors.h>
+
+namespace android {
+
+///Zero shutter lag frame ring
+///While ZSL is on, the adapter keeps the last full resolution frames of the
+///sensor here, each with its capture timestamp and the 3A state it was exposed
+///with. A capture then takes the frame closest to the shutter press instead of
+///waiting for a new exposure.
+///The ring holds the frames it stores: a frame pushed out by a newer one, or
+///flushed, goes back to the caller so that it can requeue the buffer.
+///Only FakeCameraAdapter fills a ring so far. The OMX image port only runs
+///during a capture, so OMXCameraAdapter rejects a nonzero zsl-depth and relies
+///on the ZSL Ducati does in the high quality capture mode.
+class ZslRing
+{
+public:
+
+    enum
+        {
+        MAX_DEPTH = 8
+        };
+
+    ///3A state of a stored frame
+    struct Metadata
+        {
+        ///Exposure time in us
+        int mExposureTime;
+        ///Sensor gain as ISO
+        int mSensitivity;
+        ///EV compensation in steps of the adapter
+        int mEVCompensation;
+        int mWhiteBalance;
+        ///Set when AE, AWB and focus had converged on this frame
+        bool mConverged;
+        };
+
+    struct Frame
+        {
+        void *mBuffer;
+        uint32_t mOffset;
+        size_t mLength;
+        int mWidth;
+        int mHeight;
+        nsecs_t mTimestamp;
+        Metadata mMetadata;
+        };
+
+    ZslRing();
+
+    ///Number of frames to keep, at most MAX_DEPTH. 0 turns ZSL off
+    ///The ring has to be flushed before its depth changes
+    status_t setDepth(unsigned int depth);
+    unsigned int getDepth() const;
+    unsigned int getCount() const;
+
+    ///Stores a frame. On a full ring the oldest frame is pushed out and its
+    ///buffer returned in evicted, which is NULL otherwise
+    status_t push(const Frame &frame, void *&evicted);
+
+    ///Removes the frame whose timestamp is closest to shutter
+    ///Frames that had not converged are only taken when no other frame is left
+    status_t select(nsecs_t shutter, Frame &frame);
+
+    ///Removes the oldest frame, returns false once the ring is empty
+    bool pop(Frame &frame);
+
+private:
+
+    void remove(unsigned int pos);
+
+    Frame mFrames[MAX_DEPTH];
+    unsigned int mHead;
+    unsigned int mCount;
+    unsigned int mDepth;
+    mutable Mutex mLock;
+};
+
+};
+
+#endif //ZSL_RING_H
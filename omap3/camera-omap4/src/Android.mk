@@ -22,6 +22,8 @@ LOCAL_SRC_FILES:= \
     OverlayDisplayAdapter.cpp \
     CameraProperties.cpp \
     CameraKPI.cpp \
+    ZslRing.cpp \
+    FaceTracker.cpp \
     TICameraParameters.cpp
 
 LOCAL_C_INCLUDES += \
@@ -123,6 +125,7 @@ LOCAL_SRC_FILES:= \
 	BaseCameraAdapter.cpp \
 	OMXCameraAdapter/OMXCap.cpp \
 	OMXCameraAdapter/OMXCameraAdapter.cpp \
+	OMXCameraAdapter/OMX3ATransaction.cpp \
 
 
 LOCAL_C_INCLUDES += \
@@ -227,7 +230,9 @@ include $(BUILD_SHARED_LIBRARY)
 
 include $(CLEAR_VARS)
 
-LOCAL_SRC_FILES:= CameraCalibration/CameraCalibration.cpp
+LOCAL_SRC_FILES:= \
+    CameraCalibration/CameraCalibration.cpp \
+    CameraCalibration/EepromCRC.cpp
 
 LOCAL_C_INCLUDES += \
     bionic/libc/include \
@@ -24,6 +24,7 @@
 
 
 #include "CameraHal.h"
+#include "PixelKernels.h"
 
 
 namespace android {
@@ -45,6 +46,10 @@ status_t AppCallbackNotifier::initialize()
 
     mMeasurementEnabled = false;
 
+    mPreviewGeneration = 0;
+    mLentPreviewFrames = 0;
+    mMaxLentPreviewFrames = 0;
+
     ///Create the app notifier thread
     mNotificationThread = new NotificationThread(this);
     if(!mNotificationThread.get())
@@ -115,7 +120,7 @@ void AppCallbackNotifier::errorNotify(int error)
     msg.command = AppCallbackNotifier::NOTIFIER_CMD_PROCESS_ERROR;
     msg.arg1 = (void*)error;
 
-    mEventQ.put(&msg);
+    mEventQ.put(&msg, MessageQueue::PRIORITY_HIGH);
 
     LOG_FUNCTION_NAME_EXIT
 }
@@ -141,6 +146,7 @@ void AppCallbackNotifier::notificationThread()
 {
     bool shouldLive = true;
     status_t ret;
+    MessageQueue *next;
 
     LOG_FUNCTION_NAME
 
@@ -150,11 +156,13 @@ void AppCallbackNotifier::notificationThread()
         ret = MessageQueue::waitForMsg(&mNotificationThread->msgQ()
                                                         , &mEventQ
                                                         , &mFrameQ
-                                                        , AppCallbackNotifier::NOTIFIER_TIMEOUT);
+                                                        , AppCallbackNotifier::NOTIFIER_TIMEOUT
+                                                        , &next);
 
         //CAMHAL_LOGDA("Notification Thread received message");
 
-        if(!mNotificationThread->msgQ().isEmpty())
+        ///Errors are queued with high priority and are serviced ahead of pending frames
+        if(&mNotificationThread->msgQ() == next)
             {
             ///Received a message from CameraHal, process it
             CAMHAL_LOGDA("Notification Thread received message from Camera HAL");
@@ -164,13 +172,13 @@ void AppCallbackNotifier::notificationThread()
                 CAMHAL_LOGDA("Notification Thread exiting.");
                 }
             }
-        else if(!mEventQ.isEmpty())
+        else if(&mEventQ == next)
             {
             ///Received an event from one of the event providers
             CAMHAL_LOGDA("Notification Thread received an event from event provider (CameraAdapter)");
             notifyEvent();
             }
-        else if(!mFrameQ.isEmpty())
+        else if(&mFrameQ == next)
             {
             ///Received a frame from one of the frame providers
             //CAMHAL_LOGDA("Notification Thread received a frame from frame provider (CameraAdapter)");
@@ -193,10 +201,26 @@ void AppCallbackNotifier::notificationThread()
 
 void AppCallbackNotifier::notifyEvent()
 {
-    ///Receive and send the event notifications to app
-    Message msg;
+    ///Drain the pending events under one queue lock acquisition
+    Message msgs[NOTIFIER_BATCH_SIZE];
+    int count;
+
+    LOG_FUNCTION_NAME
+
+    count = mEventQ.getBatch(msgs, NOTIFIER_BATCH_SIZE);
+
+    for ( int i = 0 ; i < count ; i++ )
+        {
+        processEvent(msgs[i]);
+        }
+
+    LOG_FUNCTION_NAME_EXIT
+}
+
+void AppCallbackNotifier::processEvent(Message &msg)
+{
+    ///Send the event notification to app
     LOG_FUNCTION_NAME
-    mEventQ.get(&msg);
     bool ret = true;
     CameraHalEvent *evt = NULL;
     CameraHalEvent::FocusEventData *focusEvtData;
@@ -312,9 +336,9 @@ void AppCallbackNotifier::notifyEvent()
 static void copy2Dto1D(void *dst, void *src, int width, int height, size_t stride, uint32_t offset, unsigned int bytesPerPixel,
     size_t length, const char *pixelFormat)
 {
+    const PixelKernels *kernels = PixelKernels::get();
     unsigned int alignedRow, row;
-    unsigned char *bufferDst, *bufferSrc, *bufferDstEnd, *bufferSrcEnd;
-    uint16_t *bufferDst_UV, *bufferSrc_UV;
+    uint8_t *bufferDst, *bufferSrc;
 
     if(pixelFormat!=NULL)
         {
@@ -328,75 +352,28 @@ static void copy2Dto1D(void *dst, void *src, int width, int height, size_t strid
             bytesPerPixel = 1;
             uint32_t xOff = offset % PAGE_SIZE;
             uint32_t yOff = offset / PAGE_SIZE;
-            bufferDst = ( unsigned char * ) dst;
-            bufferDstEnd = ( unsigned char * ) dst + width*height*bytesPerPixel;
-            bufferSrc = ( unsigned char * ) (src + offset);
-            bufferSrcEnd = ( unsigned char * ) ( ( size_t ) src + length + offset );
-            row = width*bytesPerPixel;
-            alignedRow = stride-width;
-            int stride_bytes = stride / 8;
             size_t bufferSize_Y = 0;
+            size_t rows;
 
-            //iterate through each row
-            for ( int i = 0 ; i < height ; i++)
-            {
-                memcpy(bufferDst, bufferSrc, row);
-                bufferSrc += stride;
-                bufferDst += row;
-                if ( ( bufferSrc > bufferSrcEnd ) || ( bufferDst > bufferDstEnd ) )
+            bufferDst = ( uint8_t * ) dst;
+            bufferSrc = ( uint8_t * ) src + offset;
+            row = width*bytesPerPixel;
+
+            //Do not read past the end of the luma plane
+            rows = length / stride + 1;
+            if ( rows > ( size_t ) height )
                 {
-                    break;
+                rows = height;
                 }
-            }
 
-            ///Convert NV21 to NV12 by swapping U & V
-            bufferDst_UV = (uint16_t *) (((uint8_t*)dst)+row*height);
+            kernels->copyPacked(bufferDst, bufferSrc, row, rows, stride);
+
+            ///Convert NV12 to NV21 by swapping U & V
+            bufferDst += row*height;
             bufferSize_Y = (( length + offset ) / 3) * 2;
-            bufferSrc_UV = ( uint16_t * ) (((uint8_t*)src) + bufferSize_Y + (stride/2)*yOff + xOff);
+            bufferSrc = ( uint8_t * ) src + bufferSize_Y + (stride/2)*yOff + xOff;
 
-            for(int i = 0 ; i < height/2 ; i++, bufferSrc_UV += alignedRow/2)
-            {
-                int n = width;
-                asm volatile (
-                "   pld [%[src], %[src_stride], lsl #2]                         \n\t"
-                "   cmp %[n], #32                                               \n\t"
-                "   blt 1f                                                      \n\t"
-                "0: @ 32 byte swap                                              \n\t"
-                "   sub %[n], %[n], #32                                         \n\t"
-                "   vld2.8  {q0, q1} , [%[src]]!                                \n\t"
-                "   vswp q0, q1                                                 \n\t"
-                "   cmp %[n], #32                                               \n\t"
-                "   vst2.8  {q0,q1},[%[dst]]!                                   \n\t"
-                "   bge 0b                                                      \n\t"
-                "1: @ Is there enough data?                                     \n\t"
-                "   cmp %[n], #16                                               \n\t"
-                "   blt 3f                                                      \n\t"
-                "2: @ 16 byte swap                                              \n\t"
-                "   sub %[n], %[n], #16                                         \n\t"
-                "   vld2.8  {d0, d1} , [%[src]]!                                \n\t"
-                "   vswp d0, d1                                                 \n\t"
-                "   cmp %[n], #16                                               \n\t"
-                "   vst2.8  {d0,d1},[%[dst]]!                                   \n\t"
-                "   bge 2b                                                      \n\t"
-                "3: @ Is there enough data?                                     \n\t"
-                "   cmp %[n], #8                                                \n\t"
-                "   blt 5f                                                      \n\t"
-                "4: @ 8 byte swap                                               \n\t"
-                "   sub %[n], %[n], #8                                          \n\t"
-                "   vld2.8  {d0, d1} , [%[src]]!                                \n\t"
-                "   vswp d0, d1                                                 \n\t"
-                "   cmp %[n], #8                                                \n\t"
-                "   vst2.8  {d0[0],d1[0]},[%[dst]]!                             \n\t"
-                "   bge 4b                                                      \n\t"
-                "5: @ end                                                       \n\t"
-#ifdef NEEDS_ARM_ERRATA_754319_754320
-                "   vmov s0,s0  @ add noop for errata item                      \n\t"
-#endif
-                : [dst] "+r" (bufferDst_UV), [src] "+r" (bufferSrc_UV), [n] "+r" (n)
-                : [src_stride] "r" (stride_bytes)
-                : "cc", "memory", "q0", "q1"
-                );
-            }
+            kernels->swapUV(bufferDst, bufferSrc, row, height/2, stride);
 
             return ;
 
@@ -407,22 +384,41 @@ static void copy2Dto1D(void *dst, void *src, int width, int height, size_t strid
             }
     }
 
-    bufferDst = ( unsigned char * ) dst;
-    bufferSrc = ( unsigned char * ) src;
+    bufferDst = ( uint8_t * ) dst;
+    bufferSrc = ( uint8_t * ) src;
     row = width*bytesPerPixel;
     alignedRow = ( row + ( stride -1 ) ) & ( ~ ( stride -1 ) );
 
-    //iterate through each row
-    for ( int i = 0 ; i < height ; i++,  bufferSrc += alignedRow, bufferDst += row)
+    kernels->copyPacked(bufferDst, bufferSrc, row, height, alignedRow);
+}
+
+void AppCallbackNotifier::notifyFrame()
+{
+    ///Drain the pending frames under one queue lock acquisition. The batch is
+    ///kept small so that errors and HAL messages are not held up for long
+    Message msgs[NOTIFIER_BATCH_SIZE];
+    int count;
+
+    LOG_FUNCTION_NAME
+
+    if(mFrameQ.isEmpty())
         {
-        memcpy(bufferDst, bufferSrc, row);
+        return;
+        }
+
+    count = mFrameQ.getBatch(msgs, NOTIFIER_BATCH_SIZE);
+
+    for ( int i = 0 ; i < count ; i++ )
+        {
+        processFrame(msgs[i]);
         }
+
+    LOG_FUNCTION_NAME_EXIT
 }
 
-void AppCallbackNotifier::notifyFrame()
+void AppCallbackNotifier::processFrame(Message &msg)
 {
-    ///Receive and send the frame notifications to app
-    Message msg;
+    ///Send the frame notification to app
     CameraFrame *frame;
     MemoryHeapBase *heap;
     MemoryBase *buffer = NULL;
@@ -431,15 +427,6 @@ void AppCallbackNotifier::notifyFrame()
 
     LOG_FUNCTION_NAME
 
-    if(!mFrameQ.isEmpty())
-        {
-    mFrameQ.get(&msg);
-        }
-    else
-        {
-        return;
-        }
-
     bool ret = true;
 
     if(mNotifierState != AppCallbackNotifier::NOTIFIER_STARTED)
@@ -628,6 +615,8 @@ void AppCallbackNotifier::notifyFrame()
                     {
 
                     Mutex::Autolock lock(mLock);
+                    bool frameLent = false;
+
                     if (!mPreviewing)
                     {
                         break;
@@ -636,7 +625,11 @@ void AppCallbackNotifier::notifyFrame()
                     if ( !mMeasurementEnabled )
                         {
 
-                        if(!mAppSupportsStride)
+                        ///Lend the adapter buffer itself when the frame needs no conversion
+                        memBase = lendPreviewFrame(frame);
+                        frameLent = ( NULL != memBase.get() );
+
+                        if( ( !frameLent ) && ( !mAppSupportsStride ) )
                             {
                             buffer = mPreviewBuffers[mPreviewBufCount].get();
                             if(!buffer || !frame->mBuffer)
@@ -645,7 +638,7 @@ void AppCallbackNotifier::notifyFrame()
                                 break;
                                 }
                             }
-                        else
+                        else if( !frameLent )
                             {
 
                             memBase = mSharedPreviewBuffers.valueFor( ( unsigned int ) frame->mBuffer );
@@ -657,7 +650,7 @@ void AppCallbackNotifier::notifyFrame()
                                 }
                             }
 
-                        if(!mAppSupportsStride)
+                        if( ( !frameLent ) && ( !mAppSupportsStride ) )
                             {
                             ///CAMHAL_LOGDB("+Copy 0x%x to 0x%x frame-%dx%d", frame->mBuffer, buffer->pointer(), frame->mWidth,frame->mHeight );
                             ///Copy the data into 1-D buffer
@@ -677,9 +670,15 @@ void AppCallbackNotifier::notifyFrame()
                         ///Give preview callback to app
                         mDataCb(CAMERA_MSG_PREVIEW_FRAME, memBase, mCallbackCookie);
 
+                        ///Lent frames go back to the adapter once the app drops them
+                        memBase.clear();
+
                         }
 
-                    mFrameProvider->returnFrame(frame->mBuffer,  ( CameraFrame::FrameType ) frame->mFrameType);
+                    if ( !frameLent )
+                        {
+                        mFrameProvider->returnFrame(frame->mBuffer,  ( CameraFrame::FrameType ) frame->mFrameType);
+                        }
 
                     }
                 else if(( CameraFrame::FRAME_DATA_SYNC == frame->mFrameType ) &&
@@ -939,12 +938,20 @@ AppCallbackNotifier::~AppCallbackNotifier()
         mEventProvider = NULL;
         }
 
-    if ( NULL != mFrameProvider )
         {
-        ///Deleting the frame provider
-        CAMHAL_LOGDA("Stopping Frame Provider");
-        delete mFrameProvider;
-        mFrameProvider = NULL;
+        Mutex::Autolock lentLock(mLentFramesLock);
+
+        ///Preview frames the app still holds are not returned anymore
+        mPreviewGeneration++;
+        mLentPreviewFrames = 0;
+
+        if ( NULL != mFrameProvider )
+            {
+            ///Deleting the frame provider
+            CAMHAL_LOGDA("Stopping Frame Provider");
+            delete mFrameProvider;
+            mFrameProvider = NULL;
+            }
         }
 
     releaseSharedVideoBuffers();
@@ -1103,7 +1110,12 @@ status_t AppCallbackNotifier::startPreviewCallbacks(CameraParameters &params, vo
                 }
             }
         }
-    else
+
+    ///Stride aware apps always get the adapter buffers. For other apps the buffers are
+    ///mapped as well, so that frames which need no conversion can be lent without a copy
+    if ( ( mAppSupportsStride ) ||
+         ( ( 0 < fd ) && ( NULL != offsets ) &&
+           ( strcmp(mPreviewPixelFormat, (const char *) CameraParameters::PIXEL_FORMAT_YUV420SP) != 0 ) ) )
         {
         bufArr = ( unsigned int * ) buffers;
         for ( unsigned int i = 0 ; i < count ; i ++ )
@@ -1150,6 +1162,14 @@ status_t AppCallbackNotifier::startPreviewCallbacks(CameraParameters &params, vo
 
     mPreviewBufCount = 0;
 
+        {
+        Mutex::Autolock lentLock(mLentFramesLock);
+
+        ///Keep at least half of the buffers circulating between the adapter and the display
+        mLentPreviewFrames = 0;
+        mMaxLentPreviewFrames = count / 2;
+        }
+
     mPreviewing = true;
 
     LOG_FUNCTION_NAME
@@ -1160,6 +1180,88 @@ status_t AppCallbackNotifier::startPreviewCallbacks(CameraParameters &params, vo
 
 }
 
+sp<MemoryBase> AppCallbackNotifier::lendPreviewFrame(CameraFrame *frame)
+{
+    sp<MemoryBase> buffer;
+    size_t size;
+    ssize_t index;
+
+    index = mSharedPreviewHeaps.indexOfKey( ( unsigned int ) frame->mBuffer );
+    if ( 0 > index )
+        {
+        return NULL;
+        }
+
+    if ( mAppSupportsStride )
+        {
+        size = mSharedPreviewBuffers.valueFor( ( unsigned int ) frame->mBuffer )->size();
+        }
+    else
+        {
+        ///Other apps expect packed frames, the same checks copy2Dto1D() would copy by
+        size_t row = frame->mWidth * 2;
+
+        if ( ( 0 == frame->mAlignment ) ||
+             ( 0 != frame->mOffset ) ||
+             ( ( ( row + ( frame->mAlignment - 1 ) ) & ( ~ ( frame->mAlignment - 1 ) ) ) != row ) )
+            {
+            return NULL;
+            }
+
+        size = row * frame->mHeight;
+        }
+
+    Mutex::Autolock lock(mLentFramesLock);
+
+    if ( mLentPreviewFrames >= mMaxLentPreviewFrames )
+        {
+        return NULL;
+        }
+
+    buffer = new PreviewFrameMemory(mSharedPreviewHeaps.valueAt(index), size, this, frame->mBuffer, mPreviewGeneration);
+    if ( NULL == buffer.get() )
+        {
+        return NULL;
+        }
+
+    mLentPreviewFrames++;
+
+    return buffer;
+}
+
+void AppCallbackNotifier::releasePreviewFrame(void *frameBuf, uint32_t generation)
+{
+    ///Held across returnFrame(), so that stopping the preview or deleting
+    ///the frame provider waits until the frame is back with the adapter
+    Mutex::Autolock lock(mLentFramesLock);
+
+    if ( generation != mPreviewGeneration )
+        {
+        return;
+        }
+
+    mLentPreviewFrames--;
+
+    if ( NULL != mFrameProvider )
+        {
+        mFrameProvider->returnFrame(frameBuf, CameraFrame::PREVIEW_FRAME_SYNC);
+        }
+}
+
+AppCallbackNotifier::PreviewFrameMemory::~PreviewFrameMemory()
+{
+    sp<AppCallbackNotifier> notifier = mNotifier.promote();
+
+    ///The notifier and its frame provider are already gone, nobody takes the frame back
+    if ( NULL == notifier.get() )
+        {
+        CAMHAL_LOGDA("Preview frame released after the notifier, dropping it");
+        return;
+        }
+
+    notifier->releasePreviewFrame(mFrameBuf, mGeneration);
+}
+
 sp<IMemoryHeap> AppCallbackNotifier::getPreviewHeap()
 {
 
@@ -1214,21 +1316,29 @@ status_t AppCallbackNotifier::stopPreviewCallbacks()
     mLock.lock();
     bool alreadyStopped = false;
 
-    if(mAppSupportsStride)
         {
-        for ( unsigned int i = 0 ; i < mSharedPreviewHeaps.size() ; i++ )
-            {
-            //Delete the instance
-            heap = mSharedPreviewHeaps.valueAt(i);
-            buffer = mSharedPreviewBuffers.valueAt(i);
-            heap.clear();
-            buffer.clear();
-            }
+        Mutex::Autolock lentLock(mLentFramesLock);
 
-        mSharedPreviewHeaps.clear();
-        mSharedPreviewBuffers.clear();
+        ///Frames still held by the app belong to this session and must not be
+        ///returned to the adapter once it is gone
+        mPreviewGeneration++;
+        mLentPreviewFrames = 0;
+        mMaxLentPreviewFrames = 0;
         }
-    else
+
+    for ( unsigned int i = 0 ; i < mSharedPreviewHeaps.size() ; i++ )
+        {
+        //Delete the instance
+        heap = mSharedPreviewHeaps.valueAt(i);
+        buffer = mSharedPreviewBuffers.valueAt(i);
+        heap.clear();
+        buffer.clear();
+        }
+
+    mSharedPreviewHeaps.clear();
+    mSharedPreviewBuffers.clear();
+
+    if(!mAppSupportsStride)
         {
         for(int i=0;i<AppCallbackNotifier::MAX_BUFFERS;i++)
             {
@@ -21,6 +21,8 @@
 
 #define LOG_TAG "CameraHal"
 
+#include <cutils/atomic.h>
+
 #include "BaseCameraAdapter.h"
 #include "CameraKPI.h"
 
@@ -36,6 +38,7 @@ BaseCameraAdapter::BaseCameraAdapter()
     mEndCaptureData = NULL;
     mReleaseData = NULL;
     mRecording = false;
+    mShutterTimestamp = 0;
 
     mPreviewBuffers = NULL;
     mPreviewBufferCount = 0;
@@ -53,6 +56,10 @@ BaseCameraAdapter::BaseCameraAdapter()
     mPreviewDataBuffersCount = 0;
     mPreviewDataBuffersLength = 0;
 
+    clearFrameBuffers(mPreviewBuffersAvailable);
+    clearFrameBuffers(mCaptureBuffersAvailable);
+    clearFrameBuffers(mPreviewDataBuffersAvailable);
+
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
     mStartFocus.tv_sec = 0;
     mStartFocus.tv_usec = 0;
@@ -292,52 +299,59 @@ void BaseCameraAdapter::disableMsgType(int32_t msgs, void* cookie)
 
 void BaseCameraAdapter::returnFrame(void* frameBuf, CameraFrame::FrameType frameType)
 {
-    status_t res = NO_ERROR;
-    size_t subscriberCount = 0;
-    int refCount = -1;
-
-    Mutex::Autolock lock(mReturnFrameLock);
+    FrameBufferTable *table;
+    int32_t oldCount, newCount, remaining;
+    int shift = 0;
+    int index;
 
     if ( NULL == frameBuf )
         {
         CAMHAL_LOGEA("Invalid frameBuf");
-        res = -EINVAL;
+        return;
         }
 
-    if ( NO_ERROR == res)
+    table = getFrameBufferTable(frameType, shift);
+    if ( NULL == table )
         {
+        return;
+        }
 
-        refCount = getFrameRefCount(frameBuf,  frameType);
-
-        if ( 0 < refCount )
-            {
-
-            refCount--;
-            setFrameRefCount(frameBuf, frameType, refCount);
-
-            if ( ( mRecording ) && (  CameraFrame::VIDEO_FRAME_SYNC == frameType ) )
-                {
-                refCount += getFrameRefCount(frameBuf, CameraFrame::PREVIEW_FRAME_SYNC);
-                }
-            else if ( ( mRecording ) && (  CameraFrame::PREVIEW_FRAME_SYNC == frameType ) )
-                {
-                refCount += getFrameRefCount(frameBuf, CameraFrame::VIDEO_FRAME_SYNC);
-                }
+    index = getFrameIndex(table, frameBuf);
+    if ( 0 > index )
+        {
+        return;
+        }
 
-            }
-        else
+    ///Drop one reference, unless nobody is holding the buffer
+    do
+        {
+        oldCount = android_atomic_acquire_load(&table->refCounts[index]);
+        if ( 0 == ( ( oldCount >> shift ) & REF_COUNT_MASK ) )
             {
             return;
             }
+        newCount = oldCount - ( 1 << shift );
+        }
+    while ( 0 != android_atomic_cmpxchg(oldCount, newCount, &table->refCounts[index]) );
+
+    ///While recording, preview and video subscribers share the same buffers.
+    ///Both counts live in the same word, so whoever drops the last one of either
+    ///kind sees zero and hands the buffer back to the camera.
+    if ( ( mRecording ) &&
+         ( ( CameraFrame::VIDEO_FRAME_SYNC == frameType ) ||
+           ( CameraFrame::PREVIEW_FRAME_SYNC == frameType ) ) )
+        {
+        remaining = newCount;
+        }
+    else
+        {
+        remaining = ( newCount >> shift ) & REF_COUNT_MASK;
         }
 
-    if ( NO_ERROR == res )
+    //check if someone is holding this buffer
+    if ( 0 == remaining )
         {
-        //check if someone is holding this buffer
-        if ( 0 == refCount )
-            {
-            res = fillThisBuffer(frameBuf, frameType);
-            }
+        fillThisBuffer(frameBuf, frameType);
         }
 
 }
@@ -371,12 +385,11 @@ status_t BaseCameraAdapter::sendCommand(int operation, int value1, int value2, i
                         if(desc->mBuffers)
                             {
                         Mutex::Autolock lock(mPreviewBufferLock);
-                        mPreviewBuffers = (int *) desc->mBuffers;
-                        mPreviewBuffersLength = desc->mLength;
-                        mPreviewBuffersAvailable.clear();
-                        for ( uint32_t i = 0 ; i < desc->mCount ; i++ )
+                        ret = setFrameBuffers(mPreviewBuffersAvailable, (int *) desc->mBuffers, desc->mCount, 0);
+                        if ( NO_ERROR == ret )
                             {
-                            mPreviewBuffersAvailable.add(mPreviewBuffers[i], 0);
+                            mPreviewBuffers = (int *) desc->mBuffers;
+                            mPreviewBuffersLength = desc->mLength;
                             }
                         }
                     }
@@ -393,13 +406,12 @@ status_t BaseCameraAdapter::sendCommand(int operation, int value1, int value2, i
                         Mutex::Autolock lock(mPreviewDataBufferLock);
                         if(desc->mBuffers)
                             {
-                        mPreviewDataBuffers = (int *) desc->mBuffers;
-                        mPreviewDataBuffersLength = desc->mLength;
-                        mPreviewDataBuffersAvailable.clear();
-                        for ( uint32_t i = 0 ; i < desc->mCount ; i++ )
+                        ret = setFrameBuffers(mPreviewDataBuffersAvailable, (int *) desc->mBuffers, desc->mCount, 1);
+                        if ( NO_ERROR == ret )
                             {
-                            mPreviewDataBuffersAvailable.add(mPreviewDataBuffers[i], true);
-                                }
+                            mPreviewDataBuffers = (int *) desc->mBuffers;
+                            mPreviewDataBuffersLength = desc->mLength;
+                            }
                             }
                         }
                     }
@@ -413,12 +425,11 @@ status_t BaseCameraAdapter::sendCommand(int operation, int value1, int value2, i
                     if ( ret == NO_ERROR )
                         {
                         Mutex::Autolock lock(mCaptureBufferLock);
-                        mCaptureBuffers = (int *) desc->mBuffers;
-                        mCaptureBuffersLength = desc->mLength;
-                        mCaptureBuffersAvailable.clear();
-                        for ( uint32_t i = 0 ; i < desc->mCount ; i++ )
+                        ret = setFrameBuffers(mCaptureBuffersAvailable, (int *) desc->mBuffers, desc->mCount, 1);
+                        if ( NO_ERROR == ret )
                             {
-                            mCaptureBuffersAvailable.add(mCaptureBuffers[i], true);
+                            mCaptureBuffers = (int *) desc->mBuffers;
+                            mCaptureBuffersLength = desc->mLength;
                             }
                         }
                     }
@@ -427,7 +438,7 @@ status_t BaseCameraAdapter::sendCommand(int operation, int value1, int value2, i
                     CAMHAL_LOGEB("Camera Mode %x still not supported!", mode);
                     }
 
-                if ( NULL != desc )
+                if ( ( NO_ERROR == ret ) && ( NULL != desc ) )
                     {
                     useBuffers(mode, desc->mBuffers, desc->mCount, desc->mLength);
                     }
@@ -502,6 +513,16 @@ status_t BaseCameraAdapter::sendCommand(int operation, int value1, int value2, i
 
 #endif
 
+            //Shutter press from CameraHal, ZSL captures select their frame around it
+            if ( 0 != value2 )
+                {
+                mShutterTimestamp = *( ( nsecs_t * ) value2 );
+                }
+            else
+                {
+                mShutterTimestamp = systemTime(SYSTEM_TIME_MONOTONIC);
+                }
+
             ret = takePicture();
             break;
             }
@@ -712,6 +733,8 @@ status_t BaseCameraAdapter::sendFrameToSubscribers(CameraFrame *frame)
                 case CameraFrame::IMAGE_FRAME:
                     {
 
+                    TRACE_ASYNC_END(CAMTRACE_ShotToJpeg, 0);
+
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
 
                     CameraHal::PPM("Shot to Jpeg: ", &mStartCapture);
@@ -791,41 +814,22 @@ status_t BaseCameraAdapter::sendFrameToSubscribers(CameraFrame *frame)
 
 int BaseCameraAdapter::getFrameRefCount(void* frameBuf, CameraFrame::FrameType frameType)
 {
+    FrameBufferTable *table;
     int res = -1;
+    int shift = 0;
+    int index;
 
     LOG_FUNCTION_NAME
 
-    switch ( frameType )
+    table = getFrameBufferTable(frameType, shift);
+    if ( NULL != table )
         {
-        case CameraFrame::IMAGE_FRAME:
-        case CameraFrame::RAW_FRAME:
-                {
-                Mutex::Autolock lock(mCaptureBufferLock);
-                res = mCaptureBuffersAvailable.valueFor( ( unsigned int ) frameBuf );
-                }
-            break;
-        case CameraFrame::PREVIEW_FRAME_SYNC:
-        case CameraFrame::SNAPSHOT_FRAME:
-                {
-                Mutex::Autolock lock(mPreviewBufferLock);
-                res = mPreviewBuffersAvailable.valueFor( ( unsigned int ) frameBuf );
-                }
-            break;
-        case CameraFrame::FRAME_DATA_SYNC:
-                {
-                Mutex::Autolock lock(mPreviewDataBufferLock);
-                res = mPreviewDataBuffersAvailable.valueFor( ( unsigned int ) frameBuf );
-                }
-            break;
-        case CameraFrame::VIDEO_FRAME_SYNC:
-                {
-                Mutex::Autolock lock(mVideoBufferLock);
-                res = mVideoBuffersAvailable.valueFor( ( unsigned int ) frameBuf );
-                }
-            break;
-        default:
-            break;
-        };
+        index = getFrameIndex(table, frameBuf);
+        if ( 0 <= index )
+            {
+            res = ( android_atomic_acquire_load(&table->refCounts[index]) >> shift ) & REF_COUNT_MASK;
+            }
+        }
 
     LOG_FUNCTION_NAME_EXIT
 
@@ -834,43 +838,136 @@ int BaseCameraAdapter::getFrameRefCount(void* frameBuf, CameraFrame::FrameType f
 
 void BaseCameraAdapter::setFrameRefCount(void* frameBuf, CameraFrame::FrameType frameType, int refCount)
 {
+    FrameBufferTable *table;
+    int32_t oldCount, newCount;
+    int shift = 0;
+    int index;
+
+    LOG_FUNCTION_NAME
+
+    table = getFrameBufferTable(frameType, shift);
+    if ( NULL != table )
+        {
+        index = getFrameIndex(table, frameBuf);
+        if ( 0 <= index )
+            {
+            ///Only replace the half of the counter that belongs to frameType
+            do
+                {
+                oldCount = android_atomic_acquire_load(&table->refCounts[index]);
+                newCount = ( oldCount & ~( REF_COUNT_MASK << shift ) ) |
+                           ( ( refCount & REF_COUNT_MASK ) << shift );
+                }
+            while ( 0 != android_atomic_cmpxchg(oldCount, newCount, &table->refCounts[index]) );
+            }
+        }
+
+    LOG_FUNCTION_NAME_EXIT
+
+}
+
+status_t BaseCameraAdapter::setFrameBuffers(FrameBufferTables &tables, int *buffers, size_t count, int32_t refCount)
+{
+    FrameBufferTable *table;
+    int32_t next;
 
     LOG_FUNCTION_NAME
 
+    if ( NULL == buffers )
+        {
+        count = 0;
+        }
+    else if ( MAX_FRAME_BUFFERS < count )
+        {
+        CAMHAL_LOGEB("Too many buffers %d, at most %d are supported", count, MAX_FRAME_BUFFERS);
+        LOG_FUNCTION_NAME_EXIT
+        return -EINVAL;
+        }
+
+    ///Fill the inactive table, lookups keep using the active one meanwhile
+    next = 1 - android_atomic_acquire_load(&tables.active);
+    table = &tables.tables[next];
+
+    for ( size_t i = 0 ; i < count ; i++ )
+        {
+        table->buffers[i] = buffers[i];
+        android_atomic_release_store(refCount, &table->refCounts[i]);
+        }
+
+    android_atomic_release_store(( int32_t ) count, &table->count);
+    android_atomic_release_store(next, &tables.active);
+
+    LOG_FUNCTION_NAME_EXIT
+
+    return NO_ERROR;
+}
+
+void BaseCameraAdapter::clearFrameBuffers(FrameBufferTables &tables)
+{
+    android_atomic_release_store(0, &tables.active);
+
+    for ( int t = 0 ; t < 2 ; t++ )
+        {
+        android_atomic_release_store(0, &tables.tables[t].count);
+
+        for ( int i = 0 ; i < MAX_FRAME_BUFFERS ; i++ )
+            {
+            tables.tables[t].buffers[i] = 0;
+            android_atomic_release_store(0, &tables.tables[t].refCounts[i]);
+            }
+        }
+}
+
+BaseCameraAdapter::FrameBufferTable* BaseCameraAdapter::getActiveFrameBuffers(FrameBufferTables &tables)
+{
+    return &tables.tables[android_atomic_acquire_load(&tables.active)];
+}
+
+BaseCameraAdapter::FrameBufferTable* BaseCameraAdapter::getFrameBufferTable(CameraFrame::FrameType frameType, int &shift)
+{
+    FrameBufferTable *table = NULL;
+
+    shift = 0;
+
     switch ( frameType )
         {
         case CameraFrame::IMAGE_FRAME:
         case CameraFrame::RAW_FRAME:
-                {
-                Mutex::Autolock lock(mCaptureBufferLock);
-                mCaptureBuffersAvailable.replaceValueFor(  ( unsigned int ) frameBuf, refCount);
-                }
+            table = getActiveFrameBuffers(mCaptureBuffersAvailable);
             break;
         case CameraFrame::PREVIEW_FRAME_SYNC:
         case CameraFrame::SNAPSHOT_FRAME:
-                {
-                Mutex::Autolock lock(mPreviewBufferLock);
-                mPreviewBuffersAvailable.replaceValueFor(  ( unsigned int ) frameBuf, refCount);
-                }
-            break;
-        case CameraFrame::FRAME_DATA_SYNC:
-                {
-                Mutex::Autolock lock(mPreviewDataBufferLock);
-                mPreviewDataBuffersAvailable.replaceValueFor(  ( unsigned int ) frameBuf, refCount);
-                }
+            table = getActiveFrameBuffers(mPreviewBuffersAvailable);
             break;
         case CameraFrame::VIDEO_FRAME_SYNC:
-                {
-                Mutex::Autolock lock(mVideoBufferLock);
-                mVideoBuffersAvailable.replaceValueFor(  ( unsigned int ) frameBuf, refCount);
-                }
+            table = getActiveFrameBuffers(mPreviewBuffersAvailable);
+            shift = VIDEO_REF_SHIFT;
+            break;
+        case CameraFrame::FRAME_DATA_SYNC:
+            table = getActiveFrameBuffers(mPreviewDataBuffersAvailable);
             break;
         default:
             break;
         };
 
-    LOG_FUNCTION_NAME_EXIT
+    return table;
+}
+
+int BaseCameraAdapter::getFrameIndex(FrameBufferTable *table, void *frameBuf)
+{
+    int count = android_atomic_acquire_load(&table->count);
 
+    ///At most MAX_FRAME_BUFFERS entries laid out contiguously, a linear
+    ///scan is cheaper than any search structure here
+    for ( int i = 0 ; i < count ; i++ )
+        {
+        if ( table->buffers[i] == ( int ) frameBuf )
+            {
+            return i;
+            }
+        }
+
+    return -1;
 }
 
 status_t BaseCameraAdapter::setTimeOut(int sec)
@@ -913,10 +1010,13 @@ status_t BaseCameraAdapter::startVideoCapture()
 
     if ( NO_ERROR == ret )
         {
+        FrameBufferTable *table = getActiveFrameBuffers(mPreviewBuffersAvailable);
+        int count = android_atomic_acquire_load(&table->count);
 
-        for ( unsigned int i = 0 ; i < mPreviewBuffersAvailable.size() ; i++ )
+        ///Video frames share the preview buffers, start with no video references
+        for ( int i = 0 ; i < count ; i++ )
             {
-            mVideoBuffersAvailable.add(mPreviewBuffersAvailable.keyAt(i), 0);
+            setFrameRefCount(( void * ) table->buffers[i], CameraFrame::VIDEO_FRAME_SYNC, 0);
             }
 
         mRecording = true;
@@ -940,17 +1040,19 @@ status_t BaseCameraAdapter::stopVideoCapture()
 
     if ( NO_ERROR == ret )
         {
-        for ( unsigned int i = 0 ; i < mVideoBuffersAvailable.size() ; i++ )
+        FrameBufferTable *table = getActiveFrameBuffers(mPreviewBuffersAvailable);
+        int count = android_atomic_acquire_load(&table->count);
+
+        for ( int i = 0 ; i < count ; i++ )
             {
-            void *frameBuf = ( void * ) mVideoBuffersAvailable.keyAt(i);
+            void *frameBuf = ( void * ) table->buffers[i];
             if( getFrameRefCount(frameBuf,  CameraFrame::VIDEO_FRAME_SYNC) > 0)
                 {
                 returnFrame(frameBuf, CameraFrame::VIDEO_FRAME_SYNC);
                 }
+            setFrameRefCount(frameBuf, CameraFrame::VIDEO_FRAME_SYNC, 0);
             }
 
-        mVideoBuffersAvailable.clear();
-
         mRecording = false;
         }
 
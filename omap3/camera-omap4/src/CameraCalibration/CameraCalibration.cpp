@@ -7,6 +7,8 @@
 
 #include "TICameraParameters.h"
 #include "CameraProperties.h"
+#include "BayerStats.h"
+#include "EepromCRC.h"
 
 #define SENSOR_EEPROM_SIZE (256)
 
@@ -154,7 +156,8 @@ corner
     int ee_row, ee_col;
     uint16_t *p_img;
     uint16_t *p_out;
-    int pax_row, pax_col;
+    const BayerStats *stats = BayerStats::get();
+    BayerStats::Zone zone;
     uint32_t r_sum;
     uint32_t gr_sum;
     uint32_t b_sum;
@@ -173,29 +176,17 @@ corner
             p_img = img_buff;
             p_img += (ee_row*400 + 2 + 2) * line_size_bytes/2;
             p_img += ee_col*402 + 0 + 4;
-            r_sum = 0;
-            gr_sum = 0;
-            b_sum = 0;
-            gb_sum = 0;
 
             CAMHAL_LOGEB("ee_row=%d ee_col=%d", \
                                 ee_row, ee_col);
 
             /* IMX046 color pattern = RGGB*/
-            for(pax_row = 0; pax_row<32; pax_row+=2){
-                /* first row is BGBGBG */
-                for(pax_col = 0; pax_col<32; pax_col+=2){
-                    b_sum += *p_img++;
-                    gb_sum += *p_img++;
-                }
-                p_img += line_size_bytes/2 - 32;
-                /* second row is GRGRGRGR */
-                for(pax_col = 0; pax_col<32; pax_col+=2){
-                    gr_sum += *p_img++;
-                    r_sum += *p_img++;
-                }
-                p_img += line_size_bytes/2 - 32;
-            }
+            /* first row is BGBGBG, second row is GRGRGRGR */
+            stats->zoneStats(&zone, p_img, 32, 32, line_size_bytes/2);
+            b_sum = zone.sum[0];
+            gb_sum = zone.sum[1];
+            gr_sum = zone.sum[2];
+            r_sum = zone.sum[3];
 
             r_sum = (r_sum + (32*32/4)/2) / (32*32/4);
             gr_sum = (gr_sum + (32*32/4)/2) / (32*32/4);
@@ -294,38 +285,6 @@ corner
     return ret;
 }
 
-uint16_t calcEepromCRC(uint8_t *pData, uint32_t nStart, uint32_t nEnd)
-{
-    uint16_t crc = 0x0000;
-    uint32_t i,j;
-    uint32_t tmp;
-
-    for(i = nStart; i <= nEnd+2; i ++) {
-        if(i > nEnd) {
-            tmp = 0;
-        } else {
-            tmp = pData[i] & 0xff;
-        }
-        for (j = 0; j < 8; j++)
-        {
-            if (crc & 0x8000) {
-                crc = (crc << 1) ^ 0x8005;
-            } else {
-                crc = (crc << 1);
-            }
-            if(tmp & 0x80) {
-                tmp = tmp << 1;
-                crc = crc ^ 0x0001;
-            } else {
-                tmp = tmp << 1;
-            }
-        }
-    }
-
-    return crc;
-}
-
-
 /**
 *  Check CRC sum of OTP EEPROM data.
 *
@@ -507,6 +466,36 @@ void CamCalCallbackPrv (CameraFrame *cameraFrame){
 
 }
 
+/* Logs per channel levels of the whole RAW frame and how much of it clips */
+void CamCalLogFrameStats(uint16_t *img_buff, int width, int height)
+{
+    const BayerStats *stats = BayerStats::get();
+    BayerStats::Zone zone;
+    uint32_t *hist;
+    uint32_t clipped;
+    int c;
+
+    hist = (uint32_t *) calloc(BayerStats::CHANNELS * BayerStats::HISTOGRAM_BINS, sizeof(uint32_t));
+    if(hist == NULL)
+        return;
+
+    stats->zoneStats(&zone, img_buff, width & ~1, height & ~1, width);
+    stats->histogram(hist, 10, img_buff, width & ~1, height & ~1, width);
+
+    for(c = 0; c < BayerStats::CHANNELS; c++){
+        clipped = hist[c * BayerStats::HISTOGRAM_BINS + PIX_VAL_MAX / 4];
+        for(int bin = PIX_VAL_MAX / 4 + 1; bin < BayerStats::HISTOGRAM_BINS; bin++)
+            clipped += hist[c * BayerStats::HISTOGRAM_BINS + bin];
+
+        CAMHAL_LOGEB("channel %d: min=%d max=%d mean=%d, %d pixels at %d or above", c,
+                     zone.min[c], zone.max[c],
+                     (int) (zone.sum[c] / ((width / 2) * (height / 2))),
+                     clipped, PIX_VAL_MAX);
+    }
+
+    free(hist);
+}
+
 void CamCalCallbackImg (CameraFrame *cameraFrame)
 {
     int RetL;
@@ -514,6 +503,8 @@ void CamCalCallbackImg (CameraFrame *cameraFrame)
         CamCalRet = CamCalSaveFile(options_raw_out_file, cameraFrame->mBuffer, cameraFrame->mLength, FILE_SAVE_TYPE_DEBUG_IMAGE);
         if(CamCalRet != CAMCAL_ERR_NOERROR)
             goto out;
+
+        CamCalLogFrameStats((uint16_t*)cameraFrame->mBuffer, img_width, img_height);
     }
 
     CamCalRet = parse_eeprom_data((uint16_t*)cameraFrame->mBuffer, img_width * 2, eeprom_buff);
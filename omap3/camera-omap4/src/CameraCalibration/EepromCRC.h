@@ -0,0 +1,9 @@
+#ifndef EEPROM_CRC_H
+#define EEPROM_CRC_H
+
+#include <stdint.h>
+
+/* CRC-16 of the OTP EEPROM bytes nStart to nEnd, both included */
+uint16_t calcEepromCRC(uint8_t *pData, uint32_t nStart, uint32_t nEnd);
+
+#endif //EEPROM_CRC_H
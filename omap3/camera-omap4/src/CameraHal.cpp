@@ -30,6 +30,7 @@
 #include "OverlayDisplayAdapter.h"
 #include "TICameraParameters.h"
 #include "CameraProperties.h"
+#include "ZslRing.h"
 #include "overlay_common.h"
 #include <cutils/properties.h>
 
@@ -309,7 +310,8 @@ status_t CameraHal::setParameters(const CameraParameters &newParams)
 
         CAMHAL_LOGDB("PreviewFormat %s", params.getPreviewFormat());
 
-        if ( !isParameterValid(params.getPreviewFormat(), (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FORMATS]->mPropValue))
+        if ( !isParameterUnchanged(params, CameraParameters::KEY_PREVIEW_FORMAT) &&
+             !isParameterValid(params.getPreviewFormat(), CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FORMATS))
             {
             CAMHAL_LOGEB("Invalid preview format %s",  (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FORMATS]->mPropValue);
             ret = -EINVAL;
@@ -325,7 +327,8 @@ status_t CameraHal::setParameters(const CameraParameters &newParams)
           }
 
         params.getPreviewSize(&w, &h);
-        if ( !isResolutionValid(w, h, (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_SIZES]->mPropValue))
+        if ( !isParameterUnchanged(params, CameraParameters::KEY_PREVIEW_SIZE) &&
+             !isResolutionValid(w, h, CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_SIZES))
             {
             CAMHAL_LOGEB("Invalid preview resolution %d x %d", w, h);
             ret = -EINVAL;
@@ -386,8 +389,8 @@ status_t CameraHal::setParameters(const CameraParameters &newParams)
         }
 
     ///Below parameters can be changed when the preview is running
-    if ( !isParameterValid(params.getPictureFormat(),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PICTURE_FORMATS]->mPropValue))
+    if ( !isParameterUnchanged(params, CameraParameters::KEY_PICTURE_FORMAT) &&
+         !isParameterValid(params.getPictureFormat(), CameraProperties::PROP_INDEX_SUPPORTED_PICTURE_FORMATS))
         {
         CAMHAL_LOGEA("Invalid picture format");
         ret = -EINVAL;
@@ -400,7 +403,8 @@ status_t CameraHal::setParameters(const CameraParameters &newParams)
         }
 
     params.getPictureSize(&w, &h);
-    if ( !isResolutionValid(w, h, (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PICTURE_SIZES]->mPropValue))
+    if ( !isParameterUnchanged(params, CameraParameters::KEY_PICTURE_SIZE) &&
+         !isResolutionValid(w, h, CameraProperties::PROP_INDEX_SUPPORTED_PICTURE_SIZES))
         {
         CAMHAL_LOGEB("Invalid picture resolution %dx%d", w, h);
         ret = -EINVAL;
@@ -419,10 +423,28 @@ status_t CameraHal::setParameters(const CameraParameters &newParams)
         mParameters.set(TICameraParameters::KEY_BURST, valstr);
         }
 
+    ///Number of full resolution frames kept for zero shutter lag, 0 turns it off.
+    ///Adapters without a ZSL ring reject a nonzero depth in their setParameters()
+    if( (valstr = params.get(TICameraParameters::KEY_ZSL_DEPTH)) != NULL )
+        {
+        if ( ( params.getInt(TICameraParameters::KEY_ZSL_DEPTH) < 0 ) ||
+             ( params.getInt(TICameraParameters::KEY_ZSL_DEPTH) > ZslRing::MAX_DEPTH ) )
+            {
+            CAMHAL_LOGEB("Invalid ZSL depth %s", valstr);
+            ret = -EINVAL;
+            }
+        else
+            {
+            CAMHAL_LOGDB("ZSL depth set %s", valstr);
+            mParameters.set(TICameraParameters::KEY_ZSL_DEPTH, valstr);
+            }
+        }
+
 
     /// Check the frame rate and update mParameters if the passed frame rate is a valid one
     framerate = params.getPreviewFrameRate();
-    if ( isParameterValid(framerate, (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FRAME_RATES]->mPropValue))
+    if ( isParameterUnchanged(params, CameraParameters::KEY_PREVIEW_FRAME_RATE) ||
+         isParameterValid(framerate, CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FRAME_RATES))
         {
         mParameters.setPreviewFrameRate(framerate);
         }
@@ -506,16 +528,16 @@ status_t CameraHal::setParameters(const CameraParameters &newParams)
         }
 
     if( ((valstr = params.get(TICameraParameters::KEY_EXPOSURE_MODE)) != NULL)
-        && isParameterValid(params.get(TICameraParameters::KEY_EXPOSURE_MODE),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EXPOSURE_MODES]->mPropValue))
+        && ( isParameterUnchanged(params, TICameraParameters::KEY_EXPOSURE_MODE) ||
+             isParameterValid(valstr, CameraProperties::PROP_INDEX_SUPPORTED_EXPOSURE_MODES) ) )
         {
         CAMHAL_LOGDB("Exposure set = %s", params.get(TICameraParameters::KEY_EXPOSURE_MODE));
         mParameters.set(TICameraParameters::KEY_EXPOSURE_MODE, valstr);
         }
 
     if( ((valstr = params.get(CameraParameters::KEY_WHITE_BALANCE)) != NULL)
-        && isParameterValid(params.get(CameraParameters::KEY_WHITE_BALANCE),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_WHITE_BALANCE]->mPropValue))
+        && ( isParameterUnchanged(params, CameraParameters::KEY_WHITE_BALANCE) ||
+             isParameterValid(valstr, CameraProperties::PROP_INDEX_SUPPORTED_WHITE_BALANCE) ) )
         {
         CAMHAL_LOGDB("White balance set %s", params.get(CameraParameters::KEY_WHITE_BALANCE));
         mParameters.set(CameraParameters::KEY_WHITE_BALANCE, valstr);
@@ -551,24 +573,24 @@ status_t CameraHal::setParameters(const CameraParameters &newParams)
 
 
     if( ((valstr = params.get(CameraParameters::KEY_ANTIBANDING)) != NULL)
-        && isParameterValid(params.get(CameraParameters::KEY_ANTIBANDING),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ANTIBANDING]->mPropValue))
+        && ( isParameterUnchanged(params, CameraParameters::KEY_ANTIBANDING) ||
+             isParameterValid(valstr, CameraProperties::PROP_INDEX_SUPPORTED_ANTIBANDING) ) )
         {
         CAMHAL_LOGDB("Antibanding set %s", params.get(CameraParameters::KEY_ANTIBANDING));
         mParameters.set(CameraParameters::KEY_ANTIBANDING, valstr);
         }
 
     if( ((valstr = params.get(TICameraParameters::KEY_ISO)) != NULL)
-        && isParameterValid(params.get(TICameraParameters::KEY_ISO),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ISO_VALUES]->mPropValue))
+        && ( isParameterUnchanged(params, TICameraParameters::KEY_ISO) ||
+             isParameterValid(valstr, CameraProperties::PROP_INDEX_SUPPORTED_ISO_VALUES) ) )
         {
         CAMHAL_LOGDB("ISO set %s", params.get(TICameraParameters::KEY_ISO));
         mParameters.set(TICameraParameters::KEY_ISO, valstr);
         }
 
     if( ((valstr = params.get(CameraParameters::KEY_FOCUS_MODE)) != NULL)
-        && isParameterValid(params.get(CameraParameters::KEY_FOCUS_MODE),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_FOCUS_MODES]->mPropValue))
+        && ( isParameterUnchanged(params, CameraParameters::KEY_FOCUS_MODE) ||
+             isParameterValid(valstr, CameraProperties::PROP_INDEX_SUPPORTED_FOCUS_MODES) ) )
         {
         CAMHAL_LOGDB("Focus mode set %s", params.get(CameraParameters::KEY_FOCUS_MODE));
         mParameters.set(CameraParameters::KEY_FOCUS_MODE, valstr);
@@ -638,24 +660,24 @@ status_t CameraHal::setParameters(const CameraParameters &newParams)
         }
 
     if(( (valstr = params.get(CameraParameters::KEY_SCENE_MODE)) != NULL)
-        && isParameterValid(params.get(CameraParameters::KEY_SCENE_MODE),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_SCENE_MODES]->mPropValue))
+        && ( isParameterUnchanged(params, CameraParameters::KEY_SCENE_MODE) ||
+             isParameterValid(valstr, CameraProperties::PROP_INDEX_SUPPORTED_SCENE_MODES) ) )
         {
         CAMHAL_LOGDB("Scene mode set %s", params.get(CameraParameters::KEY_SCENE_MODE));
         mParameters.set(CameraParameters::KEY_SCENE_MODE, valstr);
         }
 
     if(( (valstr = params.get(CameraParameters::KEY_FLASH_MODE)) != NULL)
-        && isParameterValid(params.get(CameraParameters::KEY_FLASH_MODE),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_FLASH_MODES]->mPropValue))
+        && ( isParameterUnchanged(params, CameraParameters::KEY_FLASH_MODE) ||
+             isParameterValid(valstr, CameraProperties::PROP_INDEX_SUPPORTED_FLASH_MODES) ) )
         {
         CAMHAL_LOGDB("Flash mode set %s", params.get(CameraParameters::KEY_FLASH_MODE));
         mParameters.set(CameraParameters::KEY_FLASH_MODE, valstr);
         }
 
     if(( (valstr = params.get(CameraParameters::KEY_EFFECT)) != NULL)
-        && isParameterValid(params.get(CameraParameters::KEY_EFFECT),
-        (const char*) mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EFFECTS]->mPropValue))
+        && ( isParameterUnchanged(params, CameraParameters::KEY_EFFECT) ||
+             isParameterValid(valstr, CameraProperties::PROP_INDEX_SUPPORTED_EFFECTS) ) )
         {
         CAMHAL_LOGDB("Effect set %s", params.get(CameraParameters::KEY_EFFECT));
         mParameters.set(CameraParameters::KEY_EFFECT, valstr);
@@ -1453,6 +1475,8 @@ status_t CameraHal::startPreview()
     size_t frameDataSize;
     const char *valstr = NULL;
 
+    TRACE_ASYNC_BEGIN(CAMTRACE_StandbyToShot, 0);
+
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
 
         gettimeofday(&mStartPreview, NULL);
@@ -2018,6 +2042,7 @@ status_t CameraHal::startRecording( )
 
     LOG_FUNCTION_NAME
 
+    TRACE_ASYNC_BEGIN(CAMTRACE_StandbyToShot, 0);
 
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
 
@@ -2308,6 +2333,8 @@ status_t CameraHal::startImageBracketing()
         int width, height;
         size_t pictureBufferLength;
 
+        TRACE_ASYNC_BEGIN(CAMTRACE_ShotToJpeg, 0);
+
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
 
         gettimeofday(&mStartCapture, NULL);
@@ -2436,6 +2463,12 @@ status_t CameraHal::takePicture( )
 
     Mutex::Autolock lock(mLock);
 
+    TRACE_ASYNC_BEGIN(CAMTRACE_ShotToSnapshot, 0);
+    TRACE_ASYNC_BEGIN(CAMTRACE_ShotToShot, 0);
+    TRACE_ASYNC_BEGIN(CAMTRACE_ShotToJpeg, 0);
+
+    mShutterTimestamp = systemTime(SYSTEM_TIME_MONOTONIC);
+
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
 
     gettimeofday(&mStartCapture, NULL);
@@ -2562,11 +2595,13 @@ status_t CameraHal::takePicture( )
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
 
          //pass capture timestamp along with the camera adapter command
-        ret = mCameraAdapter->sendCommand(CameraAdapter::CAMERA_START_IMAGE_CAPTURE,  (int) &mStartCapture);
+        ret = mCameraAdapter->sendCommand(CameraAdapter::CAMERA_START_IMAGE_CAPTURE,  (int) &mStartCapture,
+                                          (int) &mShutterTimestamp);
 
 #else
 
-        ret = mCameraAdapter->sendCommand(CameraAdapter::CAMERA_START_IMAGE_CAPTURE);
+        ret = mCameraAdapter->sendCommand(CameraAdapter::CAMERA_START_IMAGE_CAPTURE, 0,
+                                          (int) &mShutterTimestamp);
 
 #endif
 
@@ -2889,6 +2924,9 @@ CameraHal::CameraHal(int cameraId)
 
 #endif
 
+    ///No-op unless debug.camera.trace is set, or when already tracing
+    CameraKPI::startTrace();
+
     mCameraIndex = cameraId;
 
     mReloadAdapter = false;
@@ -2924,6 +2962,7 @@ CameraHal::~CameraHal()
     if(deleteProperties)
     {
         gCameraProperties.clear();
+        CameraKPI::stopTrace();
         mInstanceCond.signal();
     }
 
@@ -3212,18 +3251,17 @@ void CameraHal::dumpProperties(CameraProperties::CameraProperty** cameraProps)
         }
 }
 
-bool CameraHal::isResolutionValid(unsigned int width, unsigned int height, const char *supportedResolutions)
+bool CameraHal::isResolutionValid(unsigned int width, unsigned int height, CameraProperties::CameraPropertyIndex supported)
 {
     bool ret = true;
     status_t status = NO_ERROR;
     char tmpBuffer[PARAM_BUFFER + 1];
-    char *pos = NULL;
 
     LOG_FUNCTION_NAME
 
-    if ( NULL == supportedResolutions )
+    if ( NULL == mCameraPropertiesArr[supported] )
         {
-        CAMHAL_LOGEA("Invalid supported resolutions string");
+        CAMHAL_LOGEA("Invalid supported resolutions property");
         ret = false;
         goto exit;
         }
@@ -3236,15 +3274,7 @@ bool CameraHal::isResolutionValid(unsigned int width, unsigned int height, const
         goto exit;
         }
 
-    pos = strstr(supportedResolutions, tmpBuffer);
-    if ( NULL == pos )
-        {
-        ret = false;
-        }
-    else
-        {
-        ret = true;
-        }
+    ret = mCameraPropertiesArr[supported]->mValueSet.contains(tmpBuffer);
 
 exit:
 
@@ -3253,16 +3283,15 @@ exit:
     return ret;
 }
 
-bool CameraHal::isParameterValid(const char *param, const char *supportedParams)
+bool CameraHal::isParameterValid(const char *param, CameraProperties::CameraPropertyIndex supported)
 {
     bool ret = true;
-    char *pos = NULL;
 
     LOG_FUNCTION_NAME
 
-    if ( NULL == supportedParams )
+    if ( NULL == mCameraPropertiesArr[supported] )
         {
-        CAMHAL_LOGEA("Invalid supported parameters string");
+        CAMHAL_LOGEA("Invalid supported parameters property");
         ret = false;
         goto exit;
         }
@@ -3274,15 +3303,7 @@ bool CameraHal::isParameterValid(const char *param, const char *supportedParams)
         goto exit;
         }
 
-    pos = strstr(supportedParams, param);
-    if ( NULL == pos )
-        {
-        ret = false;
-        }
-    else
-        {
-        ret = true;
-        }
+    ret = mCameraPropertiesArr[supported]->mValueSet.contains(param);
 
 exit:
 
@@ -3291,18 +3312,17 @@ exit:
     return ret;
 }
 
-bool CameraHal::isParameterValid(int param, const char *supportedParams)
+bool CameraHal::isParameterValid(int param, CameraProperties::CameraPropertyIndex supported)
 {
     bool ret = true;
-    char *pos = NULL;
     status_t status;
     char tmpBuffer[PARAM_BUFFER + 1];
 
     LOG_FUNCTION_NAME
 
-    if ( NULL == supportedParams )
+    if ( NULL == mCameraPropertiesArr[supported] )
         {
-        CAMHAL_LOGEA("Invalid supported parameters string");
+        CAMHAL_LOGEA("Invalid supported parameters property");
         ret = false;
         goto exit;
         }
@@ -3315,15 +3335,7 @@ bool CameraHal::isParameterValid(int param, const char *supportedParams)
         goto exit;
         }
 
-    pos = strstr(supportedParams, tmpBuffer);
-    if ( NULL == pos )
-        {
-        ret = false;
-        }
-    else
-        {
-        ret = true;
-        }
+    ret = mCameraPropertiesArr[supported]->mValueSet.contains(tmpBuffer);
 
 exit:
 
@@ -3332,6 +3344,19 @@ exit:
     return ret;
 }
 
+bool CameraHal::isParameterUnchanged(const CameraParameters &params, const char *key)
+{
+    const char *newValue = params.get(key);
+    const char *oldValue = mParameters.get(key);
+
+    if ( ( NULL == newValue ) || ( NULL == oldValue ) )
+        {
+        return false;
+        }
+
+    return ( 0 == strcmp(newValue, oldValue) );
+}
+
 status_t CameraHal::parseResolution(const char *resStr, int &width, int &height)
 {
     status_t ret = NO_ERROR;
@@ -3462,190 +3487,163 @@ void CameraHal::extractSupportedParams()
     pStr = p.get(CameraParameters::KEY_SUPPORTED_PICTURE_SIZES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PICTURE_SIZES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PICTURE_SIZES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_PICTURE_FORMATS);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PICTURE_FORMATS]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PICTURE_FORMATS]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_PREVIEW_SIZES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_SIZES]->mPropValue,
-                       pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_SIZES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_PREVIEW_FORMATS);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FORMATS]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FORMATS]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_PREVIEW_FRAME_RATES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FRAME_RATES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_PREVIEW_FRAME_RATES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_JPEG_THUMBNAIL_SIZES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_THUMBNAIL_SIZES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_THUMBNAIL_SIZES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_WHITE_BALANCE);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_WHITE_BALANCE]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_WHITE_BALANCE]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_EFFECTS);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EFFECTS]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH -1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EFFECTS]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_SCENE_MODES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_SCENE_MODES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_SCENE_MODES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_FOCUS_MODES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_FOCUS_MODES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_FOCUS_MODES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_ANTIBANDING);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ANTIBANDING]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ANTIBANDING]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_FLASH_MODES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_FLASH_MODES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_FLASH_MODES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_MAX_EXPOSURE_COMPENSATION);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EV_MAX]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EV_MAX]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_MIN_EXPOSURE_COMPENSATION);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EV_MIN]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EV_MIN]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_EXPOSURE_COMPENSATION_STEP);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EV_STEP]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EV_STEP]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_SCENE_MODES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_SCENE_MODES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_SCENE_MODES]->setValue(pStr);
         }
 
     pStr = p.get(TICameraParameters::KEY_SUPPORTED_EXPOSURE);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EXPOSURE_MODES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_EXPOSURE_MODES]->setValue(pStr);
         }
 
     pStr = p.get(TICameraParameters::KEY_SUPPORTED_ISO_VALUES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ISO_VALUES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ISO_VALUES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_ZOOM_RATIOS);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ZOOM_RATIOS]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ZOOM_RATIOS]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_MAX_ZOOM);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ZOOM_STAGES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_ZOOM_STAGES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_ZOOM_SUPPORTED);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_ZOOM_SUPPORTED]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_ZOOM_SUPPORTED]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SMOOTH_ZOOM_SUPPORTED);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SMOOTH_ZOOM_SUPPORTED]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SMOOTH_ZOOM_SUPPORTED]->setValue(pStr);
         }
 
     pStr = p.get(TICameraParameters::KEY_SUPPORTED_IPP);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_IPP_MODES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_IPP_MODES]->setValue(pStr);
         }
 
     pStr = p.get(TICameraParameters::KEY_S3D_SUPPORTED);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_S3D_SUPPORTED]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_S3D_SUPPORTED]->setValue(pStr);
         }
 
     pStr = p.get(TICameraParameters::KEY_MANUALCONVERGENCE_VALUES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_MANUALCONVERGENCE_VALUES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_MANUALCONVERGENCE_VALUES]->setValue(pStr);
         }
 
     pStr = p.get(CameraParameters::KEY_SUPPORTED_PREVIEW_FPS_RANGE);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_FRAMERATE_RANGE_SUPPORTED]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_FRAMERATE_RANGE_SUPPORTED]->setValue(pStr);
         }
 
     pStr = p.get(TICameraParameters::KEY_SUPPORTED_MOT_HDR_MODES);
     if ( NULL != pStr )
         {
-        strncpy(mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_MOT_HDR_MODES]->mPropValue,
-                      pStr, MAX_PROP_VALUE_LENGTH - 1);
+        mCameraPropertiesArr[CameraProperties::PROP_INDEX_SUPPORTED_MOT_HDR_MODES]->setValue(pStr);
         }
 
     LOG_FUNCTION_NAME_EXIT
@@ -29,8 +29,28 @@
 
 #define MAX_STR_SIZE 12
 
+//Output file of the trace points, tracing is off when unset
+#define TRACE_FILE_PROPERTY  "debug.camera.trace"
+
 namespace android {
 
+static const char * const sTraceNames[CAMTRACE_Max] = {
+     "KPI AF"
+    ,"KPI Shutter"
+    ,"KPI Raw"
+    ,"KPI JPG"
+    ,"KPI Postview"
+    ,"KPI Preview"
+    ,"KPI JPG to preview"
+    ,"KPI Restart preview"
+    ,"KPI Construct"
+    ,"Standby to first shot"
+    ,"Shot to snapshot"
+    ,"Shot to shot"
+    ,"Shot to Jpeg"
+    ,"Frames with display"
+};
+
 //=========================================================
 // Public Interface
 //=========================================================
@@ -62,6 +82,8 @@ CameraKPI::~CameraKPI()
 //=========================================================
 void CameraKPI::startKPITimer(CameraKPIType tmtype)
 {
+    TRACE_ASYNC_BEGIN(CAMTRACE_KPI_AF + tmtype, 0);
+
 #ifdef CAM_PERF
 
     switch (tmtype)
@@ -136,6 +158,8 @@ void CameraKPI::stopKPITimer(CameraKPIType tmtype)
 void CameraKPI::stopKPITimer(CameraKPIType tmtype,
                              CameraKPIStatusType status)
 {
+    TRACE_ASYNC_END(CAMTRACE_KPI_AF + tmtype, 0);
+
 #ifdef CAM_PERF
 
     long long time_elapsed = 0;
@@ -244,6 +268,31 @@ void CameraKPI::stopKPITimer(CameraKPIType tmtype,
 #endif //CAM_PERF
 }
 
+//=========================================================
+// startTrace - Start recording the trace points
+//
+// Notes: Only when debug.camera.trace names the output
+//        file, e.g. /data/misc/camera/trace.json
+//=========================================================
+void CameraKPI::startTrace()
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    if ( ( property_get(TRACE_FILE_PROPERTY, value, "") > 0 ) && ( '\0' != value[0] ) )
+    {
+        TraceRing::setEventNames(sTraceNames, CAMTRACE_Max);
+        if ( TraceRing::start(value) == NO_ERROR )
+            LOGD("KPI: tracing to %s", value);
+    }
+}
+
+//=========================================================
+// stopTrace - Stop recording and complete the trace file
+//=========================================================
+void CameraKPI::stopTrace()
+{
+    TraceRing::stop();
+}
 
 //=========================================================
 // Private Interface
@@ -1557,10 +1557,161 @@ status_t CameraProperties::CameraProperty::setValue(const char * value)
         return BAD_VALUE;
         }
     strncpy(mPropValue, value, sizeof(mPropValue)-1);
+    mPropValue[sizeof(mPropValue)-1] = '\0';
     CAMHAL_LOGVB("mPropValue = %s", mPropValue);
+    return mValueSet.compile(mPropValue);
+}
+
+CameraProperties::ValueSet::ValueSet() : mValues(NULL), mEntries(NULL), mMask(0), mCount(0)
+{
+}
+
+CameraProperties::ValueSet::~ValueSet()
+{
+    delete [] mEntries;
+}
+
+///FNV-1a
+uint32_t CameraProperties::ValueSet::hash(const char *value, size_t length)
+{
+    uint32_t h = 2166136261U;
+
+    for ( size_t i = 0 ; i < length ; i++ )
+        {
+        h ^= ( uint8_t ) value[i];
+        h *= 16777619U;
+        }
+
+    return h;
+}
+
+status_t CameraProperties::ValueSet::compile(const char *values)
+{
+    const char *pos, *end;
+    unsigned int tokens = 0;
+    uint32_t size = 1;
+
+    delete [] mEntries;
+    mEntries = NULL;
+    mMask = 0;
+    mCount = 0;
+    mValues = values;
+
+    if ( NULL == values )
+        {
+        return NO_ERROR;
+        }
+
+    for ( pos = values ; '\0' != *pos ; pos++ )
+        {
+        if ( PARAMS_DELIMITER[0] == *pos )
+            {
+            tokens++;
+            }
+        }
+    tokens++;
+
+    ///Keep the table at most half full, probes stay short
+    while ( size < ( tokens * 2 ) )
+        {
+        size <<= 1;
+        }
+
+    mEntries = new Entry[size];
+    if ( NULL == mEntries )
+        {
+        return NO_MEMORY;
+        }
+
+    memset(mEntries, 0, size * sizeof(Entry));
+    mMask = size - 1;
+
+    for ( pos = values ; '\0' != *pos ; pos = ( '\0' != *end ) ? ( end + 1 ) : end )
+        {
+        const char *start = pos;
+        const char *stop;
+
+        end = strchr(start, PARAMS_DELIMITER[0]);
+        if ( NULL == end )
+            {
+            end = start + strlen(start);
+            }
+
+        ///Entries written as "a, b" are matched without the blanks
+        stop = end;
+        while ( ( start < stop ) && ( ' ' == *start ) )
+            {
+            start++;
+            }
+        while ( ( stop > start ) && ( ' ' == stop[-1] ) )
+            {
+            stop--;
+            }
+
+        if ( start == stop )
+            {
+            continue;
+            }
+
+        uint16_t length = ( uint16_t ) ( stop - start );
+        uint32_t h = hash(start, length);
+        uint32_t i = h & mMask;
+        bool duplicate = false;
+
+        while ( 0 != mEntries[i].mLength )
+            {
+            if ( ( mEntries[i].mHash == h ) &&
+                 ( mEntries[i].mLength == length ) &&
+                 ( 0 == memcmp(values + mEntries[i].mOffset, start, length) ) )
+                {
+                duplicate = true;
+                break;
+                }
+            i = ( i + 1 ) & mMask;
+            }
+
+        if ( !duplicate )
+            {
+            mEntries[i].mHash = h;
+            mEntries[i].mOffset = ( uint16_t ) ( start - values );
+            mEntries[i].mLength = length;
+            mCount++;
+            }
+        }
+
     return NO_ERROR;
 }
 
+bool CameraProperties::ValueSet::contains(const char *value) const
+{
+    size_t length;
+    uint32_t h, i;
+
+    if ( ( NULL == value ) || ( 0 == mCount ) )
+        {
+        return false;
+        }
+
+    length = strlen(value);
+    if ( ( 0 == length ) || ( MAX_PROP_VALUE_LENGTH <= length ) )
+        {
+        return false;
+        }
+
+    h = hash(value, length);
+    for ( i = h & mMask ; 0 != mEntries[i].mLength ; i = ( i + 1 ) & mMask )
+        {
+        if ( ( mEntries[i].mHash == h ) &&
+             ( mEntries[i].mLength == length ) &&
+             ( 0 == memcmp(mValues + mEntries[i].mOffset, value, length) ) )
+            {
+            return true;
+            }
+        }
+
+    return false;
+}
+
 
 };
 
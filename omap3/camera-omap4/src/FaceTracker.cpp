@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FaceTracker.h"
+
+namespace android {
+
+#define Q8_SHIFT    8
+#define Q8_HALF     ( 1 << ( Q8_SHIFT - 1 ) )
+
+static const FaceTracker::Config sDefaultConfig =
+{
+    30, ///mMinOverlap
+    40, ///mSmoothing
+    3,  ///mDeadBand
+    2,  ///mConfirmFrames
+    3,  ///mHoldFrames
+    15, ///mRegionThreshold
+};
+
+///Intersection over union of two boxes, in percent
+static unsigned int overlap(const FaceTracker::Face &a, const FaceTracker::Face &b)
+{
+    int64_t left = ( a.mLeft > b.mLeft ) ? a.mLeft : b.mLeft;
+    int64_t top = ( a.mTop > b.mTop ) ? a.mTop : b.mTop;
+    int64_t right = ( a.mLeft + a.mWidth < b.mLeft + b.mWidth ) ? a.mLeft + a.mWidth : b.mLeft + b.mWidth;
+    int64_t bottom = ( a.mTop + a.mHeight < b.mTop + b.mHeight ) ? a.mTop + a.mHeight : b.mTop + b.mHeight;
+    int64_t intersection, area;
+
+    if ( ( right <= left ) || ( bottom <= top ) )
+        {
+        return 0;
+        }
+
+    intersection = ( right - left ) * ( bottom - top );
+    area = ( int64_t ) a.mWidth * a.mHeight + ( int64_t ) b.mWidth * b.mHeight - intersection;
+
+    return ( 0 < area ) ? ( unsigned int ) ( intersection * 100 / area ) : 0;
+}
+
+static inline int32_t distance(int32_t a, int32_t b)
+{
+    return ( a > b ) ? a - b : b - a;
+}
+
+FaceTracker::FaceTracker()
+{
+    mConfig = sDefaultConfig;
+    reset();
+}
+
+void FaceTracker::setConfig(const Config &config)
+{
+    mConfig = config;
+
+    if ( 0 == mConfig.mConfirmFrames )
+        {
+        mConfig.mConfirmFrames = 1;
+        }
+
+    if ( 100 < mConfig.mSmoothing )
+        {
+        mConfig.mSmoothing = 100;
+        }
+}
+
+void FaceTracker::reset()
+{
+    memset(mSlots, 0, sizeof(mSlots));
+    memset(&mRegion, 0, sizeof(mRegion));
+    mNextId = 1;
+    mReportedCount = 0;
+    mRegionId = 0;
+    mRegionValid = false;
+}
+
+void FaceTracker::filter(Slot &slot, const Face &face)
+{
+    const int32_t box[4] = { face.mLeft, face.mTop, face.mWidth, face.mHeight };
+
+    for ( int i = 0 ; i < 4 ; i++ )
+        {
+        int32_t target = box[i] << Q8_SHIFT;
+
+        slot.mBox[i] += ( int32_t ) ( ( ( int64_t ) ( target - slot.mBox[i] ) * mConfig.mSmoothing ) / 100 );
+        }
+
+    ///The reported box only follows moves past the dead band
+    Face &reported = slot.mTrack.mFace;
+    int32_t *values[4] = { &reported.mLeft, &reported.mTop, &reported.mWidth, &reported.mHeight };
+    int32_t deadBand = ( reported.mWidth * ( int32_t ) mConfig.mDeadBand ) / 100;
+
+    for ( int i = 0 ; i < 4 ; i++ )
+        {
+        int32_t value = ( slot.mBox[i] + Q8_HALF ) >> Q8_SHIFT;
+
+        if ( distance(value, *values[i]) > deadBand )
+            {
+            *values[i] = value;
+            }
+        }
+
+    slot.mTrack.mFace.mRoll = face.mRoll;
+    slot.mTrack.mFace.mScore = face.mScore;
+}
+
+bool FaceTracker::update(const Face *faces, unsigned int count)
+{
+    bool matched[MAX_FACES];
+    bool continued[MAX_TRACKS];
+    Track previous[MAX_TRACKS];
+    unsigned int previousCount = mReportedCount;
+    bool changed = false;
+
+    if ( MAX_FACES < count )
+        {
+        count = MAX_FACES;
+        }
+
+    memset(matched, 0, sizeof(matched));
+    memset(continued, 0, sizeof(continued));
+
+    for ( unsigned int r = 0 ; r < mReportedCount ; r++ )
+        {
+        previous[r] = mSlots[mReported[r]].mTrack;
+        }
+
+    for ( unsigned int s = 0 ; s < MAX_TRACKS ; s++ )
+        {
+        for ( unsigned int d = 0 ; d < count ; d++ )
+            {
+            mOverlap[s][d] = mSlots[s].mUsed ? overlap(mSlots[s].mTrack.mFace, faces[d]) : 0;
+            }
+        }
+
+    ///Greedy matching, the best overlapping pair first
+    for ( ;; )
+        {
+        unsigned int best = 0;
+        unsigned int bestSlot = 0;
+        unsigned int bestFace = 0;
+
+        for ( unsigned int s = 0 ; s < MAX_TRACKS ; s++ )
+            {
+            if ( !mSlots[s].mUsed || continued[s] )
+                {
+                continue;
+                }
+
+            for ( unsigned int d = 0 ; d < count ; d++ )
+                {
+                if ( !matched[d] && ( mOverlap[s][d] > best ) )
+                    {
+                    best = mOverlap[s][d];
+                    bestSlot = s;
+                    bestFace = d;
+                    }
+                }
+            }
+
+        if ( ( 0 == best ) || ( best < mConfig.mMinOverlap ) )
+            {
+            break;
+            }
+
+        Slot &slot = mSlots[bestSlot];
+
+        filter(slot, faces[bestFace]);
+        slot.mTrack.mHits++;
+        slot.mTrack.mMisses = 0;
+        continued[bestSlot] = true;
+        matched[bestFace] = true;
+        }
+
+    ///Faces not detected on this frame
+    for ( unsigned int s = 0 ; s < MAX_TRACKS ; s++ )
+        {
+        Slot &slot = mSlots[s];
+
+        if ( !slot.mUsed || continued[s] )
+            {
+            continue;
+            }
+
+        slot.mTrack.mMisses++;
+        if ( ( slot.mTrack.mHits < mConfig.mConfirmFrames ) || ( slot.mTrack.mMisses > mConfig.mHoldFrames ) )
+            {
+            slot.mUsed = false;
+            }
+        }
+
+    ///New faces, while there is room for them
+    for ( unsigned int d = 0 ; d < count ; d++ )
+        {
+        if ( matched[d] )
+            {
+            continue;
+            }
+
+        for ( unsigned int s = 0 ; s < MAX_TRACKS ; s++ )
+            {
+            Slot &slot = mSlots[s];
+
+            if ( slot.mUsed )
+                {
+                continue;
+                }
+
+            memset(&slot, 0, sizeof(slot));
+            slot.mUsed = true;
+            slot.mTrack.mId = mNextId++;
+            slot.mTrack.mHits = 1;
+            slot.mBox[0] = faces[d].mLeft << Q8_SHIFT;
+            slot.mBox[1] = faces[d].mTop << Q8_SHIFT;
+            slot.mBox[2] = faces[d].mWidth << Q8_SHIFT;
+            slot.mBox[3] = faces[d].mHeight << Q8_SHIFT;
+            slot.mTrack.mFace = faces[d];
+            break;
+            }
+        }
+
+    ///Reported faces in the order of their ids, that is of their first detection
+    mReportedCount = 0;
+    for ( uint32_t last = 0 ; ; last = mSlots[mReported[mReportedCount - 1]].mTrack.mId )
+        {
+        unsigned int next = MAX_TRACKS;
+
+        for ( unsigned int s = 0 ; s < MAX_TRACKS ; s++ )
+            {
+            const Slot &slot = mSlots[s];
+
+            if ( slot.mUsed && ( slot.mTrack.mHits >= mConfig.mConfirmFrames ) && ( slot.mTrack.mId > last ) &&
+                 ( ( MAX_TRACKS == next ) || ( slot.mTrack.mId < mSlots[next].mTrack.mId ) ) )
+                {
+                next = s;
+                }
+            }
+
+        if ( MAX_TRACKS == next )
+            {
+            break;
+            }
+
+        mReported[mReportedCount++] = next;
+        }
+
+    if ( previousCount != mReportedCount )
+        {
+        changed = true;
+        }
+    else
+        {
+        for ( unsigned int r = 0 ; r < mReportedCount ; r++ )
+            {
+            const Track &track = mSlots[mReported[r]].mTrack;
+            const Face &face = track.mFace;
+            const Face &before = previous[r].mFace;
+
+            if ( ( track.mId != previous[r].mId ) ||
+                 ( face.mLeft != before.mLeft ) || ( face.mTop != before.mTop ) ||
+                 ( face.mWidth != before.mWidth ) || ( face.mHeight != before.mHeight ) ||
+                 ( face.mRoll != before.mRoll ) )
+                {
+                changed = true;
+                break;
+                }
+            }
+        }
+
+    return changed;
+}
+
+unsigned int FaceTracker::getCount() const
+{
+    return mReportedCount;
+}
+
+const FaceTracker::Track& FaceTracker::getTrack(unsigned int index) const
+{
+    return mSlots[mReported[index]].mTrack;
+}
+
+bool FaceTracker::getRegion(Face &region, bool &valid)
+{
+    const Track *track = NULL;
+    bool changed;
+
+    ///The face of the last region while it lasts, the largest one otherwise
+    for ( unsigned int r = 0 ; r < mReportedCount ; r++ )
+        {
+        const Track &candidate = mSlots[mReported[r]].mTrack;
+
+        if ( mRegionValid && ( candidate.mId == mRegionId ) )
+            {
+            track = &candidate;
+            break;
+            }
+
+        if ( ( NULL == track ) ||
+             ( ( int64_t ) candidate.mFace.mWidth * candidate.mFace.mHeight >
+               ( int64_t ) track->mFace.mWidth * track->mFace.mHeight ) )
+            {
+            track = &candidate;
+            }
+        }
+
+    if ( NULL == track )
+        {
+        changed = mRegionValid;
+        mRegionValid = false;
+        valid = false;
+        region = mRegion;
+
+        return changed;
+        }
+
+    const Face &face = track->mFace;
+    int32_t thresholdX = ( mRegion.mWidth * ( int32_t ) mConfig.mRegionThreshold ) / 100;
+    int32_t thresholdY = ( mRegion.mHeight * ( int32_t ) mConfig.mRegionThreshold ) / 100;
+
+    changed = !mRegionValid || ( track->mId != mRegionId ) ||
+              ( distance(face.mLeft + face.mWidth / 2, mRegion.mLeft + mRegion.mWidth / 2) > thresholdX ) ||
+              ( distance(face.mTop + face.mHeight / 2, mRegion.mTop + mRegion.mHeight / 2) > thresholdY ) ||
+              ( distance(face.mWidth, mRegion.mWidth) > thresholdX ) ||
+              ( distance(face.mHeight, mRegion.mHeight) > thresholdY );
+
+    if ( changed )
+        {
+        mRegion = face;
+        mRegionId = track->mId;
+        mRegionValid = true;
+        }
+
+    region = mRegion;
+    valid = true;
+
+    return changed;
+}
+
+size_t FaceTracker::encode(char *buffer, size_t size) const
+{
+    size_t length = 0;
+
+    if ( ( NULL == buffer ) || ( 0 == size ) )
+        {
+        return 0;
+        }
+
+    buffer[0] = '\0';
+
+    for ( unsigned int r = 0 ; r < mReportedCount ; r++ )
+        {
+        const Face &face = mSlots[mReported[r]].mTrack.mFace;
+        int count = snprintf(buffer + length, size - length, "%d,%dx%d,%dx%d,", face.mRoll, face.mLeft, face.mTop,
+                             face.mWidth, face.mHeight);
+
+        if ( ( 0 > count ) || ( ( size_t ) count >= size - length ) )
+            {
+            buffer[length] = '\0';
+            break;
+            }
+
+        length += count;
+        }
+
+    return length;
+}
+
+};
@@ -22,10 +22,13 @@
 #define LOG_TAG "CameraHal"
 
 #include "FakeCameraAdapter.h"
+#include "TICameraParameters.h"
 
 namespace android {
 
 #define DEFAULT_PICTURE_BUFFER_SIZE 0x1000
+#define DEFAULT_FRAME_RATE 30
+#define DEFAULT_ISO 100
 
 /*--------------------Camera Adapter Class STARTS here-----------------------------*/
 
@@ -33,6 +36,8 @@ FakeCameraAdapter::FakeCameraAdapter()
 {
     LOG_FUNCTION_NAME
 
+    mFrameRate = DEFAULT_FRAME_RATE;
+
     LOG_FUNCTION_NAME_EXIT
 }
 
@@ -43,7 +48,7 @@ FakeCameraAdapter::~FakeCameraAdapter()
     LOG_FUNCTION_NAME
 
     msg.command = BaseCameraAdapter::FRAME_EXIT;
-    mFrameQ.put(&msg);
+    mFrameQ.put(&msg, MessageQueue::PRIORITY_HIGH);
     mAdapterQ.get(&msg);
 
     msg.command = FakeCameraAdapter::CALLBACK_EXIT;
@@ -123,14 +128,36 @@ status_t FakeCameraAdapter::initialize(int sensor_index)
 
 status_t FakeCameraAdapter::setParameters(const CameraParameters& params)
 {
+    status_t ret = NO_ERROR;
+    int zslDepth;
+
     LOG_FUNCTION_NAME
 
     params.getPreviewSize(&mPreviewWidth, &mPreviewHeight);
     params.getPictureSize(&mCaptureWidth, &mCaptureHeight);
 
+    if ( 0 < params.getPreviewFrameRate() )
+        {
+        mFrameRate = params.getPreviewFrameRate();
+        }
+
+    zslDepth = params.getInt(TICameraParameters::KEY_ZSL_DEPTH);
+    if ( 0 > zslDepth )
+        {
+        zslDepth = 0;
+        }
+
+    if ( ( unsigned int ) zslDepth != mZslRing.getDepth() )
+        {
+        Mutex::Autolock lock(mImageVectorLock);
+
+        flushZslFrames();
+        ret = mZslRing.setDepth(zslDepth);
+        }
+
     LOG_FUNCTION_NAME_EXIT
 
-    return NO_ERROR;
+    return ret;
 }
 
 void FakeCameraAdapter::getParameters(CameraParameters& params)
@@ -193,7 +220,8 @@ status_t FakeCameraAdapter::stopPreview()
 
     msg.command = BaseCameraAdapter::STOP_PREVIEW;
 
-    mFrameQ.put(&msg);
+    ///Stop ahead of any returned frames still queued
+    mFrameQ.put(&msg, MessageQueue::PRIORITY_HIGH);
     MessageQueue::waitForMsg(&mAdapterQ, NULL, NULL, -1);
     mAdapterQ.get(&msg);
 
@@ -484,6 +512,28 @@ status_t FakeCameraAdapter::startImageCapture()
 
     Mutex::Autolock lock(mImageVectorLock);
 
+    ///ZSL: the stored frame closest to the shutter goes straight to the JPEG
+    ///subscribers, without a new exposure
+    if ( ( 0 < mZslRing.getDepth() ) && ( NO_ERROR == getZslFrame(frame) ) )
+        {
+        notifyShutterSubscribers();
+
+        if ( NO_ERROR != sendFrameToSubscribers(&frame) )
+            {
+            mFreeImageBuffers.push(( unsigned int ) frame.mBuffer);
+            }
+
+        //The capture buffers stay in use by the ring, so they are not released here
+        if ( NULL != mEndImageCaptureCallback)
+            {
+            mEndImageCaptureCallback(mEndCaptureData);
+            }
+
+        LOG_FUNCTION_NAME_EXIT
+
+        return ret;
+        }
+
     if ( mFreeImageBuffers.isEmpty() )
         {
         return -1;
@@ -528,6 +578,109 @@ status_t FakeCameraAdapter::startImageCapture()
     return ret;
 }
 
+void FakeCameraAdapter::storeZslFrame()
+{
+    ZslRing::Frame frame;
+    void *evicted = NULL;
+
+    Mutex::Autolock lock(mImageVectorLock);
+
+    if ( ( 0 == mZslRing.getDepth() ) || mFreeImageBuffers.isEmpty() )
+        {
+        return;
+        }
+
+    frame.mBuffer = ( void * ) mFreeImageBuffers.top();
+    mFreeImageBuffers.pop();
+
+    frame.mOffset = 0;
+    frame.mLength = mCaptureWidth*mCaptureHeight;
+    frame.mWidth = mCaptureWidth;
+    frame.mHeight = mCaptureHeight;
+    frame.mTimestamp = systemTime(SYSTEM_TIME_MONOTONIC);
+
+    //The fake sensor has no 3A, every frame is exposed the same way
+    frame.mMetadata.mExposureTime = 1000000 / mFrameRate;
+    frame.mMetadata.mSensitivity = DEFAULT_ISO;
+    frame.mMetadata.mEVCompensation = 0;
+    frame.mMetadata.mWhiteBalance = 0;
+    frame.mMetadata.mConverged = true;
+
+    if ( NO_ERROR != mZslRing.push(frame, evicted) )
+        {
+        evicted = frame.mBuffer;
+        }
+
+    if ( NULL != evicted )
+        {
+        mFreeImageBuffers.push(( unsigned int ) evicted);
+        }
+}
+
+///Called with mImageVectorLock held
+void FakeCameraAdapter::flushZslFrames()
+{
+    ZslRing::Frame frame;
+
+    while ( mZslRing.pop(frame) )
+        {
+        mFreeImageBuffers.push(( unsigned int ) frame.mBuffer);
+        }
+}
+
+status_t FakeCameraAdapter::getZslFrame(CameraFrame &frame)
+{
+    status_t ret = NO_ERROR;
+    ZslRing::Frame zslFrame;
+
+    LOG_FUNCTION_NAME
+
+    ret = mZslRing.select(mShutterTimestamp, zslFrame);
+
+    if ( NO_ERROR == ret )
+        {
+        frame.mBuffer = zslFrame.mBuffer;
+        frame.mOffset = zslFrame.mOffset;
+        frame.mLength = zslFrame.mLength;
+        frame.mWidth = zslFrame.mWidth;
+        frame.mHeight = zslFrame.mHeight;
+        frame.mTimestamp = zslFrame.mTimestamp;
+        frame.mFrameType = CameraFrame::IMAGE_FRAME;
+        }
+
+    LOG_FUNCTION_NAME_EXIT
+
+    return ret;
+}
+
+void FakeCameraAdapter::queueFreeBuffer(void *frameBuf, int frameType)
+{
+    if ( CameraFrame::IMAGE_FRAME == frameType )
+        {
+        Mutex::Autolock lock(mImageVectorLock);
+
+        //Non ZSL captures keep their buffer on the free list while in use
+        for ( size_t i = 0 ; i < mFreeImageBuffers.size() ; i++ )
+            {
+            if ( mFreeImageBuffers[i] == ( unsigned int ) frameBuf )
+                {
+                return;
+                }
+            }
+
+        mFreeImageBuffers.push(( unsigned int ) frameBuf);
+        }
+    else if ( CameraFrame::RAW_FRAME == frameType )
+        {
+        //Raw frames share the buffer of the image frame
+        }
+    else
+        {
+        Mutex::Autolock lock(mPreviewVectorLock);
+        mFreePreviewBuffers.push(( unsigned int ) frameBuf);
+        }
+}
+
 status_t FakeCameraAdapter::doAutofocus()
 {
     LOG_FUNCTION_NAME
@@ -555,6 +708,7 @@ void FakeCameraAdapter::frameThread()
                 if ( mFrameQ.isEmpty() )
                     {
                     sendNextFrame(NORMAL_FRAME);
+                    storeZslFrame();
                     }
                 else
                     {
@@ -568,13 +722,13 @@ void FakeCameraAdapter::frameThread()
                         if ( BaseCameraAdapter::STOP_PREVIEW == msg.command )
                             {
                             state = FakeCameraAdapter::STOPPED;
+
+                            Mutex::Autolock lock(mImageVectorLock);
+                            flushZslFrames();
                             }
                         else if ( BaseCameraAdapter::RETURN_FRAME== msg.command )
                             {
-                                {
-                                Mutex::Autolock lock(mPreviewVectorLock);
-                                mFreePreviewBuffers.push( ( unsigned int ) msg.arg1);
-                                }
+                            queueFreeBuffer(msg.arg1, ( int ) msg.arg2);
                             }
                         else if ( BaseCameraAdapter::DO_AUTOFOCUS == msg.command )
                             {
@@ -632,10 +786,7 @@ void FakeCameraAdapter::frameThread()
                         }
                     else if ( BaseCameraAdapter::RETURN_FRAME== msg.command )
                         {
-                            {
-                            Mutex::Autolock lock(mPreviewVectorLock);
-                            mFreePreviewBuffers.push( ( unsigned int ) msg.arg1);
-                            }
+                        queueFreeBuffer(msg.arg1, ( int ) msg.arg2);
                         }
                     else if ( BaseCameraAdapter::DO_AUTOFOCUS == msg.command )
                         {
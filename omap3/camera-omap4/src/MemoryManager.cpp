@@ -24,6 +24,7 @@
 
 #include "CameraHal.h"
 #include "TICameraParameters.h"
+#include <cutils/properties.h>
 
 extern "C" {
 
@@ -41,6 +42,10 @@ namespace android {
 #define STRIDE_8BIT (4 * 1024)
 #define STRIDE_16BIT (4 * 1024)
 
+///Number of released TILER buffers kept for reuse, 0 disables the pool
+#define TILER_POOL_SIZE_PROPERTY "camera.tiler.poolsize"
+#define TILER_POOL_SIZE_DEFAULT 8
+
 
 ///Utility Macro Declarations
 #define ZERO_OUT_ARR(a,b) { for(unsigned int i=0;i<b;i++) a[i]=NULL;}
@@ -48,6 +53,63 @@ namespace android {
 #define ZERO_OUT_STRUCT(a, b) memset(a, 0, sizeof(b));
 
 /*--------------------MemoryManager Class STARTS here-----------------------------*/
+MemoryManager::MemoryManager()
+{
+    LOG_FUNCTION_NAME
+
+    mPool = NULL;
+
+    LOG_FUNCTION_NAME_EXIT
+}
+
+MemoryManager::~MemoryManager()
+{
+    LOG_FUNCTION_NAME
+
+    if ( NULL != mPool )
+        {
+        MemMgrPoolStats stats;
+        if ( 0 == MemMgr_PoolGetStats(mPool, &stats) )
+            {
+            CAMHAL_LOGDB("TILER pool hits %u misses %u trimmed %u",
+                         stats.hits, stats.misses, stats.trimmed);
+            }
+
+        MemMgr_PoolDestroy(mPool);
+        mPool = NULL;
+        }
+
+    LOG_FUNCTION_NAME_EXIT
+}
+
+status_t MemoryManager::initialize()
+{
+    status_t ret = NO_ERROR;
+    char value[PROPERTY_VALUE_MAX];
+    int poolSize = TILER_POOL_SIZE_DEFAULT;
+
+    LOG_FUNCTION_NAME
+
+    if ( property_get(TILER_POOL_SIZE_PROPERTY, value, 0) > 0 )
+        {
+        poolSize = atoi(value);
+        }
+
+    if ( ( 0 < poolSize ) && ( NULL == mPool ) )
+        {
+        mPool = MemMgr_PoolCreate(poolSize);
+        if ( NULL == mPool )
+            {
+            CAMHAL_LOGEB("Couldn't create TILER pool of %d buffers", poolSize);
+            ret = -ENOMEM;
+            }
+        }
+
+    LOG_FUNCTION_NAME_EXIT
+
+    return ret;
+}
+
 ///@todo Change the name of the MemoryManager class to TilerMemoryManager to indicate that it allocates TILER buffers only
 void* MemoryManager::allocateBuffer(int width, int height, const char* format, int &bytes, int numBufs)
 {
@@ -56,7 +118,10 @@ void* MemoryManager::allocateBuffer(int width, int height, const char* format, i
     ///the buffers
     const uint numArrayEntriesC = (uint)(numBufs+1);
 
-    MemAllocBlock *tMemBlock;
+    ///MemAllocBlock is the structure that describes the buffer alloc request to MemMgr
+    MemAllocBlock tMemBlock[2];
+    int numAllocs = 1;
+    status_t ret = NO_ERROR;
 
 
     ///Allocate a buffer array
@@ -72,139 +137,114 @@ void* MemoryManager::allocateBuffer(int width, int height, const char* format, i
     ///If a value of an array element is NULL, it means we didnt allocate it
     ZERO_OUT_ARR(bufsArr, numArrayEntriesC);
 
+    memset(tMemBlock, 0, sizeof(tMemBlock));
+
     ///If the bytes field is not zero, it means it is a 1-D tiler buffer request (possibly for image capture bit stream buffer)
     if(bytes!=0)
         {
-        ///MemAllocBlock is the structure that describes the buffer alloc request to MemMgr
-        tMemBlock = (MemAllocBlock*)malloc(sizeof(MemAllocBlock));
+        ///1D buffers
+        tMemBlock[0].dim.len = bytes;
+        tMemBlock[0].pixelFormat = PIXEL_FMT_PAGE;
+        tMemBlock[0].stride = 0;
+        CAMHAL_LOGDB("requested bytes = %d", bytes);
+        CAMHAL_LOGDB("tMemBlock.dim.len = %d", tMemBlock[0].dim.len);
+        }
+    else ///If bytes is not zero, then it is a 2-D tiler buffer request
+        {
+        ///2D buffers
+        pixel_fmt_t pixelFormat[2];
+        int stride[2];
 
-        if(!tMemBlock)
+        if(!strcmp(format,(const char *) CameraParameters::PIXEL_FORMAT_YUV422I))
             {
-            delete [] bufsArr;
-            return NULL;
+            ///YUV422I format
+            pixelFormat[0] = PIXEL_FMT_16BIT;
+            stride[0] = STRIDE_16BIT;
+            numAllocs = 1;
+            }
+        else if(!strcmp(format,(const char *) CameraParameters::PIXEL_FORMAT_YUV420SP))
+            {
+            ///YUV420 NV12 format
+            pixelFormat[0] = PIXEL_FMT_8BIT;
+            pixelFormat[1] = PIXEL_FMT_16BIT;
+            stride[0] = STRIDE_8BIT;
+            stride[1] = STRIDE_16BIT;
+            numAllocs = 2;
+            }
+        else if(!strcmp(format,(const char *) CameraParameters::PIXEL_FORMAT_RGB565))
+            {
+            ///RGB 565 format
+            pixelFormat[0] = PIXEL_FMT_16BIT;
+            stride[0] = STRIDE_16BIT;
+            numAllocs = 1;
+            }
+        else if(!strcmp(format,(const char *) TICameraParameters::PIXEL_FORMAT_RAW))
+            {
+            ///RAW format
+            pixelFormat[0] = PIXEL_FMT_16BIT;
+            stride[0] = STRIDE_16BIT;
+            numAllocs = 1;
+            }
+        else
+            {
+            ///By default assume YUV420 NV12 format
+            ///YUV420 NV12 format
+            pixelFormat[0] = PIXEL_FMT_8BIT;
+            pixelFormat[1] = PIXEL_FMT_16BIT;
+            stride[0] = STRIDE_8BIT;
+            stride[1] = STRIDE_16BIT;
+            numAllocs = 2;
             }
 
-        ZERO_OUT_STRUCT(tMemBlock, MemAllocBlock );
-
-        ///1D buffers
-        for (int i = 0; i < numBufs; i++)
+        for(int index=0;index<numAllocs;index++)
             {
-            tMemBlock->dim.len = bytes;
-            tMemBlock->pixelFormat = PIXEL_FMT_PAGE;
-            tMemBlock->stride = 0;
-            CAMHAL_LOGDB("requested bytes = %d", bytes);
-            CAMHAL_LOGDB("tMemBlock.dim.len = %d", tMemBlock->dim.len);
-            bufsArr[i] = (uint32_t)MemMgr_Alloc(tMemBlock, 1);
-            if(!bufsArr[i])
-                {
-                LOGE("Buffer allocation failed for iteration %d", i);
-                goto error;
-                }
-            else
-                {
-                LOGD("Allocated Tiler PAGED mode buffer address[%x]", bufsArr[i]);
-                }
+            tMemBlock[index].pixelFormat = pixelFormat[index];
+            tMemBlock[index].stride = stride[index];
+            tMemBlock[index].dim.area.width=  width;/*width*/
+            tMemBlock[index].dim.area.height=  height;/*height*/
             }
+        }
 
+    ///Allocate all buffers in a single pass, this either allocates all or none of them.
+    ///The pool reuses its cached buffers and batch allocates the ones it cannot supply
+    MemAllocBlock *batchBlocks = (MemAllocBlock*)malloc(sizeof(MemAllocBlock)*numAllocs*numBufs);
+    if ( NULL == batchBlocks )
+        {
+        ret = -ENOMEM;
         }
-    else ///If bytes is not zero, then it is a 2-D tiler buffer request
+    else
         {
-        ///2D buffers
-        ///MemAllocBlock is the structure that describes the buffer alloc request to MemMgr
-        tMemBlock = (MemAllocBlock*)malloc(sizeof(MemAllocBlock)*2);
+        int err;
 
-        if(!tMemBlock)
+        memcpy(batchBlocks, tMemBlock, sizeof(MemAllocBlock)*numAllocs);
+        if ( NULL != mPool )
             {
-            delete [] bufsArr;
-            return NULL;
+            err = MemMgr_PoolAllocBatch(mPool, batchBlocks, numAllocs, (void **) bufsArr, numBufs);
             }
-
-        for(int i=0;i<2;i++)
+        else
             {
-            ZERO_OUT_STRUCT(&tMemBlock[i], MemAllocBlock );
+            err = MemMgr_AllocBatch(batchBlocks, numAllocs, (void **) bufsArr, numBufs);
             }
 
-        for (int i = 0; i < numBufs; i++)
+        if ( 0 != err )
             {
-            int numAllocs = 1;
-            pixel_fmt_t pixelFormat[2];
-            int stride[2];
-
-            if(!strcmp(format,(const char *) CameraParameters::PIXEL_FORMAT_YUV422I))
-                {
-                ///YUV422I format
-                pixelFormat[0] = PIXEL_FMT_16BIT;
-                stride[0] = STRIDE_16BIT;
-                numAllocs = 1;
-                }
-            else if(!strcmp(format,(const char *) CameraParameters::PIXEL_FORMAT_YUV420SP))
-                {
-                ///YUV420 NV12 format
-                pixelFormat[0] = PIXEL_FMT_8BIT;
-                pixelFormat[1] = PIXEL_FMT_16BIT;
-                stride[0] = STRIDE_8BIT;
-                stride[1] = STRIDE_16BIT;
-                numAllocs = 2;
-                }
-            else if(!strcmp(format,(const char *) CameraParameters::PIXEL_FORMAT_RGB565))
-                {
-                ///RGB 565 format
-                pixelFormat[0] = PIXEL_FMT_16BIT;
-                stride[0] = STRIDE_16BIT;
-                numAllocs = 1;
-                }
-            else if(!strcmp(format,(const char *) TICameraParameters::PIXEL_FORMAT_RAW))
-                {
-                ///RAW format
-                pixelFormat[0] = PIXEL_FMT_16BIT;
-                stride[0] = STRIDE_16BIT;
-                numAllocs = 1;
-                }
-            else
-                {
-                ///By default assume YUV420 NV12 format
-                ///YUV420 NV12 format
-                pixelFormat[0] = PIXEL_FMT_8BIT;
-                pixelFormat[1] = PIXEL_FMT_16BIT;
-                stride[0] = STRIDE_8BIT;
-                stride[1] = STRIDE_16BIT;
-                numAllocs = 2;
-                }
-
-            for(int index=0;index<numAllocs;index++)
-                {
-                tMemBlock[index].pixelFormat = pixelFormat[index];
-                tMemBlock[index].stride = stride[index];
-                tMemBlock[index].dim.area.width=  width;/*width*/
-                tMemBlock[index].dim.area.height=  height;/*height*/
-                }
-
-            bufsArr[i] = (uint32_t)MemMgr_Alloc(tMemBlock, numAllocs);
-            if(!bufsArr[i])
-                {
-                CAMHAL_LOGEB("Buffer allocation failed for iteration %d", i);
-                goto error;
-                }
-            else
+            CAMHAL_LOGEB("Batch allocation of %d buffers failed", numBufs);
+            ret = -ENOMEM;
+            }
+        else
+            {
+            for (int i = 0; i < numBufs; i++)
                 {
-                LOGD("Allocated Tiler PAGED mode buffer address[%x]", bufsArr[i]);
+                CAMHAL_LOGDB("Allocated Tiler buffer address[%x]", bufsArr[i]);
                 }
             }
-
+        free(batchBlocks);
         }
 
-        LOG_FUNCTION_NAME_EXIT
-
-
-        ///Free the request structure before returning from the function
-        free(tMemBlock);
-
-        return (void*)bufsArr;
-
-    error:
+    if ( NO_ERROR != ret )
+        {
         LOGE("Freeing buffers already allocated after error occurred");
         freeBuffer(bufsArr);
-        free(tMemBlock);
 
         if ( NULL != mErrorNotifier.get() )
             {
@@ -213,6 +253,11 @@ void* MemoryManager::allocateBuffer(int width, int height, const char* format, i
 
         LOG_FUNCTION_NAME_EXIT
         return NULL;
+        }
+
+    LOG_FUNCTION_NAME_EXIT
+
+    return (void*)bufsArr;
 }
 
 //TODO: Get needed data to map tiler buffers
@@ -251,7 +296,14 @@ int MemoryManager::freeBuffer(void* buf)
 
     while(*bufEntry)
         {
-        ret |= MemMgr_Free((void*)*bufEntry++);
+        if ( NULL != mPool )
+            {
+            ret |= MemMgr_PoolRelease(mPool, (void*)*bufEntry++);
+            }
+        else
+            {
+            ret |= MemMgr_Free((void*)*bufEntry++);
+            }
         }
 
     ///@todo Check if this way of deleting array is correct, else use malloc/free
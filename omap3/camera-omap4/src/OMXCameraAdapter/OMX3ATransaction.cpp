@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+* @file OMX3ATransaction.cpp
+*
+* This file implements the batching of the 3A related OMX configs.
+*
+*/
+
+#undef LOG_TAG
+
+#define LOG_TAG "OMXCameraAdapter"
+
+#include <string.h>
+#include <utils/Log.h>
+
+#include "DebugUtils.h"
+#include "OMX3ATransaction.h"
+
+namespace android {
+
+///Offset of nPortIndex in the OMX config structures, after nSize and nVersion
+#define CONFIG_PORT_OFFSET      ( sizeof(OMX_U32) + sizeof(OMX_VERSIONTYPE) )
+
+OMX3ATransaction::OMX3ATransaction() : mOpen(false), mHandle(NULL), mCount(0), mErrorCount(0), mRequested(0), mIssued(0)
+{
+    mOwner = pthread_self();
+}
+
+void OMX3ATransaction::begin(OMX_HANDLETYPE handle)
+{
+    mLock.lock();
+
+    mHandle = handle;
+    mCount = 0;
+    mErrorCount = 0;
+    mOwner = pthread_self();
+    mOpen = true;
+}
+
+OMX_ERRORTYPE OMX3ATransaction::commit(Error *errors, unsigned int *count)
+{
+    OMX_ERRORTYPE ret;
+
+    if ( !isStaging() )
+        {
+        DBGUTILS_LOGEA("No 3A transaction open on this thread");
+        return OMX_ErrorIncorrectStateOperation;
+        }
+
+    ret = flush();
+
+    DBGUTILS_LOGDB("3A configs: %u round trips requested, %u sent", mRequested, mIssued);
+
+    if ( NULL != errors )
+        {
+        memcpy(errors, mErrors, mErrorCount * sizeof(Error));
+        }
+
+    if ( NULL != count )
+        {
+        *count = mErrorCount;
+        }
+
+    mOpen = false;
+    mHandle = NULL;
+    mLock.unlock();
+
+    return ret;
+}
+
+bool OMX3ATransaction::isStaging() const
+{
+    return mOpen && pthread_equal(mOwner, pthread_self());
+}
+
+OMX3ATransaction::Config *OMX3ATransaction::find(OMX_INDEXTYPE index, OMX_PTR config)
+{
+    OMX_U32 size = *( OMX_U32 * ) config;
+    OMX_U32 port = 0;
+
+    if ( CONFIG_PORT_OFFSET + sizeof(OMX_U32) <= size )
+        {
+        memcpy(&port, ( OMX_U8 * ) config + CONFIG_PORT_OFFSET, sizeof(port));
+        }
+
+    for ( unsigned int i = 0 ; i < mCount ; i++ )
+        {
+        Config *c = &mConfigs[i];
+        if ( ( c->mIndex == index ) && ( c->mPortIndex == port ) && ( c->mSize == size ) )
+            {
+            return c;
+            }
+        }
+
+    return NULL;
+}
+
+OMX3ATransaction::Config *OMX3ATransaction::add(OMX_INDEXTYPE index, OMX_PTR config)
+{
+    OMX_U32 size = *( OMX_U32 * ) config;
+    Config *c;
+
+    if ( ( MAX_CONFIGS <= mCount ) || ( MAX_CONFIG_SIZE < size ) )
+        {
+        return NULL;
+        }
+
+    c = &mConfigs[mCount++];
+    c->mIndex = index;
+    c->mPortIndex = 0;
+    c->mSize = size;
+    c->mDirty = false;
+    memcpy(c->mData, config, size);
+
+    if ( CONFIG_PORT_OFFSET + sizeof(OMX_U32) <= size )
+        {
+        memcpy(&c->mPortIndex, c->mData + CONFIG_PORT_OFFSET, sizeof(c->mPortIndex));
+        }
+
+    return c;
+}
+
+bool OMX3ATransaction::isPending(const Config *except) const
+{
+    for ( unsigned int i = 0 ; i < mCount ; i++ )
+        {
+        if ( mConfigs[i].mDirty && ( &mConfigs[i] != except ) )
+            {
+            return true;
+            }
+        }
+
+    return false;
+}
+
+OMX_ERRORTYPE OMX3ATransaction::send(OMX_INDEXTYPE index, OMX_PTR config)
+{
+    OMX_ERRORTYPE eError;
+
+    eError = OMX_SetConfig(mHandle, index, config);
+    mIssued++;
+
+    if ( OMX_ErrorNone != eError )
+        {
+        DBGUTILS_LOGEB("Error 0x%x while applying config 0x%x", eError, index);
+        if ( MAX_CONFIGS > mErrorCount )
+            {
+            mErrors[mErrorCount].mIndex = index;
+            mErrors[mErrorCount].mError = eError;
+            mErrorCount++;
+            }
+        }
+
+    return eError;
+}
+
+OMX_ERRORTYPE OMX3ATransaction::flush()
+{
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+    OMX_ERRORTYPE eError;
+
+    for ( unsigned int i = 0 ; i < mCount ; i++ )
+        {
+        Config *c = &mConfigs[i];
+
+        if ( !c->mDirty )
+            {
+            continue;
+            }
+
+        eError = send(c->mIndex, c->mData);
+        if ( ( OMX_ErrorNone != eError ) && ( OMX_ErrorNone == ret ) )
+            {
+            ret = eError;
+            }
+        }
+
+    ///What the component has may have changed with the writes, drop the reads too
+    mCount = 0;
+
+    return ret;
+}
+
+OMX_ERRORTYPE OMX3ATransaction::getConfig(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config)
+{
+    OMX_ERRORTYPE eError;
+    bool pending = false;
+    Config *c;
+
+    if ( !isStaging() || ( handle != mHandle ) )
+        {
+        return OMX_GetConfig(handle, index, config);
+        }
+
+    mRequested++;
+
+    c = find(index, config);
+    pending = isPending(c);
+
+    ///A value written here is what the component ends up with, a value read
+    ///earlier only as long as no other write is staged
+    if ( ( NULL != c ) && ( c->mDirty || !pending ) )
+        {
+        memcpy(config, c->mData, c->mSize);
+        return OMX_ErrorNone;
+        }
+
+    if ( pending )
+        {
+        ///The staged writes may change this config, e.g. a scene mode sets
+        ///the exposure values. Send them first, commit() reports their errors.
+        flush();
+        }
+
+    eError = OMX_GetConfig(handle, index, config);
+    mIssued++;
+
+    if ( OMX_ErrorNone == eError )
+        {
+        ///Keep what the component has, further reads and identical writes stay local
+        add(index, config);
+        }
+
+    return eError;
+}
+
+OMX_ERRORTYPE OMX3ATransaction::setConfig(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config)
+{
+    Config *c;
+
+    if ( !isStaging() || ( handle != mHandle ) )
+        {
+        return OMX_SetConfig(handle, index, config);
+        }
+
+    mRequested++;
+
+    c = find(index, config);
+    if ( ( NULL != c ) && !c->mDirty && !isPending(c) && ( 0 == memcmp(c->mData, config, c->mSize) ) )
+        {
+        ///The component already has this value
+        return OMX_ErrorNone;
+        }
+
+    if ( NULL == c )
+        {
+        c = add(index, config);
+        }
+
+    if ( NULL == c )
+        {
+        ///No room to stage it, send what is pending first to keep the order
+        OMX_ERRORTYPE ret = flush();
+        OMX_ERRORTYPE eError = send(index, config);
+
+        return ( OMX_ErrorNone != ret ) ? ret : eError;
+        }
+
+    memcpy(c->mData, config, c->mSize);
+    c->mDirty = true;
+
+    return OMX_ErrorNone;
+}
+
+};
@@ -458,6 +458,8 @@ status_t OMXCameraAdapter::initialize(int sensor_index)
         mTouchFocusPosY = 0;
         mMeasurementEnabled = false;
         mFaceDetectionRunning = false;
+        mFaceRegionActive = false;
+        mFaceTracker.reset();
 
         if ( NULL != mFaceDectionResult )
             {
@@ -574,6 +576,24 @@ status_t OMXCameraAdapter::fillThisBuffer(void* frameBuf, CameraFrame::FrameType
     return ret;
 }
 
+bool OMXCameraAdapter::isParameterChanged(const CameraParameters &params, const char *key)
+{
+    const char *newValue = params.get(key);
+    const char *oldValue = mParams.get(key);
+
+    if ( mFirstTimeInit )
+        {
+        return true;
+        }
+
+    if ( ( NULL == newValue ) || ( NULL == oldValue ) )
+        {
+        return ( newValue != oldValue );
+        }
+
+    return ( 0 != strcmp(newValue, oldValue) );
+}
+
 status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
 {
     LOG_FUNCTION_NAME
@@ -584,7 +604,6 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
     bool updateImagePortParams = false;
     int minFramerate, maxFramerate;
     const char *valstr = NULL;
-    const char *oldstr = NULL;
 
    ///@todo Include more camera parameters
     int w, h;
@@ -775,8 +794,16 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
             }
         }
 
-    cap = &mCameraAdapterParameters.mCameraPortParams[mCameraAdapterParameters.mPrevPortIndex];
-    setFormat(OMX_CAMERA_PORT_VIDEO_OUT_PREVIEW, *cap);
+    ///The preview port is configured again in UseBuffersPreview(), only push
+    ///the format here when the application changed it
+    if ( isParameterChanged(params, CameraParameters::KEY_PREVIEW_SIZE) ||
+         isParameterChanged(params, CameraParameters::KEY_PREVIEW_FORMAT) ||
+         isParameterChanged(params, TICameraParameters::KEY_MINFRAMERATE) ||
+         isParameterChanged(params, TICameraParameters::KEY_MAXFRAMERATE) )
+        {
+        cap = &mCameraAdapterParameters.mCameraPortParams[mCameraAdapterParameters.mPrevPortIndex];
+        setFormat(OMX_CAMERA_PORT_VIDEO_OUT_PREVIEW, *cap);
+        }
 
     str = params.get(TICameraParameters::KEY_EXPOSURE_MODE);
     mode = getLUTvalue_HALtoOMX( str, ExpLUT);
@@ -1075,19 +1102,7 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
         if (((valstr = params.get(TICameraParameters::KEY_GBCE)) != NULL) )
             {
             // Configure GBCE only if the setting has changed since last time
-            oldstr = mParams.get(TICameraParameters::KEY_GBCE);
-            bool cmpRes = true;
-            if ( NULL != oldstr )
-                {
-                cmpRes = strcmp(valstr, oldstr) != 0;
-                }
-            else
-                {
-                cmpRes = true;
-                }
-
-
-            if( cmpRes )
+            if ( isParameterChanged(params, TICameraParameters::KEY_GBCE) )
                 {
                 if (strcmp(valstr, ( const char * ) TICameraParameters::GBCE_ENABLE ) == 0)
                     {
@@ -1113,19 +1128,7 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
             {
             // Configure GLBCE only if the setting has changed since last time
 
-            oldstr = mParams.get(TICameraParameters::KEY_GLBCE);
-            bool cmpRes = true;
-            if ( NULL != oldstr )
-                {
-                cmpRes = strcmp(valstr, oldstr) != 0;
-                }
-            else
-                {
-                cmpRes = true;
-                }
-
-
-            if( cmpRes )
+            if ( isParameterChanged(params, TICameraParameters::KEY_GLBCE) )
                 {
                 if (strcmp(valstr, ( const char * ) TICameraParameters::GLBCE_ENABLE ) == 0)
                     {
@@ -1164,20 +1167,19 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
 
     CAMHAL_LOGVB("Burst Frames set %d", mBurstFrames);
 
+    ///The ZSL ring needs a continuous stream of capture buffers, which the
+    ///image port does not provide. Ducati does ZSL itself in HIGH_QUALITY mode.
+    if ( params.getInt(TICameraParameters::KEY_ZSL_DEPTH) > 0 )
+        {
+        CAMHAL_LOGEB("ZSL depth %d not supported, use the high quality capture mode",
+                     params.getInt(TICameraParameters::KEY_ZSL_DEPTH));
+        ret = -EINVAL;
+        }
+
     if ( ((valstr = params.get(TICameraParameters::KEY_FACE_DETECTION_ENABLE)) != NULL) )
      {
       // Configure FD only if the setting has changed since last time
-      oldstr = mParams.get(TICameraParameters::KEY_FACE_DETECTION_ENABLE);
-      bool cmpRes = true;
-      if ( NULL != oldstr )
-           {
-           cmpRes = strcmp(valstr, oldstr) != 0;
-           }
-      else
-           {
-           cmpRes = true;
-           }
-      if ( cmpRes )
+      if ( isParameterChanged(params, TICameraParameters::KEY_FACE_DETECTION_ENABLE) )
            {
       if (strcmp(valstr, (const char *) TICameraParameters::FACE_DETECTION_ENABLE) == 0)
            {
@@ -1287,7 +1289,9 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
 
 	 //Set Auto Convergence Mode
     str = params.get((const char *) TICameraParameters::KEY_AUTOCONVERGENCE);
-    if ( str != NULL )
+    if ( ( str != NULL ) &&
+         ( isParameterChanged(params, TICameraParameters::KEY_AUTOCONVERGENCE) ||
+           isParameterChanged(params, TICameraParameters::KEY_MANUALCONVERGENCE_VALUES) ) )
         {
         // Set ManualConvergence default value
         OMX_S32 manualconvergence = -30;
@@ -1524,7 +1528,8 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
 
 // Motorola specific - begin
     CAMHAL_LOGDA("Start setting of Motorola specific parameters");
-    if (NULL != params.get(TICameraParameters::KEY_TESTPATTERN1_COLORBARS))
+    if ((NULL != params.get(TICameraParameters::KEY_TESTPATTERN1_COLORBARS)) &&
+        isParameterChanged(params, TICameraParameters::KEY_TESTPATTERN1_COLORBARS))
         {
         if (strcmp( params.get(TICameraParameters::KEY_TESTPATTERN1_COLORBARS),
                     (const char *) TICameraParameters::TESTPATTERN1_ENABLE) == 0)
@@ -1545,7 +1550,8 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
             }
         }
 
-    if (NULL != params.get(TICameraParameters::KEY_TESTPATTERN1_ENMANUALEXPOSURE))
+    if ((NULL != params.get(TICameraParameters::KEY_TESTPATTERN1_ENMANUALEXPOSURE)) &&
+        isParameterChanged(params, TICameraParameters::KEY_TESTPATTERN1_ENMANUALEXPOSURE))
         {
         if (strcmp( params.get(TICameraParameters::KEY_TESTPATTERN1_ENMANUALEXPOSURE),
                     (const char *) TICameraParameters::TESTPATTERN1_ENABLE) == 0)
@@ -1565,16 +1571,19 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
                 TICameraParameters::TESTPATTERN1_DISABLE);
             }
         }
-    if (NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_EXPOSURETIME))
+    if ((NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_EXPOSURETIME)) &&
+        isParameterChanged(params, TICameraParameters::KEY_DEBUGATTRIB_EXPOSURETIME))
         {
         setExposureTime((unsigned int) (params.getInt(TICameraParameters::KEY_DEBUGATTRIB_EXPOSURETIME)));
         }
 
-    if (NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_EXPOSUREGAIN))
+    if ((NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_EXPOSUREGAIN)) &&
+        isParameterChanged(params, TICameraParameters::KEY_DEBUGATTRIB_EXPOSUREGAIN))
         {
         setExposureGain((int) (params.getInt(TICameraParameters::KEY_DEBUGATTRIB_EXPOSUREGAIN)));
         }
-    if (NULL != params.get(TICameraParameters::KEY_TESTPATTERN1_TARGETEDEXPOSURE))
+    if ((NULL != params.get(TICameraParameters::KEY_TESTPATTERN1_TARGETEDEXPOSURE)) &&
+        isParameterChanged(params, TICameraParameters::KEY_TESTPATTERN1_TARGETEDEXPOSURE))
         {
         if (strcmp(params.get(TICameraParameters::KEY_TESTPATTERN1_TARGETEDEXPOSURE),
                    (const char *) TICameraParameters::TESTPATTERN1_ENABLE) == 0)
@@ -1595,17 +1604,20 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
             }
         }
 
-    if (NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_TARGETEXPVALUE))
+    if ((NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_TARGETEXPVALUE)) &&
+        isParameterChanged(params, TICameraParameters::KEY_DEBUGATTRIB_TARGETEXPVALUE))
         {
         setTargetExpValue((unsigned char) (params.getInt(TICameraParameters::KEY_DEBUGATTRIB_TARGETEXPVALUE)));
         }
 
-    if (NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_ENLENSPOSGETSET))
+    if ((NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_ENLENSPOSGETSET)) &&
+        isParameterChanged(params, TICameraParameters::KEY_DEBUGATTRIB_ENLENSPOSGETSET))
         {
         setEnLensPosGetSet(params.getInt(TICameraParameters::KEY_DEBUGATTRIB_ENLENSPOSGETSET));
         }
 
-    if (NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_LENSPOSITION))
+    if ((NULL != params.get(TICameraParameters::KEY_DEBUGATTRIB_LENSPOSITION)) &&
+        isParameterChanged(params, TICameraParameters::KEY_DEBUGATTRIB_LENSPOSITION))
         {
         setLensPosition(params.getInt(TICameraParameters::KEY_DEBUGATTRIB_LENSPOSITION));
         }
@@ -1620,18 +1632,21 @@ status_t OMXCameraAdapter::setParameters(const CameraParameters &params)
         setMIPIReset();
         }
 
-    if (NULL != params.get(TICameraParameters::KEY_MOT_LEDFLASH))
+    if ((NULL != params.get(TICameraParameters::KEY_MOT_LEDFLASH)) &&
+        isParameterChanged(params, TICameraParameters::KEY_MOT_LEDFLASH))
     {
     setLedFlash((unsigned int) (params.getInt(TICameraParameters::KEY_MOT_LEDFLASH)));
     }
 
-    if (NULL != params.get(TICameraParameters::KEY_MOT_LEDTORCH))
+    if ((NULL != params.get(TICameraParameters::KEY_MOT_LEDTORCH)) &&
+        isParameterChanged(params, TICameraParameters::KEY_MOT_LEDTORCH))
     {
     setLedTorch((unsigned int) (params.getInt(TICameraParameters::KEY_MOT_LEDTORCH)));
     }
 
     // Needed by camera_test application.
-    if (NULL != params.get(TICameraParameters::KEY_MANUAL_EXPOSURE_TIME_MS))
+    if ((NULL != params.get(TICameraParameters::KEY_MANUAL_EXPOSURE_TIME_MS)) &&
+        isParameterChanged(params, TICameraParameters::KEY_MANUAL_EXPOSURE_TIME_MS))
     {
     setManualExposureTimeMs((unsigned int) (params.getInt(TICameraParameters::KEY_MANUAL_EXPOSURE_TIME_MS)));
     }
@@ -3941,7 +3956,7 @@ status_t OMXCameraAdapter::stopPreview()
 
             {
             Mutex::Autolock lock(mPreviewDataBufferLock);
-            mPreviewDataBuffersAvailable.clear();
+            clearFrameBuffers(mPreviewDataBuffersAvailable);
             }
 
         }
@@ -3962,7 +3977,7 @@ status_t OMXCameraAdapter::stopPreview()
         {
         Mutex::Autolock lock(mPreviewBufferLock);
         ///Clear all the available preview buffers
-        mPreviewBuffersAvailable.clear();
+        clearFrameBuffers(mPreviewBuffersAvailable);
         }
 
 
@@ -4184,11 +4199,17 @@ OMX_ERRORTYPE OMXCameraAdapter::setExposureMode(Gen3A_settings& Gen3A)
     if ( OMX_ErrorNone == eError )
         {
 
+        Mutex::Autolock lock(mFaceDetectionLock);
+
         if ( EXPOSURE_FACE_PRIORITY == Gen3A.Exposure )
                 {
-                //Disable Region priority and enable Face priority
-                setAlgoPriority(REGION_PRIORITY, EXPOSURE_ALGO, false);
-                setAlgoPriority(FACE_PRIORITY, EXPOSURE_ALGO, true);
+                //Disable Region priority and enable Face priority, unless a
+                //tracked face region already drives the exposure
+                if ( !mFaceRegionActive )
+                    {
+                    setAlgoPriority(REGION_PRIORITY, EXPOSURE_ALGO, false);
+                    setAlgoPriority(FACE_PRIORITY, EXPOSURE_ALGO, true);
+                    }
 
                 //Then set the mode to auto
                 Gen3A.WhiteBallance = OMX_ExposureControlAuto;
@@ -4204,7 +4225,7 @@ OMX_ERRORTYPE OMXCameraAdapter::setExposureMode(Gen3A_settings& Gen3A)
         exp.nPortIndex = OMX_ALL;
         exp.eExposureControl = (OMX_EXPOSURECONTROLTYPE)Gen3A.Exposure;
 
-        eError =  OMX_SetConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonExposure, &exp);
+        eError =  m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonExposure, &exp);
         if ( OMX_ErrorNone != eError )
             {
             CAMHAL_LOGEB("Error while configuring exposure mode 0x%x", eError);
@@ -4279,7 +4300,7 @@ status_t OMXCameraAdapter::setAlgoPriority(AlgoPriority priority, Algorithm3A al
                     }
                 }
 
-            eError =  OMX_SetConfig(mCameraAdapterParameters.mHandleComp, ( OMX_INDEXTYPE ) OMX_TI_IndexConfigFacePriority3a, &facePriority);
+            eError =  m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, ( OMX_INDEXTYPE ) OMX_TI_IndexConfigFacePriority3a, &facePriority);
             if ( OMX_ErrorNone != eError )
                 {
                 CAMHAL_LOGEB("Error while configuring face priority 0x%x", eError);
@@ -4332,7 +4353,7 @@ status_t OMXCameraAdapter::setAlgoPriority(AlgoPriority priority, Algorithm3A al
                     }
                 }
 
-            eError =  OMX_SetConfig(mCameraAdapterParameters.mHandleComp, ( OMX_INDEXTYPE ) OMX_TI_IndexConfigRegionPriority3a, &regionPriority);
+            eError =  m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, ( OMX_INDEXTYPE ) OMX_TI_IndexConfigRegionPriority3a, &regionPriority);
             if ( OMX_ErrorNone != eError )
                 {
                 CAMHAL_LOGEB("Error while configuring region priority 0x%x", eError);
@@ -4562,7 +4583,13 @@ status_t OMXCameraAdapter::setFaceDetection(bool enable)
     if ( NO_ERROR == ret )
         {
         Mutex::Autolock lock(mFaceDetectionLock);
+        FaceTracker::Face none;
+
         mFaceDetectionRunning = enable;
+        mFaceTracker.reset();
+        memset(&none, 0, sizeof(none));
+        setFaceRegion(none, false);
+        memset(mFaceDectionResult, '\0', FACE_DETECTION_BUFFER_SIZE);
         }
 
     LOG_FUNCTION_NAME_EXIT
@@ -4699,6 +4726,18 @@ status_t OMXCameraAdapter::detectFaces(OMX_BUFFERHEADERTYPE* pBuffHeader)
         ret = encodeFaceCoordinates(faceData, mFaceDectionResult, FACE_DETECTION_BUFFER_SIZE);
         }
 
+    if ( NO_ERROR == ret )
+        {
+        FaceTracker::Face region;
+        bool valid;
+
+        ///3A only hears about the faces when the region moved noticeably
+        if ( mFaceTracker.getRegion(region, valid) )
+            {
+            ret = setFaceRegion(region, valid);
+            }
+        }
+
     LOG_FUNCTION_NAME_EXIT
 
     return ret;
@@ -4707,10 +4746,9 @@ status_t OMXCameraAdapter::detectFaces(OMX_BUFFERHEADERTYPE* pBuffHeader)
 status_t OMXCameraAdapter::encodeFaceCoordinates(const OMX_FACEDETECTIONTYPE *faceData, char *faceString, size_t faceStringSize)
 {
     status_t ret = NO_ERROR;
-    OMX_TI_FACERESULT *faceResult;
-    size_t faceResultSize;
-    int count = 0;
-    char *p;
+    const OMX_TI_FACERESULT *faceResult;
+    FaceTracker::Face faces[FaceTracker::MAX_FACES];
+    unsigned int count = 0;
 
     LOG_FUNCTION_NAME
 
@@ -4728,45 +4766,110 @@ status_t OMXCameraAdapter::encodeFaceCoordinates(const OMX_FACEDETECTIONTYPE *fa
 
     if ( NO_ERROR == ret )
         {
-
-        p = mFaceDectionResult;
-        faceResultSize = faceStringSize;
-        faceResult = ( OMX_TI_FACERESULT * ) faceData->tFacePosition;
-        if ( 0 < faceData->ulFaceCount )
+        faceResult = faceData->tFacePosition;
+        for ( unsigned int i = 0 ; ( i < faceData->ulFaceCount ) && ( i < FaceTracker::MAX_FACES ) ; i++, faceResult++ )
             {
-            for ( int i = 0  ; i < faceData->ulFaceCount ; i++)
+            if ( mFaceDetectionThreshold <= faceResult->nScore )
                 {
+                CAMHAL_LOGVB("Face %d: left = %d, top = %d, width = %d, height = %d", i,
+                                                       ( int ) faceResult->nLeft,
+                                                       ( int ) faceResult->nTop,
+                                                       ( unsigned int ) faceResult->nWidth,
+                                                       ( unsigned int ) faceResult->nHeight);
+
+                faces[count].mLeft = faceResult->nLeft;
+                faces[count].mTop = faceResult->nTop;
+                faces[count].mWidth = faceResult->nWidth;
+                faces[count].mHeight = faceResult->nHeight;
+                faces[count].mRoll = faceResult->nOrientationRoll;
+                faces[count].mScore = faceResult->nScore;
+                count++;
+                }
+            }
 
-                if ( mFaceDetectionThreshold <= faceResult->nScore )
-                    {
-                    CAMHAL_LOGVB("Face %d: left = %d, top = %d, width = %d, height = %d", i,
-                                                           ( unsigned int ) faceResult->nLeft,
-                                                           ( unsigned int ) faceResult->nTop,
-                                                           ( unsigned int ) faceResult->nWidth,
-                                                           ( unsigned int ) faceResult->nHeight);
-
-                    count = snprintf(p, faceResultSize, "%d,%dx%d,%dx%d,",
-                                                           ( unsigned int ) faceResult->nOrientationRoll,
-                                                           ( unsigned int ) faceResult->nLeft,
-                                                           ( unsigned int ) faceResult->nTop,
-                                                           ( unsigned int ) faceResult->nWidth,
-                                                           ( unsigned int ) faceResult->nHeight);
-                    }
+        ///The string only changes with the tracked faces
+        if ( mFaceTracker.update(faces, count) )
+            {
+            mFaceTracker.encode(faceString, faceStringSize);
+            }
+        }
+
+    LOG_FUNCTION_NAME_EXIT
 
-                p += count;
-                faceResultSize -= count;
-                faceResult++;
+    return ret;
+}
+
+status_t OMXCameraAdapter::setFaceRegion(const FaceTracker::Face &region, bool valid)
+{
+    status_t ret = NO_ERROR;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_CONFIG_EXTFOCUSREGIONTYPE regionControl;
+    OMXCameraPortParameters *previewData;
+    int algo = 0;
+
+    LOG_FUNCTION_NAME
+
+    if ( FOCUS_FACE_PRIORITY == mParameters3A.Focus )
+        {
+        algo |= FOCUS_ALGO;
+        }
+
+    if ( EXPOSURE_FACE_PRIORITY == mParameters3A.Exposure )
+        {
+        algo |= EXPOSURE_ALGO;
+        }
+
+    if ( !valid || ( 0 == algo ) )
+        {
+        ///Back to the face priority of Ducati until a face is tracked again
+        if ( mFaceRegionActive )
+            {
+            setAlgoPriority(REGION_PRIORITY, ( Algorithm3A ) ( FOCUS_ALGO | EXPOSURE_ALGO ), false);
+            if ( 0 != algo )
+                {
+                setAlgoPriority(FACE_PRIORITY, ( Algorithm3A ) algo, true);
                 }
+            mFaceRegionActive = false;
+            }
+
+        LOG_FUNCTION_NAME_EXIT
+        return NO_ERROR;
+        }
+
+    if ( !mFaceRegionActive )
+        {
+        setAlgoPriority(FACE_PRIORITY, ( Algorithm3A ) algo, false);
+        setAlgoPriority(REGION_PRIORITY, ( Algorithm3A ) algo, true);
+        mFaceRegionActive = true;
+        }
+
+    previewData = &mCameraAdapterParameters.mCameraPortParams[mCameraAdapterParameters.mPrevPortIndex];
+    if ( ( 0 == previewData->mWidth ) || ( 0 == previewData->mHeight ) )
+        {
+        CAMHAL_LOGEA("Preview size unknown, face region not set");
+        ret = -EINVAL;
+        }
+
+    if ( NO_ERROR == ret )
+        {
+        OMX_INIT_STRUCT_PTR (&regionControl, OMX_CONFIG_EXTFOCUSREGIONTYPE);
+        regionControl.nLeft = ( region.mLeft * TOUCH_FOCUS_RANGE ) / ( int ) previewData->mWidth;
+        regionControl.nTop = ( region.mTop * TOUCH_FOCUS_RANGE ) / ( int ) previewData->mHeight;
+        regionControl.nWidth = ( region.mWidth * TOUCH_FOCUS_RANGE ) / previewData->mWidth;
+        regionControl.nHeight = ( region.mHeight * TOUCH_FOCUS_RANGE ) / previewData->mHeight;
+
+        eError =  OMX_SetConfig(mCameraAdapterParameters.mHandleComp, ( OMX_INDEXTYPE ) OMX_IndexConfigExtFocusRegion, &regionControl);
+        if ( OMX_ErrorNone != eError )
+            {
+            CAMHAL_LOGEB("Error while configuring face region 0x%x", eError);
+            ret = -1;
             }
         else
             {
-            memset(mFaceDectionResult, '\0', faceStringSize);
+            CAMHAL_LOGDB("Face region %d,%d %dx%d configured successfully", ( int ) regionControl.nLeft,
+                         ( int ) regionControl.nTop, ( int ) regionControl.nWidth, ( int ) regionControl.nHeight);
             }
         }
-    else
-        {
-        memset(mFaceDectionResult, '\0', faceStringSize);
-        }
 
     LOG_FUNCTION_NAME_EXIT
 
@@ -4793,7 +4896,7 @@ OMX_ERRORTYPE OMXCameraAdapter::setScene(Gen3A_settings& Gen3A)
         scene.eSceneMode = ( OMX_SCENEMODETYPE ) Gen3A.SceneMode;
 
         CAMHAL_LOGEB("Configuring scene mode 0x%x", scene.eSceneMode);
-        eError =  OMX_SetConfig(mCameraAdapterParameters.mHandleComp, ( OMX_INDEXTYPE ) OMX_TI_IndexConfigSceneMode, &scene);
+        eError =  m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, ( OMX_INDEXTYPE ) OMX_TI_IndexConfigSceneMode, &scene);
         if ( OMX_ErrorNone != eError )
             {
             CAMHAL_LOGEB("Error while configuring scene mode 0x%x", eError);
@@ -4830,7 +4933,7 @@ OMX_ERRORTYPE OMXCameraAdapter::setFlashMode(Gen3A_settings& Gen3A)
         flash.eFlashControl = ( OMX_IMAGE_FLASHCONTROLTYPE ) Gen3A.FlashMode;
 
         CAMHAL_LOGEB("Configuring flash mode 0x%x", flash.eFlashControl);
-        eError =  OMX_SetConfig(mCameraAdapterParameters.mHandleComp, (OMX_INDEXTYPE) OMX_IndexConfigFlashControl, &flash);
+        eError =  m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, (OMX_INDEXTYPE) OMX_IndexConfigFlashControl, &flash);
         if ( OMX_ErrorNone != eError )
             {
             CAMHAL_LOGEB("Error while configuring flash mode 0x%x", eError);
@@ -5582,12 +5685,17 @@ status_t OMXCameraAdapter::doAutoFocus()
             }
         else if ( FOCUS_FACE_PRIORITY == focusControl.eFocusControl )
             {
+            Mutex::Autolock lock(mFaceDetectionLock);
 
-            //Disable region priority first
-            setAlgoPriority(REGION_PRIORITY, FOCUS_ALGO, false);
+            //A tracked face region already drives the focus
+            if ( !mFaceRegionActive )
+                {
+                //Disable region priority first
+                setAlgoPriority(REGION_PRIORITY, FOCUS_ALGO, false);
 
-            //Enable face algorithm priority
-            setAlgoPriority(FACE_PRIORITY, FOCUS_ALGO, true);
+                //Enable face algorithm priority
+                setAlgoPriority(FACE_PRIORITY, FOCUS_ALGO, true);
+                }
 
             //Do normal focus afterwards
             focusControl.eFocusControl = ( OMX_IMAGE_FOCUSCONTROLTYPE ) OMX_IMAGE_FocusControlExtended;
@@ -7389,8 +7497,11 @@ status_t OMXCameraAdapter::initCameraFrame(CameraFrame &frame,
 OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
 {
     OMX_ERRORTYPE ret = OMX_ErrorNone;
+    OMX_ERRORTYPE eError;
     unsigned int currSett; // 32 bit
-    int portIndex;
+    unsigned int requested, issued;
+    OMX3ATransaction::Error errors[OMX3ATransaction::MAX_CONFIGS];
+    unsigned int errorCount = 0;
 
     /*
      * Scenes have a priority during the process
@@ -7400,15 +7511,43 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
      * for instance the focus mode gets switched.
      * There is only one exception to this rule,
      * the manual a.k.a. auto scene.
+     * Exposure mode comes before EV and ISO, which
+     * share the exposure value config, and the
+     * priority configs before the algorithms they
+     * steer.
      */
-    if ( ( SetSceneMode & mPending3Asettings ) )
-        {
+    static const unsigned int applyOrder[] =
+        {
+        SetExpMode,
+        SetEVCompensation,
+        SetISO,
+        SetFlicker,
+        SetWhiteBallance,
+        SetFocus,
+        SetBrightness,
+        SetContrast,
+        SetSharpness,
+        SetSaturation,
+        SetEffect,
+        SetFlash,
+        };
+
+    ///The scene goes to Ducati on its own and first, the settings below
+    ///start from the exposure and 3A configs it sets up
+    if ( SetSceneMode & mPending3Asettings )
+        {
+        ret = setScene(Gen3A);
         mPending3Asettings &= ~SetSceneMode;
-        return setScene(Gen3A);
         }
 
-    for( currSett = 1; currSett < E3aSettingMax; currSett <<= 1)
+    ///All the configs below go to Ducati in one pass when the transaction commits
+    m3ATransaction.begin(mCameraAdapterParameters.mHandleComp);
+    requested = m3ATransaction.requested();
+    issued = m3ATransaction.issued();
+
+    for ( unsigned int i = 0 ; i < ( sizeof(applyOrder) / sizeof(applyOrder[0]) ) ; i++ )
         {
+        currSett = applyOrder[i];
         if( currSett & mPending3Asettings )
             {
             switch( currSett )
@@ -7419,12 +7558,12 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
                     OMX_INIT_STRUCT_PTR (&expValues, OMX_CONFIG_EXPOSUREVALUETYPE);
                     expValues.nPortIndex = mCameraAdapterParameters.mPrevPortIndex;
 
-                    OMX_GetConfig( mCameraAdapterParameters.mHandleComp,OMX_IndexConfigCommonExposureValue, &expValues);
+                    m3ATransaction.getConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonExposureValue, &expValues);
                     CAMHAL_LOGDB("old EV Compensation for OMX = 0x%x", (int)expValues.xEVCompensation);
                     CAMHAL_LOGDB("EV Compensation for HAL = %d", Gen3A.EVCompensation);
 
                     expValues.xEVCompensation = ( Gen3A.EVCompensation * ( 1 << Q16_OFFSET ) )  / 10;
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp,OMX_IndexConfigCommonExposureValue, &expValues);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonExposureValue, &expValues);
                     CAMHAL_LOGDB("new EV Compensation for OMX = 0x%x", (int)expValues.xEVCompensation);
                     break;
                     }
@@ -7456,7 +7595,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
 
                     CAMHAL_LOGDB("White Ballance for Hal = %d", Gen3A.WhiteBallance);
                     CAMHAL_LOGDB("White Ballance for OMX = %d", (int)wb.eWhiteBalControl);
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonWhiteBalance, &wb);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonWhiteBalance, &wb);
                     break;
                     }
 
@@ -7469,7 +7608,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
 
                     CAMHAL_LOGDB("Flicker for Hal = %d", Gen3A.Flicker);
                     CAMHAL_LOGDB("Flicker for  OMX= %d", (int)flicker.eFlickerCancel);
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp, (OMX_INDEXTYPE)OMX_IndexConfigFlickerCancel, &flicker );
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, (OMX_INDEXTYPE)OMX_IndexConfigFlickerCancel, &flicker );
                     break;
                     }
 
@@ -7481,7 +7620,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
                     brightness.nBrightness = Gen3A.Brightness;
 
                     CAMHAL_LOGDB("Brightness for Hal and OMX= %d", (int)Gen3A.Brightness);
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonBrightness, &brightness);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonBrightness, &brightness);
                     break;
                     }
 
@@ -7493,7 +7632,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
                     contrast.nContrast = Gen3A.Contrast;
 
                     CAMHAL_LOGDB("Contrast for Hal and OMX= %d", (int)Gen3A.Contrast);
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonContrast, &contrast);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonContrast, &contrast);
                     break;
                     }
 
@@ -7514,7 +7653,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
                         }
 
                     CAMHAL_LOGDB("Sharpness for Hal and OMX= %d", (int)Gen3A.Sharpness);
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp, (OMX_INDEXTYPE)OMX_IndexConfigSharpeningLevel, &procSharpness);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, (OMX_INDEXTYPE)OMX_IndexConfigSharpeningLevel, &procSharpness);
                     break;
                     }
 
@@ -7526,7 +7665,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
                     saturation.nSaturation = Gen3A.Saturation;
 
                     CAMHAL_LOGDB("Saturation for Hal and OMX= %d", (int)Gen3A.Saturation);
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonSaturation, &saturation);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonSaturation, &saturation);
                     break;
                     }
 
@@ -7536,7 +7675,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
                     OMX_INIT_STRUCT_PTR (&expValues, OMX_CONFIG_EXPOSUREVALUETYPE);
                     expValues.nPortIndex = mCameraAdapterParameters.mPrevPortIndex;
 
-                    OMX_GetConfig( mCameraAdapterParameters.mHandleComp,OMX_IndexConfigCommonExposureValue, &expValues);
+                    m3ATransaction.getConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonExposureValue, &expValues);
                     if( 0 == Gen3A.ISO )
                         {
                         expValues.bAutoSensitivity = OMX_TRUE;
@@ -7547,7 +7686,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
                         expValues.nSensitivity = Gen3A.ISO;
                         }
                     CAMHAL_LOGDB("ISO for Hal and OMX= %d", (int)Gen3A.ISO);
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp,OMX_IndexConfigCommonExposureValue, &expValues);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonExposureValue, &expValues);
                     }
                     break;
 
@@ -7558,7 +7697,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
                     effect.nPortIndex = mCameraAdapterParameters.mPrevPortIndex;
                     effect.eImageFilter = (OMX_IMAGEFILTERTYPE)Gen3A.Effect;
 
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonImageFilter, &effect);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigCommonImageFilter, &effect);
                     CAMHAL_LOGDB("effect for OMX = 0x%x", (int)effect.eImageFilter);
                     CAMHAL_LOGDB("effect for Hal = %d", Gen3A.Effect);
                     break;
@@ -7577,7 +7716,7 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
 
                     focus.eFocusControl = (OMX_IMAGE_FOCUSCONTROLTYPE)Gen3A.Focus;
 
-                    ret = OMX_SetConfig( mCameraAdapterParameters.mHandleComp, OMX_IndexConfigFocusControl, &focus);
+                    ret = m3ATransaction.setConfig(mCameraAdapterParameters.mHandleComp, OMX_IndexConfigFocusControl, &focus);
                     CAMHAL_LOGDB("Focus type in hal , OMX : %d , 0x%x", Gen3A.Focus, focus.eFocusControl );
 
                     break;
@@ -7604,7 +7743,31 @@ OMX_ERRORTYPE OMXCameraAdapter::apply3Asettings( Gen3A_settings& Gen3A )
             }
         }
 
-        return ret;
+    if ( mPending3Asettings )
+        {
+        CAMHAL_LOGEB("this setting (0x%x) is still not supported in CameraAdapter ", mPending3Asettings);
+        mPending3Asettings = 0;
+        }
+
+    ///Staged configs only fail here, report each one the component rejected
+    eError = m3ATransaction.commit(errors, &errorCount);
+    for ( unsigned int i = 0 ; i < errorCount ; i++ )
+        {
+        CAMHAL_LOGEB("Error 0x%x while configuring 3A config 0x%x",
+                     errors[i].mError,
+                     errors[i].mIndex);
+        }
+
+    if ( OMX_ErrorNone == ret )
+        {
+        ret = eError;
+        }
+
+    CAMHAL_LOGDB("3A settings applied with %u round trips instead of %u",
+                 m3ATransaction.issued() - issued,
+                 m3ATransaction.requested() - requested);
+
+    return ret;
 }
 
 int OMXCameraAdapter::getLUTvalue_HALtoOMX(const char * HalValue, LUTtype LUT)
@@ -53,9 +53,10 @@ OverlayDisplayAdapter::OverlayDisplayAdapter():mDisplayThread(NULL),
 {
     LOG_FUNCTION_NAME
 
+    mShotToShot = false;
+
 #if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
 
-    mShotToShot = false;
     mStartCapture.tv_sec = 0;
     mStartCapture.tv_usec = 0;
     mStandbyToShot.tv_sec = 0;
@@ -277,11 +278,15 @@ int OverlayDisplayAdapter::enableDisplay(struct timeval *refTime)
         {
         Mutex::Autolock lock(mLock);
         memcpy(&mStandbyToShot, refTime, sizeof( struct timeval ));
-        mMeasureStandby = true;
         }
 
 #endif
 
+    {
+    Mutex::Autolock lock(mLock);
+    mMeasureStandby = true;
+    }
+
     mFirstFrame = true;
 
     //Send START_DISPLAY COMMAND to display thread. Display thread will start and then wait for a message
@@ -843,6 +848,7 @@ status_t OverlayDisplayAdapter::PostFrame(OverlayDisplayAdapter::DisplayFrame &d
         else
             {
             mFramesWithDisplay++;
+            TRACE_COUNTER(CAMTRACE_FramesWithDisplay, mFramesWithDisplay);
 
               if(mFramesWithDisplay> OPTIMAL_BUFFER_COUNT_WITH_DISPLAY)
                 {
@@ -851,25 +857,30 @@ status_t OverlayDisplayAdapter::PostFrame(OverlayDisplayAdapter::DisplayFrame &d
                 mDisplayQ.put(&msg);
                 }
 
-#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
-
             if ( mMeasureStandby )
                 {
+                TRACE_ASYNC_END(CAMTRACE_StandbyToShot, 0);
+#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
                 CameraHal::PPM("Standby to first shot: Sensor Change completed - ", &mStandbyToShot);
+#endif
                 mMeasureStandby = false;
                 }
             else if (CameraFrame::CameraFrame::SNAPSHOT_FRAME == dispFrame.mType)
                 {
+                TRACE_ASYNC_END(CAMTRACE_ShotToSnapshot, 0);
+#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
                 CameraHal::PPM("Shot to snapshot: ", &mStartCapture);
+#endif
                 mShotToShot = true;
                 }
             else if ( mShotToShot )
                 {
+                TRACE_ASYNC_END(CAMTRACE_ShotToShot, 0);
+#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
                 CameraHal::PPM("Shot to shot: ", &mStartCapture);
+#endif
                 mShotToShot = false;
                 }
-
-#endif
             if((actualFramesWithDisplay!=mFramesWithDisplay))
                 {
                 if(actualFramesWithDisplay==1)
@@ -992,6 +1003,7 @@ bool OverlayDisplayAdapter::handleFrameReturn()
     mFramesWithDisplayMap.removeItem(mPreviewBufferMap[(int)buf]);
 
     mFramesWithDisplay--;
+    TRACE_COUNTER(CAMTRACE_FramesWithDisplay, mFramesWithDisplay);
     ///Overlay still holds one buffer back as long as display is enabled
     if ( 1 == mFramesWithDisplay )
         {
@@ -49,6 +49,7 @@ const char TICameraParameters::KEY_FACE_DETECTION_ENABLE[] = "face-detection-ena
 const char TICameraParameters::KEY_FACE_DETECTION_DATA[] = "face-detection-data";
 const char TICameraParameters::KEY_FACE_DETECTION_THRESHOLD[] = "face-detection-threshold";
 const char TICameraParameters::KEY_BURST[] = "burst-capture";
+const char TICameraParameters::KEY_ZSL_DEPTH[] = "zsl-depth";
 const char TICameraParameters::KEY_CAP_MODE[] = "mode";
 const char TICameraParameters::KEY_VSTAB[] = "vstab";
 const char TICameraParameters::KEY_VSTAB_VALUES[] = "vstab-values";
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#define LOG_TAG "CameraHal"
+
+#include "CameraHal.h"
+#include "ZslRing.h"
+
+namespace android {
+
+ZslRing::ZslRing()
+    : mHead(0), mCount(0), mDepth(0)
+{
+}
+
+status_t ZslRing::setDepth(unsigned int depth)
+{
+    Mutex::Autolock lock(mLock);
+
+    if ( MAX_DEPTH < depth )
+        {
+        CAMHAL_LOGEB("ZSL depth %u above %d", depth, MAX_DEPTH);
+        return BAD_VALUE;
+        }
+
+    if ( 0 != mCount )
+        {
+        CAMHAL_LOGEA("ZSL ring has to be flushed before the depth changes");
+        return INVALID_OPERATION;
+        }
+
+    mDepth = depth;
+    mHead = 0;
+
+    return NO_ERROR;
+}
+
+unsigned int ZslRing::getDepth() const
+{
+    Mutex::Autolock lock(mLock);
+
+    return mDepth;
+}
+
+unsigned int ZslRing::getCount() const
+{
+    Mutex::Autolock lock(mLock);
+
+    return mCount;
+}
+
+status_t ZslRing::push(const Frame &frame, void *&evicted)
+{
+    Mutex::Autolock lock(mLock);
+
+    evicted = NULL;
+
+    if ( 0 == mDepth )
+        {
+        return NO_INIT;
+        }
+
+    if ( mDepth == mCount )
+        {
+        evicted = mFrames[mHead].mBuffer;
+        mHead = ( mHead + 1 ) % MAX_DEPTH;
+        mCount--;
+        }
+
+    mFrames[( mHead + mCount ) % MAX_DEPTH] = frame;
+    mCount++;
+
+    return NO_ERROR;
+}
+
+status_t ZslRing::select(nsecs_t shutter, Frame &frame)
+{
+    Mutex::Autolock lock(mLock);
+    unsigned int best = mCount;
+    nsecs_t bestDistance = 0;
+    bool bestConverged = false;
+
+    for ( unsigned int i = 0 ; i < mCount ; i++ )
+        {
+        const Frame &candidate = mFrames[( mHead + i ) % MAX_DEPTH];
+        nsecs_t distance = candidate.mTimestamp - shutter;
+
+        if ( 0 > distance )
+            {
+            distance = -distance;
+            }
+
+        ///A converged frame always wins over one that was still settling
+        if ( ( mCount == best ) ||
+             ( candidate.mMetadata.mConverged && !bestConverged ) ||
+             ( ( candidate.mMetadata.mConverged == bestConverged ) && ( distance < bestDistance ) ) )
+            {
+            best = i;
+            bestDistance = distance;
+            bestConverged = candidate.mMetadata.mConverged;
+            }
+        }
+
+    if ( mCount == best )
+        {
+        return NOT_ENOUGH_DATA;
+        }
+
+    frame = mFrames[( mHead + best ) % MAX_DEPTH];
+    remove(best);
+
+    CAMHAL_LOGDB("ZSL frame %lld us from shutter, %u left", bestDistance / 1000, mCount);
+
+    return NO_ERROR;
+}
+
+bool ZslRing::pop(Frame &frame)
+{
+    Mutex::Autolock lock(mLock);
+
+    if ( 0 == mCount )
+        {
+        return false;
+        }
+
+    frame = mFrames[mHead];
+    remove(0);
+
+    return true;
+}
+
+///Closes the gap left by the frame at pos, newer frames move one slot back
+void ZslRing::remove(unsigned int pos)
+{
+    for ( unsigned int i = pos ; i + 1 < mCount ; i++ )
+        {
+        mFrames[( mHead + i ) % MAX_DEPTH] = mFrames[( mHead + i + 1 ) % MAX_DEPTH];
+        }
+
+    mCount--;
+}
+
+};
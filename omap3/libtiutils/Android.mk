@@ -11,6 +11,17 @@ LOCAL_SRC_FILES:= \
     MessageQueue.cpp \
     Semaphore.cpp \
     ErrorUtils.cpp \
+    TraceRing.cpp \
+    ExifTemplate.cpp \
+
+LOCAL_SRC_FILES += PixelKernels.cpp BayerStats.cpp YuvScaler.cpp
+
+#The pixel kernels, Bayer statistics and scaler select their NEON variant at runtime.
+#Only the NEON row kernels are built with -mfpu=neon, the dispatchers stay plain
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+LOCAL_SRC_FILES += PixelKernels_neon.cpp.neon BayerStats_neon.cpp.neon YuvScaler_neon.cpp.neon
+LOCAL_CFLAGS += -DLIBTIUTILS_NEON
+endif
 
 
     
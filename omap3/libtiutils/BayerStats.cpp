@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <pthread.h>
+#include <string.h>
+
+#define LOG_TAG "BayerStats"
+#include <utils/Log.h>
+
+#include "BayerStats.h"
+#include "PixelKernels.h"
+#include "RowKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BAYER_STATS_SSE2
+#endif
+
+///The NEON row kernel is built in BayerStats_neon.cpp
+#ifdef LIBTIUTILS_NEON
+#define BAYER_STATS_NEON
+#endif
+
+namespace android {
+
+///Row kernels process as many leading pixels as their vector width allows and
+///return how many they did. The scalar code finishes the row.
+///Vector sums use 32 bit lanes, which holds for rows below 2^19 pixels.
+typedef size_t (*ZoneRow)(RowStats *stats, const uint16_t *row, size_t width);
+
+/*--------------------Scalar kernels-----------------------------*/
+
+static void zoneRowTail(RowStats *stats, const uint16_t *row, size_t from, size_t width)
+{
+    for ( size_t x = from ; x < width ; x += 2 )
+        {
+        for ( int c = 0 ; c < 2 ; c++ )
+            {
+            uint16_t value = row[x + c];
+
+            stats->sum[c] += value;
+            if ( value < stats->min[c] )
+                {
+                stats->min[c] = value;
+                }
+            if ( value > stats->max[c] )
+                {
+                stats->max[c] = value;
+                }
+            }
+        }
+}
+
+static void zoneStatsRows(ZoneRow rowFn, BayerStats::Zone *zone, const uint16_t *src, size_t width,
+                          size_t height, size_t stride)
+{
+    for ( int c = 0 ; c < BayerStats::CHANNELS ; c++ )
+        {
+        zone->sum[c] = 0;
+        zone->min[c] = 0xFFFF;
+        zone->max[c] = 0;
+        }
+
+    for ( size_t y = 0 ; y < height ; y++, src += stride )
+        {
+        int base = ( y & 1 ) * 2;
+        RowStats stats;
+
+        for ( int c = 0 ; c < 2 ; c++ )
+            {
+            stats.sum[c] = 0;
+            stats.min[c] = 0xFFFF;
+            stats.max[c] = 0;
+            }
+
+        size_t done = ( NULL != rowFn ) ? rowFn(&stats, src, width) : 0;
+
+        zoneRowTail(&stats, src, done, width);
+
+        for ( int c = 0 ; c < 2 ; c++ )
+            {
+            zone->sum[base + c] += stats.sum[c];
+            if ( stats.min[c] < zone->min[base + c] )
+                {
+                zone->min[base + c] = stats.min[c];
+                }
+            if ( stats.max[c] > zone->max[base + c] )
+                {
+                zone->max[base + c] = stats.max[c];
+                }
+            }
+        }
+}
+
+static void zoneStatsScalar(BayerStats::Zone *zone, const uint16_t *src, size_t width, size_t height,
+                            size_t stride)
+{
+    zoneStatsRows(NULL, zone, src, width, height, stride);
+}
+
+static void histogramScalar(uint32_t *hist, unsigned int bits, const uint16_t *src, size_t width,
+                            size_t height, size_t stride)
+{
+    unsigned int shift = ( 8 < bits ) ? ( bits - 8 ) : 0;
+
+    for ( size_t y = 0 ; y < height ; y++, src += stride )
+        {
+        uint32_t *h0 = hist + ( y & 1 ) * 2 * BayerStats::HISTOGRAM_BINS;
+        uint32_t *h1 = h0 + BayerStats::HISTOGRAM_BINS;
+
+        for ( size_t x = 0 ; x < width ; x += 2 )
+            {
+            unsigned int b0 = src[x] >> shift;
+            unsigned int b1 = src[x + 1] >> shift;
+
+            h0[( BayerStats::HISTOGRAM_BINS > b0 ) ? b0 : ( BayerStats::HISTOGRAM_BINS - 1 )]++;
+            h1[( BayerStats::HISTOGRAM_BINS > b1 ) ? b1 : ( BayerStats::HISTOGRAM_BINS - 1 )]++;
+            }
+        }
+}
+
+static const BayerStats sScalarStats =
+{
+    "scalar",
+    zoneStatsScalar,
+    histogramScalar,
+};
+
+/*--------------------SSE2 kernels-----------------------------*/
+
+#ifdef BAYER_STATS_SSE2
+
+///SSE2 has no unsigned 16 bit min/max, the values are biased into the signed range
+static size_t zoneRowSSE2(RowStats *stats, const uint16_t *row, size_t width)
+{
+    const __m128i lowMask = _mm_set1_epi32(0xFFFF);
+    const __m128i bias = _mm_set1_epi16((short) 0x8000);
+    __m128i sum0 = _mm_setzero_si128();
+    __m128i sum1 = _mm_setzero_si128();
+    __m128i vmin = _mm_set1_epi16(0x7FFF);
+    __m128i vmax = _mm_set1_epi16((short) 0x8000);
+    uint32_t sums[2][4];
+    uint16_t mins[8], maxs[8];
+    size_t x = 0;
+
+    for ( ; x + 8 <= width ; x += 8 )
+        {
+        __m128i v = _mm_loadu_si128((const __m128i *) ( row + x ));
+        __m128i biased = _mm_xor_si128(v, bias);
+
+        sum0 = _mm_add_epi32(sum0, _mm_and_si128(v, lowMask));
+        sum1 = _mm_add_epi32(sum1, _mm_srli_epi32(v, 16));
+        vmin = _mm_min_epi16(vmin, biased);
+        vmax = _mm_max_epi16(vmax, biased);
+        }
+
+    if ( 0 == x )
+        {
+        return 0;
+        }
+
+    _mm_storeu_si128((__m128i *) sums[0], sum0);
+    _mm_storeu_si128((__m128i *) sums[1], sum1);
+    _mm_storeu_si128((__m128i *) mins, _mm_xor_si128(vmin, bias));
+    _mm_storeu_si128((__m128i *) maxs, _mm_xor_si128(vmax, bias));
+
+    for ( int c = 0 ; c < 2 ; c++ )
+        {
+        stats->sum[c] += (uint64_t) sums[c][0] + sums[c][1] + sums[c][2] + sums[c][3];
+
+        for ( int i = c ; i < 8 ; i += 2 )
+            {
+            if ( mins[i] < stats->min[c] )
+                {
+                stats->min[c] = mins[i];
+                }
+            if ( maxs[i] > stats->max[c] )
+                {
+                stats->max[c] = maxs[i];
+                }
+            }
+        }
+
+    return x;
+}
+
+static void zoneStatsSSE2(BayerStats::Zone *zone, const uint16_t *src, size_t width, size_t height,
+                          size_t stride)
+{
+    zoneStatsRows(zoneRowSSE2, zone, src, width, height, stride);
+}
+
+static const BayerStats sSSE2Stats =
+{
+    "sse2",
+    zoneStatsSSE2,
+    histogramScalar,
+};
+
+#endif
+
+/*--------------------NEON kernels-----------------------------*/
+
+#ifdef BAYER_STATS_NEON
+
+static void zoneStatsNEON(BayerStats::Zone *zone, const uint16_t *src, size_t width, size_t height,
+                          size_t stride)
+{
+    zoneStatsRows(zoneRowNEON, zone, src, width, height, stride);
+}
+
+static const BayerStats sNEONStats =
+{
+    "neon",
+    zoneStatsNEON,
+    histogramScalar,
+};
+
+///PixelKernels already knows whether the CPU has NEON
+static bool neonSupported()
+{
+    return ( NULL != PixelKernels::get("neon") );
+}
+
+#endif
+
+/*--------------------Implementation selection-----------------------------*/
+
+static bool alwaysSupported()
+{
+    return true;
+}
+
+struct BayerStatsEntry
+{
+    const BayerStats *stats;
+    bool (*supported)();
+};
+
+///Candidate implementations, fastest first
+static const BayerStatsEntry sStats[] =
+{
+#ifdef BAYER_STATS_NEON
+    { &sNEONStats, neonSupported },
+#endif
+#ifdef BAYER_STATS_SSE2
+    { &sSSE2Stats, alwaysSupported },
+#endif
+    { &sScalarStats, alwaysSupported },
+};
+
+static pthread_once_t sSelectOnce = PTHREAD_ONCE_INIT;
+static const BayerStats *sSelected = &sScalarStats;
+
+static void selectStats()
+{
+    for ( size_t i = 0 ; i < sizeof(sStats) / sizeof(sStats[0]) ; i++ )
+        {
+        if ( sStats[i].supported() )
+            {
+            sSelected = sStats[i].stats;
+            break;
+            }
+        }
+
+    LOGD("Using %s Bayer statistics", sSelected->name);
+}
+
+/**
+   @brief Returns the fastest Bayer statistics supported by the CPU
+
+   @param none
+   @return Implementation, never NULL
+ */
+const BayerStats* BayerStats::get()
+{
+    pthread_once(&sSelectOnce, selectStats);
+
+    return sSelected;
+}
+
+/**
+   @brief Returns the Bayer statistics with the given name
+
+   @param name Implementation name
+   @return Implementation
+   @return NULL if the implementation is not built in or not supported by the CPU
+ */
+const BayerStats* BayerStats::get(const char *name)
+{
+    if ( NULL == name )
+        {
+        return NULL;
+        }
+
+    for ( size_t i = 0 ; i < sizeof(sStats) / sizeof(sStats[0]) ; i++ )
+        {
+        if ( ( 0 == strcmp(sStats[i].stats->name, name) ) && sStats[i].supported() )
+            {
+            return sStats[i].stats;
+            }
+        }
+
+    return NULL;
+}
+
+};
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef BAYER_STATS_H
+#define BAYER_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace android {
+
+///Statistics of RAW Bayer frames, 16 bits per pixel
+///Channels follow the 2x2 Bayer cell: 0 and 1 are the even row, 2 and 3 the
+///odd row, whatever colors the sensor pattern puts there. Like PixelKernels,
+///there is one implementation per instruction set (scalar, SSE2, NEON), all of
+///them bit-exact.
+class BayerStats
+{
+public:
+
+    enum
+        {
+        CHANNELS = 4,
+        HISTOGRAM_BINS = 256
+        };
+
+    ///Statistics of one zone
+    struct Zone
+        {
+        uint64_t sum[CHANNELS];
+        uint16_t min[CHANNELS];
+        uint16_t max[CHANNELS];
+        };
+
+    ///Returns the fastest implementation supported by the CPU
+    static const BayerStats* get();
+
+    ///Returns the named implementation, or NULL if the build or the CPU does not support it
+    static const BayerStats* get(const char *name);
+
+    ///Name of the implementation ("scalar", "sse2" or "neon")
+    const char *name;
+
+    ///Per channel sum, minimum and maximum of a zone of width x height pixels.
+    ///width and height must be even, stride is in pixels
+    void (*zoneStats)(Zone *zone, const uint16_t *src, size_t width, size_t height, size_t stride);
+
+    ///Adds a zone to per channel histograms of HISTOGRAM_BINS bins each, channel
+    ///after channel. Pixels have bits significant bits, at least 8; larger values
+    ///count in the last bin. Histograms are bound by their scattered stores, all
+    ///implementations share the scalar one
+    void (*histogram)(uint32_t *hist, unsigned int bits, const uint16_t *src, size_t width, size_t height,
+                      size_t stride);
+};
+
+};
+
+#endif //BAYER_STATS_H
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///NEON row kernel of BayerStats, the only part of it built with -mfpu=neon
+
+#include <arm_neon.h>
+
+#include "RowKernels.h"
+
+namespace android {
+
+size_t zoneRowNEON(RowStats *stats, const uint16_t *row, size_t width)
+{
+    uint32x4_t sum0 = vdupq_n_u32(0);
+    uint32x4_t sum1 = vdupq_n_u32(0);
+    uint16x8_t min0 = vdupq_n_u16(0xFFFF);
+    uint16x8_t min1 = vdupq_n_u16(0xFFFF);
+    uint16x8_t max0 = vdupq_n_u16(0);
+    uint16x8_t max1 = vdupq_n_u16(0);
+    uint32_t sums[2][4];
+    uint16_t mins[2][8], maxs[2][8];
+    size_t x = 0;
+
+    ///vld2 splits 16 pixels into the two channels of the row
+    for ( ; x + 16 <= width ; x += 16 )
+        {
+        uint16x8x2_t v = vld2q_u16(row + x);
+
+        sum0 = vpadalq_u16(sum0, v.val[0]);
+        sum1 = vpadalq_u16(sum1, v.val[1]);
+        min0 = vminq_u16(min0, v.val[0]);
+        min1 = vminq_u16(min1, v.val[1]);
+        max0 = vmaxq_u16(max0, v.val[0]);
+        max1 = vmaxq_u16(max1, v.val[1]);
+        }
+
+    if ( 0 == x )
+        {
+        return 0;
+        }
+
+    vst1q_u32(sums[0], sum0);
+    vst1q_u32(sums[1], sum1);
+    vst1q_u16(mins[0], min0);
+    vst1q_u16(mins[1], min1);
+    vst1q_u16(maxs[0], max0);
+    vst1q_u16(maxs[1], max1);
+
+    for ( int c = 0 ; c < 2 ; c++ )
+        {
+        stats->sum[c] += (uint64_t) sums[c][0] + sums[c][1] + sums[c][2] + sums[c][3];
+
+        for ( int i = 0 ; i < 8 ; i++ )
+            {
+            if ( mins[c][i] < stats->min[c] )
+                {
+                stats->min[c] = mins[c][i];
+                }
+            if ( maxs[c][i] > stats->max[c] )
+                {
+                stats->max[c] = maxs[c][i];
+                }
+            }
+        }
+
+    return x;
+}
+
+};
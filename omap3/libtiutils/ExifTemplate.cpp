@@ -0,0 +1,599 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <string.h>
+#include <time.h>
+
+#include "ExifTemplate.h"
+
+namespace android {
+
+#define EXIF_HEADER_SIZE    6
+#define TIFF_HEADER_SIZE    8
+#define IFD_ENTRY_SIZE      12
+#define MAX_IFD_ENTRIES     24
+///Largest value of one tag, at least the GPS strings reserved
+#define MAX_VALUE_SIZE      64
+#define DATE_TIME_SIZE      20
+#define SUB_SEC_TIME_SIZE   7
+#define DATE_STAMP_SIZE     11
+
+enum
+{
+    TYPE_BYTE = 1,
+    TYPE_ASCII = 2,
+    TYPE_SHORT = 3,
+    TYPE_LONG = 4,
+    TYPE_RATIONAL = 5,
+    TYPE_UNDEFINED = 7
+};
+
+///IFDs, in their order in the template
+enum
+{
+    IFD_0 = 0,
+    IFD_EXIF,
+    IFD_INTEROPERABILITY,
+    IFD_GPS,
+    IFD_1,
+    IFD_COUNT
+};
+
+static const char sExifHeader[EXIF_HEADER_SIZE] = { 'E', 'x', 'i', 'f', 0, 0 };
+static const uint8_t sAsciiCode[8] = { 'A', 'S', 'C', 'I', 'I', 0, 0, 0 };
+
+struct IfdEntry
+{
+    uint16_t tag;
+    uint16_t type;
+    uint32_t count;
+    uint8_t value[MAX_VALUE_SIZE];
+    int field;
+    ///IFD whose offset is the value, or -1
+    int pointer;
+};
+
+///One IFD while the template is laid out
+struct IfdBuilder
+{
+    IfdEntry entries[MAX_IFD_ENTRIES];
+    unsigned int count;
+    ///From the TIFF header
+    uint32_t offset;
+    uint32_t size;
+    bool failed;
+};
+
+static inline void put16(uint8_t *p, uint32_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = ( value >> 8 ) & 0xFF;
+}
+
+static inline void put32(uint8_t *p, uint32_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = ( value >> 8 ) & 0xFF;
+    p[2] = ( value >> 16 ) & 0xFF;
+    p[3] = ( value >> 24 ) & 0xFF;
+}
+
+static inline void putRationals(uint8_t *p, const uint32_t *values, unsigned int count)
+{
+    for ( unsigned int i = 0 ; i < 2 * count ; i++ )
+        {
+        put32(p + 4 * i, values[i]);
+        }
+}
+
+///Zero padded decimal
+static inline void putDecimal(uint8_t *p, unsigned int value, unsigned int digits)
+{
+    while ( digits-- )
+        {
+        p[digits] = '0' + value % 10;
+        value /= 10;
+        }
+}
+
+static unsigned int typeSize(uint16_t type)
+{
+    switch ( type )
+        {
+        case TYPE_SHORT:
+            return 2;
+        case TYPE_LONG:
+            return 4;
+        case TYPE_RATIONAL:
+            return 8;
+        default:
+            return 1;
+        }
+}
+
+///Entries are added in increasing tag order, as TIFF requires
+static IfdEntry* addEntry(IfdBuilder *ifd, uint16_t tag, uint16_t type, uint32_t count, int field)
+{
+    IfdEntry *entry;
+
+    if ( ( MAX_IFD_ENTRIES == ifd->count ) || ( MAX_VALUE_SIZE < typeSize(type) * count ) ||
+         ( ( 0 < ifd->count ) && ( ifd->entries[ifd->count - 1].tag >= tag ) ) )
+        {
+        ifd->failed = true;
+        return NULL;
+        }
+
+    entry = &ifd->entries[ifd->count++];
+    memset(entry, 0, sizeof(IfdEntry));
+    entry->tag = tag;
+    entry->type = type;
+    entry->count = count;
+    entry->field = field;
+    entry->pointer = -1;
+
+    return entry;
+}
+
+static void addShort(IfdBuilder *ifd, uint16_t tag, uint16_t value, int field)
+{
+    IfdEntry *entry = addEntry(ifd, tag, TYPE_SHORT, 1, field);
+
+    if ( NULL != entry )
+        {
+        put16(entry->value, value);
+        }
+}
+
+static void addLong(IfdBuilder *ifd, uint16_t tag, uint32_t value, int field)
+{
+    IfdEntry *entry = addEntry(ifd, tag, TYPE_LONG, 1, field);
+
+    if ( NULL != entry )
+        {
+        put32(entry->value, value);
+        }
+}
+
+static void addRationals(IfdBuilder *ifd, uint16_t tag, const uint32_t *values, unsigned int count, int field)
+{
+    IfdEntry *entry = addEntry(ifd, tag, TYPE_RATIONAL, count, field);
+
+    if ( NULL != entry )
+        {
+        putRationals(entry->value, values, count);
+        }
+}
+
+///size reserves room for longer strings, terminator included
+static void addAscii(IfdBuilder *ifd, uint16_t tag, const char *value, uint32_t size, int field)
+{
+    IfdEntry *entry = addEntry(ifd, tag, TYPE_ASCII, size, field);
+
+    if ( ( NULL != entry ) && ( NULL != value ) )
+        {
+        strncpy(( char * ) entry->value, value, size - 1);
+        }
+}
+
+static void addBytes(IfdBuilder *ifd, uint16_t tag, uint16_t type, const uint8_t *value, uint32_t count,
+                     int field)
+{
+    IfdEntry *entry = addEntry(ifd, tag, type, count, field);
+
+    if ( ( NULL != entry ) && ( NULL != value ) )
+        {
+        memcpy(entry->value, value, count);
+        }
+}
+
+static void addPointer(IfdBuilder *ifd, uint16_t tag, int pointer)
+{
+    IfdEntry *entry = addEntry(ifd, tag, TYPE_LONG, 1, -1);
+
+    if ( NULL != entry )
+        {
+        entry->pointer = pointer;
+        }
+}
+
+ExifTemplate::ExifTemplate()
+{
+    memset(mLayouts, 0, sizeof(mLayouts));
+    mBuilt = false;
+    mThumbnail = false;
+}
+
+status_t ExifTemplate::build(const Setup &setup)
+{
+    status_t ret;
+
+    mBuilt = false;
+    mThumbnail = setup.thumbnail;
+
+    ret = layout(setup, false, &mLayouts[0]);
+    if ( NO_ERROR == ret )
+        {
+        ret = layout(setup, true, &mLayouts[1]);
+        }
+
+    mBuilt = ( NO_ERROR == ret );
+
+    return ret;
+}
+
+status_t ExifTemplate::layout(const Setup &setup, bool gps, Layout *layout)
+{
+    static const uint32_t resolution[2] = { 72, 1 };
+    static const uint32_t zero[6] = { 0, 1, 0, 1, 0, 1 };
+    static const uint8_t exifVersion[4] = { '0', '2', '2', '0' };
+    static const uint8_t flashpixVersion[4] = { '0', '1', '0', '0' };
+    static const uint8_t components[4] = { 1, 2, 3, 0 };
+    static const uint8_t fileSource = 3;
+    static const uint8_t sceneType = 1;
+    IfdBuilder *ifds = new IfdBuilder[IFD_COUNT];
+    uint32_t offset = TIFF_HEADER_SIZE;
+    status_t ret = NO_ERROR;
+
+    if ( NULL == ifds )
+        {
+        return NO_MEMORY;
+        }
+
+    memset(ifds, 0, IFD_COUNT * sizeof(IfdBuilder));
+    memset(layout, 0, sizeof(Layout));
+
+    IfdBuilder *ifd = &ifds[IFD_0];
+    addLong(ifd, 0x0100, 0, FIELD_WIDTH);
+    addLong(ifd, 0x0101, 0, FIELD_HEIGHT);
+    addAscii(ifd, 0x010F, setup.make, MAX_STRING_SIZE, FIELD_NONE);
+    addAscii(ifd, 0x0110, setup.model, MAX_STRING_SIZE, FIELD_NONE);
+    addShort(ifd, 0x0112, 1, FIELD_ORIENTATION);
+    addRationals(ifd, 0x011A, resolution, 1, FIELD_NONE);
+    addRationals(ifd, 0x011B, resolution, 1, FIELD_NONE);
+    ///Inches
+    addShort(ifd, 0x0128, 2, FIELD_NONE);
+    addAscii(ifd, 0x0132, NULL, DATE_TIME_SIZE, FIELD_DATE_TIME);
+    ///Centered
+    addShort(ifd, 0x0213, 1, FIELD_NONE);
+    addPointer(ifd, 0x8769, IFD_EXIF);
+    if ( gps )
+        {
+        addPointer(ifd, 0x8825, IFD_GPS);
+        }
+
+    ifd = &ifds[IFD_EXIF];
+    addRationals(ifd, 0x829A, zero, 1, FIELD_EXPOSURE_TIME);
+    addShort(ifd, 0x8827, 0, FIELD_ISO);
+    addBytes(ifd, 0x9000, TYPE_UNDEFINED, exifVersion, sizeof(exifVersion), FIELD_NONE);
+    addAscii(ifd, 0x9003, NULL, DATE_TIME_SIZE, FIELD_DATE_TIME_ORIGINAL);
+    addAscii(ifd, 0x9004, NULL, DATE_TIME_SIZE, FIELD_DATE_TIME_DIGITIZED);
+    addBytes(ifd, 0x9101, TYPE_UNDEFINED, components, sizeof(components), FIELD_NONE);
+    addShort(ifd, 0x9207, 0, FIELD_METERING_MODE);
+    ///No flash
+    addShort(ifd, 0x9209, 0, FIELD_NONE);
+    addRationals(ifd, 0x920A, setup.focalLength, 1, FIELD_NONE);
+    addAscii(ifd, 0x9290, NULL, SUB_SEC_TIME_SIZE, FIELD_SUB_SEC_TIME);
+    addAscii(ifd, 0x9291, NULL, SUB_SEC_TIME_SIZE, FIELD_SUB_SEC_TIME_ORIGINAL);
+    addAscii(ifd, 0x9292, NULL, SUB_SEC_TIME_SIZE, FIELD_SUB_SEC_TIME_DIGITIZED);
+    addBytes(ifd, 0xA000, TYPE_UNDEFINED, flashpixVersion, sizeof(flashpixVersion), FIELD_NONE);
+    ///sRGB
+    addShort(ifd, 0xA001, 1, FIELD_NONE);
+    addLong(ifd, 0xA002, 0, FIELD_PIXEL_X);
+    addLong(ifd, 0xA003, 0, FIELD_PIXEL_Y);
+    addPointer(ifd, 0xA005, IFD_INTEROPERABILITY);
+    ///Digital still camera, directly photographed
+    addBytes(ifd, 0xA300, TYPE_UNDEFINED, &fileSource, 1, FIELD_NONE);
+    addBytes(ifd, 0xA301, TYPE_UNDEFINED, &sceneType, 1, FIELD_NONE);
+    addShort(ifd, 0xA403, 0, FIELD_WHITE_BALANCE);
+    addRationals(ifd, 0xA404, zero, 1, FIELD_DIGITAL_ZOOM);
+
+    ifd = &ifds[IFD_INTEROPERABILITY];
+    addAscii(ifd, 0x0001, "R98", 4, FIELD_NONE);
+    addBytes(ifd, 0x0002, TYPE_UNDEFINED, flashpixVersion, sizeof(flashpixVersion), FIELD_NONE);
+
+    if ( gps )
+        {
+        ifd = &ifds[IFD_GPS];
+        addBytes(ifd, 0x0000, TYPE_BYTE, NULL, 4, FIELD_GPS_VERSION);
+        addAscii(ifd, 0x0001, NULL, 2, FIELD_GPS_LATITUDE_REF);
+        addRationals(ifd, 0x0002, zero, 3, FIELD_GPS_LATITUDE);
+        addAscii(ifd, 0x0003, NULL, 2, FIELD_GPS_LONGITUDE_REF);
+        addRationals(ifd, 0x0004, zero, 3, FIELD_GPS_LONGITUDE);
+        addBytes(ifd, 0x0005, TYPE_BYTE, NULL, 1, FIELD_GPS_ALTITUDE_REF);
+        addRationals(ifd, 0x0006, zero, 1, FIELD_GPS_ALTITUDE);
+        addRationals(ifd, 0x0007, zero, 3, FIELD_GPS_TIME_STAMP);
+        addAscii(ifd, 0x0012, NULL, GPS_MAP_DATUM_SIZE, FIELD_GPS_MAP_DATUM);
+        addBytes(ifd, 0x001B, TYPE_UNDEFINED, NULL, GPS_PROCESSING_SIZE, FIELD_GPS_PROCESSING_METHOD);
+        addAscii(ifd, 0x001D, NULL, DATE_STAMP_SIZE, FIELD_GPS_DATE_STAMP);
+        }
+
+    if ( setup.thumbnail )
+        {
+        ifd = &ifds[IFD_1];
+        ///JPEG
+        addShort(ifd, 0x0103, 6, FIELD_NONE);
+        addLong(ifd, 0x0201, 0xFFFFFFFF, FIELD_THUMBNAIL_OFFSET);
+        addLong(ifd, 0x0202, 0xFFFFFFFF, FIELD_THUMBNAIL_LENGTH);
+        }
+
+    ///Offsets of the IFDs and of their values
+    for ( int i = 0 ; i < IFD_COUNT ; i++ )
+        {
+        ifd = &ifds[i];
+        if ( ifd->failed )
+            {
+            ret = BAD_VALUE;
+            }
+
+        if ( 0 == ifd->count )
+            {
+            continue;
+            }
+
+        ifd->offset = offset;
+        ifd->size = 2 + ifd->count * IFD_ENTRY_SIZE + 4;
+        for ( unsigned int e = 0 ; e < ifd->count ; e++ )
+            {
+            uint32_t bytes = typeSize(ifd->entries[e].type) * ifd->entries[e].count;
+
+            if ( 4 < bytes )
+                {
+                ifd->size += ( bytes + 1 ) & ~1;
+                }
+            }
+
+        offset += ifd->size;
+        }
+
+    if ( ( NO_ERROR == ret ) && ( MAX_TEMPLATE_SIZE < EXIF_HEADER_SIZE + offset ) )
+        {
+        ret = NO_MEMORY;
+        }
+
+    if ( NO_ERROR != ret )
+        {
+        delete [] ifds;
+        return ret;
+        }
+
+    uint8_t *tiff = layout->data + EXIF_HEADER_SIZE;
+
+    memcpy(layout->data, sExifHeader, EXIF_HEADER_SIZE);
+    tiff[0] = 'I';
+    tiff[1] = 'I';
+    put16(tiff + 2, 0x2A);
+    put32(tiff + 4, ifds[IFD_0].offset);
+
+    for ( int i = 0 ; i < IFD_COUNT ; i++ )
+        {
+        ifd = &ifds[i];
+        if ( 0 == ifd->count )
+            {
+            continue;
+            }
+
+        uint8_t *p = tiff + ifd->offset;
+        uint32_t values = ifd->offset + 2 + ifd->count * IFD_ENTRY_SIZE + 4;
+
+        put16(p, ifd->count);
+        for ( unsigned int e = 0 ; e < ifd->count ; e++ )
+            {
+            const IfdEntry *entry = &ifd->entries[e];
+            uint8_t *record = p + 2 + e * IFD_ENTRY_SIZE;
+            uint32_t bytes = typeSize(entry->type) * entry->count;
+            uint32_t value = record + 8 - layout->data;
+
+            put16(record, entry->tag);
+            put16(record + 2, entry->type);
+            put32(record + 4, entry->count);
+
+            if ( 0 <= entry->pointer )
+                {
+                put32(record + 8, ifds[entry->pointer].offset);
+                }
+            else if ( 4 >= bytes )
+                {
+                memcpy(record + 8, entry->value, bytes);
+                }
+            else
+                {
+                put32(record + 8, values);
+                memcpy(tiff + values, entry->value, bytes);
+                value = EXIF_HEADER_SIZE + values;
+                values += ( bytes + 1 ) & ~1;
+                }
+
+            if ( ( 0 <= entry->field ) && ( FIELD_COUNT > entry->field ) )
+                {
+                layout->value[entry->field] = value;
+                layout->count[entry->field] = record + 4 - layout->data;
+                }
+            }
+
+        ///IFD1 follows IFD0, as the thumbnail IFD
+        put32(p + 2 + ifd->count * IFD_ENTRY_SIZE, ( IFD_0 == i ) ? ifds[IFD_1].offset : 0);
+        }
+
+    layout->size = EXIF_HEADER_SIZE + offset;
+
+    delete [] ifds;
+
+    return NO_ERROR;
+}
+
+size_t ExifTemplate::getSize(const Capture &capture) const
+{
+    if ( !mBuilt )
+        {
+        return 0;
+        }
+
+    return mLayouts[( NULL != capture.gps ) ? 1 : 0].size +
+           ( ( NULL != capture.thumbnail ) ? capture.thumbnailSize : 0 );
+}
+
+status_t ExifTemplate::write(const Capture &capture, uint8_t *buffer, size_t capacity, size_t *size) const
+{
+    const Layout &layout = mLayouts[( NULL != capture.gps ) ? 1 : 0];
+    size_t bytes;
+
+    if ( !mBuilt )
+        {
+        return NO_INIT;
+        }
+
+    if ( ( NULL != capture.thumbnail ) && !mThumbnail )
+        {
+        return BAD_VALUE;
+        }
+
+    bytes = getSize(capture);
+    if ( ( NULL == buffer ) || ( NULL == size ) || ( capacity < bytes ) || ( MAX_PAYLOAD_SIZE < bytes ) )
+        {
+        return BAD_VALUE;
+        }
+
+    memcpy(buffer, layout.data, layout.size);
+    patch(layout, capture, buffer);
+    *size = bytes;
+
+    return NO_ERROR;
+}
+
+void ExifTemplate::patch(const Layout &layout, const Capture &capture, uint8_t *buffer)
+{
+    const uint32_t *value = layout.value;
+    struct tm date;
+    uint8_t stamp[DATE_TIME_SIZE];
+
+    ///"YYYY:MM:DD HH:MM:SS"
+    memset(stamp, 0, sizeof(stamp));
+    if ( NULL != localtime_r(&capture.time.tv_sec, &date) )
+        {
+        putDecimal(stamp, date.tm_year + 1900, 4);
+        stamp[4] = ':';
+        putDecimal(stamp + 5, date.tm_mon + 1, 2);
+        stamp[7] = ':';
+        putDecimal(stamp + 8, date.tm_mday, 2);
+        stamp[10] = ' ';
+        putDecimal(stamp + 11, date.tm_hour, 2);
+        stamp[13] = ':';
+        putDecimal(stamp + 14, date.tm_min, 2);
+        stamp[16] = ':';
+        putDecimal(stamp + 17, date.tm_sec, 2);
+        }
+
+    memcpy(buffer + value[FIELD_DATE_TIME], stamp, DATE_TIME_SIZE);
+    memcpy(buffer + value[FIELD_DATE_TIME_ORIGINAL], stamp, DATE_TIME_SIZE);
+    memcpy(buffer + value[FIELD_DATE_TIME_DIGITIZED], stamp, DATE_TIME_SIZE);
+
+    putDecimal(buffer + value[FIELD_SUB_SEC_TIME], capture.time.tv_usec, SUB_SEC_TIME_SIZE - 1);
+    putDecimal(buffer + value[FIELD_SUB_SEC_TIME_ORIGINAL], capture.time.tv_usec, SUB_SEC_TIME_SIZE - 1);
+    putDecimal(buffer + value[FIELD_SUB_SEC_TIME_DIGITIZED], capture.time.tv_usec, SUB_SEC_TIME_SIZE - 1);
+
+    put32(buffer + value[FIELD_WIDTH], capture.width);
+    put32(buffer + value[FIELD_HEIGHT], capture.height);
+    put32(buffer + value[FIELD_PIXEL_X], capture.width);
+    put32(buffer + value[FIELD_PIXEL_Y], capture.height);
+    put16(buffer + value[FIELD_ORIENTATION], capture.orientation);
+    put16(buffer + value[FIELD_ISO], capture.iso);
+    put16(buffer + value[FIELD_METERING_MODE], capture.meteringMode);
+    put16(buffer + value[FIELD_WHITE_BALANCE], capture.whiteBalance);
+    putRationals(buffer + value[FIELD_EXPOSURE_TIME], capture.exposureTime, 1);
+    putRationals(buffer + value[FIELD_DIGITAL_ZOOM], capture.digitalZoom, 1);
+
+    if ( ( NULL != capture.gps ) && ( 0 != value[FIELD_GPS_VERSION] ) )
+        {
+        const ExifTemplate::Gps *gps = capture.gps;
+        uint32_t rationals[6];
+        size_t length;
+
+        memcpy(buffer + value[FIELD_GPS_VERSION], gps->version, sizeof(gps->version));
+        buffer[value[FIELD_GPS_LATITUDE_REF]] = gps->latitudeRef;
+        buffer[value[FIELD_GPS_LONGITUDE_REF]] = gps->longitudeRef;
+        buffer[value[FIELD_GPS_ALTITUDE_REF]] = gps->altitudeRef;
+
+        for ( int i = 0 ; i < 3 ; i++ )
+            {
+            rationals[2 * i] = gps->latitude[i];
+            rationals[2 * i + 1] = 1;
+            }
+        putRationals(buffer + value[FIELD_GPS_LATITUDE], rationals, 3);
+
+        for ( int i = 0 ; i < 3 ; i++ )
+            {
+            rationals[2 * i] = gps->longitude[i];
+            }
+        putRationals(buffer + value[FIELD_GPS_LONGITUDE], rationals, 3);
+
+        rationals[0] = gps->altitude;
+        putRationals(buffer + value[FIELD_GPS_ALTITUDE], rationals, 1);
+
+        ///"YYYY:MM:DD", and the time of the fix
+        memset(rationals, 0, sizeof(rationals));
+        memset(buffer + value[FIELD_GPS_DATE_STAMP], 0, DATE_STAMP_SIZE);
+        if ( NULL != gmtime_r(&gps->timestamp, &date) )
+            {
+            uint8_t *p = buffer + value[FIELD_GPS_DATE_STAMP];
+
+            putDecimal(p, date.tm_year + 1900, 4);
+            p[4] = ':';
+            putDecimal(p + 5, date.tm_mon + 1, 2);
+            p[7] = ':';
+            putDecimal(p + 8, date.tm_mday, 2);
+
+            rationals[0] = date.tm_hour;
+            rationals[2] = date.tm_min;
+            rationals[4] = date.tm_sec;
+            }
+        rationals[1] = rationals[3] = rationals[5] = 1;
+        putRationals(buffer + value[FIELD_GPS_TIME_STAMP], rationals, 3);
+
+        memset(buffer + value[FIELD_GPS_MAP_DATUM], 0, GPS_MAP_DATUM_SIZE);
+        if ( NULL != gps->mapDatum )
+            {
+            length = strnlen(gps->mapDatum, GPS_MAP_DATUM_SIZE - 1);
+            memcpy(buffer + value[FIELD_GPS_MAP_DATUM], gps->mapDatum, length);
+            }
+
+        ///Undefined, after its character code and without terminator
+        memcpy(buffer + value[FIELD_GPS_PROCESSING_METHOD], sAsciiCode, sizeof(sAsciiCode));
+        length = 0;
+        if ( NULL != gps->processingMethod )
+            {
+            length = strnlen(gps->processingMethod, GPS_PROCESSING_SIZE - sizeof(sAsciiCode));
+            memcpy(buffer + value[FIELD_GPS_PROCESSING_METHOD] + sizeof(sAsciiCode), gps->processingMethod,
+                   length);
+            }
+        memset(buffer + value[FIELD_GPS_PROCESSING_METHOD] + sizeof(sAsciiCode) + length, 0,
+               GPS_PROCESSING_SIZE - sizeof(sAsciiCode) - length);
+        put32(buffer + layout.count[FIELD_GPS_PROCESSING_METHOD], sizeof(sAsciiCode) + length);
+        }
+
+    if ( ( NULL != capture.thumbnail ) && ( 0 != value[FIELD_THUMBNAIL_OFFSET] ) )
+        {
+        put32(buffer + value[FIELD_THUMBNAIL_OFFSET], layout.size - EXIF_HEADER_SIZE);
+        put32(buffer + value[FIELD_THUMBNAIL_LENGTH], capture.thumbnailSize);
+        memcpy(buffer + layout.size, capture.thumbnail, capture.thumbnailSize);
+        }
+}
+
+};
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef EXIF_TEMPLATE_H
+#define EXIF_TEMPLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <Errors.h>
+
+namespace android {
+
+///EXIF APP1 payload laid out once, and patched for every capture
+///build() writes all the IFDs of a camera into a template and records the
+///offsets of the fields that change between captures. write() copies the
+///template into a buffer of the caller and patches those fields in place,
+///without allocating or formatting tags. There is one layout with the GPS IFD
+///and one without, so that a capture without a fix carries no GPS tags.
+///The payload starts with the "Exif\0\0" header and is in Intel byte order.
+class ExifTemplate
+{
+public:
+
+    enum
+        {
+        ///Space reserved for the GPS strings. The processing method includes
+        ///its 8 byte character code
+        GPS_MAP_DATUM_SIZE = 32,
+        GPS_PROCESSING_SIZE = 40,
+        ///Largest make or model, terminator included
+        MAX_STRING_SIZE = 32,
+        ///Largest template, thumbnail excluded
+        MAX_TEMPLATE_SIZE = 1024,
+        ///Largest payload, bounded by the 16 bit length of the APP1 marker
+        MAX_PAYLOAD_SIZE = 65533
+        };
+
+    ///Fields fixed for a camera
+    struct Setup
+        {
+        const char *make;
+        const char *model;
+        ///Rational, in millimeters
+        uint32_t focalLength[2];
+        ///Adds IFD1, describing a JPEG thumbnail
+        bool thumbnail;
+        };
+
+    struct Gps
+        {
+        ///Degrees, minutes and seconds, each with a denominator of 1
+        uint32_t latitude[3];
+        uint32_t longitude[3];
+        ///'N' or 'S', 'E' or 'W'
+        char latitudeRef;
+        char longitudeRef;
+        ///Meters, above sea level for an altitudeRef of 0, below it for 1
+        uint32_t altitude;
+        uint8_t altitudeRef;
+        ///Seconds since the epoch, stamped in UTC
+        time_t timestamp;
+        uint8_t version[4];
+        ///Either may be NULL, longer strings are truncated
+        const char *mapDatum;
+        const char *processingMethod;
+        };
+
+    ///Fields of one capture
+    struct Capture
+        {
+        ///Stamped in local time
+        struct timeval time;
+        uint32_t width;
+        uint32_t height;
+        ///EXIF orientation: 1, 3, 6 or 8
+        uint16_t orientation;
+        ///Rationals, in seconds and as a ratio
+        uint32_t exposureTime[2];
+        uint32_t digitalZoom[2];
+        uint16_t iso;
+        uint16_t meteringMode;
+        uint16_t whiteBalance;
+        ///NULL selects the layout without the GPS IFD
+        const Gps *gps;
+        ///Appended after the IFDs. When NULL, IFD1 keeps 0xFFFFFFFF as the
+        ///offset and length of the thumbnail, for encoders inserting it
+        const uint8_t *thumbnail;
+        uint32_t thumbnailSize;
+        };
+
+    ExifTemplate();
+
+    ///Lays out the IFDs of the camera
+    status_t build(const Setup &setup);
+
+    ///Bytes written for a capture
+    size_t getSize(const Capture &capture) const;
+
+    ///Writes the payload of a capture to buffer, and its length to size
+    status_t write(const Capture &capture, uint8_t *buffer, size_t capacity, size_t *size) const;
+
+private:
+
+    enum Field
+        {
+        FIELD_WIDTH = 0,
+        FIELD_HEIGHT,
+        FIELD_ORIENTATION,
+        FIELD_DATE_TIME,
+        FIELD_EXPOSURE_TIME,
+        FIELD_ISO,
+        FIELD_DATE_TIME_ORIGINAL,
+        FIELD_DATE_TIME_DIGITIZED,
+        FIELD_METERING_MODE,
+        FIELD_SUB_SEC_TIME,
+        FIELD_SUB_SEC_TIME_ORIGINAL,
+        FIELD_SUB_SEC_TIME_DIGITIZED,
+        FIELD_PIXEL_X,
+        FIELD_PIXEL_Y,
+        FIELD_WHITE_BALANCE,
+        FIELD_DIGITAL_ZOOM,
+        FIELD_GPS_VERSION,
+        FIELD_GPS_LATITUDE_REF,
+        FIELD_GPS_LATITUDE,
+        FIELD_GPS_LONGITUDE_REF,
+        FIELD_GPS_LONGITUDE,
+        FIELD_GPS_ALTITUDE_REF,
+        FIELD_GPS_ALTITUDE,
+        FIELD_GPS_TIME_STAMP,
+        FIELD_GPS_MAP_DATUM,
+        FIELD_GPS_PROCESSING_METHOD,
+        FIELD_GPS_DATE_STAMP,
+        FIELD_THUMBNAIL_OFFSET,
+        FIELD_THUMBNAIL_LENGTH,
+        FIELD_COUNT,
+        FIELD_NONE = FIELD_COUNT
+        };
+
+    ///Template of one layout
+    struct Layout
+        {
+        uint8_t data[MAX_TEMPLATE_SIZE];
+        uint32_t size;
+        ///Offset of the value of each field in data, 0 when the layout lacks it
+        uint32_t value[FIELD_COUNT];
+        ///Offset of the count of each field in data
+        uint32_t count[FIELD_COUNT];
+        };
+
+    status_t layout(const Setup &setup, bool gps, Layout *layout);
+    static void patch(const Layout &layout, const Capture &capture, uint8_t *buffer);
+
+    Layout mLayouts[2];
+    bool mBuilt;
+    bool mThumbnail;
+};
+
+};
+
+#endif //EXIF_TEMPLATE_H
@@ -21,10 +21,13 @@
 
 #include <errno.h>
 #include <string.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <sys/poll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 #include <Errors.h>
+#include <cutils/atomic.h>
 
 
 
@@ -33,6 +36,16 @@
 
 #include "MessageQueue.h"
 
+#ifndef EFD_SEMAPHORE
+#define EFD_SEMAPHORE 1
+#endif
+
+///Number of times a producer yields on a full ring before it starts sleeping
+#define MSGQ_FULL_SPINS 100
+#define MSGQ_FULL_SLEEP_US 1000
+///How long put() waits on a full ring before it logs that the consumer is stuck
+#define MSGQ_FULL_WARN_US 1000000
+
 namespace android {
 
 /**
@@ -42,30 +55,55 @@ namespace android {
    @return none
  */
 MessageQueue::MessageQueue()
-: fd_read(-1), fd_write(-1), mHasMsg(false)
+: fd_read(-1), fd_write(-1), mHasMsg(false), mPending(0)
 {
     LOG_FUNCTION_NAME
 
-    int fds[2] = {-1,-1};
-    status_t stat;
+    for ( int prio = 0 ; prio < PRIORITY_COUNT ; prio++ )
+        {
+        mLanes[prio].size = ( PRIORITY_NORMAL == prio ) ? NORMAL_CAPACITY : HIGH_CAPACITY;
+        mLanes[prio].ring = new Slot[mLanes[prio].size];
+
+        for ( int i = 0 ; i < mLanes[prio].size ; i++ )
+            {
+            mLanes[prio].ring[i].seq = i;
+            }
+
+        mLanes[prio].tail = 0;
+        mLanes[prio].head = 0;
+        mLanes[prio].pending = 0;
+        }
+
+    pthread_mutex_init(&mGetLock, NULL);
 
-    stat = pipe(fds);
+    ///The wakeup descriptor carries one token each time the queue becomes non-empty
+    int fd = eventfd(0, EFD_SEMAPHORE);
 
-    if ( 0 > stat )
+    if ( 0 <= fd )
         {
-        MSGQ_LOGEB("Error while openning pipe: %s", strerror(stat) );
-        this->fd_read = 0;
-        this->fd_write = 0;
-        mHasMsg = false;
+        this->fd_read = fd;
+        this->fd_write = fd;
         }
     else
         {
-        this->fd_read = fds[0];
-        this->fd_write = fds[1];
+        ///Fall back to a pipe with single byte tokens
+        int fds[2] = {-1,-1};
 
-        mHasMsg = false;
+        if ( 0 > pipe(fds) )
+            {
+            MSGQ_LOGEB("Error while openning pipe: %s", strerror(errno) );
+            this->fd_read = 0;
+            this->fd_write = 0;
+            }
+        else
+            {
+            this->fd_read = fds[0];
+            this->fd_write = fds[1];
+            }
         }
 
+    mHasMsg = false;
+
     LOG_FUNCTION_NAME_EXIT
 }
 
@@ -84,14 +122,86 @@ MessageQueue::~MessageQueue()
         close(this->fd_read);
         }
 
-    if(this->fd_write)
+    if( ( this->fd_write ) && ( this->fd_write != this->fd_read ) )
         {
         close(this->fd_write);
         }
 
+    pthread_mutex_destroy(&mGetLock);
+
+    for ( int prio = 0 ; prio < PRIORITY_COUNT ; prio++ )
+        {
+        delete [] mLanes[prio].ring;
+        }
+
     LOG_FUNCTION_NAME_EXIT
 }
 
+/**
+   @brief Posts a wakeup token to the wakeup descriptor
+
+   @param none
+   @return none
+ */
+void MessageQueue::signal()
+{
+    int err;
+
+    do
+        {
+        if ( this->fd_write == this->fd_read )
+            {
+            uint64_t token = 1;
+            err = write(this->fd_write, &token, sizeof(token));
+            }
+        else
+            {
+            char token = 0;
+            err = write(this->fd_write, &token, sizeof(token));
+            }
+        }
+    while ( ( 0 > err ) && ( EINTR == errno ) );
+
+    if ( 0 > err )
+        {
+        MSGQ_LOGEB("write() error: %s", strerror(errno));
+        }
+}
+
+/**
+   @brief Consumes a wakeup token from the wakeup descriptor
+
+   The token may still be on its way from a producer that made the queue
+   non-empty, in which case this blocks until it arrives.
+
+   @param none
+   @return none
+ */
+void MessageQueue::clear()
+{
+    int err;
+
+    do
+        {
+        if ( this->fd_write == this->fd_read )
+            {
+            uint64_t token;
+            err = read(this->fd_read, &token, sizeof(token));
+            }
+        else
+            {
+            char token;
+            err = read(this->fd_read, &token, sizeof(token));
+            }
+        }
+    while ( ( 0 > err ) && ( EINTR == errno ) );
+
+    if ( 0 > err )
+        {
+        MSGQ_LOGEB("read() error: %s", strerror(errno));
+        }
+}
+
 /**
    @brief Get a message from the queue
 
@@ -119,31 +229,173 @@ status_t MessageQueue::get(Message* msg)
         return NO_INIT;
         }
 
-    char* p = (char*) msg;
-    size_t read_bytes = 0;
+    pthread_mutex_lock(&mGetLock);
+
+    status_t ret = wait();
+
+    if ( NO_ERROR == ret )
+        {
+        pop(msg);
+        }
+
+    pthread_mutex_unlock(&mGetLock);
+
+    if ( NO_ERROR != ret )
+        {
+        LOG_FUNCTION_NAME_EXIT
+        return ret;
+        }
+
+    MSGQ_LOGDB("MQ.get(%d,%p,%p,%p,%p)", msg->command, msg->arg1,msg->arg2,msg->arg3,msg->arg4);
+
+    mHasMsg = false;
+
+    LOG_FUNCTION_NAME_EXIT
+
+    return 0;
+}
+
+/**
+   @brief Get several messages from the message queue
+
+   Waits until at least one message is available, then reads all pending
+   messages up to max without waiting again. Messages are returned in the
+   order get() would return them.
+
+   @param msgs Array receiving the messages
+   @param max Number of entries in msgs
+   @return Number of messages read on success
+   @return BAD_VALUE if the message array is NULL or max is 0
+   @return NO_INIT If the file read descriptor is not set
+   @return UNKNOWN_ERROR if waiting on the file read descriptor fails
+ */
+
+int MessageQueue::getBatch(Message* msgs, size_t max)
+{
+    LOG_FUNCTION_NAME
+
+    int count = 0;
+
+    if( ( !msgs ) || ( 0 == max ) )
+        {
+        MSGQ_LOGEA("msgs is NULL or max is 0");
+        LOG_FUNCTION_NAME_EXIT
+        return BAD_VALUE;
+        }
+
+    if(!this->fd_read)
+        {
+        MSGQ_LOGEA("read descriptor not initialized for message queue");
+        LOG_FUNCTION_NAME_EXIT
+        return NO_INIT;
+        }
+
+    pthread_mutex_lock(&mGetLock);
+
+    status_t ret = wait();
+
+    while ( ( NO_ERROR == ret ) &&
+            ( max > (size_t) count ) &&
+            ( 0 < android_atomic_acquire_load(&mPending) ) )
+        {
+        pop(&msgs[count++]);
+        }
+
+    pthread_mutex_unlock(&mGetLock);
+
+    if ( NO_ERROR != ret )
+        {
+        LOG_FUNCTION_NAME_EXIT
+        return ret;
+        }
+
+    MSGQ_LOGDB("MQ.getBatch(%d)", count);
+
+    mHasMsg = false;
+
+    LOG_FUNCTION_NAME_EXIT
+
+    return count;
+}
+
+/**
+   @brief Waits until the message queue holds at least one message
+
+   Must be called with mGetLock held.
 
-    while( read_bytes  < sizeof(*msg) )
+   @param none
+   @return NO_ERROR On success
+   @return UNKNOWN_ERROR if waiting on the file read descriptor fails
+ */
+
+status_t MessageQueue::wait()
+{
+    ///Sleep on the wakeup descriptor only while all lanes are empty
+    while ( 0 == android_atomic_acquire_load(&mPending) )
         {
-        int err = read(this->fd_read, p, sizeof(*msg) - read_bytes);
+        struct pollfd pfd;
+
+        pfd.fd = this->fd_read;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
 
-        if( err < 0 )
+        if( ( -1 == poll(&pfd, 1, -1) ) && ( EINTR != errno ) )
             {
-            MSGQ_LOGEB("read() error: %s", strerror(errno));
+            MSGQ_LOGEB("poll() error: %s", strerror(errno));
             return UNKNOWN_ERROR;
             }
-        else
+        }
+
+    return NO_ERROR;
+}
+
+/**
+   @brief Reads the oldest message of the highest priority lane holding one
+
+   Must be called with mGetLock held and messages pending. Lane counts are
+   raised before the total count, so a pending total guarantees that one
+   of the lanes holds a message.
+
+   @param msg Message structure to hold the message to be retrieved
+   @return none
+ */
+
+void MessageQueue::pop(Message* msg)
+{
+    Lane *lane = &mLanes[PRIORITY_NORMAL];
+
+    for ( int prio = PRIORITY_COUNT - 1 ; prio > PRIORITY_NORMAL ; prio-- )
+        {
+        if ( 0 < android_atomic_acquire_load(&mLanes[prio].pending) )
             {
-            read_bytes += err;
+            lane = &mLanes[prio];
+            break;
             }
         }
 
-    MSGQ_LOGDB("MQ.get(%d,%p,%p,%p,%p)", msg->command, msg->arg1,msg->arg2,msg->arg3,msg->arg4);
+    Slot *slot = &lane->ring[lane->head & ( lane->size - 1 )];
+    int32_t next = (int32_t) ( (uint32_t) lane->head + 1 );
 
-    mHasMsg = false;
+    ///A producer that claimed this slot earlier than the one that
+    ///published the pending message may still be copying it
+    while ( next != android_atomic_acquire_load(&slot->seq) )
+        {
+        sched_yield();
+        }
 
-    LOG_FUNCTION_NAME_EXIT
+    *msg = slot->msg;
 
-    return 0;
+    ///Hand the slot back to the producers for the next lap
+    android_atomic_release_store((int32_t) ( (uint32_t) lane->head + lane->size ), &slot->seq);
+    lane->head = next;
+
+    android_atomic_dec(&lane->pending);
+
+    ///Last message read: take the wakeup token so the descriptor is no longer readable
+    if ( 1 == android_atomic_dec(&mPending) )
+        {
+        clear();
+        }
 }
 
 /**
@@ -159,9 +411,12 @@ int MessageQueue::getInFd()
 }
 
 /**
-   @brief Constructor for the message queue class
+   @brief Replaces the wakeup descriptor of the message queue
+
+   The descriptor must be an eventfd created with EFD_SEMAPHORE, as it is
+   used both for posting and for consuming wakeup tokens.
 
-   @param fd file read descriptor
+   @param fd eventfd descriptor
    @return none
  */
 
@@ -169,12 +424,18 @@ void MessageQueue::setInFd(int fd)
 {
     LOG_FUNCTION_NAME
 
-    if ( -1 != this->fd_read )
+    if( ( 0 < this->fd_write ) && ( this->fd_write != this->fd_read ) )
+        {
+        close(this->fd_write);
+        }
+
+    if ( 0 < this->fd_read )
         {
         close(this->fd_read);
         }
 
     this->fd_read = fd;
+    this->fd_write = fd;
 
     LOG_FUNCTION_NAME_EXIT
 }
@@ -183,18 +444,22 @@ void MessageQueue::setInFd(int fd)
    @brief Queue a message
 
    @param msg Message structure to hold the message to be retrieved
+   @param prio Priority lane the message is queued to
    @return NO_ERROR On success
    @return BAD_VALUE if the message pointer is NULL
    @return NO_INIT If the file write descriptor is not set
    @return UNKNOWN_ERROR if the write operation fromthe file write descriptor fails
  */
 
-status_t MessageQueue::put(Message* msg)
+status_t MessageQueue::put(Message* msg, Priority prio)
 {
     LOG_FUNCTION_NAME
 
-    char* p = (char*) msg;
-    size_t bytes = 0;
+    Lane *lane;
+    Slot *slot;
+    int32_t pos;
+    int spins = 0;
+    int slept = 0;
 
     if(!msg)
         {
@@ -203,6 +468,13 @@ status_t MessageQueue::put(Message* msg)
         return BAD_VALUE;
         }
 
+    if( ( PRIORITY_NORMAL > prio ) || ( PRIORITY_COUNT <= prio ) )
+        {
+        MSGQ_LOGEB("invalid priority %d", prio);
+        LOG_FUNCTION_NAME_EXIT
+        return BAD_VALUE;
+        }
+
     if(!this->fd_write)
         {
         MSGQ_LOGEA("write descriptor not initialized for message queue");
@@ -213,22 +485,61 @@ status_t MessageQueue::put(Message* msg)
 
     MSGQ_LOGDB("MQ.put(%d,%p,%p,%p,%p)", msg->command, msg->arg1,msg->arg2,msg->arg3,msg->arg4);
 
-    while( bytes  < sizeof(msg) )
+    lane = &mLanes[prio];
+
+    ///Claim the next slot, waiting for the consumer if the ring is full
+    for ( ;; )
         {
-        int err = write(this->fd_write, p, sizeof(*msg) - bytes);
+        pos = android_atomic_acquire_load(&lane->tail);
+        slot = &lane->ring[pos & ( lane->size - 1 )];
 
-        if( err < 0 )
+        int32_t diff = (int32_t) ( (uint32_t) android_atomic_acquire_load(&slot->seq) - (uint32_t) pos );
+
+        if ( 0 == diff )
             {
-            MSGQ_LOGEB("write() error: %s", strerror(errno));
-            LOG_FUNCTION_NAME_EXIT
-            return UNKNOWN_ERROR;
+            if ( 0 == android_atomic_cmpxchg(pos, (int32_t) ( (uint32_t) pos + 1 ), &lane->tail) )
+                {
+                break;
+                }
             }
-        else
+        else if ( 0 > diff )
             {
-            bytes += err;
+            ///Ring is full
+            if ( MSGQ_FULL_SPINS > spins++ )
+                {
+                sched_yield();
+                }
+            else
+                {
+                ///Block like a full pipe did, messages are never dropped.
+                ///Log once when the consumer looks stuck
+                if ( MSGQ_FULL_WARN_US >= slept )
+                    {
+                    if ( MSGQ_FULL_WARN_US == slept )
+                        {
+                        MSGQ_LOGEB("MQ.put(%d) lane %d full, consumer not reading", msg->command, prio);
+                        }
+                    slept += MSGQ_FULL_SLEEP_US;
+                    }
+                usleep(MSGQ_FULL_SLEEP_US);
+                }
             }
         }
 
+    slot->msg = *msg;
+
+    ///Publish the message
+    android_atomic_release_store((int32_t) ( (uint32_t) pos + 1 ), &slot->seq);
+
+    ///The lane count must be raised before the total, see pop()
+    android_atomic_inc(&lane->pending);
+
+    ///Only wake the consumer when the queue becomes non-empty
+    if ( 0 == android_atomic_inc(&mPending) )
+        {
+        signal();
+        }
+
     MSGQ_LOGDA("MessageQueue::put EXIT");
 
     LOG_FUNCTION_NAME_EXIT
@@ -247,12 +558,6 @@ bool MessageQueue::isEmpty()
 {
     LOG_FUNCTION_NAME
 
-    struct pollfd pfd;
-
-    pfd.fd = this->fd_read;
-    pfd.events = POLLIN;
-    pfd.revents = 0;
-
     if(!this->fd_read)
         {
         MSGQ_LOGEA("read descriptor not initialized for message queue");
@@ -260,22 +565,7 @@ bool MessageQueue::isEmpty()
         return NO_INIT;
         }
 
-
-    if( -1 == poll(&pfd,1,0) )
-        {
-        MSGQ_LOGEB("poll() error: %s", strerror(errno));
-        LOG_FUNCTION_NAME_EXIT
-        return false;
-        }
-
-    if(pfd.revents & POLLIN)
-        {
-        mHasMsg = true;
-        }
-    else
-        {
-        mHasMsg = false;
-        }
+    mHasMsg = ( 0 != android_atomic_acquire_load(&mPending) );
 
     LOG_FUNCTION_NAME_EXIT
     return !mHasMsg;
@@ -292,6 +582,63 @@ void MessageQueue::setMsg(bool hasMsg)
     mHasMsg = hasMsg;
     }
 
+/**
+   @brief Returns if the message queue holds high priority messages
+
+   @param none
+   @return true If at least one message is queued above PRIORITY_NORMAL
+   @return false otherwise
+ */
+bool MessageQueue::hasPriorityMsg()
+{
+    for ( int prio = PRIORITY_COUNT - 1 ; prio > PRIORITY_NORMAL ; prio-- )
+        {
+        if ( 0 < android_atomic_acquire_load(&mLanes[prio].pending) )
+            {
+            return true;
+            }
+        }
+
+    return false;
+}
+
+/**
+   @brief Selects the queue to service first among up to three queues
+
+   The first queue holding high priority messages wins, otherwise the first
+   queue holding any message.
+
+   @param queue1 First queue
+   @param queue2 Second queue. Optional.
+   @param queue3 Third queue. Optional.
+   @return The queue to service, NULL if all queues are empty
+ */
+MessageQueue *MessageQueue::selectQueue(MessageQueue *queue1, MessageQueue *queue2, MessageQueue *queue3)
+{
+    MessageQueue *queues[3] = { queue1, queue2, queue3 };
+    MessageQueue *first = NULL;
+
+    for ( int i = 0 ; i < 3 ; i++ )
+        {
+        if ( ( NULL == queues[i] ) || ( 0 == android_atomic_acquire_load(&queues[i]->mPending) ) )
+            {
+            continue;
+            }
+
+        if ( queues[i]->hasPriorityMsg() )
+            {
+            return queues[i];
+            }
+
+        if ( NULL == first )
+            {
+            first = queues[i];
+            }
+        }
+
+    return first;
+}
+
 
 /**
    @briefWait for message in maximum three different queues with a timeout
@@ -300,17 +647,25 @@ void MessageQueue::setMsg(bool hasMsg)
    @param queue2 Second queue. Optional.
    @param queue3 Third queue. Optional.
    @param timeout The timeout value (in micro secs) to wait for a message in any of the queues
+   @param next Optional. Receives the queue to service first, giving precedence to
+               queues with high priority messages, or NULL if no message arrived
    @return NO_ERROR On success
    @return BAD_VALUE If queue1 is NULL
    @return NO_INIT If the file read descriptor of any of the provided queues is not set
  */
-status_t MessageQueue::waitForMsg(MessageQueue *queue1, MessageQueue *queue2, MessageQueue *queue3, int timeout)
+status_t MessageQueue::waitForMsg(MessageQueue *queue1, MessageQueue *queue2, MessageQueue *queue3, int timeout,
+                                  MessageQueue **next)
     {
     LOG_FUNCTION_NAME
 
     int n =1;
     struct pollfd pfd[3];
 
+    if(next)
+        {
+        *next = NULL;
+        }
+
     if(!queue1)
         {
         MSGQ_LOGEA("queue1 pointer is NULL");
@@ -318,6 +673,35 @@ status_t MessageQueue::waitForMsg(MessageQueue *queue1, MessageQueue *queue2, Me
         return BAD_VALUE;
         }
 
+    ///No need to poll if any of the queues already holds a message
+    int ready = 0;
+
+    if ( !queue1->isEmpty() )
+        {
+        ready++;
+        }
+
+    if ( ( queue2 ) && ( !queue2->isEmpty() ) )
+        {
+        ready++;
+        }
+
+    if ( ( queue3 ) && ( !queue3->isEmpty() ) )
+        {
+        ready++;
+        }
+
+    if ( ready )
+        {
+        if(next)
+            {
+            *next = selectQueue(queue1, queue2, queue3);
+            }
+
+        LOG_FUNCTION_NAME_EXIT
+        return ready;
+        }
+
     pfd[0].fd = queue1->getInFd();
     if(!pfd[0].fd)
         {
@@ -395,6 +779,11 @@ status_t MessageQueue::waitForMsg(MessageQueue *queue1, MessageQueue *queue2, Me
             }
         }
 
+    if(next)
+        {
+        *next = selectQueue(queue1, queue2, queue3);
+        }
+
     LOG_FUNCTION_NAME_EXIT
     return ret;
     }
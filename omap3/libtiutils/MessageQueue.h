@@ -24,6 +24,7 @@
 
 #include "DebugUtils.h"
 #include <stdint.h>
+#include <pthread.h>
 
 ///Uncomment this macro to debug the message queue implementation
 //#define DEBUG_LOG
@@ -64,16 +65,44 @@ struct Message
 };
 
 ///Message queue implementation
+///Messages are passed through an in-process ring buffer. Producers never block
+///unless the ring is full, in which case put() waits for the consumer to make
+///room, as a write to a full pipe did. The consumer only sleeps on the wakeup descriptor
+///(an eventfd, or a pipe where eventfd is unavailable) when the ring is empty.
+///The descriptor is readable for as long as the queue holds messages, so
+///getInFd() can still be multiplexed with poll()/select().
+///Each priority has its own ring (lane). Messages are read from the highest
+///priority lane that holds any, and in order within a lane.
 class MessageQueue
 {
 public:
 
+    ///Message priorities, high priority messages are read ahead of normal ones
+    enum Priority
+    {
+        PRIORITY_NORMAL = 0,
+        PRIORITY_HIGH,
+        PRIORITY_COUNT
+    };
+
+    ///Messages a lane holds before put() has to wait for the consumer, both
+    ///powers of two. The normal lane holds as many as the 64KB pipe of the
+    ///previous implementation did, the high priority one only control messages
+    enum
+    {
+        NORMAL_CAPACITY = 2048,
+        HIGH_CAPACITY = 64
+    };
+
     MessageQueue();
     ~MessageQueue();
 
     ///Get a message from the queue
     status_t get(Message*);
 
+    ///Get up to max messages from the queue, waiting until at least one is available
+    int getBatch(Message*, size_t max);
+
     ///Get the input file descriptor of the message queue
     int getInFd();
 
@@ -81,7 +110,7 @@ public:
     void setInFd(int fd);
 
     ///Queue a message
-    status_t put(Message*);
+    status_t put(Message*, Priority prio = PRIORITY_NORMAL);
 
     ///Returns if the message queue is empty or not
     bool isEmpty();
@@ -89,14 +118,52 @@ public:
     ///Force whether the message queue has message or not
     void setMsg(bool hasMsg=false);
 
-    ///Wait for message in maximum three different queues with a timeout
-    static int waitForMsg(MessageQueue *queue1, MessageQueue *queue2=0, MessageQueue *queue3=0, int timeout = 0);
+    ///Returns if the message queue holds high priority messages
+    bool hasPriorityMsg();
+
+    ///Wait for message in maximum three different queues with a timeout,
+    ///optionally returning the queue that should be serviced first
+    static int waitForMsg(MessageQueue *queue1, MessageQueue *queue2=0, MessageQueue *queue3=0, int timeout = 0,
+                          MessageQueue **next = 0);
 
 
 private:
+
+    struct Slot
+    {
+        ///Sequence number: index when free, index + 1 when it holds a message
+        volatile int32_t seq;
+        Message msg;
+    };
+
+    struct Lane
+    {
+        Slot *ring;
+        ///Number of slots, a power of two
+        int32_t size;
+        ///Next slot to be claimed by a producer
+        volatile int32_t tail;
+        ///Next slot to be read by the consumer
+        int32_t head;
+        ///Number of messages published in the lane and not yet read
+        volatile int32_t pending;
+    };
+
+    void signal();
+    void clear();
+    status_t wait();
+    void pop(Message*);
+    static MessageQueue *selectQueue(MessageQueue *queue1, MessageQueue *queue2, MessageQueue *queue3);
+
     int fd_read;
     int fd_write;
     bool mHasMsg;
+
+    Lane mLanes[PRIORITY_COUNT];
+    ///Number of messages published in all lanes and not yet read
+    volatile int32_t mPending;
+    ///Serializes consumers
+    pthread_mutex_t mGetLock;
 };
 
 };
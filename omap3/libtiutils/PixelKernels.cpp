@@ -0,0 +1,471 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_TAG "PixelKernels"
+#include <utils/Log.h>
+
+#include "PixelKernels.h"
+#include "RowKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXEL_KERNELS_SSE2
+#endif
+
+///AVX2 kernels are built with a target attribute, so they do not depend on the build flags
+#if ( defined(__x86_64__) || defined(__i386__) ) && \
+    ( defined(__clang__) || ( __GNUC__ > 4 ) || ( ( __GNUC__ == 4 ) && ( __GNUC_MINOR__ >= 9 ) ) )
+#include <cpuid.h>
+#include <immintrin.h>
+#define PIXEL_KERNELS_AVX2
+#define PIXEL_KERNELS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+///The NEON row kernels are built in PixelKernels_neon.cpp
+#ifdef LIBTIUTILS_NEON
+#define PIXEL_KERNELS_NEON
+#endif
+
+namespace android {
+
+///Row kernels process as many leading pixels as their vector width allows and
+///return how many they did. The scalar code finishes the row.
+typedef size_t (*SwapUVRow)(uint8_t *dst, const uint8_t *src, size_t width);
+typedef size_t (*Yuv422iRows)(uint8_t *y0, uint8_t *y1, uint8_t *vu,
+                              const uint8_t *r0, const uint8_t *r1, size_t width);
+
+/*--------------------Scalar kernels-----------------------------*/
+
+static void copyPackedScalar(uint8_t *dst, const uint8_t *src, size_t width, size_t height, size_t srcStride)
+{
+    if ( width == srcStride )
+        {
+        memcpy(dst, src, width * height);
+        return;
+        }
+
+    for ( size_t i = 0 ; i < height ; i++, src += srcStride, dst += width )
+        {
+        memcpy(dst, src, width);
+        }
+}
+
+static void swapUVTail(uint8_t *dst, const uint8_t *src, size_t from, size_t width)
+{
+    for ( size_t x = from ; x < width ; x += 2 )
+        {
+        uint8_t c = src[x];
+        dst[x] = src[x + 1];
+        dst[x + 1] = c;
+        }
+}
+
+static void swapUVRows(SwapUVRow rowFn, uint8_t *dst, const uint8_t *src, size_t width, size_t height,
+                       size_t srcStride)
+{
+    for ( size_t i = 0 ; i < height ; i++, src += srcStride, dst += width )
+        {
+        size_t done = ( NULL != rowFn ) ? rowFn(dst, src, width) : 0;
+
+        swapUVTail(dst, src, done, width);
+        }
+}
+
+static void swapUVScalar(uint8_t *dst, const uint8_t *src, size_t width, size_t height, size_t srcStride)
+{
+    swapUVRows(NULL, dst, src, width, height, srcStride);
+}
+
+///y1 is NULL for the last row of frames with an odd height, r1 is then the same row as r0
+static void yuv422iTail(uint8_t *y0, uint8_t *y1, uint8_t *vu, const uint8_t *r0, const uint8_t *r1,
+                        size_t from, size_t width)
+{
+    for ( size_t x = from ; x < width ; x += 2 )
+        {
+        const uint8_t *p0 = r0 + 2 * x;
+        const uint8_t *p1 = r1 + 2 * x;
+
+        y0[x] = p0[0];
+        y0[x + 1] = p0[2];
+
+        if ( NULL != y1 )
+            {
+            y1[x] = p1[0];
+            y1[x + 1] = p1[2];
+            }
+
+        vu[x] = ( p0[3] + p1[3] + 1 ) >> 1;
+        vu[x + 1] = ( p0[1] + p1[1] + 1 ) >> 1;
+        }
+}
+
+static void yuv422iToNV21Rows(Yuv422iRows rowsFn, uint8_t *dstY, uint8_t *dstVU, const uint8_t *src,
+                              size_t width, size_t height, size_t srcStride)
+{
+    for ( size_t i = 0 ; i < height ; i += 2 )
+        {
+        const uint8_t *r0 = src + i * srcStride;
+        const uint8_t *r1 = ( i + 1 < height ) ? ( r0 + srcStride ) : r0;
+        uint8_t *y0 = dstY + i * width;
+        uint8_t *y1 = ( i + 1 < height ) ? ( y0 + width ) : NULL;
+        uint8_t *vu = dstVU + ( i / 2 ) * width;
+        size_t done = ( NULL != rowsFn ) ? rowsFn(y0, y1, vu, r0, r1, width) : 0;
+
+        yuv422iTail(y0, y1, vu, r0, r1, done, width);
+        }
+}
+
+static void yuv422iToNV21Scalar(uint8_t *dstY, uint8_t *dstVU, const uint8_t *src, size_t width, size_t height,
+                                size_t srcStride)
+{
+    yuv422iToNV21Rows(NULL, dstY, dstVU, src, width, height, srcStride);
+}
+
+static const PixelKernels sScalarKernels =
+{
+    "scalar",
+    copyPackedScalar,
+    swapUVScalar,
+    yuv422iToNV21Scalar,
+};
+
+/*--------------------SSE2 kernels-----------------------------*/
+
+#ifdef PIXEL_KERNELS_SSE2
+
+static size_t swapUVRowSSE2(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    size_t x = 0;
+
+    for ( ; x + 16 <= width ; x += 16 )
+        {
+        __m128i uv = _mm_loadu_si128((const __m128i *) ( src + x ));
+        uv = _mm_or_si128(_mm_slli_epi16(uv, 8), _mm_srli_epi16(uv, 8));
+        _mm_storeu_si128((__m128i *) ( dst + x ), uv);
+        }
+
+    return x;
+}
+
+static size_t yuv422iRowsSSE2(uint8_t *y0, uint8_t *y1, uint8_t *vu,
+                              const uint8_t *r0, const uint8_t *r1, size_t width)
+{
+    const __m128i lumaMask = _mm_set1_epi16(0x00FF);
+    size_t x = 0;
+
+    for ( ; x + 16 <= width ; x += 16 )
+        {
+        __m128i a0 = _mm_loadu_si128((const __m128i *) ( r0 + 2 * x ));
+        __m128i a1 = _mm_loadu_si128((const __m128i *) ( r0 + 2 * x + 16 ));
+        __m128i b0 = _mm_loadu_si128((const __m128i *) ( r1 + 2 * x ));
+        __m128i b1 = _mm_loadu_si128((const __m128i *) ( r1 + 2 * x + 16 ));
+
+        _mm_storeu_si128((__m128i *) ( y0 + x ),
+                         _mm_packus_epi16(_mm_and_si128(a0, lumaMask), _mm_and_si128(a1, lumaMask)));
+
+        if ( NULL != y1 )
+            {
+            _mm_storeu_si128((__m128i *) ( y1 + x ),
+                             _mm_packus_epi16(_mm_and_si128(b0, lumaMask), _mm_and_si128(b1, lumaMask)));
+            }
+
+        ///U V U V ... averaged over both rows, then swapped to V U
+        __m128i uv = _mm_packus_epi16(_mm_srli_epi16(_mm_avg_epu8(a0, b0), 8),
+                                      _mm_srli_epi16(_mm_avg_epu8(a1, b1), 8));
+        uv = _mm_or_si128(_mm_slli_epi16(uv, 8), _mm_srli_epi16(uv, 8));
+        _mm_storeu_si128((__m128i *) ( vu + x ), uv);
+        }
+
+    return x;
+}
+
+static void swapUVSSE2(uint8_t *dst, const uint8_t *src, size_t width, size_t height, size_t srcStride)
+{
+    swapUVRows(swapUVRowSSE2, dst, src, width, height, srcStride);
+}
+
+static void yuv422iToNV21SSE2(uint8_t *dstY, uint8_t *dstVU, const uint8_t *src, size_t width, size_t height,
+                              size_t srcStride)
+{
+    yuv422iToNV21Rows(yuv422iRowsSSE2, dstY, dstVU, src, width, height, srcStride);
+}
+
+static const PixelKernels sSSE2Kernels =
+{
+    "sse2",
+    copyPackedScalar,
+    swapUVSSE2,
+    yuv422iToNV21SSE2,
+};
+
+#endif
+
+/*--------------------AVX2 kernels-----------------------------*/
+
+#ifdef PIXEL_KERNELS_AVX2
+
+PIXEL_KERNELS_TARGET_AVX2
+static size_t swapUVRowAVX2(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    size_t x = 0;
+
+    for ( ; x + 32 <= width ; x += 32 )
+        {
+        __m256i uv = _mm256_loadu_si256((const __m256i *) ( src + x ));
+        uv = _mm256_or_si256(_mm256_slli_epi16(uv, 8), _mm256_srli_epi16(uv, 8));
+        _mm256_storeu_si256((__m256i *) ( dst + x ), uv);
+        }
+
+    return x;
+}
+
+PIXEL_KERNELS_TARGET_AVX2
+static size_t yuv422iRowsAVX2(uint8_t *y0, uint8_t *y1, uint8_t *vu,
+                              const uint8_t *r0, const uint8_t *r1, size_t width)
+{
+    const __m256i lumaMask = _mm256_set1_epi16(0x00FF);
+    size_t x = 0;
+
+    ///_mm256_packus_epi16 packs within 128 bit lanes, the permutes restore the pixel order
+    for ( ; x + 32 <= width ; x += 32 )
+        {
+        __m256i a0 = _mm256_loadu_si256((const __m256i *) ( r0 + 2 * x ));
+        __m256i a1 = _mm256_loadu_si256((const __m256i *) ( r0 + 2 * x + 32 ));
+        __m256i b0 = _mm256_loadu_si256((const __m256i *) ( r1 + 2 * x ));
+        __m256i b1 = _mm256_loadu_si256((const __m256i *) ( r1 + 2 * x + 32 ));
+
+        __m256i luma = _mm256_packus_epi16(_mm256_and_si256(a0, lumaMask), _mm256_and_si256(a1, lumaMask));
+        _mm256_storeu_si256((__m256i *) ( y0 + x ), _mm256_permute4x64_epi64(luma, 0xD8));
+
+        if ( NULL != y1 )
+            {
+            luma = _mm256_packus_epi16(_mm256_and_si256(b0, lumaMask), _mm256_and_si256(b1, lumaMask));
+            _mm256_storeu_si256((__m256i *) ( y1 + x ), _mm256_permute4x64_epi64(luma, 0xD8));
+            }
+
+        __m256i uv = _mm256_packus_epi16(_mm256_srli_epi16(_mm256_avg_epu8(a0, b0), 8),
+                                         _mm256_srli_epi16(_mm256_avg_epu8(a1, b1), 8));
+        uv = _mm256_or_si256(_mm256_slli_epi16(uv, 8), _mm256_srli_epi16(uv, 8));
+        _mm256_storeu_si256((__m256i *) ( vu + x ), _mm256_permute4x64_epi64(uv, 0xD8));
+        }
+
+    return x;
+}
+
+static void swapUVAVX2(uint8_t *dst, const uint8_t *src, size_t width, size_t height, size_t srcStride)
+{
+    swapUVRows(swapUVRowAVX2, dst, src, width, height, srcStride);
+}
+
+static void yuv422iToNV21AVX2(uint8_t *dstY, uint8_t *dstVU, const uint8_t *src, size_t width, size_t height,
+                              size_t srcStride)
+{
+    yuv422iToNV21Rows(yuv422iRowsAVX2, dstY, dstVU, src, width, height, srcStride);
+}
+
+static const PixelKernels sAVX2Kernels =
+{
+    "avx2",
+    copyPackedScalar,
+    swapUVAVX2,
+    yuv422iToNV21AVX2,
+};
+
+#endif
+
+/*--------------------NEON kernels-----------------------------*/
+
+#ifdef PIXEL_KERNELS_NEON
+
+static void swapUVNEON(uint8_t *dst, const uint8_t *src, size_t width, size_t height, size_t srcStride)
+{
+    swapUVRows(swapUVRowNEON, dst, src, width, height, srcStride);
+}
+
+static void yuv422iToNV21NEON(uint8_t *dstY, uint8_t *dstVU, const uint8_t *src, size_t width, size_t height,
+                              size_t srcStride)
+{
+    yuv422iToNV21Rows(yuv422iRowsNEON, dstY, dstVU, src, width, height, srcStride);
+}
+
+static const PixelKernels sNEONKernels =
+{
+    "neon",
+    copyPackedScalar,
+    swapUVNEON,
+    yuv422iToNV21NEON,
+};
+
+#endif
+
+/*--------------------CPU feature detection-----------------------------*/
+
+static bool alwaysSupported()
+{
+    return true;
+}
+
+#ifdef PIXEL_KERNELS_AVX2
+
+static bool avx2Supported()
+{
+    unsigned int eax, ebx, ecx, edx;
+    unsigned int xcr0, xcr0High;
+
+    if ( !__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !( ecx & bit_OSXSAVE ) || !( ecx & bit_AVX ) )
+        {
+        return false;
+        }
+
+    ///The OS has to save the YMM registers on context switches
+    __asm__ volatile ( "xgetbv" : "=a" (xcr0), "=d" (xcr0High) : "c" (0) );
+    if ( 0x6 != ( xcr0 & 0x6 ) )
+        {
+        return false;
+        }
+
+    if ( 7 > __get_cpuid_max(0, NULL) )
+        {
+        return false;
+        }
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+    return ( 0 != ( ebx & bit_AVX2 ) );
+}
+
+#endif
+
+#ifdef PIXEL_KERNELS_NEON
+
+static bool neonSupported()
+{
+#if defined(__aarch64__)
+    return true;
+#else
+    char line[512];
+    bool neon = true;
+    FILE *cpuinfo = fopen("/proc/cpuinfo", "r");
+
+    ///Assume NEON when /proc/cpuinfo is unavailable, the library was built for it
+    if ( NULL == cpuinfo )
+        {
+        return true;
+        }
+
+    while ( NULL != fgets(line, sizeof(line), cpuinfo) )
+        {
+        if ( 0 == strncmp(line, "Features", 8) )
+            {
+            neon = ( NULL != strstr(line, " neon") );
+            break;
+            }
+        }
+
+    fclose(cpuinfo);
+
+    return neon;
+#endif
+}
+
+#endif
+
+struct PixelKernelsEntry
+{
+    const PixelKernels *kernels;
+    bool (*supported)();
+};
+
+///Candidate implementations, fastest first
+static const PixelKernelsEntry sKernels[] =
+{
+#ifdef PIXEL_KERNELS_NEON
+    { &sNEONKernels, neonSupported },
+#endif
+#ifdef PIXEL_KERNELS_AVX2
+    { &sAVX2Kernels, avx2Supported },
+#endif
+#ifdef PIXEL_KERNELS_SSE2
+    { &sSSE2Kernels, alwaysSupported },
+#endif
+    { &sScalarKernels, alwaysSupported },
+};
+
+static pthread_once_t sSelectOnce = PTHREAD_ONCE_INIT;
+static const PixelKernels *sSelected = &sScalarKernels;
+
+static void selectKernels()
+{
+    for ( size_t i = 0 ; i < sizeof(sKernels) / sizeof(sKernels[0]) ; i++ )
+        {
+        if ( sKernels[i].supported() )
+            {
+            sSelected = sKernels[i].kernels;
+            break;
+            }
+        }
+
+    LOGD("Using %s pixel kernels", sSelected->name);
+}
+
+/**
+   @brief Returns the fastest pixel kernels supported by the CPU
+
+   @param none
+   @return Kernel implementation, never NULL
+ */
+const PixelKernels* PixelKernels::get()
+{
+    pthread_once(&sSelectOnce, selectKernels);
+
+    return sSelected;
+}
+
+/**
+   @brief Returns the pixel kernels with the given name
+
+   @param name Implementation name
+   @return Kernel implementation
+   @return NULL if the implementation is not built in or not supported by the CPU
+ */
+const PixelKernels* PixelKernels::get(const char *name)
+{
+    if ( NULL == name )
+        {
+        return NULL;
+        }
+
+    for ( size_t i = 0 ; i < sizeof(sKernels) / sizeof(sKernels[0]) ; i++ )
+        {
+        if ( ( 0 == strcmp(sKernels[i].kernels->name, name) ) && sKernels[i].supported() )
+            {
+            return sKernels[i].kernels;
+            }
+        }
+
+    return NULL;
+}
+
+};
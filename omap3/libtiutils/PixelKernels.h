@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace android {
+
+///Pixel copy and conversion kernels shared by the camera HALs
+///There is one implementation per instruction set (scalar, SSE2, AVX2, NEON),
+///all of them producing bit-exact results. get() picks the fastest one the
+///CPU supports the first time it is called.
+class PixelKernels
+{
+public:
+
+    ///Returns the fastest implementation supported by the CPU
+    static const PixelKernels* get();
+
+    ///Returns the named implementation, or NULL if the build or the CPU does not support it
+    static const PixelKernels* get(const char *name);
+
+    ///Name of the implementation ("scalar", "sse2", "avx2" or "neon")
+    const char *name;
+
+    ///Copies height rows of width bytes from a strided buffer into a packed buffer.
+    ///Used for YUV422I and RGB565 frames, and for the luma plane of NV12 frames
+    void (*copyPacked)(uint8_t *dst, const uint8_t *src, size_t width, size_t height, size_t srcStride);
+
+    ///Copies height rows of an interleaved chroma plane into a packed buffer, swapping
+    ///the two bytes of each pair. Converts the chroma plane of NV12 to NV21 and back.
+    ///width is in bytes and must be even
+    void (*swapUV)(uint8_t *dst, const uint8_t *src, size_t width, size_t height, size_t srcStride);
+
+    ///Converts a YUV422I (YUYV) frame into packed NV21 planes. Chroma of each pair of
+    ///rows is averaged, rounding up. width is in pixels and must be even
+    void (*yuv422iToNV21)(uint8_t *dstY, uint8_t *dstVU, const uint8_t *src, size_t width, size_t height,
+                          size_t srcStride);
+};
+
+};
+
+#endif //PIXEL_KERNELS_H
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///NEON row kernels of PixelKernels, the only part of it built with -mfpu=neon
+
+#include <arm_neon.h>
+
+#include "RowKernels.h"
+
+namespace android {
+
+size_t swapUVRowNEON(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    size_t x = 0;
+
+    for ( ; x + 32 <= width ; x += 32 )
+        {
+        uint8x16x2_t uv = vld2q_u8(src + x);
+        uint8x16_t u = uv.val[0];
+
+        uv.val[0] = uv.val[1];
+        uv.val[1] = u;
+        vst2q_u8(dst + x, uv);
+        }
+
+    return x;
+}
+
+size_t yuv422iRowsNEON(uint8_t *y0, uint8_t *y1, uint8_t *vu,
+                              const uint8_t *r0, const uint8_t *r1, size_t width)
+{
+    size_t x = 0;
+
+    ///vld4 splits 32 pixels into even luma, U, odd luma and V
+    for ( ; x + 32 <= width ; x += 32 )
+        {
+        uint8x16x4_t a = vld4q_u8(r0 + 2 * x);
+        uint8x16x4_t b = vld4q_u8(r1 + 2 * x);
+        uint8x16x2_t out;
+
+        out.val[0] = a.val[0];
+        out.val[1] = a.val[2];
+        vst2q_u8(y0 + x, out);
+
+        if ( NULL != y1 )
+            {
+            out.val[0] = b.val[0];
+            out.val[1] = b.val[2];
+            vst2q_u8(y1 + x, out);
+            }
+
+        out.val[0] = vrhaddq_u8(a.val[3], b.val[3]);
+        out.val[1] = vrhaddq_u8(a.val[1], b.val[1]);
+        vst2q_u8(vu + x, out);
+        }
+
+    return x;
+}
+
+};
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef ROW_KERNELS_H
+#define ROW_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace android {
+
+///Row kernels shared between the libtiutils dispatchers and the translation
+///units that hold their vector variants. Each kernel processes as many leading
+///pixels of a row as its vector width allows and returns how many it did, the
+///scalar code of the dispatcher finishes the row.
+///
+///The NEON variants live in *_neon.cpp, the only files built with -mfpu=neon,
+///so that the dispatchers and the scalar fallbacks never contain NEON code.
+///They are only declared when the build sets LIBTIUTILS_NEON.
+
+///Statistics of the two channels of one Bayer row
+struct RowStats
+{
+    uint64_t sum[2];
+    uint16_t min[2];
+    uint16_t max[2];
+};
+
+#ifdef LIBTIUTILS_NEON
+
+size_t swapUVRowNEON(uint8_t *dst, const uint8_t *src, size_t width);
+size_t yuv422iRowsNEON(uint8_t *y0, uint8_t *y1, uint8_t *vu,
+                       const uint8_t *r0, const uint8_t *r1, size_t width);
+
+///Vector sums use 32 bit lanes, which holds for rows below 2^19 pixels
+size_t zoneRowNEON(RowStats *stats, const uint16_t *row, size_t width);
+
+///One output row of the vertical pass of YuvScaler, taps rows weighted by coef
+size_t verticalRowNEON(uint8_t *dst, const uint8_t *const *rows, const int16_t *coef, unsigned int taps,
+                       size_t width);
+
+#endif
+
+};
+
+#endif //ROW_KERNELS_H
@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#undef LOG_TAG
+
+#define LOG_TAG "TraceRing"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <utils/Log.h>
+#include <cutils/atomic.h>
+
+#include "DebugUtils.h"
+#include "TraceRing.h"
+
+namespace android {
+
+///One recorded event, 16 bytes
+struct TraceEvent
+{
+    int64_t mTimestamp;
+    uint16_t mId;
+    uint8_t mType;
+    uint8_t mReserved;
+    int32_t mValue;
+};
+
+///Ring of one thread
+///mHead is only written by the thread that claimed the ring, mTail only by
+///the drain thread, so a release store of either index publishes the events
+///(or the free slots) to the other side.
+struct TraceThreadRing
+{
+    enum State
+        {
+        RING_FREE,
+        RING_CLAIMED,
+        RING_ACTIVE,
+        ///The owner thread exited, freed once drained
+        RING_RETIRED
+        };
+
+    volatile int32_t mState;
+    volatile int32_t mHead;
+    volatile int32_t mTail;
+    volatile int32_t mDropped;
+    pid_t mTid;
+    bool mNamed;
+    char mName[17];
+    TraceEvent mEvents[TraceRing::RING_EVENTS];
+};
+
+volatile int32_t TraceRing::sEnabled = 0;
+
+static TraceThreadRing sRings[TraceRing::MAX_THREADS];
+static pthread_key_t sRingKey;
+static pthread_once_t sRingKeyOnce = PTHREAD_ONCE_INIT;
+static volatile int32_t sUnclaimedDropped = 0;
+
+static const char * const *sNames = NULL;
+static unsigned int sNameCount = 0;
+
+///Serializes start() and stop()
+static pthread_mutex_t sControlLock = PTHREAD_MUTEX_INITIALIZER;
+///Wakes the drain thread up early when stopping
+static pthread_mutex_t sDrainLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sDrainCond = PTHREAD_COND_INITIALIZER;
+static pthread_t sDrainThread;
+static bool sRunning = false;
+static bool sExit = false;
+
+///Owned by the drain thread while it runs, by stop() afterwards
+static FILE *sFile = NULL;
+static bool sFirstRecord = true;
+static unsigned int sDropped = 0;
+
+static void retireRing(void *ring)
+{
+    android_atomic_release_store(TraceThreadRing::RING_RETIRED, &( ( TraceThreadRing * ) ring )->mState);
+}
+
+static void createRingKey()
+{
+    pthread_key_create(&sRingKey, retireRing);
+}
+
+static TraceThreadRing *claimRing()
+{
+    for ( unsigned int i = 0 ; i < TraceRing::MAX_THREADS ; i++ )
+        {
+        TraceThreadRing *ring = &sRings[i];
+
+        if ( 0 == android_atomic_cmpxchg(TraceThreadRing::RING_FREE, TraceThreadRing::RING_CLAIMED, &ring->mState) )
+            {
+            ring->mHead = 0;
+            ring->mTail = 0;
+            ring->mDropped = 0;
+            ring->mTid = gettid();
+            ring->mNamed = false;
+            memset(ring->mName, 0, sizeof(ring->mName));
+            prctl(PR_GET_NAME, ( unsigned long ) ring->mName, 0, 0, 0);
+
+            ///The name ends up in a JSON string
+            for ( char *c = ring->mName ; '\0' != *c ; c++ )
+                {
+                if ( ( '"' == *c ) || ( '\\' == *c ) || ( ' ' > *c ) )
+                    {
+                    *c = '_';
+                    }
+                }
+
+            android_atomic_release_store(TraceThreadRing::RING_ACTIVE, &ring->mState);
+
+            return ring;
+            }
+        }
+
+    return NULL;
+}
+
+void TraceRing::setEventNames(const char * const *names, unsigned int count)
+{
+    pthread_mutex_lock(&sControlLock);
+    sNames = names;
+    sNameCount = count;
+    pthread_mutex_unlock(&sControlLock);
+}
+
+void TraceRing::record(uint16_t id, EventType type, int32_t value)
+{
+    TraceThreadRing *ring;
+    TraceEvent *event;
+    struct timespec ts;
+    uint32_t head;
+
+    pthread_once(&sRingKeyOnce, createRingKey);
+
+    ring = ( TraceThreadRing * ) pthread_getspecific(sRingKey);
+    if ( NULL == ring )
+        {
+        ring = claimRing();
+        if ( NULL == ring )
+            {
+            ///More threads than rings, the claim is retried on the next event
+            android_atomic_inc(&sUnclaimedDropped);
+            return;
+            }
+
+        pthread_setspecific(sRingKey, ring);
+        }
+
+    head = ( uint32_t ) ring->mHead;
+    if ( RING_EVENTS <= ( head - ( uint32_t ) android_atomic_acquire_load(&ring->mTail) ) )
+        {
+        android_atomic_inc(&ring->mDropped);
+        return;
+        }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    event = &ring->mEvents[head & ( RING_EVENTS - 1 )];
+    event->mTimestamp = ( int64_t ) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    event->mId = id;
+    event->mType = ( uint8_t ) type;
+    event->mValue = value;
+
+    android_atomic_release_store(( int32_t ) ( head + 1 ), &ring->mHead);
+}
+
+static void writeEvent(const TraceThreadRing *ring, const TraceEvent *event)
+{
+    static const char phases[] = { 'B', 'E', 'b', 'e', 'C', 'i' };
+    char unnamed[16];
+    const char *name;
+
+    if ( ( event->mId < sNameCount ) && ( NULL != sNames[event->mId] ) )
+        {
+        name = sNames[event->mId];
+        }
+    else
+        {
+        snprintf(unnamed, sizeof(unnamed), "event-%u", event->mId);
+        name = unnamed;
+        }
+
+    ///Chrome timestamps are in microseconds
+    fprintf(sFile, "%s{\"name\":\"%s\",\"cat\":\"camera\",\"ph\":\"%c\",\"ts\":%lld.%03d,\"pid\":%d,\"tid\":%d",
+            sFirstRecord ? "" : ",\n", name, phases[event->mType],
+            ( long long ) ( event->mTimestamp / 1000 ), ( int ) ( event->mTimestamp % 1000 ),
+            ( int ) getpid(), ( int ) ring->mTid);
+    sFirstRecord = false;
+
+    switch ( event->mType )
+        {
+        case TraceRing::EVENT_ASYNC_BEGIN:
+        case TraceRing::EVENT_ASYNC_END:
+            fprintf(sFile, ",\"id\":%d}", event->mValue);
+            break;
+        case TraceRing::EVENT_COUNTER:
+            fprintf(sFile, ",\"args\":{\"value\":%d}}", event->mValue);
+            break;
+        case TraceRing::EVENT_INSTANT:
+            fputs(",\"s\":\"t\"}", sFile);
+            break;
+        default:
+            fputc('}', sFile);
+            break;
+        }
+}
+
+static void drainRing(TraceThreadRing *ring)
+{
+    uint32_t head = ( uint32_t ) android_atomic_acquire_load(&ring->mHead);
+    uint32_t tail = ( uint32_t ) ring->mTail;
+
+    if ( !ring->mNamed && ( '\0' != ring->mName[0] ) )
+        {
+        fprintf(sFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                sFirstRecord ? "" : ",\n", ( int ) getpid(), ( int ) ring->mTid, ring->mName);
+        sFirstRecord = false;
+        }
+    ring->mNamed = true;
+
+    for ( ; tail != head ; tail++ )
+        {
+        writeEvent(ring, &ring->mEvents[tail & ( TraceRing::RING_EVENTS - 1 )]);
+        }
+
+    android_atomic_release_store(( int32_t ) tail, &ring->mTail);
+    sDropped += android_atomic_swap(0, &ring->mDropped);
+}
+
+static void drainRings()
+{
+    for ( unsigned int i = 0 ; i < TraceRing::MAX_THREADS ; i++ )
+        {
+        TraceThreadRing *ring = &sRings[i];
+        int32_t state = android_atomic_acquire_load(&ring->mState);
+
+        if ( ( TraceThreadRing::RING_ACTIVE == state ) || ( TraceThreadRing::RING_RETIRED == state ) )
+            {
+            drainRing(ring);
+            }
+
+        if ( TraceThreadRing::RING_RETIRED == state )
+            {
+            android_atomic_release_store(TraceThreadRing::RING_FREE, &ring->mState);
+            }
+        }
+
+    sDropped += android_atomic_swap(0, &sUnclaimedDropped);
+    fflush(sFile);
+}
+
+static void *drainThread(void *)
+{
+    struct timespec ts;
+
+    pthread_mutex_lock(&sDrainLock);
+
+    while ( !sExit )
+        {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += TraceRing::DRAIN_PERIOD_MS * 1000000L;
+        ts.tv_sec += ts.tv_nsec / 1000000000L;
+        ts.tv_nsec %= 1000000000L;
+
+        pthread_cond_timedwait(&sDrainCond, &sDrainLock, &ts);
+
+        pthread_mutex_unlock(&sDrainLock);
+        drainRings();
+        pthread_mutex_lock(&sDrainLock);
+        }
+
+    pthread_mutex_unlock(&sDrainLock);
+
+    return NULL;
+}
+
+status_t TraceRing::start(const char *path)
+{
+    status_t ret = NO_ERROR;
+
+    pthread_mutex_lock(&sControlLock);
+
+    if ( sRunning )
+        {
+        pthread_mutex_unlock(&sControlLock);
+        return ALREADY_EXISTS;
+        }
+
+    sFile = fopen(path, "w");
+    if ( NULL == sFile )
+        {
+        DBGUTILS_LOGEB("Unable to open trace file %s: %s", path, strerror(errno));
+        pthread_mutex_unlock(&sControlLock);
+        return BAD_VALUE;
+        }
+
+    ///Skip what was recorded around the previous stop()
+    for ( unsigned int i = 0 ; i < MAX_THREADS ; i++ )
+        {
+        TraceThreadRing *ring = &sRings[i];
+        int32_t state = android_atomic_acquire_load(&ring->mState);
+
+        if ( TraceThreadRing::RING_ACTIVE == state )
+            {
+            android_atomic_release_store(android_atomic_acquire_load(&ring->mHead), &ring->mTail);
+            ring->mDropped = 0;
+            ring->mNamed = false;
+            }
+        else if ( TraceThreadRing::RING_RETIRED == state )
+            {
+            android_atomic_release_store(TraceThreadRing::RING_FREE, &ring->mState);
+            }
+        }
+
+    sUnclaimedDropped = 0;
+    sDropped = 0;
+    sFirstRecord = true;
+    sExit = false;
+    fputs("[\n", sFile);
+
+    if ( 0 != pthread_create(&sDrainThread, NULL, drainThread, NULL) )
+        {
+        DBGUTILS_LOGEA("Unable to create the trace drain thread");
+        fclose(sFile);
+        sFile = NULL;
+        ret = NO_MEMORY;
+        }
+    else
+        {
+        sRunning = true;
+        android_atomic_release_store(1, &sEnabled);
+        DBGUTILS_LOGDB("Tracing to %s", path);
+        }
+
+    pthread_mutex_unlock(&sControlLock);
+
+    return ret;
+}
+
+status_t TraceRing::stop()
+{
+    pthread_mutex_lock(&sControlLock);
+
+    if ( !sRunning )
+        {
+        pthread_mutex_unlock(&sControlLock);
+        return NO_INIT;
+        }
+
+    android_atomic_release_store(0, &sEnabled);
+
+    pthread_mutex_lock(&sDrainLock);
+    sExit = true;
+    pthread_cond_signal(&sDrainCond);
+    pthread_mutex_unlock(&sDrainLock);
+
+    pthread_join(sDrainThread, NULL);
+
+    drainRings();
+    fputs("\n]\n", sFile);
+    fclose(sFile);
+    sFile = NULL;
+    sRunning = false;
+
+    if ( 0 < sDropped )
+        {
+        DBGUTILS_LOGEB("%u trace events dropped on full rings", sDropped);
+        }
+
+    pthread_mutex_unlock(&sControlLock);
+
+    return NO_ERROR;
+}
+
+unsigned int TraceRing::dropped()
+{
+    return sDropped;
+}
+
+};
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <Errors.h>
+#include <stdint.h>
+
+namespace android {
+
+///Binary event tracing for timing measurements that stay compiled in
+///Every thread records into its own ring of fixed size events, without locks
+///and without formatting anything. A background thread drains the rings and
+///writes the events to a file in the Chrome trace_event JSON format, which
+///chrome://tracing or Perfetto open directly.
+///While tracing is stopped a trace point costs a load and a branch.
+///When a ring is full, new events of that thread are dropped and counted.
+class TraceRing
+{
+public:
+
+    enum EventType
+        {
+        ///Duration on the calling thread, begin and end must nest
+        EVENT_BEGIN,
+        EVENT_END,
+        ///Duration that can begin and end on different threads
+        EVENT_ASYNC_BEGIN,
+        EVENT_ASYNC_END,
+        ///Value sampled at the time of the event
+        EVENT_COUNTER,
+        ///Point in time
+        EVENT_INSTANT
+        };
+
+    enum
+        {
+        RING_EVENTS = 512,
+        MAX_THREADS = 32,
+        MAX_EVENT_IDS = 256,
+        DRAIN_PERIOD_MS = 100
+        };
+
+    ///Names of the event ids, indexed by id. The table has to stay valid while tracing
+    static void setEventNames(const char * const *names, unsigned int count);
+
+    ///Starts the drain thread, which writes the events to path
+    ///Returns ALREADY_EXISTS if tracing is already running
+    static status_t start(const char *path);
+
+    ///Drains the rings a last time, completes the file and stops the drain thread
+    static status_t stop();
+
+    ///Records an event on the ring of the calling thread, use the TRACE_ macros instead
+    ///For async events value identifies the duration, for counters it is the sample
+    static void record(uint16_t id, EventType type, int32_t value);
+
+    ///Events dropped on full rings since the last start()
+    static unsigned int dropped();
+
+    ///Non zero while tracing, checked inline by the trace points
+    static volatile int32_t sEnabled;
+};
+
+#define TRACE_RECORD(id, type, value) \
+    do { if ( TraceRing::sEnabled ) TraceRing::record((id), (type), (value)); } while ( 0 )
+
+#define TRACE_BEGIN(id)                 TRACE_RECORD(id, TraceRing::EVENT_BEGIN, 0)
+#define TRACE_END(id)                   TRACE_RECORD(id, TraceRing::EVENT_END, 0)
+#define TRACE_ASYNC_BEGIN(id, cookie)   TRACE_RECORD(id, TraceRing::EVENT_ASYNC_BEGIN, cookie)
+#define TRACE_ASYNC_END(id, cookie)     TRACE_RECORD(id, TraceRing::EVENT_ASYNC_END, cookie)
+#define TRACE_COUNTER(id, value)        TRACE_RECORD(id, TraceRing::EVENT_COUNTER, value)
+#define TRACE_INSTANT(id)               TRACE_RECORD(id, TraceRing::EVENT_INSTANT, 0)
+
+};
+
+#endif //TRACE_RING_H
@@ -0,0 +1,689 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_TAG "YuvScaler"
+#include <utils/Log.h>
+
+#include "YuvScaler.h"
+#include "PixelKernels.h"
+#include "RowKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define YUV_SCALER_SSE2
+#endif
+
+///The NEON row kernel is built in YuvScaler_neon.cpp
+#ifdef LIBTIUTILS_NEON
+#define YUV_SCALER_NEON
+#endif
+
+namespace android {
+
+#define COEF_ONE    ( 1 << YuvScaler::COEF_BITS )
+#define COEF_ROUND  ( 1 << ( YuvScaler::COEF_BITS - 1 ) )
+
+///Smallest crop, in luma pixels, so that the 4 taps of a chroma window fit in it
+#define MIN_CROP    8
+
+static inline uint8_t clampPixel(int32_t sum)
+{
+    sum = ( sum + COEF_ROUND ) >> YuvScaler::COEF_BITS;
+
+    return ( 0 > sum ) ? 0 : ( ( 255 < sum ) ? 255 : sum );
+}
+
+/*--------------------Scalar kernels-----------------------------*/
+
+///Vector kernels process as many leading pixels as their width allows, this
+///finishes the row
+
+static void verticalTail(uint8_t *dst, const uint8_t *const *rows, const int16_t *coef, unsigned int taps,
+                         size_t from, size_t width)
+{
+    for ( size_t x = from ; x < width ; x++ )
+        {
+        int32_t sum = 0;
+
+        for ( unsigned int t = 0 ; t < taps ; t++ )
+            {
+            sum += coef[t] * rows[t][x];
+            }
+
+        dst[x] = clampPixel(sum);
+        }
+}
+
+static void verticalRowScalar(uint8_t *dst, const uint8_t *const *rows, const int16_t *coef, unsigned int taps,
+                              size_t width)
+{
+    verticalTail(dst, rows, coef, taps, 0, width);
+}
+
+static const YuvScaler::Kernels sScalarKernels =
+{
+    "scalar",
+    verticalRowScalar,
+};
+
+/*--------------------SSE2 kernels-----------------------------*/
+
+#ifdef YUV_SCALER_SSE2
+
+///Two source rows, 16 pixels, multiplied by their interleaved coefficient pair
+static inline void maddPair(__m128i sum[4], const uint8_t *a, const uint8_t *b, __m128i coefs)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i va = _mm_loadu_si128((const __m128i *) a);
+    __m128i vb = _mm_loadu_si128((const __m128i *) b);
+    __m128i lo = _mm_unpacklo_epi8(va, zero);
+    __m128i hi = _mm_unpackhi_epi8(va, zero);
+    __m128i blo = _mm_unpacklo_epi8(vb, zero);
+    __m128i bhi = _mm_unpackhi_epi8(vb, zero);
+
+    sum[0] = _mm_add_epi32(sum[0], _mm_madd_epi16(_mm_unpacklo_epi16(lo, blo), coefs));
+    sum[1] = _mm_add_epi32(sum[1], _mm_madd_epi16(_mm_unpackhi_epi16(lo, blo), coefs));
+    sum[2] = _mm_add_epi32(sum[2], _mm_madd_epi16(_mm_unpacklo_epi16(hi, bhi), coefs));
+    sum[3] = _mm_add_epi32(sum[3], _mm_madd_epi16(_mm_unpackhi_epi16(hi, bhi), coefs));
+}
+
+static size_t verticalRowSSE2(uint8_t *dst, const uint8_t *const *rows, const int16_t *coef, unsigned int taps,
+                              size_t width)
+{
+    const __m128i round = _mm_set1_epi32(COEF_ROUND);
+    const __m128i c01 = _mm_set1_epi32(( uint16_t ) coef[0] | ( ( uint32_t ) ( uint16_t ) coef[1] << 16 ));
+    const __m128i c23 = ( 4 == taps ) ?
+                        _mm_set1_epi32(( uint16_t ) coef[2] | ( ( uint32_t ) ( uint16_t ) coef[3] << 16 )) :
+                        _mm_setzero_si128();
+    size_t x = 0;
+
+    for ( ; x + 16 <= width ; x += 16 )
+        {
+        __m128i sum[4] = { round, round, round, round };
+
+        maddPair(sum, rows[0] + x, rows[1] + x, c01);
+        if ( 4 == taps )
+            {
+            maddPair(sum, rows[2] + x, rows[3] + x, c23);
+            }
+
+        __m128i lo = _mm_packs_epi32(_mm_srai_epi32(sum[0], YuvScaler::COEF_BITS),
+                                     _mm_srai_epi32(sum[1], YuvScaler::COEF_BITS));
+        __m128i hi = _mm_packs_epi32(_mm_srai_epi32(sum[2], YuvScaler::COEF_BITS),
+                                     _mm_srai_epi32(sum[3], YuvScaler::COEF_BITS));
+
+        _mm_storeu_si128((__m128i *) ( dst + x ), _mm_packus_epi16(lo, hi));
+        }
+
+    return x;
+}
+
+static void verticalRowSSE2Full(uint8_t *dst, const uint8_t *const *rows, const int16_t *coef, unsigned int taps,
+                                size_t width)
+{
+    verticalTail(dst, rows, coef, taps, verticalRowSSE2(dst, rows, coef, taps, width), width);
+}
+
+static const YuvScaler::Kernels sSSE2Kernels =
+{
+    "sse2",
+    verticalRowSSE2Full,
+};
+
+#endif
+
+/*--------------------NEON kernels-----------------------------*/
+
+#ifdef YUV_SCALER_NEON
+
+static void verticalRowNEONFull(uint8_t *dst, const uint8_t *const *rows, const int16_t *coef, unsigned int taps,
+                                size_t width)
+{
+    verticalTail(dst, rows, coef, taps, verticalRowNEON(dst, rows, coef, taps, width), width);
+}
+
+static const YuvScaler::Kernels sNEONKernels =
+{
+    "neon",
+    verticalRowNEONFull,
+};
+
+///PixelKernels already knows whether the CPU has NEON
+static bool neonSupported()
+{
+    return ( NULL != PixelKernels::get("neon") );
+}
+
+#endif
+
+/*--------------------Implementation selection-----------------------------*/
+
+static bool alwaysSupported()
+{
+    return true;
+}
+
+struct ScalerKernelsEntry
+{
+    const YuvScaler::Kernels *kernels;
+    bool (*supported)();
+};
+
+///Candidate implementations, fastest first
+static const ScalerKernelsEntry sKernels[] =
+{
+#ifdef YUV_SCALER_NEON
+    { &sNEONKernels, neonSupported },
+#endif
+#ifdef YUV_SCALER_SSE2
+    { &sSSE2Kernels, alwaysSupported },
+#endif
+    { &sScalarKernels, alwaysSupported },
+};
+
+static pthread_once_t sSelectOnce = PTHREAD_ONCE_INIT;
+static const YuvScaler::Kernels *sSelected = &sScalarKernels;
+
+static void selectKernels()
+{
+    for ( size_t i = 0 ; i < sizeof(sKernels) / sizeof(sKernels[0]) ; i++ )
+        {
+        if ( sKernels[i].supported() )
+            {
+            sSelected = sKernels[i].kernels;
+            break;
+            }
+        }
+
+    LOGD("Using %s scaler kernels", sSelected->name);
+}
+
+/**
+   @brief Returns the fastest scaler kernels supported by the CPU
+
+   @param none
+   @return Implementation, never NULL
+ */
+const YuvScaler::Kernels* YuvScaler::getKernels()
+{
+    pthread_once(&sSelectOnce, selectKernels);
+
+    return sSelected;
+}
+
+/**
+   @brief Returns the scaler kernels with the given name
+
+   @param name Implementation name
+   @return Implementation
+   @return NULL if the implementation is not built in or not supported by the CPU
+ */
+const YuvScaler::Kernels* YuvScaler::getKernels(const char *name)
+{
+    if ( NULL == name )
+        {
+        return NULL;
+        }
+
+    for ( size_t i = 0 ; i < sizeof(sKernels) / sizeof(sKernels[0]) ; i++ )
+        {
+        if ( ( 0 == strcmp(sKernels[i].kernels->name, name) ) && sKernels[i].supported() )
+            {
+            return sKernels[i].kernels;
+            }
+        }
+
+    return NULL;
+}
+
+/*--------------------Filter tables-----------------------------*/
+
+///Q14 coefficients of one phase. The 4-tap filter weighs the source pixels
+///at -1, 0, 1 and 2 from the sample position, bilinear the ones at 0 and 1.
+///Rounding errors go to the largest tap so that flat areas stay flat
+static void filterCoefs(int16_t *coef, unsigned int taps, int phase)
+{
+    double t = (double) phase / YuvScaler::PHASES;
+    double w[YuvScaler::MAX_TAPS];
+    int32_t total = 0;
+    unsigned int largest = 0;
+
+    if ( 2 == taps )
+        {
+        w[0] = 1.0 - t;
+        w[1] = t;
+        }
+    else
+        {
+        w[0] = ( -t * t * t + 2 * t * t - t ) / 2;
+        w[1] = ( 3 * t * t * t - 5 * t * t + 2 ) / 2;
+        w[2] = ( -3 * t * t * t + 4 * t * t + t ) / 2;
+        w[3] = ( t * t * t - t * t ) / 2;
+        }
+
+    for ( unsigned int i = 0 ; i < taps ; i++ )
+        {
+        double scaled = w[i] * COEF_ONE;
+
+        coef[i] = (int16_t) ( ( 0 > scaled ) ? ( scaled - 0.5 ) : ( scaled + 0.5 ) );
+        total += coef[i];
+        if ( coef[i] > coef[largest] )
+            {
+            largest = i;
+            }
+        }
+
+    coef[largest] += COEF_ONE - total;
+}
+
+///Sample position of output index i in PHASES units of the source, centers aligned
+static int32_t samplePosition(int i, int srcSize, int dstSize)
+{
+    int64_t num = ( (int64_t) ( 2 * i + 1 ) * srcSize - dstSize ) * YuvScaler::PHASES + dstSize;
+    int64_t den = 2 * (int64_t) dstSize;
+
+    ///Floor division, positions left of the first pixel are negative
+    return (int32_t) ( ( 0 <= num ) ? ( num / den ) : -( ( -num + den - 1 ) / den ) );
+}
+
+///First tap and coefficients of output index i, with the taps that fall
+///outside of the size source pixels folded onto the edge ones
+static int32_t windowCoefs(int16_t *coef, unsigned int taps, int i, int srcSize, int dstSize, bool fold)
+{
+    int32_t pos = samplePosition(i, srcSize, dstSize);
+    int32_t first = ( pos >> 6 ) - ( ( 4 == taps ) ? 1 : 0 );
+    int16_t raw[YuvScaler::MAX_TAPS];
+
+    filterCoefs(raw, taps, pos & ( YuvScaler::PHASES - 1 ));
+
+    if ( !fold )
+        {
+        memcpy(coef, raw, taps * sizeof(int16_t));
+        return first;
+        }
+
+    int32_t start = first;
+    if ( 0 > start )
+        {
+        start = 0;
+        }
+    if ( start > srcSize - (int32_t) taps )
+        {
+        start = srcSize - taps;
+        }
+
+    memset(coef, 0, taps * sizeof(int16_t));
+    for ( unsigned int k = 0 ; k < taps ; k++ )
+        {
+        int32_t index = first + k;
+
+        index = ( 0 > index ) ? 0 : ( ( srcSize <= index ) ? ( srcSize - 1 ) : index );
+        coef[index - start] += raw[k];
+        }
+
+    return start;
+}
+
+///Sampled components of a packed frame
+void YuvScaler::framePlanes(int format, int width, int height, Plane *y, Plane *u, Plane *v)
+{
+    if ( FORMAT_NV12 == format )
+        {
+        Plane py = { 0, 1, (size_t) width, width, height };
+        Plane pu = { (size_t) width * height, 2, (size_t) width, width / 2, height / 2 };
+
+        *y = py;
+        *u = pu;
+        *v = pu;
+        v->offset++;
+        }
+    else
+        {
+        Plane py = { 1, 2, (size_t) width * 2, width, height };
+        Plane pu = { 0, 4, (size_t) width * 2, width / 2, height };
+
+        *y = py;
+        *u = pu;
+        *v = pu;
+        v->offset += 2;
+        }
+}
+
+/*--------------------YuvScaler-----------------------------*/
+
+YuvScaler::YuvScaler()
+    : mKernels(NULL), mConfigured(false), mTaps(0), mPassCount(0), mLine(NULL)
+{
+    memset(mConfig, 0, sizeof(mConfig));
+    memset(mPasses, 0, sizeof(mPasses));
+}
+
+YuvScaler::~YuvScaler()
+{
+    release();
+}
+
+void YuvScaler::setKernels(const Kernels *kernels)
+{
+    Mutex::Autolock lock(mLock);
+
+    mKernels = kernels;
+}
+
+void YuvScaler::release()
+{
+    for ( unsigned int p = 0 ; p < mPassCount ; p++ )
+        {
+        free(mPasses[p].rowIndex);
+        free(mPasses[p].rowCoef);
+        for ( unsigned int j = 0 ; j < mPasses[p].jobCount ; j++ )
+            {
+            free(mPasses[p].jobs[j].taps);
+            }
+        }
+
+    memset(mPasses, 0, sizeof(mPasses));
+    mPassCount = 0;
+
+    free(mLine);
+    mLine = NULL;
+
+    mConfigured = false;
+}
+
+///Builds the row and column tables of one geometry. One pass per distinct set
+///of source rows: a single one when a YUV422I frame goes to a YUV422I frame,
+///luma then chroma otherwise
+status_t YuvScaler::configure(int srcWidth, int srcHeight, int srcFormat, int dstWidth, int dstHeight,
+                              int dstFormat, int cropTop, int cropLeft, int cropWidth, int cropHeight,
+                              Filter filter)
+{
+    Plane srcPlanes[3], dstPlanes[3];
+    size_t lineMax = 0;
+
+    release();
+
+    mTaps = ( FILTER_POLYPHASE == filter ) ? 4 : 2;
+
+    framePlanes(srcFormat, srcWidth, srcHeight, &srcPlanes[0], &srcPlanes[1], &srcPlanes[2]);
+    framePlanes(dstFormat, dstWidth, dstHeight, &dstPlanes[0], &dstPlanes[1], &dstPlanes[2]);
+
+    ///Luma shares its rows with chroma only when both frames are YUV422I
+    mPassCount = ( ( FORMAT_YUV422I == srcFormat ) && ( FORMAT_YUV422I == dstFormat ) ) ? 1 : 2;
+
+    for ( unsigned int p = 0 ; p < mPassCount ; p++ )
+        {
+        Pass &pass = mPasses[p];
+        bool chroma = ( 1 == p );
+        const Plane &rows = chroma ? srcPlanes[1] : srcPlanes[0];
+        int vsub = srcHeight / rows.height;
+        int top = cropTop / vsub;
+        int height = cropHeight / vsub;
+
+        ///The source rows start with the first component of the plane
+        pass.src = rows;
+        pass.src.offset = ( FORMAT_NV12 == srcFormat ) ? rows.offset : 0;
+        pass.dstRows = chroma ? dstPlanes[1].height : dstPlanes[0].height;
+
+        ///Bytes of the crop within a source row
+        if ( FORMAT_NV12 == srcFormat )
+            {
+            pass.lineOffset = cropLeft;
+            pass.lineLength = cropWidth;
+            }
+        else
+            {
+            pass.lineOffset = cropLeft * 2;
+            pass.lineLength = cropWidth * 2;
+            }
+
+        lineMax = ( pass.lineLength > lineMax ) ? pass.lineLength : lineMax;
+
+        pass.rowIndex = (int32_t *) malloc(pass.dstRows * mTaps * sizeof(int32_t));
+        pass.rowCoef = (int16_t *) malloc(pass.dstRows * mTaps * sizeof(int16_t));
+        if ( ( NULL == pass.rowIndex ) || ( NULL == pass.rowCoef ) )
+            {
+            release();
+            return NO_MEMORY;
+            }
+
+        for ( int r = 0 ; r < pass.dstRows ; r++ )
+            {
+            int32_t first = windowCoefs(pass.rowCoef + r * mTaps, mTaps, r, height, pass.dstRows, false);
+
+            ///Rows are fetched one by one, the edge row repeats
+            for ( unsigned int t = 0 ; t < mTaps ; t++ )
+                {
+                int32_t index = first + t;
+
+                index = ( 0 > index ) ? 0 : ( ( height <= index ) ? ( height - 1 ) : index );
+                pass.rowIndex[r * mTaps + t] = top + index;
+                }
+            }
+
+        ///Components the pass writes
+        unsigned int first = chroma ? 1 : 0;
+        unsigned int last = ( chroma || ( 1 == mPassCount ) ) ? 2 : 0;
+
+        pass.jobCount = 0;
+        for ( unsigned int c = first ; c <= last ; c++ )
+            {
+            Job &job = pass.jobs[pass.jobCount++];
+            int left = cropLeft / ( srcWidth / srcPlanes[c].width );
+            int width = cropWidth / ( srcWidth / srcPlanes[c].width );
+            ///Byte of the first cropped sample of the component within the line
+            int32_t base = (int32_t) ( srcPlanes[c].offset - pass.src.offset ) +
+                           left * (int32_t) srcPlanes[c].step - (int32_t) pass.lineOffset;
+
+            job.dst = dstPlanes[c];
+            job.srcStep = srcPlanes[c].step;
+            job.taps = (Tap *) malloc(job.dst.width * sizeof(Tap));
+            if ( NULL == job.taps )
+                {
+                release();
+                return NO_MEMORY;
+                }
+
+            for ( int i = 0 ; i < job.dst.width ; i++ )
+                {
+                int32_t start = windowCoefs(job.taps[i].coef, mTaps, i, width, job.dst.width, true);
+
+                job.taps[i].offset = base + start * (int32_t) job.srcStep;
+                }
+            }
+        }
+
+    mLine = (uint8_t *) malloc(lineMax);
+    if ( NULL == mLine )
+        {
+        release();
+        return NO_MEMORY;
+        }
+
+    mConfigured = true;
+
+    return NO_ERROR;
+}
+
+/**
+   @brief Scales the crop rectangle of a frame into another frame
+
+   @param src Source frame
+   @param srcWidth Source width in pixels
+   @param srcHeight Source height in pixels
+   @param srcFormat FORMAT_YUV422I or FORMAT_NV12
+   @param dst Destination frame
+   @param dstWidth Destination width in pixels, even
+   @param dstHeight Destination height in pixels, even for NV12
+   @param dstFormat FORMAT_YUV422I or FORMAT_NV12
+   @param cropTop Crop rectangle in the source, in pixels
+   @param cropLeft
+   @param cropWidth
+   @param cropHeight
+   @param zoom Further zoom in the crop rectangle, 1.0 or less for none
+   @param filter Interpolation filter
+   @return NO_ERROR
+   @return BAD_VALUE if a frame or the crop rectangle are unusable
+   @return NO_MEMORY if the tables cannot be allocated
+ */
+status_t YuvScaler::process(const void *src, int srcWidth, int srcHeight, int srcFormat,
+                            void *dst, int dstWidth, int dstHeight, int dstFormat,
+                            int cropTop, int cropLeft, int cropWidth, int cropHeight,
+                            float zoom, Filter filter)
+{
+    Mutex::Autolock lock(mLock);
+    int config[11];
+    status_t ret;
+
+    if ( ( NULL == src ) || ( NULL == dst ) ||
+         ( ( FORMAT_YUV422I != srcFormat ) && ( FORMAT_NV12 != srcFormat ) ) ||
+         ( ( FORMAT_YUV422I != dstFormat ) && ( FORMAT_NV12 != dstFormat ) ) ||
+         ( ( FILTER_BILINEAR != filter ) && ( FILTER_POLYPHASE != filter ) ) ||
+         ( MIN_CROP > srcWidth ) || ( MIN_CROP > srcHeight ) || ( srcWidth & 1 ) ||
+         ( ( FORMAT_NV12 == srcFormat ) && ( srcHeight & 1 ) ) ||
+         ( 2 > dstWidth ) || ( 2 > dstHeight ) || ( dstWidth & 1 ) ||
+         ( ( FORMAT_NV12 == dstFormat ) && ( dstHeight & 1 ) ) )
+        {
+        LOGE("Unsupported scaling %dx%d (%d) to %dx%d (%d)", srcWidth, srcHeight, srcFormat,
+             dstWidth, dstHeight, dstFormat);
+        return BAD_VALUE;
+        }
+
+    ///Clamp the crop to the frame, as scale_process() does
+    cropTop = ( 0 > cropTop ) ? 0 : ( ( srcHeight < cropTop ) ? srcHeight : cropTop );
+    cropLeft = ( 0 > cropLeft ) ? 0 : ( ( srcWidth < cropLeft ) ? srcWidth : cropLeft );
+    cropWidth = ( 0 > cropWidth ) ? 0 : ( ( srcWidth - cropLeft < cropWidth ) ? ( srcWidth - cropLeft ) : cropWidth );
+    cropHeight = ( 0 > cropHeight ) ? 0 : ( ( srcHeight - cropTop < cropHeight ) ? ( srcHeight - cropTop ) : cropHeight );
+
+    if ( 1.0f < zoom )
+        {
+        int width = (int) ( cropWidth / zoom );
+        int height = (int) ( cropHeight / zoom );
+
+        cropLeft += ( cropWidth - width ) / 2;
+        cropTop += ( cropHeight - height ) / 2;
+        cropWidth = width;
+        cropHeight = height;
+        }
+
+    ///Whole chroma samples only
+    cropWidth += cropLeft & 1;
+    cropLeft &= ~1;
+    cropWidth &= ~1;
+    if ( FORMAT_NV12 == srcFormat )
+        {
+        cropHeight += cropTop & 1;
+        cropTop &= ~1;
+        cropHeight &= ~1;
+        }
+
+    if ( ( MIN_CROP > cropWidth ) || ( MIN_CROP > cropHeight ) )
+        {
+        LOGE("Crop %dx%d too small", cropWidth, cropHeight);
+        return BAD_VALUE;
+        }
+
+    config[0] = srcWidth;
+    config[1] = srcHeight;
+    config[2] = srcFormat;
+    config[3] = dstWidth;
+    config[4] = dstHeight;
+    config[5] = dstFormat;
+    config[6] = cropTop;
+    config[7] = cropLeft;
+    config[8] = cropWidth;
+    config[9] = cropHeight;
+    config[10] = filter;
+
+    if ( !mConfigured || ( 0 != memcmp(config, mConfig, sizeof(config)) ) )
+        {
+        ret = configure(srcWidth, srcHeight, srcFormat, dstWidth, dstHeight, dstFormat,
+                        cropTop, cropLeft, cropWidth, cropHeight, filter);
+        if ( NO_ERROR != ret )
+            {
+            return ret;
+            }
+
+        memcpy(mConfig, config, sizeof(config));
+        }
+
+    if ( NULL == mKernels )
+        {
+        mKernels = getKernels();
+        }
+
+    const uint8_t *in = (const uint8_t *) src;
+    uint8_t *out = (uint8_t *) dst;
+
+    for ( unsigned int p = 0 ; p < mPassCount ; p++ )
+        {
+        const Pass &pass = mPasses[p];
+
+        for ( int r = 0 ; r < pass.dstRows ; r++ )
+            {
+            const uint8_t *rows[MAX_TAPS];
+
+            for ( unsigned int t = 0 ; t < mTaps ; t++ )
+                {
+                rows[t] = in + pass.src.offset + pass.rowIndex[r * mTaps + t] * pass.src.stride + pass.lineOffset;
+                }
+
+            mKernels->verticalRow(mLine, rows, pass.rowCoef + r * mTaps, mTaps, pass.lineLength);
+
+            for ( unsigned int j = 0 ; j < pass.jobCount ; j++ )
+                {
+                const Job &job = pass.jobs[j];
+                uint8_t *o = out + job.dst.offset + r * job.dst.stride;
+                const size_t s = job.srcStep;
+
+                if ( 4 == mTaps )
+                    {
+                    for ( int i = 0 ; i < job.dst.width ; i++, o += job.dst.step )
+                        {
+                        const Tap &tap = job.taps[i];
+                        const uint8_t *l = mLine + tap.offset;
+
+                        *o = clampPixel(tap.coef[0] * l[0] + tap.coef[1] * l[s] +
+                                        tap.coef[2] * l[2 * s] + tap.coef[3] * l[3 * s]);
+                        }
+                    }
+                else
+                    {
+                    for ( int i = 0 ; i < job.dst.width ; i++, o += job.dst.step )
+                        {
+                        const Tap &tap = job.taps[i];
+                        const uint8_t *l = mLine + tap.offset;
+
+                        *o = clampPixel(tap.coef[0] * l[0] + tap.coef[1] * l[s]);
+                        }
+                    }
+                }
+            }
+        }
+
+    return NO_ERROR;
+}
+
+};
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef YUV_SCALER_H
+#define YUV_SCALER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Errors.h>
+#include <utils/threads.h>
+
+namespace android {
+
+///CPU crop, zoom and resize of YUV422I (UYVY) and NV12 frames
+///It takes the same crop and zoom arguments as the DSP VPP scale_process() of
+///camera-omap3, so that the HAL can run either one. Scaling is separable: a
+///vertical pass filters the source rows into one line, then a table driven
+///horizontal pass resamples that line. Coefficients are Q14 fixed point.
+///Like PixelKernels, the vertical pass has one implementation per instruction
+///set (scalar, SSE2, NEON), all of them bit-exact.
+class YuvScaler
+{
+public:
+
+    ///Same values as PIX_YUV422I and PIX_YUV420P of camera-omap3
+    enum Format
+        {
+        FORMAT_YUV422I = 0,
+        FORMAT_NV12 = 1
+        };
+
+    enum Filter
+        {
+        FILTER_BILINEAR = 0,
+        ///4-tap Catmull-Rom. Below half size the taps no longer cover the
+        ///source pixels, downscale in two steps when aliasing matters
+        FILTER_POLYPHASE = 1
+        };
+
+    enum
+        {
+        COEF_BITS = 14,
+        PHASES = 64,
+        MAX_TAPS = 4
+        };
+
+    ///Vertical pass kernels
+    struct Kernels
+        {
+        ///Name of the implementation ("scalar", "sse2" or "neon")
+        const char *name;
+
+        ///dst[x] = sum of coef[t] * rows[t][x] over taps rows, rounded from Q14
+        ///and clamped to 8 bits. taps is 2 or 4
+        void (*verticalRow)(uint8_t *dst, const uint8_t *const *rows, const int16_t *coef, unsigned int taps,
+                            size_t width);
+        };
+
+    ///Returns the fastest kernels supported by the CPU
+    static const Kernels* getKernels();
+
+    ///Returns the named kernels, or NULL if the build or the CPU does not support them
+    static const Kernels* getKernels(const char *name);
+
+    YuvScaler();
+    ~YuvScaler();
+
+    ///Overrides the kernels picked by getKernels(), for tests and benchmarks
+    void setKernels(const Kernels *kernels);
+
+    ///Scales the crop rectangle of src, narrowed around its center by zoom, to
+    ///the whole of dst. The crop is clamped to the source like scale_process()
+    ///does, and aligned to the chroma subsampling. Frames are packed, NV12 has
+    ///its chroma plane right after the luma one. Tables are kept between calls
+    ///with the same geometry
+    status_t process(const void *src, int srcWidth, int srcHeight, int srcFormat,
+                     void *dst, int dstWidth, int dstHeight, int dstFormat,
+                     int cropTop, int cropLeft, int cropWidth, int cropHeight,
+                     float zoom, Filter filter);
+
+private:
+
+    ///One output sample of the horizontal pass
+    struct Tap
+        {
+        int32_t offset;
+        int16_t coef[MAX_TAPS];
+        };
+
+    ///One sampled component of a frame, in bytes
+    struct Plane
+        {
+        size_t offset;
+        size_t step;
+        size_t stride;
+        int width;
+        int height;
+        };
+
+    ///Output component resampled from the line of a pass
+    struct Job
+        {
+        Plane dst;
+        Tap *taps;
+        size_t srcStep;
+        };
+
+    ///Source rows filtered into one line, and the components taken from it
+    struct Pass
+        {
+        Plane src;
+        int dstRows;
+        int32_t *rowIndex;
+        int16_t *rowCoef;
+        size_t lineOffset;
+        size_t lineLength;
+        Job jobs[3];
+        unsigned int jobCount;
+        };
+
+    status_t configure(int srcWidth, int srcHeight, int srcFormat, int dstWidth, int dstHeight,
+                       int dstFormat, int cropTop, int cropLeft, int cropWidth, int cropHeight,
+                       Filter filter);
+    void release();
+    static void framePlanes(int format, int width, int height, Plane *y, Plane *u, Plane *v);
+
+    const Kernels *mKernels;
+    Mutex mLock;
+
+    ///Geometry the tables were built for
+    int mConfig[11];
+    bool mConfigured;
+
+    unsigned int mTaps;
+    Pass mPasses[2];
+    unsigned int mPassCount;
+    uint8_t *mLine;
+};
+
+};
+
+#endif //YUV_SCALER_H
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///NEON row kernel of YuvScaler, the only part of it built with -mfpu=neon
+
+#include <arm_neon.h>
+
+#include "YuvScaler.h"
+#include "RowKernels.h"
+
+namespace android {
+
+size_t verticalRowNEON(uint8_t *dst, const uint8_t *const *rows, const int16_t *coef, unsigned int taps,
+                       size_t width)
+{
+    size_t x = 0;
+
+    for ( ; x + 8 <= width ; x += 8 )
+        {
+        int16x8_t p = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(rows[0] + x)));
+        int32x4_t lo = vmull_n_s16(vget_low_s16(p), coef[0]);
+        int32x4_t hi = vmull_n_s16(vget_high_s16(p), coef[0]);
+
+        for ( unsigned int t = 1 ; t < taps ; t++ )
+            {
+            p = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(rows[t] + x)));
+            lo = vmlal_n_s16(lo, vget_low_s16(p), coef[t]);
+            hi = vmlal_n_s16(hi, vget_high_s16(p), coef[t]);
+            }
+
+        ///Rounding narrow shifts, then saturation to 8 bits, as clampPixel() does
+        int16x8_t sum = vcombine_s16(vqrshrn_n_s32(lo, YuvScaler::COEF_BITS),
+                                     vqrshrn_n_s32(hi, YuvScaler::COEF_BITS));
+
+        vst1_u8(dst + x, vqmovun_s16(sum));
+        }
+
+    return x;
+}
+
+};
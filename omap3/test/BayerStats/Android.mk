@@ -0,0 +1,46 @@
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	bayerstats_test.cpp \
+	../../camera-omap4/src/CameraCalibration/EepromCRC.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libtiutils \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/libtiutils \
+	hardware/ti/omap4/omap3/camera-omap4/src/CameraCalibration \
+	hardware/ti/omap4/omap3/test
+
+LOCAL_MODULE:= bayerstats_test
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	bayerstats_bench.cpp \
+	../../camera-omap4/src/CameraCalibration/EepromCRC.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libtiutils \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/libtiutils \
+	hardware/ti/omap4/omap3/camera-omap4/src/CameraCalibration
+
+LOCAL_MODULE:= bayerstats_bench
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Throughput benchmark of the libtiutils Bayer statistics on a synthetic 8MP
+///RAW frame (3280x2464, 10 bit), and of the calibration EEPROM CRC.
+///
+///Usage: bayerstats_bench [iterations]
+///
+///Prints one CSV row per kernel and implementation:
+///kernel,impl,width,height,iterations,ms_per_run,mpix_per_sec
+///
+///Kernels:
+///  frame_stats     sums, minimum and maximum of the whole frame
+///  histogram       per channel histograms of the whole frame
+///  cal_zones       the 9x7 zones of 32x32 pixels CameraCal averages
+///  eeprom_crc      CRC of the 76 byte calibrated EEPROM range, bitwise as before
+///                  and table driven. width is in bytes for this one
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "BayerStats.h"
+#include "EepromCRC.h"
+
+using namespace android;
+
+#define DEFAULT_ITERATIONS  20
+#define RAW_WIDTH           3280
+#define RAW_HEIGHT          2464
+#define CRC_START           0x0
+#define CRC_END             0x4b
+#define CRC_RUNS            10000
+
+static const char *sImplementations[] = { "scalar", "sse2", "neon" };
+
+enum
+{
+    KERNEL_FRAME_STATS = 0,
+    KERNEL_HISTOGRAM,
+    KERNEL_CAL_ZONES,
+    KERNEL_COUNT
+};
+
+static const char *sKernelNames[KERNEL_COUNT] = { "frame_stats", "histogram", "cal_zones" };
+
+static uint32_t sHistogram[BayerStats::CHANNELS * BayerStats::HISTOGRAM_BINS];
+
+///Keeps the compiler from dropping results nobody reads
+static volatile uint64_t sSink;
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void runKernel(const BayerStats *s, int kernel, const uint16_t *raw)
+{
+    BayerStats::Zone zone;
+
+    switch ( kernel )
+        {
+        case KERNEL_FRAME_STATS:
+            s->zoneStats(&zone, raw, RAW_WIDTH, RAW_HEIGHT, RAW_WIDTH);
+            sSink += zone.sum[0];
+            break;
+
+        case KERNEL_HISTOGRAM:
+            memset(sHistogram, 0, sizeof(sHistogram));
+            s->histogram(sHistogram, 10, raw, RAW_WIDTH, RAW_HEIGHT, RAW_WIDTH);
+            sSink += sHistogram[0];
+            break;
+
+        case KERNEL_CAL_ZONES:
+            for ( int row = 0 ; row < 7 ; row++ )
+                {
+                for ( int col = 0 ; col < 9 ; col++ )
+                    {
+                    s->zoneStats(&zone, raw + ( row * 400 + 4 ) * RAW_WIDTH + col * 402 + 4, 32, 32, RAW_WIDTH);
+                    sSink += zone.sum[0];
+                    }
+                }
+            break;
+        }
+}
+
+///The bitwise CRC calcEepromCRC() used before the table
+static uint16_t bitwiseCRC(const uint8_t *pData, uint32_t nStart, uint32_t nEnd)
+{
+    uint16_t crc = 0x0000;
+    uint32_t tmp;
+
+    for ( uint32_t i = nStart ; i <= nEnd + 2 ; i++ )
+        {
+        tmp = ( i > nEnd ) ? 0 : pData[i];
+
+        for ( int j = 0 ; j < 8 ; j++ )
+            {
+            crc = ( crc & 0x8000 ) ? ( ( crc << 1 ) ^ 0x8005 ) : ( crc << 1 );
+            if ( tmp & 0x80 )
+                {
+                crc ^= 0x0001;
+                }
+            tmp <<= 1;
+            }
+        }
+
+    return crc;
+}
+
+static void benchCRC()
+{
+    uint8_t eeprom[256];
+
+    for ( size_t i = 0 ; i < sizeof(eeprom) ; i++ )
+        {
+        eeprom[i] = rand() & 0xFF;
+        }
+
+    for ( int table = 0 ; table < 2 ; table++ )
+        {
+        int64_t start = now_ns();
+
+        for ( int n = 0 ; n < CRC_RUNS ; n++ )
+            {
+            ///Vary one byte so that every run computes a new CRC
+            eeprom[CRC_START] = n;
+            sSink += table ? calcEepromCRC(eeprom, CRC_START, CRC_END) : bitwiseCRC(eeprom, CRC_START, CRC_END);
+            }
+
+        double msPerRun = ( now_ns() - start ) / 1e6 / CRC_RUNS;
+
+        printf("eeprom_crc,%s,%d,1,%d,%.6f,%.1f\n", table ? "table" : "bitwise",
+               CRC_END - CRC_START + 1, CRC_RUNS, msPerRun, ( CRC_END - CRC_START + 1 ) / ( msPerRun * 1e3 ));
+        }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int iterations = DEFAULT_ITERATIONS;
+    uint16_t *raw;
+
+    if ( 1 < argc )
+        {
+        iterations = strtoul(argv[1], NULL, 0);
+        if ( 0 == iterations )
+            {
+            fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    raw = (uint16_t *) malloc(RAW_WIDTH * RAW_HEIGHT * sizeof(uint16_t));
+    if ( NULL == raw )
+        {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+        }
+
+    for ( size_t i = 0 ; i < RAW_WIDTH * RAW_HEIGHT ; i++ )
+        {
+        raw[i] = rand() & 0x3FF;
+        }
+
+    printf("kernel,impl,width,height,iterations,ms_per_run,mpix_per_sec\n");
+
+    for ( int kernel = 0 ; kernel < KERNEL_COUNT ; kernel++ )
+        {
+        for ( size_t i = 0 ; i < sizeof(sImplementations) / sizeof(sImplementations[0]) ; i++ )
+            {
+            const BayerStats *s = BayerStats::get(sImplementations[i]);
+            unsigned int runs = ( KERNEL_CAL_ZONES == kernel ) ? ( iterations * 100 ) : iterations;
+            double pixels = ( KERNEL_CAL_ZONES == kernel ) ? ( 9 * 7 * 32 * 32 ) : ( RAW_WIDTH * RAW_HEIGHT );
+
+            if ( NULL == s )
+                {
+                continue;
+                }
+
+            ///Warm up the caches and the page tables
+            runKernel(s, kernel, raw);
+
+            int64_t start = now_ns();
+
+            for ( unsigned int n = 0 ; n < runs ; n++ )
+                {
+                runKernel(s, kernel, raw);
+                }
+
+            double msPerRun = ( now_ns() - start ) / 1e6 / runs;
+
+            printf("%s,%s,%d,%d,%u,%.3f,%.1f\n", sKernelNames[kernel], s->name,
+                   RAW_WIDTH, RAW_HEIGHT, runs, msPerRun, pixels / ( msPerRun * 1e3 ));
+            }
+        }
+
+    benchCRC();
+
+    free(raw);
+
+    return 0;
+}
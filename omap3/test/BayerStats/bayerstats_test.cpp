@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Bit-exactness tests of the libtiutils Bayer statistics and of the camera
+///calibration EEPROM CRC. Every implementation supported by the CPU is checked
+///against a per-pixel reference on odd sizes, padded strides and unaligned
+///buffers, and against the zone averaging loop CameraCal used before.
+///The table driven CRC is checked against the bitwise one it replaced.
+///
+///Usage: bayerstats_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BayerStats.h"
+#include "EepromCRC.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+static const char *sImplementations[] = { "scalar", "sse2", "neon" };
+
+static const size_t sWidths[] = { 2, 4, 6, 8, 14, 16, 18, 30, 32, 34, 62, 64, 66, 322, 3280 };
+static const size_t sHeights[] = { 2, 4, 6, 16 };
+
+static void fillRandom(uint16_t *buf, size_t count, unsigned int bits)
+{
+    for ( size_t i = 0 ; i < count ; i++ )
+        {
+        buf[i] = ( ( rand() << 8 ) ^ rand() ) & ( ( 1 << bits ) - 1 );
+        }
+}
+
+static void referenceZone(BayerStats::Zone *zone, const uint16_t *src, size_t width, size_t height,
+                          size_t stride)
+{
+    for ( int c = 0 ; c < BayerStats::CHANNELS ; c++ )
+        {
+        zone->sum[c] = 0;
+        zone->min[c] = 0xFFFF;
+        zone->max[c] = 0;
+        }
+
+    for ( size_t y = 0 ; y < height ; y++ )
+        {
+        for ( size_t x = 0 ; x < width ; x++ )
+            {
+            int c = ( y & 1 ) * 2 + ( x & 1 );
+            uint16_t value = src[y * stride + x];
+
+            zone->sum[c] += value;
+            zone->min[c] = ( value < zone->min[c] ) ? value : zone->min[c];
+            zone->max[c] = ( value > zone->max[c] ) ? value : zone->max[c];
+            }
+        }
+}
+
+static bool checkZone(const BayerStats *s, size_t width, size_t height, size_t stride, unsigned int bits)
+{
+    ///One extra pixel in front so that rows start unaligned
+    uint16_t *base = (uint16_t *) malloc(( stride * height + 1 ) * sizeof(uint16_t));
+    uint16_t *src = base + 1;
+    BayerStats::Zone expected, zone;
+    bool ok;
+
+    fillRandom(base, stride * height + 1, bits);
+
+    referenceZone(&expected, src, width, height, stride);
+    s->zoneStats(&zone, src, width, height, stride);
+
+    ok = ( 0 == memcmp(expected.sum, zone.sum, sizeof(zone.sum)) ) &&
+         ( 0 == memcmp(expected.min, zone.min, sizeof(zone.min)) ) &&
+         ( 0 == memcmp(expected.max, zone.max, sizeof(zone.max)) );
+
+    free(base);
+
+    return ok;
+}
+
+static bool checkHistogram(const BayerStats *s, size_t width, size_t height, size_t stride, unsigned int bits)
+{
+    const size_t bins = BayerStats::CHANNELS * BayerStats::HISTOGRAM_BINS;
+    uint16_t *src = (uint16_t *) malloc(stride * height * sizeof(uint16_t));
+    uint32_t expected[BayerStats::CHANNELS * BayerStats::HISTOGRAM_BINS];
+    uint32_t hist[BayerStats::CHANNELS * BayerStats::HISTOGRAM_BINS];
+    bool ok;
+
+    ///Two more bits than the histogram expects, so that the last bin collects the overflow
+    fillRandom(src, stride * height, bits + 2);
+
+    memset(expected, 0, sizeof(expected));
+    for ( size_t y = 0 ; y < height ; y++ )
+        {
+        for ( size_t x = 0 ; x < width ; x++ )
+            {
+            unsigned int bin = src[y * stride + x] >> ( bits - 8 );
+            int c = ( y & 1 ) * 2 + ( x & 1 );
+
+            if ( BayerStats::HISTOGRAM_BINS <= bin )
+                {
+                bin = BayerStats::HISTOGRAM_BINS - 1;
+                }
+
+            expected[c * BayerStats::HISTOGRAM_BINS + bin]++;
+            }
+        }
+
+    ///Histograms accumulate, so run twice over a cleared one
+    memset(hist, 0, sizeof(hist));
+    s->histogram(hist, bits, src, width, height, stride);
+    s->histogram(hist, bits, src, width, height, stride);
+
+    ok = true;
+    for ( size_t i = 0 ; i < bins ; i++ )
+        {
+        ok = ok && ( 2 * expected[i] == hist[i] );
+        }
+
+    free(src);
+
+    return ok;
+}
+
+///The 32x32 zone averaging parse_eeprom_data() did one pixel at a time
+static bool checkCalibrationZone(const BayerStats *s)
+{
+    const size_t width = 3280, height = 2464;
+    uint16_t *img = (uint16_t *) malloc(width * height * sizeof(uint16_t));
+    bool ok = true;
+
+    fillRandom(img, width * height, 10);
+
+    for ( int ee_row = 0 ; ee_row < 7 ; ee_row++ )
+        {
+        for ( int ee_col = 0 ; ee_col < 9 ; ee_col++ )
+            {
+            uint16_t *p_img = img + ( ee_row * 400 + 2 + 2 ) * width + ee_col * 402 + 0 + 4;
+            uint16_t *zoneStart = p_img;
+            uint32_t r_sum = 0, gr_sum = 0, b_sum = 0, gb_sum = 0;
+            BayerStats::Zone zone;
+
+            for ( int pax_row = 0 ; pax_row < 32 ; pax_row += 2 )
+                {
+                for ( int pax_col = 0 ; pax_col < 32 ; pax_col += 2 )
+                    {
+                    b_sum += *p_img++;
+                    gb_sum += *p_img++;
+                    }
+                p_img += width - 32;
+                for ( int pax_col = 0 ; pax_col < 32 ; pax_col += 2 )
+                    {
+                    gr_sum += *p_img++;
+                    r_sum += *p_img++;
+                    }
+                p_img += width - 32;
+                }
+
+            s->zoneStats(&zone, zoneStart, 32, 32, width);
+
+            ok = ok && ( b_sum == zone.sum[0] ) && ( gb_sum == zone.sum[1] ) &&
+                 ( gr_sum == zone.sum[2] ) && ( r_sum == zone.sum[3] );
+            }
+        }
+
+    free(img);
+
+    return ok;
+}
+
+///The bitwise CRC calcEepromCRC() used before, two zero bytes appended
+static uint16_t referenceCRC(uint8_t *pData, uint32_t nStart, uint32_t nEnd)
+{
+    uint16_t crc = 0x0000;
+    uint32_t tmp;
+
+    for ( uint32_t i = nStart ; i <= nEnd + 2 ; i++ )
+        {
+        tmp = ( i > nEnd ) ? 0 : pData[i];
+
+        for ( int j = 0 ; j < 8 ; j++ )
+            {
+            crc = ( crc & 0x8000 ) ? ( ( crc << 1 ) ^ 0x8005 ) : ( crc << 1 );
+            if ( tmp & 0x80 )
+                {
+                crc ^= 0x0001;
+                }
+            tmp <<= 1;
+            }
+        }
+
+    return crc;
+}
+
+static bool checkCRC()
+{
+    uint8_t eeprom[256];
+    bool ok = true;
+
+    for ( int n = 0 ; n < 64 ; n++ )
+        {
+        for ( size_t i = 0 ; i < sizeof(eeprom) ; i++ )
+            {
+            eeprom[i] = ( 0 == n ) ? 0xFF : ( rand() & 0xFF );
+            }
+
+        ///The two ranges CRCCheck() uses, then random ones
+        ok = ok && ( referenceCRC(eeprom, 0x0, 0x4b) == calcEepromCRC(eeprom, 0x0, 0x4b) );
+        ok = ok && ( referenceCRC(eeprom, 0x10, 0x4b) == calcEepromCRC(eeprom, 0x10, 0x4b) );
+
+        uint32_t start = rand() % 200;
+        uint32_t end = start + rand() % 50;
+        ok = ok && ( referenceCRC(eeprom, start, end) == calcEepromCRC(eeprom, start, end) );
+        }
+
+    return ok;
+}
+
+int main()
+{
+    srand(1);
+
+    testExpect(checkCRC(), "calcEepromCRC");
+
+    for ( size_t i = 0 ; i < sizeof(sImplementations) / sizeof(sImplementations[0]) ; i++ )
+        {
+        const BayerStats *s = BayerStats::get(sImplementations[i]);
+
+        if ( NULL == s )
+            {
+            printf("%s: not supported, skipped\n", sImplementations[i]);
+            continue;
+            }
+
+        for ( size_t w = 0 ; w < sizeof(sWidths) / sizeof(sWidths[0]) ; w++ )
+            {
+            for ( size_t h = 0 ; h < sizeof(sHeights) / sizeof(sHeights[0]) ; h++ )
+                {
+                size_t width = sWidths[w];
+                size_t height = sHeights[h];
+                size_t stride = width + ( ( w + h ) % 3 ? ( rand() % 32 ) : 0 );
+
+                testExpect(checkZone(s, width, height, stride, 10), "%s: zoneStats 10 bit %ux%u stride %u",
+                           s->name, (unsigned int) width, (unsigned int) height, (unsigned int) stride);
+                testExpect(checkZone(s, width, height, stride, 16), "%s: zoneStats 16 bit %ux%u stride %u",
+                           s->name, (unsigned int) width, (unsigned int) height, (unsigned int) stride);
+                testExpect(checkHistogram(s, width, height, stride, 10), "%s: histogram %ux%u stride %u",
+                           s->name, (unsigned int) width, (unsigned int) height, (unsigned int) stride);
+                }
+            }
+
+        testExpect(checkCalibrationZone(s), "%s: calibration zones", s->name);
+
+        printf("%s: done\n", s->name);
+        }
+
+    return testReport();
+}
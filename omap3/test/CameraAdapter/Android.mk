@@ -0,0 +1,65 @@
+ifdef BOARD_USES_TI_CAMERA_HAL
+ifeq ($(TARGET_BOARD_PLATFORM),omap4)
+
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	frameref_bench.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libfakecameraadapter \
+	libcamera \
+	libcamera_client \
+	libtiutils \
+	libbinder \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/camera-omap4/inc \
+	hardware/ti/omap4/omap3/libtiutils \
+	hardware/ti/omap4/omap3/liboverlay \
+	frameworks/base/include/ui \
+	frameworks/base/include/utils \
+	external/icu4c/common
+
+LOCAL_MODULE:= frameref_bench
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2 -DTARGET_OMAP4 -D___ANDROID___
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	camera_pipeline_bench.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libfakecameraadapter \
+	libcamera \
+	libcamera_client \
+	libtiutils \
+	libbinder \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/camera-omap4/inc \
+	hardware/ti/omap4/omap3/libtiutils \
+	hardware/ti/omap4/omap3/liboverlay \
+	frameworks/base/include/ui \
+	frameworks/base/include/utils \
+	external/icu4c/common
+
+LOCAL_MODULE:= camera_pipeline_bench
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2 -DTARGET_OMAP4 -D___ANDROID___
+
+include $(BUILD_EXECUTABLE)
+
+endif
+endif
@@ -0,0 +1,1095 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///End-to-end benchmark of the camera HAL frame pipeline, without any camera
+///hardware.
+///
+///Usage: camera_pipeline_bench [-m preview|record|burst|capture|zsl|all] [-w width]
+///                             [-h height] [-f fps] [-n frames] [-b buffers]
+///                             [-d display_ms] [-e encode_ms] [-c 0|1] [-s shot_frames]
+///                             [-z zsl_depth]
+///
+///A FakeCameraAdapter subclass plays the sensor. It sends frames at the requested
+///rate through BaseCameraAdapter::sendFrameToSubscribers(). The frames then go to
+///the real AppCallbackNotifier, to a stub DisplayAdapter that keeps each frame on
+///screen for display_ms, and, while recording, to a stub encoder that holds video
+///frames for encode_ms. A frame is dropped when the sensor ticks and no buffer has
+///been returned yet.
+///
+///Each frame carries its capture timestamp in its first bytes, so every sink can
+///measure its latency, whether it gets the adapter buffer, a mapping of it or a copy.
+///
+///The capture and zsl modes press the shutter every shot_frames frames, halfway
+///between two sensor frames. capture sends the next sensor frame to JPEG. zsl keeps
+///the last zsl_depth frames in the ZslRing of the adapter and sends the one closest
+///to the shutter press. Both stamp the captured frame with the shutter press time.
+///
+///Prints one CSV row per mode and stage:
+///mode,width,height,fps,frames,dropped,cpu_us_per_frame,csw_per_frame,stage,samples,p50_us,p99_us,max_us
+///
+///Stages:
+///  dispatch    time spent in sendFrameToSubscribers() by the camera thread
+///  callback    capture to the preview callback of the application
+///  display     capture to the display receiving the frame
+///  release     time spent in returnFrame() by the display
+///  encoder     capture to the encoder receiving the video frame
+///  jpeg        capture (burst) or shutter press (capture, zsl) to the compressed
+///              image callback
+///  zsl_offset  distance between the shutter press and the frame taken from the ring
+///  turnaround  capture to the buffer being handed back to the camera
+///
+///csw_per_frame counts the voluntary context switches of the whole process per
+///frame. Threads blocking on contended locks show up there.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#define LOG_TAG "CameraPipelineBench"
+#include <utils/Log.h>
+#include <cutils/atomic.h>
+#include <binder/MemoryHeapBase.h>
+#include <binder/MemoryBase.h>
+
+#include "CameraHal.h"
+#include "FakeCameraAdapter.h"
+
+using namespace android;
+
+#define DEFAULT_WIDTH       640
+#define DEFAULT_HEIGHT      480
+#define DEFAULT_FPS         30
+#define DEFAULT_FRAMES      300
+#define DEFAULT_BUFFERS     6
+#define DEFAULT_DISPLAY_MS  16
+#define DEFAULT_ENCODE_MS   20
+#define DEFAULT_SHOT_FRAMES 10
+#define DEFAULT_ZSL_DEPTH   4
+#define MAX_BUFFERS         16
+#define STAMP_MAGIC         0x43414D46
+#define CMD_FRAME           1
+#define CMD_EXIT            2
+
+enum Mode
+    {
+    MODE_PREVIEW = 0,
+    MODE_RECORD,
+    MODE_BURST,
+    MODE_CAPTURE,
+    MODE_ZSL,
+    MODE_COUNT
+    };
+
+static const char *gModeNames[MODE_COUNT] = { "preview", "record", "burst", "capture", "zsl" };
+
+enum StageId
+    {
+    STAGE_DISPATCH = 0,
+    STAGE_CALLBACK,
+    STAGE_DISPLAY,
+    STAGE_RELEASE,
+    STAGE_ENCODER,
+    STAGE_JPEG,
+    STAGE_TURNAROUND,
+    STAGE_ZSL_OFFSET,
+    STAGE_COUNT
+    };
+
+static const char *gStageNames[STAGE_COUNT] =
+    {
+    "dispatch", "callback", "display", "release", "encoder", "jpeg", "turnaround", "zsl_offset"
+    };
+
+///Latency samples of one stage, recorded from any thread
+struct Stage
+{
+    int64_t *samples;
+    int32_t capacity;
+    volatile int32_t count;
+};
+
+static Stage gStages[STAGE_COUNT];
+
+///Written by the sensor at the start of every frame
+struct FrameStamp
+{
+    int64_t timestamp;
+    uint32_t magic;
+    uint32_t sequence;
+};
+
+struct Config
+{
+    int mode;
+    int width;
+    int height;
+    int fps;
+    unsigned int frames;
+    unsigned int buffers;
+    int64_t displayNs;
+    int64_t encodeNs;
+    bool callbacks;
+    unsigned int shotFrames;
+    unsigned int zslDepth;
+};
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void stageRecord(StageId id, int64_t ns)
+{
+    Stage *stage = &gStages[id];
+    int32_t index = android_atomic_inc(&stage->count);
+
+    if ( index < stage->capacity )
+        {
+        stage->samples[index] = ns;
+        }
+}
+
+///Records the latency since the frame was captured, if the memory carries a stamp
+static void stageRecordStamp(StageId id, const void *frame)
+{
+    const FrameStamp *stamp = ( const FrameStamp * ) frame;
+
+    if ( ( NULL != stamp ) && ( STAMP_MAGIC == stamp->magic ) )
+        {
+        stageRecord(id, now_ns() - stamp->timestamp);
+        }
+}
+
+/*--------------------Stub camera adapter-----------------------------*/
+
+///FakeCameraAdapter driven by the benchmark. Returned buffers are handed back
+///to the sensor loop instead of the fake frame thread.
+class BenchCameraAdapter : public FakeCameraAdapter
+{
+public:
+
+    BenchCameraAdapter() { }
+
+    status_t sendFrame(CameraFrame &frame)
+        {
+        int64_t start = now_ns();
+        status_t ret = sendFrameToSubscribers(&frame);
+
+        stageRecord(STAGE_DISPATCH, now_ns() - start);
+
+        return ret;
+        }
+
+    ///Marks a buffer as held by the preview subscribers ahead of dispatch
+    void holdPreview(void *buffer, int count)
+        {
+        setFrameRefCount(buffer, CameraFrame::PREVIEW_FRAME_SYNC, count);
+        }
+
+    size_t previewSubscribers()
+        {
+        Mutex::Autolock lock(mSubscriberLock);
+        return mFrameSubscribers.size();
+        }
+
+    ///Next free buffer of the given type, NULL if none came back yet
+    void* getFreeBuffer(CameraFrame::FrameType frameType)
+        {
+        MessageQueue &queue = ( CameraFrame::IMAGE_FRAME == frameType ) ? mFreeCaptureQ : mFreePreviewQ;
+        Message msg;
+
+        if ( queue.isEmpty() )
+            {
+            return NULL;
+            }
+
+        queue.get(&msg);
+
+        return msg.arg1;
+        }
+
+    status_t setZslDepth(unsigned int depth)
+        {
+        return mZslRing.setDepth(depth);
+        }
+
+    ///Keeps a capture frame in the ZSL ring, the frame it pushes out becomes free
+    void storeZslFrame(const CameraFrame &frame)
+        {
+        ZslRing::Frame zslFrame;
+        void *evicted = NULL;
+
+        zslFrame.mBuffer = frame.mBuffer;
+        zslFrame.mOffset = frame.mOffset;
+        zslFrame.mLength = frame.mLength;
+        zslFrame.mWidth = frame.mWidth;
+        zslFrame.mHeight = frame.mHeight;
+        zslFrame.mTimestamp = frame.mTimestamp;
+        memset(&zslFrame.mMetadata, 0, sizeof(zslFrame.mMetadata));
+        zslFrame.mMetadata.mConverged = true;
+
+        if ( NO_ERROR != mZslRing.push(zslFrame, evicted) )
+            {
+            evicted = frame.mBuffer;
+            }
+
+        if ( NULL != evicted )
+            {
+            putFreeBuffer(evicted, CameraFrame::IMAGE_FRAME);
+            }
+        }
+
+    ///Takes the frame for a shutter press, the way takePicture() does in ZSL mode
+    status_t getZslCapture(nsecs_t shutter, CameraFrame &frame)
+        {
+        ZslRing::Frame zslFrame;
+        status_t ret;
+
+        ret = mZslRing.select(shutter, zslFrame);
+        if ( NO_ERROR == ret )
+            {
+            frame.mBuffer = zslFrame.mBuffer;
+            frame.mOffset = zslFrame.mOffset;
+            frame.mLength = zslFrame.mLength;
+            frame.mWidth = zslFrame.mWidth;
+            frame.mHeight = zslFrame.mHeight;
+            frame.mTimestamp = zslFrame.mTimestamp;
+            frame.mFrameType = CameraFrame::IMAGE_FRAME;
+            }
+
+        return ret;
+        }
+
+    void flushZslFrames()
+        {
+        ZslRing::Frame frame;
+
+        while ( mZslRing.pop(frame) )
+            {
+            putFreeBuffer(frame.mBuffer, CameraFrame::IMAGE_FRAME);
+            }
+        }
+
+    void putFreeBuffer(void *frameBuf, CameraFrame::FrameType frameType)
+        {
+        Message msg;
+
+        msg.command = CMD_FRAME;
+        msg.arg1 = frameBuf;
+        msg.arg2 = ( void * ) frameType;
+
+        if ( ( CameraFrame::IMAGE_FRAME == frameType ) || ( CameraFrame::RAW_FRAME == frameType ) )
+            {
+            mFreeCaptureQ.put(&msg);
+            }
+        else
+            {
+            mFreePreviewQ.put(&msg);
+            }
+        }
+
+protected:
+
+    virtual status_t fillThisBuffer(void* frameBuf, CameraFrame::FrameType frameType)
+        {
+        stageRecordStamp(STAGE_TURNAROUND, frameBuf);
+        putFreeBuffer(frameBuf, frameType);
+
+        return NO_ERROR;
+        }
+
+private:
+
+    MessageQueue mFreePreviewQ;
+    MessageQueue mFreeCaptureQ;
+    ZslRing mZslRing;
+};
+
+/*--------------------Stub display-----------------------------*/
+
+///Display that keeps the last frame on screen until the next one has been up
+///for display_ms, the way the overlay holds on to queued buffers
+class StubDisplayAdapter : public DisplayAdapter
+{
+public:
+
+    StubDisplayAdapter(int64_t holdNs)
+        : mHoldNs(holdNs), mFrameProvider(NULL), mFd(-1), mOffsets(NULL) { }
+
+    virtual ~StubDisplayAdapter()
+        {
+        Message msg;
+
+        msg.command = CMD_EXIT;
+        mDisplayQ.put(&msg);
+        pthread_join(mThread, NULL);
+
+        delete mFrameProvider;
+        delete [] mOffsets;
+        }
+
+    virtual status_t initialize()
+        {
+        return pthread_create(&mThread, NULL, displayThread, this) ? UNKNOWN_ERROR : NO_ERROR;
+        }
+
+    virtual int setOverlay(const sp<Overlay> &overlay)
+        {
+        return NO_ERROR;
+        }
+
+    virtual int setFrameProvider(FrameNotifier *frameProvider)
+        {
+        mFrameProvider = new FrameProvider(frameProvider, this, frameCallbackRelay);
+        return ( NULL == mFrameProvider ) ? NO_MEMORY : NO_ERROR;
+        }
+
+    virtual status_t setErrorHandler(ErrorNotifier *errorNotifier)
+        {
+        return NO_ERROR;
+        }
+
+    virtual int enableDisplay(struct timeval *refTime = NULL)
+        {
+        return mFrameProvider->enableFrameNotification(CameraFrame::PREVIEW_FRAME_SYNC);
+        }
+
+    virtual int disableDisplay()
+        {
+        return mFrameProvider->disableFrameNotification(CameraFrame::PREVIEW_FRAME_SYNC);
+        }
+
+    virtual status_t pauseDisplay(bool pause)
+        {
+        return NO_ERROR;
+        }
+
+#if PPM_INSTRUMENTATION || PPM_INSTRUMENTATION_ABS
+
+    virtual status_t setSnapshotTimeRef(struct timeval *refTime = NULL)
+        {
+        return NO_ERROR;
+        }
+
+#endif
+
+    virtual int useBuffers(void *bufArr, int num)
+        {
+        return NO_ERROR;
+        }
+
+    virtual bool supportsExternalBuffering()
+        {
+        return false;
+        }
+
+    ///Allocates the preview buffers in one shared heap, like the overlay does
+    virtual void* allocateBuffer(int width, int height, const char* format, int &bytes, int numBufs)
+        {
+        bytes = width * height * 2;
+
+        mHeap = new MemoryHeapBase(bytes * numBufs);
+        if ( ( NULL == mHeap.get() ) || ( NULL == mHeap->getBase() ) )
+            {
+            return NULL;
+            }
+
+        mOffsets = new uint32_t[numBufs];
+        for ( int i = 0 ; i < numBufs ; i++ )
+            {
+            mBuffers[i] = ( int ) mHeap->getBase() + i * bytes;
+            mOffsets[i] = i * bytes;
+            }
+
+        mFd = mHeap->getHeapID();
+
+        return mBuffers;
+        }
+
+    virtual uint32_t * getOffsets()
+        {
+        return mOffsets;
+        }
+
+    virtual int getFd()
+        {
+        return mFd;
+        }
+
+    virtual int freeBuffer(void* buf)
+        {
+        mHeap.clear();
+        return NO_ERROR;
+        }
+
+    void returnFrame(void *frameBuf)
+        {
+        int64_t start = now_ns();
+
+        mFrameProvider->returnFrame(frameBuf, CameraFrame::PREVIEW_FRAME_SYNC);
+        stageRecord(STAGE_RELEASE, now_ns() - start);
+        }
+
+    static void frameCallbackRelay(CameraFrame* caFrame)
+        {
+        StubDisplayAdapter *da = ( StubDisplayAdapter * ) caFrame->mCookie;
+        Message msg;
+
+        stageRecordStamp(STAGE_DISPLAY, caFrame->mBuffer);
+
+        msg.command = CMD_FRAME;
+        msg.arg1 = caFrame->mBuffer;
+        msg.id = now_ns();
+        da->mDisplayQ.put(&msg);
+        }
+
+    static void *displayThread(void *arg)
+        {
+        StubDisplayAdapter *da = ( StubDisplayAdapter * ) arg;
+        void *onScreen = NULL;
+        struct timespec ts;
+        Message msg;
+
+        for ( ;; )
+            {
+            da->mDisplayQ.get(&msg);
+
+            if ( CMD_EXIT == msg.command )
+                {
+                break;
+                }
+
+            ///Flip once the new frame has been queued long enough, then release the old one
+            int64_t flip = msg.id + da->mHoldNs;
+            ts.tv_sec = flip / 1000000000LL;
+            ts.tv_nsec = flip % 1000000000LL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+            if ( NULL != onScreen )
+                {
+                da->returnFrame(onScreen);
+                }
+
+            onScreen = msg.arg1;
+            }
+
+        if ( NULL != onScreen )
+            {
+            da->returnFrame(onScreen);
+            }
+
+        return NULL;
+        }
+
+private:
+
+    int64_t mHoldNs;
+    FrameProvider *mFrameProvider;
+    MessageQueue mDisplayQ;
+    pthread_t mThread;
+    sp<MemoryHeapBase> mHeap;
+    int mBuffers[MAX_BUFFERS];
+    int mFd;
+    uint32_t *mOffsets;
+};
+
+/*--------------------Stub camera service-----------------------------*/
+
+///Only exists so that AppCallbackNotifier can query the enabled messages
+class StubCameraHardware : public CameraHardwareInterface
+{
+public:
+
+    StubCameraHardware() : mMsgEnabled(0) { }
+
+    virtual sp<IMemoryHeap> getPreviewHeap() const { return NULL; }
+    virtual sp<IMemoryHeap> getRawHeap() const { return NULL; }
+    virtual void setCallbacks(notify_callback notify_cb, data_callback data_cb,
+                              data_callback_timestamp data_cb_timestamp, void* user) { }
+    virtual void enableMsgType(int32_t msgType) { android_atomic_or(msgType, &mMsgEnabled); }
+    virtual void disableMsgType(int32_t msgType) { android_atomic_and(~msgType, &mMsgEnabled); }
+    virtual bool msgTypeEnabled(int32_t msgType)
+        {
+        return ( android_atomic_acquire_load(&mMsgEnabled) & msgType ) == msgType;
+        }
+    virtual status_t startPreview() { return NO_ERROR; }
+    virtual bool useOverlay() { return true; }
+    virtual status_t setOverlay(const sp<Overlay> &overlay) { return NO_ERROR; }
+    virtual void stopPreview() { }
+    virtual bool previewEnabled() { return true; }
+    virtual status_t startRecording() { return NO_ERROR; }
+    virtual void stopRecording() { }
+    virtual bool recordingEnabled() { return false; }
+    virtual void releaseRecordingFrame(const sp<IMemory>& mem) { }
+    virtual status_t autoFocus() { return NO_ERROR; }
+    virtual status_t cancelAutoFocus() { return NO_ERROR; }
+    virtual status_t takePicture() { return NO_ERROR; }
+    virtual status_t cancelPicture() { return NO_ERROR; }
+    virtual status_t setParameters(const CameraParameters& params) { return NO_ERROR; }
+    virtual CameraParameters getParameters() const { return CameraParameters(); }
+    virtual status_t sendCommand(int32_t cmd, int32_t arg1, int32_t arg2) { return NO_ERROR; }
+    virtual void release() { }
+    virtual status_t dump(int fd, const Vector<String16>& args) const { return NO_ERROR; }
+
+private:
+
+    volatile int32_t mMsgEnabled;
+};
+
+/*--------------------Stub application and encoder-----------------------------*/
+
+struct Pipeline
+{
+    sp<AppCallbackNotifier> notifier;
+    MessageQueue encoderQ;
+    pthread_t encoderThread;
+    int64_t encodeNs;
+};
+
+static void notifyCallback(int32_t msgType, int32_t ext1, int32_t ext2, void *user)
+{
+}
+
+static void dataCallback(int32_t msgType, const sp<IMemory>& dataPtr, void *user)
+{
+    if ( NULL == dataPtr.get() )
+        {
+        return;
+        }
+
+    if ( CAMERA_MSG_PREVIEW_FRAME == msgType )
+        {
+        stageRecordStamp(STAGE_CALLBACK, dataPtr->pointer());
+        }
+    else if ( CAMERA_MSG_COMPRESSED_IMAGE == msgType )
+        {
+        stageRecordStamp(STAGE_JPEG, dataPtr->pointer());
+        }
+}
+
+///Video frames are queued to the encoder thread, which releases them after encode_ms
+#ifdef OMAP_ENHANCEMENT
+static void dataCallbackTimestamp(nsecs_t timestamp, int32_t msgType, const sp<IMemory>& dataPtr, void *user,
+                                  uint32_t offset, uint32_t stride)
+#else
+static void dataCallbackTimestamp(nsecs_t timestamp, int32_t msgType, const sp<IMemory>& dataPtr, void *user)
+#endif
+{
+    Pipeline *pipeline = ( Pipeline * ) user;
+    Message msg;
+
+    if ( NULL == dataPtr.get() )
+        {
+        return;
+        }
+
+    stageRecordStamp(STAGE_ENCODER, dataPtr->pointer());
+
+    ///The encoder owns a reference until it releases the frame
+    dataPtr->incStrong(pipeline);
+
+    msg.command = CMD_FRAME;
+    msg.arg1 = dataPtr.get();
+    msg.id = now_ns();
+    pipeline->encoderQ.put(&msg);
+}
+
+static void *encoderThread(void *arg)
+{
+    Pipeline *pipeline = ( Pipeline * ) arg;
+    struct timespec ts;
+    Message msg;
+
+    for ( ;; )
+        {
+        pipeline->encoderQ.get(&msg);
+
+        if ( CMD_EXIT == msg.command )
+            {
+            break;
+            }
+
+        int64_t done = msg.id + pipeline->encodeNs;
+        ts.tv_sec = done / 1000000000LL;
+        ts.tv_nsec = done % 1000000000LL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+        IMemory *mem = ( IMemory * ) msg.arg1;
+        pipeline->notifier->releaseRecordingFrame(mem);
+        mem->decStrong(pipeline);
+        }
+
+    return NULL;
+}
+
+/*--------------------Benchmark-----------------------------*/
+
+static int compareLatency(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a;
+    int64_t y = *(const int64_t *) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+///Nearest-rank percentile of a sorted sample
+static int64_t percentile(const int64_t *sorted, unsigned int count, unsigned int pct)
+{
+    unsigned int rank = ( count * pct + 99 ) / 100;
+
+    return sorted[( rank > 0 ) ? ( rank - 1 ) : 0];
+}
+
+static int64_t cpuTimeNs(const struct rusage &usage)
+{
+    return ( (int64_t) usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * 1000000000LL +
+           ( (int64_t) usage.ru_utime.tv_usec + usage.ru_stime.tv_usec ) * 1000LL;
+}
+
+static void stampFrame(void *buffer, uint32_t sequence, int64_t timestamp)
+{
+    FrameStamp *stamp = ( FrameStamp * ) buffer;
+
+    stamp->timestamp = timestamp;
+    stamp->magic = STAMP_MAGIC;
+    stamp->sequence = sequence;
+}
+
+static bool isCaptureMode(int mode)
+{
+    return ( MODE_BURST == mode ) || ( MODE_CAPTURE == mode ) || ( MODE_ZSL == mode );
+}
+
+static int runMode(const Config &config, int mode)
+{
+    BenchCameraAdapter *adapter;
+    sp<StubDisplayAdapter> display;
+    sp<StubCameraHardware> hardware;
+    Pipeline pipeline;
+    CameraParameters params;
+    CameraAdapter::BuffersDescriptor desc;
+    sp<MemoryHeapBase> captureHeap;
+    int captureBuffers[MAX_BUFFERS + ZslRing::MAX_DEPTH];
+    unsigned int captureCount = config.buffers;
+    int64_t shutter = 0;
+    int *previewBuffers;
+    int bytes = 0;
+    unsigned int sent = 0, dropped = 0;
+    struct rusage startUsage, endUsage;
+    struct timespec tick;
+    int64_t period, next;
+    int ret = 0;
+
+    for ( int i = 0 ; i < STAGE_COUNT ; i++ )
+        {
+        gStages[i].count = 0;
+        }
+
+    adapter = new BenchCameraAdapter();
+    if ( ( NULL == adapter ) || ( NO_ERROR != adapter->initialize() ) )
+        {
+        return -ENOMEM;
+        }
+
+    ///Display first: it provides the preview buffers, as in CameraHal
+    display = new StubDisplayAdapter(config.displayNs);
+    display->initialize();
+    display->setFrameProvider(adapter);
+    previewBuffers = ( int * ) display->allocateBuffer(config.width, config.height,
+                                                       CameraParameters::PIXEL_FORMAT_YUV422I,
+                                                       bytes, config.buffers);
+    if ( NULL == previewBuffers )
+        {
+        delete adapter;
+        return -ENOMEM;
+        }
+
+    memset(&desc, 0, sizeof(desc));
+    desc.mBuffers = previewBuffers;
+    desc.mOffsets = display->getOffsets();
+    desc.mFd = display->getFd();
+    desc.mLength = bytes;
+    desc.mCount = config.buffers;
+    adapter->sendCommand(CameraAdapter::CAMERA_USE_BUFFERS, CameraAdapter::CAMERA_PREVIEW, ( int ) &desc);
+
+    for ( unsigned int i = 0 ; i < config.buffers ; i++ )
+        {
+        adapter->putFreeBuffer(( void * ) previewBuffers[i], CameraFrame::PREVIEW_FRAME_SYNC);
+        }
+
+    if ( isCaptureMode(mode) )
+        {
+        ///The ring holds zsl_depth buffers on top of the ones in flight
+        if ( MODE_ZSL == mode )
+            {
+            captureCount += config.zslDepth;
+            adapter->setZslDepth(config.zslDepth);
+            }
+
+        captureHeap = new MemoryHeapBase(bytes * captureCount);
+        for ( unsigned int i = 0 ; i < captureCount ; i++ )
+            {
+            captureBuffers[i] = ( int ) captureHeap->getBase() + i * bytes;
+            adapter->putFreeBuffer(( void * ) captureBuffers[i], CameraFrame::IMAGE_FRAME);
+            }
+
+        desc.mBuffers = captureBuffers;
+        desc.mOffsets = NULL;
+        desc.mFd = -1;
+        desc.mCount = captureCount;
+        adapter->sendCommand(CameraAdapter::CAMERA_USE_BUFFERS, CameraAdapter::CAMERA_IMAGE_CAPTURE, ( int ) &desc);
+        }
+
+    ///Application side: notifier, stub service and encoder
+    hardware = new StubCameraHardware();
+    if ( config.callbacks )
+        {
+        hardware->enableMsgType(CAMERA_MSG_PREVIEW_FRAME);
+        }
+    if ( MODE_RECORD == mode )
+        {
+        hardware->enableMsgType(CAMERA_MSG_VIDEO_FRAME);
+        }
+    if ( isCaptureMode(mode) )
+        {
+        hardware->enableMsgType(CAMERA_MSG_COMPRESSED_IMAGE);
+        }
+
+    pipeline.encodeNs = config.encodeNs;
+    pipeline.notifier = new AppCallbackNotifier();
+    pipeline.notifier->initialize();
+    pipeline.notifier->setEventProvider(CameraHalEvent::ALL_EVENTS, adapter);
+    pipeline.notifier->setFrameProvider(adapter);
+    pipeline.notifier->setCallbacks(hardware.get(), notifyCallback, dataCallback, dataCallbackTimestamp, &pipeline);
+    pipeline.notifier->start();
+    pthread_create(&pipeline.encoderThread, NULL, encoderThread, &pipeline);
+
+    params.setPreviewSize(config.width, config.height);
+    params.setPreviewFormat(CameraParameters::PIXEL_FORMAT_YUV422I);
+    pipeline.notifier->startPreviewCallbacks(params, previewBuffers, display->getOffsets(), display->getFd(),
+                                             bytes, config.buffers);
+    display->enableDisplay();
+
+    if ( MODE_RECORD == mode )
+        {
+        pipeline.notifier->initSharedVideoBuffers(previewBuffers, display->getOffsets(), display->getFd(),
+                                                  bytes, config.buffers);
+        pipeline.notifier->startRecording();
+        adapter->sendCommand(CameraAdapter::CAMERA_START_VIDEO);
+        }
+
+    getrusage(RUSAGE_SELF, &startUsage);
+
+    ///Sensor loop, one frame per period
+    period = 1000000000LL / config.fps;
+    next = now_ns();
+
+    for ( unsigned int i = 0 ; i < config.frames ; i++ )
+        {
+        CameraFrame frame;
+        void *buffer;
+
+        next += period;
+        tick.tv_sec = next / 1000000000LL;
+        tick.tv_nsec = next % 1000000000LL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tick, NULL);
+
+        buffer = adapter->getFreeBuffer(CameraFrame::PREVIEW_FRAME_SYNC);
+        if ( NULL == buffer )
+            {
+            dropped++;
+            continue;
+            }
+
+        stampFrame(buffer, i, now_ns());
+
+        frame.mBuffer = buffer;
+        frame.mAlignment = config.width * 2;
+        frame.mWidth = config.width;
+        frame.mHeight = config.height;
+        frame.mLength = bytes;
+        frame.mOffset = 0;
+        frame.mTimestamp = now_ns();
+
+        if ( MODE_RECORD == mode )
+            {
+            ///Video goes out first, as the OMX adapter does. Keep the buffer from
+            ///being refilled if the encoder is done before the preview is sent
+            adapter->holdPreview(buffer, adapter->previewSubscribers());
+            frame.mFrameType = CameraFrame::VIDEO_FRAME_SYNC;
+            adapter->sendFrame(frame);
+            }
+
+        frame.mFrameType = CameraFrame::PREVIEW_FRAME_SYNC;
+        adapter->sendFrame(frame);
+
+        if ( MODE_BURST == mode )
+            {
+            buffer = adapter->getFreeBuffer(CameraFrame::IMAGE_FRAME);
+            if ( NULL == buffer )
+                {
+                dropped++;
+                }
+            else
+                {
+                stampFrame(buffer, i, now_ns());
+                frame.mBuffer = buffer;
+                frame.mFrameType = CameraFrame::IMAGE_FRAME;
+                adapter->sendFrame(frame);
+                }
+            }
+        else if ( ( MODE_CAPTURE == mode ) && ( 0 != shutter ) )
+            {
+            ///No ring: the first frame exposed after the shutter press is captured
+            buffer = adapter->getFreeBuffer(CameraFrame::IMAGE_FRAME);
+            if ( NULL == buffer )
+                {
+                dropped++;
+                }
+            else
+                {
+                stampFrame(buffer, i, shutter);
+                frame.mBuffer = buffer;
+                frame.mFrameType = CameraFrame::IMAGE_FRAME;
+                adapter->sendFrame(frame);
+                }
+
+            shutter = 0;
+            }
+        else if ( MODE_ZSL == mode )
+            {
+            buffer = adapter->getFreeBuffer(CameraFrame::IMAGE_FRAME);
+            if ( NULL == buffer )
+                {
+                dropped++;
+                }
+            else
+                {
+                stampFrame(buffer, i, frame.mTimestamp);
+                frame.mBuffer = buffer;
+                adapter->storeZslFrame(frame);
+                }
+            }
+
+        sent++;
+
+        ///Shutter press halfway to the next sensor frame
+        if ( ( ( MODE_CAPTURE == mode ) || ( MODE_ZSL == mode ) ) &&
+             ( ( config.shotFrames / 2 ) == ( i % config.shotFrames ) ) )
+            {
+            shutter = next + period / 2;
+            tick.tv_sec = shutter / 1000000000LL;
+            tick.tv_nsec = shutter % 1000000000LL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tick, NULL);
+
+            if ( ( MODE_ZSL == mode ) && ( NO_ERROR == adapter->getZslCapture(shutter, frame) ) )
+                {
+                int64_t offset = frame.mTimestamp - shutter;
+
+                stageRecord(STAGE_ZSL_OFFSET, ( 0 > offset ) ? -offset : offset);
+                stampFrame(frame.mBuffer, i, shutter);
+                adapter->sendFrame(frame);
+                shutter = 0;
+                }
+            }
+        }
+
+    getrusage(RUSAGE_SELF, &endUsage);
+
+    ///Tear down in the same order as CameraHal
+    if ( MODE_RECORD == mode )
+        {
+        adapter->sendCommand(CameraAdapter::CAMERA_STOP_VIDEO);
+        pipeline.notifier->stopRecording();
+        }
+
+    display->disableDisplay();
+    adapter->flushZslFrames();
+    pipeline.notifier->stopPreviewCallbacks();
+    pipeline.notifier->stop();
+
+    {
+    Message msg;
+
+    msg.command = CMD_EXIT;
+    pipeline.encoderQ.put(&msg);
+    pthread_join(pipeline.encoderThread, NULL);
+    }
+
+    for ( int i = 0 ; i < STAGE_COUNT ; i++ )
+        {
+        Stage *stage = &gStages[i];
+        unsigned int samples = android_atomic_acquire_load(&stage->count);
+
+        if ( samples > ( unsigned int ) stage->capacity )
+            {
+            samples = stage->capacity;
+            }
+
+        if ( 0 == samples )
+            {
+            continue;
+            }
+
+        qsort(stage->samples, samples, sizeof(*stage->samples), compareLatency);
+
+        printf("%s,%d,%d,%d,%u,%u,%.1f,%.2f,%s,%u,%.1f,%.1f,%.1f\n",
+               gModeNames[mode], config.width, config.height, config.fps, sent, dropped,
+               ( sent > 0 ) ? ( ( cpuTimeNs(endUsage) - cpuTimeNs(startUsage) ) / 1000.0 / sent ) : 0.0,
+               ( sent > 0 ) ? ( (double) ( endUsage.ru_nvcsw - startUsage.ru_nvcsw ) / sent ) : 0.0,
+               gStageNames[i], samples,
+               percentile(stage->samples, samples, 50) / 1000.0,
+               percentile(stage->samples, samples, 99) / 1000.0,
+               stage->samples[samples - 1] / 1000.0);
+        }
+
+    pipeline.notifier.clear();
+    display.clear();
+    delete adapter;
+
+    return ret;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-m preview|record|burst|capture|zsl|all] [-w width] [-h height]\n"
+                    "          [-f fps] [-n frames] [-b buffers] [-d display_ms] [-e encode_ms]\n"
+                    "          [-c 0|1] [-s shot_frames] [-z zsl_depth]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    Config config;
+    int first = MODE_PREVIEW, last = MODE_COUNT - 1;
+    int opt, ret = 0;
+
+    config.mode = -1;
+    config.width = DEFAULT_WIDTH;
+    config.height = DEFAULT_HEIGHT;
+    config.fps = DEFAULT_FPS;
+    config.frames = DEFAULT_FRAMES;
+    config.buffers = DEFAULT_BUFFERS;
+    config.displayNs = DEFAULT_DISPLAY_MS * 1000000LL;
+    config.encodeNs = DEFAULT_ENCODE_MS * 1000000LL;
+    config.callbacks = true;
+    config.shotFrames = DEFAULT_SHOT_FRAMES;
+    config.zslDepth = DEFAULT_ZSL_DEPTH;
+
+    while ( -1 != ( opt = getopt(argc, argv, "m:w:h:f:n:b:d:e:c:s:z:") ) )
+        {
+        switch ( opt )
+            {
+            case 'm':
+                for ( int i = 0 ; i < MODE_COUNT ; i++ )
+                    {
+                    if ( 0 == strcmp(optarg, gModeNames[i]) )
+                        {
+                        config.mode = i;
+                        }
+                    }
+                if ( ( -1 == config.mode ) && ( 0 != strcmp(optarg, "all") ) )
+                    {
+                    usage(argv[0]);
+                    return 1;
+                    }
+                break;
+            case 'w':
+                config.width = atoi(optarg);
+                break;
+            case 'h':
+                config.height = atoi(optarg);
+                break;
+            case 'f':
+                config.fps = atoi(optarg);
+                break;
+            case 'n':
+                config.frames = strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                config.buffers = strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                config.displayNs = atoi(optarg) * 1000000LL;
+                break;
+            case 'e':
+                config.encodeNs = atoi(optarg) * 1000000LL;
+                break;
+            case 'c':
+                config.callbacks = ( 0 != atoi(optarg) );
+                break;
+            case 's':
+                config.shotFrames = strtoul(optarg, NULL, 0);
+                break;
+            case 'z':
+                config.zslDepth = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+            }
+        }
+
+    if ( ( 0 >= config.width ) || ( 0 >= config.height ) || ( 0 >= config.fps ) ||
+         ( 0 == config.frames ) || ( 2 > config.buffers ) || ( MAX_BUFFERS < config.buffers ) ||
+         ( 0 == config.shotFrames ) || ( 0 == config.zslDepth ) || ( ZslRing::MAX_DEPTH < config.zslDepth ) )
+        {
+        usage(argv[0]);
+        return 1;
+        }
+
+    if ( -1 != config.mode )
+        {
+        first = last = config.mode;
+        }
+
+    ///Every frame visits each stage at most twice (preview and video or capture)
+    for ( int i = 0 ; i < STAGE_COUNT ; i++ )
+        {
+        gStages[i].capacity = config.frames * 2;
+        gStages[i].samples = (int64_t *) malloc(gStages[i].capacity * sizeof(int64_t));
+        if ( NULL == gStages[i].samples )
+            {
+            return 1;
+            }
+        }
+
+    printf("mode,width,height,fps,frames,dropped,cpu_us_per_frame,csw_per_frame,stage,samples,p50_us,p99_us,max_us\n");
+
+    for ( int mode = first ; mode <= last ; mode++ )
+        {
+        ret |= runMode(config, mode);
+        }
+
+    for ( int i = 0 ; i < STAGE_COUNT ; i++ )
+        {
+        free(gStages[i].samples);
+        }
+
+    return ret ? 1 : 0;
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Frame reference counting benchmark of BaseCameraAdapter, driven through
+///FakeCameraAdapter.
+///
+///Usage: frameref_bench [frames]
+///
+///The main thread plays the camera: it sends preview (and while recording,
+///video) frames to the subscribers as soon as a buffer is handed back through
+///fillThisBuffer(). Each subscriber releases its frames from its own thread,
+///so returnFrame() is called concurrently for the same buffers.
+///
+///Prints one CSV row per case and subscriber count:
+///case,subscribers,frames,frames_per_sec,p50_ns,p99_ns,max_ns
+///
+///Latencies are the time spent inside returnFrame(), which used to be the hold
+///time of the adapter wide return lock.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define LOG_TAG "FrameRefBench"
+#include <utils/Log.h>
+#include <cutils/atomic.h>
+
+#include "FakeCameraAdapter.h"
+
+using namespace android;
+
+#define DEFAULT_FRAMES      20000
+#define BUFFER_COUNT        8
+#define MAX_SUBSCRIBERS     4
+#define CMD_FRAME           1
+#define CMD_EXIT            2
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+///FakeCameraAdapter whose buffers come back to the benchmark instead of its frame thread
+class BenchCameraAdapter : public FakeCameraAdapter
+{
+public:
+
+    BenchCameraAdapter() : mReturned(0) { }
+
+    status_t sendFrame(void *buffer, CameraFrame::FrameType frameType)
+        {
+        CameraFrame frame;
+
+        frame.mBuffer = buffer;
+        frame.mFrameType = frameType;
+        frame.mTimestamp = now_ns();
+
+        return sendFrameToSubscribers(&frame);
+        }
+
+    ///Marks a buffer as held by count preview subscribers ahead of dispatch
+    void holdPreview(void *buffer, int count)
+        {
+        setFrameRefCount(buffer, CameraFrame::PREVIEW_FRAME_SYNC, count);
+        }
+
+    status_t startRecording()
+        {
+        return startVideoCapture();
+        }
+
+    status_t stopRecording()
+        {
+        return stopVideoCapture();
+        }
+
+    MessageQueue mFreeQ;
+    volatile int32_t mReturned;
+
+protected:
+
+    virtual status_t fillThisBuffer(void* frameBuf, CameraFrame::FrameType frameType)
+        {
+        Message msg;
+
+        ///Count first, so a waiter seeing less than expected always has a put coming
+        android_atomic_inc(&mReturned);
+
+        msg.command = CMD_FRAME;
+        msg.arg1 = frameBuf;
+        msg.arg2 = ( void * ) frameType;
+        mFreeQ.put(&msg);
+
+        return NO_ERROR;
+        }
+};
+
+struct Subscriber
+{
+    BenchCameraAdapter *adapter;
+    MessageQueue queue;
+    int64_t *latency;
+    unsigned int count;
+    pthread_t thread;
+};
+
+///Subscriber callback, runs in the camera thread: hand the frame over to the subscriber thread
+static void frameCallback(CameraFrame *frame)
+{
+    Subscriber *sub = (Subscriber *) frame->mCookie;
+    Message msg;
+
+    msg.command = CMD_FRAME;
+    msg.arg1 = frame->mBuffer;
+    msg.arg2 = ( void * ) frame->mFrameType;
+    sub->queue.put(&msg);
+}
+
+static void *subscriberThread(void *arg)
+{
+    Subscriber *sub = (Subscriber *) arg;
+    Message msg;
+    int64_t start;
+
+    for ( ;; )
+        {
+        if ( NO_ERROR != sub->queue.get(&msg) )
+            {
+            break;
+            }
+
+        if ( CMD_EXIT == msg.command )
+            {
+            break;
+            }
+
+        start = now_ns();
+        sub->adapter->returnFrame(msg.arg1, ( CameraFrame::FrameType ) ( int ) msg.arg2);
+        sub->latency[sub->count++] = now_ns() - start;
+        }
+
+    return NULL;
+}
+
+static int compareLatency(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a;
+    int64_t y = *(const int64_t *) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+///Nearest-rank percentile of a sorted sample
+static int64_t percentile(const int64_t *sorted, unsigned int count, unsigned int pct)
+{
+    unsigned int rank = ( count * pct + 99 ) / 100;
+
+    return sorted[( rank > 0 ) ? ( rank - 1 ) : 0];
+}
+
+static int runCase(const char *name, unsigned int subscribers, unsigned int frames, bool recording)
+{
+    BenchCameraAdapter *adapter;
+    Subscriber sub[MAX_SUBSCRIBERS * 2];
+    unsigned int threads = recording ? ( subscribers * 2 ) : subscribers;
+    int buffers[BUFFER_COUNT];
+    CameraAdapter::BuffersDescriptor desc;
+    int64_t *latency;
+    unsigned int samples = 0;
+    int64_t start, elapsed;
+    Message msg;
+    int ret = 0;
+
+    adapter = new BenchCameraAdapter();
+    if ( ( NULL == adapter ) || ( NO_ERROR != adapter->initialize() ) )
+        {
+        return -ENOMEM;
+        }
+
+    latency = (int64_t *) malloc(frames * threads * sizeof(*latency));
+    if ( NULL == latency )
+        {
+        delete adapter;
+        return -ENOMEM;
+        }
+
+    ///The buffers are never touched, any distinct addresses will do
+    for ( int i = 0 ; i < BUFFER_COUNT ; i++ )
+        {
+        buffers[i] = ( int ) &buffers[i];
+        }
+
+    memset(&desc, 0, sizeof(desc));
+    desc.mBuffers = buffers;
+    desc.mCount = BUFFER_COUNT;
+    adapter->sendCommand(CameraAdapter::CAMERA_USE_BUFFERS, CameraAdapter::CAMERA_PREVIEW, ( int ) &desc);
+
+    for ( unsigned int i = 0 ; i < threads ; i++ )
+        {
+        sub[i].adapter = adapter;
+        sub[i].latency = latency + i * frames;
+        sub[i].count = 0;
+        adapter->enableMsgType(( i < subscribers ) ? CameraFrame::PREVIEW_FRAME_SYNC : CameraFrame::VIDEO_FRAME_SYNC,
+                               frameCallback, NULL, &sub[i]);
+        pthread_create(&sub[i].thread, NULL, subscriberThread, &sub[i]);
+        }
+
+    if ( recording )
+        {
+        adapter->startRecording();
+        }
+
+    start = now_ns();
+
+    ///Every buffer starts out free
+    for ( unsigned int i = 0 ; i < frames ; i++ )
+        {
+        void *buffer;
+
+        if ( i < BUFFER_COUNT )
+            {
+            buffer = ( void * ) buffers[i];
+            }
+        else
+            {
+            adapter->mFreeQ.get(&msg);
+            buffer = msg.arg1;
+            }
+
+        if ( recording )
+            {
+            ///The video frame goes out first, keep the buffer from being refilled
+            ///when the video subscribers are done before the preview frame is sent
+            adapter->holdPreview(buffer, subscribers);
+            adapter->sendFrame(buffer, CameraFrame::VIDEO_FRAME_SYNC);
+            }
+
+        adapter->sendFrame(buffer, CameraFrame::PREVIEW_FRAME_SYNC);
+        }
+
+    ///Wait for the frames still in flight
+    while ( android_atomic_acquire_load(&adapter->mReturned) < ( int32_t ) frames )
+        {
+        adapter->mFreeQ.get(&msg);
+        }
+
+    elapsed = now_ns() - start;
+
+    if ( recording )
+        {
+        adapter->stopRecording();
+        }
+
+    for ( unsigned int i = 0 ; i < threads ; i++ )
+        {
+        msg.command = CMD_EXIT;
+        sub[i].queue.put(&msg);
+        pthread_join(sub[i].thread, NULL);
+        adapter->disableMsgType(( i < subscribers ) ? CameraFrame::PREVIEW_FRAME_SYNC : CameraFrame::VIDEO_FRAME_SYNC,
+                                &sub[i]);
+
+        ///Pack the samples of all subscribers together
+        memmove(latency + samples, sub[i].latency, sub[i].count * sizeof(*latency));
+        samples += sub[i].count;
+        }
+
+    if ( 0 == samples )
+        {
+        ret = -EIO;
+        }
+    else
+        {
+        qsort(latency, samples, sizeof(*latency), compareLatency);
+
+        printf("%s,%u,%u,%.0f,%lld,%lld,%lld\n", name, threads, frames,
+               ( elapsed > 0 ) ? ( frames * 1e9 / elapsed ) : 0.0,
+               (long long) percentile(latency, samples, 50),
+               (long long) percentile(latency, samples, 99),
+               (long long) latency[samples - 1]);
+        }
+
+    free(latency);
+    delete adapter;
+
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int frames = DEFAULT_FRAMES;
+    int ret = 0;
+
+    if ( 1 < argc )
+        {
+        frames = strtoul(argv[1], NULL, 0);
+        if ( frames < BUFFER_COUNT )
+            {
+            fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    printf("case,subscribers,frames,frames_per_sec,p50_ns,p99_ns,max_ns\n");
+
+    for ( unsigned int subscribers = 1 ; subscribers <= MAX_SUBSCRIBERS ; subscribers *= 2 )
+        {
+        ret |= runCase("preview", subscribers, frames, false);
+        ret |= runCase("recording", subscribers, frames, true);
+        }
+
+    return ret ? 1 : 0;
+}
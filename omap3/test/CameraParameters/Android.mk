@@ -0,0 +1,30 @@
+ifdef BOARD_USES_TI_CAMERA_HAL
+ifeq ($(TARGET_BOARD_PLATFORM),omap4)
+
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	param_bench.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libcamera \
+	libcamera_client \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/camera-omap4/inc \
+	external/libxml2/include \
+	external/icu4c/common
+
+LOCAL_MODULE:= param_bench
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2 -DTARGET_OMAP4
+
+include $(BUILD_EXECUTABLE)
+
+endif
+endif
@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Parameter validation benchmark of the checks done by CameraHal::setParameters()
+///
+///Usage: param_bench [calls]
+///
+///Every call validates the enumerated keys of a typical application parameter
+///string against the supported values of the camera, the way setParameters()
+///does. The applications mostly send the same string again with one or two
+///keys changed (zoom, focus area, GPS), which the workload reproduces.
+///
+///Cases:
+///  strstr    - substring search in the supported list, the former validation
+///  valueset  - lookup in the CameraProperties::ValueSet of the supported list
+///  diff      - values equal to the applied ones are skipped, the rest looked up
+///
+///Prints one CSV row per case:
+///case,calls,lookups_per_call,ns_per_call,p50_ns,p99_ns,max_ns,rejected
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOG_TAG "ParamBench"
+#include <utils/Log.h>
+#include <camera/CameraParameters.h>
+
+#include "CameraProperties.h"
+#include "TICameraParameters.h"
+
+using namespace android;
+
+#define DEFAULT_CALLS       20000
+#define PARAM_BUFFER        64
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+///Supported values as reported by the OMX capabilities of the primary camera
+struct Capability
+{
+    const char *key;
+    const char *supported;
+    bool resolution;
+};
+
+static const Capability gCapabilities[] = {
+    { CameraParameters::KEY_PREVIEW_FORMAT, "yuv420sp,yuv422i-yuyv,rgb565", false },
+    { CameraParameters::KEY_PREVIEW_SIZE,
+      "1280x720,864x480,848x480,800x480,720x576,720x480,768x576,640x480,352x288,320x240,240x160,176x144,128x96", true },
+    { CameraParameters::KEY_PICTURE_FORMAT, "jpeg,yuv422i-yuyv,yuv420sp,raw,jps,mpo,raw+jpeg,raw+mpo", false },
+    { CameraParameters::KEY_PICTURE_SIZE,
+      "3264x2448,2592x1944,2048x1536,1600x1200,1280x1024,1152x864,1280x960,640x480,320x240", true },
+    { CameraParameters::KEY_PREVIEW_FRAME_RATE, "33,30,24,20,15,10,5", false },
+    { TICameraParameters::KEY_EXPOSURE_MODE,
+      "off,auto,night,backlighting,spotlight,sports,snow,beach,aperture,small-aperture,face-priority", false },
+    { CameraParameters::KEY_WHITE_BALANCE,
+      "auto,daylight,cloudy-daylight,tungsten,fluorescent,incandescent,horizon,sunset,shade,twilight,warm-fluorescent", false },
+    { CameraParameters::KEY_ANTIBANDING, "off,auto,50hz,60hz", false },
+    { TICameraParameters::KEY_ISO, "auto,100,200,400,800,1000,1200,1600", false },
+    { CameraParameters::KEY_FOCUS_MODE, "auto,infinity,macro,fixed,edof,continuous-video,portrait,extended,caf,face-priority", false },
+    { CameraParameters::KEY_SCENE_MODE,
+      "auto,portrait,landscape,night,night-portrait,fireworks,sports,snow,beach,sunset,party,candlelight,steadyphoto,theatre,action", false },
+    { CameraParameters::KEY_FLASH_MODE, "off,on,auto,torch,red-eye", false },
+    { CameraParameters::KEY_EFFECT, "none,mono,negative,solarize,sepia,whiteboard,blackboard,aqua,posterize,vivid", false },
+};
+
+#define CAPABILITY_COUNT ( sizeof(gCapabilities) / sizeof(gCapabilities[0]) )
+
+///Parameters of a camera application in preview, as passed to setParameters()
+static const char gAppParameters[] =
+    "preview-format=yuv420sp;preview-size=640x480;preview-frame-rate=30;preview-fps-range=15000,30000;"
+    "picture-format=jpeg;picture-size=2592x1944;jpeg-quality=95;jpeg-thumbnail-width=320;"
+    "jpeg-thumbnail-height=240;jpeg-thumbnail-quality=60;exposure=auto;whitebalance=auto;antibanding=auto;"
+    "iso=auto;focus-mode=auto;scene-mode=auto;flash-mode=auto;effect=none;zoom=0;rotation=0;"
+    "exposure-compensation=0;contrast=100;sharpness=100;saturation=100;brightness=50;"
+    "touch-focus=1000,1000;gbce=disable;glbce=disable;mode=high-quality";
+
+///Former CameraHal::isParameterValid()/isResolutionValid()
+static bool legacyValid(const Capability &cap, const char *value)
+{
+    char tmpBuffer[PARAM_BUFFER];
+    int w, h;
+
+    if ( NULL == value )
+        {
+        return false;
+        }
+
+    if ( cap.resolution && ( 2 == sscanf(value, "%dx%d", &w, &h) ) )
+        {
+        snprintf(tmpBuffer, sizeof(tmpBuffer), "%dx%d", w, h);
+        value = tmpBuffer;
+        }
+
+    return ( NULL != strstr(cap.supported, value) );
+}
+
+static bool valueSetValid(const CameraProperties::CameraProperty *prop, const Capability &cap, const char *value)
+{
+    char tmpBuffer[PARAM_BUFFER];
+    int w, h;
+
+    if ( NULL == value )
+        {
+        return false;
+        }
+
+    if ( cap.resolution && ( 2 == sscanf(value, "%dx%d", &w, &h) ) )
+        {
+        snprintf(tmpBuffer, sizeof(tmpBuffer), "%dx%d", w, h);
+        value = tmpBuffer;
+        }
+
+    return prop->mValueSet.contains(value);
+}
+
+///Same check as CameraHal::isParameterUnchanged()
+static bool unchanged(const CameraParameters &params, const CameraParameters &applied, const char *key)
+{
+    const char *newValue = params.get(key);
+    const char *oldValue = applied.get(key);
+
+    if ( ( NULL == newValue ) || ( NULL == oldValue ) )
+        {
+        return false;
+        }
+
+    return ( 0 == strcmp(newValue, oldValue) );
+}
+
+///Returns the parameters the application sends on call i
+static void appParameters(CameraParameters &params, unsigned int i)
+{
+    static const char *whiteBalance[] = { "auto", "daylight", "cloudy-daylight", "fluorescent" };
+    char tmp[32];
+
+    ///Zoom and touch focus follow the user, a mode switch now and then
+    snprintf(tmp, sizeof(tmp), "%u", i % 60);
+    params.set(CameraParameters::KEY_ZOOM, tmp);
+    snprintf(tmp, sizeof(tmp), "%u,%u", 100 + ( i * 7 ) % 1800, 100 + ( i * 13 ) % 1800);
+    params.set(TICameraParameters::KEY_TOUCH_FOCUS_POS, tmp);
+
+    if ( 0 == ( i % 16 ) )
+        {
+        params.set(CameraParameters::KEY_WHITE_BALANCE, whiteBalance[( i / 16 ) % 4]);
+        }
+}
+
+enum Case
+{
+    CASE_STRSTR,
+    CASE_VALUESET,
+    CASE_DIFF,
+};
+
+static int compareLatency(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a;
+    int64_t y = *(const int64_t *) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+///Nearest-rank percentile of a sorted sample
+static int64_t percentile(const int64_t *sorted, unsigned int count, unsigned int pct)
+{
+    unsigned int rank = ( count * pct + 99 ) / 100;
+
+    return sorted[( rank > 0 ) ? ( rank - 1 ) : 0];
+}
+
+static int runCase(const char *name, Case benchCase, CameraProperties::CameraProperty **props, unsigned int calls)
+{
+    CameraParameters params, applied;
+    int64_t *latency;
+    int64_t start, total = 0;
+    unsigned int lookups = 0;
+    unsigned int rejected = 0;
+
+    latency = (int64_t *) malloc(calls * sizeof(*latency));
+    if ( NULL == latency )
+        {
+        return -ENOMEM;
+        }
+
+    params.unflatten(String8(gAppParameters));
+    applied.unflatten(String8(gAppParameters));
+
+    for ( unsigned int i = 0 ; i < calls ; i++ )
+        {
+        appParameters(params, i);
+
+        start = now_ns();
+
+        for ( unsigned int j = 0 ; j < CAPABILITY_COUNT ; j++ )
+            {
+            const char *value = params.get(gCapabilities[j].key);
+            bool valid;
+
+            if ( CASE_STRSTR == benchCase )
+                {
+                valid = legacyValid(gCapabilities[j], value);
+                lookups++;
+                }
+            else if ( ( CASE_DIFF == benchCase ) && unchanged(params, applied, gCapabilities[j].key) )
+                {
+                valid = true;
+                }
+            else
+                {
+                valid = valueSetValid(props[j], gCapabilities[j], value);
+                lookups++;
+                }
+
+            if ( !valid )
+                {
+                rejected++;
+                }
+            else if ( CASE_DIFF == benchCase )
+                {
+                applied.set(gCapabilities[j].key, value);
+                }
+            }
+
+        latency[i] = now_ns() - start;
+        total += latency[i];
+        }
+
+    qsort(latency, calls, sizeof(*latency), compareLatency);
+
+    printf("%s,%u,%.2f,%lld,%lld,%lld,%lld,%u\n", name, calls, ( double ) lookups / calls,
+           (long long) ( total / calls ),
+           (long long) percentile(latency, calls, 50),
+           (long long) percentile(latency, calls, 99),
+           (long long) latency[calls - 1],
+           rejected);
+
+    free(latency);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    CameraProperties::CameraProperty *props[CAPABILITY_COUNT];
+    unsigned int calls = DEFAULT_CALLS;
+    int ret = 0;
+
+    if ( 1 < argc )
+        {
+        calls = strtoul(argv[1], NULL, 0);
+        if ( 0 == calls )
+            {
+            fprintf(stderr, "usage: %s [calls]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    for ( unsigned int i = 0 ; i < CAPABILITY_COUNT ; i++ )
+        {
+        props[i] = new CameraProperties::CameraProperty(gCapabilities[i].key, gCapabilities[i].supported);
+        }
+
+    printf("case,calls,lookups_per_call,ns_per_call,p50_ns,p99_ns,max_ns,rejected\n");
+
+    ret |= runCase("strstr", CASE_STRSTR, props, calls);
+    ret |= runCase("valueset", CASE_VALUESET, props, calls);
+    ret |= runCase("diff", CASE_DIFF, props, calls);
+
+    for ( unsigned int i = 0 ; i < CAPABILITY_COUNT ; i++ )
+        {
+        delete props[i];
+        }
+
+    return ret ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+ifdef BOARD_USES_TI_CAMERA_HAL
+ifeq ($(TARGET_BOARD_PLATFORM),omap3)
+ifdef HARDWARE_OMX
+
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	exiftemplate_test.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libtiutils \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/libtiutils \
+	external/libexif \
+	hardware/ti/omap4/omap3/test
+
+LOCAL_STATIC_LIBRARIES:= \
+	libexifgnu
+
+LOCAL_MODULE:= exiftemplate_test
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	exiftemplate_bench.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libtiutils \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/libtiutils \
+	external/libexif
+
+LOCAL_STATIC_LIBRARIES:= \
+	libexifgnu
+
+LOCAL_MODULE:= exiftemplate_bench
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2
+
+include $(BUILD_EXECUTABLE)
+
+endif
+endif
+endif
@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Per capture cost of the APP1 payload: the libtiutils EXIF template against
+///building the same tags with libexif, as get_exif_buffer() of camera-omap3
+///used to do for every shot.
+///
+///Usage: exiftemplate_bench [iterations]
+///
+///Prints one CSV row per case and implementation:
+///case,impl,iterations,us_per_capture,bytes
+///
+///Cases:
+///  plain      no GPS fix, thumbnail left to the encoder
+///  gps        with a GPS fix
+///  thumbnail  with a GPS fix and a 6KB thumbnail
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libexif/exif-data.h>
+
+#include "ExifTemplate.h"
+
+using namespace android;
+
+#define DEFAULT_ITERATIONS  10000
+#define BUFFER_SIZE         ( 64 * 1024 )
+#define THUMBNAIL_SIZE      6000
+
+enum
+{
+    CASE_PLAIN = 0,
+    CASE_GPS,
+    CASE_THUMBNAIL,
+    CASE_COUNT
+};
+
+static const char *sCaseNames[CASE_COUNT] = { "plain", "gps", "thumbnail" };
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void setEntry(ExifData *ed, ExifIfd ifd, int tag, ExifFormat format, unsigned int components,
+                     const void *data)
+{
+    ExifEntry *entry = exif_entry_new();
+
+    exif_content_add_entry(ed->ifd[ifd], entry);
+    entry->tag = (ExifTag) tag;
+    entry->format = format;
+    entry->components = components;
+    entry->size = exif_format_get_size(format) * components;
+    entry->data = (unsigned char *) malloc(entry->size);
+    memcpy(entry->data, data, entry->size);
+    exif_entry_unref(entry);
+}
+
+static void setShort(ExifData *ed, ExifIfd ifd, int tag, ExifShort value)
+{
+    unsigned char data[2];
+
+    exif_set_short(data, exif_data_get_byte_order(ed), value);
+    setEntry(ed, ifd, tag, EXIF_FORMAT_SHORT, 1, data);
+}
+
+static void setLong(ExifData *ed, ExifIfd ifd, int tag, ExifLong value)
+{
+    unsigned char data[4];
+
+    exif_set_long(data, exif_data_get_byte_order(ed), value);
+    setEntry(ed, ifd, tag, EXIF_FORMAT_LONG, 1, data);
+}
+
+static void setRationals(ExifData *ed, ExifIfd ifd, int tag, const uint32_t *values, unsigned int count)
+{
+    unsigned char data[24];
+
+    for ( unsigned int i = 0 ; i < count ; i++ )
+        {
+        ExifRational r = { values[2 * i], values[2 * i + 1] };
+
+        exif_set_rational(data + 8 * i, exif_data_get_byte_order(ed), r);
+        }
+
+    setEntry(ed, ifd, tag, EXIF_FORMAT_RATIONAL, count, data);
+}
+
+static void setString(ExifData *ed, ExifIfd ifd, int tag, const char *value)
+{
+    setEntry(ed, ifd, tag, EXIF_FORMAT_ASCII, strlen(value) + 1, value);
+}
+
+///The tags of the template, formatted and serialized by libexif
+static size_t buildLibexif(const ExifTemplate::Setup &setup, const ExifTemplate::Capture &capture)
+{
+    static const uint32_t resolution[2] = { 72, 1 };
+    ExifData *ed = exif_data_new();
+    unsigned char *data = NULL;
+    unsigned int size = 0;
+    char string[64];
+    struct tm tm;
+
+    exif_data_set_byte_order(ed, EXIF_BYTE_ORDER_INTEL);
+
+    localtime_r(&capture.time.tv_sec, &tm);
+    strftime(string, sizeof(string), "%Y:%m:%d %H:%M:%S", &tm);
+
+    setLong(ed, EXIF_IFD_0, EXIF_TAG_IMAGE_WIDTH, capture.width);
+    setLong(ed, EXIF_IFD_0, EXIF_TAG_IMAGE_LENGTH, capture.height);
+    setString(ed, EXIF_IFD_0, EXIF_TAG_MAKE, setup.make);
+    setString(ed, EXIF_IFD_0, EXIF_TAG_MODEL, setup.model);
+    setShort(ed, EXIF_IFD_0, EXIF_TAG_ORIENTATION, capture.orientation);
+    setRationals(ed, EXIF_IFD_0, EXIF_TAG_X_RESOLUTION, resolution, 1);
+    setRationals(ed, EXIF_IFD_0, EXIF_TAG_Y_RESOLUTION, resolution, 1);
+    setShort(ed, EXIF_IFD_0, EXIF_TAG_RESOLUTION_UNIT, 2);
+    setString(ed, EXIF_IFD_0, EXIF_TAG_DATE_TIME, string);
+    setShort(ed, EXIF_IFD_0, EXIF_TAG_YCBCR_POSITIONING, 1);
+
+    setRationals(ed, EXIF_IFD_EXIF, EXIF_TAG_EXPOSURE_TIME, capture.exposureTime, 1);
+    setShort(ed, EXIF_IFD_EXIF, EXIF_TAG_ISO_SPEED_RATINGS, capture.iso);
+    setEntry(ed, EXIF_IFD_EXIF, EXIF_TAG_EXIF_VERSION, EXIF_FORMAT_UNDEFINED, 4, "0220");
+    setString(ed, EXIF_IFD_EXIF, EXIF_TAG_DATE_TIME_ORIGINAL, string);
+    setString(ed, EXIF_IFD_EXIF, EXIF_TAG_DATE_TIME_DIGITIZED, string);
+    setEntry(ed, EXIF_IFD_EXIF, EXIF_TAG_COMPONENTS_CONFIGURATION, EXIF_FORMAT_UNDEFINED, 4, "\1\2\3\0");
+    setShort(ed, EXIF_IFD_EXIF, EXIF_TAG_METERING_MODE, capture.meteringMode);
+    setShort(ed, EXIF_IFD_EXIF, EXIF_TAG_FLASH, 0);
+    setRationals(ed, EXIF_IFD_EXIF, EXIF_TAG_FOCAL_LENGTH, setup.focalLength, 1);
+    snprintf(string, sizeof(string), "%06d", (int) capture.time.tv_usec);
+    setString(ed, EXIF_IFD_EXIF, EXIF_TAG_SUB_SEC_TIME, string);
+    setString(ed, EXIF_IFD_EXIF, EXIF_TAG_SUB_SEC_TIME_ORIGINAL, string);
+    setString(ed, EXIF_IFD_EXIF, EXIF_TAG_SUB_SEC_TIME_DIGITIZED, string);
+    setEntry(ed, EXIF_IFD_EXIF, EXIF_TAG_FLASH_PIX_VERSION, EXIF_FORMAT_UNDEFINED, 4, "0100");
+    setShort(ed, EXIF_IFD_EXIF, EXIF_TAG_COLOR_SPACE, 1);
+    setLong(ed, EXIF_IFD_EXIF, EXIF_TAG_PIXEL_X_DIMENSION, capture.width);
+    setLong(ed, EXIF_IFD_EXIF, EXIF_TAG_PIXEL_Y_DIMENSION, capture.height);
+    setEntry(ed, EXIF_IFD_EXIF, EXIF_TAG_FILE_SOURCE, EXIF_FORMAT_UNDEFINED, 1, "\3");
+    setEntry(ed, EXIF_IFD_EXIF, EXIF_TAG_SCENE_TYPE, EXIF_FORMAT_UNDEFINED, 1, "\1");
+    setShort(ed, EXIF_IFD_EXIF, EXIF_TAG_WHITE_BALANCE, capture.whiteBalance);
+    setRationals(ed, EXIF_IFD_EXIF, EXIF_TAG_DIGITAL_ZOOM_RATIO, capture.digitalZoom, 1);
+
+    setString(ed, EXIF_IFD_INTEROPERABILITY, EXIF_TAG_INTEROPERABILITY_INDEX, "R98");
+    setEntry(ed, EXIF_IFD_INTEROPERABILITY, EXIF_TAG_INTEROPERABILITY_VERSION, EXIF_FORMAT_UNDEFINED, 4, "0100");
+
+    if ( NULL != capture.gps )
+        {
+        const ExifTemplate::Gps *gps = capture.gps;
+        uint32_t rationals[6] = { gps->latitude[0], 1, gps->latitude[1], 1, gps->latitude[2], 1 };
+        char ref[2] = { gps->latitudeRef, 0 };
+        unsigned char method[ExifTemplate::GPS_PROCESSING_SIZE];
+        size_t length = strlen(gps->processingMethod);
+
+        setEntry(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_VERSION_ID, EXIF_FORMAT_BYTE, 4, gps->version);
+        setString(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_LATITUDE_REF, ref);
+        setRationals(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_LATITUDE, rationals, 3);
+        ref[0] = gps->longitudeRef;
+        rationals[0] = gps->longitude[0];
+        rationals[2] = gps->longitude[1];
+        rationals[4] = gps->longitude[2];
+        setString(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_LONGITUDE_REF, ref);
+        setRationals(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_LONGITUDE, rationals, 3);
+        setEntry(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_ALTITUDE_REF, EXIF_FORMAT_BYTE, 1, &gps->altitudeRef);
+        rationals[0] = gps->altitude;
+        setRationals(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_ALTITUDE, rationals, 1);
+
+        gmtime_r(&gps->timestamp, &tm);
+        rationals[0] = tm.tm_hour;
+        rationals[2] = tm.tm_min;
+        rationals[4] = tm.tm_sec;
+        setRationals(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_TIME_STAMP, rationals, 3);
+        setString(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_MAP_DATUM, gps->mapDatum);
+        memcpy(method, "ASCII\0\0\0", 8);
+        memcpy(method + 8, gps->processingMethod, length);
+        setEntry(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_PROCESSING_METHOD, EXIF_FORMAT_UNDEFINED, 8 + length, method);
+        strftime(string, sizeof(string), "%Y:%m:%d", &tm);
+        setString(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_DATE_STAMP, string);
+        }
+
+    setShort(ed, EXIF_IFD_1, EXIF_TAG_COMPRESSION, 6);
+    if ( NULL != capture.thumbnail )
+        {
+        ed->data = (unsigned char *) malloc(capture.thumbnailSize);
+        memcpy(ed->data, capture.thumbnail, capture.thumbnailSize);
+        ed->size = capture.thumbnailSize;
+        }
+    else
+        {
+        setLong(ed, EXIF_IFD_1, EXIF_TAG_JPEG_INTERCHANGE_FORMAT, 0xFFFFFFFF);
+        setLong(ed, EXIF_IFD_1, EXIF_TAG_JPEG_INTERCHANGE_FORMAT_LENGTH, 0xFFFFFFFF);
+        }
+
+    exif_data_save_data(ed, &data, &size);
+    exif_data_unref(ed);
+    free(data);
+
+    return size;
+}
+
+int main(int argc, char *argv[])
+{
+    static const ExifTemplate::Setup setup = { "Zoom", "SONY IU046", { 468, 100 }, true };
+    unsigned int iterations = DEFAULT_ITERATIONS;
+    ExifTemplate exif;
+    ExifTemplate::Gps gps;
+    uint8_t *buffer, *thumbnail;
+    size_t size = 0;
+
+    if ( 1 < argc )
+        {
+        iterations = strtoul(argv[1], NULL, 0);
+        if ( 0 == iterations )
+            {
+            fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    buffer = (uint8_t *) malloc(BUFFER_SIZE);
+    thumbnail = (uint8_t *) malloc(THUMBNAIL_SIZE);
+    if ( ( NULL == buffer ) || ( NULL == thumbnail ) )
+        {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+        }
+
+    memset(thumbnail, 0x5A, THUMBNAIL_SIZE);
+
+    memset(&gps, 0, sizeof(gps));
+    gps.latitude[0] = 48;
+    gps.latitude[1] = 51;
+    gps.latitude[2] = 24;
+    gps.longitude[0] = 2;
+    gps.longitude[1] = 21;
+    gps.longitude[2] = 7;
+    gps.latitudeRef = 'N';
+    gps.longitudeRef = 'E';
+    gps.altitude = 35;
+    gps.timestamp = time(NULL);
+    gps.version[0] = 2;
+    gps.version[1] = 2;
+    gps.mapDatum = "WGS-84";
+    gps.processingMethod = "GPS NETWORK";
+
+    if ( NO_ERROR != exif.build(setup) )
+        {
+        fprintf(stderr, "template build failed\n");
+        return 1;
+        }
+
+    printf("case,impl,iterations,us_per_capture,bytes\n");
+
+    for ( int c = 0 ; c < CASE_COUNT ; c++ )
+        {
+        ExifTemplate::Capture capture;
+
+        memset(&capture, 0, sizeof(capture));
+        capture.width = 2592;
+        capture.height = 1944;
+        capture.orientation = 1;
+        capture.exposureTime[0] = 33000;
+        capture.exposureTime[1] = 1000000;
+        capture.digitalZoom[0] = 100;
+        capture.digitalZoom[1] = 100;
+        capture.iso = 100;
+        capture.meteringMode = 1;
+        capture.gps = ( CASE_PLAIN != c ) ? &gps : NULL;
+        capture.thumbnail = ( CASE_THUMBNAIL == c ) ? thumbnail : NULL;
+        capture.thumbnailSize = ( CASE_THUMBNAIL == c ) ? THUMBNAIL_SIZE : 0;
+
+        int64_t start = now_ns();
+
+        for ( unsigned int n = 0 ; n < iterations ; n++ )
+            {
+            gettimeofday(&capture.time, NULL);
+            exif.write(capture, buffer, BUFFER_SIZE, &size);
+            }
+
+        printf("%s,template,%u,%.3f,%u\n", sCaseNames[c], iterations, ( now_ns() - start ) / 1e3 / iterations,
+               (unsigned int) size);
+
+        start = now_ns();
+
+        for ( unsigned int n = 0 ; n < iterations ; n++ )
+            {
+            gettimeofday(&capture.time, NULL);
+            size = buildLibexif(setup, capture);
+            }
+
+        printf("%s,libexif,%u,%.3f,%u\n", sCaseNames[c], iterations, ( now_ns() - start ) / 1e3 / iterations,
+               (unsigned int) size);
+        }
+
+    free(buffer);
+    free(thumbnail);
+
+    return 0;
+}
@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Round trip tests of the libtiutils EXIF template.
+///Payloads written by ExifTemplate are parsed back with libexif, with and
+///without GPS and thumbnail, and every patched field is compared with the
+///capture. Rewriting a buffer holding an earlier capture has to give the same
+///bytes as writing a clean one, and bad arguments have to be refused.
+///
+///Usage: exiftemplate_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libexif/exif-data.h>
+
+#include "ExifTemplate.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+#define BUFFER_SIZE     ( 64 * 1024 )
+#define THUMBNAIL_SIZE  6000
+
+static const ExifTemplate::Setup sSetup = { "Zoom", "SONY IU046", { 468, 100 }, true };
+
+static ExifTemplate::Capture makeCapture(unsigned int seed)
+{
+    ExifTemplate::Capture capture;
+
+    memset(&capture, 0, sizeof(capture));
+    capture.time.tv_sec = 1300000000 + seed * 86461;
+    capture.time.tv_usec = ( seed * 123457 ) % 1000000;
+    capture.width = 2592 - seed * 16;
+    capture.height = 1944 - seed * 8;
+    capture.orientation = ( seed & 1 ) ? 6 : 1;
+    capture.exposureTime[0] = 33000 + seed;
+    capture.exposureTime[1] = 1000000;
+    capture.digitalZoom[0] = 100 + seed * 25;
+    capture.digitalZoom[1] = 100;
+    capture.iso = 100 << ( seed % 4 );
+    capture.meteringMode = 1 + ( seed & 1 );
+    capture.whiteBalance = seed & 1;
+
+    return capture;
+}
+
+static ExifTemplate::Gps makeGps(unsigned int seed, const char *mapDatum, const char *processingMethod)
+{
+    ExifTemplate::Gps gps;
+
+    memset(&gps, 0, sizeof(gps));
+    gps.latitude[0] = 48 + seed;
+    gps.latitude[1] = 51;
+    gps.latitude[2] = 24 + seed;
+    gps.longitude[0] = 2;
+    gps.longitude[1] = 21 + seed;
+    gps.longitude[2] = 7;
+    gps.latitudeRef = ( seed & 1 ) ? 'S' : 'N';
+    gps.longitudeRef = ( seed & 1 ) ? 'W' : 'E';
+    gps.altitude = 35 + seed;
+    gps.altitudeRef = seed & 1;
+    gps.timestamp = 1299999000 + seed * 3607;
+    gps.version[0] = 2;
+    gps.version[1] = 2;
+    gps.mapDatum = mapDatum;
+    gps.processingMethod = processingMethod;
+
+    return gps;
+}
+
+static ExifEntry* entry(ExifData *ed, ExifIfd ifd, int tag)
+{
+    return exif_content_get_entry(ed->ifd[ifd], (ExifTag) tag);
+}
+
+static bool hasShort(ExifData *ed, ExifIfd ifd, int tag, unsigned int value)
+{
+    ExifEntry *e = entry(ed, ifd, tag);
+
+    return ( NULL != e ) && ( EXIF_FORMAT_SHORT == e->format ) && ( 1 == e->components ) &&
+           ( value == exif_get_short(e->data, exif_data_get_byte_order(ed)) );
+}
+
+static bool hasLong(ExifData *ed, ExifIfd ifd, int tag, unsigned int value)
+{
+    ExifEntry *e = entry(ed, ifd, tag);
+
+    return ( NULL != e ) && ( EXIF_FORMAT_LONG == e->format ) && ( 1 == e->components ) &&
+           ( value == exif_get_long(e->data, exif_data_get_byte_order(ed)) );
+}
+
+///values holds count numerator and denominator pairs
+static bool hasRationals(ExifData *ed, ExifIfd ifd, int tag, const uint32_t *values, unsigned int count)
+{
+    ExifEntry *e = entry(ed, ifd, tag);
+
+    if ( ( NULL == e ) || ( EXIF_FORMAT_RATIONAL != e->format ) || ( count != e->components ) )
+        {
+        return false;
+        }
+
+    for ( unsigned int i = 0 ; i < count ; i++ )
+        {
+        ExifRational r = exif_get_rational(e->data + 8 * i, exif_data_get_byte_order(ed));
+
+        if ( ( r.numerator != values[2 * i] ) || ( r.denominator != values[2 * i + 1] ) )
+            {
+            return false;
+            }
+        }
+
+    return true;
+}
+
+///The string has to be terminated within the count of the tag
+static bool hasAscii(ExifData *ed, ExifIfd ifd, int tag, const char *value)
+{
+    ExifEntry *e = entry(ed, ifd, tag);
+
+    return ( NULL != e ) && ( EXIF_FORMAT_ASCII == e->format ) && ( 0 < e->size ) &&
+           ( NULL != memchr(e->data, 0, e->size) ) && ( 0 == strcmp((const char *) e->data, value) );
+}
+
+static bool hasBytes(ExifData *ed, ExifIfd ifd, int tag, int format, const void *value, unsigned int size)
+{
+    ExifEntry *e = entry(ed, ifd, tag);
+
+    return ( NULL != e ) && ( format == e->format ) && ( size == e->size ) &&
+           ( 0 == memcmp(e->data, value, size) );
+}
+
+static void testRoundTrip(bool withGps, bool withThumbnail)
+{
+    ExifTemplate exif;
+    ExifTemplate::Capture capture = makeCapture(withGps + 2 * withThumbnail);
+    ExifTemplate::Gps gps = makeGps(withThumbnail, "WGS-84", "GPS NETWORK");
+    uint8_t *buffer = (uint8_t *) malloc(BUFFER_SIZE);
+    uint8_t *thumbnail = (uint8_t *) malloc(THUMBNAIL_SIZE);
+    size_t size = 0;
+    char what[128], date[32];
+    struct tm tm;
+
+    for ( int i = 0 ; i < THUMBNAIL_SIZE ; i++ )
+        {
+        thumbnail[i] = rand() & 0xFF;
+        }
+
+    if ( withGps )
+        {
+        capture.gps = &gps;
+        }
+
+    if ( withThumbnail )
+        {
+        capture.thumbnail = thumbnail;
+        capture.thumbnailSize = THUMBNAIL_SIZE;
+        }
+
+    snprintf(what, sizeof(what), "round trip gps %d thumbnail %d", withGps, withThumbnail);
+    testExpect(NO_ERROR == exif.build(sSetup), "build");
+    testExpect(NO_ERROR == exif.write(capture, buffer, BUFFER_SIZE, &size), "%s", what);
+    testExpect(size == exif.getSize(capture), "size");
+    testExpect(0 == memcmp(buffer, "Exif\0\0II*\0", 10), "header");
+
+    ExifData *ed = exif_data_new();
+    exif_data_unset_option(ed, EXIF_DATA_OPTION_IGNORE_UNKNOWN_TAGS);
+    exif_data_unset_option(ed, EXIF_DATA_OPTION_FOLLOW_SPECIFICATION);
+    exif_data_load_data(ed, buffer, size);
+
+    testExpect(EXIF_BYTE_ORDER_INTEL == exif_data_get_byte_order(ed), "byte order");
+
+    ///IFD0
+    testExpect(hasLong(ed, EXIF_IFD_0, EXIF_TAG_IMAGE_WIDTH, capture.width), "image width");
+    testExpect(hasLong(ed, EXIF_IFD_0, EXIF_TAG_IMAGE_LENGTH, capture.height), "image length");
+    testExpect(hasAscii(ed, EXIF_IFD_0, EXIF_TAG_MAKE, sSetup.make), "make");
+    testExpect(hasAscii(ed, EXIF_IFD_0, EXIF_TAG_MODEL, sSetup.model), "model");
+    testExpect(hasShort(ed, EXIF_IFD_0, EXIF_TAG_ORIENTATION, capture.orientation), "orientation");
+    testExpect(hasShort(ed, EXIF_IFD_0, EXIF_TAG_RESOLUTION_UNIT, 2), "resolution unit");
+
+    localtime_r(&capture.time.tv_sec, &tm);
+    strftime(date, sizeof(date), "%Y:%m:%d %H:%M:%S", &tm);
+    testExpect(hasAscii(ed, EXIF_IFD_0, EXIF_TAG_DATE_TIME, date), "date time");
+    testExpect(hasAscii(ed, EXIF_IFD_EXIF, EXIF_TAG_DATE_TIME_ORIGINAL, date), "date time original");
+    testExpect(hasAscii(ed, EXIF_IFD_EXIF, EXIF_TAG_DATE_TIME_DIGITIZED, date), "date time digitized");
+
+    ///EXIF
+    snprintf(date, sizeof(date), "%06d", (int) capture.time.tv_usec);
+    testExpect(hasAscii(ed, EXIF_IFD_EXIF, EXIF_TAG_SUB_SEC_TIME, date), "sub sec time");
+    testExpect(hasAscii(ed, EXIF_IFD_EXIF, EXIF_TAG_SUB_SEC_TIME_ORIGINAL, date), "sub sec time original");
+    testExpect(hasAscii(ed, EXIF_IFD_EXIF, EXIF_TAG_SUB_SEC_TIME_DIGITIZED, date), "sub sec time digitized");
+    testExpect(hasRationals(ed, EXIF_IFD_EXIF, EXIF_TAG_EXPOSURE_TIME, capture.exposureTime, 1), "exposure time");
+    testExpect(hasRationals(ed, EXIF_IFD_EXIF, EXIF_TAG_DIGITAL_ZOOM_RATIO, capture.digitalZoom, 1), "digital zoom");
+    testExpect(hasRationals(ed, EXIF_IFD_EXIF, EXIF_TAG_FOCAL_LENGTH, sSetup.focalLength, 1), "focal length");
+    testExpect(hasShort(ed, EXIF_IFD_EXIF, EXIF_TAG_ISO_SPEED_RATINGS, capture.iso), "iso");
+    testExpect(hasShort(ed, EXIF_IFD_EXIF, EXIF_TAG_METERING_MODE, capture.meteringMode), "metering mode");
+    testExpect(hasShort(ed, EXIF_IFD_EXIF, EXIF_TAG_WHITE_BALANCE, capture.whiteBalance), "white balance");
+    testExpect(hasShort(ed, EXIF_IFD_EXIF, EXIF_TAG_FLASH, 0), "flash");
+    testExpect(hasLong(ed, EXIF_IFD_EXIF, EXIF_TAG_PIXEL_X_DIMENSION, capture.width), "pixel x");
+    testExpect(hasLong(ed, EXIF_IFD_EXIF, EXIF_TAG_PIXEL_Y_DIMENSION, capture.height), "pixel y");
+    testExpect(hasBytes(ed, EXIF_IFD_EXIF, EXIF_TAG_EXIF_VERSION, EXIF_FORMAT_UNDEFINED, "0220", 4), "exif version");
+    testExpect(hasAscii(ed, EXIF_IFD_INTEROPERABILITY, EXIF_TAG_INTEROPERABILITY_INDEX, "R98"), "interoperability");
+
+    ///GPS
+    if ( withGps )
+        {
+        uint32_t rationals[6] = { gps.latitude[0], 1, gps.latitude[1], 1, gps.latitude[2], 1 };
+        char ref[2] = { gps.latitudeRef, 0 };
+
+        testExpect(hasBytes(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_VERSION_ID, EXIF_FORMAT_BYTE, gps.version, 4), "gps version");
+        testExpect(hasRationals(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_LATITUDE, rationals, 3), "gps latitude");
+        testExpect(hasAscii(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_LATITUDE_REF, ref), "gps latitude ref");
+
+        rationals[0] = gps.longitude[0];
+        rationals[2] = gps.longitude[1];
+        rationals[4] = gps.longitude[2];
+        ref[0] = gps.longitudeRef;
+        testExpect(hasRationals(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_LONGITUDE, rationals, 3), "gps longitude");
+        testExpect(hasAscii(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_LONGITUDE_REF, ref), "gps longitude ref");
+
+        rationals[0] = gps.altitude;
+        testExpect(hasRationals(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_ALTITUDE, rationals, 1), "gps altitude");
+        testExpect(hasBytes(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_ALTITUDE_REF, EXIF_FORMAT_BYTE, &gps.altitudeRef, 1),
+                   "gps altitude ref");
+
+        gmtime_r(&gps.timestamp, &tm);
+        rationals[0] = tm.tm_hour;
+        rationals[2] = tm.tm_min;
+        rationals[4] = tm.tm_sec;
+        strftime(date, sizeof(date), "%Y:%m:%d", &tm);
+        testExpect(hasRationals(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_TIME_STAMP, rationals, 3), "gps time stamp");
+        testExpect(hasAscii(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_DATE_STAMP, date), "gps date stamp");
+        testExpect(hasAscii(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_MAP_DATUM, gps.mapDatum), "gps map datum");
+        testExpect(hasBytes(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_PROCESSING_METHOD, EXIF_FORMAT_UNDEFINED,
+                            "ASCII\0\0\0GPS NETWORK", 8 + strlen(gps.processingMethod)), "gps processing method");
+        }
+    else
+        {
+        testExpect(0 == ed->ifd[EXIF_IFD_GPS]->count, "no gps");
+        }
+
+    ///IFD1
+    testExpect(hasShort(ed, EXIF_IFD_1, EXIF_TAG_COMPRESSION, 6), "compression");
+    if ( withThumbnail )
+        {
+        testExpect(hasLong(ed, EXIF_IFD_1, EXIF_TAG_JPEG_INTERCHANGE_FORMAT_LENGTH, THUMBNAIL_SIZE), "thumbnail length");
+        testExpect(( THUMBNAIL_SIZE == ed->size ) && ( 0 == memcmp(ed->data, thumbnail, THUMBNAIL_SIZE) ), "thumbnail");
+        }
+    else
+        {
+        testExpect(hasLong(ed, EXIF_IFD_1, EXIF_TAG_JPEG_INTERCHANGE_FORMAT, 0xFFFFFFFF), "thumbnail placeholder");
+        testExpect(hasLong(ed, EXIF_IFD_1, EXIF_TAG_JPEG_INTERCHANGE_FORMAT_LENGTH, 0xFFFFFFFF),
+                   "thumbnail length placeholder");
+        }
+
+    exif_data_unref(ed);
+    free(buffer);
+    free(thumbnail);
+}
+
+///A buffer reused from a capture with longer strings and a thumbnail
+static void testRewrite()
+{
+    ExifTemplate exif;
+    ExifTemplate::Gps longGps = makeGps(1, "A VERY LONG MAP DATUM NAME, TRUNCATED",
+                                        "A PROCESSING METHOD LONGER THAN ITS ROOM");
+    ExifTemplate::Gps shortGps = makeGps(2, "", "GPS");
+    ExifTemplate::Capture first = makeCapture(3);
+    ExifTemplate::Capture second = makeCapture(4);
+    uint8_t *reused = (uint8_t *) malloc(BUFFER_SIZE);
+    uint8_t *clean = (uint8_t *) calloc(1, BUFFER_SIZE);
+    uint8_t thumbnail[512];
+    size_t firstSize, reusedSize, cleanSize;
+
+    memset(thumbnail, 0xA5, sizeof(thumbnail));
+    memset(reused, 0xFF, BUFFER_SIZE);
+    first.gps = &longGps;
+    first.thumbnail = thumbnail;
+    first.thumbnailSize = sizeof(thumbnail);
+    second.gps = &shortGps;
+
+    exif.build(sSetup);
+    exif.write(first, reused, BUFFER_SIZE, &firstSize);
+    testExpect(NO_ERROR == exif.write(second, reused, BUFFER_SIZE, &reusedSize), "rewrite");
+    testExpect(NO_ERROR == exif.write(second, clean, BUFFER_SIZE, &cleanSize), "clean write");
+    testExpect(( reusedSize == cleanSize ) && ( 0 == memcmp(reused, clean, cleanSize) ), "rewrite matches clean write");
+
+    ///Strings longer than their room are truncated, the map datum is still terminated
+    exif.write(first, reused, BUFFER_SIZE, &firstSize);
+
+    ExifData *ed = exif_data_new();
+    exif_data_unset_option(ed, EXIF_DATA_OPTION_IGNORE_UNKNOWN_TAGS);
+    exif_data_unset_option(ed, EXIF_DATA_OPTION_FOLLOW_SPECIFICATION);
+    exif_data_load_data(ed, reused, firstSize);
+    testExpect(hasAscii(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_MAP_DATUM, "A VERY LONG MAP DATUM NAME, TRU"), "map datum truncated");
+    testExpect(hasBytes(ed, EXIF_IFD_GPS, EXIF_TAG_GPS_PROCESSING_METHOD, EXIF_FORMAT_UNDEFINED,
+                        "ASCII\0\0\0A PROCESSING METHOD LONGER THAN ", ExifTemplate::GPS_PROCESSING_SIZE),
+               "processing method truncated");
+    exif_data_unref(ed);
+
+    free(reused);
+    free(clean);
+}
+
+static void testLimits()
+{
+    ExifTemplate exif;
+    ExifTemplate::Setup setup = sSetup;
+    ExifTemplate::Capture capture = makeCapture(0);
+    uint8_t *buffer = (uint8_t *) malloc(BUFFER_SIZE + 1024);
+    size_t size;
+
+    testExpect(NO_INIT == exif.write(capture, buffer, BUFFER_SIZE, &size), "write before build");
+    testExpect(0 == exif.getSize(capture), "size before build");
+
+    exif.build(sSetup);
+    testExpect(BAD_VALUE == exif.write(capture, buffer, exif.getSize(capture) - 1, &size), "short buffer");
+    testExpect(NO_ERROR == exif.write(capture, buffer, exif.getSize(capture), &size), "exact buffer");
+
+    ///The payload has to fit an APP1 marker
+    capture.thumbnail = buffer;
+    capture.thumbnailSize = ExifTemplate::MAX_PAYLOAD_SIZE;
+    testExpect(BAD_VALUE == exif.write(capture, buffer, BUFFER_SIZE + 1024, &size), "payload over 64KB");
+
+    setup.thumbnail = false;
+    exif.build(setup);
+    capture.thumbnailSize = 16;
+    testExpect(BAD_VALUE == exif.write(capture, buffer, BUFFER_SIZE, &size), "thumbnail without IFD1");
+
+    capture.thumbnail = NULL;
+    testExpect(NO_ERROR == exif.write(capture, buffer, BUFFER_SIZE, &size), "write without IFD1");
+
+    ExifData *ed = exif_data_new();
+    exif_data_unset_option(ed, EXIF_DATA_OPTION_IGNORE_UNKNOWN_TAGS);
+    exif_data_unset_option(ed, EXIF_DATA_OPTION_FOLLOW_SPECIFICATION);
+    exif_data_load_data(ed, buffer, size);
+    testExpect(0 == ed->ifd[EXIF_IFD_1]->count, "no IFD1");
+    testExpect(hasLong(ed, EXIF_IFD_0, EXIF_TAG_IMAGE_WIDTH, capture.width), "parsed without IFD1");
+    exif_data_unref(ed);
+
+    free(buffer);
+}
+
+int main()
+{
+    srand(1);
+
+    for ( int gps = 0 ; gps < 2 ; gps++ )
+        {
+        for ( int thumbnail = 0 ; thumbnail < 2 ; thumbnail++ )
+            {
+            testRoundTrip(gps, thumbnail);
+            }
+        }
+
+    testRewrite();
+    testLimits();
+
+    return testReport();
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///FaceTracker checks, on synthetic face streams
+///
+///Usage: facetracker_test
+///
+///Detections are drawn around known boxes with a deterministic jitter, as the
+///face detection reports them from frame to frame.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FaceTracker.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+#define FRAMES  200
+#define JITTER  4
+
+static FaceTracker::Face makeFace(int left, int top, int size)
+{
+    FaceTracker::Face face;
+
+    memset(&face, 0, sizeof(face));
+    face.mLeft = left;
+    face.mTop = top;
+    face.mWidth = size;
+    face.mHeight = size;
+    face.mScore = 100;
+
+    return face;
+}
+
+static int jitter()
+{
+    return ( rand() % ( 2 * JITTER + 1 ) ) - JITTER;
+}
+
+static FaceTracker::Face detect(const FaceTracker::Face &truth)
+{
+    FaceTracker::Face face = truth;
+
+    face.mLeft += jitter();
+    face.mTop += jitter();
+    face.mWidth += jitter();
+    face.mHeight = face.mWidth;
+
+    return face;
+}
+
+static const FaceTracker::Track* findTrack(const FaceTracker &tracker, uint32_t id)
+{
+    for ( unsigned int i = 0 ; i < tracker.getCount() ; i++ )
+        {
+        if ( id == tracker.getTrack(i).mId )
+            {
+            return &tracker.getTrack(i);
+            }
+        }
+
+    return NULL;
+}
+
+///Two drifting faces keep their ids, whatever the order of the detections
+static bool checkStableIds()
+{
+    FaceTracker tracker;
+    uint32_t ids[2] = { 0, 0 };
+
+    srand(1);
+
+    for ( int frame = 0 ; frame < FRAMES ; frame++ )
+        {
+        FaceTracker::Face truth[2] = { makeFace(100 + frame, 120, 80), makeFace(400 - frame / 2, 200, 60) };
+        FaceTracker::Face faces[2];
+
+        ///Detections come in any order
+        faces[frame & 1] = detect(truth[0]);
+        faces[( frame + 1 ) & 1] = detect(truth[1]);
+        tracker.update(faces, 2);
+
+        if ( ( 0 == frame ) && ( 0 != tracker.getCount() ) )
+            {
+            return false;
+            }
+
+        if ( 1 == frame )
+            {
+            if ( 2 != tracker.getCount() )
+                {
+                return false;
+                }
+
+            ids[0] = tracker.getTrack(0).mId;
+            ids[1] = tracker.getTrack(1).mId;
+            }
+
+        if ( 1 <= frame )
+            {
+            const FaceTracker::Track *first = findTrack(tracker, ids[0]);
+            const FaceTracker::Track *second = findTrack(tracker, ids[1]);
+
+            if ( ( 2 != tracker.getCount() ) || ( NULL == first ) || ( NULL == second ) ||
+                 ( 20 < abs(first->mFace.mLeft - truth[0].mLeft) ) ||
+                 ( 20 < abs(second->mFace.mLeft - truth[1].mLeft) ) )
+                {
+                return false;
+                }
+            }
+        }
+
+    return true;
+}
+
+///A still face jitters less after filtering, and is updated on fewer frames
+static bool checkSmoothing()
+{
+    FaceTracker tracker;
+    FaceTracker::Face truth = makeFace(300, 200, 100);
+    int rawSpread = 0;
+    int smoothSpread = 0;
+    int rawMin = 1 << 30, rawMax = -( 1 << 30 );
+    int smoothMin = 1 << 30, smoothMax = -( 1 << 30 );
+    int changes = 0;
+
+    srand(2);
+
+    for ( int frame = 0 ; frame < FRAMES ; frame++ )
+        {
+        FaceTracker::Face face = detect(truth);
+
+        if ( tracker.update(&face, 1) && ( 20 <= frame ) )
+            {
+            changes++;
+            }
+
+        if ( 20 <= frame )
+            {
+            const FaceTracker::Face &smooth = tracker.getTrack(0).mFace;
+
+            rawMin = ( face.mLeft < rawMin ) ? face.mLeft : rawMin;
+            rawMax = ( face.mLeft > rawMax ) ? face.mLeft : rawMax;
+            smoothMin = ( smooth.mLeft < smoothMin ) ? smooth.mLeft : smoothMin;
+            smoothMax = ( smooth.mLeft > smoothMax ) ? smooth.mLeft : smoothMax;
+            }
+        }
+
+    rawSpread = rawMax - rawMin;
+    smoothSpread = smoothMax - smoothMin;
+
+
+    return ( 1 == tracker.getCount() ) && ( smoothSpread * 2 <= rawSpread ) && ( changes < FRAMES - 20 );
+}
+
+///A face seen on a single frame is never reported
+static bool checkConfirm()
+{
+    FaceTracker tracker;
+    FaceTracker::Face face = makeFace(50, 50, 40);
+
+    if ( tracker.update(&face, 1) || ( 0 != tracker.getCount() ) )
+        {
+        return false;
+        }
+
+    if ( tracker.update(NULL, 0) || ( 0 != tracker.getCount() ) )
+        {
+        return false;
+        }
+
+    ///Seen again, it starts over as a new face
+    tracker.update(&face, 1);
+    if ( !tracker.update(&face, 1) || ( 1 != tracker.getCount() ) )
+        {
+        return false;
+        }
+
+    return ( 2 == tracker.getTrack(0).mId );
+}
+
+///A reported face outlives a few missed detections, then is dropped
+static bool checkHold()
+{
+    FaceTracker tracker;
+    FaceTracker::Face face = makeFace(200, 100, 90);
+    uint32_t id;
+
+    tracker.update(&face, 1);
+    tracker.update(&face, 1);
+    id = tracker.getTrack(0).mId;
+
+    ///Default hold is 3 frames
+    for ( int i = 0 ; i < 3 ; i++ )
+        {
+        if ( tracker.update(NULL, 0) || ( 1 != tracker.getCount() ) )
+            {
+            return false;
+            }
+        }
+
+    tracker.update(&face, 1);
+    if ( ( 1 != tracker.getCount() ) || ( id != tracker.getTrack(0).mId ) )
+        {
+        return false;
+        }
+
+    for ( int i = 0 ; i < 3 ; i++ )
+        {
+        tracker.update(NULL, 0);
+        }
+
+    if ( !tracker.update(NULL, 0) || ( 0 != tracker.getCount() ) )
+        {
+        return false;
+        }
+
+    ///A jump without overlap is a new face, the old one is held then dropped
+    tracker.update(&face, 1);
+    tracker.update(&face, 1);
+    face.mLeft += 200;
+    for ( int i = 0 ; i < 4 ; i++ )
+        {
+        tracker.update(&face, 1);
+        }
+
+    return ( 1 == tracker.getCount() ) && ( id + 2 == tracker.getTrack(0).mId );
+}
+
+///The region follows the largest face, and only moves past the threshold
+static bool checkRegion()
+{
+    FaceTracker tracker;
+    FaceTracker::Face region;
+    bool valid;
+    int changes = 0;
+
+    srand(3);
+
+    if ( tracker.getRegion(region, valid) || valid )
+        {
+        return false;
+        }
+
+    for ( int frame = 0 ; frame < FRAMES ; frame++ )
+        {
+        FaceTracker::Face faces[2] = { detect(makeFace(100, 100, 50)), detect(makeFace(300 + frame / 4, 100, 120)) };
+
+        tracker.update(faces, 2);
+        if ( tracker.getRegion(region, valid) )
+            {
+            changes++;
+            }
+
+        if ( ( 1 <= frame ) && ( !valid || ( 250 > region.mLeft ) ) )
+            {
+            return false;
+            }
+        }
+
+
+    ///The first one, then every 18 pixels at most
+    if ( ( 1 > changes ) || ( 1 + FRAMES / 4 / 15 < changes ) )
+        {
+        return false;
+        }
+
+    for ( int i = 0 ; i < 4 ; i++ )
+        {
+        tracker.update(NULL, 0);
+        }
+
+    return tracker.getRegion(region, valid) && !valid && !tracker.getRegion(region, valid);
+}
+
+static bool checkEncode()
+{
+    FaceTracker tracker;
+    FaceTracker::Face faces[2] = { makeFace(10, 20, 30), makeFace(100, 200, 300) };
+    char buffer[64];
+
+    faces[0].mRoll = -5;
+    tracker.update(faces, 2);
+    tracker.update(faces, 2);
+
+    if ( ( 33 != tracker.encode(buffer, sizeof(buffer)) ) || ( 0 != strcmp(buffer, "-5,10x20,30x30,0,100x200,300x300,") ) )
+        {
+        return false;
+        }
+
+    ///Faces that do not fit are dropped whole
+    if ( ( 15 != tracker.encode(buffer, 20) ) || ( 0 != strcmp(buffer, "-5,10x20,30x30,") ) )
+        {
+        return false;
+        }
+
+    tracker.reset();
+
+    return ( 0 == tracker.encode(buffer, sizeof(buffer)) ) && ( '\0' == buffer[0] );
+}
+
+///More detections than tracks
+static bool checkCapacity()
+{
+    FaceTracker tracker;
+    FaceTracker::Face faces[FaceTracker::MAX_FACES + 5];
+
+    for ( int i = 0 ; i < FaceTracker::MAX_FACES + 5 ; i++ )
+        {
+        faces[i] = makeFace(( i % 8 ) * 100, ( i / 8 ) * 100, 50);
+        }
+
+    for ( int frame = 0 ; frame < 4 ; frame++ )
+        {
+        tracker.update(faces, FaceTracker::MAX_FACES + 5);
+        }
+
+    return ( FaceTracker::MAX_TRACKS == tracker.getCount() );
+}
+
+int main()
+{
+    static const TestCheck checks[] =
+        {
+        { "stable ids", checkStableIds },
+        { "smoothing", checkSmoothing },
+        { "confirm", checkConfirm },
+        { "hold", checkHold },
+        { "region", checkRegion },
+        { "encode", checkEncode },
+        { "capacity", checkCapacity },
+        };
+
+    TEST_RUN(checks);
+
+    return testReport();
+}
@@ -0,0 +1,34 @@
+ifdef BOARD_USES_TI_CAMERA_HAL
+ifeq ($(TARGET_BOARD_PLATFORM),omap3)
+ifdef HARDWARE_OMX
+
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	jpegencoder_test.cpp \
+	jpegenc_stub.cpp \
+	../../camera-omap3/JpegEncoder.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/camera-omap3 \
+	hardware/ti/omx/system/src/openmax_il/omx_core/inc \
+	hardware/ti/omx/image/src/openmax_il/jpeg_enc/inc \
+	external/libexif \
+	hardware/ti/omap4/omap3/test
+
+LOCAL_MODULE:= jpegencoder_test
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2
+
+include $(BUILD_EXECUTABLE)
+
+endif
+endif
+endif
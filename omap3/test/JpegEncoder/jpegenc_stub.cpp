@@ -0,0 +1,669 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+    #include "OMX_Component.h"
+}
+#include <OMX_JpegEnc_CustomCmd.h>
+
+#include "jpegenc_stub.h"
+
+#define STUB_PORTS          2
+#define STUB_QUEUE          8
+
+enum
+{
+    INDEX_QFACTOR = OMX_IndexVendorStartUnused + 1,
+    INDEX_CONVERSION,
+    INDEX_PPLIB,
+    INDEX_APP1
+};
+
+struct StubComponent
+{
+    OMX_COMPONENTTYPE omx;
+    OMX_CALLBACKTYPE callbacks;
+    OMX_PTR appData;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool exit;
+
+    OMX_STATETYPE state;
+    OMX_STATETYPE target;
+    bool transition;
+
+    OMX_PARAM_PORTDEFINITIONTYPE ports[STUB_PORTS];
+    unsigned int populated[STUB_PORTS];
+    OMX_BUFFERHEADERTYPE *queues[STUB_PORTS][STUB_QUEUE];
+    unsigned int queued[STUB_PORTS];
+
+    JPGE_PPLIB_DynamicParams pplib;
+    uint32_t exifTag;
+    uint32_t quality;
+    uint32_t conversion;
+};
+
+static pthread_mutex_t sStatsLock = PTHREAD_MUTEX_INITIALIZER;
+static JpegStubStats sStats;
+static unsigned int sEncodeUs;
+static unsigned int sTransitionUs;
+static bool sFailNext;
+static int sBusy;
+
+static void count(int *counter, int delta)
+{
+    pthread_mutex_lock(&sStatsLock);
+    *counter += delta;
+    pthread_mutex_unlock(&sStatsLock);
+}
+
+void JpegEncoderStub::reset(unsigned int encodeUs, unsigned int transitionUs)
+{
+    pthread_mutex_lock(&sStatsLock);
+    memset(&sStats, 0, sizeof(sStats));
+    sEncodeUs = encodeUs;
+    sTransitionUs = transitionUs;
+    sFailNext = false;
+    sBusy = 0;
+    pthread_mutex_unlock(&sStatsLock);
+}
+
+void JpegEncoderStub::failNextEncode()
+{
+    pthread_mutex_lock(&sStatsLock);
+    sFailNext = true;
+    pthread_mutex_unlock(&sStatsLock);
+}
+
+JpegStubStats JpegEncoderStub::getStats()
+{
+    JpegStubStats stats;
+
+    pthread_mutex_lock(&sStatsLock);
+    stats = sStats;
+    pthread_mutex_unlock(&sStatsLock);
+
+    return stats;
+}
+
+bool JpegEncoderStub::isBusy()
+{
+    bool busy;
+
+    pthread_mutex_lock(&sStatsLock);
+    busy = ( 0 < sBusy );
+    pthread_mutex_unlock(&sStatsLock);
+
+    return busy;
+}
+
+uint32_t JpegEncoderStub::outputSize(uint32_t inputSum)
+{
+    return sizeof(JpegStubOutput) + inputSum % 64;
+}
+
+static StubComponent* stub(OMX_HANDLETYPE handle)
+{
+    return ( StubComponent * ) ( ( OMX_COMPONENTTYPE * ) handle )->pComponentPrivate;
+}
+
+static bool populated(StubComponent *c, unsigned int port)
+{
+    return ( c->populated[port] == c->ports[port].nBufferCountActual );
+}
+
+///One pending command at a time, completed by the worker
+static void runTransition(StubComponent *c)
+{
+    OMX_STATETYPE from = c->state;
+    OMX_STATETYPE to = c->target;
+
+    if ( ( ( OMX_StateLoaded == from ) && ( OMX_StateIdle == to ) ) ||
+         ( ( OMX_StateIdle == from ) && ( OMX_StateExecuting == to ) ) ||
+         ( ( OMX_StateExecuting == from ) && ( OMX_StateIdle == to ) ) ||
+         ( ( OMX_StateIdle == from ) && ( OMX_StateLoaded == to ) ) )
+        {
+        if ( ( OMX_StateIdle == to ) && ( OMX_StateExecuting == from ) &&
+             ( c->queued[0] || c->queued[1] ) )
+            {
+            ///The client is expected to let its shots complete first
+            count(&sStats.violations, 1);
+            }
+        }
+    else
+        {
+        count(&sStats.violations, 1);
+        }
+
+    pthread_mutex_unlock(&c->lock);
+    usleep(sTransitionUs);
+    pthread_mutex_lock(&c->lock);
+
+    c->state = to;
+    c->transition = false;
+    if ( OMX_StateExecuting == to )
+        {
+        count(&sStats.executing, 1);
+        }
+
+    pthread_mutex_unlock(&c->lock);
+    c->callbacks.EventHandler(&c->omx, c->appData, OMX_EventCmdComplete, OMX_CommandStateSet, to, NULL);
+    pthread_mutex_lock(&c->lock);
+}
+
+static OMX_BUFFERHEADERTYPE* pop(StubComponent *c, unsigned int port)
+{
+    OMX_BUFFERHEADERTYPE *header = c->queues[port][0];
+
+    c->queued[port]--;
+    memmove(&c->queues[port][0], &c->queues[port][1], c->queued[port] * sizeof(c->queues[port][0]));
+
+    return header;
+}
+
+static void runEncode(StubComponent *c)
+{
+    OMX_BUFFERHEADERTYPE *in = pop(c, 0);
+    OMX_BUFFERHEADERTYPE *out = pop(c, 1);
+    JpegStubOutput image;
+    bool fail;
+    int number;
+
+    ///The configs in effect when the buffer starts
+    memset(&image, 0, sizeof(image));
+    image.magic = JPEG_STUB_MAGIC;
+    image.zoomFactor = c->pplib.ulPPLIBZoomFactor;
+    image.cropWidth = c->pplib.ulPPLIBEnableCropping ? c->pplib.ulPPLIBXsize : 0;
+    image.exifTag = c->exifTag;
+    image.quality = c->quality;
+    image.conversion = c->conversion;
+    for ( OMX_U32 i = 0 ; i < in->nFilledLen ; i++ )
+        {
+        image.inputSum += in->pBuffer[in->nOffset + i];
+        }
+
+    pthread_mutex_lock(&sStatsLock);
+    fail = sFailNext;
+    sFailNext = false;
+    number = sStats.encodes++;
+    pthread_mutex_unlock(&sStatsLock);
+
+    pthread_mutex_unlock(&c->lock);
+
+    usleep(sEncodeUs);
+
+    count(&sBusy, -1);
+
+    if ( fail )
+        {
+        ///The buffers stay with the broken component
+        c->callbacks.EventHandler(&c->omx, c->appData, OMX_EventError, OMX_ErrorHardware, 0, NULL);
+        pthread_mutex_lock(&c->lock);
+        return;
+        }
+
+    out->nOffset = 0;
+    out->nFilledLen = JpegEncoderStub::outputSize(image.inputSum);
+    if ( out->nAllocLen < out->nFilledLen )
+        {
+        count(&sStats.violations, 1);
+        out->nFilledLen = out->nAllocLen;
+        }
+    else
+        {
+        memcpy(out->pBuffer, &image, sizeof(image));
+        }
+
+    ///Both orders happen on the DSP
+    if ( number & 1 )
+        {
+        c->callbacks.FillBufferDone(&c->omx, c->appData, out);
+        c->callbacks.EmptyBufferDone(&c->omx, c->appData, in);
+        }
+    else
+        {
+        c->callbacks.EmptyBufferDone(&c->omx, c->appData, in);
+        c->callbacks.FillBufferDone(&c->omx, c->appData, out);
+        }
+
+    pthread_mutex_lock(&c->lock);
+}
+
+static void* worker(void *arg)
+{
+    StubComponent *c = ( StubComponent * ) arg;
+
+    pthread_mutex_lock(&c->lock);
+
+    while ( !c->exit )
+        {
+        if ( c->transition )
+            {
+            bool ready = true;
+
+            if ( ( OMX_StateLoaded == c->state ) && ( OMX_StateIdle == c->target ) )
+                {
+                ready = populated(c, 0) && populated(c, 1);
+                }
+            else if ( ( OMX_StateIdle == c->state ) && ( OMX_StateLoaded == c->target ) )
+                {
+                ready = ( 0 == c->populated[0] ) && ( 0 == c->populated[1] );
+                }
+
+            if ( ready )
+                {
+                runTransition(c);
+                continue;
+                }
+            }
+
+        if ( ( OMX_StateExecuting == c->state ) && !c->transition && c->queued[0] && c->queued[1] )
+            {
+            runEncode(c);
+            continue;
+            }
+
+        pthread_cond_wait(&c->cond, &c->lock);
+        }
+
+    pthread_mutex_unlock(&c->lock);
+
+    return NULL;
+}
+
+static OMX_ERRORTYPE stubSendCommand(OMX_HANDLETYPE handle, OMX_COMMANDTYPE cmd, OMX_U32 param, OMX_PTR data)
+{
+    StubComponent *c = stub(handle);
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+
+    if ( OMX_CommandStateSet != cmd )
+        {
+        return OMX_ErrorNotImplemented;
+        }
+
+    pthread_mutex_lock(&c->lock);
+
+    if ( OMX_StateInvalid == ( OMX_STATETYPE ) param )
+        {
+        c->state = OMX_StateInvalid;
+        c->transition = false;
+        }
+    else if ( c->transition || ( OMX_StateInvalid == c->state ) )
+        {
+        count(&sStats.violations, 1);
+        ret = OMX_ErrorIncorrectStateTransition;
+        }
+    else
+        {
+        c->target = ( OMX_STATETYPE ) param;
+        c->transition = true;
+        pthread_cond_signal(&c->cond);
+        }
+
+    pthread_mutex_unlock(&c->lock);
+
+    return ret;
+}
+
+static OMX_ERRORTYPE stubGetParameter(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR param)
+{
+    StubComponent *c = stub(handle);
+
+    if ( OMX_IndexParamImageInit == index )
+        {
+        OMX_PORT_PARAM_TYPE *ports = ( OMX_PORT_PARAM_TYPE * ) param;
+
+        ports->nPorts = STUB_PORTS;
+        ports->nStartPortNumber = 0;
+
+        return OMX_ErrorNone;
+        }
+
+    if ( OMX_IndexParamPortDefinition == index )
+        {
+        OMX_PARAM_PORTDEFINITIONTYPE *def = ( OMX_PARAM_PORTDEFINITIONTYPE * ) param;
+
+        if ( STUB_PORTS <= def->nPortIndex )
+            {
+            return OMX_ErrorBadPortIndex;
+            }
+
+        pthread_mutex_lock(&c->lock);
+        *def = c->ports[def->nPortIndex];
+        pthread_mutex_unlock(&c->lock);
+
+        return OMX_ErrorNone;
+        }
+
+    return OMX_ErrorUnsupportedIndex;
+}
+
+static OMX_ERRORTYPE stubSetParameter(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR param)
+{
+    StubComponent *c = stub(handle);
+    OMX_PARAM_PORTDEFINITIONTYPE *def = ( OMX_PARAM_PORTDEFINITIONTYPE * ) param;
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+
+    if ( OMX_IndexParamPortDefinition != index )
+        {
+        return OMX_ErrorUnsupportedIndex;
+        }
+
+    if ( STUB_PORTS <= def->nPortIndex )
+        {
+        return OMX_ErrorBadPortIndex;
+        }
+
+    pthread_mutex_lock(&c->lock);
+
+    if ( ( OMX_StateLoaded != c->state ) || c->transition )
+        {
+        count(&sStats.violations, 1);
+        ret = OMX_ErrorIncorrectStateOperation;
+        }
+    else
+        {
+        c->ports[def->nPortIndex] = *def;
+        }
+
+    pthread_mutex_unlock(&c->lock);
+
+    return ret;
+}
+
+static OMX_ERRORTYPE stubGetExtensionIndex(OMX_HANDLETYPE handle, OMX_STRING name, OMX_INDEXTYPE *index)
+{
+    static const struct
+        {
+        const char *name;
+        int index;
+        } extensions[] =
+        {
+        { "OMX.TI.JPEG.encoder.Config.QFactor", INDEX_QFACTOR },
+        { "OMX.TI.JPEG.encoder.Config.ConversionFlag", INDEX_CONVERSION },
+        { "OMX.TI.JPEG.encoder.Config.PPLibDynParams", INDEX_PPLIB },
+        { "OMX.TI.JPEG.encoder.Config.APP1", INDEX_APP1 },
+        };
+
+    for ( size_t i = 0 ; i < sizeof(extensions) / sizeof(extensions[0]) ; i++ )
+        {
+        if ( 0 == strcmp(name, extensions[i].name) )
+            {
+            *index = ( OMX_INDEXTYPE ) extensions[i].index;
+            return OMX_ErrorNone;
+            }
+        }
+
+    return OMX_ErrorUnsupportedIndex;
+}
+
+static OMX_ERRORTYPE stubGetConfig(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config)
+{
+    StubComponent *c = stub(handle);
+
+    if ( INDEX_PPLIB != ( int ) index )
+        {
+        return OMX_ErrorUnsupportedIndex;
+        }
+
+    pthread_mutex_lock(&c->lock);
+    memcpy(config, &c->pplib, sizeof(c->pplib));
+    pthread_mutex_unlock(&c->lock);
+
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE stubSetConfig(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config)
+{
+    StubComponent *c = stub(handle);
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+
+    pthread_mutex_lock(&c->lock);
+
+    switch ( ( int ) index )
+        {
+        case INDEX_QFACTOR:
+            c->quality = ( ( OMX_IMAGE_PARAM_QFACTORTYPE * ) config )->nQFactor;
+            break;
+        case INDEX_CONVERSION:
+            c->conversion = *( JPE_CONVERSION_FLAG_TYPE * ) config;
+            break;
+        case INDEX_PPLIB:
+            memcpy(&c->pplib, config, sizeof(c->pplib));
+            break;
+        case INDEX_APP1:
+            {
+            JPEG_APPTHUMB_MARKER *marker = ( JPEG_APPTHUMB_MARKER * ) config;
+
+            c->exifTag = ( 4 < marker->nMarkerSize ) ? marker->pMarkerBuffer[4] : 0;
+            break;
+            }
+        default:
+            ret = OMX_ErrorUnsupportedIndex;
+            break;
+        }
+
+    pthread_mutex_unlock(&c->lock);
+
+    return ret;
+}
+
+static OMX_ERRORTYPE stubUseBuffer(OMX_HANDLETYPE handle, OMX_BUFFERHEADERTYPE **header, OMX_U32 port,
+                                   OMX_PTR appPrivate, OMX_U32 size, OMX_U8 *buffer)
+{
+    StubComponent *c = stub(handle);
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+
+    if ( STUB_PORTS <= port )
+        {
+        return OMX_ErrorBadPortIndex;
+        }
+
+    pthread_mutex_lock(&c->lock);
+
+    if ( ( OMX_StateLoaded != c->state ) || populated(c, port) )
+        {
+        count(&sStats.violations, 1);
+        ret = OMX_ErrorIncorrectStateOperation;
+        }
+    else
+        {
+        *header = ( OMX_BUFFERHEADERTYPE * ) calloc(1, sizeof(OMX_BUFFERHEADERTYPE));
+        ( *header )->nSize = sizeof(OMX_BUFFERHEADERTYPE);
+        ( *header )->pBuffer = buffer;
+        ( *header )->nAllocLen = size;
+        ( *header )->pAppPrivate = appPrivate;
+        ( *header )->nInputPortIndex = 0;
+        ( *header )->nOutputPortIndex = 1;
+        c->populated[port]++;
+        count(&sStats.useBuffers, 1);
+        pthread_cond_signal(&c->cond);
+        }
+
+    pthread_mutex_unlock(&c->lock);
+
+    return ret;
+}
+
+static OMX_ERRORTYPE stubFreeBuffer(OMX_HANDLETYPE handle, OMX_U32 port, OMX_BUFFERHEADERTYPE *header)
+{
+    StubComponent *c = stub(handle);
+
+    if ( STUB_PORTS <= port )
+        {
+        return OMX_ErrorBadPortIndex;
+        }
+
+    pthread_mutex_lock(&c->lock);
+
+    if ( ( OMX_StateLoaded != c->state ) && ( OMX_StateInvalid != c->state ) &&
+         !( c->transition && ( OMX_StateLoaded == c->target ) ) )
+        {
+        count(&sStats.violations, 1);
+        }
+
+    free(header);
+    c->populated[port]--;
+    count(&sStats.freeBuffers, 1);
+    pthread_cond_signal(&c->cond);
+
+    pthread_mutex_unlock(&c->lock);
+
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE queueBuffer(OMX_HANDLETYPE handle, unsigned int port, OMX_BUFFERHEADERTYPE *header)
+{
+    StubComponent *c = stub(handle);
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+
+    ///Buffers are not to be queued from within a callback of the component
+    if ( pthread_equal(pthread_self(), c->thread) )
+        {
+        count(&sStats.violations, 1);
+        }
+
+    pthread_mutex_lock(&c->lock);
+
+    if ( ( OMX_StateExecuting != c->state ) || ( STUB_QUEUE == c->queued[port] ) )
+        {
+        count(&sStats.violations, 1);
+        ret = OMX_ErrorIncorrectStateOperation;
+        }
+    else
+        {
+        c->queues[port][c->queued[port]++] = header;
+        if ( 0 == port )
+            {
+            count(&sBusy, 1);
+            }
+        pthread_cond_signal(&c->cond);
+        }
+
+    pthread_mutex_unlock(&c->lock);
+
+    return ret;
+}
+
+static OMX_ERRORTYPE stubEmptyThisBuffer(OMX_HANDLETYPE handle, OMX_BUFFERHEADERTYPE *header)
+{
+    return queueBuffer(handle, 0, header);
+}
+
+static OMX_ERRORTYPE stubFillThisBuffer(OMX_HANDLETYPE handle, OMX_BUFFERHEADERTYPE *header)
+{
+    return queueBuffer(handle, 1, header);
+}
+
+OMX_ERRORTYPE TIOMX_Init(void)
+{
+    count(&sStats.initRefs, 1);
+
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE TIOMX_Deinit(void)
+{
+    count(&sStats.initRefs, -1);
+
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE TIOMX_GetHandle(OMX_HANDLETYPE *handle, OMX_STRING name, OMX_PTR appData, OMX_CALLBACKTYPE *callbacks)
+{
+    StubComponent *c;
+
+    if ( 0 != strcmp(name, "OMX.TI.JPEG.encoder") )
+        {
+        return OMX_ErrorComponentNotFound;
+        }
+
+    c = ( StubComponent * ) calloc(1, sizeof(StubComponent));
+    if ( NULL == c )
+        {
+        return OMX_ErrorInsufficientResources;
+        }
+
+    c->omx.nSize = sizeof(OMX_COMPONENTTYPE);
+    c->omx.pComponentPrivate = c;
+    c->omx.pApplicationPrivate = appData;
+    c->omx.SendCommand = stubSendCommand;
+    c->omx.GetParameter = stubGetParameter;
+    c->omx.SetParameter = stubSetParameter;
+    c->omx.GetConfig = stubGetConfig;
+    c->omx.SetConfig = stubSetConfig;
+    c->omx.GetExtensionIndex = stubGetExtensionIndex;
+    c->omx.UseBuffer = stubUseBuffer;
+    c->omx.FreeBuffer = stubFreeBuffer;
+    c->omx.EmptyThisBuffer = stubEmptyThisBuffer;
+    c->omx.FillThisBuffer = stubFillThisBuffer;
+    c->callbacks = *callbacks;
+    c->appData = appData;
+    c->state = OMX_StateLoaded;
+
+    for ( unsigned int i = 0 ; i < STUB_PORTS ; i++ )
+        {
+        c->ports[i].nSize = sizeof(OMX_PARAM_PORTDEFINITIONTYPE);
+        c->ports[i].nPortIndex = i;
+        c->ports[i].eDir = ( 0 == i ) ? OMX_DirInput : OMX_DirOutput;
+        c->ports[i].nBufferCountActual = 1;
+        c->ports[i].nBufferCountMin = 1;
+        }
+
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->cond, NULL);
+    pthread_create(&c->thread, NULL, worker, c);
+
+    count(&sStats.getHandles, 1);
+    *handle = &c->omx;
+
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE TIOMX_FreeHandle(OMX_HANDLETYPE handle)
+{
+    StubComponent *c = stub(handle);
+
+    pthread_mutex_lock(&c->lock);
+    if ( ( ( OMX_StateLoaded != c->state ) && ( OMX_StateInvalid != c->state ) ) ||
+         c->populated[0] || c->populated[1] )
+        {
+        count(&sStats.violations, 1);
+        }
+    c->exit = true;
+    pthread_cond_signal(&c->cond);
+    pthread_mutex_unlock(&c->lock);
+
+    pthread_join(c->thread, NULL);
+    pthread_cond_destroy(&c->cond);
+    pthread_mutex_destroy(&c->lock);
+    free(c);
+
+    count(&sStats.freeHandles, 1);
+
+    return OMX_ErrorNone;
+}
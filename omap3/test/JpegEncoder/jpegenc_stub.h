@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Stub of the TI OMX JPEG encoder for jpegencoder_test
+///
+///It replaces TIOMX_Init(), TIOMX_GetHandle(), TIOMX_FreeHandle() and
+///TIOMX_Deinit(). The component runs its commands and buffers on a worker
+///thread, sleeping to stand for the DSP, and checks that the OMX state machine
+///is followed, and that no buffer is queued from within one of its callbacks.
+///Like the real component it latches the EXIF and PPLib configs when it starts
+///a buffer, not when the buffer is queued.
+
+#ifndef JPEGENC_STUB_H
+#define JPEGENC_STUB_H
+
+#include <stdint.h>
+
+///Written at the start of every output buffer
+struct JpegStubOutput
+{
+    uint32_t magic;
+    uint32_t inputSum;
+    uint32_t zoomFactor;
+    uint32_t cropWidth;
+    uint32_t exifTag;
+    uint32_t quality;
+    uint32_t conversion;
+};
+
+struct JpegStubStats
+{
+    int getHandles;
+    int freeHandles;
+    int initRefs;
+    int useBuffers;
+    int freeBuffers;
+    int executing;
+    int encodes;
+    ///OMX calls made in a state that does not allow them
+    int violations;
+};
+
+#define JPEG_STUB_MAGIC 0x4A504547
+
+class JpegEncoderStub
+{
+public:
+
+    ///Clears the statistics and sets the simulated costs, in microseconds
+    static void reset(unsigned int encodeUs, unsigned int transitionUs);
+
+    ///The next buffer ends with an OMX_EventError instead of an image
+    static void failNextEncode();
+
+    static JpegStubStats getStats();
+
+    ///True while a buffer is queued to or held by the component
+    static bool isBusy();
+
+    ///Size of the image written for an input checksum
+    static uint32_t outputSize(uint32_t inputSum);
+};
+
+#endif //JPEGENC_STUB_H
@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///JpegEncoder session and pipeline checks, against the stub OMX component of
+///jpegenc_stub.cpp
+///
+///Usage: jpegencoder_test
+///
+///Also prints the latency breakdown of a burst, as logged by the encoder.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "JpegEncoder.h"
+#include "jpegenc_stub.h"
+#include "TestCheck.h"
+
+#define WIDTH       64
+#define HEIGHT      48
+#define IN_SIZE     ( WIDTH * HEIGHT * 2 )
+#define OUT_SIZE    4096
+#define ENCODE_US   2000
+#define SETUP_US    1000
+
+struct Shot
+{
+    uint8_t input[IN_SIZE];
+    uint8_t output[OUT_SIZE * 2];
+    uint8_t exifData[8];
+    exif_buffer exif;
+    uint32_t inputSum;
+};
+
+struct Settings
+{
+    int quality;
+    int rotation;
+    float zoom;
+    int cropWidth;
+    int outSize;
+};
+
+static const Settings sDefault = { 90, 0, 1.0f, WIDTH, OUT_SIZE };
+
+static void makeShot(Shot *shot, int n)
+{
+    memset(shot, 0, sizeof(Shot));
+    shot->inputSum = 0;
+    for ( int i = 0 ; i < IN_SIZE ; i++ )
+        {
+        shot->input[i] = ( i * 7 + n * 13 ) & 0xFF;
+        shot->inputSum += shot->input[i];
+        }
+
+    shot->exifData[0] = 0x40 + n;
+    shot->exif.data = shot->exifData;
+    shot->exif.size = sizeof(shot->exifData);
+}
+
+static bool queue(JpegEncoder *encoder, Shot *shot, const Settings &s)
+{
+    return encoder->queueImage(shot->output, s.outSize, shot->input, IN_SIZE, WIDTH, HEIGHT, s.quality,
+                               &shot->exif, 0, 0, 0, WIDTH, HEIGHT, s.rotation, s.zoom, 0, 0,
+                               s.cropWidth, HEIGHT);
+}
+
+static bool encode(JpegEncoder *encoder, Shot *shot, const Settings &s)
+{
+    return encoder->encodeImage(shot->output, s.outSize, shot->input, IN_SIZE, WIDTH, HEIGHT, s.quality,
+                                &shot->exif, 0, 0, 0, WIDTH, HEIGHT, s.rotation, s.zoom, 0, 0,
+                                s.cropWidth, HEIGHT);
+}
+
+///The image carries the configs of its own shot, and jpegSize its size
+static bool verify(JpegEncoder *encoder, const Shot *shot, const Settings &s)
+{
+    JpegStubOutput image;
+
+    memcpy(&image, shot->output, sizeof(image));
+
+    return ( JPEG_STUB_MAGIC == image.magic ) &&
+           ( shot->inputSum == image.inputSum ) &&
+           ( ( uint32_t ) ( s.zoom * 1024 ) == image.zoomFactor ) &&
+           ( ( ( s.cropWidth < WIDTH ) ? ( uint32_t ) s.cropWidth : 0 ) == image.cropWidth ) &&
+           ( shot->exifData[0] == image.exifTag ) &&
+           ( ( uint32_t ) s.quality == image.quality ) &&
+           ( ( int ) JpegEncoderStub::outputSize(shot->inputSum) == encoder->jpegSize );
+}
+
+///Deletes the encoder, which has to leave no handle, buffer or OMX core reference
+static bool release(JpegEncoder *encoder)
+{
+    JpegStubStats stats;
+
+    delete encoder;
+
+    stats = JpegEncoderStub::getStats();
+
+    return ( stats.getHandles == stats.freeHandles ) &&
+           ( stats.useBuffers == stats.freeBuffers ) &&
+           ( 0 == stats.initRefs ) &&
+           ( 0 == stats.violations );
+}
+
+///A burst with the same settings loads the component once
+static bool checkBurst()
+{
+    static const int shots = 5;
+    JpegEncoder *encoder = new JpegEncoder();
+    Shot *shot = new Shot;
+    JpegStubStats stats;
+    bool ok = true;
+
+    JpegEncoderStub::reset(ENCODE_US, SETUP_US);
+
+    printf("shot,setup_us,pending_us,encode_us,total_us,reconfigured\n");
+
+    for ( int i = 0 ; i < shots ; i++ )
+        {
+        makeShot(shot, i);
+        ok = ok && encode(encoder, shot, sDefault) && verify(encoder, shot, sDefault) &&
+             ( encoder->timing.reconfigured == ( 0 == i ) );
+
+        printf("%d,%u,%u,%u,%u,%d\n", i, encoder->timing.setup, encoder->timing.pending,
+               encoder->timing.encode, encoder->timing.total, encoder->timing.reconfigured);
+        }
+
+    stats = JpegEncoderStub::getStats();
+    ok = ok && ( 1 == stats.getHandles ) && ( 1 == stats.executing ) &&
+         ( 2 * JpegEncoder::PIPELINE_DEPTH == stats.useBuffers ) && ( shots == stats.encodes );
+
+    delete shot;
+
+    return release(encoder) && ok;
+}
+
+///Zoom, crop and EXIF change per shot without touching the ports
+static bool checkDynamic()
+{
+    JpegEncoder *encoder = new JpegEncoder();
+    Shot *shot = new Shot;
+    Settings s = sDefault;
+    bool ok = true;
+
+    JpegEncoderStub::reset(ENCODE_US, SETUP_US);
+
+    for ( int i = 0 ; i < 4 ; i++ )
+        {
+        s.zoom = 1.0f + i * 0.5f;
+        s.cropWidth = WIDTH - i * 8;
+        makeShot(shot, i);
+        ok = ok && encode(encoder, shot, s) && verify(encoder, shot, s);
+        }
+
+    ok = ok && ( 1 == JpegEncoderStub::getStats().getHandles );
+
+    delete shot;
+
+    return release(encoder) && ok;
+}
+
+///Quality, rotation and a larger buffer reload the component, a smaller buffer does not
+static bool checkReconfigure()
+{
+    JpegEncoder *encoder = new JpegEncoder();
+    Shot *shot = new Shot;
+    Settings s = sDefault;
+    JpegStubStats stats;
+    bool ok = true;
+
+    JpegEncoderStub::reset(ENCODE_US, SETUP_US);
+
+    makeShot(shot, 0);
+    ok = ok && encode(encoder, shot, s) && verify(encoder, shot, s);
+
+    s.quality = 70;
+    ok = ok && encode(encoder, shot, s) && verify(encoder, shot, s) && encoder->timing.reconfigured;
+    ok = ok && ( 2 == JpegEncoderStub::getStats().getHandles );
+
+    s.rotation = 90;
+    ok = ok && encode(encoder, shot, s) && verify(encoder, shot, s) && encoder->timing.reconfigured;
+    ok = ok && ( JPE_CONV_YUV422I_90ROT_YUV422I == ( ( JpegStubOutput * ) shot->output )->conversion );
+
+    s.outSize = OUT_SIZE * 2;
+    ok = ok && encode(encoder, shot, s) && verify(encoder, shot, s) && encoder->timing.reconfigured;
+
+    s.outSize = OUT_SIZE;
+    ok = ok && encode(encoder, shot, s) && verify(encoder, shot, s) && !encoder->timing.reconfigured;
+
+    stats = JpegEncoderStub::getStats();
+    ok = ok && ( 4 == stats.getHandles ) && ( 3 == stats.freeHandles ) && ( 4 == stats.executing ) &&
+         ( 3 * 2 * JpegEncoder::PIPELINE_DEPTH == stats.freeBuffers ) && ( 0 == stats.violations );
+
+    delete shot;
+
+    return release(encoder) && ok;
+}
+
+///The second shot is queued while the first one encodes, and starts without
+///the caller
+static bool checkPipeline()
+{
+    JpegEncoder *encoder = new JpegEncoder();
+    Shot *shots = new Shot[3];
+    Settings first = sDefault;
+    Settings second = sDefault;
+    bool ok = true;
+    void *output = NULL;
+
+    JpegEncoderStub::reset(ENCODE_US * 10, SETUP_US);
+
+    second.zoom = 2.0f;
+    second.cropWidth = WIDTH / 2;
+    for ( int i = 0 ; i < 3 ; i++ )
+        {
+        makeShot(&shots[i], i);
+        }
+
+    ok = ok && queue(encoder, &shots[0], first) && queue(encoder, &shots[1], second);
+    ok = ok && JpegEncoderStub::isBusy() && ( 2 == encoder->pendingImages() );
+    ok = ok && !queue(encoder, &shots[2], first);
+
+    for ( int i = 0 ; ( i < 1000 ) && ( 2 > JpegEncoderStub::getStats().encodes ) ; i++ )
+        {
+        usleep(1000);
+        }
+
+    ok = ok && encoder->dequeueImage(&output) && ( shots[0].output == output ) &&
+         verify(encoder, &shots[0], first);
+    ok = ok && encoder->dequeueImage(&output) && ( shots[1].output == output ) &&
+         verify(encoder, &shots[1], second) && ( 0 < encoder->timing.pending );
+    ok = ok && !encoder->dequeueImage(NULL) && ( 2 == JpegEncoderStub::getStats().encodes );
+
+    delete [] shots;
+
+    return release(encoder) && ok;
+}
+
+///A shot with new settings waits for the one in flight before reloading
+static bool checkReconfigureInFlight()
+{
+    JpegEncoder *encoder = new JpegEncoder();
+    Shot *shots = new Shot[2];
+    Settings first = sDefault;
+    Settings second = sDefault;
+    bool ok = true;
+
+    JpegEncoderStub::reset(ENCODE_US * 5, SETUP_US);
+
+    second.quality = 50;
+    makeShot(&shots[0], 0);
+    makeShot(&shots[1], 1);
+
+    ok = ok && queue(encoder, &shots[0], first) && queue(encoder, &shots[1], second);
+    ok = ok && encoder->dequeueImage(NULL) && verify(encoder, &shots[0], first);
+    ok = ok && encoder->dequeueImage(NULL) && verify(encoder, &shots[1], second) &&
+         encoder->timing.reconfigured;
+    ok = ok && ( 2 == JpegEncoderStub::getStats().getHandles );
+
+    delete [] shots;
+
+    return release(encoder) && ok;
+}
+
+///A component error fails the shot and the next one reloads the component
+static bool checkError()
+{
+    JpegEncoder *encoder = new JpegEncoder();
+    Shot *shot = new Shot;
+    bool ok = true;
+
+    JpegEncoderStub::reset(ENCODE_US, SETUP_US);
+
+    makeShot(shot, 0);
+    ok = ok && encode(encoder, shot, sDefault);
+
+    JpegEncoderStub::failNextEncode();
+    ok = ok && !encode(encoder, shot, sDefault) && ( 0 == encoder->jpegSize );
+
+    makeShot(shot, 1);
+    ok = ok && encode(encoder, shot, sDefault) && verify(encoder, shot, sDefault) &&
+         encoder->timing.reconfigured;
+    ok = ok && ( 2 == JpegEncoderStub::getStats().getHandles );
+
+    delete shot;
+
+    return release(encoder) && ok;
+}
+
+///Deleting the encoder lets the queued shots complete first
+static bool checkTeardown()
+{
+    JpegEncoder *encoder = new JpegEncoder();
+    Shot *shots = new Shot[2];
+    bool ok = true;
+
+    JpegEncoderStub::reset(ENCODE_US * 5, SETUP_US);
+
+    makeShot(&shots[0], 0);
+    makeShot(&shots[1], 1);
+    ok = ok && queue(encoder, &shots[0], sDefault) && queue(encoder, &shots[1], sDefault);
+
+    ok = release(encoder) && ok;
+    ok = ok && ( 2 == JpegEncoderStub::getStats().encodes );
+
+    delete [] shots;
+
+    return ok;
+}
+
+int main()
+{
+    static const TestCheck checks[] =
+        {
+        { "burst", checkBurst },
+        { "dynamic", checkDynamic },
+        { "reconfigure", checkReconfigure },
+        { "pipeline", checkPipeline },
+        { "reconfigure in flight", checkReconfigureInFlight },
+        { "error", checkError },
+        { "teardown", checkTeardown },
+        };
+
+    TEST_RUN(checks);
+
+    return testReport();
+}
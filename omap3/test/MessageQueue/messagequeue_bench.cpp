@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Throughput and latency benchmark of the libtiutils MessageQueue against
+///the previous pipe based implementation.
+///
+///Usage: messagequeue_bench [messages]
+///
+///Prints one CSV row per queue and producer count:
+///queue,producers,messages,msgs_per_sec,p50_ns,p99_ns,max_ns
+///
+///"ring-batch" drains the ring with getBatch(). The "control-*" rows report
+///the latency of sparse control messages queued behind bulk traffic, in the
+///normal and in the high priority lane.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/poll.h>
+
+#define LOG_TAG "MessageQueueBench"
+#include <utils/Log.h>
+#include <cutils/atomic.h>
+#include <Errors.h>
+
+#include "MessageQueue.h"
+
+using namespace android;
+
+#define DEFAULT_MESSAGES    100000
+#define MAX_PRODUCERS       4
+#define BATCH_SIZE          32
+#define CONTROL_MESSAGES    1000
+#define CONTROL_PERIOD_US   200
+#define CMD_DATA            1
+#define CMD_CONTROL         2
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+///Pipe based message queue, as MessageQueue was implemented before the ring
+class PipeMessageQueue
+{
+public:
+
+    PipeMessageQueue()
+        {
+        int fds[2] = {-1,-1};
+
+        if ( 0 > pipe(fds) )
+            {
+            LOGE("pipe() error: %s", strerror(errno));
+            }
+
+        fd_read = fds[0];
+        fd_write = fds[1];
+        }
+
+    ~PipeMessageQueue()
+        {
+        close(fd_read);
+        close(fd_write);
+        }
+
+    status_t get(Message *msg)
+        {
+        char *p = (char *) msg;
+        size_t bytes = 0;
+
+        while ( bytes < sizeof(*msg) )
+            {
+            int err = read(fd_read, p + bytes, sizeof(*msg) - bytes);
+
+            if ( 0 > err )
+                {
+                return UNKNOWN_ERROR;
+                }
+
+            bytes += err;
+            }
+
+        return NO_ERROR;
+        }
+
+    status_t put(Message *msg)
+        {
+        char *p = (char *) msg;
+        size_t bytes = 0;
+
+        while ( bytes < sizeof(*msg) )
+            {
+            int err = write(fd_write, p + bytes, sizeof(*msg) - bytes);
+
+            if ( 0 > err )
+                {
+                return UNKNOWN_ERROR;
+                }
+
+            bytes += err;
+            }
+
+        return NO_ERROR;
+        }
+
+    int getInFd()
+        {
+        return fd_read;
+        }
+
+private:
+
+    int fd_read;
+    int fd_write;
+};
+
+template <class Q>
+struct Producer
+{
+    Q *queue;
+    unsigned int messages;
+    unsigned int command;
+    volatile int32_t *stop;
+    volatile int32_t done;
+};
+
+template <class Q>
+static void *producerThread(void *arg)
+{
+    Producer<Q> *prod = (Producer<Q> *) arg;
+    Message msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.command = CMD_DATA;
+
+    for ( unsigned int i = 0 ; i < prod->messages ; i++ )
+        {
+        msg.id = now_ns();
+        prod->queue->put(&msg);
+        }
+
+    return NULL;
+}
+
+///Floods the queue with bulk messages until stopped
+static void *bulkThread(void *arg)
+{
+    Producer<MessageQueue> *prod = (Producer<MessageQueue> *) arg;
+    Message msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.command = CMD_DATA;
+
+    while ( !android_atomic_acquire_load(prod->stop) )
+        {
+        msg.id = now_ns();
+        prod->queue->put(&msg);
+        }
+
+    android_atomic_release_store(1, &prod->done);
+
+    return NULL;
+}
+
+///Queues sparse control messages in the lane given by command
+static void *controlThread(void *arg)
+{
+    Producer<MessageQueue> *prod = (Producer<MessageQueue> *) arg;
+    Message msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.command = CMD_CONTROL;
+
+    for ( unsigned int i = 0 ; i < prod->messages ; i++ )
+        {
+        usleep(CONTROL_PERIOD_US);
+        msg.id = now_ns();
+        prod->queue->put(&msg, (MessageQueue::Priority) prod->command);
+        }
+
+    return NULL;
+}
+
+static int compareLatency(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a;
+    int64_t y = *(const int64_t *) b;
+
+    return ( x > y ) - ( x < y );
+}
+
+///Nearest-rank percentile of a sorted sample
+static int64_t percentile(const int64_t *sorted, unsigned int count, unsigned int pct)
+{
+    unsigned int rank = ( count * pct + 99 ) / 100;
+
+    return sorted[( rank > 0 ) ? ( rank - 1 ) : 0];
+}
+
+static int reportLatency(const char *name, unsigned int producers, unsigned int total,
+                         int64_t elapsed, int64_t *latency)
+{
+    qsort(latency, total, sizeof(*latency), compareLatency);
+
+    printf("%s,%u,%u,%.0f,%lld,%lld,%lld\n", name, producers, total,
+           ( elapsed > 0 ) ? ( total * 1e9 / elapsed ) : 0.0,
+           (long long) percentile(latency, total, 50),
+           (long long) percentile(latency, total, 99),
+           (long long) latency[total - 1]);
+
+    return 0;
+}
+
+template <class Q>
+static int runCase(const char *name, unsigned int producers, unsigned int messages)
+{
+    Q queue;
+    Producer<Q> prod[MAX_PRODUCERS];
+    pthread_t threads[MAX_PRODUCERS];
+    unsigned int perProducer = messages / producers;
+    unsigned int total = perProducer * producers;
+    int64_t *latency;
+    int64_t start, elapsed;
+    Message msg;
+
+    latency = (int64_t *) malloc(total * sizeof(*latency));
+    if ( NULL == latency )
+        {
+        return -ENOMEM;
+        }
+
+    start = now_ns();
+
+    for ( unsigned int i = 0 ; i < producers ; i++ )
+        {
+        prod[i].queue = &queue;
+        prod[i].messages = perProducer;
+        prod[i].command = CMD_DATA;
+        prod[i].stop = NULL;
+        pthread_create(&threads[i], NULL, producerThread<Q>, &prod[i]);
+        }
+
+    ///Consume the way the camera HAL threads do: sleep on the descriptor, then drain
+    for ( unsigned int i = 0 ; i < total ; )
+        {
+        struct pollfd pfd;
+
+        pfd.fd = queue.getInFd();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if ( ( -1 == poll(&pfd, 1, -1) ) && ( EINTR != errno ) )
+            {
+            free(latency);
+            return -errno;
+            }
+
+        while ( ( i < total ) && ( pfd.revents & POLLIN ) )
+            {
+            if ( NO_ERROR != queue.get(&msg) )
+                {
+                free(latency);
+                return -EIO;
+                }
+
+            latency[i++] = now_ns() - msg.id;
+
+            pfd.revents = 0;
+            poll(&pfd, 1, 0);
+            }
+        }
+
+    elapsed = now_ns() - start;
+
+    for ( unsigned int i = 0 ; i < producers ; i++ )
+        {
+        pthread_join(threads[i], NULL);
+        }
+
+    reportLatency(name, producers, total, elapsed, latency);
+
+    free(latency);
+
+    return 0;
+}
+
+static int runBatchCase(const char *name, unsigned int producers, unsigned int messages)
+{
+    MessageQueue queue;
+    Producer<MessageQueue> prod[MAX_PRODUCERS];
+    pthread_t threads[MAX_PRODUCERS];
+    unsigned int perProducer = messages / producers;
+    unsigned int total = perProducer * producers;
+    Message batch[BATCH_SIZE];
+    int64_t *latency;
+    int64_t start, elapsed;
+    int ret = 0;
+
+    latency = (int64_t *) malloc(total * sizeof(*latency));
+    if ( NULL == latency )
+        {
+        return -ENOMEM;
+        }
+
+    start = now_ns();
+
+    for ( unsigned int i = 0 ; i < producers ; i++ )
+        {
+        prod[i].queue = &queue;
+        prod[i].messages = perProducer;
+        prod[i].command = CMD_DATA;
+        prod[i].stop = NULL;
+        pthread_create(&threads[i], NULL, producerThread<MessageQueue>, &prod[i]);
+        }
+
+    for ( unsigned int i = 0 ; i < total ; )
+        {
+        size_t max = ( total - i < BATCH_SIZE ) ? ( total - i ) : BATCH_SIZE;
+        int count = queue.getBatch(batch, max);
+
+        if ( 0 >= count )
+            {
+            ret = -EIO;
+            break;
+            }
+
+        int64_t now = now_ns();
+
+        for ( int j = 0 ; j < count ; j++ )
+            {
+            latency[i++] = now - batch[j].id;
+            }
+        }
+
+    elapsed = now_ns() - start;
+
+    for ( unsigned int i = 0 ; i < producers ; i++ )
+        {
+        pthread_join(threads[i], NULL);
+        }
+
+    if ( 0 == ret )
+        {
+        reportLatency(name, producers, total, elapsed, latency);
+        }
+
+    free(latency);
+
+    return ret;
+}
+
+static int runControlCase(const char *name, MessageQueue::Priority prio)
+{
+    MessageQueue queue;
+    Producer<MessageQueue> bulk, control;
+    pthread_t bulkTid, controlTid;
+    volatile int32_t stop = 0;
+    int64_t latency[CONTROL_MESSAGES];
+    int64_t start, elapsed;
+    unsigned int received = 0;
+    Message msg;
+
+    bulk.queue = &queue;
+    bulk.messages = 0;
+    bulk.command = CMD_DATA;
+    bulk.stop = &stop;
+    bulk.done = 0;
+
+    control.queue = &queue;
+    control.messages = CONTROL_MESSAGES;
+    control.command = prio;
+    control.stop = &stop;
+
+    start = now_ns();
+
+    pthread_create(&bulkTid, NULL, bulkThread, &bulk);
+    pthread_create(&controlTid, NULL, controlThread, &control);
+
+    while ( CONTROL_MESSAGES > received )
+        {
+        if ( NO_ERROR != queue.get(&msg) )
+            {
+            break;
+            }
+
+        if ( CMD_CONTROL == msg.command )
+            {
+            latency[received++] = now_ns() - msg.id;
+            }
+        }
+
+    elapsed = now_ns() - start;
+
+    android_atomic_release_store(1, &stop);
+
+    ///Keep draining so the bulk producer cannot stay blocked on a full ring
+    while ( !android_atomic_acquire_load(&bulk.done) )
+        {
+        if ( !queue.isEmpty() )
+            {
+            queue.get(&msg);
+            }
+        }
+
+    pthread_join(bulkTid, NULL);
+    pthread_join(controlTid, NULL);
+
+    if ( CONTROL_MESSAGES > received )
+        {
+        return -EIO;
+        }
+
+    return reportLatency(name, 2, received, elapsed, latency);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int messages = DEFAULT_MESSAGES;
+    int ret = 0;
+
+    if ( 1 < argc )
+        {
+        messages = strtoul(argv[1], NULL, 0);
+        if ( messages < MAX_PRODUCERS )
+            {
+            fprintf(stderr, "usage: %s [messages]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    printf("queue,producers,messages,msgs_per_sec,p50_ns,p99_ns,max_ns\n");
+
+    for ( unsigned int producers = 1 ; producers <= MAX_PRODUCERS ; producers *= 2 )
+        {
+        ret |= runCase<PipeMessageQueue>("pipe", producers, messages);
+        ret |= runCase<MessageQueue>("ring", producers, messages);
+        ret |= runBatchCase("ring-batch", producers, messages);
+        }
+
+    ret |= runControlCase("control-normal", MessageQueue::PRIORITY_NORMAL);
+    ret |= runControlCase("control-high", MessageQueue::PRIORITY_HIGH);
+
+    return ret ? 1 : 0;
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///libtiutils MessageQueue checks: ordering, priority lanes, and put() blocking
+///once a lane is full
+///
+///Usage: messagequeue_test
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/poll.h>
+
+#define LOG_TAG "MessageQueueTest"
+#include <utils/Log.h>
+#include <Errors.h>
+
+#include "MessageQueue.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+///Messages the producer of checkFullResumes() queues beyond the capacity
+#define OVERFLOW_MESSAGES   100
+#define CONSUMER_DELAY_US   50000
+
+static status_t put(MessageQueue *queue, unsigned int command,
+                    MessageQueue::Priority prio = MessageQueue::PRIORITY_NORMAL)
+{
+    Message msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.command = command;
+
+    return queue->put(&msg, prio);
+}
+
+///True if the wakeup descriptor is readable
+static bool readable(MessageQueue *queue)
+{
+    struct pollfd pfd;
+
+    pfd.fd = queue->getInFd();
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    return 1 == poll(&pfd, 1, 0);
+}
+
+///Reads count messages, which have to be first, first + 1, ...
+static bool drain(MessageQueue *queue, unsigned int first, unsigned int count)
+{
+    Message msg;
+
+    for ( unsigned int i = 0 ; i < count ; i++ )
+        {
+        if ( ( NO_ERROR != queue->get(&msg) ) || ( first + i != msg.command ) )
+            {
+            return false;
+            }
+        }
+
+    return queue->isEmpty() && !readable(queue);
+}
+
+struct BlockedPut
+{
+    MessageQueue *queue;
+    unsigned int command;
+    MessageQueue::Priority prio;
+    volatile bool done;
+    status_t ret;
+};
+
+static void *blockedPut(void *arg)
+{
+    BlockedPut *p = (BlockedPut *) arg;
+
+    p->ret = put(p->queue, p->command, p->prio);
+    p->done = true;
+
+    return NULL;
+}
+
+///Fills a lane, then checks that one more put() blocks until the consumer
+///reads and that nothing is dropped
+static bool checkFullLane(MessageQueue::Priority prio, unsigned int capacity)
+{
+    MessageQueue queue;
+    BlockedPut blocked;
+    pthread_t producer;
+    Message msg;
+    bool ok = true;
+
+    for ( unsigned int i = 0 ; ok && ( i < capacity ) ; i++ )
+        {
+        ok = ( NO_ERROR == put(&queue, i, prio) );
+        }
+
+    blocked.queue = &queue;
+    blocked.command = capacity;
+    blocked.prio = prio;
+    blocked.done = false;
+    blocked.ret = UNKNOWN_ERROR;
+    pthread_create(&producer, NULL, blockedPut, &blocked);
+
+    usleep(CONSUMER_DELAY_US);
+    ok = ok && !blocked.done;
+
+    ///Reading one message makes room for the blocked one
+    ok = ok && ( NO_ERROR == queue.get(&msg) ) && ( 0 == msg.command );
+
+    pthread_join(producer, NULL);
+
+    return ok && blocked.done && ( NO_ERROR == blocked.ret ) &&
+           readable(&queue) && drain(&queue, 1, capacity);
+}
+
+///A full normal lane blocks put() and keeps its messages
+static bool checkFullNormal()
+{
+    return checkFullLane(MessageQueue::PRIORITY_NORMAL, MessageQueue::NORMAL_CAPACITY);
+}
+
+///A full high priority lane blocks put() and keeps its messages
+static bool checkFullHigh()
+{
+    return checkFullLane(MessageQueue::PRIORITY_HIGH, MessageQueue::HIGH_CAPACITY);
+}
+
+///The high priority lane fills up on its own, the normal one is not affected
+static bool checkHighSeparate()
+{
+    MessageQueue queue;
+    Message msg;
+    bool ok = true;
+
+    for ( unsigned int i = 0 ; ok && ( i < MessageQueue::HIGH_CAPACITY ) ; i++ )
+        {
+        ok = ( NO_ERROR == put(&queue, i, MessageQueue::PRIORITY_HIGH) );
+        }
+
+    ok = ok && ( NO_ERROR == put(&queue, 1000) ) && queue.hasPriorityMsg();
+
+    for ( unsigned int i = 0 ; ok && ( i < MessageQueue::HIGH_CAPACITY ) ; i++ )
+        {
+        ok = ( NO_ERROR == queue.get(&msg) ) && ( i == msg.command );
+        }
+
+    ok = ok && !queue.hasPriorityMsg() && drain(&queue, 1000, 1);
+
+    return ok;
+}
+
+static void *overflowProducer(void *arg)
+{
+    MessageQueue *queue = (MessageQueue *) arg;
+    status_t ret = NO_ERROR;
+
+    for ( unsigned int i = 0 ;
+          ( NO_ERROR == ret ) && ( i < MessageQueue::NORMAL_CAPACITY + OVERFLOW_MESSAGES ) ;
+          i++ )
+        {
+        ret = put(queue, i);
+        }
+
+    return (void *) (intptr_t) ret;
+}
+
+///A producer waiting on a full lane resumes once the consumer reads
+static bool checkFullResumes()
+{
+    MessageQueue queue;
+    pthread_t producer;
+    void *ret = NULL;
+    bool ok;
+
+    pthread_create(&producer, NULL, overflowProducer, &queue);
+
+    usleep(CONSUMER_DELAY_US);
+
+    ok = drain(&queue, 0, MessageQueue::NORMAL_CAPACITY + OVERFLOW_MESSAGES);
+
+    pthread_join(producer, &ret);
+
+    return ok && ( NO_ERROR == (status_t) (intptr_t) ret );
+}
+
+///getBatch() returns high priority messages first, then the rest in order
+static bool checkBatch()
+{
+    MessageQueue queue;
+    Message msgs[8];
+    bool ok = true;
+
+    ok = ( NO_ERROR == put(&queue, 1) ) && ( NO_ERROR == put(&queue, 2) ) &&
+         ( NO_ERROR == put(&queue, 0, MessageQueue::PRIORITY_HIGH) );
+
+    ok = ok && ( 3 == queue.getBatch(msgs, 8) ) &&
+         ( 0 == msgs[0].command ) && ( 1 == msgs[1].command ) && ( 2 == msgs[2].command );
+
+    ok = ok && queue.isEmpty() && !readable(&queue);
+
+    return ok;
+}
+
+int main()
+{
+    static const TestCheck checks[] =
+        {
+        { "full normal lane", checkFullNormal },
+        { "full high priority lane", checkFullHigh },
+        { "separate high priority lane", checkHighSeparate },
+        { "full lane resumes", checkFullResumes },
+        { "batch", checkBatch },
+        };
+
+    TEST_RUN(checks);
+
+    return testReport();
+}
@@ -0,0 +1,30 @@
+ifdef BOARD_USES_TI_CAMERA_HAL
+ifeq ($(TARGET_BOARD_PLATFORM),omap4)
+
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	omx3a_transaction_test.cpp \
+	../../camera-omap4/src/OMXCameraAdapter/OMX3ATransaction.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/camera-omap4/inc/OMXCameraAdapter \
+	hardware/ti/omap4/omap3/libtiutils \
+	hardware/ti/omap4/omx/ducati/domx/system/omx_core/inc \
+	hardware/ti/omap4/omap3/test
+
+LOCAL_MODULE:= omx3a_transaction_test
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2 -DTARGET_OMAP4
+
+include $(BUILD_EXECUTABLE)
+
+endif
+endif
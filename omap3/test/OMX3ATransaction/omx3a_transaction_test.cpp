@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///OMX3ATransaction checks against a mock OMX component
+///
+///Usage: omx3a_transaction_test
+///
+///The mock keeps the last value set for every config and records the
+///SetConfig()/GetConfig() calls, so that each case can check both what the
+///component ends up with and how many round trips it took.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "OMX3ATransaction.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+#define MAX_CALLS       64
+
+#define INIT_CONFIG(cfg, type, port) \
+    memset(&(cfg), 0, sizeof(type)); \
+    (cfg).nSize = sizeof(type); \
+    (cfg).nVersion.s.nVersionMajor = 0x1; \
+    (cfg).nVersion.s.nVersionMinor = 0x1; \
+    (cfg).nPortIndex = (port)
+
+struct MockCall
+{
+    bool set;
+    OMX_INDEXTYPE index;
+};
+
+struct MockComponent
+{
+    OMX_COMPONENTTYPE component;
+    OMX_CONFIG_EXPOSUREVALUETYPE exposure;
+    OMX_CONFIG_WHITEBALCONTROLTYPE whiteBalance;
+    OMX_CONFIG_IMAGEFILTERTYPE filter;
+    ///Setting the image filter also sets the EV compensation, like a scene
+    ///mode sets up the exposure values
+    bool filterSetsExposure;
+    MockCall calls[MAX_CALLS];
+    unsigned int count;
+    unsigned int sets;
+    unsigned int gets;
+};
+
+static OMX_PTR mockConfig(MockComponent *mock, OMX_INDEXTYPE index, OMX_U32 *size)
+{
+    switch ( index )
+        {
+        case OMX_IndexConfigCommonExposureValue:
+            *size = sizeof(mock->exposure);
+            return &mock->exposure;
+        case OMX_IndexConfigCommonWhiteBalance:
+            *size = sizeof(mock->whiteBalance);
+            return &mock->whiteBalance;
+        case OMX_IndexConfigCommonImageFilter:
+            *size = sizeof(mock->filter);
+            return &mock->filter;
+        default:
+            return NULL;
+        }
+}
+
+static OMX_ERRORTYPE mockAccess(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config, bool set)
+{
+    MockComponent *mock = ( MockComponent * ) ( ( OMX_COMPONENTTYPE * ) handle )->pComponentPrivate;
+    OMX_U32 size;
+    OMX_PTR stored = mockConfig(mock, index, &size);
+
+    if ( mock->count < MAX_CALLS )
+        {
+        mock->calls[mock->count].set = set;
+        mock->calls[mock->count].index = index;
+        mock->count++;
+        }
+
+    if ( NULL == stored )
+        {
+        return OMX_ErrorUnsupportedIndex;
+        }
+
+    if ( set )
+        {
+        memcpy(stored, config, size);
+        mock->sets++;
+
+        if ( mock->filterSetsExposure && ( OMX_IndexConfigCommonImageFilter == index ) )
+            {
+            mock->exposure.xEVCompensation = 5 << 16;
+            }
+        }
+    else
+        {
+        memcpy(config, stored, size);
+        mock->gets++;
+        }
+
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE mockSetConfig(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config)
+{
+    return mockAccess(handle, index, config, true);
+}
+
+static OMX_ERRORTYPE mockGetConfig(OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config)
+{
+    return mockAccess(handle, index, config, false);
+}
+
+static void mockInit(MockComponent *mock)
+{
+    memset(mock, 0, sizeof(*mock));
+    mock->component.pComponentPrivate = mock;
+    mock->component.SetConfig = mockSetConfig;
+    mock->component.GetConfig = mockGetConfig;
+
+    INIT_CONFIG(mock->exposure, OMX_CONFIG_EXPOSUREVALUETYPE, 1);
+    INIT_CONFIG(mock->whiteBalance, OMX_CONFIG_WHITEBALCONTROLTYPE, 1);
+    INIT_CONFIG(mock->filter, OMX_CONFIG_IMAGEFILTERTYPE, 1);
+    mock->exposure.bAutoSensitivity = OMX_TRUE;
+    mock->whiteBalance.eWhiteBalControl = OMX_WhiteBalControlAuto;
+}
+
+static void mockReset(MockComponent *mock)
+{
+    mock->count = 0;
+    mock->sets = 0;
+    mock->gets = 0;
+}
+
+///EV compensation and ISO both read and write the exposure value config
+static bool checkSharedConfig()
+{
+    MockComponent mock;
+    OMX3ATransaction transaction;
+    OMX_HANDLETYPE handle;
+    OMX_CONFIG_EXPOSUREVALUETYPE exp;
+    OMX_ERRORTYPE ret;
+
+    mockInit(&mock);
+    handle = ( OMX_HANDLETYPE ) &mock.component;
+
+    transaction.begin(handle);
+
+    INIT_CONFIG(exp, OMX_CONFIG_EXPOSUREVALUETYPE, 1);
+    transaction.getConfig(handle, OMX_IndexConfigCommonExposureValue, &exp);
+    exp.xEVCompensation = 2 << 16;
+    transaction.setConfig(handle, OMX_IndexConfigCommonExposureValue, &exp);
+
+    INIT_CONFIG(exp, OMX_CONFIG_EXPOSUREVALUETYPE, 1);
+    transaction.getConfig(handle, OMX_IndexConfigCommonExposureValue, &exp);
+    if ( ( 2 << 16 ) != exp.xEVCompensation )
+        {
+        ///The second read has to see the staged EV
+        transaction.commit();
+        return false;
+        }
+    exp.bAutoSensitivity = OMX_FALSE;
+    exp.nSensitivity = 400;
+    transaction.setConfig(handle, OMX_IndexConfigCommonExposureValue, &exp);
+
+    if ( 0 != mock.sets )
+        {
+        transaction.commit();
+        return false;
+        }
+
+    ret = transaction.commit();
+
+    return ( OMX_ErrorNone == ret ) &&
+           ( 1 == mock.gets ) && ( 1 == mock.sets ) &&
+           ( 4 == transaction.requested() ) && ( 2 == transaction.issued() ) &&
+           ( ( 2 << 16 ) == mock.exposure.xEVCompensation ) &&
+           ( OMX_FALSE == mock.exposure.bAutoSensitivity ) &&
+           ( 400 == mock.exposure.nSensitivity );
+}
+
+///Writing back the value just read from the component is not sent
+static bool checkUnchangedDropped()
+{
+    MockComponent mock;
+    OMX3ATransaction transaction;
+    OMX_HANDLETYPE handle;
+    OMX_CONFIG_WHITEBALCONTROLTYPE wb;
+
+    mockInit(&mock);
+    handle = ( OMX_HANDLETYPE ) &mock.component;
+
+    transaction.begin(handle);
+
+    INIT_CONFIG(wb, OMX_CONFIG_WHITEBALCONTROLTYPE, 1);
+    transaction.getConfig(handle, OMX_IndexConfigCommonWhiteBalance, &wb);
+    transaction.setConfig(handle, OMX_IndexConfigCommonWhiteBalance, &wb);
+
+    transaction.commit();
+
+    return ( 1 == mock.gets ) && ( 0 == mock.sets );
+}
+
+///Repeated writes of a config keep the last value and the first-touch order
+static bool checkLastWriteWins()
+{
+    MockComponent mock;
+    OMX3ATransaction transaction;
+    OMX_HANDLETYPE handle;
+    OMX_CONFIG_WHITEBALCONTROLTYPE wb;
+    OMX_CONFIG_IMAGEFILTERTYPE filter;
+
+    mockInit(&mock);
+    handle = ( OMX_HANDLETYPE ) &mock.component;
+
+    transaction.begin(handle);
+
+    INIT_CONFIG(wb, OMX_CONFIG_WHITEBALCONTROLTYPE, 1);
+    wb.eWhiteBalControl = OMX_WhiteBalControlSunLight;
+    transaction.setConfig(handle, OMX_IndexConfigCommonWhiteBalance, &wb);
+
+    INIT_CONFIG(filter, OMX_CONFIG_IMAGEFILTERTYPE, 1);
+    filter.eImageFilter = OMX_ImageFilterNegative;
+    transaction.setConfig(handle, OMX_IndexConfigCommonImageFilter, &filter);
+
+    wb.eWhiteBalControl = OMX_WhiteBalControlShade;
+    transaction.setConfig(handle, OMX_IndexConfigCommonWhiteBalance, &wb);
+
+    transaction.commit();
+
+    return ( 2 == mock.sets ) && ( 2 == mock.count ) &&
+           ( OMX_IndexConfigCommonWhiteBalance == mock.calls[0].index ) &&
+           ( OMX_IndexConfigCommonImageFilter == mock.calls[1].index ) &&
+           ( OMX_WhiteBalControlShade == mock.whiteBalance.eWhiteBalControl ) &&
+           ( OMX_ImageFilterNegative == mock.filter.eImageFilter );
+}
+
+///Calls outside a transaction or to another component are not staged
+static bool checkPassThrough()
+{
+    MockComponent mock, other;
+    OMX3ATransaction transaction;
+    OMX_HANDLETYPE handle, otherHandle;
+    OMX_CONFIG_WHITEBALCONTROLTYPE wb;
+
+    mockInit(&mock);
+    mockInit(&other);
+    handle = ( OMX_HANDLETYPE ) &mock.component;
+    otherHandle = ( OMX_HANDLETYPE ) &other.component;
+
+    INIT_CONFIG(wb, OMX_CONFIG_WHITEBALCONTROLTYPE, 1);
+    wb.eWhiteBalControl = OMX_WhiteBalControlTungsten;
+    transaction.setConfig(handle, OMX_IndexConfigCommonWhiteBalance, &wb);
+    if ( ( 1 != mock.sets ) || ( 0 != transaction.requested() ) )
+        {
+        return false;
+        }
+
+    transaction.begin(handle);
+    transaction.setConfig(otherHandle, OMX_IndexConfigCommonWhiteBalance, &wb);
+    transaction.commit();
+
+    return ( 1 == other.sets ) && ( 1 == mock.sets ) &&
+           ( OMX_WhiteBalControlTungsten == other.whiteBalance.eWhiteBalControl );
+}
+
+///Unknown configs are returned as errors on commit, the others still applied
+static bool checkCommitError()
+{
+    MockComponent mock;
+    OMX3ATransaction transaction;
+    OMX_HANDLETYPE handle;
+    OMX_CONFIG_WHITEBALCONTROLTYPE wb;
+    OMX_CONFIG_BOOLEANTYPE flag;
+    OMX3ATransaction::Error errors[OMX3ATransaction::MAX_CONFIGS];
+    unsigned int count = 0;
+    OMX_ERRORTYPE ret;
+
+    mockInit(&mock);
+    handle = ( OMX_HANDLETYPE ) &mock.component;
+
+    transaction.begin(handle);
+
+    memset(&flag, 0, sizeof(flag));
+    flag.nSize = sizeof(flag);
+    flag.bEnabled = OMX_TRUE;
+    transaction.setConfig(handle, OMX_IndexConfigCommonColorEnhancement, &flag);
+
+    INIT_CONFIG(wb, OMX_CONFIG_WHITEBALCONTROLTYPE, 1);
+    wb.eWhiteBalControl = OMX_WhiteBalControlHorizon;
+    transaction.setConfig(handle, OMX_IndexConfigCommonWhiteBalance, &wb);
+
+    ret = transaction.commit(errors, &count);
+
+    return ( OMX_ErrorUnsupportedIndex == ret ) &&
+           ( 1 == count ) &&
+           ( OMX_IndexConfigCommonColorEnhancement == errors[0].mIndex ) &&
+           ( OMX_ErrorUnsupportedIndex == errors[0].mError ) &&
+           ( OMX_WhiteBalControlHorizon == mock.whiteBalance.eWhiteBalControl );
+}
+
+///A read that reaches the component sees the writes staged before it, and the
+///read-modify-write keeps what they changed
+static bool checkReadAfterWrite()
+{
+    MockComponent mock;
+    OMX3ATransaction transaction;
+    OMX_HANDLETYPE handle;
+    OMX_CONFIG_IMAGEFILTERTYPE filter;
+    OMX_CONFIG_EXPOSUREVALUETYPE exp;
+    OMX_ERRORTYPE ret;
+
+    mockInit(&mock);
+    mock.filterSetsExposure = true;
+    handle = ( OMX_HANDLETYPE ) &mock.component;
+
+    transaction.begin(handle);
+
+    ///Read before the write, this copy must not be served afterwards
+    INIT_CONFIG(exp, OMX_CONFIG_EXPOSUREVALUETYPE, 1);
+    transaction.getConfig(handle, OMX_IndexConfigCommonExposureValue, &exp);
+
+    INIT_CONFIG(filter, OMX_CONFIG_IMAGEFILTERTYPE, 1);
+    filter.eImageFilter = OMX_ImageFilterSolarize;
+    transaction.setConfig(handle, OMX_IndexConfigCommonImageFilter, &filter);
+
+    INIT_CONFIG(exp, OMX_CONFIG_EXPOSUREVALUETYPE, 1);
+    transaction.getConfig(handle, OMX_IndexConfigCommonExposureValue, &exp);
+    if ( ( 5 << 16 ) != exp.xEVCompensation )
+        {
+        transaction.commit();
+        return false;
+        }
+
+    exp.bAutoSensitivity = OMX_FALSE;
+    exp.nSensitivity = 200;
+    transaction.setConfig(handle, OMX_IndexConfigCommonExposureValue, &exp);
+
+    ret = transaction.commit();
+
+    return ( OMX_ErrorNone == ret ) &&
+           ( 2 == mock.sets ) &&
+           ( OMX_ImageFilterSolarize == mock.filter.eImageFilter ) &&
+           ( ( 5 << 16 ) == mock.exposure.xEVCompensation ) &&
+           ( 200 == mock.exposure.nSensitivity );
+}
+
+///Past MAX_CONFIGS the staged configs are sent first, then the new one
+static bool checkOverflow()
+{
+    MockComponent mock;
+    OMX3ATransaction transaction;
+    OMX_HANDLETYPE handle;
+    OMX_CONFIG_WHITEBALCONTROLTYPE wb;
+    OMX_CONFIG_IMAGEFILTERTYPE filter;
+
+    mockInit(&mock);
+    handle = ( OMX_HANDLETYPE ) &mock.component;
+
+    transaction.begin(handle);
+
+    ///Distinct ports make distinct configs
+    for ( unsigned int i = 0 ; i < OMX3ATransaction::MAX_CONFIGS ; i++ )
+        {
+        INIT_CONFIG(wb, OMX_CONFIG_WHITEBALCONTROLTYPE, 100 + i);
+        wb.eWhiteBalControl = OMX_WhiteBalControlFlash;
+        transaction.setConfig(handle, OMX_IndexConfigCommonWhiteBalance, &wb);
+        }
+
+    INIT_CONFIG(filter, OMX_CONFIG_IMAGEFILTERTYPE, 1);
+    filter.eImageFilter = OMX_ImageFilterEmboss;
+    transaction.setConfig(handle, OMX_IndexConfigCommonImageFilter, &filter);
+
+    if ( ( OMX3ATransaction::MAX_CONFIGS + 1 ) != mock.sets )
+        {
+        transaction.commit();
+        return false;
+        }
+
+    mockReset(&mock);
+    transaction.commit();
+
+    return ( 0 == mock.sets ) &&
+           ( OMX_ImageFilterEmboss == mock.filter.eImageFilter );
+}
+
+int main()
+{
+    static const TestCheck checks[] =
+        {
+        { "sharedConfig", checkSharedConfig },
+        { "unchangedDropped", checkUnchangedDropped },
+        { "lastWriteWins", checkLastWriteWins },
+        { "passThrough", checkPassThrough },
+        { "commitError", checkCommitError },
+        { "readAfterWrite", checkReadAfterWrite },
+        { "overflow", checkOverflow },
+        };
+
+    TEST_RUN(checks);
+
+    return testReport();
+}
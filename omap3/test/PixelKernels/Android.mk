@@ -0,0 +1,42 @@
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	pixelkernels_test.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libtiutils \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/libtiutils \
+	hardware/ti/omap4/omap3/test
+
+LOCAL_MODULE:= pixelkernels_test
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	pixelkernels_bench.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libtiutils \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/libtiutils
+
+LOCAL_MODULE:= pixelkernels_bench
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Throughput benchmark of the libtiutils pixel kernels at 720p and 1080p.
+///Sources have a 4096 byte stride, as preview buffers from the TILER do.
+///
+///Usage: pixelkernels_bench [iterations]
+///
+///Prints one CSV row per kernel, implementation and frame size:
+///kernel,impl,width,height,iterations,ms_per_frame,mpix_per_sec
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "PixelKernels.h"
+
+using namespace android;
+
+#define DEFAULT_ITERATIONS  200
+#define SOURCE_STRIDE       4096
+
+static const char *sImplementations[] = { "scalar", "sse2", "avx2", "neon" };
+
+static const struct
+{
+    size_t width;
+    size_t height;
+} sSizes[] = { { 1280, 720 }, { 1920, 1080 } };
+
+enum
+{
+    KERNEL_COPY_PACKED = 0,
+    KERNEL_NV12_TO_NV21,
+    KERNEL_YUV422I_TO_NV21,
+    KERNEL_COUNT
+};
+
+static const char *sKernelNames[KERNEL_COUNT] = { "copy_packed_yuv422i", "nv12_to_nv21", "yuv422i_to_nv21" };
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+///Runs one kernel over a whole frame, the way the camera HALs call it
+static void runKernel(const PixelKernels *k, int kernel, uint8_t *dst, const uint8_t *src,
+                      size_t width, size_t height)
+{
+    switch ( kernel )
+        {
+        case KERNEL_COPY_PACKED:
+            k->copyPacked(dst, src, 2 * width, height, SOURCE_STRIDE);
+            break;
+
+        case KERNEL_NV12_TO_NV21:
+            k->copyPacked(dst, src, width, height, SOURCE_STRIDE);
+            k->swapUV(dst + width * height, src + SOURCE_STRIDE * height, width, height / 2, SOURCE_STRIDE);
+            break;
+
+        case KERNEL_YUV422I_TO_NV21:
+            k->yuv422iToNV21(dst, dst + width * height, src, width, height, SOURCE_STRIDE);
+            break;
+        }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int iterations = DEFAULT_ITERATIONS;
+    size_t maxHeight = 1080;
+    uint8_t *src, *dst;
+
+    if ( 1 < argc )
+        {
+        iterations = strtoul(argv[1], NULL, 0);
+        if ( 0 == iterations )
+            {
+            fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    src = (uint8_t *) malloc(SOURCE_STRIDE * maxHeight * 2);
+    dst = (uint8_t *) malloc(1920 * maxHeight * 2);
+    if ( ( NULL == src ) || ( NULL == dst ) )
+        {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+        }
+
+    for ( size_t i = 0 ; i < SOURCE_STRIDE * maxHeight * 2 ; i++ )
+        {
+        src[i] = rand() & 0xFF;
+        }
+    memset(dst, 0, 1920 * maxHeight * 2);
+
+    printf("kernel,impl,width,height,iterations,ms_per_frame,mpix_per_sec\n");
+
+    for ( int kernel = 0 ; kernel < KERNEL_COUNT ; kernel++ )
+        {
+        for ( size_t s = 0 ; s < sizeof(sSizes) / sizeof(sSizes[0]) ; s++ )
+            {
+            for ( size_t i = 0 ; i < sizeof(sImplementations) / sizeof(sImplementations[0]) ; i++ )
+                {
+                const PixelKernels *k = PixelKernels::get(sImplementations[i]);
+                size_t width = sSizes[s].width;
+                size_t height = sSizes[s].height;
+
+                if ( NULL == k )
+                    {
+                    continue;
+                    }
+
+                ///Warm up the caches and the page tables
+                runKernel(k, kernel, dst, src, width, height);
+
+                int64_t start = now_ns();
+
+                for ( unsigned int n = 0 ; n < iterations ; n++ )
+                    {
+                    runKernel(k, kernel, dst, src, width, height);
+                    }
+
+                int64_t elapsed = now_ns() - start;
+                double msPerFrame = elapsed / 1e6 / iterations;
+
+                printf("%s,%s,%u,%u,%u,%.3f,%.1f\n", sKernelNames[kernel], k->name,
+                       (unsigned int) width, (unsigned int) height, iterations, msPerFrame,
+                       ( width * height ) / ( msPerFrame * 1e3 ));
+                }
+            }
+        }
+
+    free(src);
+    free(dst);
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Bit-exactness tests of the libtiutils pixel kernels. Every implementation
+///supported by the CPU is checked against a per-pixel reference on odd sizes,
+///padded strides and unaligned buffers.
+///
+///Usage: pixelkernels_test
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PixelKernels.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+static const char *sImplementations[] = { "scalar", "sse2", "avx2", "neon" };
+
+static const size_t sWidths[] = { 2, 4, 14, 16, 18, 30, 32, 34, 62, 64, 66, 96, 176, 322, 640 };
+static const size_t sHeights[] = { 1, 2, 3, 4, 7, 16 };
+
+///Guard bytes written after each destination buffer to catch overruns
+#define GUARD_SIZE  64
+#define GUARD_BYTE  0xA5
+
+static void fillRandom(uint8_t *buf, size_t size)
+{
+    for ( size_t i = 0 ; i < size ; i++ )
+        {
+        buf[i] = rand() & 0xFF;
+        }
+}
+
+///Allocates size bytes starting at an odd offset, followed by guard bytes
+static uint8_t *allocBuffer(size_t size, uint8_t **base)
+{
+    *base = (uint8_t *) malloc(size + GUARD_SIZE + 1);
+    if ( NULL == *base )
+        {
+        return NULL;
+        }
+
+    memset(*base, GUARD_BYTE, size + GUARD_SIZE + 1);
+
+    return *base + 1;
+}
+
+static bool guardIntact(const uint8_t *buf, size_t size)
+{
+    for ( size_t i = 0 ; i < GUARD_SIZE ; i++ )
+        {
+        if ( GUARD_BYTE != buf[size + i] )
+            {
+            return false;
+            }
+        }
+
+    return true;
+}
+
+static bool checkCopyPacked(const PixelKernels *k, size_t width, size_t height, size_t stride)
+{
+    uint8_t *srcBase, *dstBase;
+    uint8_t *src = allocBuffer(stride * height, &srcBase);
+    uint8_t *dst = allocBuffer(width * height, &dstBase);
+    bool ok;
+
+    fillRandom(src, stride * height);
+    k->copyPacked(dst, src, width, height, stride);
+
+    ok = guardIntact(dst, width * height);
+    for ( size_t y = 0 ; ok && ( y < height ) ; y++ )
+        {
+        ok = ( 0 == memcmp(dst + y * width, src + y * stride, width) );
+        }
+
+    free(srcBase);
+    free(dstBase);
+
+    return ok;
+}
+
+static bool checkSwapUV(const PixelKernels *k, size_t width, size_t height, size_t stride)
+{
+    uint8_t *srcBase, *dstBase;
+    uint8_t *src = allocBuffer(stride * height, &srcBase);
+    uint8_t *dst = allocBuffer(width * height, &dstBase);
+    bool ok;
+
+    fillRandom(src, stride * height);
+    k->swapUV(dst, src, width, height, stride);
+
+    ok = guardIntact(dst, width * height);
+    for ( size_t y = 0 ; ok && ( y < height ) ; y++ )
+        {
+        for ( size_t x = 0 ; ok && ( x < width ) ; x += 2 )
+            {
+            ok = ( dst[y * width + x] == src[y * stride + x + 1] ) &&
+                 ( dst[y * width + x + 1] == src[y * stride + x] );
+            }
+        }
+
+    free(srcBase);
+    free(dstBase);
+
+    return ok;
+}
+
+static bool checkYuv422iToNV21(const PixelKernels *k, size_t width, size_t height, size_t stride)
+{
+    size_t chromaRows = ( height + 1 ) / 2;
+    uint8_t *srcBase, *yBase, *vuBase;
+    uint8_t *src = allocBuffer(stride * height, &srcBase);
+    uint8_t *dstY = allocBuffer(width * height, &yBase);
+    uint8_t *dstVU = allocBuffer(width * chromaRows, &vuBase);
+    bool ok;
+
+    fillRandom(src, stride * height);
+    k->yuv422iToNV21(dstY, dstVU, src, width, height, stride);
+
+    ok = guardIntact(dstY, width * height) && guardIntact(dstVU, width * chromaRows);
+
+    for ( size_t y = 0 ; ok && ( y < height ) ; y++ )
+        {
+        for ( size_t x = 0 ; ok && ( x < width ) ; x++ )
+            {
+            ok = ( dstY[y * width + x] == src[y * stride + 2 * x] );
+            }
+        }
+
+    for ( size_t y = 0 ; ok && ( y < chromaRows ) ; y++ )
+        {
+        const uint8_t *r0 = src + 2 * y * stride;
+        const uint8_t *r1 = ( 2 * y + 1 < height ) ? ( r0 + stride ) : r0;
+
+        for ( size_t x = 0 ; ok && ( x < width ) ; x += 2 )
+            {
+            unsigned int u = ( r0[2 * x + 1] + r1[2 * x + 1] + 1 ) / 2;
+            unsigned int v = ( r0[2 * x + 3] + r1[2 * x + 3] + 1 ) / 2;
+
+            ok = ( dstVU[y * width + x] == v ) && ( dstVU[y * width + x + 1] == u );
+            }
+        }
+
+    free(srcBase);
+    free(yBase);
+    free(vuBase);
+
+    return ok;
+}
+
+int main()
+{
+    srand(1);
+
+    for ( size_t i = 0 ; i < sizeof(sImplementations) / sizeof(sImplementations[0]) ; i++ )
+        {
+        const PixelKernels *k = PixelKernels::get(sImplementations[i]);
+
+        if ( NULL == k )
+            {
+            printf("%s: not supported, skipped\n", sImplementations[i]);
+            continue;
+            }
+
+        for ( size_t w = 0 ; w < sizeof(sWidths) / sizeof(sWidths[0]) ; w++ )
+            {
+            for ( size_t h = 0 ; h < sizeof(sHeights) / sizeof(sHeights[0]) ; h++ )
+                {
+                size_t width = sWidths[w];
+                size_t height = sHeights[h];
+                size_t pad = ( w + h ) % 3 ? 2 * ( rand() % 32 ) : 0;
+
+                testExpect(checkCopyPacked(k, width, height, width + pad + ( pad & 1 )),
+                           "%s: copyPacked %ux%u stride pad %u",
+                           k->name, (unsigned int) width, (unsigned int) height, (unsigned int) pad);
+                testExpect(checkSwapUV(k, width, height, width + pad),
+                           "%s: swapUV %ux%u stride pad %u",
+                           k->name, (unsigned int) width, (unsigned int) height, (unsigned int) pad);
+                testExpect(checkYuv422iToNV21(k, width, height, 2 * width + pad),
+                           "%s: yuv422iToNV21 %ux%u stride pad %u",
+                           k->name, (unsigned int) width, (unsigned int) height, (unsigned int) pad);
+                }
+            }
+
+        printf("%s: done\n", k->name);
+        }
+
+    return testReport();
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Pass/fail bookkeeping shared by the unit tests under omap3/test
+///
+///Every test is a single translation unit, so the counters are file statics.
+///A test either runs a table of named checks through TEST_RUN() or counts
+///individual results with testExpect(), and returns testReport() from main().
+
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <stdarg.h>
+#include <stdio.h>
+
+///A named check, returns true on success
+struct TestCheck
+{
+    const char *name;
+    bool (*check)();
+};
+
+static int sTestPassed;
+static int sTestFailed;
+
+///Counts one result, printing the printf style description followed by
+///FAILED when ok is false
+static inline bool testExpect(bool ok, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+
+static inline bool testExpect(bool ok, const char *fmt, ...)
+{
+    va_list args;
+
+    if ( ok )
+        {
+        sTestPassed++;
+        }
+    else
+        {
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+        printf(" FAILED\n");
+        sTestFailed++;
+        }
+
+    return ok;
+}
+
+///Runs count checks in order
+static inline void testRun(const TestCheck *checks, size_t count)
+{
+    for ( size_t i = 0 ; i < count ; i++ )
+        {
+        testExpect(checks[i].check(), "%s", checks[i].name);
+        }
+}
+
+#define TEST_RUN(checks) testRun(checks, sizeof(checks) / sizeof(checks[0]))
+
+///Prints the totals and returns the exit code of the test
+static inline int testReport()
+{
+    printf("%d passed, %d failed\n", sTestPassed, sTestFailed);
+
+    return sTestFailed ? 1 : 0;
+}
+
+#endif
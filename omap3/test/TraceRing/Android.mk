@@ -0,0 +1,23 @@
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	tracering_test.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libtiutils \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/libtiutils \
+	frameworks/base/include/utils \
+	hardware/ti/omap4/omap3/test
+
+LOCAL_MODULE:= tracering_test
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///TraceRing checks and trace point cost
+///
+///Usage: tracering_test [trace file]
+///
+///Several threads record begin/end pairs, counters and async events while the
+///drain thread writes them out. The resulting Chrome trace file is read back:
+///every recorded event must be either in the file or counted as dropped, the
+///timestamps of a thread must not go back, and the begin/end pairs of a thread
+///must match. The cost of a trace point with tracing stopped and running is
+///printed last.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "TraceRing.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+#define DEFAULT_TRACE_FILE  "/data/local/tmp/tracering_test.json"
+#define THREADS             4
+#define ITERATIONS          1000
+#define COST_EVENTS         200000
+#define MAX_TIDS            64
+
+enum
+{
+    TEST_STEP,
+    TEST_COUNTER,
+    TEST_ASYNC,
+    TEST_MAX
+};
+
+static const char * const sNames[TEST_MAX] = { "step", "counter", "async" };
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void *recordThread(void *arg)
+{
+    int cookie = (int) (long) arg;
+
+    for ( int i = 0 ; i < ITERATIONS ; i++ )
+        {
+        TRACE_BEGIN(TEST_STEP);
+        TRACE_COUNTER(TEST_COUNTER, i);
+        TRACE_END(TEST_STEP);
+
+        ///Stay well below what the drain thread takes out of a ring per period
+        usleep(1000);
+        }
+
+    TRACE_ASYNC_END(TEST_ASYNC, cookie);
+
+    return NULL;
+}
+
+struct ThreadStats
+{
+    int tid;
+    double lastTs;
+    int depth;
+    bool ordered;
+    bool named;
+};
+
+static ThreadStats *findThread(ThreadStats *stats, unsigned int *count, int tid)
+{
+    for ( unsigned int i = 0 ; i < *count ; i++ )
+        {
+        if ( stats[i].tid == tid )
+            {
+            return &stats[i];
+            }
+        }
+
+    if ( MAX_TIDS <= *count )
+        {
+        return NULL;
+        }
+
+    memset(&stats[*count], 0, sizeof(stats[*count]));
+    stats[*count].tid = tid;
+    stats[*count].ordered = true;
+
+    return &stats[( *count )++];
+}
+
+///Reads the trace back, one event per line as written by TraceRing
+static bool checkTrace(const char *path, unsigned int recorded, unsigned int dropped)
+{
+    ThreadStats stats[MAX_TIDS];
+    unsigned int threads = 0;
+    unsigned int events = 0;
+    unsigned int asyncEnds = 0;
+    bool balanced = true;
+    bool ordered = true;
+    char line[512];
+    FILE *f;
+
+    f = fopen(path, "r");
+    if ( NULL == f )
+        {
+        printf("unable to read %s\n", path);
+        return false;
+        }
+
+    if ( ( NULL == fgets(line, sizeof(line), f) ) || ( 0 != strcmp(line, "[\n") ) )
+        {
+        printf("trace does not start a JSON array\n");
+        fclose(f);
+        return false;
+        }
+
+    while ( NULL != fgets(line, sizeof(line), f) )
+        {
+        const char *ph = strstr(line, "\"ph\":\"");
+        const char *ts = strstr(line, "\"ts\":");
+        const char *tid = strstr(line, "\"tid\":");
+        ThreadStats *thread;
+
+        if ( 0 == strcmp(line, "]\n") )
+            {
+            break;
+            }
+
+        if ( ( NULL == ph ) || ( NULL == tid ) )
+            {
+            continue;
+            }
+
+        thread = findThread(stats, &threads, atoi(tid + 6));
+        if ( NULL == thread )
+            {
+            continue;
+            }
+
+        if ( 'M' == ph[6] )
+            {
+            thread->named = true;
+            continue;
+            }
+
+        events++;
+
+        if ( NULL != ts )
+            {
+            double t = atof(ts + 5);
+            if ( t < thread->lastTs )
+                {
+                thread->ordered = false;
+                }
+            thread->lastTs = t;
+            }
+
+        switch ( ph[6] )
+            {
+            case 'B':
+                thread->depth++;
+                break;
+            case 'E':
+                thread->depth--;
+                break;
+            case 'e':
+                asyncEnds++;
+                break;
+            default:
+                break;
+            }
+        }
+
+    fclose(f);
+
+    for ( unsigned int i = 0 ; i < threads ; i++ )
+        {
+        ordered = ordered && stats[i].ordered;
+        ///A dropped end leaves its begin open
+        balanced = balanced && ( ( 0 == stats[i].depth ) || ( 0 < dropped ) );
+        }
+
+    printf("recorded %u, written %u, dropped %u, threads %u\n", recorded, events, dropped, threads);
+
+    return ( events + dropped == recorded ) && ordered && balanced &&
+           ( ( THREADS == asyncEnds ) || ( 0 < dropped ) );
+}
+
+static double costPerEvent()
+{
+    int64_t start = now_ns();
+
+    for ( int i = 0 ; i < COST_EVENTS ; i++ )
+        {
+        TRACE_COUNTER(TEST_COUNTER, i);
+        }
+
+    return ( double ) ( now_ns() - start ) / COST_EVENTS;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = ( 1 < argc ) ? argv[1] : DEFAULT_TRACE_FILE;
+    pthread_t threads[THREADS];
+    unsigned int recorded;
+    double stoppedCost, runningCost;
+
+    TraceRing::setEventNames(sNames, TEST_MAX);
+
+    ///Nothing is recorded while stopped
+    stoppedCost = costPerEvent();
+
+    if ( NO_ERROR != TraceRing::start(path) )
+        {
+        printf("unable to trace to %s\n", path);
+        return 1;
+        }
+
+    testExpect(ALREADY_EXISTS == TraceRing::start(path), "second start");
+
+    for ( int i = 0 ; i < THREADS ; i++ )
+        {
+        TRACE_ASYNC_BEGIN(TEST_ASYNC, i);
+        pthread_create(&threads[i], NULL, recordThread, (void *) (long) i);
+        }
+
+    for ( int i = 0 ; i < THREADS ; i++ )
+        {
+        pthread_join(threads[i], NULL);
+        }
+
+    recorded = THREADS * ( 1 + ITERATIONS * 3 + 1 );
+
+    TraceRing::stop();
+
+    testExpect(checkTrace(path, recorded, TraceRing::dropped()), "trace contents");
+
+    ///Running cost, the ring of this thread overflows and drops most of these
+    TraceRing::start(path);
+    runningCost = costPerEvent();
+    TraceRing::stop();
+
+    testExpect(NO_INIT == TraceRing::stop(), "second stop");
+
+    printf("trace point cost: %.1f ns stopped, %.1f ns tracing\n", stoppedCost, runningCost);
+
+    return testReport();
+}
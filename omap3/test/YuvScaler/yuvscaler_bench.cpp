@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Throughput benchmark of the libtiutils CPU scaler, VGA through 5MP.
+///
+///Usage: yuvscaler_bench [iterations]
+///
+///Prints one CSV row per case, implementation and filter:
+///case,impl,filter,src,dst,iterations,ms_per_frame,mpix_per_sec
+///
+///mpix_per_sec counts output pixels. Cases:
+///  zoom2x       2x digital zoom of a YUV422I frame into the same size
+///  zoom2x_nv12  the same into an NV12 frame
+///  snapshot     a 5MP YUV422I capture down to the size, as the snapshot does
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "YuvScaler.h"
+
+using namespace android;
+
+#define DEFAULT_ITERATIONS  10
+#define CAPTURE_WIDTH       2592
+#define CAPTURE_HEIGHT      1944
+
+static const char *sImplementations[] = { "scalar", "sse2", "neon" };
+static const char *sFilterNames[] = { "bilinear", "polyphase" };
+
+struct Size
+{
+    int width;
+    int height;
+};
+
+static const Size sSizes[] =
+{
+    { 640, 480 },
+    { 1280, 720 },
+    { 1600, 1200 },
+    { 2048, 1536 },
+    { 2592, 1944 },
+};
+
+enum
+{
+    CASE_ZOOM = 0,
+    CASE_ZOOM_NV12,
+    CASE_SNAPSHOT,
+    CASE_COUNT
+};
+
+static const char *sCaseNames[CASE_COUNT] = { "zoom2x", "zoom2x_nv12", "snapshot" };
+
+static int64_t now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int iterations = DEFAULT_ITERATIONS;
+    uint8_t *src, *dst;
+
+    if ( 1 < argc )
+        {
+        iterations = strtoul(argv[1], NULL, 0);
+        if ( 0 == iterations )
+            {
+            fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+            return 1;
+            }
+        }
+
+    src = (uint8_t *) malloc(CAPTURE_WIDTH * CAPTURE_HEIGHT * 2);
+    dst = (uint8_t *) malloc(CAPTURE_WIDTH * CAPTURE_HEIGHT * 2);
+    if ( ( NULL == src ) || ( NULL == dst ) )
+        {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+        }
+
+    for ( size_t i = 0 ; i < CAPTURE_WIDTH * CAPTURE_HEIGHT * 2 ; i++ )
+        {
+        src[i] = rand() & 0xFF;
+        }
+
+    printf("case,impl,filter,src,dst,iterations,ms_per_frame,mpix_per_sec\n");
+
+    for ( int c = 0 ; c < CASE_COUNT ; c++ )
+        {
+        for ( size_t s = 0 ; s < sizeof(sSizes) / sizeof(sSizes[0]) ; s++ )
+            {
+            const Size &size = sSizes[s];
+            int srcWidth = ( CASE_SNAPSHOT == c ) ? CAPTURE_WIDTH : size.width;
+            int srcHeight = ( CASE_SNAPSHOT == c ) ? CAPTURE_HEIGHT : size.height;
+            int dstFormat = ( CASE_ZOOM_NV12 == c ) ? YuvScaler::FORMAT_NV12 : YuvScaler::FORMAT_YUV422I;
+            float zoom = ( CASE_SNAPSHOT == c ) ? 1.0f : 2.0f;
+
+            for ( size_t i = 0 ; i < sizeof(sImplementations) / sizeof(sImplementations[0]) ; i++ )
+                {
+                const YuvScaler::Kernels *kernels = YuvScaler::getKernels(sImplementations[i]);
+
+                if ( NULL == kernels )
+                    {
+                    continue;
+                    }
+
+                for ( int f = 0 ; f < 2 ; f++ )
+                    {
+                    YuvScaler scaler;
+
+                    scaler.setKernels(kernels);
+
+                    ///Builds the tables and warms up the caches
+                    scaler.process(src, srcWidth, srcHeight, YuvScaler::FORMAT_YUV422I,
+                                   dst, size.width, size.height, dstFormat,
+                                   0, 0, srcWidth, srcHeight, zoom, (YuvScaler::Filter) f);
+
+                    int64_t start = now_ns();
+
+                    for ( unsigned int n = 0 ; n < iterations ; n++ )
+                        {
+                        scaler.process(src, srcWidth, srcHeight, YuvScaler::FORMAT_YUV422I,
+                                       dst, size.width, size.height, dstFormat,
+                                       0, 0, srcWidth, srcHeight, zoom, (YuvScaler::Filter) f);
+                        }
+
+                    double msPerFrame = ( now_ns() - start ) / 1e6 / iterations;
+
+                    printf("%s,%s,%s,%dx%d,%dx%d,%u,%.3f,%.1f\n", sCaseNames[c], kernels->name, sFilterNames[f],
+                           srcWidth, srcHeight, size.width, size.height, iterations, msPerFrame,
+                           size.width * size.height / ( msPerFrame * 1e3 ));
+                    }
+                }
+            }
+        }
+
+    free(src);
+    free(dst);
+
+    return 0;
+}
@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///Quality and bit-exactness tests of the libtiutils CPU scaler.
+///The fixed point scaler is compared, by PSNR, with a double precision
+///reference of the same filters on smooth frames, for both formats and filters,
+///down and up scaling, with crops. Every implementation supported by the CPU
+///has to match the scalar one bit for bit, zoom has to match the equivalent
+///crop, and the 4-tap filter has to beat bilinear when upscaling.
+///
+///Usage: yuvscaler_test
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YuvScaler.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+#define MIN_PSNR    45.0
+
+static const char *sImplementations[] = { "scalar", "sse2", "neon" };
+static const char *sFormatNames[] = { "yuv422i", "nv12" };
+static const char *sFilterNames[] = { "bilinear", "polyphase" };
+
+struct Geometry
+{
+    int srcWidth;
+    int srcHeight;
+    int dstWidth;
+    int dstHeight;
+    int cropTop;
+    int cropLeft;
+    int cropWidth;
+    int cropHeight;
+};
+
+///Crops are aligned to the chroma samples, as the scaler would align them
+static const Geometry sGeometries[] =
+{
+    { 640, 480, 176, 144, 0, 0, 640, 480 },
+    { 640, 480, 640, 480, 0, 0, 640, 480 },
+    { 320, 240, 640, 480, 0, 0, 320, 240 },
+    { 640, 480, 640, 480, 120, 160, 320, 240 },
+    { 648, 486, 322, 202, 10, 34, 450, 300 },
+    { 176, 144, 1280, 720, 4, 6, 160, 128 },
+    { 2592, 1944, 640, 480, 0, 0, 2592, 1944 },
+    { 96, 64, 50, 30, 0, 0, 96, 64 },
+};
+
+struct Plane
+{
+    size_t offset;
+    size_t step;
+    size_t stride;
+    int width;
+    int height;
+};
+
+static void framePlanes(int format, int width, int height, Plane planes[3])
+{
+    if ( YuvScaler::FORMAT_NV12 == format )
+        {
+        Plane y = { 0, 1, (size_t) width, width, height };
+        Plane u = { (size_t) width * height, 2, (size_t) width, width / 2, height / 2 };
+
+        planes[0] = y;
+        planes[1] = u;
+        planes[2] = u;
+        planes[2].offset++;
+        }
+    else
+        {
+        Plane y = { 1, 2, (size_t) width * 2, width, height };
+        Plane u = { 0, 4, (size_t) width * 2, width / 2, height };
+
+        planes[0] = y;
+        planes[1] = u;
+        planes[2] = u;
+        planes[2].offset += 2;
+        }
+}
+
+static size_t frameSize(int format, int width, int height)
+{
+    return ( YuvScaler::FORMAT_NV12 == format ) ? ( width * height * 3 / 2 ) : ( width * height * 2 );
+}
+
+///Smooth content, so that the PSNR measures the filters and not aliasing
+static void fillSmooth(uint8_t *frame, int format, int width, int height, double scale)
+{
+    Plane planes[3];
+
+    framePlanes(format, width, height, planes);
+
+    for ( int c = 0 ; c < 3 ; c++ )
+        {
+        const Plane &p = planes[c];
+        double sx = scale * width / p.width;
+        double sy = scale * height / p.height;
+
+        for ( int y = 0 ; y < p.height ; y++ )
+            {
+            for ( int x = 0 ; x < p.width ; x++ )
+                {
+                double fx = ( x + 0.5 ) * sx;
+                double fy = ( y + 0.5 ) * sy;
+                double v = 128 + 60 * sin(fx / 23.0 + c) * cos(fy / 31.0) + 40 * sin(( fx + fy ) / 57.0 + 2 * c);
+
+                frame[p.offset + y * p.stride + x * p.step] = (uint8_t) ( v + 0.5 );
+                }
+            }
+        }
+}
+
+static void fillRandom(uint8_t *frame, size_t size)
+{
+    for ( size_t i = 0 ; i < size ; i++ )
+        {
+        frame[i] = rand() & 0xFF;
+        }
+}
+
+static double weight(int taps, int k, double t)
+{
+    if ( 2 == taps )
+        {
+        return ( 0 == k ) ? ( 1.0 - t ) : t;
+        }
+
+    switch ( k )
+        {
+        case 0:
+            return ( -t * t * t + 2 * t * t - t ) / 2;
+        case 1:
+            return ( 3 * t * t * t - 5 * t * t + 2 ) / 2;
+        case 2:
+            return ( -3 * t * t * t + 4 * t * t + t ) / 2;
+        default:
+            return ( t * t * t - t * t ) / 2;
+        }
+}
+
+static int clampIndex(int i, int size)
+{
+    return ( 0 > i ) ? 0 : ( ( size <= i ) ? ( size - 1 ) : i );
+}
+
+///Double precision scaling of every component, exact sample positions, edge pixels repeated
+static void referenceScale(const uint8_t *src, int srcWidth, int srcHeight, int srcFormat,
+                           uint8_t *dst, int dstWidth, int dstHeight, int dstFormat,
+                           int cropTop, int cropLeft, int cropWidth, int cropHeight, int taps)
+{
+    Plane srcPlanes[3], dstPlanes[3];
+    int first = ( 4 == taps ) ? -1 : 0;
+
+    framePlanes(srcFormat, srcWidth, srcHeight, srcPlanes);
+    framePlanes(dstFormat, dstWidth, dstHeight, dstPlanes);
+
+    for ( int c = 0 ; c < 3 ; c++ )
+        {
+        const Plane &sp = srcPlanes[c];
+        const Plane &dp = dstPlanes[c];
+        int hsub = srcWidth / sp.width;
+        int vsub = srcHeight / sp.height;
+        int left = cropLeft / hsub, width = cropWidth / hsub;
+        int top = cropTop / vsub, height = cropHeight / vsub;
+
+        for ( int y = 0 ; y < dp.height ; y++ )
+            {
+            double py = ( y + 0.5 ) * height / dp.height - 0.5;
+            int y0 = (int) floor(py);
+
+            for ( int x = 0 ; x < dp.width ; x++ )
+                {
+                double px = ( x + 0.5 ) * width / dp.width - 0.5;
+                int x0 = (int) floor(px);
+                double sum = 0;
+
+                for ( int j = 0 ; j < taps ; j++ )
+                    {
+                    int row = top + clampIndex(y0 + first + j, height);
+                    double wy = weight(taps, j, py - y0);
+
+                    for ( int k = 0 ; k < taps ; k++ )
+                        {
+                        int col = left + clampIndex(x0 + first + k, width);
+
+                        sum += wy * weight(taps, k, px - x0) * src[sp.offset + row * sp.stride + col * sp.step];
+                        }
+                    }
+
+                sum = floor(sum + 0.5);
+                dst[dp.offset + y * dp.stride + x * dp.step] = (uint8_t) ( ( 0 > sum ) ? 0 : ( ( 255 < sum ) ? 255 : sum ) );
+                }
+            }
+        }
+}
+
+static double psnr(const uint8_t *a, const uint8_t *b, size_t size)
+{
+    double mse = 0;
+
+    for ( size_t i = 0 ; i < size ; i++ )
+        {
+        double d = (double) a[i] - b[i];
+        mse += d * d;
+        }
+
+    mse /= size;
+
+    return ( 0 == mse ) ? 99.0 : 10 * log10(255.0 * 255.0 / mse);
+}
+
+///Fixed point against double precision, every format pair and filter
+static void testQuality(const Geometry &g)
+{
+    for ( int sf = 0 ; sf < 2 ; sf++ )
+        {
+        size_t srcSize = frameSize(sf, g.srcWidth, g.srcHeight);
+        uint8_t *src = (uint8_t *) malloc(srcSize);
+
+        fillSmooth(src, sf, g.srcWidth, g.srcHeight, 1.0);
+
+        for ( int df = 0 ; df < 2 ; df++ )
+            {
+            size_t dstSize = frameSize(df, g.dstWidth, g.dstHeight);
+            uint8_t *dst = (uint8_t *) malloc(dstSize);
+            uint8_t *ref = (uint8_t *) malloc(dstSize);
+
+            for ( int f = 0 ; f < 2 ; f++ )
+                {
+                YuvScaler scaler;
+                char what[128];
+                status_t ret;
+
+                ret = scaler.process(src, g.srcWidth, g.srcHeight, sf, dst, g.dstWidth, g.dstHeight, df,
+                                     g.cropTop, g.cropLeft, g.cropWidth, g.cropHeight, 1.0f,
+                                     (YuvScaler::Filter) f);
+                referenceScale(src, g.srcWidth, g.srcHeight, sf, ref, g.dstWidth, g.dstHeight, df,
+                               g.cropTop, g.cropLeft, g.cropWidth, g.cropHeight, f ? 4 : 2);
+
+                double db = psnr(dst, ref, dstSize);
+
+                snprintf(what, sizeof(what), "%s %dx%d %s -> %dx%d %s crop %d,%d %dx%d: %.1f dB",
+                         sFilterNames[f], g.srcWidth, g.srcHeight, sFormatNames[sf], g.dstWidth, g.dstHeight,
+                         sFormatNames[df], g.cropLeft, g.cropTop, g.cropWidth, g.cropHeight, db);
+                testExpect(( NO_ERROR == ret ) && ( MIN_PSNR <= db ), "%s", what);
+                }
+
+            free(dst);
+            free(ref);
+            }
+
+        free(src);
+        }
+}
+
+///Every implementation has to produce the scalar output, on noise to reach the clamps
+static void testBitExact(const Geometry &g)
+{
+    const YuvScaler::Kernels *scalar = YuvScaler::getKernels("scalar");
+
+    for ( size_t i = 1 ; i < sizeof(sImplementations) / sizeof(sImplementations[0]) ; i++ )
+        {
+        const YuvScaler::Kernels *kernels = YuvScaler::getKernels(sImplementations[i]);
+
+        if ( NULL == kernels )
+            {
+            continue;
+            }
+
+        for ( int sf = 0 ; sf < 2 ; sf++ )
+            {
+            size_t srcSize = frameSize(sf, g.srcWidth, g.srcHeight);
+            uint8_t *src = (uint8_t *) malloc(srcSize);
+
+            fillRandom(src, srcSize);
+
+            for ( int df = 0 ; df < 2 ; df++ )
+                {
+                size_t dstSize = frameSize(df, g.dstWidth, g.dstHeight);
+                uint8_t *expected = (uint8_t *) malloc(dstSize);
+                uint8_t *dst = (uint8_t *) malloc(dstSize);
+
+                for ( int f = 0 ; f < 2 ; f++ )
+                    {
+                    YuvScaler a, b;
+                    char what[128];
+
+                    a.setKernels(scalar);
+                    b.setKernels(kernels);
+                    a.process(src, g.srcWidth, g.srcHeight, sf, expected, g.dstWidth, g.dstHeight, df,
+                              g.cropTop, g.cropLeft, g.cropWidth, g.cropHeight, 1.0f, (YuvScaler::Filter) f);
+                    b.process(src, g.srcWidth, g.srcHeight, sf, dst, g.dstWidth, g.dstHeight, df,
+                              g.cropTop, g.cropLeft, g.cropWidth, g.cropHeight, 1.0f, (YuvScaler::Filter) f);
+
+                    snprintf(what, sizeof(what), "%s %s %dx%d %s -> %dx%d %s bit-exact", kernels->name,
+                             sFilterNames[f], g.srcWidth, g.srcHeight, sFormatNames[sf], g.dstWidth,
+                             g.dstHeight, sFormatNames[df]);
+                    testExpect(0 == memcmp(expected, dst, dstSize), "%s", what);
+                    }
+
+                free(expected);
+                free(dst);
+                }
+
+            free(src);
+            }
+        }
+}
+
+///Zoom narrows the crop around its center, out of range crops are clamped
+static void testCropAndZoom()
+{
+    const int width = 640, height = 480;
+    size_t srcSize = frameSize(YuvScaler::FORMAT_YUV422I, width, height);
+    size_t dstSize = frameSize(YuvScaler::FORMAT_YUV422I, width, height);
+    uint8_t *src = (uint8_t *) malloc(srcSize);
+    uint8_t *a = (uint8_t *) malloc(dstSize);
+    uint8_t *b = (uint8_t *) malloc(dstSize);
+    YuvScaler scaler;
+    status_t ret;
+
+    fillRandom(src, srcSize);
+
+    ret = scaler.process(src, width, height, YuvScaler::FORMAT_YUV422I, a, width, height, YuvScaler::FORMAT_YUV422I,
+                         0, 0, width, height, 2.0f, YuvScaler::FILTER_POLYPHASE);
+    ret |= scaler.process(src, width, height, YuvScaler::FORMAT_YUV422I, b, width, height, YuvScaler::FORMAT_YUV422I,
+                          120, 160, 320, 240, 1.0f, YuvScaler::FILTER_POLYPHASE);
+    testExpect(( NO_ERROR == ret ) && ( 0 == memcmp(a, b, dstSize) ), "zoom 2x matches the centered crop");
+
+    ret = scaler.process(src, width, height, YuvScaler::FORMAT_YUV422I, a, width, height, YuvScaler::FORMAT_YUV422I,
+                         -8, -8, width + 100, height + 100, 1.0f, YuvScaler::FILTER_BILINEAR);
+    ret |= scaler.process(src, width, height, YuvScaler::FORMAT_YUV422I, b, width, height, YuvScaler::FORMAT_YUV422I,
+                          0, 0, width, height, 1.0f, YuvScaler::FILTER_BILINEAR);
+    testExpect(( NO_ERROR == ret ) && ( 0 == memcmp(a, b, dstSize) ), "crop clamped to the frame");
+
+    ///Same size, no crop, phase 0 everywhere: a copy
+    testExpect(0 == memcmp(src, b, dstSize), "identity scaling copies");
+
+    ret = scaler.process(src, width, height, YuvScaler::FORMAT_YUV422I, a, width, height, YuvScaler::FORMAT_YUV422I,
+                         0, width - 2, 100, 100, 1.0f, YuvScaler::FILTER_BILINEAR);
+    testExpect(BAD_VALUE == ret, "empty crop rejected");
+
+    ret = scaler.process(src, width, height, YuvScaler::FORMAT_YUV422I, a, width - 1, height,
+                         YuvScaler::FORMAT_YUV422I, 0, 0, width, height, 1.0f, YuvScaler::FILTER_BILINEAR);
+    testExpect(BAD_VALUE == ret, "odd width rejected");
+
+    free(src);
+    free(a);
+    free(b);
+}
+
+///Upscaling a smooth frame sampled at half resolution gets closer to the full
+///resolution one with the 4-tap filter
+static void testPolyphaseBeatsBilinear()
+{
+    const int width = 640, height = 480;
+    const int format = YuvScaler::FORMAT_NV12;
+    uint8_t *full = (uint8_t *) malloc(frameSize(format, width, height));
+    uint8_t *half = (uint8_t *) malloc(frameSize(format, width / 2, height / 2));
+    uint8_t *up = (uint8_t *) malloc(frameSize(format, width, height));
+    double db[2];
+
+    fillSmooth(full, format, width, height, 2.0);
+    fillSmooth(half, format, width / 2, height / 2, 4.0);
+
+    for ( int f = 0 ; f < 2 ; f++ )
+        {
+        YuvScaler scaler;
+
+        scaler.process(half, width / 2, height / 2, format, up, width, height, format,
+                       0, 0, width / 2, height / 2, 1.0f, (YuvScaler::Filter) f);
+        db[f] = psnr(full, up, frameSize(format, width, height));
+        }
+
+    char what[128];
+    snprintf(what, sizeof(what), "polyphase %.1f dB over bilinear %.1f dB", db[1], db[0]);
+    testExpect(db[1] > db[0], "%s", what);
+
+    free(full);
+    free(half);
+    free(up);
+}
+
+int main()
+{
+    srand(1);
+
+    for ( size_t i = 0 ; i < sizeof(sGeometries) / sizeof(sGeometries[0]) ; i++ )
+        {
+        testQuality(sGeometries[i]);
+        testBitExact(sGeometries[i]);
+        }
+
+    testCropAndZoom();
+    testPolyphaseBeatsBilinear();
+
+    return testReport();
+}
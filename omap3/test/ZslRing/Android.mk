@@ -0,0 +1,29 @@
+ifdef BOARD_USES_TI_CAMERA_HAL
+ifeq ($(TARGET_BOARD_PLATFORM),omap4)
+
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	zslring_test.cpp
+
+LOCAL_SHARED_LIBRARIES:= \
+	libcamera \
+	libutils \
+	libcutils
+
+LOCAL_C_INCLUDES += \
+	hardware/ti/omap4/omap3/camera-omap4/inc \
+	hardware/ti/omap4/omap3/libtiutils \
+	hardware/ti/omap4/omap3/test
+
+LOCAL_MODULE:= zslring_test
+LOCAL_MODULE_TAGS:= eng
+
+LOCAL_CFLAGS += -Wall -fno-short-enums -O2 -DTARGET_OMAP4
+
+include $(BUILD_EXECUTABLE)
+
+endif
+endif
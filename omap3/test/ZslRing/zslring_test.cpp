@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+///ZslRing checks
+///
+///Usage: zslring_test
+///
+///Buffers are plain integers cast to pointers, the ring never touches them.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ZslRing.h"
+#include "TestCheck.h"
+
+using namespace android;
+
+#define BUFFER(n)   ( ( void * ) ( intptr_t ) ( n ) )
+
+static ZslRing::Frame makeFrame(int buffer, nsecs_t timestamp, bool converged)
+{
+    ZslRing::Frame frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.mBuffer = BUFFER(buffer);
+    frame.mTimestamp = timestamp;
+    frame.mMetadata.mConverged = converged;
+
+    return frame;
+}
+
+///A full ring hands back its oldest buffer for every new frame
+static bool checkEviction()
+{
+    ZslRing ring;
+    void *evicted;
+
+    if ( ( NO_INIT != ring.push(makeFrame(1, 100, true), evicted) ) ||
+         ( NO_ERROR != ring.setDepth(3) ) )
+        {
+        return false;
+        }
+
+    for ( int i = 1 ; i <= 5 ; i++ )
+        {
+        if ( NO_ERROR != ring.push(makeFrame(i, i * 100, true), evicted) )
+            {
+            return false;
+            }
+
+        if ( evicted != ( ( 3 < i ) ? BUFFER(i - 3) : NULL ) )
+            {
+            return false;
+            }
+        }
+
+    return ( 3 == ring.getCount() );
+}
+
+///The frame closest to the shutter is taken, on either side of it
+static bool checkClosest()
+{
+    ZslRing ring;
+    ZslRing::Frame frame;
+    void *evicted;
+
+    ring.setDepth(4);
+    for ( int i = 1 ; i <= 4 ; i++ )
+        {
+        ring.push(makeFrame(i, i * 100, true), evicted);
+        }
+
+    if ( ( NO_ERROR != ring.select(240, frame) ) || ( BUFFER(2) != frame.mBuffer ) )
+        {
+        return false;
+        }
+
+    ///The shutter is past the newest frame
+    if ( ( NO_ERROR != ring.select(1000, frame) ) || ( BUFFER(4) != frame.mBuffer ) )
+        {
+        return false;
+        }
+
+    ///Removing frames keeps the others in order
+    return ring.pop(frame) && ( BUFFER(1) == frame.mBuffer ) &&
+           ring.pop(frame) && ( BUFFER(3) == frame.mBuffer ) &&
+           !ring.pop(frame);
+}
+
+///Frames exposed while 3A was still settling are the last choice
+static bool checkConverged()
+{
+    ZslRing ring;
+    ZslRing::Frame frame;
+    void *evicted;
+
+    ring.setDepth(3);
+    ring.push(makeFrame(1, 100, true), evicted);
+    ring.push(makeFrame(2, 200, false), evicted);
+    ring.push(makeFrame(3, 300, true), evicted);
+
+    return ( NO_ERROR == ring.select(210, frame) ) && ( BUFFER(3) == frame.mBuffer ) &&
+           ( NO_ERROR == ring.select(210, frame) ) && ( BUFFER(1) == frame.mBuffer ) &&
+           ( NO_ERROR == ring.select(210, frame) ) && ( BUFFER(2) == frame.mBuffer ) &&
+           ( NOT_ENOUGH_DATA == ring.select(210, frame) );
+}
+
+///The depth only changes on an empty ring
+static bool checkDepth()
+{
+    ZslRing ring;
+    ZslRing::Frame frame;
+    void *evicted;
+
+    if ( BAD_VALUE != ring.setDepth(ZslRing::MAX_DEPTH + 1) )
+        {
+        return false;
+        }
+
+    ring.setDepth(2);
+    ring.push(makeFrame(1, 100, true), evicted);
+
+    if ( INVALID_OPERATION != ring.setDepth(4) )
+        {
+        return false;
+        }
+
+    ring.pop(frame);
+
+    return ( NO_ERROR == ring.setDepth(0) ) &&
+           ( NO_INIT == ring.push(makeFrame(2, 200, true), evicted) ) &&
+           ( 0 == ring.getCount() );
+}
+
+int main()
+{
+    static const TestCheck checks[] =
+        {
+        { "eviction", checkEviction },
+        { "closest", checkClosest },
+        { "converged", checkConverged },
+        { "depth", checkDepth },
+        };
+
+    TEST_RUN(checks);
+
+    return testReport();
+}
@@ -68,6 +68,7 @@
 #include <RcmServer.h>
 #include <IpcUsr.h>
 #include <ProcMgr.h>
+#include <_NameServer.h>
 
 #include <SysLinkMemUtils.h>
 #include <hardware_legacy/power.h>
@@ -1357,6 +1358,10 @@ static void *RPC_DucatiFaultHandler(void *data)
 
 	ducatiFault = OMX_TRUE;
 
+	/* Names registered by the faulted core go away without this
+	   process removing them, drop what the lookup cache holds */
+	NameServer_invalidateCache();
+
 #ifdef SET_WATCHDOG_TIMEOUT
 	if (SUCCESS != pthread_create(&watchDogFaultHandler,
 		              NULL, RPC_WatchDogFaultHandler, NULL))
@@ -85,7 +85,8 @@ enum messageq_drv_cmd {
     MESSAGEQ_DETACH,
     MESSAGEQ_GET,
     MESSAGEQ_SHAREDMEMREQ,
-    MESSAGEQ_UNBLOCK
+    MESSAGEQ_UNBLOCK,
+    MESSAGEQ_BATCH
 };
 
 /*  ----------------------------------------------------------------------------
@@ -225,6 +226,21 @@ enum messageq_drv_cmd {
                                         MESSAGEQ_UNBLOCK,                      \
                                         MessageQDrv_CmdArgs)
 
+/*!
+ *  @brief  Command for MessageQ_putv and MessageQ_getv
+ */
+#define CMD_MESSAGEQ_BATCH              _IOWR(MESSAGEQ_IOC_MAGIC,              \
+                                        MESSAGEQ_BATCH,                        \
+                                        MessageQDrv_CmdArgs)
+
+/*!
+ *  @brief  Status returned by MessageQDrv_ioctl when the kernel driver does
+ *          not implement CMD_MESSAGEQ_BATCH. Only that command is mapped to
+ *          it. It is outside of the MessageQ_E_* range and never returned by
+ *          the MessageQ APIs.
+ */
+#define MessageQDrv_E_NOTSUPPORTED      (-64)
+
 /*  ----------------------------------------------------------------------------
  *  Command arguments for MessageQ
  *  ----------------------------------------------------------------------------
@@ -321,6 +337,17 @@ typedef struct MessageQDrv_CmdArgs_Tag {
         struct {
             Ptr                   handle;
         } unblock;
+
+        struct {
+            Ptr                   handle;
+            /*!< Queue to get from, NULL to put to queueId. */
+            MessageQ_QueueId      queueId;
+            UInt                  timeout;
+            /*!< Wait for the first message only, the rest is drained. */
+            SharedRegion_SRPtr  * msgSrPtrs;
+            UInt32                count;
+            /*!< In: entries in msgSrPtrs. Out: number of messages moved. */
+        } batch;
     } args;
 
     Int32 apiStatus;
@@ -304,6 +304,24 @@ typedef struct {
      */
 } RcmServer_ThreadPoolDesc;
 
+/*!
+ *  @brief  Execution statistics of a server function
+ *
+ *  Use RcmServer_getFxnStats() to find the functions which take long
+ *  enough to hold up a worker pool. The client can send the messages for
+ *  those to a dedicated pool, see RcmServer_Params.workerPools.
+ */
+typedef struct {
+    UInt32  calls;
+    /*!< Number of times the function was executed */
+
+    UInt32  avgUs;
+    /*!< Average execution time in microseconds */
+
+    UInt32  maxUs;
+    /*!< Longest execution time in microseconds */
+} RcmServer_FxnStats;
+
 /*!
  *  @brief  Worker pool descriptor array
  */
@@ -491,6 +509,24 @@ Void RcmServer_exit (Void);
  */
 Void RcmServer_init (Void);
 
+/*!
+ *  @brief  Get the execution statistics of a function
+ *
+ *          Counts every execution of the function by the server, whichever
+ *          pool or thread executed it, since the symbol was added.
+ *
+ *  @param  handle  Handle to an instance object.
+ *  @param  name    The function's name.
+ *  @param  stats   Filled with the function's statistics.
+ *
+ *  @return Status of the call
+ *          -#RcmClient_S_SUCCESS
+ *          -#RcmServer_E_SYMBOLNOTFOUND
+ */
+Int RcmServer_getFxnStats (RcmServer_Handle     handle,
+                           String               name,
+                           RcmServer_FxnStats * stats);
+
 /*!
  *  @brief  Initialize the instance create params structure.
  *
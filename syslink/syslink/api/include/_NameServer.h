@@ -125,6 +125,24 @@ typedef struct NameServer_Config_tag {
     /*!< Reserved value. */
 } NameServer_Config;
 
+/*!
+ *  @brief  Counters of the process-local cache in front of NameServer_get and
+ *          NameServer_getLocal.
+ */
+typedef struct NameServer_CacheStats_tag {
+    UInt32 hits;
+    /*!< Lookups answered with a cached value */
+    UInt32 negHits;
+    /*!< Lookups answered with a cached NameServer_E_NOTFOUND */
+    UInt32 misses;
+    /*!< Lookups that went to the kernel */
+    UInt32 invalidations;
+    /*!< Times entries were dropped by an add, remove, delete, driver failure
+         or NameServer_invalidateCache */
+    UInt32 entries;
+    /*!< Entries currently cached */
+} NameServer_CacheStats;
+
 
 /* =============================================================================
  * APIs
@@ -199,6 +217,61 @@ Int NameServer_registerRemoteDriver (NameServerRemote_Handle handle,
  */
 Int NameServer_unregisterRemoteDriver (UInt16 procId);
 
+/*!
+ *  @brief      Function to get the counters of the lookup cache.
+ *
+ *              NameServer_get (over all processors) and NameServer_getLocal
+ *              results are cached per process. MessageQ_open resolves queue
+ *              names through the same cache. Values are dropped when the
+ *              name is added or removed, or its NameServer deleted, in this
+ *              process, and otherwise after 250 ms. A name changed by another
+ *              process or a remote core can resolve to its old value for that
+ *              long. Names not found are cached for 50 ms.
+ *
+ *  @param      stats   Filled with the counters since NameServer_setup.
+ *
+ *  @sa         NameServer_invalidateCache
+ */
+Void NameServer_getCacheStats (NameServer_CacheStats * stats);
+
+/*!
+ *  @brief      Function to drop everything in the lookup cache.
+ *
+ *              To be called when a remote processor is stopped or recovered
+ *              (ProcMgr PROC_STOP, PROC_ERROR or PROC_WATCHDOG), as its names
+ *              go away without this process removing them. A failing
+ *              NameServer driver call drops the cache as well.
+ *
+ *  @sa         NameServer_getCacheStats
+ */
+Void NameServer_invalidateCache (Void);
+
+/*!
+ *  @brief      Function to drop the cached lookups of a name.
+ *
+ *              For modules that add or remove names through their own driver
+ *              calls, such as MessageQ_create and MessageQ_delete, so that
+ *              this process does not see a stale value for them.
+ *
+ *  @param      handle  Handle to the NameServer instance.
+ *  @param      name    Name whose lookups are dropped, NULL for all the names
+ *                      of the instance.
+ *
+ *  @sa         NameServer_invalidateCache
+ */
+Void NameServer_invalidateEntries (NameServer_Handle handle, String name);
+
+/*!
+ *  @brief      Function to free a handle returned by NameServer_getHandle.
+ *
+ *              The NameServer instance itself is not deleted.
+ *
+ *  @param      handlePtr   Pointer to the handle, set to NULL.
+ *
+ *  @sa         NameServer_getHandle
+ */
+Void NameServer_releaseHandle (NameServer_Handle * handlePtr);
+
 /*!
  *  @brief     Determines if a remote driver is registered for the specified id.
  *
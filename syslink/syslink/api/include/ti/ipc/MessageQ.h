@@ -301,6 +301,12 @@ extern "C" {
  */
 #define MessageQ_PRIORITYMASK           0x3
 
+/*!
+ *  @brief      Maximum number of messages moved per driver call by
+ *              #MessageQ_putv and #MessageQ_getv
+ */
+#define MessageQ_BATCHSIZE              32
+
 /*!
  *  @brief   Extract the destination queue from a message.
  *           <br>
@@ -625,6 +631,64 @@ Int MessageQ_get(MessageQ_Handle handle, MessageQ_Msg *msg, UInt timeout);
  */
 Int MessageQ_put(MessageQ_QueueId queueId, MessageQ_Msg msg);
 
+/*!
+ *  @brief      Place several messages onto a message queue
+ *
+ *  Same as calling #MessageQ_put on each message in order. The messages are
+ *  handed to the driver in batches of up to #MessageQ_BATCHSIZE per call
+ *  once the driver supports batches. No MessageQ driver implements the
+ *  batch command yet, so today this falls back to one #MessageQ_put call
+ *  per message, in order.
+ *
+ *  On failure, the messages after the ones that were put are still owned
+ *  by the caller.
+ *
+ *  @param[in]     queueId  Destination MessageQ
+ *  @param[in]     msgs     Messages to be sent.
+ *  @param[in,out] count    In: number of messages in msgs.
+ *                          Out: number of messages put.
+ *
+ *  @return     Status of the call.
+ *              - #MessageQ_S_SUCCESS denotes success.
+ *              - #MessageQ_E_FAIL denotes failure. Only *count messages
+ *                 were put.
+ *
+ *  @sa         MessageQ_getv
+ */
+Int MessageQ_putv(MessageQ_QueueId queueId, MessageQ_Msg *msgs, UInt *count);
+
+/*!
+ *  @brief      Gets all the messages pending on a message queue
+ *
+ *  Waits up to timeout for the first message, like #MessageQ_get. Then it
+ *  also takes the messages already queued behind it, without waiting,
+ *  until msgs is full or the queue is empty. A reader woken up by one
+ *  message thus drains everything that piled up while it was busy.
+ *
+ *  *count is set on every return, and the messages returned are owned by
+ *  the caller whatever the status.
+ *
+ *  Like #MessageQ_putv, this uses one driver call per batch once the driver
+ *  supports it. Until then it falls back to one #MessageQ_get call per
+ *  message.
+ *
+ *  @param      handle      MessageQ handle
+ *  @param[out] msgs        Received messages
+ *  @param[in,out] count    In: room in msgs. Out: number of messages
+ *                          received.
+ *  @param[in]  timeout     Maximum duration to wait for the first message
+ *                          in microseconds.
+ *
+ *  @return     Status of the call.
+ *              - #MessageQ_S_SUCCESS denotes at least one message.
+ *              - #MessageQ_E_TIMEOUT denotes no message before timeout.
+ *              - #MessageQ_E_UNBLOCKED denotes the wait was unblocked.
+ *
+ *  @sa         MessageQ_putv
+ */
+Int MessageQ_getv(MessageQ_Handle handle, MessageQ_Msg *msgs, UInt *count,
+                  UInt timeout);
+
 /*!
  *  @brief      Register a heap with MessageQ
  *
@@ -134,6 +134,8 @@
 #include <MessageQDrvDefs.h>
 #include <MessageQDrv.h>
 #include <ti/ipc/SharedRegion.h>
+#include <ti/ipc/NameServer.h>
+#include <_NameServer.h>
 
 
 #if defined (__cplusplus)
@@ -141,6 +143,17 @@ extern "C" {
 #endif
 
 
+/* =============================================================================
+ * Macros
+ * =============================================================================
+ */
+/*!
+ *  @brief  Name of the NameServer the kernel-side MessageQ registers the
+ *          queue names in
+ */
+#define MessageQ_NAMESERVER             "MessageQ"
+
+
 /* =============================================================================
  * Structures & Enums
  * =============================================================================
@@ -161,6 +174,15 @@ typedef struct MessageQ_ModuleObject_tag {
     UInt32          setupRefCount;
     /*!< Reference count for number of times setup/destroy were called in this
          process. */
+    Bool            batchSupported;
+    /*!< Cleared once the driver fails CMD_MESSAGEQ_BATCH. MessageQ_putv
+         and MessageQ_getv then loop over MessageQ_put and MessageQ_get.
+         No driver implements the command yet, so in practice the first
+         batch call clears it. */
+    NameServer_Handle nameServer;
+    /*!< Handle to the MessageQ NameServer, through which MessageQ_open
+         uses the NameServer lookup cache. NULL if it could not be opened,
+         MessageQ_open then asks the driver every time. */
 } MessageQ_ModuleObject;
 
 
@@ -178,7 +200,9 @@ static
 #endif /* if !defined(SYSLINK_BUILD_DEBUG) */
 MessageQ_ModuleObject MessageQ_state =
 {
-    .setupRefCount = 0
+    .setupRefCount = 0,
+    .batchSupported = TRUE,
+    .nameServer = NULL
 };
 
 /*!
@@ -192,6 +216,57 @@ static
 MessageQ_ModuleObject * MessageQ_module = &MessageQ_state;
 
 
+/* =============================================================================
+ * Internal functions
+ * =============================================================================
+ */
+/*
+ *  ======== _MessageQ_lookup ========
+ *  Resolves a queue name through the NameServer lookup cache. Returns
+ *  MessageQ_E_NOTFOUND for an unknown name, and MessageQ_E_FAIL when the
+ *  cache cannot be used, the caller then asks the driver.
+ */
+static Int
+_MessageQ_lookup (String name, MessageQ_QueueId * queueId)
+{
+    Int    status = MessageQ_E_FAIL;
+    UInt32 value;
+
+    if (MessageQ_module->nameServer != NULL) {
+        status = NameServer_getUInt32 (MessageQ_module->nameServer,
+                                       name,
+                                       &value,
+                                       NULL);
+        if (status >= 0) {
+            *queueId = (MessageQ_QueueId) value;
+            status = MessageQ_S_SUCCESS;
+        }
+        else if (status == NameServer_E_NOTFOUND) {
+            status = MessageQ_E_NOTFOUND;
+        }
+        else {
+            status = MessageQ_E_FAIL;
+        }
+    }
+
+    return status;
+}
+
+
+/*
+ *  ======== _MessageQ_dropCached ========
+ *  Drops the cached lookups of a queue name created or deleted by this
+ *  process. A NULL name drops those of all queues.
+ */
+static Void
+_MessageQ_dropCached (String name)
+{
+    if (MessageQ_module->nameServer != NULL) {
+        NameServer_invalidateEntries (MessageQ_module->nameServer, name);
+    }
+}
+
+
 /* =============================================================================
  * APIS
  * =============================================================================
@@ -304,6 +379,13 @@ MessageQ_setup (const MessageQ_Config * config)
                                      status,
                                      "API (through IOCTL) failed on kernel-side!");
             }
+            else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+                /* Not fatal: without it MessageQ_open skips the cache. */
+                MessageQ_module->nameServer =
+                                    NameServer_getHandle (MessageQ_NAMESERVER);
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+            }
         }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
     }
@@ -335,6 +417,10 @@ MessageQ_destroy (void)
                    MessageQ_module->setupRefCount);
     }
     else {
+        if (MessageQ_module->nameServer != NULL) {
+            NameServer_releaseHandle (&MessageQ_module->nameServer);
+        }
+
         status = MessageQDrv_ioctl (CMD_MESSAGEQ_DESTROY, &cmdArgs);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (status < 0) {
@@ -453,6 +539,10 @@ MessageQ_create (      String            name,
         status =
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
         MessageQDrv_ioctl (CMD_MESSAGEQ_CREATE, &cmdArgs);
+        if (name != NULL) {
+            /* A cached MessageQ_E_NOTFOUND for the name is now wrong. */
+            _MessageQ_dropCached (name);
+        }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (status < 0) {
             GT_setFailureReason (curTrace,
@@ -537,6 +627,8 @@ MessageQ_delete (MessageQ_Handle * handlePtr)
         GT_assert (curTrace,
                    (((MessageQ_Object *)(handlePtr))->knlObject != NULL));
         status = MessageQDrv_ioctl (CMD_MESSAGEQ_DELETE, &cmdArgs);
+        /* The handle does not keep the name, drop the lookups of all queues. */
+        _MessageQ_dropCached (NULL);
 
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (status < 0) {
@@ -611,21 +703,29 @@ MessageQ_open (String name, MessageQ_QueueId * queueId)
         /* Initialize return queue ID to invalid. */
         *queueId = MessageQ_INVALIDMESSAGEQ;
 
-        status = MessageQDrv_ioctl (CMD_MESSAGEQ_OPEN, &cmdArgs);
-#if !defined(SYSLINK_BUILD_OPTIMIZE)
-        /* MessageQ_E_NOTFOUND is a valid runtime failure. */
+        /* The kernel-side open is a lookup in the MessageQ NameServer, which
+         * the process-local NameServer cache answers without an ioctl.
+         */
+        status = _MessageQ_lookup (name, queueId);
         if ((status < 0) && (status != MessageQ_E_NOTFOUND)) {
-            GT_setFailureReason (curTrace,
-                                 GT_4CLASS,
-                                 "MessageQ_open",
-                                 status,
-                                 "API (through IOCTL) failed on kernel-side!");
-        }
-        else {
+            status = MessageQDrv_ioctl (CMD_MESSAGEQ_OPEN, &cmdArgs);
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+            /* MessageQ_E_NOTFOUND is a valid runtime failure. */
+            if ((status < 0) && (status != MessageQ_E_NOTFOUND)) {
+                GT_setFailureReason (curTrace,
+                                     GT_4CLASS,
+                                     "MessageQ_open",
+                                     status,
+                                     "API (through IOCTL) failed on kernel-side!");
+            }
+            else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
-            *queueId = cmdArgs.args.open.queueId;
+                *queueId = cmdArgs.args.open.queueId;
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
+            }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
         }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
     }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
 
@@ -830,6 +930,254 @@ MessageQ_get (MessageQ_Handle handle, MessageQ_Msg * msg ,UInt timeout)
 }
 
 
+/* Place several messages onto a message queue, up to MessageQ_BATCHSIZE per
+ * driver call.
+ */
+Int
+MessageQ_putv (MessageQ_QueueId queueId, MessageQ_Msg * msgs, UInt * count)
+{
+    Int                 status = MessageQ_S_SUCCESS;
+    UInt                done   = 0;
+    UInt                total;
+    UInt                batch;
+    UInt                i;
+    UInt16              index;
+    MessageQDrv_CmdArgs cmdArgs;
+    SharedRegion_SRPtr  msgSrPtrs [MessageQ_BATCHSIZE];
+
+    GT_3trace (curTrace, GT_ENTER, "MessageQ_putv", queueId, msgs, count);
+
+    GT_assert (curTrace, (queueId != MessageQ_INVALIDMESSAGEQ));
+    GT_assert (curTrace, (msgs != NULL));
+    GT_assert (curTrace, (count != NULL));
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if (MessageQ_module->setupRefCount == 0) {
+        status = MessageQ_E_INVALIDSTATE;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_putv",
+                             status,
+                             "Module is not initialized!");
+    }
+    else if (queueId == MessageQ_INVALIDMESSAGEQ) {
+        status = MessageQ_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_putv",
+                             status,
+                             "queueId is MessageQ_INVALIDMESSAGEQ!");
+    }
+    else if ((msgs == NULL) || (count == NULL)) {
+        status = MessageQ_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_putv",
+                             status,
+                             "msgs or count is null!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        total = *count;
+
+        while (     (status >= 0)
+                &&  (done < total)
+                &&  (MessageQ_module->batchSupported == TRUE)) {
+            batch = total - done;
+            if (batch > MessageQ_BATCHSIZE) {
+                batch = MessageQ_BATCHSIZE;
+            }
+
+            for (i = 0; i < batch; i++) {
+                GT_assert (curTrace, (msgs [done + i] != NULL));
+                index = SharedRegion_getId (msgs [done + i]);
+                msgSrPtrs [i] = SharedRegion_getSRPtr (msgs [done + i], index);
+            }
+
+            cmdArgs.args.batch.handle    = NULL;
+            cmdArgs.args.batch.queueId   = queueId;
+            cmdArgs.args.batch.timeout   = 0;
+            cmdArgs.args.batch.msgSrPtrs = msgSrPtrs;
+            cmdArgs.args.batch.count     = batch;
+
+            status = MessageQDrv_ioctl (CMD_MESSAGEQ_BATCH, &cmdArgs);
+            if (    (status == MessageQDrv_E_NOTSUPPORTED)
+                ||  (status == MessageQ_E_OSFAILURE)) {
+                /* The ioctl itself failed, so nothing was put. Put them one
+                 * at a time from now on. */
+                MessageQ_module->batchSupported = FALSE;
+                status = MessageQ_S_SUCCESS;
+            }
+            else if (status >= 0) {
+                done += batch;
+            }
+            else {
+                /* The driver reports how many made it before the failure. */
+                done += cmdArgs.args.batch.count;
+            }
+        }
+
+        while ((status >= 0) && (done < total)) {
+            status = MessageQ_put (queueId, msgs [done]);
+            if (status >= 0) {
+                done++;
+            }
+        }
+
+        *count = done;
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+        if (status < 0) {
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "MessageQ_putv",
+                                 status,
+                                 "Failed to put all the messages!");
+        }
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    GT_1trace (curTrace, GT_LEAVE, "MessageQ_putv", status);
+
+    return (status);
+}
+
+
+/* Gets the messages pending on a message queue. Waits for the first one
+ * only, the ones queued behind it are taken without waiting so that a reader
+ * drains the queue on each wakeup.
+ */
+Int
+MessageQ_getv (MessageQ_Handle   handle,
+               MessageQ_Msg    * msgs,
+               UInt            * count,
+               UInt              timeout)
+{
+    Int                 status  = MessageQ_S_SUCCESS;
+    Bool                drained = FALSE;
+    UInt                done    = 0;
+    UInt                total;
+    UInt                batch;
+    UInt                i;
+    MessageQDrv_CmdArgs cmdArgs;
+    SharedRegion_SRPtr  msgSrPtrs [MessageQ_BATCHSIZE];
+
+    GT_4trace (curTrace, GT_ENTER, "MessageQ_getv", handle, msgs, count,
+               timeout);
+
+    GT_assert (curTrace, (handle != NULL));
+    GT_assert (curTrace, (msgs != NULL));
+    GT_assert (curTrace, (count != NULL));
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if (MessageQ_module->setupRefCount == 0) {
+        status = MessageQ_E_INVALIDSTATE;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_getv",
+                             status,
+                             "Module is not initialized!");
+    }
+    else if (handle == NULL) {
+        status = MessageQ_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_getv",
+                             status,
+                             "handle pointer passed is null!");
+    }
+    else if ((msgs == NULL) || (count == NULL) || (*count == 0)) {
+        status = MessageQ_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_getv",
+                             status,
+                             "msgs or count is null or empty!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        GT_assert (curTrace,
+                   (((MessageQ_Object *)(handle))->knlObject != NULL));
+        total = *count;
+
+        while (     (drained == FALSE)
+                &&  (done < total)
+                &&  (MessageQ_module->batchSupported == TRUE)) {
+            batch = total - done;
+            if (batch > MessageQ_BATCHSIZE) {
+                batch = MessageQ_BATCHSIZE;
+            }
+
+            cmdArgs.args.batch.handle    =
+                                    ((MessageQ_Object *)(handle))->knlObject;
+            cmdArgs.args.batch.queueId   = MessageQ_INVALIDMESSAGEQ;
+            cmdArgs.args.batch.timeout   = (done == 0) ? timeout : 0;
+            cmdArgs.args.batch.msgSrPtrs = msgSrPtrs;
+            cmdArgs.args.batch.count     = batch;
+
+            status = MessageQDrv_ioctl (CMD_MESSAGEQ_BATCH, &cmdArgs);
+            if (    (status == MessageQDrv_E_NOTSUPPORTED)
+                ||  (status == MessageQ_E_OSFAILURE)) {
+                /* The ioctl itself failed, so nothing was taken. Get them
+                 * one at a time from now on. */
+                MessageQ_module->batchSupported = FALSE;
+                status = MessageQ_S_SUCCESS;
+            }
+            else if (status < 0) {
+                drained = TRUE;
+            }
+            else {
+                GT_assert (curTrace, (cmdArgs.args.batch.count <= batch));
+                for (i = 0; i < cmdArgs.args.batch.count; i++) {
+                    msgs [done + i] = (MessageQ_Msg)
+                                          SharedRegion_getPtr (msgSrPtrs [i]);
+                }
+                done += cmdArgs.args.batch.count;
+
+                /* A short batch means the queue is empty. */
+                if (cmdArgs.args.batch.count < batch) {
+                    drained = TRUE;
+                }
+            }
+        }
+
+        while ((drained == FALSE) && (done < total)) {
+            status = MessageQ_get (handle,
+                                   &msgs [done],
+                                   (done == 0) ? timeout : 0);
+            if (status < 0) {
+                drained = TRUE;
+            }
+            else {
+                done++;
+            }
+        }
+
+        /* Running out of messages after the first one is not an error. */
+        if ((done > 0) && (status == MessageQ_E_TIMEOUT)) {
+            status = MessageQ_S_SUCCESS;
+        }
+
+        *count = done;
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+        if (    (status < 0)
+            &&  (status != MessageQ_E_TIMEOUT)
+            &&  (status != MessageQ_E_UNBLOCKED)) {
+            /* Timeout and unblock are valid runtime errors. */
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "MessageQ_getv",
+                                 status,
+                                 "Failed to get the messages!");
+        }
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    GT_1trace (curTrace, GT_LEAVE, "MessageQ_getv", status);
+
+    return (status);
+}
+
+
 /* Return a count of the number of messages in the queue */
 Int
 MessageQ_count (MessageQ_Handle handle)
@@ -213,7 +213,14 @@ MessageQDrv_ioctl (UInt32 cmd, Ptr args)
         osStatus = ioctl (MessageQDrv_handle, cmd, args);
     } while( (osStatus < 0) && (errno == EINTR) );
 
-    if (osStatus < 0) {
+    if (    (osStatus < 0)
+        &&  (cmd == CMD_MESSAGEQ_BATCH)
+        &&  ((errno == ENOTTY) || (errno == EINVAL))) {
+        /*! @retval MessageQDrv_E_NOTSUPPORTED Batch command unknown to the
+         *          driver. Other commands keep MessageQ_E_OSFAILURE. */
+        status = MessageQDrv_E_NOTSUPPORTED;
+    }
+    else if (osStatus < 0) {
         /*! @retval MessageQ_E_OSFAILURE Driver ioctl failed */
         status = MessageQ_E_OSFAILURE;
         GT_setFailureReason (curTrace,
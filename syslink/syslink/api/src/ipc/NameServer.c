@@ -91,6 +91,7 @@
 
 
 /* Standard headers */
+#include <time.h>
 #include <Std.h>
 
 /* Utilities & OSAL headers */
@@ -112,6 +113,42 @@ extern "C" {
 #endif
 
 
+/* =============================================================================
+ * Macros
+ * =============================================================================
+ */
+/*!
+ *  @brief  Lifetime in ms of a cached value. Only changes made in this
+ *          process, and remote processor faults, drop entries before that.
+ *          A name removed, or removed and added again, by another process or
+ *          a remote core keeps resolving to its old value for up to this
+ *          long: MessageQ_open can return the queue id of a deleted queue,
+ *          and a put to it fails. 0 disables caching of values.
+ */
+#if !defined(NameServer_CACHE_TTL_MS)
+#define NameServer_CACHE_TTL_MS         250u
+#endif /* if !defined(NameServer_CACHE_TTL_MS) */
+
+/*!
+ *  @brief  Lifetime in ms of a cached NameServer_E_NOTFOUND, so that a name
+ *          created by a remote core or another process is not missed for long.
+ *          0 disables negative caching.
+ */
+#if !defined(NameServer_CACHE_NEGTTL_MS)
+#define NameServer_CACHE_NEGTTL_MS      50u
+#endif /* if !defined(NameServer_CACHE_NEGTTL_MS) */
+
+/*!
+ *  @brief  Number of hash buckets of the lookup cache
+ */
+#define NameServer_CACHE_NUMBUCKETS     64u
+
+/*!
+ *  @brief  Number of entries above which the whole cache is dropped
+ */
+#define NameServer_CACHE_MAXENTRIES     256u
+
+
 /* =============================================================================
  * Structures & Enums
  * =============================================================================
@@ -123,6 +160,29 @@ typedef struct NameServer_Object {
     /*!< Pointer to the kernel-side ProcMgr object. */
 } NameServer_Object;
 
+/*!
+ *  @brief  Result of a NameServer_get or NameServer_getLocal kept by the
+ *          process-local lookup cache
+ */
+typedef struct NameServer_CacheEntry_tag {
+    struct NameServer_CacheEntry_tag * next;
+    /*!< Next entry in the same bucket */
+    Ptr                 knlObject;
+    /*!< Kernel-side NameServer the lookup was made on */
+    String              name;
+    /*!< Name looked up, stored after the value */
+    Bool                local;
+    /*!< TRUE for NameServer_getLocal, FALSE for NameServer_get */
+    UInt32              reqLen;
+    /*!< Buffer length passed to the lookup */
+    Int                 status;
+    /*!< NameServer_S_SUCCESS, or NameServer_E_NOTFOUND for a negative entry */
+    unsigned long long  expires;
+    /*!< Monotonic time in ms after which the entry is stale */
+    UInt32              len;
+    /*!< Length of the value, stored right after the entry */
+} NameServer_CacheEntry;
+
 /*!
  *  @brief  ProcMgr Module state object
  */
@@ -134,6 +194,13 @@ typedef struct NameServer_ModuleObject_tag {
     UInt32              refCount;
     /*!< Reference count for number of times setup/destroy were called in this
          process. */
+    NameServer_CacheEntry * cache [NameServer_CACHE_NUMBUCKETS];
+    /*!< Lookup cache, protected by the system gate */
+    UInt32              cacheGen;
+    /*!< Bumped on every invalidation, so that a lookup racing with one does
+         not cache what it got from the kernel. */
+    NameServer_CacheStats cacheStats;
+    /*!< Lookup cache counters */
 } NameServer_ModuleObject;
 
 
@@ -165,6 +232,267 @@ static
 NameServer_ModuleObject * NameServer_module = &NameServer_state;
 
 
+/* =============================================================================
+ * Lookup cache
+ * =============================================================================
+ */
+/* Current monotonic time in ms */
+static unsigned long long
+_NameServer_cacheNow (Void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (unsigned long long) ts.tv_sec * 1000u + ts.tv_nsec / 1000000u;
+}
+
+
+/* Bucket of a (kernel object, name) pair */
+static UInt32
+_NameServer_cacheHash (Ptr knlObject, String name)
+{
+    UInt32 hash = (UInt32) knlObject >> 3;
+
+    while (*name != '\0') {
+        hash = (hash * 31u) + (UInt8) *name++;
+    }
+
+    return hash % NameServer_CACHE_NUMBUCKETS;
+}
+
+
+/* Frees a chain of entries unlinked from the cache */
+static Void
+_NameServer_cacheFree (NameServer_CacheEntry * list)
+{
+    NameServer_CacheEntry * entry;
+
+    while (list != NULL) {
+        entry = list;
+        list  = list->next;
+        Memory_free (NULL,
+                     entry,
+                     sizeof (NameServer_CacheEntry) + entry->len
+                     + String_len (entry->name) + 1);
+    }
+}
+
+
+/*
+ *  ======== _NameServer_cacheInvalidate ========
+ *  Drops the entries of name in the NameServer knlObject. A NULL name drops
+ *  all the entries of that NameServer, a NULL knlObject the whole cache.
+ */
+static Void
+_NameServer_cacheInvalidate (Ptr knlObject, String name)
+{
+    NameServer_CacheEntry *  dropped = NULL;
+    NameServer_CacheEntry ** link;
+    NameServer_CacheEntry *  entry;
+    UInt32                   first   = 0u;
+    UInt32                   last    = NameServer_CACHE_NUMBUCKETS - 1u;
+    UInt32                   i;
+    IArg                     key;
+
+    if ((knlObject != NULL) && (name != NULL)) {
+        first = last = _NameServer_cacheHash (knlObject, name);
+    }
+
+    key = Gate_enterSystem ();
+
+    NameServer_module->cacheGen++;
+    NameServer_module->cacheStats.invalidations++;
+
+    for (i = first; i <= last; i++) {
+        link = &NameServer_module->cache [i];
+        while (*link != NULL) {
+            entry = *link;
+            if (    ((knlObject == NULL) || (entry->knlObject == knlObject))
+                &&  ((name == NULL) || (String_cmp (entry->name, name) == 0))) {
+                *link       = entry->next;
+                entry->next = dropped;
+                dropped     = entry;
+                NameServer_module->cacheStats.entries--;
+            }
+            else {
+                link = &entry->next;
+            }
+        }
+    }
+
+    Gate_leaveSystem (key);
+
+    _NameServer_cacheFree (dropped);
+}
+
+
+/*
+ *  ======== _NameServer_cacheGet ========
+ *  Looks a lookup up in the cache. On a hit returns TRUE with the cached
+ *  status, and the value in value and len for a positive entry. On a miss
+ *  returns FALSE with the generation to hand back to _NameServer_cachePut.
+ */
+static Bool
+_NameServer_cacheGet (Ptr       knlObject,
+                      String    name,
+                      Bool      local,
+                      Ptr       value,
+                      UInt32  * len,
+                      Int     * status,
+                      UInt32  * gen)
+{
+    Bool                    hit    = FALSE;
+    unsigned long long      now    = _NameServer_cacheNow ();
+    UInt32                  bucket = _NameServer_cacheHash (knlObject, name);
+    NameServer_CacheEntry * entry;
+    IArg                    key;
+
+    key = Gate_enterSystem ();
+
+    for (entry = NameServer_module->cache [bucket];
+         entry != NULL;
+         entry = entry->next) {
+        if (    (entry->knlObject == knlObject)
+            &&  (entry->local == local)
+            &&  (entry->reqLen == *len)
+            &&  (String_cmp (entry->name, name) == 0)) {
+            break;
+        }
+    }
+
+    /* A stale entry is left in place for the refill to replace. */
+    if ((entry != NULL) && (now < entry->expires)) {
+        hit     = TRUE;
+        *status = entry->status;
+        if (entry->status >= 0) {
+            Memory_copy (value, (Ptr) (entry + 1), entry->len);
+            *len = entry->len;
+            NameServer_module->cacheStats.hits++;
+        }
+        else {
+            NameServer_module->cacheStats.negHits++;
+        }
+    }
+    else {
+        *gen = NameServer_module->cacheGen;
+        NameServer_module->cacheStats.misses++;
+    }
+
+    Gate_leaveSystem (key);
+
+    return hit;
+}
+
+
+/*
+ *  ======== _NameServer_cachePut ========
+ *  Caches the result of a lookup that missed, unless the cache was
+ *  invalidated since (gen no longer current). reqLen is the buffer length
+ *  that was asked for, len the length of the value returned.
+ */
+static Void
+_NameServer_cachePut (Ptr       knlObject,
+                      String    name,
+                      Bool      local,
+                      UInt32    reqLen,
+                      Int       status,
+                      Ptr       value,
+                      UInt32    len,
+                      UInt32    gen)
+{
+    NameServer_CacheEntry *  dropped = NULL;
+    NameServer_CacheEntry *  entry;
+    NameServer_CacheEntry ** link;
+    UInt32                   nameLen;
+    UInt32                   ttl;
+    UInt32                   bucket;
+    UInt32                   i;
+    IArg                     key;
+
+    ttl = (status >= 0) ? NameServer_CACHE_TTL_MS : NameServer_CACHE_NEGTTL_MS;
+    if (ttl == 0u) {
+        return;
+    }
+    if (status < 0) {
+        len = 0u;
+    }
+
+    nameLen = String_len (name) + 1;
+    entry = (NameServer_CacheEntry *) Memory_alloc (NULL,
+                                      sizeof (NameServer_CacheEntry) + len
+                                      + nameLen,
+                                      0);
+    if (entry == NULL) {
+        /* Not caching is always correct. */
+        return;
+    }
+
+    entry->next      = NULL;
+    entry->knlObject = knlObject;
+    entry->local     = local;
+    entry->reqLen    = reqLen;
+    entry->status    = status;
+    entry->expires   = _NameServer_cacheNow () + ttl;
+    entry->len       = len;
+    entry->name      = (String) ((UInt8 *) (entry + 1) + len);
+    Memory_copy (entry->name, name, nameLen);
+    if (len != 0u) {
+        Memory_copy ((Ptr) (entry + 1), value, len);
+    }
+
+    bucket = _NameServer_cacheHash (knlObject, name);
+
+    key = Gate_enterSystem ();
+
+    if (gen != NameServer_module->cacheGen) {
+        /* Raced with an invalidation, the result may already be stale. */
+        dropped = entry;
+        entry   = NULL;
+    }
+    else {
+        if (  NameServer_module->cacheStats.entries
+            >= NameServer_CACHE_MAXENTRIES) {
+            for (i = 0u; i < NameServer_CACHE_NUMBUCKETS; i++) {
+                link = &NameServer_module->cache [i];
+                while (*link != NULL) {
+                    link = &(*link)->next;
+                }
+                *link = dropped;
+                dropped = NameServer_module->cache [i];
+                NameServer_module->cache [i] = NULL;
+            }
+            NameServer_module->cacheStats.entries = 0u;
+        }
+        else {
+            /* Replace the stale entry for the same lookup, if any. */
+            link = &NameServer_module->cache [bucket];
+            while (*link != NULL) {
+                if (    ((*link)->knlObject == knlObject)
+                    &&  ((*link)->local == local)
+                    &&  ((*link)->reqLen == reqLen)
+                    &&  (String_cmp ((*link)->name, name) == 0)) {
+                    dropped       = *link;
+                    *link         = dropped->next;
+                    dropped->next = NULL;
+                    NameServer_module->cacheStats.entries--;
+                    break;
+                }
+                link = &(*link)->next;
+            }
+        }
+
+        entry->next = NameServer_module->cache [bucket];
+        NameServer_module->cache [bucket] = entry;
+        NameServer_module->cacheStats.entries++;
+    }
+
+    Gate_leaveSystem (key);
+
+    _NameServer_cacheFree (dropped);
+}
+
+
 /* =============================================================================
  * APIS
  * =============================================================================
@@ -262,6 +590,12 @@ NameServer_setup (Void)
                    NameServer_module->refCount);
     }
     else {
+        /* Whatever was cached before an Ipc restart is stale. */
+        _NameServer_cacheInvalidate (NULL, NULL);
+        Memory_set (&NameServer_module->cacheStats,
+                    0,
+                    sizeof (NameServer_CacheStats));
+
         /* Open the driver handle. */
         status = NameServerDrv_open ();
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
@@ -327,6 +661,8 @@ NameServer_destroy (Void)
 
         /* Close the driver handle. */
         NameServerDrv_close ();
+
+        _NameServer_cacheInvalidate (NULL, NULL);
     }
 
     GT_1trace (curTrace, GT_LEAVE, "NameServer_destroy", status);
@@ -514,6 +850,7 @@ NameServer_delete (NameServer_Handle * handlePtr)
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
         cmdArgs.args.delete.handle = (*handlePtr)->knlObject;
         status = NameServerDrv_ioctl (CMD_NAMESERVER_DELETE, &cmdArgs);
+        _NameServer_cacheInvalidate ((*handlePtr)->knlObject, NULL);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (status < 0) {
             GT_setFailureReason (curTrace,
@@ -597,6 +934,11 @@ NameServer_add (NameServer_Handle handle, String name, Ptr buf, UInt len)
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
         NameServerDrv_ioctl (CMD_NAMESERVER_ADD, &cmdArgs);
         new_node = cmdArgs.args.add.node;
+        /* Drop a cached NameServer_E_NOTFOUND for the name. Done after the
+         * kernel call so that a lookup racing with it cannot cache the old
+         * state.
+         */
+        _NameServer_cacheInvalidate (handle->knlObject, name);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (status < 0) {
             GT_setFailureReason (curTrace,
@@ -709,6 +1051,7 @@ NameServer_remove (NameServer_Handle handle, String name)
         cmdArgs.args.remove.name    = name;
         cmdArgs.args.remove.nameLen = String_len (name) + 1;
         status = NameServerDrv_ioctl (CMD_NAMESERVER_REMOVE, &cmdArgs);
+        _NameServer_cacheInvalidate (handle->knlObject, name);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (status < 0) {
             GT_setFailureReason (curTrace,
@@ -769,6 +1112,8 @@ NameServer_removeEntry (NameServer_Handle handle, Ptr entry)
         cmdArgs.args.removeEntry.handle = handle->knlObject;
         cmdArgs.args.removeEntry.entry  = entry;
         status = NameServerDrv_ioctl (CMD_NAMESERVER_REMOVEENTRY, &cmdArgs);
+        /* The entry does not tell the name, drop the whole NameServer. */
+        _NameServer_cacheInvalidate (handle->knlObject, NULL);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (status < 0) {
             GT_setFailureReason (curTrace,
@@ -799,6 +1144,8 @@ NameServer_get (NameServer_Handle handle,
     Int                   status  = NameServer_S_SUCCESS;
     UInt32                procLen = 0;
     UInt32                i       = 0u;
+    UInt32                gen     = 0u;
+    Bool                  cached  = (procId == NULL);
     NameServerDrv_CmdArgs cmdArgs;
 
     GT_5trace (curTrace, GT_ENTER, "NameServer_get",
@@ -860,35 +1207,55 @@ NameServer_get (NameServer_Handle handle,
     }
     else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
-        cmdArgs.args.get.handle  = handle->knlObject;
-        cmdArgs.args.get.name    = name;
-        cmdArgs.args.get.nameLen = String_len (name) + 1;
-        cmdArgs.args.get.value   = value;
-        cmdArgs.args.get.len     = *len;
-        cmdArgs.args.get.procId  = procId;
-        if (procId != NULL) {
-            while (procId[i] != 0xFFFF) { /* TBD */
-                procLen++;
-                i++;
+        /* Only lookups over all processors are cached, the answer to a
+         * given procId list is not worth the bookkeeping.
+         */
+        if (    (cached == FALSE)
+            ||  (_NameServer_cacheGet (handle->knlObject, name, FALSE,
+                                       value, len, &status, &gen) == FALSE)) {
+            cmdArgs.args.get.handle  = handle->knlObject;
+            cmdArgs.args.get.name    = name;
+            cmdArgs.args.get.nameLen = String_len (name) + 1;
+            cmdArgs.args.get.value   = value;
+            cmdArgs.args.get.len     = *len;
+            cmdArgs.args.get.procId  = procId;
+            if (procId != NULL) {
+                while (procId[i] != 0xFFFF) { /* TBD */
+                    procLen++;
+                    i++;
+                }
+            }
+            cmdArgs.args.get.procLen = procLen;
+            status = NameServerDrv_ioctl (CMD_NAMESERVER_GET, &cmdArgs);
+            if ((status >= 0) || (status == NameServer_E_NOTFOUND)) {
+                if (cached == TRUE) {
+                    _NameServer_cachePut (handle->knlObject, name, FALSE, *len,
+                                          status, value, cmdArgs.args.get.len,
+                                          gen);
+                }
+            }
+            else {
+                /* Typically a remote processor going through recovery. */
+                _NameServer_cacheInvalidate (NULL, NULL);
             }
-        }
-        cmdArgs.args.get.procLen = procLen;
-        status = NameServerDrv_ioctl (CMD_NAMESERVER_GET, &cmdArgs);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
-        /* NameServer_E_NOTFOUND is a valid run-time failure. */
-        if ((status < 0) && (status != NameServer_E_NOTFOUND)) {
-            GT_setFailureReason (curTrace,
-                                 GT_4CLASS,
-                                 "NameServer_get",
-                                 status,
-                                 "API (through IOCTL) failed on kernel-side!");
-        }
-        else {
+            /* NameServer_E_NOTFOUND is a valid run-time failure. */
+            if ((status < 0) && (status != NameServer_E_NOTFOUND)) {
+                GT_setFailureReason (curTrace,
+                                  GT_4CLASS,
+                                  "NameServer_get",
+                                  status,
+                                  "API (through IOCTL) failed on kernel-side!");
+            }
+            else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
-            /* Return updated len */
-            *len = cmdArgs.args.get.len;
+                /* Return updated len */
+                *len = cmdArgs.args.get.len;
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
+            }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
         }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
     }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
 
@@ -916,6 +1283,7 @@ NameServer_getLocal (NameServer_Handle handle,
                      UInt32          * len)
 {
     Int                   status = NameServer_S_SUCCESS;
+    UInt32                gen    = 0u;
     NameServerDrv_CmdArgs cmdArgs;
 
     GT_4trace (curTrace, GT_ENTER, "NameServer_getLocal",
@@ -977,26 +1345,39 @@ NameServer_getLocal (NameServer_Handle handle,
     }
     else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
-        cmdArgs.args.getLocal.handle  = handle->knlObject;
-        cmdArgs.args.getLocal.name    = name;
-        cmdArgs.args.getLocal.nameLen = String_len (name) + 1;
-        cmdArgs.args.getLocal.value   = value;
-        cmdArgs.args.getLocal.len     = *len;
-        status = NameServerDrv_ioctl (CMD_NAMESERVER_GETLOCAL, &cmdArgs);
+        if (_NameServer_cacheGet (handle->knlObject, name, TRUE,
+                                  value, len, &status, &gen) == FALSE) {
+            cmdArgs.args.getLocal.handle  = handle->knlObject;
+            cmdArgs.args.getLocal.name    = name;
+            cmdArgs.args.getLocal.nameLen = String_len (name) + 1;
+            cmdArgs.args.getLocal.value   = value;
+            cmdArgs.args.getLocal.len     = *len;
+            status = NameServerDrv_ioctl (CMD_NAMESERVER_GETLOCAL, &cmdArgs);
+            if ((status >= 0) || (status == NameServer_E_NOTFOUND)) {
+                _NameServer_cachePut (handle->knlObject, name, TRUE, *len,
+                                      status, value, cmdArgs.args.getLocal.len,
+                                      gen);
+            }
+            else {
+                _NameServer_cacheInvalidate (NULL, NULL);
+            }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
-        if (status < 0) {
-            GT_setFailureReason (curTrace,
-                                 GT_4CLASS,
-                                 "NameServer_getLocal",
-                                 status,
-                                 "API (through IOCTL) failed on kernel-side!");
-        }
-        else {
+            if (status < 0) {
+                GT_setFailureReason (curTrace,
+                                  GT_4CLASS,
+                                  "NameServer_getLocal",
+                                  status,
+                                  "API (through IOCTL) failed on kernel-side!");
+            }
+            else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
-            /* Return updated len */
-            *len = cmdArgs.args.get.len;
+                /* Return updated len */
+                *len = cmdArgs.args.get.len;
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
+            }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
         }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
     }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
 
@@ -1299,6 +1680,109 @@ NameServer_getHandle (String name)
 }
 
 
+/* Function to get the counters of the lookup cache. */
+Void
+NameServer_getCacheStats (NameServer_CacheStats * stats)
+{
+    IArg key;
+
+    GT_1trace (curTrace, GT_ENTER, "NameServer_getCacheStats", stats);
+
+    GT_assert (curTrace, (stats != NULL));
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if (stats == NULL) {
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "NameServer_getCacheStats",
+                             NameServer_E_INVALIDARG,
+                             "stats passed is null!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        key = Gate_enterSystem ();
+        Memory_copy (stats,
+                     &NameServer_module->cacheStats,
+                     sizeof (NameServer_CacheStats));
+        Gate_leaveSystem (key);
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    GT_0trace (curTrace, GT_LEAVE, "NameServer_getCacheStats");
+}
+
+
+/* Function to drop everything in the lookup cache. */
+Void
+NameServer_invalidateCache (Void)
+{
+    GT_0trace (curTrace, GT_ENTER, "NameServer_invalidateCache");
+
+    _NameServer_cacheInvalidate (NULL, NULL);
+
+    GT_0trace (curTrace, GT_LEAVE, "NameServer_invalidateCache");
+}
+
+
+/* Function to drop the cached lookups of a name, or of all names. */
+Void
+NameServer_invalidateEntries (NameServer_Handle handle, String name)
+{
+    GT_2trace (curTrace, GT_ENTER, "NameServer_invalidateEntries",
+               handle, name);
+
+    GT_assert (curTrace, (handle != NULL));
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if (handle == NULL) {
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "NameServer_invalidateEntries",
+                             NameServer_E_INVALIDARG,
+                             "handle passed is null!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        _NameServer_cacheInvalidate (handle->knlObject, name);
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    GT_0trace (curTrace, GT_LEAVE, "NameServer_invalidateEntries");
+}
+
+
+/* Function to free a handle returned by NameServer_getHandle. */
+Void
+NameServer_releaseHandle (NameServer_Handle * handlePtr)
+{
+    GT_1trace (curTrace, GT_ENTER, "NameServer_releaseHandle", handlePtr);
+
+    GT_assert (curTrace, (handlePtr != NULL));
+    GT_assert (curTrace, ((handlePtr != NULL) && (*handlePtr != NULL)));
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if ((handlePtr == NULL) || (*handlePtr == NULL)) {
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "NameServer_releaseHandle",
+                             NameServer_E_INVALIDARG,
+                             "handlePtr or *handlePtr passed is null!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        /* The kernel-side instance and its cached lookups stay. */
+        Memory_free (NULL, *handlePtr, sizeof (NameServer_Object));
+        *handlePtr = NULL;
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    GT_0trace (curTrace, GT_LEAVE, "NameServer_releaseHandle");
+}
+
+
 /* =============================================================================
  * Internal functions
  * =============================================================================
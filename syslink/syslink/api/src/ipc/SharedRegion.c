@@ -128,6 +128,23 @@ UInt32 SharedRegion_getNumOffsetBits();
  */
 Int SharedRegion_checkOverlap (Ptr    base, UInt32 len);
 
+/*!
+ *  @brief      Builds a translation table from the regions and makes it the
+ *              current one. Called with the gate held, or before the module
+ *              is shared between threads.
+ *
+ *  @sa         None
+ */
+static Int _SharedRegion_publishXlt (Void);
+
+/*!
+ *  @brief      Frees the current and the retired translation tables. No
+ *              reader may be running.
+ *
+ *  @sa         None
+ */
+static Void _SharedRegion_freeXlt (Void);
+
 
 /* =============================================================================
  * Macros and types
@@ -145,6 +162,32 @@ Int SharedRegion_checkOverlap (Ptr    base, UInt32 len);
  * Structure & Enums
  * =============================================================================
  */
+/*!
+ *  @brief  Address range of a valid region in the translation table
+ */
+typedef struct SharedRegion_XltRange_tag {
+    UInt32                base;           /*!< First address of the region */
+    UInt32                end;            /*!< base + len, 0 if not valid */
+    UInt16                id;             /*!< Region id */
+} SharedRegion_XltRange;
+
+/*!
+ *  @brief  Translation table, an immutable snapshot of the region bases
+ *
+ *  getId, getPtr and getSRPtr read the current table without taking the
+ *  gate. Writers build a new table under the gate and publish it with a
+ *  single pointer store. A table is never modified once published, and the
+ *  ones it replaces are only freed by SharedRegion_destroy, since a reader
+ *  may still be walking them. Regions change a few times per process, so
+ *  the retired tables stay few.
+ */
+typedef struct SharedRegion_Xlt_tag {
+    struct SharedRegion_Xlt_tag * next;   /*!< Next retired table */
+    UInt32                  numRanges;    /*!< Number of valid regions */
+    SharedRegion_XltRange * ranges;       /*!< Valid regions sorted by base */
+    SharedRegion_XltRange * byId;         /*!< All regions indexed by id */
+} SharedRegion_Xlt;
+
 /*!
  *  @brief  SharedRegion Module state object
  */
@@ -162,6 +205,8 @@ typedef struct SharedRegion_ModuleObject_tag {
                                                * in knl space
                                                */
     SharedRegion_Config   cfg;        /*!< Current config values */
+    SharedRegion_Xlt * volatile xlt;  /*!< Current translation table */
+    SharedRegion_Xlt    * retired;    /*!< Tables replaced since setup */
 } SharedRegion_ModuleObject;
 
 
@@ -184,6 +229,8 @@ SharedRegion_ModuleObject SharedRegion_state =
     .regions              = NULL,
     .localLock            = NULL,
     .offsetMask           = 0,
+    .xlt                  = NULL,
+    .retired              = NULL,
 };
 
 /*!
@@ -419,6 +466,11 @@ SharedRegion_setup (SharedRegion_Config * cfg)
                 }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
             }
+
+            if (status >= 0) {
+                /* Regions already set up on kernel-side came with setup. */
+                status = _SharedRegion_publishXlt ();
+            }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
@@ -469,6 +521,8 @@ SharedRegion_destroy (Void)
             key = IGateProvider_enter (SharedRegion_module->localLock);
         }
 
+        _SharedRegion_freeXlt ();
+
         if (SharedRegion_module->bCreatedInKnlSpace != NULL) {
             Memory_free (NULL,
                          SharedRegion_module->bCreatedInKnlSpace,
@@ -745,6 +799,7 @@ SharedRegion_setEntry (UInt16               id,
             Memory_copy ((Ptr) &(region->entry),
                          (Ptr) entry,
                          sizeof (SharedRegion_Entry));
+            status = _SharedRegion_publishXlt ();
 
             /* Leave the gate */
             IGateProvider_leave (SharedRegion_module->localLock, key);
@@ -767,15 +822,16 @@ SharedRegion_setEntry (UInt16               id,
 UInt16
 SharedRegion_getId (Ptr addr)
 {
-    SharedRegion_Region  * region = NULL;
-    UInt16                 id = SharedRegion_INVALIDREGIONID;
-    UInt32                 i;
-    IArg                   key;
+    SharedRegion_Xlt      * xlt = NULL;
+    SharedRegion_XltRange * range;
+    UInt16                  id  = SharedRegion_INVALIDREGIONID;
+    UInt32                  lo;
+    UInt32                  hi;
+    UInt32                  mid;
 
     GT_1trace (curTrace, GT_ENTER, "SharedRegion_getId", addr);
 
     /* addr can be NULL. */
-
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
     if (SharedRegion_module->setupRefCount == 0) {
         GT_setFailureReason (curTrace,
@@ -788,29 +844,32 @@ SharedRegion_getId (Ptr addr)
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
     /* Return invalid for NULL addr */
     if (addr != NULL) {
-        /* Enter the gate */
-        key = IGateProvider_enter (SharedRegion_module->localLock);
-
-        for (i = 0; i < SharedRegion_module->cfg.numEntries; i++) {
-            region = &(SharedRegion_module->regions [i]);
-            if (   (region->entry.isValid)
-                && (addr >= region->entry.base)
-                && (  addr
-                    < (Ptr)((UInt32) region->entry.base + region->entry.len))) {
-
-                id = i;
-                break;
+        /* No gate, see SharedRegion_Xlt. */
+        xlt = SharedRegion_module->xlt;
+        if (xlt != NULL) {
+            /* Binary search of the valid regions, which do not overlap. */
+            lo = 0;
+            hi = xlt->numRanges;
+            while (lo < hi) {
+                mid   = (lo + hi) >> 1;
+                range = &(xlt->ranges [mid]);
+                if ((UInt32) addr < range->base) {
+                    hi = mid;
+                }
+                else if ((UInt32) addr >= range->end) {
+                    lo = mid + 1;
+                }
+                else {
+                    id = range->id;
+                    break;
+                }
             }
         }
-
-        /* Leave the gate */
-        IGateProvider_leave (SharedRegion_module->localLock, key);
     }
 
     GT_1trace (curTrace, GT_LEAVE, "SharedRegion_getId", id);
 
     return id;
-
 }
 
 
@@ -819,9 +878,8 @@ Ptr
 SharedRegion_getPtr (SharedRegion_SRPtr srPtr)
 {
 
-    SharedRegion_Region * region    = NULL;
+    SharedRegion_Xlt    * xlt       = NULL;
     Ptr                   returnPtr = NULL;
-    IArg                  key    = 0;
     UInt16                regionId;
 
     GT_1trace (curTrace, GT_ENTER, "SharedRegion_getPtr", srPtr);
@@ -844,8 +902,8 @@ SharedRegion_getPtr (SharedRegion_SRPtr srPtr)
             returnPtr = (Ptr) srPtr;
         }
         else {
-            /* Enter the gate */
-            key = IGateProvider_enter (SharedRegion_module->localLock);
+            /* No gate, see SharedRegion_Xlt. */
+            xlt = SharedRegion_module->xlt;
 
             regionId = (UInt32) (srPtr >> SharedRegion_module->numOffsetBits);
 
@@ -857,17 +915,12 @@ SharedRegion_getPtr (SharedRegion_SRPtr srPtr)
                                      SharedRegion_E_INVALIDARG,
                                      "Id cannot be larger than numEntries!");
             }
-            else {
+            else
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
-                region = &(SharedRegion_module->regions [regionId]);
-
+            if (xlt != NULL) {
                 returnPtr = (Ptr)(  (srPtr & SharedRegion_module->offsetMask)
-                                  + (UInt32) region->entry.base);
-#if !defined(SYSLINK_BUILD_OPTIMIZE)
+                                  + xlt->byId [regionId].base);
             }
-#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
-            /* Leave the gate */
-            IGateProvider_leave (SharedRegion_module->localLock, key);
         }
     }
 
@@ -882,9 +935,9 @@ SharedRegion_getPtr (SharedRegion_SRPtr srPtr)
 SharedRegion_SRPtr
 SharedRegion_getSRPtr (Ptr addr, UInt16 id)
 {
-    SharedRegion_Region * region  = NULL;
-    SharedRegion_SRPtr    retPtr = SharedRegion_INVALIDSRPTR ;
-    IArg                  key    = 0;
+    SharedRegion_Xlt      * xlt    = NULL;
+    SharedRegion_XltRange * range  = NULL;
+    SharedRegion_SRPtr      retPtr = SharedRegion_INVALIDSRPTR ;
 
     GT_2trace (curTrace, GT_ENTER, "SharedRegion_getSRPtr", addr, id);
 
@@ -929,10 +982,11 @@ SharedRegion_getSRPtr (Ptr addr, UInt16 id)
                 retPtr = (SharedRegion_SRPtr) addr;
             }
             else {
-                /* Enter the gate */
-                key = IGateProvider_enter (SharedRegion_module->localLock);
-
-                region = &(SharedRegion_module->regions[id]);
+                /* No gate, see SharedRegion_Xlt. */
+                xlt = SharedRegion_module->xlt;
+                if (xlt != NULL) {
+                    range = &(xlt->byId [id]);
+                }
 
                 /*
                  *  Note: The very last byte on the very last id cannot be
@@ -945,12 +999,12 @@ SharedRegion_getSRPtr (Ptr addr, UInt16 id)
                  *            ==> address 0x3fffffff would be invalid because
                  *                the SRPtr for this address is 0xffffffff
                  */
-                if (    ((UInt32) addr >= (UInt32) region->entry.base)
-                    &&  (  (UInt32) addr
-                         < ((UInt32) region->entry.base + region->entry.len))) {
+                if (    (range != NULL)
+                    &&  ((UInt32) addr >= range->base)
+                    &&  ((UInt32) addr < range->end)) {
                     retPtr = (SharedRegion_SRPtr)
                               (  (id << SharedRegion_module->numOffsetBits)
-                               | ((UInt32) addr - (UInt32) region->entry.base));
+                               | ((UInt32) addr - range->base));
                 }
                 else {
                     retPtr = SharedRegion_INVALIDSRPTR;
@@ -961,8 +1015,6 @@ SharedRegion_getSRPtr (Ptr addr, UInt16 id)
                                          "Provided addr is not in correct range"
                                          " for the specified id!");
                 }
-                /* Leave the gate */
-                IGateProvider_leave (SharedRegion_module->localLock, key);
             }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         }
@@ -1045,6 +1097,7 @@ SharedRegion_clearEntry (UInt16 id)
             region->entry.name          = NULL;
             region->reservedSize        = 0u;
             region->heap                = NULL;
+            status = _SharedRegion_publishXlt ();
 
             /* Leave the gate */
             IGateProvider_leave (SharedRegion_module->localLock, key);
@@ -1760,6 +1813,107 @@ SharedRegion_getRegionInfo (UInt16                i,
     GT_0trace (curTrace, GT_LEAVE, "SharedRegion_getRegionInfo");
 }
 
+/* Builds a translation table from the regions and makes it the current one. */
+static Int
+_SharedRegion_publishXlt (Void)
+{
+    Int                     status     = SharedRegion_S_SUCCESS;
+    UInt32                  numEntries = SharedRegion_module->cfg.numEntries;
+    SharedRegion_Xlt      * xlt;
+    SharedRegion_XltRange   range;
+    SharedRegion_Region   * region;
+    UInt32                  i;
+    UInt32                  j;
+
+    GT_0trace (curTrace, GT_ENTER, "_SharedRegion_publishXlt");
+
+    xlt = (SharedRegion_Xlt *) Memory_alloc (NULL,
+                                     (   sizeof (SharedRegion_Xlt)
+                                      +  (  2 * numEntries
+                                          * sizeof (SharedRegion_XltRange))),
+                                     0);
+    if (xlt == NULL) {
+        /* The current table stays, without the change. */
+        status = SharedRegion_E_MEMORY;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "_SharedRegion_publishXlt",
+                             status,
+                             "Failed to allocate the translation table!");
+    }
+    else {
+        xlt->next      = NULL;
+        xlt->numRanges = 0;
+        xlt->byId      = (SharedRegion_XltRange *) (xlt + 1);
+        xlt->ranges    = xlt->byId + numEntries;
+
+        for (i = 0; i < numEntries; i++) {
+            region = &(SharedRegion_module->regions [i]);
+            range.base = (UInt32) region->entry.base;
+            range.end  = range.base + region->entry.len;
+            range.id   = i;
+            xlt->byId [i] = range;
+
+            if (region->entry.isValid) {
+                /* Insertion sort by base, there are only a few regions. */
+                for (j = xlt->numRanges;
+                     (j > 0) && (xlt->ranges [j - 1].base > range.base);
+                     j--) {
+                    xlt->ranges [j] = xlt->ranges [j - 1];
+                }
+                xlt->ranges [j] = range;
+                xlt->numRanges++;
+            }
+        }
+
+        /* The table must be complete before readers can see it. */
+        __sync_synchronize ();
+
+        if (SharedRegion_module->xlt != NULL) {
+            SharedRegion_module->xlt->next = SharedRegion_module->retired;
+            SharedRegion_module->retired   = SharedRegion_module->xlt;
+        }
+        SharedRegion_module->xlt = xlt;
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "_SharedRegion_publishXlt", status);
+
+    return status;
+}
+
+
+/* Frees the current and the retired translation tables. */
+static Void
+_SharedRegion_freeXlt (Void)
+{
+    SharedRegion_Xlt * xlt  = SharedRegion_module->xlt;
+    SharedRegion_Xlt * next;
+
+    GT_0trace (curTrace, GT_ENTER, "_SharedRegion_freeXlt");
+
+    SharedRegion_module->xlt = NULL;
+    if (xlt != NULL) {
+        xlt->next = SharedRegion_module->retired;
+    }
+    else {
+        xlt = SharedRegion_module->retired;
+    }
+    SharedRegion_module->retired = NULL;
+
+    while (xlt != NULL) {
+        next = xlt->next;
+        Memory_free (NULL,
+                     xlt,
+                     (   sizeof (SharedRegion_Xlt)
+                      +  (  2 * SharedRegion_module->cfg.numEntries
+                          * sizeof (SharedRegion_XltRange))));
+        xlt = next;
+    }
+
+    GT_0trace (curTrace, GT_LEAVE, "_SharedRegion_freeXlt");
+}
+
+
 /* Sets the regions in user space that are created in knl space and
  * not on user space
  */
@@ -1771,6 +1925,7 @@ _SharedRegion_setRegions (Void)
     SharedRegion_Region *   regions = NULL;
     SharedRegionDrv_CmdArgs cmdArgs;
     Memory_MapInfo          mapInfo;
+    IArg                    key;
 
     cmdArgs.args.getRegionInfo.regions = (SharedRegion_Region *)
                                       Memory_alloc (NULL,
@@ -1844,6 +1999,12 @@ _SharedRegion_setRegions (Void)
                     }
                 }
             }
+
+            if (status >= 0) {
+                key = IGateProvider_enter (SharedRegion_module->localLock);
+                status = _SharedRegion_publishXlt ();
+                IGateProvider_leave (SharedRegion_module->localLock, key);
+            }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
@@ -1871,6 +2032,7 @@ _SharedRegion_clearRegions ()
     UInt32              i;
     Memory_UnmapInfo    unmapInfo;
     SharedRegion_Region *regions;
+    IArg                key;
 
     for (i = 0;
         (   (i < SharedRegion_module->cfg.numEntries) && (status >= 0));
@@ -1878,11 +2040,12 @@ _SharedRegion_clearRegions ()
         regions = &(SharedRegion_module->regions[i]);
         if (   (regions->entry.isValid == TRUE)
             && (SharedRegion_module->bCreatedInKnlSpace[i] == TRUE)) {
-//            Gate_enterSystem();
+            key = IGateProvider_enter (SharedRegion_module->localLock);
             SharedRegion_module->regions[i].entry.isValid = FALSE;
             SharedRegion_module->bCreatedInKnlSpace[i] = FALSE;
-
-//            Gate_leaveSystem();
+            /* Stop translating into the region before unmapping it. */
+            _SharedRegion_publishXlt ();
+            IGateProvider_leave (SharedRegion_module->localLock, key);
 
             unmapInfo.addr  = (UInt32) regions->entry.base;
             unmapInfo.size = regions->entry.len;
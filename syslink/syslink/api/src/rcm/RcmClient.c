@@ -76,6 +76,13 @@ extern "C" {
 #define RCMCLIENT_HEAPID_ARRAY_BLOCKSIZE 256   /*!< Default heap block size */
 #define MAX_NAME_LEN                      32   /*!< Max RCM client name len */
 #define WAIT_NONE                        0x0   /*!< 0 wait time for msg Que */
+#define RCMCLIENT_MAILBOX_SIZE            32   /*!< Mailbox buckets, 2^n    */
+
+/*!
+ *  @brief  Mailbox bucket of a message id. Ids are handed out in sequence,
+ *          so the low bits spread the calls in flight evenly.
+ */
+#define RCMCLIENT_MAILBOX_HASH(msgId) ((msgId) & (RCMCLIENT_MAILBOX_SIZE - 1))
 
 /* =============================================================================
  * Structures & Enums
@@ -83,12 +90,14 @@ extern "C" {
  */
 
 /*!
- *  @brief  RCM recipient used for managing messages from server
- *          (mailman algorithm)
+ *  @brief  Caller waiting for a return message from the server. Recipients
+ *          are kept in the mailbox bucket of their msgId while waiting and
+ *          on the instance free list otherwise, so the event is created
+ *          once per concurrent caller and not once per call.
  */
 typedef struct Recipient_tag {
-    List_Elem            elem;       /*!< Pointer to list of messages       */
-    UInt16               msgId;      /*!< Msg ID received from server       */
+    struct Recipient_tag * next;     /*!< Next in bucket or free list       */
+    UInt16               msgId;      /*!< Msg ID expected from server       */
     RcmClient_Message  * msg;        /*!< Ptr to msg received from server   */
     OsalSemaphore_Handle event;      /*!< Semaphore to unblock client task  */
 } Recipient;
@@ -105,10 +114,14 @@ typedef struct RcmClient_Object_tag {
     MessageQ_QueueId     serverMsgQ;  /*!< Server message queue id          */
     Bool                 cbNotify;    /*!< Callback notification            */
     UInt16               msgId;       /*!< Last used message id             */
-    OsalSemaphore_Handle mbxLock;     /*!< Mailbox lock                     */
-    OsalSemaphore_Handle queueLock;   /*!< Message queue lock               */
-    List_Handle          recipients;  /*!< List of waiting recipients       */
-    List_Handle          newMail;     /*!< List of undelivered messages     */
+    pthread_t            receiver;    /*!< Return message receiver thread   */
+    Bool                 shutdown;    /*!< Signal receiver thread to exit   */
+    Int                  mailStatus;  /*!< Set once the inbound queue fails */
+    Recipient          * recipients [RCMCLIENT_MAILBOX_SIZE];
+                                      /*!< Waiting recipients by msgId      */
+    List_Elem          * newMail [RCMCLIENT_MAILBOX_SIZE];
+                                      /*!< Undelivered messages by msgId    */
+    Recipient          * freeRecipients; /*!< Idle recipients for reuse     */
 } RcmClient_Object;
 
 /*!
@@ -154,6 +167,16 @@ static Int _RcmClient_getReturnMsg (RcmClient_Object      * obj,
                                     const UInt16            msgId,
                                     RcmClient_Message    ** returnMsg);
 
+/*!
+ *  @brief      Deliver return messages from the server to their recipients
+ */
+static Void * _RcmClient_receiverFxn (Void * arg);
+
+/*!
+ *  @brief      Wake the receiver thread so that it can exit
+ */
+static Int _RcmClient_wakeReceiver (RcmClient_Object * obj);
+
 /*!
  *  @brief      Initialize RCM client module
  */
@@ -370,7 +393,6 @@ Int _RcmClient_Instance_init (RcmClient_Object        * obj,
     MessageQ_Params mqParams;
     Int             rval;
     UInt16          procId;
-    List_Params     listP;
     Int             status = RcmClient_S_SUCCESS;
 
     GT_0trace (curTrace, GT_ENTER, "_RcmClient_Instance_init");
@@ -382,10 +404,9 @@ Int _RcmClient_Instance_init (RcmClient_Object        * obj,
     obj->serverMsgQ  = MessageQ_INVALIDMESSAGEQ;
     obj->msgQue      = NULL;
     obj->errorMsgQue = NULL;
-    obj->mbxLock     = NULL;
-    obj->queueLock   = NULL;
-    obj->recipients  = NULL;
-    obj->newMail     = NULL;
+    obj->receiver    = 0;
+    obj->shutdown    = FALSE;
+    obj->mailStatus  = RcmClient_S_SUCCESS;
 
     /* Create a gate instance */
     obj->gate = (IGateProvider_Handle) GateMutex_create ();
@@ -480,58 +501,17 @@ Int _RcmClient_Instance_init (RcmClient_Object        * obj,
         obj->heapId = RcmClient_module->heapIdAry[procId];
     }
 
-    /* Create the mailbox lock */
-    obj->mbxLock = OsalSemaphore_create (OsalSemaphore_Type_Counting, 1);
-    GT_assert (curTrace, (obj->mbxLock != NULL));
-    if (obj->mbxLock ==  NULL) {
+    /* Start the thread delivering return messages to their recipients */
+    rval = pthread_create (&(obj->receiver), NULL, _RcmClient_receiverFxn,
+                           obj);
+    if (rval != 0) {
+        obj->receiver = 0;
         status = RcmClient_E_FAIL;
         GT_setFailureReason (curTrace,
                              GT_4CLASS,
                              "_RcmClient_Instance_init",
                              status,
-                             "Unable to create mbx lock");
-        goto leave;
-    }
-
-    /* Create the message queue lock */
-    obj->queueLock = OsalSemaphore_create (OsalSemaphore_Type_Counting, 1);
-    GT_assert (curTrace, (obj->queueLock != NULL));
-    if (obj->queueLock ==  NULL) {
-        status = RcmClient_E_FAIL;
-        GT_setFailureReason (curTrace,
-                             GT_4CLASS,
-                             "_RcmClient_Instance_init",
-                             status,
-                             "Unable to create queue lock");
-        goto leave;
-    }
-
-    /* Create the return message recipient list */
-    List_Params_init (&listP);
-    listP.gateHandle = obj->gate;
-    obj->recipients = List_create (&listP);
-    GT_assert (curTrace, (obj->recipients != NULL));
-    if (obj->recipients == NULL) {
-        status = RcmClient_E_LISTCREATEFAILED;
-        GT_setFailureReason (curTrace,
-                             GT_4CLASS,
-                             "_RcmClient_Instance_init",
-                             status,
-                             "Unable to create recipients list");
-        goto leave;
-    }
-
-    /* Create list of undelivered messages (new mail) */
-    List_Params_init (&listP);
-    listP.gateHandle = obj->gate;
-    obj->newMail = List_create (&listP);
-    if (obj->newMail == NULL) {
-        status = RcmClient_E_LISTCREATEFAILED;
-        GT_setFailureReason (curTrace,
-                             GT_4CLASS,
-                             "_RcmClient_Instance_init",
-                             status,
-                             "Could not create new mail list object");
+                             "Unable to create receiver thread");
         goto leave;
     }
 
@@ -587,6 +567,10 @@ Int RcmClient_delete (RcmClient_Handle * handlePtr)
     /* Finalize the object */
     obj    = (RcmClient_Object *)(*handlePtr);
     status = _RcmClient_Instance_finalize (obj);
+    if (status < 0) {
+        /* The receiver thread still uses the instance, do not free it */
+        goto leave;
+    }
 
     Memory_free (NULL, (RcmClient_Object *)*handlePtr,
                     sizeof (RcmClient_Object));
@@ -600,7 +584,42 @@ leave:
 
 
 /*!
- *  @brief      Deallocate memory of RCM instance and reset instance
+ *  @brief      Wake the receiver thread blocked on the inbound queue so that
+ *              it sees the shutdown flag. Unblocks the queue, or queues a
+ *              wake message if that fails.
+ *
+ *  @param      obj     RCM instance handle pointer
+ */
+static Int _RcmClient_wakeReceiver (RcmClient_Object * obj)
+{
+    MessageQ_Msg msgqMsg;
+    Int          status;
+
+    status = MessageQ_unblock (obj->msgQue);
+    if (status >= 0) {
+        return RcmClient_S_SUCCESS;
+    }
+
+    /* The receiver frees the wake message once it sees the shutdown flag */
+    msgqMsg = MessageQ_alloc (obj->heapId, sizeof (MessageQ_MsgHeader));
+    if (msgqMsg == NULL) {
+        return RcmClient_E_MSGALLOCFAILED;
+    }
+
+    status = MessageQ_put (MessageQ_getQueueId (obj->msgQue), msgqMsg);
+    if (status < 0) {
+        MessageQ_free (msgqMsg);
+        return RcmClient_E_IPCERROR;
+    }
+
+    return RcmClient_S_SUCCESS;
+}
+
+
+/*!
+ *  @brief      Deallocate memory of RCM instance and reset instance. Fails,
+ *              leaving the instance untouched, if the receiver thread cannot
+ *              be stopped.
  *
  *  @param      obj     RCM instance handle pointer
  *
@@ -608,32 +627,57 @@ leave:
  */
 Int _RcmClient_Instance_finalize (RcmClient_Object * obj)
 {
-    Int status = RcmClient_S_SUCCESS;
+    Recipient * recipient;
+    List_Elem * elem;
+    UInt        i;
+    Int         status = RcmClient_S_SUCCESS;
 
     GT_1trace (curTrace, GT_ENTER, "RcmClient_instance_finalize", obj);
 
-    if (obj->newMail != NULL) {
-        while (!(List_empty(obj->newMail))) {
-            List_remove(obj->newMail, List_get(obj->newMail));
+    /* Stop the receiver before tearing down what it delivers to */
+    obj->shutdown = TRUE;
+
+    if (obj->receiver != 0) {
+        status = _RcmClient_wakeReceiver (obj);
+        if (status < 0) {
+            /* The receiver may still run, keep everything it uses alive */
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "_RcmClient_Instance_finalize",
+                                 status,
+                                 "Unable to stop the receiver thread!");
+            goto leave;
         }
-        List_delete (&obj->newMail);
+
+        pthread_join (obj->receiver, NULL);
+        obj->receiver = 0;
     }
 
-    if (obj->recipients != NULL) {
-        while (!(List_empty(obj->recipients))) {
-            List_remove(obj->recipients, List_get(obj->recipients));
+    /* Return messages nobody came to collect */
+    for (i = 0; i < RCMCLIENT_MAILBOX_SIZE; i++) {
+        while ((elem = obj->newMail [i]) != NULL) {
+            obj->newMail [i] = elem->next;
+            MessageQ_free ((MessageQ_Msg) elem);
         }
-        List_delete (&obj->recipients);
     }
 
-    if (obj->queueLock != NULL) {
-        OsalSemaphore_delete (&(obj->queueLock));
-        obj->queueLock = NULL;
+    /* Recipients still in a bucket had their wait fail */
+    for (i = 0; i < RCMCLIENT_MAILBOX_SIZE; i++) {
+        while ((recipient = obj->recipients [i]) != NULL) {
+            obj->recipients [i] = recipient->next;
+            recipient->next = obj->freeRecipients;
+            obj->freeRecipients = recipient;
+        }
     }
 
-    if (obj->mbxLock != NULL) {
-        OsalSemaphore_delete (&(obj->mbxLock));
-        obj->mbxLock = NULL;
+    while ((recipient = obj->freeRecipients) != NULL) {
+        obj->freeRecipients = recipient->next;
+#ifdef HAVE_ANDROID_OS
+        /* Android bionic Semdelete code returns -1 if count == 0 */
+        OsalSemaphore_post (recipient->event);
+#endif /* ifdef HAVE_ANDROID_OS */
+        OsalSemaphore_delete (&(recipient->event));
+        Memory_free (NULL, recipient, sizeof (Recipient));
     }
 
     if (obj->serverMsgQ != MessageQ_INVALIDMESSAGEQ) {
@@ -651,6 +695,7 @@ Int _RcmClient_Instance_finalize (RcmClient_Object * obj)
     /* Destruct the instance gate */
     GateMutex_delete ((GateMutex_Handle *)&(obj->gate));
 
+leave:
     GT_1trace (curTrace, GT_LEAVE, "_RcmClient_Instance_finalize", status);
 
     return status;
@@ -2120,18 +2165,16 @@ leave:
 
 
 /*!
- *  @brief      A thread safe algorithm for message delivery
- *              This function is called to pickup a specified return message
- *              from the server. messages are taken from the queue and either
- *              delivered to the mailbox if not the specified message or
- *              returned to the caller. The calling thread might play the role
- *              of mailman or simply wait on a list of recipients.
+ *  @brief      Pick up a specified return message from the server.
  *
- *              This algorithm guarantees that a waiting recipient is released
- *              as soon as his message arrives. All new mail is placed in the
- *              mailbox until the recipient arrives to collect it. The messages
- *              can arrive in any order and will be processed as they arrive.
- *              message delivery is never stalled waiting on absent recipient.
+ *              Return messages are read from the inbound queue by the
+ *              receiver thread only. The caller looks for its message in the
+ *              mailbox bucket of its msgId; if the message has not arrived
+ *              it leaves a recipient in the bucket and sleeps on the
+ *              recipient's own event until the receiver hands the message
+ *              over. Messages can arrive in any order, a waiter is only
+ *              woken by its own message, and a message whose recipient has
+ *              not arrived yet (RcmClient_execNoWait) waits in the bucket.
  *
  *  @param      handle     Instance handle
  *  @param      msgId      Message expected from the RCM server
@@ -2142,13 +2185,12 @@ Int _RcmClient_getReturnMsg (RcmClient_Object     * handle,
                              const UInt16           msgId,
                              RcmClient_Message   ** returnMsg)
 {
-    List_Elem         * elem;
-    Recipient         * recipient;
+    List_Elem        ** link;
     RcmClient_Packet  * packet;
-    Bool                messageDelivered;
-    MessageQ_Msg        msgqMsg             = NULL;
-    Bool                messageFound        = FALSE;
-    Int                 queueLockAcquired   = 0;
+    Recipient         * recipient;
+    IArg                key;
+    Bool                waiting             = FALSE;
+    UInt                hash                = RCMCLIENT_MAILBOX_HASH (msgId);
     Int                 rval;
     Int                 status              = RcmClient_S_SUCCESS;
 
@@ -2176,354 +2218,203 @@ Int _RcmClient_getReturnMsg (RcmClient_Object     * handle,
 
     *returnMsg = NULL;
 
-    /* Keep trying until message found */
-    while (!messageFound) {
+    /* Take an idle recipient, or make one for this new concurrent caller */
+    key = IGateProvider_enter (handle->gate);
+    recipient = handle->freeRecipients;
+    if (recipient != NULL) {
+        handle->freeRecipients = recipient->next;
+    }
+    IGateProvider_leave (handle->gate, key);
+
+    if (recipient == NULL) {
+        recipient = (Recipient *) Memory_alloc (NULL, sizeof (Recipient), 0);
+        if (recipient == NULL) {
+            status = RcmClient_E_NOMEMORY;
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "_RcmClient_getReturnMsg",
+                                 status,
+                                 "Recipient allocation failed");
+            goto leave;
+        }
+        recipient->event = OsalSemaphore_create (OsalSemaphore_Type_Counting,
+                                                 0);
+        if (recipient->event == NULL) {
+            Memory_free (NULL, recipient, sizeof (Recipient));
+            status = RcmClient_E_FAIL;
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "_RcmClient_getReturnMsg",
+                                 status,
+                                 "Thread event construct fails");
+            goto leave;
+        }
+    }
+    recipient->msgId = msgId;
+    recipient->msg   = NULL;
+
+    key = IGateProvider_enter (handle->gate);
 
-        /* Acquire the mailbox lock */
-        rval = OsalSemaphore_pend (handle->mbxLock, OSALSEMAPHORE_WAIT_FOREVER);
+    /* The message may have arrived before its recipient */
+    for (link = &handle->newMail [hash]; *link != NULL;
+         link = &(*link)->next) {
+        packet = _getPacketAddrElem (*link);
+        if (packet->msgId == msgId) {
+            *link = (*link)->next;
+            *returnMsg = &packet->message;
+            break;
+        }
+    }
+
+    if (*returnMsg == NULL) {
+        if (handle->mailStatus < 0) {
+            status = handle->mailStatus;
+        }
+        else {
+            recipient->next = handle->recipients [hash];
+            handle->recipients [hash] = recipient;
+            waiting = TRUE;
+        }
+    }
+
+    IGateProvider_leave (handle->gate, key);
+
+    if (waiting) {
+        rval = OsalSemaphore_pend (recipient->event,
+                                   OSALSEMAPHORE_WAIT_FOREVER);
         if (rval < 0) {
+            /* The receiver may still deliver to the recipient, so it stays
+             * where it is until the instance is finalized. */
             GT_setFailureReason (curTrace,
                                  GT_4CLASS,
                                  "_RcmClient_getReturnMsg",
                                  rval,
-                                 "handle->mbxLock pend failed");
+                                 "Thread event pend fails");
             status = RcmClient_E_FAIL;
             goto leave;
         }
 
-        /* Search new mail list for message */
-        elem = NULL;
-        while ((elem = List_next (handle->newMail, elem)) != NULL) {
-            packet = _getPacketAddrElem (elem);
-            if (msgId == packet->msgId) {
-                List_remove (handle->newMail, elem);
-                *returnMsg = &packet->message;
-                messageFound = TRUE;
-                break;
-            }
+        /* No message means the receiver gave up on the inbound queue */
+        *returnMsg = recipient->msg;
+        if (*returnMsg == NULL) {
+            status = handle->mailStatus;
         }
+    }
 
-        if (messageFound) {
-            /* Release the mailbox lock */
-            rval = OsalSemaphore_post (handle->mbxLock);
-            if (rval < 0) {
-                GT_setFailureReason (curTrace,
-                                     GT_4CLASS,
-                                     "_RcmClient_getReturnMsg",
-                                     rval,
-                                     "handle->mbxLock post failed");
-                status = RcmClient_E_FAIL;
-                goto leave;
+    key = IGateProvider_enter (handle->gate);
+    recipient->next = handle->freeRecipients;
+    handle->freeRecipients = recipient;
+    IGateProvider_leave (handle->gate, key);
+
+    if (status < 0) {
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "_RcmClient_getReturnMsg",
+                             status,
+                             "Inbound message queue failed");
+    }
+
+leave:
+    GT_1trace (curTrace, GT_LEAVE, "_RcmClient_getReturnMsg", status);
+
+    return status;
+}
+
+
+/*!
+ *  @brief      Receiver thread. Hands each return message to the recipient
+ *              waiting for it, or parks it in the mailbox until the
+ *              recipient arrives.
+ *
+ *  @param      arg        Instance handle
+ */
+static
+Void * _RcmClient_receiverFxn (Void * arg)
+{
+    RcmClient_Object  * handle      = (RcmClient_Object *) arg;
+    Recipient        ** link;
+    Recipient         * recipient;
+    RcmClient_Packet  * packet;
+    List_Elem         * elem;
+    MessageQ_Msg        msgqMsg;
+    IArg                key;
+    UInt                hash;
+    UInt                i;
+    Int                 rval;
+
+    GT_1trace (curTrace, GT_ENTER, "_RcmClient_receiverFxn", handle);
+
+    while (!handle->shutdown) {
+        msgqMsg = NULL;
+        rval = MessageQ_get (handle->msgQue, &msgqMsg, MessageQ_FOREVER);
+        if (handle->shutdown) {
+            if (msgqMsg != NULL) {
+                MessageQ_free (msgqMsg);
             }
+            break;
         }
-        else {
-            /* Attempt the message queue lock */
-            queueLockAcquired = OsalSemaphore_pend (handle->queueLock,
-                                        OSALSEMAPHORE_WAIT_NONE);
-            if ((queueLockAcquired < 0) &&
-                (queueLockAcquired != OSALSEMAPHORE_E_WAITNONE)) {
-                GT_setFailureReason (curTrace,
-                                     GT_4CLASS,
-                                     "_RcmClient_getReturnMsg",
-                                     status,
-                                     "handle->queueLock failed");
-                status = RcmClient_E_FAIL;
-                goto leave;
-            }
 
-            if (! (queueLockAcquired < 0)) {
-                /*
-                 * MailMan role
-                 */
-
-                /* Deliver new mail until message found */
-                while (!messageFound) {
-                    /* Get message from queue if available (non-blocking) */
-                    if (NULL == msgqMsg) {
-                        rval = MessageQ_get (handle->msgQue, &msgqMsg,
-                                                WAIT_NONE);
-                        if ((rval != MessageQ_E_TIMEOUT) && (rval < 0)) {
-                            GT_setFailureReason (curTrace,
-                                                 GT_4CLASS,
-                                                 "_RcmClient_getReturnMsg",
-                                                 rval,
-                                                 "handle->MessageQ get failed");
-                            status = RcmClient_E_LOSTMSG;
-                            goto leave;
-                        }
-                    }
-
-                    while (NULL != msgqMsg) {
-                        /* Check if message found */
-                        packet = _getPacketAddrMsgqMsg (msgqMsg);
-                        messageFound = (msgId == packet->msgId);
-                        if (messageFound) {
-                            *returnMsg = &packet->message;
-
-                            /* Search wait list for new mailman */
-                            elem = NULL;
-                            while ((elem =
-                                List_next (handle->recipients, elem)) != NULL) {
-                                recipient = (Recipient *)elem;
-                                if (NULL == recipient->msg) {
-                                    rval = OsalSemaphore_post(recipient->event);
-                                    if (rval < 0) {
-                                        GT_setFailureReason (curTrace,
-                                                             GT_4CLASS,
-                                                             "RcmClient_"
-                                                             "getReturnMsg",
-                                                             rval,
-                                                             "recipient->event "
-                                                             "post failed");
-                                        status = RcmClient_E_FAIL;
-                                        goto leave;
-                                    }
-                                    break;
-                                }
-                            }
-
-                            /* Release the message queue lock */
-                            rval = OsalSemaphore_post (handle->queueLock);
-                            if (rval < 0) {
-                                GT_setFailureReason (curTrace,
-                                                     GT_4CLASS,
-                                                     "_RcmClient_getReturnMsg",
-                                                     rval,
-                                                     "handle->queueLock post "
-                                                     "failed");
-                                status = RcmClient_E_FAIL;
-                                goto leave;
-                            }
-
-                            /* Release the mailbox lock */
-                            rval = OsalSemaphore_post (handle->mbxLock);
-                            if (rval < 0) {
-                                GT_setFailureReason (curTrace,
-                                                     GT_4CLASS,
-                                                     "_RcmClient_getReturnMsg",
-                                                     rval,
-                                                     "handle->mbxLock post "
-                                                     "failed");
-                                status = RcmClient_E_FAIL;
-                                goto leave;
-                            }
-                            break;
-                        }
-                        else {
-                            /*
-                             * Deliver message to mailbox
-                             */
-
-                            /* Search recipient list for message owner */
-                            elem = NULL;
-                            messageDelivered = FALSE;
-                            while ((elem =
-                                List_next (handle->recipients, elem)) != NULL) {
-                                recipient = (Recipient *)elem;
-                                if (recipient->msgId == packet->msgId) {
-                                    recipient->msg = &packet->message;
-                                    rval = OsalSemaphore_post(recipient->event);
-                                    if (rval < 0) {
-                                        GT_setFailureReason (curTrace,
-                                                             GT_4CLASS,
-                                                             "RcmClient_"
-                                                             "getReturnMsg",
-                                                             rval,
-                                                             "recipient->event "
-                                                             "post failed");
-                                        status = RcmClient_E_FAIL;
-                                        goto leave;
-                                    }
-                                    messageDelivered = TRUE;
-                                    break;
-                                }
-                            }
-
-                            /* Add undelivered message to new mail list */
-                            if (!messageDelivered) {
-                                /* Use the elem in the MessageQ hdr */
-                                elem = (List_Elem *)&packet->msgqHeader;
-                                List_put (handle->newMail, elem);
-                            }
-                        }
-
-                        /* Get next message from queue if available */
-                        rval = MessageQ_get (handle->msgQue, &msgqMsg,
-                                                WAIT_NONE);
-                        if ((rval != MessageQ_E_TIMEOUT) && (rval < 0)) {
-                            GT_setFailureReason (curTrace,
-                                                 GT_4CLASS,
-                                                 "_RcmClient_getReturnMsg",
-                                                 rval,
-                                                 "handle->MessageQ get failed");
-                            status = RcmClient_E_LOSTMSG;
-                            goto leave;
-                        }
-                    }
-
-                    if (!messageFound) {
-                        /*
-                         * Message queue empty
-                         */
-
-                        /* Release the mailbox lock */
-                        rval = OsalSemaphore_post (handle->mbxLock);
-                        if (rval < 0) {
-                            GT_setFailureReason (curTrace,
-                                                 GT_4CLASS,
-                                                 "_RcmClient_getReturnMsg",
-                                                 rval,
-                                                 "uhandle->mbxLock post failed");
-                            status = RcmClient_E_FAIL;
-                            goto leave;
-                        }
-
-                        /* Get next message, this blocks the thread */
-                        rval = MessageQ_get (handle->msgQue, &msgqMsg,
-                                                MessageQ_FOREVER);
-                        if (rval < 0) {
-                            GT_setFailureReason (curTrace,
-                                                 GT_4CLASS,
-                                                 "_RcmClient_getReturnMsg",
-                                                 rval,
-                                                 "handle->MessageQ get failed");
-                            status = RcmClient_E_LOSTMSG;
-                            goto leave;
-                        }
-
-                        if (msgqMsg == NULL) {
-                            GT_setFailureReason (curTrace,
-                                                 GT_4CLASS,
-                                                 "_RcmClient_getReturnMsg",
-                                                 rval,
-                                                 "Message received is NULL");
-                            status = RcmClient_E_LOSTMSG;
-                            goto leave;
-                        }
-
-                        /* Acquire the mailbox lock */
-                        rval = OsalSemaphore_pend (handle->mbxLock,
-                                                   OSALSEMAPHORE_WAIT_FOREVER);
-                        if (rval < 0) {
-                            GT_setFailureReason (curTrace,
-                                                GT_4CLASS,
-                                                "_RcmClient_getReturnMsg",
-                                                rval,
-                                                "handle->queueLock fails");
-                            status = RcmClient_E_FAIL;
-                        }
-                    }
+        if ((rval < 0) || (msgqMsg == NULL)) {
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "_RcmClient_receiverFxn",
+                                 rval,
+                                 "handle->MessageQ get failed");
+
+            /* Fail every caller waiting now or from now on */
+            key = IGateProvider_enter (handle->gate);
+            handle->mailStatus = RcmClient_E_LOSTMSG;
+            for (i = 0; i < RCMCLIENT_MAILBOX_SIZE; i++) {
+                while ((recipient = handle->recipients [i]) != NULL) {
+                    handle->recipients [i] = recipient->next;
+                    OsalSemaphore_post (recipient->event);
                 }
             }
-            else {
-                /* Construct recipient on local stack */
-                Recipient self;
-                self.msgId = msgId;
-                self.msg = NULL;
-                self.event = OsalSemaphore_create (OsalSemaphore_Type_Counting,
-                                    0);
-                if (self.event ==  NULL) {
-                    GT_setFailureReason (curTrace,
-                                         GT_4CLASS,
-                                         "_RcmClient_getReturnMsg",
-                                         RcmClient_E_FAIL,
-                                         "Thread event construct fails");
-                    status = RcmClient_E_FAIL;
-                    goto leave;
-                }
+            IGateProvider_leave (handle->gate, key);
+            break;
+        }
 
-                /* Add recipient to wait list */
-                elem = &self.elem;
-                List_put (handle->recipients, elem);
-
-                /* Release the mailbox lock */
-                rval = OsalSemaphore_post (handle->mbxLock);
-                if (rval < 0) {
-                    GT_setFailureReason (curTrace,
-                                         GT_4CLASS,
-                                         "_RcmClient_getReturnMsg",
-                                         rval,
-                                         "handle->mbxLock post fails");
-                    status = RcmClient_E_FAIL;
-                    goto leave;
-                }
+        packet = _getPacketAddrMsgqMsg (msgqMsg);
+        hash = RCMCLIENT_MAILBOX_HASH (packet->msgId);
 
-                /* Wait on event */
-                rval = OsalSemaphore_pend (self.event,
-                                            OSALSEMAPHORE_WAIT_FOREVER);
-                if (rval < 0) {
-                    GT_setFailureReason (curTrace,
-                                         GT_4CLASS,
-                                         "_RcmClient_getReturnMsg",
-                                         rval,
-                                         "Thread event pend fails");
-                    status = RcmClient_E_FAIL;
-                    goto leave;
-                }
+        key = IGateProvider_enter (handle->gate);
 
-                /* Acquire the mailbox lock */
-                rval = OsalSemaphore_pend (handle->mbxLock,
-                                            OSALSEMAPHORE_WAIT_FOREVER);
-                if (rval < 0) {
-                    GT_setFailureReason (curTrace,
-                                         GT_4CLASS,
-                                         "_RcmClient_getReturnMsg",
-                                         rval,
-                                         "handle->mbxLock pend fails");
-                    status = RcmClient_E_FAIL;
-                    goto leave;
-                }
+        for (link = &handle->recipients [hash]; *link != NULL;
+             link = &(*link)->next) {
+            if ((*link)->msgId == packet->msgId) {
+                break;
+            }
+        }
 
-                if (NULL != self.msg) {
-                    /* Pickup message */
-                    *returnMsg = self.msg;
-                    messageFound = TRUE;
-                }
+        recipient = *link;
+        if (recipient != NULL) {
+            *link = recipient->next;
+            recipient->msg = &packet->message;
+        }
+        else {
+            /* Use the elem in the MessageQ hdr */
+            elem = (List_Elem *) &packet->msgqHeader;
+            elem->next = handle->newMail [hash];
+            handle->newMail [hash] = elem;
+        }
 
-                /* Remove recipient from wait list */
-                List_remove (handle->recipients, elem);
-#ifdef HAVE_ANDROID_OS
-                /* Android bionic Semdelete code returns -1 if count == 0 */
-                rval = OsalSemaphore_post (self.event);
-                if (rval < 0) {
-                    GT_setFailureReason (curTrace,
-                                         GT_4CLASS,
-                                         "_RcmClient_getReturnMsg",
-                                         rval,
-                                         "self.event post fails");
-                    status = RcmClient_E_FAIL;
-                    goto leave;
-                }
-#endif /* ifdef HAVE_ANDROID_OS */
-                rval = OsalSemaphore_delete (&(self.event));
-                if (rval < 0){
-                    GT_setFailureReason (curTrace,
-                                         GT_4CLASS,
-                                         "_RcmClient_getReturnMsg",
-                                         rval,
-                                         "Thread event delete failed");
-                    status = RcmClient_E_FAIL;
-                    goto leave;
-                }
+        IGateProvider_leave (handle->gate, key);
 
-                /* Release the mailbox lock */
-                rval = OsalSemaphore_post (handle->mbxLock);
-                if (rval < 0){
-                    GT_setFailureReason (curTrace,
-                                         GT_4CLASS,
-                                         "_RcmClient_getReturnMsg",
-                                         rval,
-                                         "handle->mbxLock post fails");
-                    status = RcmClient_E_FAIL;
-                }
+        if (recipient != NULL) {
+            rval = OsalSemaphore_post (recipient->event);
+            if (rval < 0) {
+                GT_setFailureReason (curTrace,
+                                     GT_4CLASS,
+                                     "_RcmClient_receiverFxn",
+                                     rval,
+                                     "recipient->event post failed");
             }
         }
-    } /* while (!messageFound) */
+    }
 
-leave:
-    GT_1trace (curTrace, GT_LEAVE, "_RcmClient_getReturnMsg", status);
+    GT_0trace (curTrace, GT_LEAVE, "_RcmClient_receiverFxn");
 
-    return status;
+    return NULL;
 }
 
 
@@ -40,6 +40,11 @@
  *          After processing a message, the server will return the message to
  *          the client.
  *
+ *          Messages for a worker pool are queued on one of its worker
+ *          threads, a worker with nothing queued steals from its siblings.
+ *          Control messages (symbol lookup, job id acquire and release) are
+ *          processed by the server thread, ahead of any queued function.
+ *
  *  ============================================================================
  */
 
@@ -47,6 +52,7 @@
 #include <host_os.h>
 #include <pthread.h>
 #include <sched.h>
+#include <time.h>
 
 /* Utility and IPC headers */
 #include <Std.h>
@@ -98,6 +104,9 @@ typedef struct RcmServer_FxnTabElem_tag {
     String                      name;
     RcmServer_MsgFxn            addr;
     UInt16                      key;
+    UInt32                      calls;      /* Execution count */
+    UInt32                      maxUs;      /* Longest execution time */
+    unsigned long long          totalUs;    /* Sum of execution times */
 } RcmServer_FxnTabElem;
 
 /* Array of RcmServer_FxnTabElems */
@@ -116,8 +125,6 @@ typedef struct RcmServer_ThreadPool_tag {
     String                      stackSeg;   /* Thread stack placement */
     OsalSemaphore_Handle        sem;        /* Message semaphore (counting) */
     List_Object                 threadList; /* List of worker threads */
-    List_Object                 readyQueue; /* Queue of messages */
-    IGateProvider_Handle        readyQueueGate; /* message queue list gate */
 } RcmServer_ThreadPool;
 
 /* RCM Server instance object structure */
@@ -136,6 +143,7 @@ typedef struct RcmServer_Object_tag {
     RcmServer_ThreadPool *   poolMap [RCMSERVER_POOL_MAP_LEN];
     List_Handle              jobList;      /* List of job stream queues */
     IGateProvider_Handle     jobListGate;  /* Job stream queue gate */
+    IGateProvider_Handle     statsGate;    /* Function statistics gate */
 } RcmServer_Object;
 
 /* RCM Worker Thread object structure */
@@ -144,6 +152,10 @@ typedef struct {
     UInt16                      jobId;      /* Current job stream id */
     pthread_t                   thread;     /* Server thread object */
     Bool                        terminate;  /* Thread terminate flag */
+    Bool                        busy;       /* Executing a message */
+    Int                         queued;     /* Messages in readyQueue */
+    List_Object                 readyQueue; /* Messages given to this worker */
+    IGateProvider_Handle        readyQueueGate; /* Ready queue gate */
     RcmServer_ThreadPool *      pool;       /* Worker pool */
     RcmServer_Object *          server;     /* Server instance */
 } RcmServer_WorkerThread;
@@ -183,11 +195,14 @@ static Int _RcmServer_acqJobId (RcmServer_Object * obj, UInt16 * jobIdPtr);
 static Int _RcmServer_dispatch (RcmServer_Object  * obj,
                                 RcmClient_Packet  * packet);
 
+static Int _RcmServer_enqueue (RcmServer_ThreadPool  * pool,
+                               RcmClient_Packet      * packet);
+
 static Int _RcmServer_execMsg (RcmServer_Object * obj, RcmClient_Message * msg);
 
-static Int _RcmServer_getFxnAddr (RcmServer_Object    * obj,
-                                  UInt32                fxnIdx,
-                                  RcmServer_MsgFxn    * addrPtr);
+static Int _RcmServer_getFxnElem (RcmServer_Object        * obj,
+                                  UInt32                    fxnIdx,
+                                  RcmServer_FxnTabElem   ** elemPtr);
 
 static UInt16 _RcmServer_getNextKey (RcmServer_Object * obj);
 
@@ -208,6 +223,8 @@ static Void _RcmServer_serverThrFxn (IArg arg);
 
 static Void _RcmServer_setStatusCode (RcmClient_Packet * packet, UInt16 code);
 
+static RcmClient_Packet * _RcmServer_take (RcmServer_WorkerThread * worker);
+
 static Void _RcmServer_workerThrFxn (IArg arg);
 
 #define RcmServer_Module_heap() (NULL)
@@ -507,6 +524,7 @@ _RcmServer_Instance_init (RcmServer_Object        * obj,
     obj->fxnTabStatic.elem   = NULL;
     obj->poolMap0Len         = 0;
     obj->jobList             = NULL;
+    obj->statsGate           = NULL;
 
     /* Initialize the function table */
     for (i = 0; i < RcmServer_module->defaultCfg.maxTables; i++) {
@@ -531,6 +549,19 @@ _RcmServer_Instance_init (RcmServer_Object        * obj,
         goto leave;
     }
 
+    /* Create the gate protecting the function execution statistics */
+    obj->statsGate = (IGateProvider_Handle) GateMutex_create ();
+    GT_assert (curTrace, (obj->statsGate != NULL));
+    if (obj->statsGate == NULL) {
+        status = RcmServer_E_FAIL;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "_RcmServer_Instance_init",
+                             status,
+                             "Unable to create mutex!");
+        goto leave;
+    }
+
     /* Create list for job objects */
     List_Params_init (&listP);
     obj->jobListGate = (IGateProvider_Handle) GateMutex_create ();
@@ -681,20 +712,6 @@ _RcmServer_Instance_init (RcmServer_Object        * obj,
     /* ThreadList is static, no gate protection required */
     List_construct (&(poolAry [0].threadList), NULL);
 
-    poolAry [0].readyQueueGate = (IGateProvider_Handle) GateMutex_create ();
-    GT_assert (curTrace, (poolAry [0].readyQueueGate != NULL));
-    if (poolAry [0].readyQueueGate == NULL) {
-        status = RcmServer_E_FAIL;
-        GT_setFailureReason (curTrace,
-                             GT_4CLASS,
-                             "_RcmServer_Instance_init",
-                             status,
-                             "Unable to create mutex!");
-        goto leave;
-    }
-    listP.gateHandle = poolAry [0].readyQueueGate;
-    List_construct (&(poolAry [0].readyQueue), &listP);
-
     poolAry [0].sem = OsalSemaphore_create (OsalSemaphore_Type_Counting, 0);
     if (poolAry [0].sem ==  NULL) {
         status = RcmServer_E_FAIL;
@@ -726,21 +743,6 @@ _RcmServer_Instance_init (RcmServer_Object        * obj,
         /* ThreadList is static, no gate protection required */
         List_construct (&(poolAry [i+1].threadList), NULL);
 
-        poolAry [i+1].readyQueueGate =
-                    (IGateProvider_Handle) GateMutex_create ();
-        GT_assert (curTrace, (poolAry [i+1].readyQueueGate != NULL));
-        if (poolAry [0].readyQueueGate == NULL) {
-            status = RcmServer_E_FAIL;
-            GT_setFailureReason (curTrace,
-                             GT_4CLASS,
-                             "_RcmServer_Instance_init",
-                             status,
-                             "Unable to create mutex!");
-            goto leave;
-        }
-        listP.gateHandle = poolAry [i+1].readyQueueGate;
-        List_construct (&(poolAry [i+1].readyQueue), &listP);
-
         /* Create the run synchronizer */
         poolAry [i+1].sem  = OsalSemaphore_create (OsalSemaphore_Type_Counting,
                                                     0);
@@ -777,9 +779,28 @@ _RcmServer_Instance_init (RcmServer_Object        * obj,
             worker->jobId     = RcmClient_DISCRETEJOBID;
             worker->thread    = 0;
             worker->terminate = FALSE;
+            worker->busy      = FALSE;
+            worker->queued    = 0;
             worker->pool      = &(poolAry [i]);
             worker->server    = obj;
 
+            /* Each worker has its own ready queue, siblings steal from it */
+            worker->readyQueueGate = (IGateProvider_Handle) GateMutex_create ();
+            GT_assert (curTrace, (worker->readyQueueGate != NULL));
+            if (worker->readyQueueGate == NULL) {
+                Memory_free (RcmServer_Module_heap(), worker,
+                                sizeof (RcmServer_WorkerThread));
+                status = RcmServer_E_FAIL;
+                GT_setFailureReason (curTrace,
+                                     GT_4CLASS,
+                                     "_RcmServer_Instance_init",
+                                     status,
+                                     "Unable to create mutex!");
+                goto leave;
+            }
+            listP.gateHandle = worker->readyQueueGate;
+            List_construct (&(worker->readyQueue), &listP);
+
             /* add worker thread to worker pool */
             listH = &(poolAry [i].threadList);
             List_putHead (listH, &(worker->elem));
@@ -1001,10 +1022,11 @@ _RcmServer_Instance_finalize (RcmServer_Object * obj)
     /* Convenient alias */
     poolAry = obj->poolMap [0];
 
-    /* Free all the static pool resources */
+    /* Stop the worker threads of every pool before freeing any of them,
+     * a worker still running may be stealing from a sibling's readyQueue
+     * or handing a job stream message to another pool.
+     */
     for (i = 0; i < obj->poolMap0Len; i++) {
-
-        /* Free all the worker thread objects */
         listH = &(poolAry [i].threadList);
 
         /* Mark each worker thread for termination */
@@ -1028,10 +1050,14 @@ _RcmServer_Instance_finalize (RcmServer_Object * obj)
                 goto leave;
             }
         }
+    }
+
+    for (i = 0; i < obj->poolMap0Len; i++) {
+        listH = &(poolAry [i].threadList);
 
         /* Wait for each worker thread to terminate */
         elem = NULL;
-        while ((elem = List_get (listH)) != NULL) {
+        while ((elem = List_next (listH, elem)) != NULL) {
             worker = (RcmServer_WorkerThread *)elem;
             status = pthread_join (worker->thread, NULL);
             if (status < 0) {
@@ -1045,6 +1071,54 @@ _RcmServer_Instance_finalize (RcmServer_Object * obj)
             }
 
             /* Not required for unix Thread_delete(&worker->thread); */
+        }
+    }
+
+    /* Free all the static pool resources */
+    for (i = 0; i < obj->poolMap0Len; i++) {
+
+        /* Free all the worker thread objects */
+        listH = &(poolAry [i].threadList);
+
+        while ((elem = List_get (listH)) != NULL) {
+            worker = (RcmServer_WorkerThread *)elem;
+
+            /* Return any remaining messages on the worker's readyQueue */
+            msgQueH = &(worker->readyQueue);
+
+            while ((elem = List_get (msgQueH)) != NULL) {
+                packet = (RcmClient_Packet *)elem;
+                GT_2trace (curTrace,
+                           GT_3CLASS,
+                           "_RcmServer_Instance_finalize: Returning "
+                           "unprocessed message, msgId = 0x%x, packet = 0x%x",
+                           packet->msgId, packet);
+                _RcmServer_setStatusCode (packet,
+                                            RcmServer_Status_Unprocessed);
+                msgqMsg = &packet->msgqHeader;
+                rval = MessageQ_put (MessageQ_getReplyQueue (msgqMsg),
+                                        msgqMsg);
+                if (rval < 0) {
+                    GT_2trace (curTrace,
+                               GT_4CLASS,
+                               "_RcmServer_Instance_finalize: Unable to "
+                               "return msg 0x%x from pool 0x%x back to Client",
+                               rval, packet->message.poolId);
+                }
+            }
+
+            List_destruct (&(worker->readyQueue));
+            status = GateMutex_delete (
+                        (GateMutex_Handle *)&(worker->readyQueueGate));
+            if (status < 0) {
+                GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "_RcmServer_Instance_finalize",
+                                 status,
+                                 "Unable to delete mutex");
+                status = RcmClient_E_FAIL;
+                goto leave;
+            }
 
             /* Free the worker thread object */
             Memory_free (RcmServer_Module_heap(), worker,
@@ -1076,41 +1150,6 @@ _RcmServer_Instance_finalize (RcmServer_Object * obj)
             goto leave;
         }
         List_destruct (&(poolAry [i].threadList));
-
-        /* Return any remaining messages on the readyQueue */
-        msgQueH = &(poolAry [i].readyQueue);
-
-        while ((elem = List_get (msgQueH)) != NULL) {
-            packet = (RcmClient_Packet *)elem;
-            GT_2trace (curTrace,
-                       GT_3CLASS,
-                       "_RcmServer_Instance_finalize: Returning unprocessed "
-                       "message, msgId = 0x%x, packet = 0x%x",
-                       packet->msgId, packet);
-            _RcmServer_setStatusCode (packet, RcmServer_Status_Unprocessed);
-            msgqMsg = &packet->msgqHeader;
-            rval = MessageQ_put (MessageQ_getReplyQueue (msgqMsg), msgqMsg);
-            if (rval < 0) {
-                GT_2trace (curTrace,
-                           GT_4CLASS,
-                           "_RcmServer_Instance_finalize: Unable to return "
-                           "msg 0x%x from pool 0x%x back to Client",
-                           rval, packet->message.poolId);
-            }
-        }
-
-        List_destruct (&(poolAry [i].readyQueue));
-        status = GateMutex_delete (
-                    (GateMutex_Handle *)&(poolAry [i].readyQueueGate));
-        if (status < 0) {
-            GT_setFailureReason (curTrace,
-                             GT_4CLASS,
-                             "_RcmServer_Instance_finalize",
-                             status,
-                             "Unable to delete mutex");
-            status = RcmClient_E_FAIL;
-            goto leave;
-        }
     }
 
     /* Free the name block for the static pools */
@@ -1201,6 +1240,20 @@ _RcmServer_Instance_finalize (RcmServer_Object * obj)
                     obj->fxnTabStatic.length * sizeof (RcmServer_FxnTabElem));
     }
 
+    /* Destruct the statistics gate */
+    if (obj->statsGate != NULL) {
+        status = GateMutex_delete ((GateMutex_Handle *)&(obj->statsGate));
+        if (status < 0) {
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "_RcmServer_Instance_finalize",
+                                 status,
+                                 "Unable to delete mutex");
+            status = RcmClient_E_FAIL;
+            goto leave;
+        }
+    }
+
     /* Destruct the instance gate */
     status = GateMutex_delete ((GateMutex_Handle *)&(obj->gate));
     if (status < 0) {
@@ -1322,6 +1375,9 @@ RcmServer_addSymbol (RcmServer_Handle   handle,
                 ((handle->fxnTab [i]) + j)->addr = 0;
                 ((handle->fxnTab [i]) + j)->name = NULL;
                 ((handle->fxnTab [i]) + j)->key = 0;
+                ((handle->fxnTab [i]) + j)->calls = 0;
+                ((handle->fxnTab [i]) + j)->maxUs = 0;
+                ((handle->fxnTab [i]) + j)->totalUs = 0;
             }
 
             /* Use first slot in new table */
@@ -1354,6 +1410,9 @@ RcmServer_addSymbol (RcmServer_Handle   handle,
 
         String_cpy (slot->name, funcName);
         slot->key = _RcmServer_getNextKey (handle);
+        slot->calls = 0;
+        slot->maxUs = 0;
+        slot->totalUs = 0;
         fxnIdx = ((slot->key << _RCM_KeyShift) | (i << 12) | j);
     }
     /* Error, no more room to add new symbol */
@@ -1380,6 +1439,69 @@ leave:
 }
 
 
+/*
+ *  ======== RcmServer_getFxnStats ========
+ */
+Int
+RcmServer_getFxnStats (RcmServer_Handle     handle,
+                       String               name,
+                       RcmServer_FxnStats * stats)
+{
+    UInt32                  fxnIdx;
+    RcmServer_FxnTabElem  * slot;
+    IArg                    key;
+    Int                     status = RcmServer_S_SUCCESS;
+
+    GT_3trace (curTrace, GT_ENTER, "RcmServer_getFxnStats", handle, name,
+                stats);
+
+    if (RcmServer_module->setupRefCount == 0) {
+        status = RcmServer_E_INVALIDSTATE;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "RcmServer_getFxnStats",
+                             status,
+                             "Module is in an invalid state!");
+        goto leave;
+    }
+    if ((handle == NULL) || (name == NULL) || (stats == NULL)) {
+        status = RcmServer_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "RcmServer_getFxnStats",
+                             status,
+                             "Invalid argument passed!");
+        goto leave;
+    }
+
+    status = _RcmServer_getSymIdx (handle, name, &fxnIdx);
+    if (status >= 0) {
+        status = _RcmServer_getFxnElem (handle, fxnIdx, &slot);
+    }
+    if (status < 0) {
+        status = RcmServer_E_SYMBOLNOTFOUND;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "RcmServer_getFxnStats",
+                             status,
+                             "Given symbol not found!");
+        goto leave;
+    }
+
+    key = IGateProvider_enter (handle->statsGate);
+    stats->calls = slot->calls;
+    stats->avgUs = (slot->calls == 0) ? 0 :
+                        (UInt32)(slot->totalUs / slot->calls);
+    stats->maxUs = slot->maxUs;
+    IGateProvider_leave (handle->statsGate, key);
+
+leave:
+    GT_1trace (curTrace, GT_LEAVE, "RcmServer_getFxnStats", status);
+
+    return status;
+}
+
+
 /*
  *  ======== RcmServer_removeSymbol ========
  */
@@ -1663,18 +1785,7 @@ _RcmServer_dispatch (RcmServer_Object * obj, RcmClient_Packet * packet)
     jobId = packet->message.jobId;
 
     if (jobId == RcmClient_DISCRETEJOBID) {
-        listH = &pool->readyQueue;
-        List_put (listH, (List_Elem *)packet);
-
-        /* Dispatch a new worker thread */
-        status = OsalSemaphore_post (pool->sem);
-        if (status < 0) {
-            GT_setFailureReason (curTrace,
-                                 GT_4CLASS,
-                                 "_RcmServer_dispatch",
-                                 status,
-                                 "Could not post pool semaphore!");
-        }
+        status = _RcmServer_enqueue (pool, packet);
     }
     /* Must be a job stream message */
     else {
@@ -1701,18 +1812,7 @@ _RcmServer_dispatch (RcmServer_Object * obj, RcmClient_Packet * packet)
         /* If job object is empty, place message directly on ready queue */
         else if (job->empty) {
             job->empty = FALSE;
-            listH = &pool->readyQueue;
-            List_put (listH, (List_Elem *)packet);
-
-            /* Dispatch a new worker thread */
-            status = OsalSemaphore_post (pool->sem);
-            if (status < 0) {
-                GT_setFailureReason (curTrace,
-                                     GT_4CLASS,
-                                     "_RcmServer_dispatch",
-                                     RcmServer_E_INVALIDSTATE,
-                                     "Could not post pool semaphore!");
-            }
+            status = _RcmServer_enqueue (pool, packet);
         }
         /* Place message on job queue */
         else {
@@ -1729,20 +1829,107 @@ leave:
 }
 
 
+/*
+ *  ======== _RcmServer_enqueue ========
+ *
+ *  Give a ready message to one of the pool's worker threads. An idle
+ *  worker with nothing queued is preferred, otherwise the worker with the
+ *  fewest queued messages. The choice only decides whose readyQueue the
+ *  message waits on: the pool semaphore wakes any worker, and a worker
+ *  with an empty readyQueue steals from its siblings, so a message never
+ *  waits behind a long running function while another worker is idle.
+ */
+static Int
+_RcmServer_enqueue (RcmServer_ThreadPool * pool, RcmClient_Packet * packet)
+{
+    IArg                        key;
+    List_Elem                 * elem;
+    RcmServer_WorkerThread    * worker;
+    RcmServer_WorkerThread    * target  = NULL;
+    Int                         status  = RcmServer_S_SUCCESS;
+
+    GT_2trace (curTrace, GT_ENTER, "_RcmServer_enqueue", pool, packet);
+
+    /* Busy and queued are only read as hints, no gate needed */
+    elem = NULL;
+    while ((elem = List_next (&pool->threadList, elem)) != NULL) {
+        worker = (RcmServer_WorkerThread *)elem;
+        if (!worker->busy && (worker->queued == 0)) {
+            target = worker;
+            break;
+        }
+        if ((target == NULL) || (worker->queued < target->queued)) {
+            target = worker;
+        }
+    }
+
+    if (target == NULL) {
+        status = RcmServer_E_FAIL;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "_RcmServer_enqueue",
+                             status,
+                             "Worker pool has no threads!");
+        goto leave;
+    }
+
+    key = IGateProvider_enter (target->readyQueueGate);
+    List_enqueue (&target->readyQueue, (List_Elem *)packet);
+    target->queued++;
+    IGateProvider_leave (target->readyQueueGate, key);
+
+    /* Dispatch a worker thread. The message is queued either way, so a
+     * failure is not returned, the caller would send the message back.
+     */
+    if (OsalSemaphore_post (pool->sem) < 0) {
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "_RcmServer_enqueue",
+                             RcmServer_E_FAIL,
+                             "Could not post pool semaphore!");
+    }
+
+leave:
+    GT_1trace (curTrace, GT_LEAVE, "_RcmServer_enqueue", status);
+
+    return status;
+}
+
+
 /*
  *  ======== _RcmServer_execMsg ========
+ *
+ *  Also accumulates the execution time of the function, see
+ *  RcmServer_getFxnStats.
  */
 static Int
 _RcmServer_execMsg (RcmServer_Object * obj, RcmClient_Message * msg)
 {
-    RcmServer_MsgFxn    fxn;
-    Int                 status;
+    RcmServer_FxnTabElem  * slot;
+    struct timespec         start;
+    struct timespec         end;
+    UInt32                  us;
+    IArg                    key;
+    Int                     status;
 
     GT_2trace (curTrace, GT_ENTER, "_RcmServer_execMsg", obj, msg);
 
-    status = _RcmServer_getFxnAddr (obj, msg->fxnIdx, &fxn);
+    status = _RcmServer_getFxnElem (obj, msg->fxnIdx, &slot);
     if (status >= 0) {
-        msg->result = (*fxn)(msg->dataSize, msg->data);
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        msg->result = (*slot->addr)(msg->dataSize, msg->data);
+        clock_gettime (CLOCK_MONOTONIC, &end);
+
+        us = (end.tv_sec - start.tv_sec) * 1000000
+                + (end.tv_nsec - start.tv_nsec) / 1000;
+
+        key = IGateProvider_enter (obj->statsGate);
+        slot->calls++;
+        slot->totalUs += us;
+        if (us > slot->maxUs) {
+            slot->maxUs = us;
+        }
+        IGateProvider_leave (obj->statsGate, key);
     }
 
     GT_1trace (curTrace, GT_LEAVE, "_RcmServer_execMsg", status);
@@ -1752,7 +1939,7 @@ _RcmServer_execMsg (RcmServer_Object * obj, RcmClient_Message * msg)
 
 
 /*
- *  ======== _RcmServer_getFxnAddr ========
+ *  ======== _RcmServer_getFxnElem ========
  *
  *  The function index (fxnIdx) uses the following format. Note that the
  *  format differs for static vs. dynamic functions. All static functions
@@ -1780,32 +1967,30 @@ _RcmServer_execMsg (RcmServer_Object * obj, RcmClient_Message * msg)
  *  11:0    offset: 0 - [31, 63, 127, 255, 511, 1023, 2047, 4095]
  */
 static Int
-_RcmServer_getFxnAddr (RcmServer_Object   * obj,
-                       UInt32               fxnIdx,
-                       RcmServer_MsgFxn   * addrPtr)
+_RcmServer_getFxnElem (RcmServer_Object       * obj,
+                       UInt32                   fxnIdx,
+                       RcmServer_FxnTabElem  ** elemPtr)
 {
     UInt                    i;
     UInt                    j;
     UInt16                  key;
-    RcmServer_FxnTabElem  * slot;
-    RcmServer_MsgFxn        addr = 0;
+    RcmServer_FxnTabElem  * slot = NULL;
     Int                     status = RcmServer_S_SUCCESS;
 
-    GT_3trace (curTrace, GT_ENTER, "_RcmServer_getFxnAddr", obj, fxnIdx,
-                addrPtr);
+    GT_3trace (curTrace, GT_ENTER, "_RcmServer_getFxnElem", obj, fxnIdx,
+                elemPtr);
 
     /* Static functions have bit-31 set */
     if (fxnIdx & 0x80000000) {
         j = (fxnIdx & 0x0000FFFF);
         if (j < (obj->fxnTabStatic.length)) {
-            /* Fetch the function address from the table */
+            /* Fetch the function element from the table */
             slot = (obj->fxnTab [0])+j;
-            addr = slot->addr;
         }
         else {
             GT_setFailureReason (curTrace,
                                  GT_4CLASS,
-                                 "_RcmServer_getFxnAddr",
+                                 "_RcmServer_getFxnElem",
                                  fxnIdx,
                                  "Invalid function index!");
             status = RcmServer_E_InvalidFxnIdx;
@@ -1818,16 +2003,15 @@ _RcmServer_getFxnAddr (RcmServer_Object   * obj,
         i = (fxnIdx & 0xF000) >> 12;
         if ((i > 0) && (i < RCMSERVER_MAX_TABLES) && \
             (obj->fxnTab [i] != NULL)) {
-            /* Fetch the function address from the table */
+            /* Fetch the function element from the table */
             j = (fxnIdx & 0x0FFF);
             slot = (obj->fxnTab [i]) + j;
-            addr = slot->addr;
 
             /* Validate the key */
             if (key != slot->key) {
                 GT_setFailureReason (curTrace,
                                      GT_4CLASS,
-                                     "_RcmServer_getFxnAddr",
+                                     "_RcmServer_getFxnElem",
                                      fxnIdx,
                                      "Invalid function index!");
                 status = RcmServer_E_InvalidFxnIdx;
@@ -1836,7 +2020,7 @@ _RcmServer_getFxnAddr (RcmServer_Object   * obj,
         else {
             GT_setFailureReason (curTrace,
                                  GT_4CLASS,
-                                 "_RcmServer_getFxnAddr",
+                                 "_RcmServer_getFxnElem",
                                  fxnIdx,
                                  "Invalid function index!");
             status = RcmServer_E_InvalidFxnIdx;
@@ -1844,10 +2028,10 @@ _RcmServer_getFxnAddr (RcmServer_Object   * obj,
     }
 
     if (status >= 0) {
-        *addrPtr = addr;
+        *elemPtr = slot;
     }
 
-    GT_1trace (curTrace, GT_LEAVE, "_RcmServer_getFxnAddr", status);
+    GT_1trace (curTrace, GT_LEAVE, "_RcmServer_getFxnElem", status);
 
     return status;
 }
@@ -1994,15 +2178,15 @@ _RcmServer_getPool (RcmServer_Object      * obj,
 static Void
 _RcmServer_process (RcmServer_Object * obj, RcmClient_Packet * packet)
 {
-    String              name;
-    UInt32              fxnIdx;
-    RcmServer_MsgFxn    fxn;
-    RcmClient_Message * rcmMsg;
-    MessageQ_Msg        msgqMsg;
-    UInt16              messageType;
-    UInt16              jobId;
-    Int                 rval;
-    Int                 status      = RcmServer_S_SUCCESS;
+    String                  name;
+    UInt32                  fxnIdx;
+    RcmServer_FxnTabElem  * slot;
+    RcmClient_Message     * rcmMsg;
+    MessageQ_Msg            msgqMsg;
+    UInt16                  messageType;
+    UInt16                  jobId;
+    Int                     rval;
+    Int                     status      = RcmServer_S_SUCCESS;
 
     GT_2trace (curTrace, GT_ENTER, "_RcmServer_process", obj, packet);
 
@@ -2095,7 +2279,7 @@ _RcmServer_process (RcmServer_Object * obj, RcmClient_Packet * packet)
         break;
 
     case RcmClient_Desc_DPC:
-        rval = _RcmServer_getFxnAddr (obj, rcmMsg->fxnIdx, &fxn);
+        rval = _RcmServer_getFxnElem (obj, rcmMsg->fxnIdx, &slot);
         if (rval < 0) {
             _RcmServer_setStatusCode (packet,
                                         RcmServer_Status_SYMBOL_NOT_FOUND);
@@ -2114,7 +2298,7 @@ _RcmServer_process (RcmServer_Object * obj, RcmClient_Packet * packet)
         }
 
         /* invoke the function with a null context */
-        (*fxn)(0, NULL);
+        (*slot->addr)(0, NULL);
         break;
 
     case RcmClient_Desc_SYM_ADD:
@@ -2316,6 +2500,7 @@ _RcmServer_serverThrFxn (IArg arg)
 {
     RcmClient_Packet  * packet;
     MessageQ_Msg        msgqMsg;
+    UInt16              messageType;
     Int                 status;
     Bool                running     = TRUE;
     RcmServer_Object  * obj         = (RcmServer_Object *)arg;
@@ -2378,7 +2563,19 @@ _RcmServer_serverThrFxn (IArg arg)
                    "thread = 0x%x, packet = 0x%x",
                    (IArg)(obj->serverThread), (IArg)packet);
 
-        if ((packet->message.poolId == RcmClient_DEFAULTPOOLID)
+        messageType = ((RcmClient_Desc_TYPE_MASK & packet->desc) >>
+                            RcmClient_Desc_TYPE_SHIFT);
+
+        if ((messageType == RcmClient_Desc_SYM_IDX)
+            || (messageType == RcmClient_Desc_JOB_ACQ)
+            || (messageType == RcmClient_Desc_JOB_REL)) {
+            /* Control messages are short and never block, process them
+             * right away instead of queueing them behind function calls
+             * in the worker pools.
+             */
+            _RcmServer_process (obj, packet);
+        }
+        else if ((packet->message.poolId == RcmClient_DEFAULTPOOLID)
             && ((obj->poolMap [0])[0].count == 0)) {
             /* In-band (server thread) message processing */
             _RcmServer_process (obj, packet);
@@ -2439,6 +2636,58 @@ _RcmServer_setStatusCode (RcmClient_Packet * packet, UInt16 code)
 }
 
 
+/*
+ *  ======== _RcmServer_take ========
+ *
+ *  Get the oldest message from the worker's own ready queue. If it is
+ *  empty, steal the oldest message of the first sibling in the same pool
+ *  that has one: that message has waited the longest, most likely behind a
+ *  long running function.
+ */
+static RcmClient_Packet *
+_RcmServer_take (RcmServer_WorkerThread * worker)
+{
+    IArg                        key;
+    List_Elem                 * elem;
+    List_Elem                 * packet  = NULL;
+    RcmServer_WorkerThread    * victim  = worker;
+    List_Handle                 listH   = &worker->pool->threadList;
+
+    GT_1trace (curTrace, GT_ENTER, "_RcmServer_take", worker);
+
+    do {
+        key = IGateProvider_enter (victim->readyQueueGate);
+        packet = List_dequeue (&victim->readyQueue);
+        if (packet != NULL) {
+            victim->queued--;
+        }
+        IGateProvider_leave (victim->readyQueueGate, key);
+
+        if (packet != NULL) {
+            break;
+        }
+
+        /* Next sibling, wrapping around the static thread list */
+        elem = List_next (listH, &victim->elem);
+        if (elem == NULL) {
+            elem = List_next (listH, NULL);
+        }
+        victim = (RcmServer_WorkerThread *)elem;
+    } while (victim != worker);
+
+    if ((packet != NULL) && (victim != worker)) {
+        GT_2trace (curTrace,
+                   GT_2CLASS,
+                   "_RcmServer_take: thread = 0x%x stole packet = 0x%x",
+                   (IArg)worker->thread, (IArg)packet);
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "_RcmServer_take", packet);
+
+    return (RcmClient_Packet *)packet;
+}
+
+
 /*
  *  ======== _RcmServer_workerThrFxn ========
  */
@@ -2448,7 +2697,6 @@ _RcmServer_workerThrFxn (IArg arg)
     RcmClient_Packet          * packet;
     List_Elem                 * elem;
     List_Handle                 listH;
-    List_Handle                 readyQueueH;
     UInt16                      jobId;
     IArg                        key;
     RcmServer_ThreadPool      * pool;
@@ -2461,7 +2709,6 @@ _RcmServer_workerThrFxn (IArg arg)
     GT_1trace (curTrace, GT_ENTER, "_RcmServer_workerThrFxn", arg);
 
     obj = (RcmServer_WorkerThread *)arg;
-    readyQueueH = &obj->pool->readyQueue;
     packet = NULL;
     running = TRUE;
 
@@ -2495,8 +2742,8 @@ _RcmServer_workerThrFxn (IArg arg)
             continue;
         }
 
-        /* Get next message from ready queue */
-        packet = (RcmClient_Packet *)List_get (readyQueueH);
+        /* Get next message from own ready queue, or steal one */
+        packet = _RcmServer_take (obj);
         if (packet == NULL) {
             GT_1trace (curTrace,
                        GT_2CLASS,
@@ -2515,7 +2762,9 @@ _RcmServer_workerThrFxn (IArg arg)
         jobId = packet->message.jobId;
 
         /* Process the message */
+        obj->busy = TRUE;
         _RcmServer_process(obj->server, packet);
+        obj->busy = FALSE;
         packet = NULL;
 
         /* If this worker thread just finished processing a job message,
@@ -2556,9 +2805,13 @@ _RcmServer_workerThrFxn (IArg arg)
                     break;
                 }
                 else {
-                    /* Get target pool id */
+                    /* Get target pool id and queue it in one of the pool's
+                     * worker ready queues */
                     packet = (RcmClient_Packet *)elem;
                     rval = _RcmServer_getPool (obj->server, packet, &pool);
+                    if (rval >= 0) {
+                        rval = _RcmServer_enqueue (pool, packet);
+                    }
                     /* If error, return the message to the client */
                     if (rval < 0) {
                         switch (rval) {
@@ -2586,20 +2839,8 @@ _RcmServer_workerThrFxn (IArg arg)
                                                  "back to the client!");
                         }
                     }
-                    /* Packet is valid, queue it in the corresponding pool's
-                     * ready queue */
                     else {
-                        listH = &pool->readyQueue;
-                        List_put (listH, elem);
                         packet = NULL;
-                        rval = OsalSemaphore_post (pool->sem);
-                        if (rval < 0) {
-                            GT_setFailureReason (curTrace,
-                                                 GT_4CLASS,
-                                                 "_RcmServer_workerThrFxn",
-                                                 rval,
-                                                 "Pool Ssemaphore post failed");
-                        }
                     }
 
                     /* Loop around and wait to be run again */
@@ -66,6 +66,7 @@
 #include <ti/ipc/MultiProc.h>
 #include <ti/ipc/SharedRegion.h>
 #include <ti/ipc/MessageQ.h>
+#include <_NameServer.h>
 
 /* Sample headers */
 #include <CrashInfo.h>
@@ -397,6 +398,9 @@ static Void sysM3EventHandler (Void)
             exceptionDumpWdtRegisters (PROC_SYSM3);
         }
 
+        /* The names of the M3 cores go away with them */
+        NameServer_invalidateCache ();
+
         /* Initiate cleanup */
         isSysM3Event = TRUE;
         restart = TRUE;
@@ -443,6 +447,9 @@ static Void appM3EventHandler (Void)
             exceptionDumpRegisters ();
         }
 
+        /* The names of the M3 cores go away with them */
+        NameServer_invalidateCache ();
+
         /* Initiate cleanup */
         isAppM3Event = TRUE;
         restart = TRUE;
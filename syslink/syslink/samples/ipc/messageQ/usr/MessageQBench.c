@@ -0,0 +1,324 @@
+/*
+ *  Copyright 2001-2009 Texas Instruments - http://www.ti.com/
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*==============================================================================
+ *  @file   MessageQBench.c
+ *
+ *  @brief  Throughput and latency of MessageQ_put/get against
+ *          MessageQ_putv/getv on a local queue
+ *
+ *  The messages never leave the MPU: they go through the MessageQ driver and
+ *  back into the same process, so the numbers are the cost of the driver
+ *  crossings and not of a remote transport. Needs the syslink daemon (or
+ *  the SysM3 image) to have set up SharedRegion 0.
+ *
+ *  Usage: messageQBench.out [iterations]
+ *
+ *  Prints one CSV row per implementation and batch size:
+ *  impl,batch,messages,msgs_per_sec,us_per_msg,max_us_per_batch
+ *
+ *  Each iteration puts a batch of messages to the queue and gets them back.
+ *  us_per_msg is the average of that round trip divided by the batch size,
+ *  max_us_per_batch the slowest round trip.
+ *
+ *  ============================================================================
+ */
+
+
+/* Standard headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Std.h>
+
+/* OSAL & Utils headers */
+#include <Trace.h>
+#include <OsalPrint.h>
+#include <Memory.h>
+
+/* Module level headers */
+#include <IpcUsr.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/ipc/HeapBufMP.h>
+#include <ti/ipc/SharedRegion.h>
+
+
+#if defined (__cplusplus)
+extern "C" {
+#endif /* defined (__cplusplus) */
+
+
+/** ============================================================================
+ *  Macros and types
+ *  ============================================================================
+ */
+#define MESSAGEQBENCH_ITERATIONS    10000
+#define MESSAGEQBENCH_MSGSIZE       64u
+#define MESSAGEQBENCH_HEAPID        1u
+#define MESSAGEQBENCH_HEAPNAME      "BenchHeap"
+#define MESSAGEQBENCH_QUEUENAME     "MsgQBench"
+#define MESSAGEQBENCH_MAXBATCH      64
+
+
+/** ============================================================================
+ *  Globals
+ *  ============================================================================
+ */
+static const UInt MessageQBench_batches [] = { 1, 4, 16, 32, 64 };
+
+
+/** ============================================================================
+ *  Functions
+ *  ============================================================================
+ */
+static long long
+MessageQBench_nowUs (Void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (long long) ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+
+/* One put and get round trip of count messages, one driver call per message */
+static Int
+MessageQBench_single (MessageQ_Handle    handle,
+                      MessageQ_QueueId   queueId,
+                      MessageQ_Msg     * msgs,
+                      UInt               count)
+{
+    Int  status = MessageQ_S_SUCCESS;
+    UInt i;
+
+    for (i = 0; (i < count) && (status >= 0); i++) {
+        status = MessageQ_put (queueId, msgs [i]);
+    }
+
+    for (i = 0; (i < count) && (status >= 0); i++) {
+        status = MessageQ_get (handle, &msgs [i], MessageQ_FOREVER);
+    }
+
+    return status;
+}
+
+
+/* The same round trip through MessageQ_putv and MessageQ_getv */
+static Int
+MessageQBench_vector (MessageQ_Handle    handle,
+                      MessageQ_QueueId   queueId,
+                      MessageQ_Msg     * msgs,
+                      UInt               count)
+{
+    Int  status;
+    UInt done = 0;
+    UInt n    = count;
+
+    status = MessageQ_putv (queueId, msgs, &n);
+
+    while ((status >= 0) && (done < count)) {
+        n = count - done;
+        status = MessageQ_getv (handle, &msgs [done], &n, MessageQ_FOREVER);
+        done += n;
+    }
+
+    return status;
+}
+
+
+static Int
+MessageQBench_run (MessageQ_Handle handle, UInt iterations)
+{
+    Int                status  = MessageQ_S_SUCCESS;
+    MessageQ_QueueId   queueId = MessageQ_getQueueId (handle);
+    MessageQ_Msg       msgs [MESSAGEQBENCH_MAXBATCH];
+    UInt               allocated;
+    UInt               b;
+    UInt               impl;
+    UInt               n;
+    long long          start;
+    long long          round;
+    long long          total;
+    long long          worst;
+
+    for (allocated = 0; allocated < MESSAGEQBENCH_MAXBATCH; allocated++) {
+        msgs [allocated] = MessageQ_alloc (MESSAGEQBENCH_HEAPID,
+                                           MESSAGEQBENCH_MSGSIZE);
+        if (msgs [allocated] == NULL) {
+            Osal_printf ("Error in MessageQ_alloc\n");
+            status = MessageQ_E_MEMORY;
+            break;
+        }
+    }
+
+    if (status >= 0) {
+        printf ("impl,batch,messages,msgs_per_sec,us_per_msg,"
+                "max_us_per_batch\n");
+    }
+
+    for (impl = 0; (impl < 2) && (status >= 0); impl++) {
+        for (b = 0;
+             (b < sizeof (MessageQBench_batches) / sizeof (UInt))
+             && (status >= 0);
+             b++) {
+            /* Warm up the driver and the caches. */
+            status = (impl == 0)
+                 ? MessageQBench_single (handle, queueId, msgs,
+                                         MessageQBench_batches [b])
+                 : MessageQBench_vector (handle, queueId, msgs,
+                                         MessageQBench_batches [b]);
+
+            total = 0;
+            worst = 0;
+            for (n = 0; (n < iterations) && (status >= 0); n++) {
+                start = MessageQBench_nowUs ();
+                status = (impl == 0)
+                     ? MessageQBench_single (handle, queueId, msgs,
+                                             MessageQBench_batches [b])
+                     : MessageQBench_vector (handle, queueId, msgs,
+                                             MessageQBench_batches [b]);
+                round = MessageQBench_nowUs () - start;
+                total += round;
+                if (round > worst) {
+                    worst = round;
+                }
+            }
+
+            if (status < 0) {
+                Osal_printf ("Round trip failed [0x%x]\n", status);
+            }
+            else {
+                n = iterations * MessageQBench_batches [b];
+                printf ("%s,%u,%u,%.0f,%.2f,%lld\n",
+                        (impl == 0) ? "single" : "vector",
+                        MessageQBench_batches [b],
+                        n,
+                        (total > 0) ? (n * 1e6 / total) : 0.0,
+                        (Double) total / n,
+                        worst);
+            }
+        }
+    }
+
+    while (allocated > 0) {
+        MessageQ_free (msgs [--allocated]);
+    }
+
+    return status;
+}
+
+
+int
+main (int argc, char ** argv)
+{
+    Int                status     = 0;
+    UInt               iterations = MESSAGEQBENCH_ITERATIONS;
+    Ipc_Config         config;
+    HeapBufMP_Params   heapbufmpParams;
+    HeapBufMP_Handle   heapHandle = NULL;
+    IHeap_Handle       srHeap     = NULL;
+    SizeT              heapSize   = 0;
+    Ptr                heapPtr    = NULL;
+    MessageQ_Params    msgParams;
+    MessageQ_Handle    handle     = NULL;
+
+    if (argc > 1) {
+        iterations = strtoul (argv [1], NULL, 0);
+        if (iterations == 0) {
+            Osal_printf ("Usage: %s [iterations]\n", argv [0]);
+            return 1;
+        }
+    }
+
+    Ipc_getConfig (&config);
+    status = Ipc_setup (&config);
+    if (status < 0) {
+        Osal_printf ("Error in Ipc_setup [0x%x]\n", status);
+        return 1;
+    }
+
+    HeapBufMP_Params_init (&heapbufmpParams);
+    heapbufmpParams.name       = MESSAGEQBENCH_HEAPNAME;
+    heapbufmpParams.align      = 128;
+    heapbufmpParams.numBlocks  = MESSAGEQBENCH_MAXBATCH;
+    heapbufmpParams.blockSize  = MESSAGEQBENCH_MSGSIZE;
+    heapSize = HeapBufMP_sharedMemReq (&heapbufmpParams);
+
+    srHeap = SharedRegion_getHeap (0);
+    if (srHeap == NULL) {
+        Osal_printf ("SharedRegion_getHeap failed\n");
+        status = MessageQ_E_FAIL;
+    }
+    else {
+        heapPtr = Memory_alloc (srHeap, heapSize, 0);
+        if (heapPtr == NULL) {
+            Osal_printf ("Memory_alloc failed\n");
+            status = MessageQ_E_MEMORY;
+        }
+    }
+
+    if (status >= 0) {
+        heapbufmpParams.sharedAddr = heapPtr;
+        heapHandle = HeapBufMP_create (&heapbufmpParams);
+        if (heapHandle == NULL) {
+            Osal_printf ("HeapBufMP_create failed\n");
+            status = MessageQ_E_FAIL;
+        }
+        else {
+            status = MessageQ_registerHeap (heapHandle, MESSAGEQBENCH_HEAPID);
+            if (status < 0) {
+                Osal_printf ("MessageQ_registerHeap failed [0x%x]\n", status);
+            }
+        }
+    }
+
+    if (status >= 0) {
+        MessageQ_Params_init (&msgParams);
+        handle = MessageQ_create (MESSAGEQBENCH_QUEUENAME, &msgParams);
+        if (handle == NULL) {
+            Osal_printf ("Error in MessageQ_create\n");
+            status = MessageQ_E_FAIL;
+        }
+    }
+
+    if (status >= 0) {
+        status = MessageQBench_run (handle, iterations);
+    }
+
+    /* Clean-up */
+    if (handle != NULL) {
+        MessageQ_delete (&handle);
+    }
+
+    if (heapHandle != NULL) {
+        MessageQ_unregisterHeap (MESSAGEQBENCH_HEAPID);
+        HeapBufMP_delete (&heapHandle);
+    }
+
+    if (heapPtr != NULL) {
+        Memory_free (srHeap, heapPtr, heapSize);
+    }
+
+    Ipc_destroy ();
+
+    return (status < 0) ? 1 : 0;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
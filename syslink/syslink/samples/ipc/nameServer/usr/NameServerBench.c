@@ -0,0 +1,216 @@
+/*
+ *  Copyright 2001-2009 Texas Instruments - http://www.ti.com/
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*============================================================================
+ *  @file   NameServerBench.c
+ *
+ *  @brief  Cost of NameServer lookups with and without the process-local
+ *          lookup cache
+ *
+ *  Needs the syslink daemon to be running, as Ipc_setup does.
+ *
+ *  Usage: nameServerBench.out [iterations]
+ *
+ *  Prints one CSV row per kind of lookup and cache state:
+ *  lookup,cache,lookups,lookups_per_sec,us_per_lookup
+ *
+ *  lookup is "found" for names in the table and "notfound" for names that
+ *  are not. cache is "cold" when the cache is dropped before every lookup,
+ *  so each one is a driver call, and "warm" otherwise. The cache counters
+ *  are printed last:
+ *  hits,neg_hits,misses,invalidations
+ *
+ *  ============================================================================
+ */
+
+ /* OS-specific headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+ /* Standard headers */
+#include <Std.h>
+
+/* OSAL & Utils headers */
+#include <OsalPrint.h>
+
+/* Module level headers */
+#include <IpcUsr.h>
+#include <ti/ipc/NameServer.h>
+#include <_NameServer.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif /* defined (__cplusplus) */
+
+/** ============================================================================
+ *  Macros and types
+ *  ============================================================================
+ */
+#define NAMESERVERBENCH_ITERATIONS  100000
+#define NAMESERVERBENCH_NUMNAMES    16
+#define NAMESERVERBENCH_NAME        "NsBench"
+
+
+/** ============================================================================
+ *  Functions
+ *  ============================================================================
+ */
+static long long
+nameServerBench_nowUs (Void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (long long) ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+
+/* Times lookups of the names with the given prefix, in turn */
+static Int
+nameServerBench_measure (NameServer_Handle  handle,
+                         String             prefix,
+                         Bool               warm,
+                         UInt               iterations)
+{
+    Int         expected;
+    Int         status;
+    Char        names [NAMESERVERBENCH_NUMNAMES][NameServer_Params_MAXNAMELEN];
+    UInt32      value;
+    UInt        i;
+    long long   start;
+    long long   elapsed;
+
+    for (i = 0; i < NAMESERVERBENCH_NUMNAMES; i++) {
+        snprintf (names [i], NameServer_Params_MAXNAMELEN, "%s%u", prefix, i);
+    }
+    expected = (prefix [0] == 'f') ? NameServer_S_SUCCESS
+                                   : NameServer_E_NOTFOUND;
+
+    NameServer_invalidateCache ();
+
+    start = nameServerBench_nowUs ();
+
+    for (i = 0; i < iterations; i++) {
+        if (warm == FALSE) {
+            NameServer_invalidateCache ();
+        }
+        status = NameServer_getLocalUInt32 (handle,
+                                            names [i % NAMESERVERBENCH_NUMNAMES],
+                                            &value);
+        if (    (status != expected)
+            ||  ((status >= 0) && (value != i % NAMESERVERBENCH_NUMNAMES))) {
+            Osal_printf ("Lookup of %s returned [0x%x]\n",
+                         names [i % NAMESERVERBENCH_NUMNAMES], status);
+            return NameServer_E_FAIL;
+        }
+    }
+
+    elapsed = nameServerBench_nowUs () - start;
+
+    printf ("%s,%s,%u,%.0f,%.2f\n",
+            (expected >= 0) ? "found" : "notfound",
+            (warm == TRUE) ? "warm" : "cold",
+            iterations,
+            (elapsed > 0) ? (iterations * 1e6 / elapsed) : 0.0,
+            (Double) elapsed / iterations);
+
+    return NameServer_S_SUCCESS;
+}
+
+
+int
+main (int argc, char ** argv)
+{
+    Int                   status     = 0;
+    UInt                  iterations = NAMESERVERBENCH_ITERATIONS;
+    Ipc_Config            config;
+    NameServer_Params     params;
+    NameServer_Handle     handle     = NULL;
+    NameServer_CacheStats stats;
+    Char                  name [NameServer_Params_MAXNAMELEN];
+    UInt                  i;
+
+    if (argc > 1) {
+        iterations = strtoul (argv [1], NULL, 0);
+        if (iterations == 0) {
+            Osal_printf ("Usage: %s [iterations]\n", argv [0]);
+            return 1;
+        }
+    }
+
+    Ipc_getConfig (&config);
+    status = Ipc_setup (&config);
+    if (status < 0) {
+        Osal_printf ("Error in Ipc_setup [0x%x]\n", status);
+        return 1;
+    }
+
+    NameServer_Params_init (&params);
+    params.maxRuntimeEntries = NAMESERVERBENCH_NUMNAMES;
+    params.maxValueLen       = sizeof (UInt32);
+    handle = NameServer_create (NAMESERVERBENCH_NAME, &params);
+    if (handle == NULL) {
+        Osal_printf ("Error in NameServer_create\n");
+        status = NameServer_E_FAIL;
+    }
+
+    for (i = 0; (i < NAMESERVERBENCH_NUMNAMES) && (status >= 0); i++) {
+        snprintf (name, sizeof (name), "found%u", i);
+        if (NameServer_addUInt32 (handle, name, i) == NULL) {
+            Osal_printf ("Error in NameServer_addUInt32 (%s)\n", name);
+            status = NameServer_E_FAIL;
+        }
+    }
+
+    if (status >= 0) {
+        printf ("lookup,cache,lookups,lookups_per_sec,us_per_lookup\n");
+        status = nameServerBench_measure (handle, "found", FALSE, iterations);
+    }
+    if (status >= 0) {
+        status = nameServerBench_measure (handle, "found", TRUE, iterations);
+    }
+    if (status >= 0) {
+        status = nameServerBench_measure (handle, "none", FALSE, iterations);
+    }
+    if (status >= 0) {
+        status = nameServerBench_measure (handle, "none", TRUE, iterations);
+    }
+
+    if (status >= 0) {
+        NameServer_getCacheStats (&stats);
+        printf ("hits,neg_hits,misses,invalidations\n");
+        printf ("%u,%u,%u,%u\n",
+                stats.hits,
+                stats.negHits,
+                stats.misses,
+                stats.invalidations);
+    }
+
+    /* Clean-up */
+    if (handle != NULL) {
+        NameServer_delete (&handle);
+    }
+
+    Ipc_destroy ();
+
+    return (status < 0) ? 1 : 0;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
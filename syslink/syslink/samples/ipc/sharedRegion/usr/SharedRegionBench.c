@@ -0,0 +1,263 @@
+/*
+ *  Copyright 2001-2009 Texas Instruments - http://www.ti.com/
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*============================================================================
+ *  @file   SharedRegionBench.c
+ *
+ *  @brief  Address translations per second of the SharedRegion module, from
+ *          the regions already set up to all SharedRegion_numEntries of them
+ *
+ *  Like sharedRegionApp, the extra regions are carved out of the SysM3
+ *  shared memory window, in the region ids nobody uses. SysM3 must be
+ *  running, as it is with the syslink daemon.
+ *
+ *  Usage: sharedRegionBench.out [iterations]
+ *
+ *  Prints one CSV row per number of valid regions:
+ *  regions,lookups,lookups_per_sec,ns_per_lookup
+ *
+ *  A lookup is the round trip of an address through SharedRegion_getId,
+ *  SharedRegion_getSRPtr and SharedRegion_getPtr, as done when a buffer
+ *  pointer is marshalled. Addresses are spread over all the valid regions.
+ *
+ *  ============================================================================
+ */
+
+ /* OS-specific headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+ /* Standard headers */
+#include <Std.h>
+
+/* OSAL & Utils headers */
+#include <Trace.h>
+#include <OsalPrint.h>
+
+/* Module level headers */
+#include <IpcUsr.h>
+#include <ti/ipc/MultiProc.h>
+#include <ti/ipc/SharedRegion.h>
+
+#include <ProcMgr.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif /* defined (__cplusplus) */
+
+/** ============================================================================
+ *  Macros and types
+ *  ============================================================================
+ */
+#define SHAREDREGIONBENCH_ITERATIONS    1000000
+#define SHAREDREGIONBENCH_SAMPLES       256
+
+/*!
+ *  @brief  Slave address and size of each region added by the benchmark
+ */
+#define SHAREDMEM                       0xA0000000
+#define SHAREDREGIONBENCH_SLICE         0x1000
+
+
+/** ============================================================================
+ *  Functions
+ *  ============================================================================
+ */
+static long long
+sharedRegionBench_nowNs (Void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/* Times lookups spread over the currently valid regions */
+static Int
+sharedRegionBench_measure (UInt iterations)
+{
+    SharedRegion_Entry  entry;
+    SharedRegion_SRPtr  srPtr;
+    UInt32              samples [SHAREDREGIONBENCH_SAMPLES];
+    UInt32              valid [SHAREDREGIONBENCH_SAMPLES];
+    UInt16              numEntries = SharedRegion_getNumRegions ();
+    UInt                numValid   = 0;
+    UInt                errors     = 0;
+    UInt                i;
+    UInt16              id;
+    Ptr                 addr;
+    long long           start;
+    long long           elapsed;
+
+    for (i = 0;
+         (i < numEntries) && (numValid < SHAREDREGIONBENCH_SAMPLES);
+         i++) {
+        if (    (SharedRegion_getEntry (i, &entry) >= 0)
+            &&  (entry.isValid == TRUE)) {
+            valid [numValid++] = i;
+        }
+    }
+
+    if (numValid == 0) {
+        Osal_printf ("No valid SharedRegion\n");
+        return SharedRegion_E_FAIL;
+    }
+
+    /* Word aligned addresses, scattered over each region in turn. */
+    for (i = 0; i < SHAREDREGIONBENCH_SAMPLES; i++) {
+        SharedRegion_getEntry (valid [i % numValid], &entry);
+        samples [i] = (UInt32) entry.base
+                    + (((i * 2654435761u) % entry.len) & ~3u);
+    }
+
+    start = sharedRegionBench_nowNs ();
+
+    for (i = 0; i < iterations; i++) {
+        addr  = (Ptr) samples [i % SHAREDREGIONBENCH_SAMPLES];
+        id    = SharedRegion_getId (addr);
+        srPtr = SharedRegion_getSRPtr (addr, id);
+        if (SharedRegion_getPtr (srPtr) != addr) {
+            errors++;
+        }
+    }
+
+    elapsed = sharedRegionBench_nowNs () - start;
+
+    if (errors != 0) {
+        Osal_printf ("%u lookups out of %u did not round trip\n",
+                     errors, iterations);
+        return SharedRegion_E_FAIL;
+    }
+
+    printf ("%u,%u,%.0f,%.1f\n",
+            numValid,
+            iterations,
+            (elapsed > 0) ? (iterations * 1e9 / elapsed) : 0.0,
+            (Double) elapsed / iterations);
+
+    return SharedRegion_S_SUCCESS;
+}
+
+
+int
+main (int argc, char ** argv)
+{
+    Int                   status     = 0;
+    UInt                  iterations = SHAREDREGIONBENCH_ITERATIONS;
+    Ipc_Config            config;
+    ProcMgr_Handle        procMgrHandle = NULL;
+    ProcMgr_AttachParams  attachParams;
+    UInt32                shAddrBase;
+    SharedRegion_Entry    entry;
+    UInt16                added [SHAREDREGIONBENCH_SAMPLES];
+    UInt                  numAdded = 0;
+    UInt16                numEntries;
+    UInt16                i;
+
+    if (argc > 1) {
+        iterations = strtoul (argv [1], NULL, 0);
+        if (iterations == 0) {
+            Osal_printf ("Usage: %s [iterations]\n", argv [0]);
+            return 1;
+        }
+    }
+
+    Ipc_getConfig (&config);
+    status = Ipc_setup (&config);
+    if (status < 0) {
+        Osal_printf ("Error in Ipc_setup [0x%x]\n", status);
+        return 1;
+    }
+
+    status = ProcMgr_open (&procMgrHandle, MultiProc_getId ("SysM3"));
+    if (status < 0) {
+        Osal_printf ("Error in ProcMgr_open [0x%x]\n", status);
+    }
+    else {
+        ProcMgr_getAttachParams (NULL, &attachParams);
+        status = ProcMgr_attach (procMgrHandle, &attachParams);
+        if (status < 0) {
+            Osal_printf ("ProcMgr_attach failed [0x%x]\n", status);
+        }
+    }
+
+    if (status >= 0) {
+        status = ProcMgr_translateAddr (procMgrHandle,
+                                        (Ptr) &shAddrBase,
+                                        ProcMgr_AddrType_MasterUsrVirt,
+                                        (Ptr) SHAREDMEM,
+                                        ProcMgr_AddrType_SlaveVirt);
+        if (status < 0) {
+            Osal_printf ("Error in ProcMgr_translateAddr [0x%x]\n", status);
+        }
+    }
+
+    if (status >= 0) {
+        printf ("regions,lookups,lookups_per_sec,ns_per_lookup\n");
+        status = sharedRegionBench_measure (iterations);
+    }
+
+    /* Fill the unused ids one by one, measuring after each. */
+    numEntries = SharedRegion_getNumRegions ();
+    for (i = 0;
+         (i < numEntries) && (status >= 0)
+         && (numAdded < SHAREDREGIONBENCH_SAMPLES);
+         i++) {
+        SharedRegion_getEntry (i, &entry);
+        if (entry.isValid == TRUE) {
+            continue;
+        }
+
+        SharedRegion_entryInit (&entry);
+        entry.base        = (Ptr) (  shAddrBase
+                                   + (numAdded * SHAREDREGIONBENCH_SLICE));
+        entry.len         = SHAREDREGIONBENCH_SLICE;
+        entry.ownerProcId = MultiProc_self ();
+        entry.isValid     = TRUE;
+        entry.createHeap  = FALSE;
+
+        status = SharedRegion_setEntry (i, &entry);
+        if (status < 0) {
+            Osal_printf ("Error in SharedRegion_setEntry (%d) [0x%x]\n",
+                         i, status);
+        }
+        else {
+            added [numAdded++] = i;
+            status = sharedRegionBench_measure (iterations);
+        }
+    }
+
+    /* Clean-up */
+    while (numAdded > 0) {
+        SharedRegion_clearEntry (added [--numAdded]);
+    }
+
+    if (procMgrHandle != NULL) {
+        ProcMgr_detach (procMgrHandle);
+        ProcMgr_close (&procMgrHandle);
+    }
+
+    Ipc_destroy ();
+
+    return (status < 0) ? 1 : 0;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
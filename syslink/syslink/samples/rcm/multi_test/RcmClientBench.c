@@ -0,0 +1,366 @@
+/*
+ *  Copyright 2001-2009 Texas Instruments - http://www.ti.com/
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*==============================================================================
+ *  @file   RcmClientBench.c
+ *
+ *  @brief  Throughput and latency of RcmClient_exec with several threads
+ *          sharing one client, over a loopback RcmServer
+ *
+ *  The server runs in this process on the MPU, so the numbers are the cost
+ *  of the client's return message matching and of the MessageQ driver, and
+ *  not of a remote core. Needs the syslink daemon (or the SysM3 image) to
+ *  have set up SharedRegion 0.
+ *
+ *  Usage: rcm_clientbench.out [calls per thread]
+ *
+ *  Prints one CSV row per number of client threads:
+ *  threads,calls,calls_per_sec,avg_us,max_us
+ *
+ *  avg_us and max_us are the RcmClient_exec round trip seen by a thread.
+ *
+ *  ============================================================================
+ */
+
+ /* OS-specific headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+/* Standard headers */
+#include <Std.h>
+
+/* OSAL & Utils headers */
+#include <OsalPrint.h>
+#include <Memory.h>
+
+/* IPC headers */
+#include <IpcUsr.h>
+#include <ti/ipc/HeapBufMP.h>
+#include <ti/ipc/SharedRegion.h>
+
+/* RCM headers */
+#include <RcmClient.h>
+#include <RcmServer.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif /* defined (__cplusplus) */
+
+/** ============================================================================
+ *  Macros and types
+ *  ============================================================================
+ */
+#define RCMCLIENTBENCH_CALLS        2000
+#define RCMCLIENTBENCH_MAXTHREADS   16
+#define RCMCLIENTBENCH_MSGSIZE      256
+#define RCMCLIENTBENCH_HEAPID       1
+#define RCMCLIENTBENCH_HEAPNAME     "RcmBenchHeap"
+#define RCMCLIENTBENCH_SERVERNAME   "RcmSvr_Bench"
+
+/* Per thread results */
+typedef struct {
+    pthread_t   thread;
+    UInt        calls;
+    Int         status;
+    long long   totalUs;
+    long long   maxUs;
+} RcmClientBench_Thread;
+
+
+/** ============================================================================
+ *  Globals
+ *  ============================================================================
+ */
+static const UInt       RcmClientBench_threads [] = { 1, 2, 4, 8, 16 };
+static RcmClient_Handle RcmClientBench_client     = NULL;
+static UInt32           RcmClientBench_fxnIdx;
+static sem_t            RcmClientBench_go;
+
+
+/** ============================================================================
+ *  Functions
+ *  ============================================================================
+ */
+static long long
+RcmClientBench_nowUs (Void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (long long) ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+
+/*
+ *  ======== fxnDouble ========
+ *  Server side of every call, kept trivial so the round trip dominates.
+ */
+static Int32
+fxnDouble (UInt32 dataSize, UInt32 * data)
+{
+    return (Int32) data [0] * 2;
+}
+
+
+static Void *
+RcmClientBench_threadFxn (Void * arg)
+{
+    RcmClientBench_Thread * self      = (RcmClientBench_Thread *) arg;
+    RcmClient_Message     * rcmMsg;
+    RcmClient_Message     * returnMsg;
+    long long               start;
+    long long               round;
+    UInt                    i;
+
+    sem_wait (&RcmClientBench_go);
+
+    for (i = 0; (i < self->calls) && (self->status >= 0); i++) {
+        self->status = RcmClient_alloc (RcmClientBench_client,
+                                        sizeof (UInt32), &rcmMsg);
+        if (self->status < 0) {
+            Osal_printf ("RcmClient_alloc failed [0x%x]\n", self->status);
+            break;
+        }
+
+        rcmMsg->fxnIdx  = RcmClientBench_fxnIdx;
+        rcmMsg->data[0] = i;
+
+        start = RcmClientBench_nowUs ();
+        self->status = RcmClient_exec (RcmClientBench_client, rcmMsg,
+                                       &returnMsg);
+        round = RcmClientBench_nowUs () - start;
+
+        if (self->status < 0) {
+            Osal_printf ("RcmClient_exec failed [0x%x]\n", self->status);
+            break;
+        }
+
+        if (returnMsg->result != (Int32) i * 2) {
+            Osal_printf ("Call %u returned %d\n", i, returnMsg->result);
+            self->status = RcmClient_E_FAIL;
+        }
+        RcmClient_free (RcmClientBench_client, returnMsg);
+
+        self->totalUs += round;
+        if (round > self->maxUs) {
+            self->maxUs = round;
+        }
+    }
+
+    return NULL;
+}
+
+
+static Int
+RcmClientBench_run (UInt numThreads, UInt calls)
+{
+    RcmClientBench_Thread   threads [RCMCLIENTBENCH_MAXTHREADS];
+    Int                     status  = RcmClient_S_SUCCESS;
+    long long               totalUs = 0;
+    long long               maxUs   = 0;
+    long long               start;
+    long long               elapsed;
+    UInt                    n;
+    UInt                    i;
+
+    for (i = 0; i < numThreads; i++) {
+        threads [i].calls   = calls;
+        threads [i].status  = RcmClient_S_SUCCESS;
+        threads [i].totalUs = 0;
+        threads [i].maxUs   = 0;
+        pthread_create (&threads [i].thread, NULL, RcmClientBench_threadFxn,
+                        &threads [i]);
+    }
+
+    /* Release all threads at once */
+    start = RcmClientBench_nowUs ();
+    for (i = 0; i < numThreads; i++) {
+        sem_post (&RcmClientBench_go);
+    }
+
+    for (i = 0; i < numThreads; i++) {
+        pthread_join (threads [i].thread, NULL);
+        if (threads [i].status < 0) {
+            status = threads [i].status;
+        }
+        totalUs += threads [i].totalUs;
+        if (threads [i].maxUs > maxUs) {
+            maxUs = threads [i].maxUs;
+        }
+    }
+    elapsed = RcmClientBench_nowUs () - start;
+
+    if (status >= 0) {
+        n = numThreads * calls;
+        printf ("%u,%u,%.0f,%.1f,%lld\n",
+                numThreads,
+                n,
+                (elapsed > 0) ? (n * 1e6 / elapsed) : 0.0,
+                (Double) totalUs / n,
+                maxUs);
+    }
+
+    return status;
+}
+
+
+int
+main (int argc, char ** argv)
+{
+    Int                 status     = 0;
+    UInt                calls      = RCMCLIENTBENCH_CALLS;
+    Ipc_Config          config;
+    HeapBufMP_Params    heapbufmpParams;
+    HeapBufMP_Handle    heapHandle = NULL;
+    IHeap_Handle        srHeap     = NULL;
+    SizeT               heapSize   = 0;
+    Ptr                 heapPtr    = NULL;
+    RcmServer_Params    serverParams;
+    RcmServer_Handle    server     = NULL;
+    RcmClient_Params    clientParams;
+    UInt                i;
+
+    if (argc > 1) {
+        calls = strtoul (argv [1], NULL, 0);
+        if (calls == 0) {
+            Osal_printf ("Usage: %s [calls per thread]\n", argv [0]);
+            return 1;
+        }
+    }
+
+    Ipc_getConfig (&config);
+    status = Ipc_setup (&config);
+    if (status < 0) {
+        Osal_printf ("Error in Ipc_setup [0x%x]\n", status);
+        return 1;
+    }
+
+    sem_init (&RcmClientBench_go, 0, 0);
+
+    /* Room for every thread to have a message in flight */
+    HeapBufMP_Params_init (&heapbufmpParams);
+    heapbufmpParams.name       = RCMCLIENTBENCH_HEAPNAME;
+    heapbufmpParams.align      = 128;
+    heapbufmpParams.numBlocks  = 2 * RCMCLIENTBENCH_MAXTHREADS;
+    heapbufmpParams.blockSize  = RCMCLIENTBENCH_MSGSIZE;
+    heapSize = HeapBufMP_sharedMemReq (&heapbufmpParams);
+
+    srHeap = SharedRegion_getHeap (0);
+    if (srHeap == NULL) {
+        Osal_printf ("SharedRegion_getHeap failed\n");
+        status = RcmClient_E_FAIL;
+    }
+    else {
+        heapPtr = Memory_alloc (srHeap, heapSize, 0);
+        if (heapPtr == NULL) {
+            Osal_printf ("Memory_alloc failed\n");
+            status = RcmClient_E_NOMEMORY;
+        }
+    }
+
+    if (status >= 0) {
+        heapbufmpParams.sharedAddr = heapPtr;
+        heapHandle = HeapBufMP_create (&heapbufmpParams);
+        if (heapHandle == NULL) {
+            Osal_printf ("HeapBufMP_create failed\n");
+            status = RcmClient_E_FAIL;
+        }
+        else {
+            status = MessageQ_registerHeap (heapHandle, RCMCLIENTBENCH_HEAPID);
+            if (status < 0) {
+                Osal_printf ("MessageQ_registerHeap failed [0x%x]\n", status);
+            }
+        }
+    }
+
+    /* Loopback server */
+    if (status >= 0) {
+        RcmServer_init ();
+        RcmServer_Params_init (&serverParams);
+        status = RcmServer_create (RCMCLIENTBENCH_SERVERNAME, &serverParams,
+                                   &server);
+        if (status < 0) {
+            Osal_printf ("RcmServer_create failed [0x%x]\n", status);
+        }
+        else {
+            status = RcmServer_addSymbol (server, "fxnDouble", fxnDouble,
+                                          &RcmClientBench_fxnIdx);
+            if (status >= 0) {
+                status = RcmServer_start (server);
+            }
+            if (status < 0) {
+                Osal_printf ("RcmServer set-up failed [0x%x]\n", status);
+            }
+        }
+    }
+
+    if (status >= 0) {
+        RcmClient_init ();
+        RcmClient_Params_init (&clientParams);
+        clientParams.heapId = RCMCLIENTBENCH_HEAPID;
+        status = RcmClient_create (RCMCLIENTBENCH_SERVERNAME, &clientParams,
+                                   &RcmClientBench_client);
+        if (status < 0) {
+            Osal_printf ("RcmClient_create failed [0x%x]\n", status);
+        }
+    }
+
+    if (status >= 0) {
+        printf ("threads,calls,calls_per_sec,avg_us,max_us\n");
+    }
+
+    for (i = 0;
+         (i < sizeof (RcmClientBench_threads) / sizeof (UInt))
+         && (status >= 0);
+         i++) {
+        status = RcmClientBench_run (RcmClientBench_threads [i], calls);
+    }
+
+    /* Clean-up */
+    if (RcmClientBench_client != NULL) {
+        RcmClient_delete (&RcmClientBench_client);
+        RcmClient_exit ();
+    }
+
+    if (server != NULL) {
+        RcmServer_delete (&server);
+        RcmServer_exit ();
+    }
+
+    if (heapHandle != NULL) {
+        MessageQ_unregisterHeap (RCMCLIENTBENCH_HEAPID);
+        HeapBufMP_delete (&heapHandle);
+    }
+
+    if (heapPtr != NULL) {
+        Memory_free (srHeap, heapPtr, heapSize);
+    }
+
+    sem_destroy (&RcmClientBench_go);
+
+    Ipc_destroy ();
+
+    return (status < 0) ? 1 : 0;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
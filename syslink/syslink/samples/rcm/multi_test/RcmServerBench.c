@@ -0,0 +1,481 @@
+/*
+ *  Copyright 2001-2009 Texas Instruments - http://www.ti.com/
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*==============================================================================
+ *  @file   RcmServerBench.c
+ *
+ *  @brief  Tail latency of short RcmServer functions mixed with long ones
+ *
+ *  A loopback RcmServer runs in this process with a default pool of
+ *  RCMSERVERBENCH_WORKERS worker threads and a dedicated pool of one
+ *  thread. Client threads call a trivial function, and a share of the
+ *  calls go to a function that spins for RCMSERVERBENCH_LONGUS. The long
+ *  calls are sent either to the default pool, with the short ones, or to
+ *  the dedicated pool. Needs the syslink daemon (or the SysM3 image) to
+ *  have set up SharedRegion 0.
+ *
+ *  Usage: rcm_serverbench.out [calls per thread]
+ *
+ *  Prints one CSV row per long call pool and share of long calls:
+ *  long_pool,long_pct,short_calls,p50_us,p99_us,max_us,long_calls
+ *
+ *  p50_us, p99_us and max_us are the RcmClient_exec round trip of the
+ *  short calls. Then the execution statistics the server kept for each
+ *  function over all the runs, from RcmServer_getFxnStats:
+ *  fxn,calls,avg_us,max_us
+ *
+ *  ============================================================================
+ */
+
+ /* OS-specific headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+/* Standard headers */
+#include <Std.h>
+
+/* OSAL & Utils headers */
+#include <OsalPrint.h>
+#include <Memory.h>
+
+/* IPC headers */
+#include <IpcUsr.h>
+#include <ti/ipc/HeapBufMP.h>
+#include <ti/ipc/SharedRegion.h>
+
+/* RCM headers */
+#include <RcmClient.h>
+#include <RcmServer.h>
+
+#if defined (__cplusplus)
+extern "C" {
+#endif /* defined (__cplusplus) */
+
+/** ============================================================================
+ *  Macros and types
+ *  ============================================================================
+ */
+#define RCMSERVERBENCH_CALLS        500
+#define RCMSERVERBENCH_THREADS      8
+#define RCMSERVERBENCH_WORKERS      4
+#define RCMSERVERBENCH_LONGUS       5000
+#define RCMSERVERBENCH_MSGSIZE      256
+#define RCMSERVERBENCH_HEAPID       1
+#define RCMSERVERBENCH_HEAPNAME     "RcmSrvBenchHeap"
+#define RCMSERVERBENCH_SERVERNAME   "RcmSvr_SrvBench"
+
+/* Pool ids as seen by the client: static pools have bit 15 set */
+#define RCMSERVERBENCH_SLOWPOOLID   0x8001
+
+/* Per thread results */
+typedef struct {
+    pthread_t   thread;
+    UInt        index;
+    UInt        calls;
+    UInt        every;      /* One call in every is a long call, 0 = none */
+    UInt16      longPool;   /* Pool id for the long calls */
+    Int         status;
+    UInt        numShort;
+    UInt        numLong;
+    long long * shortUs;    /* Round trip of each short call */
+} RcmServerBench_Thread;
+
+
+/** ============================================================================
+ *  Globals
+ *  ============================================================================
+ */
+static const UInt       RcmServerBench_pcts [] = { 0, 1, 5, 10 };
+static RcmClient_Handle RcmServerBench_client   = NULL;
+static UInt32           RcmServerBench_shortIdx;
+static UInt32           RcmServerBench_longIdx;
+static sem_t            RcmServerBench_go;
+
+
+/** ============================================================================
+ *  Functions
+ *  ============================================================================
+ */
+static long long
+RcmServerBench_nowUs (Void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    return (long long) ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+
+/*
+ *  ======== fxnShort ========
+ */
+static Int32
+fxnShort (UInt32 dataSize, UInt32 * data)
+{
+    return (Int32) data [0] * 2;
+}
+
+
+/*
+ *  ======== fxnLong ========
+ *  Keeps its worker thread busy, like a handler doing real work would.
+ */
+static Int32
+fxnLong (UInt32 dataSize, UInt32 * data)
+{
+    long long end = RcmServerBench_nowUs () + RCMSERVERBENCH_LONGUS;
+
+    while (RcmServerBench_nowUs () < end) {
+        /* spin */
+    }
+
+    return (Int32) data [0] * 2;
+}
+
+
+static int
+RcmServerBench_cmp (const void * a, const void * b)
+{
+    long long x = *(const long long *) a;
+    long long y = *(const long long *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+static Void *
+RcmServerBench_threadFxn (Void * arg)
+{
+    RcmServerBench_Thread * self      = (RcmServerBench_Thread *) arg;
+    RcmClient_Message     * rcmMsg;
+    RcmClient_Message     * returnMsg;
+    Bool                    isLong;
+    long long               start;
+    long long               round;
+    UInt                    i;
+
+    sem_wait (&RcmServerBench_go);
+
+    for (i = 0; (i < self->calls) && (self->status >= 0); i++) {
+        self->status = RcmClient_alloc (RcmServerBench_client,
+                                        sizeof (UInt32), &rcmMsg);
+        if (self->status < 0) {
+            Osal_printf ("RcmClient_alloc failed [0x%x]\n", self->status);
+            break;
+        }
+
+        /* Spread the long calls of the threads over time */
+        isLong = (self->every != 0)
+                    && (((i + self->index) % self->every) == 0);
+
+        if (isLong) {
+            rcmMsg->fxnIdx = RcmServerBench_longIdx;
+            rcmMsg->poolId = self->longPool;
+        }
+        else {
+            rcmMsg->fxnIdx = RcmServerBench_shortIdx;
+        }
+        rcmMsg->data[0] = i;
+
+        start = RcmServerBench_nowUs ();
+        self->status = RcmClient_exec (RcmServerBench_client, rcmMsg,
+                                       &returnMsg);
+        round = RcmServerBench_nowUs () - start;
+
+        if (self->status < 0) {
+            Osal_printf ("RcmClient_exec failed [0x%x]\n", self->status);
+            break;
+        }
+
+        if (returnMsg->result != (Int32) i * 2) {
+            Osal_printf ("Call %u returned %d\n", i, returnMsg->result);
+            self->status = RcmClient_E_FAIL;
+        }
+        RcmClient_free (RcmServerBench_client, returnMsg);
+
+        if (isLong) {
+            self->numLong++;
+        }
+        else {
+            self->shortUs [self->numShort++] = round;
+        }
+    }
+
+    return NULL;
+}
+
+
+static Int
+RcmServerBench_run (UInt16 longPool, UInt pct, UInt calls)
+{
+    RcmServerBench_Thread   threads [RCMSERVERBENCH_THREADS];
+    Int                     status   = RcmClient_S_SUCCESS;
+    long long             * all;
+    UInt                    numShort = 0;
+    UInt                    numLong  = 0;
+    UInt                    i;
+
+    all = malloc (RCMSERVERBENCH_THREADS * calls * sizeof (long long));
+    if (all == NULL) {
+        Osal_printf ("malloc failed\n");
+        return RcmClient_E_NOMEMORY;
+    }
+
+    for (i = 0; i < RCMSERVERBENCH_THREADS; i++) {
+        threads [i].index    = i;
+        threads [i].calls    = calls;
+        threads [i].every    = (pct == 0) ? 0 : (100 / pct);
+        threads [i].longPool = longPool;
+        threads [i].status   = RcmClient_S_SUCCESS;
+        threads [i].numShort = 0;
+        threads [i].numLong  = 0;
+        threads [i].shortUs  = all + (i * calls);
+        pthread_create (&threads [i].thread, NULL, RcmServerBench_threadFxn,
+                        &threads [i]);
+    }
+
+    /* Release all threads at once */
+    for (i = 0; i < RCMSERVERBENCH_THREADS; i++) {
+        sem_post (&RcmServerBench_go);
+    }
+
+    for (i = 0; i < RCMSERVERBENCH_THREADS; i++) {
+        pthread_join (threads [i].thread, NULL);
+        if (threads [i].status < 0) {
+            status = threads [i].status;
+        }
+    }
+
+    /* Gather the short call round trips at the start of the array */
+    for (i = 0; i < RCMSERVERBENCH_THREADS; i++) {
+        memmove (all + numShort, threads [i].shortUs,
+                 threads [i].numShort * sizeof (long long));
+        numShort += threads [i].numShort;
+        numLong  += threads [i].numLong;
+    }
+
+    if ((status >= 0) && (numShort > 0)) {
+        qsort (all, numShort, sizeof (long long), RcmServerBench_cmp);
+        printf ("%s,%u,%u,%lld,%lld,%lld,%u\n",
+                (longPool == RcmClient_DEFAULTPOOLID) ? "default" : "dedicated",
+                pct,
+                numShort,
+                all [numShort / 2],
+                all [(numShort * 99) / 100],
+                all [numShort - 1],
+                numLong);
+    }
+
+    free (all);
+
+    return status;
+}
+
+
+static Void
+RcmServerBench_printStats (RcmServer_Handle server, String name)
+{
+    RcmServer_FxnStats  stats;
+
+    if (RcmServer_getFxnStats (server, name, &stats) < 0) {
+        Osal_printf ("RcmServer_getFxnStats (%s) failed\n", name);
+    }
+    else {
+        printf ("%s,%u,%u,%u\n", name, stats.calls, stats.avgUs, stats.maxUs);
+    }
+}
+
+
+int
+main (int argc, char ** argv)
+{
+    Int                         status     = 0;
+    UInt                        calls      = RCMSERVERBENCH_CALLS;
+    Ipc_Config                  config;
+    HeapBufMP_Params            heapbufmpParams;
+    HeapBufMP_Handle            heapHandle = NULL;
+    IHeap_Handle                srHeap     = NULL;
+    SizeT                       heapSize   = 0;
+    Ptr                         heapPtr    = NULL;
+    RcmServer_ThreadPoolDesc    slowPool;
+    RcmServer_Params            serverParams;
+    RcmServer_Handle            server     = NULL;
+    RcmClient_Params            clientParams;
+    UInt                        p;
+    UInt                        i;
+
+    if (argc > 1) {
+        calls = strtoul (argv [1], NULL, 0);
+        if (calls == 0) {
+            Osal_printf ("Usage: %s [calls per thread]\n", argv [0]);
+            return 1;
+        }
+    }
+
+    Ipc_getConfig (&config);
+    status = Ipc_setup (&config);
+    if (status < 0) {
+        Osal_printf ("Error in Ipc_setup [0x%x]\n", status);
+        return 1;
+    }
+
+    sem_init (&RcmServerBench_go, 0, 0);
+
+    /* Room for every thread to have a message in flight */
+    HeapBufMP_Params_init (&heapbufmpParams);
+    heapbufmpParams.name       = RCMSERVERBENCH_HEAPNAME;
+    heapbufmpParams.align      = 128;
+    heapbufmpParams.numBlocks  = 2 * RCMSERVERBENCH_THREADS;
+    heapbufmpParams.blockSize  = RCMSERVERBENCH_MSGSIZE;
+    heapSize = HeapBufMP_sharedMemReq (&heapbufmpParams);
+
+    srHeap = SharedRegion_getHeap (0);
+    if (srHeap == NULL) {
+        Osal_printf ("SharedRegion_getHeap failed\n");
+        status = RcmClient_E_FAIL;
+    }
+    else {
+        heapPtr = Memory_alloc (srHeap, heapSize, 0);
+        if (heapPtr == NULL) {
+            Osal_printf ("Memory_alloc failed\n");
+            status = RcmClient_E_NOMEMORY;
+        }
+    }
+
+    if (status >= 0) {
+        heapbufmpParams.sharedAddr = heapPtr;
+        heapHandle = HeapBufMP_create (&heapbufmpParams);
+        if (heapHandle == NULL) {
+            Osal_printf ("HeapBufMP_create failed\n");
+            status = RcmClient_E_FAIL;
+        }
+        else {
+            status = MessageQ_registerHeap (heapHandle, RCMSERVERBENCH_HEAPID);
+            if (status < 0) {
+                Osal_printf ("MessageQ_registerHeap failed [0x%x]\n", status);
+            }
+        }
+    }
+
+    /* Loopback server, with a dedicated pool for slow functions */
+    if (status >= 0) {
+        RcmServer_init ();
+        RcmServer_Params_init (&serverParams);
+        serverParams.defaultPool.count = RCMSERVERBENCH_WORKERS;
+
+        slowPool.name       = "Slow";
+        slowPool.count      = 1;
+        slowPool.priority   = RCMSERVER_REGULAR_PRIORITY;
+        slowPool.osPriority = RCMSERVER_INVALID_OS_PRIORITY;
+        slowPool.stackSize  = 0;
+        slowPool.stackSeg   = "";
+        serverParams.workerPools.length = 1;
+        serverParams.workerPools.elem   = &slowPool;
+
+        status = RcmServer_create (RCMSERVERBENCH_SERVERNAME, &serverParams,
+                                   &server);
+        if (status < 0) {
+            Osal_printf ("RcmServer_create failed [0x%x]\n", status);
+        }
+        else {
+            status = RcmServer_addSymbol (server, "fxnShort", fxnShort,
+                                          &RcmServerBench_shortIdx);
+            if (status >= 0) {
+                status = RcmServer_addSymbol (server, "fxnLong", fxnLong,
+                                              &RcmServerBench_longIdx);
+            }
+            if (status >= 0) {
+                status = RcmServer_start (server);
+            }
+            if (status < 0) {
+                Osal_printf ("RcmServer set-up failed [0x%x]\n", status);
+            }
+        }
+    }
+
+    if (status >= 0) {
+        RcmClient_init ();
+        RcmClient_Params_init (&clientParams);
+        clientParams.heapId = RCMSERVERBENCH_HEAPID;
+        status = RcmClient_create (RCMSERVERBENCH_SERVERNAME, &clientParams,
+                                   &RcmServerBench_client);
+        if (status < 0) {
+            Osal_printf ("RcmClient_create failed [0x%x]\n", status);
+        }
+    }
+
+    if (status >= 0) {
+        printf ("long_pool,long_pct,short_calls,p50_us,p99_us,max_us,"
+                "long_calls\n");
+    }
+
+    for (p = 0; (p < 2) && (status >= 0); p++) {
+        for (i = 0;
+             (i < sizeof (RcmServerBench_pcts) / sizeof (UInt))
+             && (status >= 0);
+             i++) {
+            /* Without long calls, the pool makes no difference */
+            if ((p == 1) && (RcmServerBench_pcts [i] == 0)) {
+                continue;
+            }
+            status = RcmServerBench_run ((p == 0) ? RcmClient_DEFAULTPOOLID
+                                                  : RCMSERVERBENCH_SLOWPOOLID,
+                                         RcmServerBench_pcts [i], calls);
+        }
+    }
+
+    if (status >= 0) {
+        printf ("\nfxn,calls,avg_us,max_us\n");
+        RcmServerBench_printStats (server, "fxnShort");
+        RcmServerBench_printStats (server, "fxnLong");
+    }
+
+    /* Clean-up */
+    if (RcmServerBench_client != NULL) {
+        RcmClient_delete (&RcmServerBench_client);
+        RcmClient_exit ();
+    }
+
+    if (server != NULL) {
+        RcmServer_delete (&server);
+        RcmServer_exit ();
+    }
+
+    if (heapHandle != NULL) {
+        MessageQ_unregisterHeap (RCMSERVERBENCH_HEAPID);
+        HeapBufMP_delete (&heapHandle);
+    }
+
+    if (heapPtr != NULL) {
+        Memory_free (srHeap, heapPtr, heapSize);
+    }
+
+    sem_destroy (&RcmServerBench_go);
+
+    Ipc_destroy ();
+
+    return (status < 0) ? 1 : 0;
+}
+
+
+#if defined (__cplusplus)
+}
+#endif /* defined (__cplusplus) */
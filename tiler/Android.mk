@@ -18,6 +18,14 @@ LOCAL_MODULE := memmgr_test
 LOCAL_MODULE_TAGS := tests
 include $(BUILD_EXECUTABLE)
 
+include $(CLEAR_VARS)
+LOCAL_ARM_MODE := arm
+LOCAL_SRC_FILES := memmgr_bench.c
+LOCAL_SHARED_LIBRARIES := libtimemmgr
+LOCAL_MODULE := memmgr_bench
+LOCAL_MODULE_TAGS := tests
+include $(BUILD_EXECUTABLE)
+
 include $(CLEAR_VARS)
 LOCAL_ARM_MODE := arm
 LOCAL_SRC_FILES := utils_test.c testlib.c
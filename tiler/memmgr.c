@@ -33,6 +33,9 @@
  *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+/* pthread_rwlock_t is only visible to -ansi builds with this */
+#define _XOPEN_SOURCE 600
+
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
@@ -65,59 +68,45 @@ typedef struct tiler_block_info tiler_block_info;
 #include "tilermem.h"
 #include "tilermem_utils.h"
 #include "memmgr.h"
+#ifdef STUB_TILER
+#include "tiler_emu.h"
+#endif
 
-/* list of allocations */
+/* registry of allocations, kept sorted by buffer start address */
 struct _AllocData {
     struct tiler_buf_info buf;
     int       buf_type;
-    struct _AllocList {
-        struct _AllocList *next, *last;
-        struct _AllocData *me;
-    } link;
 };
-static struct _AllocList bufs = {0};
-static int bufs_inited = 0;
-
-typedef struct _AllocList _AllocList;
 typedef struct _AllocData _AllocData;
 
+static _AllocData **bufs = NULL;
+static int num_bufs = 0;
+static int max_bufs = 0;
+
+#define BUFS_GROW_BY 16
+
 static int refCnt = 0;
 static int td = -1;
 static pthread_mutex_t ref_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t che_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t che_lock = PTHREAD_RWLOCK_INITIALIZER;
 
 /**
- * Initializes the static structures
+ * Increases the reference count by a given number of
+ * references.  Initialized tiler if this was the first
+ * reference
  *
- * @author a0194118 (9/8/2009)
- */
-static void init()
-{
-    if (!bufs_inited)
-    {
-        DLIST_INIT(bufs);
-        bufs_inited = 1;
-    }
-}
-
-/**
- * Increases the reference count.  Initialized tiler if this was
- * the first reference
- *
- * @author a0194118 (9/2/2009)
+ * @param num_refs  Number of references to add
  *
  * @return 0 on success, non-0 error value on failure.
  */
-static int inc_ref()
+static int inc_ref_n(int num_refs)
 {
     /* initialize tiler on first call */
     pthread_mutex_lock(&ref_mutex);
 
     int res = MEMMGR_ERR_NONE;
 
-    if (!refCnt++) {
-        /* initialize lists */
-        init();
+    if (!refCnt) {
 #ifndef STUB_TILER
         td = open("/dev/tiler", O_RDWR | O_SYNC);
         if (NOT_I(td,>=,0)) res = MEMMGR_ERR_GENERIC;
@@ -126,9 +115,9 @@ static int inc_ref()
         res = MEMMGR_ERR_NONE;
 #endif
     }
-    if (res)
+    if (!res)
     {
-        refCnt--;
+        refCnt += num_refs;
     }
 
     pthread_mutex_unlock(&ref_mutex);
@@ -136,21 +125,35 @@ static int inc_ref()
 }
 
 /**
- * Decreases the reference count.  Deinitialized tiler if this
- * was the last reference
+ * Increases the reference count.  Initialized tiler if this was
+ * the first reference
  *
  * @author a0194118 (9/2/2009)
  *
  * @return 0 on success, non-0 error value on failure.
  */
-static int dec_ref()
+static int inc_ref()
+{
+    return inc_ref_n(1);
+}
+
+/**
+ * Decreases the reference count by a given number of
+ * references.  Deinitialized tiler if this was the last
+ * reference
+ *
+ * @param num_refs  Number of references to remove
+ *
+ * @return 0 on success, non-0 error value on failure.
+ */
+static int dec_ref_n(int num_refs)
 {
     pthread_mutex_lock(&ref_mutex);
 
-    int res = MEMMGR_ERR_NONE;;
+    int res = MEMMGR_ERR_NONE;
 
-    if (refCnt <= 0) res = MEMMGR_ERR_GENERIC;
-    else if (!--refCnt) {
+    if (refCnt < num_refs) res = MEMMGR_ERR_GENERIC;
+    else if (!(refCnt -= num_refs)) {
 #ifndef STUB_TILER
         close(td);
         td = -1;
@@ -161,6 +164,19 @@ static int dec_ref()
     return res;
 }
 
+/**
+ * Decreases the reference count.  Deinitialized tiler if this
+ * was the last reference
+ *
+ * @author a0194118 (9/2/2009)
+ *
+ * @return 0 on success, non-0 error value on failure.
+ */
+static int dec_ref()
+{
+    return dec_ref_n(1);
+}
+
 /**
  * Returns the default page stride for this block
  *
@@ -221,30 +237,141 @@ static bytes_t map_size(bytes_t size, bytes_t offs)
     return def_stride(size + (offs & (PAGE_SIZE - 1)));
 }
 
+/**
+ * Finds the last record whose buffer starts at or before the
+ * given pointer.  The registry is sorted by start address and
+ * buffers never overlap, so this is the only record that may
+ * contain the pointer.  Must be called with che_lock held.
+ *
+ * @param ptr    Pointer
+ *
+ * @return index of the record, or -1 if no record starts at or
+ *         before ptr.
+ */
+static int buf_cache_find(void *ptr)
+{
+    int lo = 0, hi = num_bufs;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) >> 1;
+        if (bufs[mid]->buf.blocks[0].ptr <= ptr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo - 1;
+}
+
+/**
+ * Returns the record of the buffer that contains the given
+ * pointer, if the buffer type matches the type mask.  Must be
+ * called with che_lock held.
+ *
+ * @param ptr            Pointer
+ * @param buf_type_mask  Buffer types to match: BUF_ALLOCED,
+ *                       BUF_MAPPED or BUF_ANY
+ *
+ * @return pointer to the record, or NULL if not found.
+ */
+static _AllocData *buf_cache_lookup(void *ptr, int buf_type_mask)
+{
+    int ix = buf_cache_find(ptr);
+    if (ix >= 0)
+    {
+        _AllocData *ad = bufs[ix];
+        if ((ad->buf_type & buf_type_mask) &&
+            ptr < ad->buf.blocks[0].ptr + ad->buf.length)
+            return ad;
+    }
+    return NULL;
+}
+
+/**
+ * Records a number of buffer-pointer -- tiler-ID mappings for
+ * a specific buffer type.  Either all or none of the buffers
+ * are recorded.
+ *
+ * @param buf       Pointer to array of buffer info structures
+ * @param num       Number of buffers
+ * @param buf_type  Buffer type: BUF_ALLOCED or BUF_MAPPED
+ *
+ * @return 0 on success, -ENOMEM on memory allocation failure
+ */
+static int buf_cache_add_n(struct tiler_buf_info *buf, int num, int buf_type)
+{
+    int ix, ret = 0;
+    _AllocData **ads = NEWN(_AllocData *, num);
+    if (!ads) return -ENOMEM;
+
+    /* allocate the records before taking the lock */
+    for (ix = 0; ix < num; ix++)
+    {
+        ads[ix] = NEW(_AllocData);
+        if (!ads[ix])
+        {
+            ret = -ENOMEM;
+            break;
+        }
+        memcpy(&ads[ix]->buf, buf + ix, sizeof(ads[ix]->buf));
+        ads[ix]->buf_type = buf_type;
+    }
+
+    pthread_rwlock_wrlock(&che_lock);
+
+    /* grow the registry if needed */
+    if (!ret && num_bufs + num > max_bufs)
+    {
+        int new_max = ROUND_UP_TO(num_bufs + num, BUFS_GROW_BY);
+        _AllocData **new_bufs = realloc(bufs, sizeof(*bufs) * new_max);
+        if (new_bufs)
+        {
+            bufs = new_bufs;
+            max_bufs = new_max;
+        }
+        else
+        {
+            ret = -ENOMEM;
+        }
+    }
+
+    if (!ret)
+    {
+        for (ix = 0; ix < num; ix++)
+        {
+            /* insert after the last buffer that starts before this one */
+            int pos = buf_cache_find(buf[ix].blocks[0].ptr) + 1;
+            memmove(bufs + pos + 1, bufs + pos, sizeof(*bufs) * (num_bufs - pos));
+            bufs[pos] = ads[ix];
+            num_bufs++;
+        }
+    }
+    pthread_rwlock_unlock(&che_lock);
+
+    if (ret)
+    {
+        for (ix = 0; ix < num; ix++)
+        {
+            FREE(ads[ix]);
+        }
+    }
+    FREE(ads);
+    return ret;
+}
+
 /**
  * Records a buffer-pointer -- tiler-ID mapping for a specific
  * buffer type.
  *
  * @author a0194118 (9/7/2009)
  *
- * @param bufPtr    Buffer pointer
- * @param tiler_id  Tiler ID
+ * @param buf       Pointer to the buffer info
  * @param buf_type  Buffer type: BUF_ALLOCED or BUF_MAPPED
  *
  * @return 0 on success, -ENOMEM on memory allocation failure
  */
 static int buf_cache_add(struct tiler_buf_info *buf, int buf_type)
 {
-    pthread_mutex_lock(&che_mutex);
-    _AllocData *ad = NEW(_AllocData);
-    if (ad)
-    {
-        memcpy(&ad->buf, buf, sizeof(ad->buf));
-        ad->buf_type = buf_type;
-        DLIST_MADD_BEFORE(bufs, ad, link);
-    }
-    pthread_mutex_unlock(&che_mutex);
-    return ad == NULL ? -ENOMEM : 0;
+    return buf_cache_add_n(buf, 1, buf_type);
 }
 
 /**
@@ -263,26 +390,13 @@ static void buf_cache_query(void *ptr, struct tiler_buf_info *buf,
                             int buf_type_mask)
 {
     IN;
-    if(0) DP("in(p=%p,t=%d,bp*=%p)", ptr, buf_type_mask, buf->blocks[0].ptr);
-    _AllocData *ad;
-    pthread_mutex_lock(&che_mutex);
-    DLIST_MLOOP(bufs, ad, link) {
-        if(0) {
-            DP("got(%p-%p,%d)", ad->buf.blocks->ptr, ad->buf.blocks->ptr + ad->buf.length, ad->buf_type);
-            CHK_P(ad->buf.blocks->ptr,<=,ptr);
-            CHK_P(ptr,<,ad->buf.blocks->ptr + ad->buf.length);
-            CHK_I(ad->buf_type & buf_type_mask,!=,0);
-            CHK_P(buf->blocks->ptr,!=,0);
-        }
-        if ((ad->buf_type & buf_type_mask) &&
-            ad->buf.blocks->ptr <= ptr && ptr < ad->buf.blocks->ptr + ad->buf.length) {
-            memcpy(buf, &ad->buf, sizeof(*buf));
-            pthread_mutex_unlock(&che_mutex);
-            return;
-        }
-    }
-    pthread_mutex_unlock(&che_mutex);
-    ZERO(*buf);
+    pthread_rwlock_rdlock(&che_lock);
+    _AllocData *ad = buf_cache_lookup(ptr, buf_type_mask);
+    if (ad)
+        memcpy(buf, &ad->buf, sizeof(*buf));
+    else
+        ZERO(*buf);
+    pthread_rwlock_unlock(&che_lock);
     OUT;
 }
 
@@ -301,18 +415,24 @@ static void buf_cache_query(void *ptr, struct tiler_buf_info *buf,
 static void buf_cache_del(void *bufPtr, struct tiler_buf_info *buf,
                           int buf_type)
 {
-    _AllocData *ad;
-    pthread_mutex_lock(&che_mutex);
-    DLIST_MLOOP(bufs, ad, link) {
-        if (ad->buf.blocks->ptr == bufPtr && ad->buf_type == buf_type) {
-            memcpy(buf, &ad->buf, sizeof(*buf));
-            DLIST_REMOVE(ad->link);
-            FREE(ad);
-            pthread_mutex_unlock(&che_mutex);
-            return;
+    pthread_rwlock_wrlock(&che_lock);
+    int ix = buf_cache_find(bufPtr);
+    if (ix >= 0 && bufs[ix]->buf.blocks[0].ptr == bufPtr &&
+        bufs[ix]->buf_type == buf_type)
+    {
+        _AllocData *ad = bufs[ix];
+        memcpy(buf, &ad->buf, sizeof(*buf));
+        FREE(ad);
+        memmove(bufs + ix, bufs + ix + 1, sizeof(*bufs) * (num_bufs - ix - 1));
+
+        /* release the registry when the last buffer is gone */
+        if (!--num_bufs)
+        {
+            FREE(bufs);
+            max_bufs = 0;
         }
     }
-    pthread_mutex_unlock(&che_mutex);
+    pthread_rwlock_unlock(&che_lock);
     OUT;
     return;
 }
@@ -328,16 +448,10 @@ static void buf_cache_del(void *bufPtr, struct tiler_buf_info *buf,
  */
 static int cache_check()
 {
-    int num_bufs = 0;
-    pthread_mutex_lock(&che_mutex);
-
-    init();
-
-    _AllocData *ad;
-    DLIST_MLOOP(bufs, ad, link) { num_bufs++; }
-
-    pthread_mutex_unlock(&che_mutex);
-    return (num_bufs == refCnt) ? MEMMGR_ERR_NONE : MEMMGR_ERR_GENERIC;
+    pthread_rwlock_rdlock(&che_lock);
+    int ret = (num_bufs == refCnt) ? MEMMGR_ERR_NONE : MEMMGR_ERR_GENERIC;
+    pthread_rwlock_unlock(&che_lock);
+    return ret;
 }
 
 static void dump_block(struct tiler_block_info *blk, char *prefix, char *suffix)
@@ -394,30 +508,8 @@ static enum tiler_fmt tiler_get_fmt(SSPtr ssptr)
             ssptr < TILER_MEM_PAGED ? TILFMT_32BIT :
             ssptr < TILER_MEM_END   ? TILFMT_PAGE : TILFMT_NONE);
 #else
-    /* if emulating, we need to get through all allocated memory segments */
-    pthread_mutex_lock(&che_mutex);
-    init();
-    _AllocData *ad;
-    void *ptr = (void *) ssptr;
-    if (!ptr) return TILFMT_INVALID;
-    /* P("?%p", (void *)ssptr); */
-    DLIST_MLOOP(bufs, ad, link) {
-        int ix;
-        struct tiler_buf_info *buf = (struct tiler_buf_info *) ad->buf.offset;
-        /* P("buf[%d]", buf->num_blocks); */
-        for (ix = 0; ix < buf->num_blocks; ix++)
-        {
-            /* P("block[%p-%p]", buf->blocks[ix].ptr, buf->blocks[ix].ptr + def_size(buf->blocks + ix)); */
-            if (ptr >= buf->blocks[ix].ptr &&
-                ptr < buf->blocks[ix].ptr + def_size(buf->blocks + ix)) {
-                enum tiler_fmt fmt = buf->blocks[ix].fmt;
-                pthread_mutex_unlock(&che_mutex);
-                return fmt;
-            }
-        }
-    }
-    pthread_mutex_unlock(&che_mutex);
-    return TILFMT_NONE;
+    /* if emulating, only reserved container areas are tiler memory */
+    return tiler_emu_get_fmt(ssptr);
 #endif
 }
 
@@ -435,7 +527,12 @@ static int tiler_alloc(struct tiler_block_info *blk)
 {
     dump_block(blk, "=(ta)=>", "");
     blk->ptr = NULL;
+#ifndef STUB_TILER
     int ret = A_S(ioctl(td, TILIOC_GBLK, blk),==,0);
+#else
+    /* reserve container area, memory is allocated in tiler_mmap */
+    int ret = tiler_emu_alloc(blk);
+#endif
     dump_block(blk, "alloced: ", "");
     return R_I(ret);
 }
@@ -451,7 +548,11 @@ static int tiler_alloc(struct tiler_block_info *blk)
  */
 static int tiler_free(struct tiler_block_info *blk)
 {
+#ifndef STUB_TILER
     return R_I(ioctl(td, TILIOC_FBLK, blk));
+#else
+    return R_I(tiler_emu_free(blk));
+#endif
 }
 
 /**
@@ -466,7 +567,11 @@ static int tiler_free(struct tiler_block_info *blk)
 static int tiler_map(struct tiler_block_info *blk)
 {
     dump_block(blk, "=(tm)=>", "");
+#ifndef STUB_TILER
     int ret = A_S(ioctl(td, TILIOC_MBLK, blk),==,0);
+#else
+    int ret = tiler_emu_map(blk);
+#endif
     dump_block(blk, "mapped: ", "");
     return R_I(ret);
 }
@@ -482,24 +587,27 @@ static int tiler_map(struct tiler_block_info *blk)
  */
 static int tiler_unmap(struct tiler_block_info *blk)
 {
+#ifndef STUB_TILER
     return ioctl(td, TILIOC_UMBLK, blk);
+#else
+    return tiler_emu_free(blk);
+#endif
 }
 
 /**
  * Registers a buffer structure with tiler, and maps the buffer
- * into memory using tiler. On success, it writes the tiler ID
- * of the buffer into the area pointed by tiler ID.
- *
- * @author a0194118 (9/7/2009)
+ * into memory using tiler.  On success, the registered buffer
+ * information (with the block pointers filled out) is returned
+ * in buf.  The buffer is not added to the records.
  *
  * @param blks        Pointer to array of block info structures
  * @param num_blocks  Number of blocks
- * @param tiler_id      Pointer to tiler ID.
+ * @param buf         Pointer to the buffer info to fill out
  *
- * @return pointer to the mapped buffer.
+ * @return pointer to the mapped buffer, or NULL on failure.
  */
-static void *tiler_mmap(struct tiler_block_info *blks, int num_blocks,
-                        int buf_type)
+static void *tiler_mmap_buf(struct tiler_block_info *blks, int num_blocks,
+                            struct tiler_buf_info *buf)
 {
     IN;
 
@@ -508,48 +616,50 @@ static void *tiler_mmap(struct tiler_block_info *blks, int num_blocks,
     bytes_t size;
 
     /* register buffer with tiler */
-    struct tiler_buf_info buf;
-    buf.num_blocks = num_blocks;
+    buf->num_blocks = num_blocks;
     /* work on copy in buf */
-    memcpy(buf.blocks, blks, sizeof(tiler_block_info) * num_blocks);
+    memcpy(buf->blocks, blks, sizeof(tiler_block_info) * num_blocks);
 #ifndef STUB_TILER
-    dump_buf(&buf, "==(RBUF)=>");
-    int ret = ioctl(td, TILIOC_RBUF, &buf);
-    dump_buf(&buf, "<=(RBUF)==");
+    dump_buf(buf, "==(RBUF)=>");
+    int ret = ioctl(td, TILIOC_RBUF, buf);
+    dump_buf(buf, "<=(RBUF)==");
     if (NOT_I(ret,==,0)) return NULL;
-    size = buf.length;
+    size = buf->length;
 #else
     /* save buffer in stub */
     struct tiler_buf_info *buf_c = NEWN(struct tiler_buf_info,2);
-    buf.offset = (uint32_t) buf_c;
+    buf->offset = (uint32_t) buf_c;
+
+    /* buffer length is needed to look up pointers in the registry */
+    for (size = ix = 0; ix < num_blocks; ix++)
+    {
+        size += def_size(blks + ix);
+    }
+    buf->length = size;
 #endif
-    if (NOT_P(buf.offset,!=,0)) return NULL;
+    if (NOT_P(buf->offset,!=,0)) return NULL;
 
     /* map blocks to process space */
 #ifndef STUB_TILER
-    void *bufPtr = mmap(0, map_size(size, buf.offset),
+    void *bufPtr = mmap(0, map_size(size, buf->offset),
                         PROT_READ | PROT_WRITE, MAP_SHARED,
-                        td, buf.offset & ~(PAGE_SIZE - 1));
+                        td, buf->offset & ~(PAGE_SIZE - 1));
     if (bufPtr == MAP_FAILED){
         bufPtr = NULL;
     } else {
-        bufPtr += buf.offset & (PAGE_SIZE - 1);
+        bufPtr += buf->offset & (PAGE_SIZE - 1);
     }
     if(0) DP("ptr=%p", bufPtr);
 #else
+    /* keep the page offset of the first block as the driver does */
     void *bufPtr = malloc(size + PAGE_SIZE - 1);
     buf_c[1].blocks[0].ptr = bufPtr;
-    bufPtr = ROUND_UP_TO2POW(bufPtr, PAGE_SIZE);
-    /* P("<= [0x%x]", size); */
-
-    /* fill out pointers - this is needed for caching 1D/2D type */
-    for (size = ix = 0; ix < num_blocks; ix++)
+    if (bufPtr)
     {
-        buf.blocks[ix].ptr = bufPtr ? bufPtr + size : bufPtr;
-        size += def_size(blks + ix);
+        bufPtr = (void *) ROUND_UP_TO2POW((uintptr_t) bufPtr, PAGE_SIZE);
+        bufPtr += blks[0].ssptr & (PAGE_SIZE - 1);
     }
-
-    memcpy(buf_c, &buf, sizeof(struct tiler_buf_info));
+    /* P("<= [0x%x]", size); */
 #endif
 
     if (bufPtr != NULL)
@@ -557,35 +667,88 @@ static void *tiler_mmap(struct tiler_block_info *blks, int num_blocks,
         /* fill out pointers */
         for (size = ix = 0; ix < num_blocks; ix++)
         {
-            buf.blocks[ix].ptr = bufPtr + size;
-            /* P("   [0x%p]", buf.blocks[ix].ptr); */
+            buf->blocks[ix].ptr = bufPtr + size;
+            /* P("   [0x%p]", buf->blocks[ix].ptr); */
             size += def_size(blks + ix);
+            CHK_I((buf->blocks[ix].ssptr & (PAGE_SIZE - 1)),==,((uint32_t) buf->blocks[ix].ptr & (PAGE_SIZE - 1)));
+        }
 #ifdef STUB_TILER
-            buf.blocks[ix].ssptr = (uint32_t) buf.blocks[ix].ptr;
-#else
-            CHK_I((buf.blocks[ix].ssptr & (PAGE_SIZE - 1)),==,((uint32_t) buf.blocks[ix].ptr & (PAGE_SIZE - 1)));
+        memcpy(buf_c, buf, sizeof(struct tiler_buf_info));
 #endif
-        }
     }
     /* if failed to map: unregister buffer */
-    if (NOT_P(bufPtr,!=,NULL) ||
-        /* or failed to cache tiler buffer */
-        NOT_I(buf_cache_add(&buf, buf_type),==,0))
+    if (NOT_P(bufPtr,!=,NULL))
     {
 #ifndef STUB_TILER
-        A_I(ioctl(td, TILIOC_URBUF, &buf),==,0);
+        A_I(ioctl(td, TILIOC_URBUF, buf),==,0);
 #else
         FREE(buf_c);
-        buf.offset = 0;
+        buf->offset = 0;
 #endif
-    } else {
-        /* update original from local copy */
-        memcpy(blks, buf.blocks, sizeof(tiler_block_info) * num_blocks);
     }
 
     return R_P(bufPtr);
 }
 
+/**
+ * Unmaps a buffer mapped by tiler_mmap_buf from memory, and
+ * unregisters it with tiler.  The blocks of the buffer are not
+ * freed.
+ *
+ * @param buf         Pointer to the buffer info
+ * @param bufPtr      Pointer to the mapped buffer
+ */
+static void tiler_munmap_buf(struct tiler_buf_info *buf, void *bufPtr)
+{
+#ifndef STUB_TILER
+    A_I(ioctl(td, TILIOC_URBUF, buf),==,0);
+    bufPtr = (void *)((uint32_t)bufPtr & ~(PAGE_SIZE - 1));
+    A_I(munmap(bufPtr, map_size(buf->length, buf->offset)),==,0);
+#else
+    struct tiler_buf_info *buf_c = (struct tiler_buf_info *) buf->offset;
+    FREE(buf_c[1].blocks[0].ptr);
+    FREE(buf_c);
+#endif
+}
+
+/**
+ * Registers a buffer structure with tiler, and maps the buffer
+ * into memory using tiler.  On success, the buffer is added to
+ * the records, and the block info structures are updated with
+ * the block pointers.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param blks        Pointer to array of block info structures
+ * @param num_blocks  Number of blocks
+ * @param buf_type    Buffer type: BUF_ALLOCED or BUF_MAPPED
+ *
+ * @return pointer to the mapped buffer, or NULL on failure.
+ */
+static void *tiler_mmap(struct tiler_block_info *blks, int num_blocks,
+                        int buf_type)
+{
+    IN;
+    struct tiler_buf_info buf;
+
+    void *bufPtr = tiler_mmap_buf(blks, num_blocks, &buf);
+    if (bufPtr)
+    {
+        /* if failed to cache tiler buffer: unmap and unregister it */
+        if (NOT_I(buf_cache_add(&buf, buf_type),==,0))
+        {
+            tiler_munmap_buf(&buf, bufPtr);
+            bufPtr = NULL;
+        }
+        else
+        {
+            /* update original from local copy */
+            memcpy(blks, buf.blocks, sizeof(tiler_block_info) * num_blocks);
+        }
+    }
+    return R_P(bufPtr);
+}
+
 /**
  * Checks whether the tiler_block_info is filled in correctly.
  * Verifies the pixel format, correct length, width and or
@@ -790,6 +953,109 @@ DONE:
     return R_P(bufPtr);
 }
 
+int MemMgr_AllocBatch(MemAllocBlock blocks[], int num_blocks,
+                      void *bufPtrs[], int num_bufs)
+{
+    IN;
+    int ret = MEMMGR_ERR_GENERIC;
+    struct tiler_buf_info *bufs_info = NULL;
+    int ib = 0, ix = 0;
+
+    /* need to access ssptrs */
+    struct tiler_block_info *blks = (tiler_block_info *) blocks;
+
+    /* check block allocation params, and state */
+    if (NOT_P(bufPtrs,!=,NULL) || NOT_I(num_bufs,>,0) ||
+        NOT_I(check_blocks(blks, num_blocks, num_blocks - 1),==,0))
+        goto DONE;
+
+    bufs_info = NEWN(struct tiler_buf_info, num_bufs);
+    if (NOT_P(bufs_info,!=,NULL)) goto DONE;
+
+    /* take all references at once */
+    if (NOT_I(inc_ref_n(num_bufs),==,0)) goto DONE;
+
+    /* ----- begin recoverable portion ----- */
+    for (ib = 0; ib < num_bufs; ib++)
+    {
+        struct tiler_block_info *bblks = blks + ib * num_blocks;
+        bufPtrs[ib] = NULL;
+
+        /* every buffer uses the (checked) specification of the first */
+        if (ib)
+        {
+            memcpy(bblks, blks, sizeof(*blks) * num_blocks);
+            reset_blocks(bblks, num_blocks);
+        }
+
+        /* allocate each block using tiler driver */
+        for (ix = 0; ix < num_blocks; ix++)
+        {
+            if (ix)
+            {
+                /* continue offset between pages */
+                bblks[ix].align = PAGE_SIZE;
+                bblks[ix].offs = bblks[ix - 1].offs;
+            }
+            CHK_I(bblks[ix].ptr,==,NULL);
+            if (NOT_I(tiler_alloc(bblks + ix),==,0)) goto FAIL_ALLOC;
+        }
+
+        bufPtrs[ib] = tiler_mmap_buf(bblks, num_blocks, bufs_info + ib);
+        if (NOT_P(bufPtrs[ib],!=,NULL)) goto FAIL_ALLOC;
+    }
+
+    /* record all buffers with a single registry update */
+    if (NOT_I(buf_cache_add_n(bufs_info, num_bufs, BUF_ALLOCED),==,0))
+        goto FAIL_CACHE;
+
+    /* update block information from the mapped buffers */
+    for (ib = 0; ib < num_bufs; ib++)
+    {
+        memcpy(blks + ib * num_blocks, bufs_info[ib].blocks,
+               sizeof(*blks) * num_blocks);
+    }
+    ret = MEMMGR_ERR_NONE;
+    goto DONE;
+
+    /* ------ error handling ------ */
+FAIL_CACHE:
+    /* all buffers were mapped */
+    ix = num_blocks;
+    ib = num_bufs - 1;
+FAIL_ALLOC:
+    /* unwind the buffer that failed (or the last one) */
+    if (ix == num_blocks && bufPtrs[ib])
+        tiler_munmap_buf(bufs_info + ib, bufPtrs[ib]);
+    while (ix)
+    {
+        tiler_free(blks + ib * num_blocks + --ix);
+    }
+
+    /* unwind the buffers already completed */
+    while (ib--)
+    {
+        tiler_munmap_buf(bufs_info + ib, bufPtrs[ib]);
+        for (ix = 0; ix < num_blocks; ix++)
+        {
+            tiler_free(blks + ib * num_blocks + ix);
+        }
+    }
+
+    /* clear ssptr and ptr fields for all blocks, and the pointers */
+    for (ib = 0; ib < num_bufs; ib++)
+    {
+        reset_blocks(blks + ib * num_blocks, num_blocks);
+        bufPtrs[ib] = NULL;
+    }
+
+    A_I(dec_ref_n(num_bufs),==,0);
+DONE:
+    FREE(bufs_info);
+    CHK_I(cache_check(),==,0);
+    return R_I(ret);
+}
+
 int MemMgr_Free(void *bufPtr)
 {
     IN;
@@ -820,9 +1086,14 @@ int MemMgr_Free(void *bufPtr)
         bufPtr = (void *)((uint32_t)bufPtr & ~(PAGE_SIZE - 1));
         ERR_ADD(ret, munmap(bufPtr, map_size(buf.length, buf.offset)));
 #else
-        void *ptr = (void *) buf.offset;
-        FREE(ptr);
+        /* free each block, then the memory */
+        int ix;
         ret = MEMMGR_ERR_NONE;
+        for (ix = 0; ix < buf.num_blocks; ix++)
+        {
+            ERR_ADD(ret, tiler_free(buf.blocks + ix));
+        }
+        tiler_munmap_buf(&buf, bufPtr);
 #endif
         ERR_ADD(ret, dec_ref());
     }
@@ -920,10 +1191,14 @@ int MemMgr_UnMap(void *bufPtr)
         bufPtr = (void *)((uint32_t)bufPtr & ~(PAGE_SIZE - 1));
         ERR_ADD(ret, munmap(bufPtr, map_size(buf.length, buf.offset)));
 #else
-        struct tiler_buf_info *ptr = (struct tiler_buf_info *) buf.offset;
-        FREE(ptr[1].blocks[0].ptr);
-        FREE(ptr);
+        /* unmap each block, then free the copy */
+        int ix;
         ret = MEMMGR_ERR_NONE;
+        for (ix = 0; ix < buf.num_blocks; ix++)
+        {
+            ERR_ADD(ret, tiler_unmap(buf.blocks + ix));
+        }
+        tiler_munmap_buf(&buf, bufPtr);
 #endif
         ERR_ADD(ret, dec_ref());
     }
@@ -999,27 +1274,29 @@ bytes_t MemMgr_GetStride(void *ptr)
     }
     A_I(dec_ref(),==,0);
 #else
-    /* if emulating, we need to get through all allocated memory segments */
-    pthread_mutex_lock(&che_mutex);
-    init();
-
-    _AllocData *ad;
+    /* if emulating, look up the block in the buffer registry */
     if (!ptr) return R_UP(0);
-    DLIST_MLOOP(bufs, ad, link) {
+
+    pthread_rwlock_rdlock(&che_lock);
+    _AllocData *ad = buf_cache_lookup(ptr, BUF_ANY);
+    if (ad)
+    {
         int ix;
-        struct tiler_buf_info *buf = (struct tiler_buf_info *) ad->buf.offset;
-        for (ix = 0; ix < buf->num_blocks; ix++)
+        for (ix = 0; ix < ad->buf.num_blocks; ix++)
         {
-            if (ptr >= buf->blocks[ix].ptr &&
-                ptr < buf->blocks[ix].ptr + def_size(buf->blocks + ix))
+            if (ptr >= ad->buf.blocks[ix].ptr &&
+                ptr < ad->buf.blocks[ix].ptr + def_size(ad->buf.blocks + ix))
             {
-                bytes_t stride = buf->blocks[ix].stride;
-                pthread_mutex_unlock(&che_mutex);
+                bytes_t stride = ad->buf.blocks[ix].stride;
+                pthread_rwlock_unlock(&che_lock);
                 return R_UP(stride);
             }
         }
     }
-    pthread_mutex_unlock(&che_mutex);
+    pthread_rwlock_unlock(&che_lock);
+
+    /* see if pointer is valid */
+    if (TilerMem_VirtToPhys(ptr) == 0) return R_UP(0);
 #endif
     return R_UP(PAGE_SIZE);
 }
@@ -1048,10 +1325,384 @@ SSPtr TilerMem_VirtToPhys(void *ptr)
     }
     return (SSPtr)R_P(ssptr);
 #else
-    return (SSPtr)ptr;
+    /* if emulating, translate pointers into the emulated container */
+    SSPtr ssptr = 0;
+    if (!ptr) return 0;
+
+    pthread_rwlock_rdlock(&che_lock);
+    _AllocData *ad = buf_cache_lookup(ptr, BUF_ANY);
+    if (ad)
+    {
+        int ix;
+        for (ix = 0; ix < ad->buf.num_blocks; ix++)
+        {
+            tiler_block_info *blk = ad->buf.blocks + ix;
+            bytes_t size = def_size(blk);
+            if (ptr >= blk->ptr && ptr < blk->ptr + size)
+            {
+                bytes_t offs = ptr - blk->ptr;
+                if (blk->fmt == TILFMT_PAGE)
+                {
+                    ssptr = blk->ssptr + offs;
+                }
+                else
+                {
+                    /* lines are page strided in process space */
+                    bytes_t line = size / blk->dim.area.height;
+                    ssptr = blk->ssptr + offs % line +
+                            offs / line * TilerMem_GetStride(blk->ssptr);
+                }
+                break;
+            }
+        }
+    }
+    pthread_rwlock_unlock(&che_lock);
+
+    /* other memory has the same address, if it is mapped */
+    if (!ad && !msync((void *)((uintptr_t)ptr & ~(PAGE_SIZE - 1)),
+                      PAGE_SIZE, MS_ASYNC))
+    {
+        ssptr = (SSPtr)ptr;
+    }
+    return ssptr;
 #endif
 }
 
+/* buffer pool entry */
+struct _PoolBuf {
+    MemAllocBlock req[TILER_MAX_NUM_BLOCKS];  /* requested geometry */
+    MemAllocBlock blk[TILER_MAX_NUM_BLOCKS];  /* allocated blocks */
+    int       num_blocks;
+    void     *bufPtr;
+    struct _PoolList {
+        struct _PoolList *next, *last;
+        struct _PoolBuf *me;
+    } link;
+};
+
+typedef struct _PoolList _PoolList;
+typedef struct _PoolBuf _PoolBuf;
+
+struct MemMgrPool {
+    pthread_mutex_t mtx;
+    int       max_cached;
+    _PoolList cached;        /* least recently released first */
+    _PoolList in_use;
+    MemMgrPoolStats stats;
+};
+
+/**
+ * Checks whether a block specification matches the geometry a
+ * pooled buffer was allocated with.
+ *
+ * @param pb          Pointer to the pool entry
+ * @param blocks      Block specification
+ * @param num_blocks  Number of blocks
+ *
+ * @return true iff the pooled buffer can be reused for the
+ *         block specification.
+ */
+static bool pool_match(_PoolBuf *pb, MemAllocBlock blocks[], int num_blocks)
+{
+    int ix;
+    if (pb->num_blocks != num_blocks) return false;
+    for (ix = 0; ix < num_blocks; ix++)
+    {
+        MemAllocBlock *a = pb->req + ix, *b = blocks + ix;
+        /* dim.len also covers the 2D width and height */
+        if (a->pixelFormat != b->pixelFormat || a->dim.len != b->dim.len ||
+            a->stride != b->stride || a->key != b->key ||
+            a->group_id != b->group_id || a->align != b->align ||
+            a->offs != b->offs)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Frees the least recently released cached buffers of a pool
+ * until at most max_cached remain.  Must be called with the
+ * pool mutex held.
+ *
+ * @param pool        Pointer to the pool
+ * @param max_cached  Number of cached buffers to keep
+ *
+ * @return 0 on success, non-0 error value on failure.
+ */
+static int pool_trim(MemMgrPool *pool, int max_cached)
+{
+    int ret = MEMMGR_ERR_NONE;
+    while ((int) pool->stats.cached > max_cached)
+    {
+        _PoolBuf *pb = DLIST_FIRST(pool->cached);
+        DLIST_REMOVE(pb->link);
+        pool->stats.cached--;
+        pool->stats.trimmed++;
+        ERR_ADD(ret, MemMgr_Free(pb->bufPtr));
+        FREE(pb);
+    }
+    return ret;
+}
+
+MemMgrPool *MemMgr_PoolCreate(int max_cached)
+{
+    IN;
+    MemMgrPool *pool = NULL;
+    if (NOT_I(max_cached,>=,0)) return R_P(NULL);
+
+    pool = NEW(MemMgrPool);
+    if (NOT_P(pool,!=,NULL)) return R_P(NULL);
+
+    pthread_mutex_init(&pool->mtx, NULL);
+    pool->max_cached = max_cached;
+    DLIST_INIT(pool->cached);
+    DLIST_INIT(pool->in_use);
+    return R_P(pool);
+}
+
+void *MemMgr_PoolAlloc(MemMgrPool *pool, MemAllocBlock blocks[],
+                       int num_blocks)
+{
+    IN;
+    void *bufPtr = NULL;
+    _PoolBuf *pb;
+
+    if (NOT_P(pool,!=,NULL) || NOT_P(blocks,!=,NULL) ||
+        NOT_I(num_blocks,>,0) ||
+        NOT_I(num_blocks,<=,TILER_MAX_NUM_BLOCKS)) return R_P(NULL);
+
+    pthread_mutex_lock(&pool->mtx);
+
+    /* reuse the most recently released buffer of the same geometry */
+    DLIST_RMLOOP(pool->cached, pb, link) {
+        if (pool_match(pb, blocks, num_blocks))
+        {
+            DLIST_MOVE_BEFORE(pool->in_use, pb->link);
+            pool->stats.cached--;
+            pool->stats.in_use++;
+            pool->stats.hits++;
+            memcpy(blocks, pb->blk, sizeof(*blocks) * num_blocks);
+            bufPtr = pb->bufPtr;
+            goto DONE;
+        }
+    }
+
+    pb = NEW(_PoolBuf);
+    if (NOT_P(pb,!=,NULL)) goto DONE;
+    memcpy(pb->req, blocks, sizeof(*blocks) * num_blocks);
+    pb->num_blocks = num_blocks;
+
+    /* callers may pass in blocks filled out by a previous allocation */
+    reset_blocks((tiler_block_info *) blocks, num_blocks);
+    bufPtr = MemMgr_Alloc(blocks, num_blocks);
+    if (!bufPtr && pool->stats.cached)
+    {
+        /* cached buffers may be holding the space we need */
+        pool_trim(pool, 0);
+        memcpy(blocks, pb->req, sizeof(*blocks) * num_blocks);
+        reset_blocks((tiler_block_info *) blocks, num_blocks);
+        bufPtr = MemMgr_Alloc(blocks, num_blocks);
+    }
+
+    if (bufPtr)
+    {
+        memcpy(pb->blk, blocks, sizeof(*blocks) * num_blocks);
+        pb->bufPtr = bufPtr;
+        DLIST_MADD_BEFORE(pool->in_use, pb, link);
+        pool->stats.in_use++;
+        pool->stats.misses++;
+    }
+    else
+    {
+        FREE(pb);
+    }
+
+DONE:
+    pthread_mutex_unlock(&pool->mtx);
+    return R_P(bufPtr);
+}
+
+int MemMgr_PoolAllocBatch(MemMgrPool *pool, MemAllocBlock blocks[],
+                          int num_blocks, void *bufPtrs[], int num_bufs)
+{
+    IN;
+    int ret = MEMMGR_ERR_GENERIC;
+    MemAllocBlock req[TILER_MAX_NUM_BLOCKS];
+    _PoolBuf **pbs = NULL, *pb;
+    int ib, num_hits = 0;
+
+    if (NOT_P(pool,!=,NULL) || NOT_P(blocks,!=,NULL) ||
+        NOT_P(bufPtrs,!=,NULL) || NOT_I(num_bufs,>,0) ||
+        NOT_I(num_blocks,>,0) ||
+        NOT_I(num_blocks,<=,TILER_MAX_NUM_BLOCKS)) return R_I(ret);
+
+    pbs = NEWN(_PoolBuf *, num_bufs);
+    if (NOT_P(pbs,!=,NULL)) return R_I(ret);
+    memcpy(req, blocks, sizeof(*blocks) * num_blocks);
+
+    pthread_mutex_lock(&pool->mtx);
+
+    /* take the most recently released buffers of the same geometry */
+    DLIST_RMLOOP(pool->cached, pb, link) {
+        if (num_hits == num_bufs) break;
+        if (pool_match(pb, req, num_blocks))
+        {
+            pbs[num_hits++] = pb;
+        }
+    }
+
+    /* the pool entries of the buffers it cannot supply */
+    for (ib = num_hits; ib < num_bufs; ib++)
+    {
+        pbs[ib] = NEW(_PoolBuf);
+        if (NOT_P(pbs[ib],!=,NULL)) goto FAIL;
+    }
+
+    /* allocate the missing buffers in a single pass */
+    if (num_hits < num_bufs)
+    {
+        MemAllocBlock *miss = blocks + num_hits * num_blocks;
+        memcpy(miss, req, sizeof(*blocks) * num_blocks);
+        reset_blocks((tiler_block_info *) miss, num_blocks);
+        if (MemMgr_AllocBatch(miss, num_blocks, bufPtrs + num_hits,
+                              num_bufs - num_hits))
+        {
+            /* cached buffers not taken above may be holding the space */
+            if (pool->stats.cached == (uint32_t) num_hits) goto FAIL;
+            for (ib = 0; ib < num_hits; ib++)
+            {
+                DLIST_REMOVE(pbs[ib]->link);
+            }
+            pool->stats.cached -= num_hits;
+            pool_trim(pool, 0);
+            for (ib = 0; ib < num_hits; ib++)
+            {
+                DLIST_MADD_BEFORE(pool->cached, pbs[ib], link);
+            }
+            pool->stats.cached += num_hits;
+
+            memcpy(miss, req, sizeof(*blocks) * num_blocks);
+            reset_blocks((tiler_block_info *) miss, num_blocks);
+            if (MemMgr_AllocBatch(miss, num_blocks, bufPtrs + num_hits,
+                                  num_bufs - num_hits)) goto FAIL;
+        }
+    }
+
+    /* nothing can fail from here on */
+    for (ib = 0; ib < num_bufs; ib++)
+    {
+        pb = pbs[ib];
+        if (ib < num_hits)
+        {
+            DLIST_MOVE_BEFORE(pool->in_use, pb->link);
+            memcpy(blocks + ib * num_blocks, pb->blk,
+                   sizeof(*blocks) * num_blocks);
+            bufPtrs[ib] = pb->bufPtr;
+        }
+        else
+        {
+            memcpy(pb->req, req, sizeof(*blocks) * num_blocks);
+            memcpy(pb->blk, blocks + ib * num_blocks,
+                   sizeof(*blocks) * num_blocks);
+            pb->num_blocks = num_blocks;
+            pb->bufPtr = bufPtrs[ib];
+            DLIST_MADD_BEFORE(pool->in_use, pb, link);
+        }
+    }
+    pool->stats.cached -= num_hits;
+    pool->stats.in_use += num_bufs;
+    pool->stats.hits += num_hits;
+    pool->stats.misses += num_bufs - num_hits;
+    ret = MEMMGR_ERR_NONE;
+    goto DONE;
+
+FAIL:
+    /* the buffers taken from the cache were never moved out of it */
+    for (ib = num_hits; ib < num_bufs; ib++)
+    {
+        FREE(pbs[ib]);
+    }
+    for (ib = 0; ib < num_bufs; ib++)
+    {
+        bufPtrs[ib] = NULL;
+    }
+
+DONE:
+    pthread_mutex_unlock(&pool->mtx);
+    FREE(pbs);
+    return R_I(ret);
+}
+
+int MemMgr_PoolRelease(MemMgrPool *pool, void *bufPtr)
+{
+    IN;
+    int ret = MEMMGR_ERR_GENERIC;
+    _PoolBuf *pb;
+
+    if (NOT_P(pool,!=,NULL)) return R_I(ret);
+
+    pthread_mutex_lock(&pool->mtx);
+    DLIST_MLOOP(pool->in_use, pb, link) {
+        if (pb->bufPtr == bufPtr)
+        {
+            DLIST_MOVE_BEFORE(pool->cached, pb->link);
+            pool->stats.in_use--;
+            pool->stats.cached++;
+            ret = pool_trim(pool, pool->max_cached);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool->mtx);
+    return R_I(ret);
+}
+
+int MemMgr_PoolTrim(MemMgrPool *pool, int max_cached)
+{
+    IN;
+    int ret;
+
+    if (NOT_P(pool,!=,NULL) || NOT_I(max_cached,>=,0))
+        return R_I(MEMMGR_ERR_GENERIC);
+
+    pthread_mutex_lock(&pool->mtx);
+    ret = pool_trim(pool, max_cached);
+    pthread_mutex_unlock(&pool->mtx);
+    return R_I(ret);
+}
+
+int MemMgr_PoolGetStats(MemMgrPool *pool, MemMgrPoolStats *stats)
+{
+    IN;
+    if (NOT_P(pool,!=,NULL) || NOT_P(stats,!=,NULL))
+        return R_I(MEMMGR_ERR_GENERIC);
+
+    pthread_mutex_lock(&pool->mtx);
+    memcpy(stats, &pool->stats, sizeof(*stats));
+    pthread_mutex_unlock(&pool->mtx);
+    return R_I(MEMMGR_ERR_NONE);
+}
+
+int MemMgr_PoolDestroy(MemMgrPool *pool)
+{
+    IN;
+    int ret;
+    _PoolBuf *pb, *pb_safe;
+
+    if (NOT_P(pool,!=,NULL)) return R_I(MEMMGR_ERR_GENERIC);
+
+    pthread_mutex_lock(&pool->mtx);
+    ret = pool_trim(pool, 0);
+    DLIST_SAFE_MLOOP(pool->in_use, pb, pb_safe, link) {
+        ERR_ADD(ret, MemMgr_Free(pb->bufPtr));
+        FREE(pb);
+    }
+    pthread_mutex_unlock(&pool->mtx);
+
+    pthread_mutex_destroy(&pool->mtx);
+    FREE(pool);
+    return R_I(ret);
+}
+
 /**
  * Internal Unit Test.  Tests the static methods of this
  * library.  Assumes an unitialized state as well.
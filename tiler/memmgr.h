@@ -153,6 +153,33 @@ bytes_t MemMgr_PageSize();
  */
 void *MemMgr_Alloc(MemAllocBlock blocks[], int num_blocks);
 
+/**
+ * Allocates a number of identical buffers in one pass.  Each
+ * buffer is allocated as by MemMgr_Alloc(), but the buffers are
+ * registered with the memory allocator in a single update.
+ * Either all buffers are allocated, or none of them are: on
+ * any failure the buffers allocated so far are freed.
+ * <p>
+ * Each buffer can be freed using MemMgr_Free().
+ *
+ * @param blocks     Block specification information.  This
+ *                   should be an array of at least num_blocks *
+ *                   num_bufs elements.  The first num_blocks
+ *                   elements specify the buffer geometry.  On
+ *                   success, each consecutive group of
+ *                   num_blocks elements is filled out for the
+ *                   corresponding buffer as by MemMgr_Alloc().
+ * @param num_blocks Number of blocks in each buffer
+ * @param bufPtrs    Array of at least num_bufs elements that
+ *                   receives the buffer pointers.  These are
+ *                   set to NULL on failure.
+ * @param num_bufs   Number of buffers to allocate
+ *
+ * @return 0 on success.  Non-0 error value on failure.
+ */
+int MemMgr_AllocBatch(MemAllocBlock blocks[], int num_blocks,
+                      void *bufPtrs[], int num_bufs);
+
 /**
  * Frees a buffer allocated by MemMgr_Alloc(). It fails for
  * any buffer not allocated by MemMgr_Alloc() or one that has
@@ -310,4 +337,138 @@ bool MemMgr_Is2DBlock(void *ptr);
  */
 bytes_t MemMgr_GetStride(void *ptr);
 
+/**
+ * Memory Allocator buffer pool
+ *
+ * A pool keeps buffers released by its users instead of freeing
+ * them, keyed by the geometry they were allocated with.  A later
+ * allocation with the same block specification reuses a cached
+ * buffer without going through the tiler driver.  Buffers
+ * allocated from a pool must be returned to the same pool.
+ */
+typedef struct MemMgrPool MemMgrPool;
+
+/**
+ * Memory Allocator buffer pool statistics
+ */
+struct MemMgrPoolStats {
+    uint32_t hits;      /* allocations served from cached buffers */
+    uint32_t misses;    /* allocations that called MemMgr_Alloc */
+    uint32_t trimmed;   /* cached buffers freed by LRU trimming */
+    uint32_t cached;    /* buffers currently cached */
+    uint32_t in_use;    /* buffers currently handed out */
+};
+
+typedef struct MemMgrPoolStats MemMgrPoolStats;
+
+/**
+ * Creates a buffer pool.
+ *
+ * @param max_cached  High-water mark: maximum number of released
+ *                    buffers kept in the pool.  When exceeded,
+ *                    the least recently released buffers are
+ *                    freed.
+ *
+ * @return Pointer to the pool, or NULL on failure.
+ */
+MemMgrPool *MemMgr_PoolCreate(int max_cached);
+
+/**
+ * Allocates a buffer from a pool.  If the pool has a cached
+ * buffer allocated with the same block specification (pixel
+ * format, dimensions, stride, alignment and offset), it is
+ * reused.  Otherwise the buffer is allocated using
+ * MemMgr_Alloc().  If that fails, the cached buffers are freed
+ * and the allocation is retried.
+ * <p>
+ * The block specification is updated the same way as by
+ * MemMgr_Alloc().
+ *
+ * @param pool       Pointer to the pool
+ * @param blocks     Block specification information.  This
+ *                   should be an array of at least num_blocks
+ *                   elements.
+ * @param num_blocks Number of blocks
+ *
+ * @return Pointer to the buffer. NULL if allocation failed.
+ */
+void *MemMgr_PoolAlloc(MemMgrPool *pool, MemAllocBlock blocks[],
+                       int num_blocks);
+
+/**
+ * Allocates num_bufs buffers of the same geometry from a pool.
+ * The most recently released cached buffers of that geometry
+ * are reused, and the buffers the pool cannot supply are
+ * allocated in a single pass using MemMgr_AllocBatch().  If
+ * that fails, the other cached buffers are freed and the
+ * allocation is retried.
+ * <p>
+ * Either all buffers are allocated, or none of them are: on
+ * failure the reused buffers stay cached.  Each buffer is
+ * returned to the pool using MemMgr_PoolRelease().
+ *
+ * @param pool       Pointer to the pool
+ * @param blocks     Block specification information.  This
+ *                   should be an array of at least num_blocks *
+ *                   num_bufs elements.  The first num_blocks
+ *                   elements specify the buffer geometry.  On
+ *                   success the block information of buffer i is
+ *                   updated in elements i * num_blocks onward.
+ * @param num_blocks Number of blocks per buffer
+ * @param bufPtrs    Array of at least num_bufs elements that
+ *                   receives the buffer pointers
+ * @param num_bufs   Number of buffers
+ *
+ * @return 0 on success.  Non-0 error value on failure.
+ */
+int MemMgr_PoolAllocBatch(MemMgrPool *pool, MemAllocBlock blocks[],
+                          int num_blocks, void *bufPtrs[], int num_bufs);
+
+/**
+ * Returns a buffer allocated by MemMgr_PoolAlloc() or
+ * MemMgr_PoolAllocBatch() to the pool.
+ * The buffer is cached for reuse, and the pool is trimmed to
+ * its high-water mark.
+ *
+ * @param pool      Pointer to the pool
+ * @param bufPtr    Pointer to the buffer as returned by
+ *                  MemMgr_PoolAlloc()
+ *
+ * @return 0 on success.  Non-0 error value on failure, e.g. if
+ *         the buffer was not allocated from this pool.
+ */
+int MemMgr_PoolRelease(MemMgrPool *pool, void *bufPtr);
+
+/**
+ * Frees the least recently released cached buffers until at
+ * most max_cached buffers remain in the pool.  This does not
+ * change the high-water mark of the pool.
+ *
+ * @param pool        Pointer to the pool
+ * @param max_cached  Number of cached buffers to keep
+ *
+ * @return 0 on success.  Non-0 error value on failure.
+ */
+int MemMgr_PoolTrim(MemMgrPool *pool, int max_cached);
+
+/**
+ * Retrieves the hit/miss statistics of a pool.
+ *
+ * @param pool    Pointer to the pool
+ * @param stats   Pointer to the statistics to fill out
+ *
+ * @return 0 on success.  Non-0 error value on failure.
+ */
+int MemMgr_PoolGetStats(MemMgrPool *pool, MemMgrPoolStats *stats);
+
+/**
+ * Destroys a pool.  All cached buffers, as well as the buffers
+ * still handed out by the pool, are freed.
+ *
+ * @param pool    Pointer to the pool
+ *
+ * @return 0 on success.  Non-0 error value on failure.
+ */
+int MemMgr_PoolDestroy(MemMgrPool *pool);
+
 #endif
@@ -0,0 +1,458 @@
+/*
+ *  memmgr_bench.c
+ *
+ *  Memory Allocator Interface latency benchmarks.
+ *
+ *  Copyright (C) 2009-2011 Texas Instruments, Inc.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Measures the latency of MemMgr_Alloc, MemMgr_Map, MemMgr_Free,
+ * MemMgr_UnMap, TilerMem_VirtToPhys and MemMgr_GetStride over the
+ * same geometry matrix that memmgr_test exercises, and prints one
+ * CSV row per (case, operation):
+ *
+ *   case,op,iterations,p50_ns,p99_ns,max_ns,ops_per_sec
+ *
+ * The column order and the case/op names are stable so the output
+ * of different releases can be compared directly; new columns may
+ * only be appended.  Progress, errors and MemMgr debug traces go to
+ * stderr.
+ *
+ * In STUB_TILER builds "memmgr_bench -c" instead runs a random
+ * alloc/free churn of camera and video buffers on the emulated TILER
+ * container with each area allocator, and prints the resulting
+ * container occupancy and fragmentation:
+ *
+ *   allocator,ops,allocs,failed,used_slots,total_slots,num_areas,
+ *   largest_free_1d,largest_free_2d,fragmentation_pct
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+#include <utils.h>
+#include <memmgr.h>
+#include <tilermem.h>
+#include <tilermem_utils.h>
+#ifdef STUB_TILER
+#include <tiler_emu.h>
+#endif
+
+#define DEFAULT_ITERATIONS 1000
+#define DEFAULT_CHURN_OPS  10000
+#define CHURN_SLOTS        32
+
+/* CSV output */
+static FILE *csv;
+
+/* benchmarked case kinds */
+enum bench_kind {
+    BENCH_1D,       /* 1D page mode alloc */
+    BENCH_2D,       /* single 2D block alloc */
+    BENCH_NV12,     /* 8-bit Y + 16-bit UV alloc */
+    BENCH_MAP       /* 1D map of a user buffer */
+};
+
+/* timed operations, in CSV output order */
+enum bench_op {
+    OP_ALLOC,       /* MemMgr_Alloc or MemMgr_Map */
+    OP_VIRT2PHYS,   /* TilerMem_VirtToPhys */
+    OP_GETSTRIDE,   /* MemMgr_GetStride */
+    OP_FREE,        /* MemMgr_Free or MemMgr_UnMap */
+    NUM_OPS
+};
+
+struct bench_case {
+    enum bench_kind kind;
+    pixels_t width, height;
+    pixel_fmt_t fmt;
+};
+
+static const struct bench_case cases[] = {
+#define GEOMETRY(w, h) \
+    { BENCH_1D,   w, h, PIXEL_FMT_PAGE  }, \
+    { BENCH_2D,   w, h, PIXEL_FMT_8BIT  }, \
+    { BENCH_2D,   w, h, PIXEL_FMT_16BIT }, \
+    { BENCH_2D,   w, h, PIXEL_FMT_32BIT }, \
+    { BENCH_NV12, w, h, PIXEL_FMT_8BIT  }, \
+    { BENCH_MAP,  w, h, PIXEL_FMT_PAGE  },
+    GEOMETRY(176, 144)
+    GEOMETRY(640, 480)
+    GEOMETRY(848, 480)
+    GEOMETRY(1280, 720)
+    GEOMETRY(1920, 1080)
+#undef GEOMETRY
+};
+
+/**
+ * Returns the current monotonic time in nanoseconds.
+ *
+ * @return time in ns
+ */
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Returns the nearest-rank percentile of a sorted sample array.
+ *
+ * @param s    Sorted samples
+ * @param n    Number of samples (> 0)
+ * @param pct  Percentile (1-100)
+ *
+ * @return the sample at the given percentile
+ */
+static uint64_t percentile(uint64_t *s, int n, int pct)
+{
+    int rank = (n * pct + 99) / 100;
+    return s[rank > 0 ? rank - 1 : 0];
+}
+
+static const char *fmt_name(const struct bench_case *c)
+{
+    switch (c->kind)
+    {
+    case BENCH_1D:   return "page";
+    case BENCH_NV12: return "nv12";
+    case BENCH_MAP:  return "map";
+    default:
+        switch (c->fmt)
+        {
+        case PIXEL_FMT_8BIT:  return "8bit";
+        case PIXEL_FMT_16BIT: return "16bit";
+        case PIXEL_FMT_32BIT: return "32bit";
+        default:              return "unknown";
+        }
+    }
+}
+
+static const char *op_name(const struct bench_case *c, enum bench_op op)
+{
+    switch (op)
+    {
+    case OP_ALLOC:     return c->kind == BENCH_MAP ? "map" : "alloc";
+    case OP_VIRT2PHYS: return "virt2phys";
+    case OP_GETSTRIDE: return "get_stride";
+    default:           return c->kind == BENCH_MAP ? "unmap" : "free";
+    }
+}
+
+/**
+ * Fills in the allocation request for a benchmark case.
+ *
+ * @param c       Benchmark case
+ * @param blocks  Block array (2 entries) to fill
+ * @param data    Page aligned user buffer for map cases
+ *
+ * @return number of blocks in the request
+ */
+static int setup_blocks(const struct bench_case *c, MemAllocBlock *blocks,
+                        void *data)
+{
+    memset(blocks, 0, 2 * sizeof(*blocks));
+
+    switch (c->kind)
+    {
+    case BENCH_NV12:
+        blocks[0].pixelFormat = PIXEL_FMT_8BIT;
+        blocks[0].dim.area.width  = c->width;
+        blocks[0].dim.area.height = c->height;
+        blocks[1].pixelFormat = PIXEL_FMT_16BIT;
+        blocks[1].dim.area.width  = c->width >> 1;
+        blocks[1].dim.area.height = c->height >> 1;
+        return 2;
+    case BENCH_2D:
+        blocks[0].pixelFormat = c->fmt;
+        blocks[0].dim.area.width  = c->width;
+        blocks[0].dim.area.height = c->height;
+        return 1;
+    case BENCH_MAP:
+        blocks[0].ptr = data;
+        /* fall through */
+    default:
+        blocks[0].pixelFormat = PIXEL_FMT_PAGE;
+        blocks[0].dim.len = ROUND_UP_TO2POW(c->width * c->height * 2, PAGE_SIZE);
+        return 1;
+    }
+}
+
+/**
+ * Runs one benchmark case for the given number of iterations
+ * and prints its CSV rows.  Each iteration allocates (or maps)
+ * one buffer, queries it and frees (or unmaps) it, so only a
+ * single buffer is live at a time.
+ *
+ * @param c           Benchmark case
+ * @param iterations  Number of iterations
+ * @param samples     Scratch sample array (NUM_OPS * iterations)
+ *
+ * @return 0 on success, non-0 error value on failure
+ */
+static int run_case(const struct bench_case *c, int iterations,
+                    uint64_t *samples)
+{
+    MemAllocBlock blocks[2];
+    void *buffer = NULL, *data = NULL;
+    uint64_t total[NUM_OPS];
+    int i, op, res = 0;
+
+    if (c->kind == BENCH_MAP)
+    {
+        bytes_t length = ROUND_UP_TO2POW(c->width * c->height * 2, PAGE_SIZE);
+        buffer = malloc(length + PAGE_SIZE - 1);
+        if (!buffer) return MEMMGR_ERR_GENERIC;
+        data = (void *) ROUND_UP_TO2POW((uintptr_t) buffer, PAGE_SIZE);
+    }
+
+    for (i = 0; i < iterations && !res; i++)
+    {
+        int num_blocks = setup_blocks(c, blocks, data);
+        uint64_t t0, t1, t2, t3, t4;
+        void *bufPtr;
+        SSPtr ssptr;
+        bytes_t stride;
+
+        t0 = now_ns();
+        bufPtr = c->kind == BENCH_MAP ? MemMgr_Map(blocks, num_blocks) :
+                                        MemMgr_Alloc(blocks, num_blocks);
+        t1 = now_ns();
+        if (!bufPtr)
+        {
+            fprintf(stderr, "%ux%u %s: allocation failed at iteration %d\n",
+                    c->width, c->height, fmt_name(c), i);
+            res = MEMMGR_ERR_GENERIC;
+            break;
+        }
+
+        ssptr = TilerMem_VirtToPhys(bufPtr);
+        t2 = now_ns();
+        stride = MemMgr_GetStride(bufPtr);
+        t3 = now_ns();
+
+        if (!ssptr || stride != blocks[0].stride)
+        {
+            fprintf(stderr, "%ux%u %s: invalid ssptr/stride (%x/%u)\n",
+                    c->width, c->height, fmt_name(c), ssptr, stride);
+            res = MEMMGR_ERR_GENERIC;
+        }
+
+        if (c->kind == BENCH_MAP)
+            res |= MemMgr_UnMap(bufPtr);
+        else
+            res |= MemMgr_Free(bufPtr);
+        t4 = now_ns();
+
+        samples[OP_ALLOC * iterations + i]     = t1 - t0;
+        samples[OP_VIRT2PHYS * iterations + i] = t2 - t1;
+        samples[OP_GETSTRIDE * iterations + i] = t3 - t2;
+        samples[OP_FREE * iterations + i]      = t4 - t3;
+    }
+    FREE(buffer);
+    if (res) return res;
+
+    for (op = 0; op < NUM_OPS; op++)
+    {
+        uint64_t *s = samples + op * iterations;
+
+        total[op] = 0;
+        for (i = 0; i < iterations; i++) total[op] += s[i];
+        qsort(s, iterations, sizeof(*s), cmp_u64);
+
+        fprintf(csv, "%ux%u_%s,%s,%d,%llu,%llu,%llu,%.0f\n",
+               c->width, c->height, fmt_name(c), op_name(c, op), iterations,
+               (unsigned long long) percentile(s, iterations, 50),
+               (unsigned long long) percentile(s, iterations, 99),
+               (unsigned long long) s[iterations - 1],
+               total[op] ? iterations * 1e9 / total[op] : 0.);
+    }
+    return 0;
+}
+
+#ifdef STUB_TILER
+/* churn workload: a mix of capture, preview, decode and bitstream buffers */
+static const struct bench_case churn_cases[] = {
+    { BENCH_NV12, 1920, 1080, PIXEL_FMT_8BIT  },    /* 1080p decode */
+    { BENCH_NV12, 1280, 720,  PIXEL_FMT_8BIT  },    /* 720p preview */
+    { BENCH_NV12, 640,  480,  PIXEL_FMT_8BIT  },    /* VGA preview */
+    { BENCH_2D,   3264, 2448, PIXEL_FMT_16BIT },    /* 8MP YUV422 capture */
+    { BENCH_2D,   1920, 1080, PIXEL_FMT_32BIT },    /* ARGB overlay */
+    { BENCH_1D,   1024, 1024, PIXEL_FMT_PAGE  },    /* 2MB bitstream */
+};
+
+/**
+ * Runs a random alloc/free churn on the emulated container with
+ * the given area allocator, and prints the container state at
+ * the end.  The random sequence is the same for each allocator.
+ *
+ * @param allocator  Area allocator
+ * @param ops        Number of alloc/free operations
+ *
+ * @return 0 on success, non-0 error value on failure
+ */
+static int run_churn(const struct tiler_emu_allocator *allocator, int ops)
+{
+    void *bufs[CHURN_SLOTS];
+    MemAllocBlock blocks[2];
+    struct tiler_emu_stats stats;
+    int i, allocs = 0, failed = 0, res = 0;
+
+    if (tiler_emu_set_allocator(allocator))
+    {
+        fprintf(stderr, "could not select %s allocator\n", allocator->name);
+        return MEMMGR_ERR_GENERIC;
+    }
+
+    memset(bufs, 0, sizeof(bufs));
+    srand(0x1234);
+    for (i = 0; i < ops; i++)
+    {
+        int slot = rand() % CHURN_SLOTS;
+        if (bufs[slot])
+        {
+            res |= MemMgr_Free(bufs[slot]);
+            bufs[slot] = NULL;
+        }
+        else
+        {
+            const struct bench_case *c =
+                churn_cases + rand() % (sizeof(churn_cases) / sizeof(*churn_cases));
+            int num_blocks = setup_blocks(c, blocks, NULL);
+            bufs[slot] = MemMgr_Alloc(blocks, num_blocks);
+            if (bufs[slot]) allocs++; else failed++;
+        }
+    }
+
+    tiler_emu_get_stats(&stats);
+    fprintf(csv, "%s,%d,%d,%d,%u,%u,%u,%u,%u,%u\n", stats.allocator, ops,
+            allocs, failed, stats.used_slots, stats.total_slots,
+            stats.num_areas, stats.largest_free_1d, stats.largest_free_2d,
+            stats.fragmentation);
+
+    for (i = 0; i < CHURN_SLOTS; i++)
+    {
+        if (bufs[i]) res |= MemMgr_Free(bufs[i]);
+    }
+    return res;
+}
+#endif
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [iterations]\n"
+            "       %s -c [ops]\n\n"
+            "Prints per-operation p50/p99/max latency (ns) and throughput "
+            "(ops/s) as CSV.\nDefault is %d iterations per case.\n\n"
+            "With -c, runs %d (default) random allocs/frees on the emulated "
+            "container\nwith each area allocator and prints occupancy and "
+            "fragmentation as CSV.\nThis is only available in STUB_TILER "
+            "builds.\n",
+            name, name, DEFAULT_ITERATIONS, DEFAULT_CHURN_OPS);
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = DEFAULT_ITERATIONS, failed = 0;
+    uint64_t *samples;
+    unsigned int ix;
+
+    /* MemMgr traces go to stdout: keep them out of the CSV */
+    csv = fdopen(dup(STDOUT_FILENO), "w");
+    if (!csv || dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+    {
+        perror("could not redirect stdout");
+        return 1;
+    }
+
+    if (argc > 1 && !strcmp(argv[1], "-c"))
+    {
+        int ops = DEFAULT_CHURN_OPS;
+        if (argc > 3 || (argc == 3 && (ops = atoi(argv[2])) <= 0))
+        {
+            usage(argv[0]);
+            return 1;
+        }
+#ifdef STUB_TILER
+        fprintf(csv, "allocator,ops,allocs,failed,used_slots,total_slots,"
+                "num_areas,largest_free_1d,largest_free_2d,fragmentation_pct\n");
+        failed += run_churn(&tiler_emu_first_fit, ops) != 0;
+        failed += run_churn(&tiler_emu_split_fit, ops) != 0;
+        fclose(csv);
+        return failed;
+#else
+        fprintf(stderr, "container churn needs a STUB_TILER build\n");
+        return 1;
+#endif
+    }
+
+    if (argc > 2 || (argc == 2 && (iterations = atoi(argv[1])) <= 0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    samples = NEWN(uint64_t, NUM_OPS * iterations);
+    if (!samples)
+    {
+        fprintf(stderr, "could not allocate %d samples\n", NUM_OPS * iterations);
+        return 1;
+    }
+
+    fprintf(csv, "case,op,iterations,p50_ns,p99_ns,max_ns,ops_per_sec\n");
+    for (ix = 0; ix < sizeof(cases) / sizeof(*cases); ix++)
+    {
+        if (run_case(cases + ix, iterations, samples))
+        {
+            fprintf(stderr, "case %ux%u_%s FAILED\n", cases[ix].width,
+                    cases[ix].height, fmt_name(cases + ix));
+            failed++;
+        }
+    }
+
+    FREE(samples);
+    fclose(csv);
+    return failed;
+}
@@ -46,6 +46,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
 
 #ifdef HAVE_CONFIG_H
     #include "config.h"
@@ -57,6 +58,9 @@
 #include <tilermem.h>
 #include <tilermem_utils.h>
 #include <testlib.h>
+#ifdef STUB_TILER
+#include <tiler_emu.h>
+#endif
 
 /* for star_tiler_test */
 #include <fcntl.h>     /* open() */
@@ -172,6 +176,15 @@
     T(star_tiler_test(1000, 30))\
     T(star_test(100, 10))\
     T(star_test(1000, 10))\
+    T(lookup_perf_test(4096, MAX_ALLOCS))\
+    T(pool_test(176, 144))\
+    T(pool_test(1920, 1080))\
+    T(pool_batch_test(176, 144, 2))\
+    T(pool_batch_test(640, 480, 6))\
+    T(alloc_batch_test(176, 144, 1))\
+    T(alloc_batch_test(640, 480, 8))\
+    T(alloc_batch_test(1920, 1080, 4))\
+    T(container_test(1920, 1080))\
 
 /* this is defined in memmgr.c, but not exported as it is for internal
    use only */
@@ -853,7 +866,7 @@ int map_1D_test(bytes_t length, bytes_t stride)
 #ifdef __MAP_OK__
     /* allocate aligned buffer */
     void *buffer = malloc(length + PAGE_SIZE - 1);
-    void *dataPtr = (void *)(((uint32_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
+    void *dataPtr = (void *)(((uintptr_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
     uint16_t val = (uint16_t) rand();
     void *ptr = map_1D(dataPtr, length, stride, val);
     if (!ptr) return 1;
@@ -1035,7 +1048,7 @@ int maxmap_1D_test(bytes_t length, int max_maps)
         if (ptr)
         {
             void *buffer = ptr;
-            void *dataPtr = (void *)(((uint32_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
+            void *dataPtr = (void *)(((uintptr_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
             uint16_t val = (uint16_t) rand();
             ptr = map_1D(dataPtr, length, 0, val);
             if (ptr)
@@ -1067,6 +1080,419 @@ int maxmap_1D_test(bytes_t length, int max_maps)
     return res;
 }
 
+/**
+ * This method tests the batched allocation of a number of NV12
+ * tiled buffers.  It verifies that each buffer of the batch is
+ * registered and has its block information filled out as by
+ * MemMgr_Alloc, that the buffers do not overlap, and that each
+ * can be freed individually.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param width     Buffer width
+ * @param height    Buffer height
+ * @param num_bufs  Number of buffers in the batch
+ *
+ * @return 0 on success, non-0 error value on failure
+ */
+int alloc_batch_test(pixels_t width, pixels_t height, int num_bufs)
+{
+    printf("Allocate & Free a batch of %d %ux%u NV12 buffers\n", num_bufs,
+           width, height);
+
+    MemAllocBlock *blocks = NEWN(MemAllocBlock, 2 * num_bufs);
+    void **bufPtrs = NEWN(void *, num_bufs);
+    int ret = 0, ix;
+    if (NOT_P(blocks,!=,NULL) || NOT_P(bufPtrs,!=,NULL))
+    {
+        FREE(blocks);
+        FREE(bufPtrs);
+        return MEMMGR_ERR_GENERIC;
+    }
+
+    blocks[0].pixelFormat = PIXEL_FMT_8BIT;
+    blocks[0].dim.area.width  = width;
+    blocks[0].dim.area.height = height;
+    blocks[1].pixelFormat = PIXEL_FMT_16BIT;
+    blocks[1].dim.area.width  = width >> 1;
+    blocks[1].dim.area.height = height >> 1;
+
+    /* negative cases */
+    ret |= NOT_I(MemMgr_AllocBatch(blocks, 2, bufPtrs, 0),!=,0);
+    ret |= NOT_I(MemMgr_AllocBatch(blocks, 2, NULL, num_bufs),!=,0);
+
+    ret |= NOT_I(MemMgr_AllocBatch(blocks, 2, bufPtrs, num_bufs),==,0);
+    for (ix = 0; !ret && ix < num_bufs; ix++)
+    {
+        MemAllocBlock *blk = blocks + 2 * ix;
+        void *buf2 = bufPtrs[ix] + blk[0].stride * height;
+        if (NOT_P(bufPtrs[ix],!=,NULL) ||
+            NOT_P(blk[0].ptr,==,bufPtrs[ix]) ||
+            NOT_P(blk[1].ptr,==,buf2) ||
+            NOT_I(MemMgr_Is2DBlock(bufPtrs[ix]),!=,0) ||
+            NOT_I(MemMgr_Is2DBlock(buf2),!=,0) ||
+            NOT_I(MemMgr_GetStride(bufPtrs[ix]),==,blk[0].stride) ||
+            NOT_I(MemMgr_GetStride(buf2),==,blk[1].stride) ||
+            NOT_P(TilerMem_VirtToPhys(bufPtrs[ix]),==,blk[0].reserved) ||
+            (ix && NOT_P(bufPtrs[ix],!=,bufPtrs[ix - 1])))
+        {
+            P("  for buffer %d", ix);
+            ret = MEMMGR_ERR_GENERIC;
+        }
+    }
+
+    /* fill all buffers first, so overlaps are detected */
+    for (ix = 0; !ret && ix < num_bufs; ix++)
+    {
+        fill_mem((uint16_t) ix, blocks + 2 * ix);
+        fill_mem((uint16_t) ix, blocks + 2 * ix + 1);
+    }
+    for (ix = 0; !ret && ix < num_bufs; ix++)
+    {
+        ERR_ADD(ret, check_mem((uint16_t) ix, blocks + 2 * ix));
+        ERR_ADD(ret, check_mem((uint16_t) ix, blocks + 2 * ix + 1));
+    }
+
+    for (ix = 0; ix < num_bufs; ix++)
+    {
+        if (bufPtrs[ix])
+            ERR_ADD(ret, MemMgr_Free(bufPtrs[ix]));
+    }
+
+    FREE(blocks);
+    FREE(bufPtrs);
+    return ret;
+}
+
+/**
+ * This method tests the buffer pool.  It allocates NV12 buffers
+ * of two geometries from a pool, releases and reallocates them,
+ * and verifies that buffers of the same geometry are reused,
+ * different geometries are not mixed up, and that the pool is
+ * trimmed to its high-water mark in LRU order.  The hit/miss
+ * statistics are checked along the way.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param width    Buffer width
+ * @param height   Buffer height
+ *
+ * @return 0 on success, non-0 error value on failure
+ */
+int pool_test(pixels_t width, pixels_t height)
+{
+    printf("Pool of %ux%u and %ux%u NV12 buffers\n", width, height,
+           width >> 1, height >> 1);
+
+    MemAllocBlock blocks[2], saved[2];
+    MemMgrPoolStats stats;
+    void *a, *b, *c, *d;
+    int ret = 0;
+
+    MemMgrPool *pool = MemMgr_PoolCreate(2);
+    if (NOT_P(pool,!=,NULL)) return MEMMGR_ERR_GENERIC;
+
+    ZERO(blocks);
+    blocks[0].pixelFormat = PIXEL_FMT_8BIT;
+    blocks[0].dim.area.width  = width;
+    blocks[0].dim.area.height = height;
+    blocks[1].pixelFormat = PIXEL_FMT_16BIT;
+    blocks[1].dim.area.width  = width >> 1;
+    blocks[1].dim.area.height = height >> 1;
+    memcpy(saved, blocks, sizeof(saved));
+
+    /* two misses for the same geometry */
+    a = MemMgr_PoolAlloc(pool, blocks, 2);
+    memcpy(blocks, saved, sizeof(saved));
+    b = MemMgr_PoolAlloc(pool, blocks, 2);
+    ret |= NOT_P(a,!=,NULL) || NOT_P(b,!=,NULL) || NOT_P(a,!=,b);
+
+    /* a released buffer is reused, and the blocks are filled out */
+    ret |= NOT_I(MemMgr_PoolRelease(pool, a),==,0);
+    memcpy(blocks, saved, sizeof(saved));
+    c = MemMgr_PoolAlloc(pool, blocks, 2);
+    ret |= NOT_P(c,==,a) || NOT_P(blocks[0].ptr,==,a) ||
+           NOT_I(blocks[0].stride,!=,0) ||
+           NOT_I(MemMgr_GetStride(c),==,blocks[0].stride);
+
+    /* a different geometry is a miss */
+    blocks[0].dim.area.width = blocks[1].dim.area.width = width >> 1;
+    blocks[0].dim.area.height = blocks[1].dim.area.height = height >> 1;
+    d = MemMgr_PoolAlloc(pool, blocks, 2);
+    ret |= NOT_P(d,!=,NULL) || NOT_P(d,!=,a) || NOT_P(d,!=,b);
+
+    /* releasing 3 buffers trims the least recently released one */
+    ret |= NOT_I(MemMgr_PoolRelease(pool, b),==,0);
+    ret |= NOT_I(MemMgr_PoolRelease(pool, c),==,0);
+    ret |= NOT_I(MemMgr_PoolRelease(pool, d),==,0);
+    ret |= NOT_I(MemMgr_IsMapped(b),==,0);
+    ret |= NOT_I(MemMgr_IsMapped(c),!=,0);
+
+    /* releasing twice or a foreign buffer fails */
+    ret |= NOT_I(MemMgr_PoolRelease(pool, d),!=,0);
+    ret |= NOT_I(MemMgr_PoolRelease(pool, NULL),!=,0);
+
+    ret |= NOT_I(MemMgr_PoolGetStats(pool, &stats),==,0);
+    ret |= NOT_I(stats.hits,==,1) || NOT_I(stats.misses,==,3) ||
+           NOT_I(stats.trimmed,==,1) || NOT_I(stats.cached,==,2) ||
+           NOT_I(stats.in_use,==,0);
+
+    ret |= NOT_I(MemMgr_PoolTrim(pool, 0),==,0);
+    ret |= NOT_I(MemMgr_IsMapped(c),==,0);
+    ret |= NOT_I(MemMgr_PoolDestroy(pool),==,0);
+    return ret;
+}
+
+/**
+ * This method tests batched allocation from the buffer pool.
+ * It caches two NV12 buffers in a pool, then allocates num_bufs
+ * buffers of the same geometry in one call, and verifies that
+ * the cached buffers are reused, the rest are allocated, the
+ * blocks are filled out for each buffer, and that all of them
+ * can be released to the pool.
+ *
+ * @param width    Buffer width
+ * @param height   Buffer height
+ * @param num_bufs Number of buffers, at least 2
+ *
+ * @return 0 on success, non-0 error value on failure
+ */
+int pool_batch_test(pixels_t width, pixels_t height, int num_bufs)
+{
+    printf("Pool batch of %d %ux%u NV12 buffers\n", num_bufs, width, height);
+
+    MemAllocBlock *blocks, saved[2];
+    MemMgrPoolStats stats;
+    void **bufPtrs, *a, *b;
+    int ret = 0, ib, found = 0;
+
+    MemMgrPool *pool = MemMgr_PoolCreate(num_bufs);
+    if (NOT_P(pool,!=,NULL)) return MEMMGR_ERR_GENERIC;
+
+    blocks = NEWN(MemAllocBlock, 2 * num_bufs);
+    bufPtrs = NEWN(void *, num_bufs);
+    if (NOT_P(blocks,!=,NULL) || NOT_P(bufPtrs,!=,NULL))
+    {
+        ret = MEMMGR_ERR_GENERIC;
+        goto DONE;
+    }
+
+    blocks[0].pixelFormat = PIXEL_FMT_8BIT;
+    blocks[0].dim.area.width  = width;
+    blocks[0].dim.area.height = height;
+    blocks[1].pixelFormat = PIXEL_FMT_16BIT;
+    blocks[1].dim.area.width  = width >> 1;
+    blocks[1].dim.area.height = height >> 1;
+    memcpy(saved, blocks, sizeof(saved));
+
+    /* cache two buffers */
+    a = MemMgr_PoolAlloc(pool, blocks, 2);
+    memcpy(blocks, saved, sizeof(saved));
+    b = MemMgr_PoolAlloc(pool, blocks, 2);
+    ret |= NOT_P(a,!=,NULL) || NOT_P(b,!=,NULL);
+    ret |= NOT_I(MemMgr_PoolRelease(pool, a),==,0);
+    ret |= NOT_I(MemMgr_PoolRelease(pool, b),==,0);
+
+    /* invalid parameters */
+    memcpy(blocks, saved, sizeof(saved));
+    ret |= NOT_I(MemMgr_PoolAllocBatch(NULL, blocks, 2, bufPtrs, num_bufs),!=,0);
+    ret |= NOT_I(MemMgr_PoolAllocBatch(pool, blocks, 2, bufPtrs, 0),!=,0);
+    ret |= NOT_I(MemMgr_PoolAllocBatch(pool, blocks, 2, NULL, num_bufs),!=,0);
+
+    /* the cached buffers are reused, the rest are allocated */
+    memcpy(blocks, saved, sizeof(saved));
+    ret |= NOT_I(MemMgr_PoolAllocBatch(pool, blocks, 2, bufPtrs, num_bufs),==,0);
+    for (ib = 0; ib < num_bufs; ib++)
+    {
+        found += (bufPtrs[ib] == a) + (bufPtrs[ib] == b);
+        ret |= NOT_P(bufPtrs[ib],!=,NULL) ||
+               NOT_P(blocks[2 * ib].ptr,==,bufPtrs[ib]) ||
+               NOT_I(MemMgr_IsMapped(bufPtrs[ib]),!=,0) ||
+               NOT_I(MemMgr_GetStride(bufPtrs[ib]),==,blocks[2 * ib].stride);
+    }
+    ret |= NOT_I(found,==,2);
+
+    for (ib = 0; ib < num_bufs; ib++)
+    {
+        ret |= NOT_I(MemMgr_PoolRelease(pool, bufPtrs[ib]),==,0);
+    }
+
+    ret |= NOT_I(MemMgr_PoolGetStats(pool, &stats),==,0);
+    ret |= NOT_I(stats.hits,==,2) || NOT_I(stats.misses,==,num_bufs) ||
+           NOT_I(stats.trimmed,==,0) || NOT_I(stats.cached,==,num_bufs) ||
+           NOT_I(stats.in_use,==,0);
+
+DONE:
+    ret |= NOT_I(MemMgr_PoolDestroy(pool),==,0);
+    FREE(blocks);
+    FREE(bufPtrs);
+    return ret;
+}
+
+/**
+ * This method tests the emulated TILER container.  It fills the
+ * container with NV12 buffers of the given size, and verifies
+ * that allocations eventually fail, that the occupancy reported
+ * for each view matches the slot geometry of the buffers, and
+ * that all slots are released when the buffers are freed.  It
+ * also checks that the area allocator can only be changed while
+ * the container is empty.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param width    Buffer width
+ * @param height   Buffer height
+ *
+ * @return 0 on success, non-0 error value on failure
+ */
+int container_test(pixels_t width, pixels_t height)
+{
+    printf("Fill emulated container with %ux%u NV12 buffers\n", width, height);
+
+#ifdef STUB_TILER
+    struct tiler_emu_stats stats;
+    void *bufs[MAX_ALLOCS];
+    int n = 0, res = 0;
+
+    /* 8-bit slots are 64x64 pixels, 16-bit slots are 64x32 pixels */
+    uint32_t y_slots  = ((width + 63) / 64) * ((height + 63) / 64);
+    uint32_t uv_slots = ((width / 2 * 2 + 127) / 128) * ((height / 2 + 31) / 32);
+
+    tiler_emu_get_stats(&stats);
+    if (NOT_I(stats.used_slots,==,0) ||
+        NOT_I(stats.total_slots,==,TILER_WIDTH * TILER_HEIGHT))
+        return MEMMGR_ERR_GENERIC;
+
+    while (n < MAX_ALLOCS && (bufs[n] = alloc_NV12(width, height, n)) != NULL)
+        n++;
+
+    tiler_emu_get_stats(&stats);
+    P(":: %d buffers, %u/%u slots used, %u%% fragmented", n,
+      stats.used_slots, stats.total_slots, stats.fragmentation);
+    ERR_ADD(res, NOT_I(n,>,0));
+    ERR_ADD(res, NOT_I(n,<,MAX_ALLOCS));
+    ERR_ADD(res, NOT_I(stats.num_areas,==,2 * n));
+    ERR_ADD(res, NOT_I(stats.used_by_fmt[TILFMT_8BIT],==,n * y_slots));
+    ERR_ADD(res, NOT_I(stats.used_by_fmt[TILFMT_16BIT],==,n * uv_slots));
+    ERR_ADD(res, NOT_I(stats.largest_free_2d,<=,stats.total_slots - stats.used_slots));
+
+    /* allocator cannot be changed while the container is in use */
+    ERR_ADD(res, NOT_I(tiler_emu_set_allocator(&tiler_emu_first_fit),!=,0));
+
+    while (n--)
+    {
+        ERR_ADD(res, free_NV12(width, height, n, bufs[n]));
+    }
+
+    tiler_emu_get_stats(&stats);
+    ERR_ADD(res, NOT_I(stats.used_slots,==,0));
+    ERR_ADD(res, NOT_I(stats.num_areas,==,0));
+    ERR_ADD(res, NOT_I(stats.largest_free_2d,==,stats.total_slots));
+    ERR_ADD(res, NOT_I(stats.fragmentation,==,0));
+
+    /* first-fit places 1D blocks at the start of the container */
+    ERR_ADD(res, NOT_I(tiler_emu_set_allocator(&tiler_emu_first_fit),==,0));
+    void *ptr = alloc_1D(PAGE_SIZE, 0, 0);
+    ERR_ADD(res, NOT_P(TilerMem_VirtToPhys(ptr),==,TILER_MEM_PAGED));
+    ERR_ADD(res, free_1D(PAGE_SIZE, 0, 0, ptr));
+    ERR_ADD(res, NOT_I(tiler_emu_set_allocator(&tiler_emu_split_fit),==,0));
+
+    return res;
+#else
+    return TESTERR_NOTIMPLEMENTED;
+#endif
+}
+
+/**
+ * Returns the current monotonic time in nanoseconds.
+ *
+ * @return time in ns
+ */
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+#define LOOKUP_ROUNDS 100000
+
+/**
+ * This microbenchmark measures the cost of buffer lookups
+ * against the number of live buffers.  It keeps doubling the
+ * number of allocated 1D buffers up to max_allocs, and at each
+ * step times LOOKUP_ROUNDS MemMgr_GetStride and MemMgr_IsMapped
+ * calls on pointers inside randomly selected buffers.  The
+ * lookup cost should stay (close to) flat as buffers are added.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param length      Buffer length
+ * @param max_allocs  Maximum number of live buffers
+ *
+ * @return 0 on success, non-0 error value on failure
+ */
+int lookup_perf_test(bytes_t length, int max_allocs)
+{
+    printf("Lookup cost vs. # of live %ub 1D buffers\n", length);
+
+    struct data {
+        uint16_t val;
+        void    *bufPtr;
+        bytes_t  stride;
+    } *mem;
+
+    mem = NEWN(struct data, max_allocs);
+    if (NOT_P(mem,!=,NULL)) return MEMMGR_ERR_GENERIC;
+
+    int ix = 0, n, i, res = 0;
+    srand(0x1234);
+    for (n = 1; n <= max_allocs && !res; n <<= 1)
+    {
+        /* grow the number of live buffers to n */
+        while (ix < n)
+        {
+            uint16_t val = (uint16_t) rand();
+            void *ptr = alloc_1D(length, 0, val);
+            if (!ptr) break;
+            mem[ix].val = val;
+            mem[ix].bufPtr = ptr;
+            mem[ix].stride = MemMgr_GetStride(ptr);
+            ix++;
+        }
+        if (ix < n) break;
+
+        uint64_t start = now_ns();
+        for (i = 0; i < LOOKUP_ROUNDS; i++)
+        {
+            struct data *d = mem + rand() % ix;
+            ERR_ADD(res, NOT_I(MemMgr_GetStride(d->bufPtr + rand() % length),==,d->stride));
+        }
+        uint64_t t_stride = now_ns() - start;
+
+        start = now_ns();
+        for (i = 0; i < LOOKUP_ROUNDS; i++)
+        {
+            void *ptr = mem[rand() % ix].bufPtr + (rand() % length);
+            ERR_ADD(res, NOT_I(MemMgr_IsMapped(ptr),!=,0));
+        }
+        uint64_t t_mapped = now_ns() - start;
+
+        printf("%5d buffers: GetStride %6u ns, IsMapped %6u ns per lookup\n",
+               ix, (uint32_t) (t_stride / LOOKUP_ROUNDS),
+               (uint32_t) (t_mapped / LOOKUP_ROUNDS));
+    }
+
+    P(":: Allocated %d buffers", ix);
+
+    while (ix--)
+    {
+        ERR_ADD(res, free_1D(length, 0, mem[ix].val, mem[ix].bufPtr));
+    }
+    FREE(mem);
+    return res;
+}
+
 /**
  * This stress tests allocates/maps/frees/unmaps buffers at
  * least num_ops times.  The test maintains a set of slots that
@@ -1161,7 +1587,7 @@ int star_test(uint32_t num_ops, uint16_t num_slots)
                 mem[ix].buffer = malloc(mem[ix].length + PAGE_SIZE - 1);
                 if (mem[ix].buffer)
                 {
-                    mem[ix].dataPtr = (void *)(((uint32_t)mem[ix].buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
+                    mem[ix].dataPtr = (void *)(((uintptr_t)mem[ix].buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
                     mem[ix].bufPtr = map_1D(mem[ix].dataPtr, mem[ix].length, 0, mem[ix].val);
                     if (!mem[ix].bufPtr) FREE(mem[ix].buffer);
                 }
@@ -1344,7 +1770,7 @@ int star_tiler_test(uint32_t num_ops, uint16_t num_slots)
                 {
                     mem[ix].blk.dim.len = length;
                     mem[ix].blk.fmt = TILFMT_PAGE;
-                    mem[ix].blk.ptr = (void *)(((uint32_t)mem[ix].buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
+                    mem[ix].blk.ptr = (void *)(((uintptr_t)mem[ix].buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
                     res = A_S(ioctl(td, TILIOC_MBLK, &mem[ix].blk),==,0);
                     if (res)
                         FREE(mem[ix].buffer);
@@ -1477,7 +1903,7 @@ int neg_free_tests()
 
     P("/* free mapped buffer */");
     void *buffer = malloc(PAGE_SIZE * 2);
-    void *dataPtr = (void *)(((uint32_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
+    void *dataPtr = (void *)(((uintptr_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
     ptr = map_1D(dataPtr, PAGE_SIZE, 0, 0);
     ret |= NOT_I(MemMgr_Free(ptr),!=,0);
 
@@ -1558,7 +1984,7 @@ int neg_map_tests()
 
     P("/* 1 1D buffer with not aligned start address */");
     void *buffer = malloc(3 * PAGE_SIZE);
-    void *dataPtr = (void *)(((uint32_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
+    void *dataPtr = (void *)(((uintptr_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
     block[0].ptr = dataPtr + 3;
     ret |= NEGM(MemMgr_Map(block, 1));
 
@@ -1601,7 +2027,7 @@ int neg_unmap_tests()
     MemMgr_Free(ptr);
 
     void *buffer = malloc(PAGE_SIZE * 2);
-    void *dataPtr = (void *)(((uint32_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
+    void *dataPtr = (void *)(((uintptr_t)buffer + PAGE_SIZE - 1) &~ (PAGE_SIZE - 1));
     ptr = map_1D(dataPtr, PAGE_SIZE, 0, 0);
     MemMgr_UnMap(ptr);
 
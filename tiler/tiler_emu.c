@@ -0,0 +1,492 @@
+/*
+ *  tiler_emu.c
+ *
+ *  User space TILER container emulator for STUB_TILER builds.
+ *
+ *  Copyright (C) 2009-2011 Texas Instruments, Inc.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* pthread_mutex_t is only visible to -ansi builds with this */
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include <tiler.h>
+
+#define __DEBUG__
+#undef  __DEBUG_ENTRY__
+#define __DEBUG_ASSERT__
+
+#ifdef HAVE_CONFIG_H
+    #include "config.h"
+#endif
+#include "utils.h"
+#include "debug_utils.h"
+#include "tilermem_utils.h"
+#include "memmgr.h"
+#include "tiler_emu.h"
+
+/* geometry of a container view */
+struct _EmuView {
+    uint32_t base;          /* system space address of the view */
+    uint32_t stride;        /* view stride in bytes */
+    uint16_t slot_w;        /* slot width in bytes */
+    uint16_t slot_h;        /* slot height in lines */
+};
+
+static const struct _EmuView views[TILFMT_MAX + 1] = {
+    { TILER_MEM_8BIT,  TILER_STRIDE_8BIT,  64, 64 },    /* 64x64 8-bit */
+    { TILER_MEM_16BIT, TILER_STRIDE_16BIT, 128, 32 },   /* 64x32 16-bit */
+    { TILER_MEM_32BIT, TILER_STRIDE_32BIT, 128, 32 },   /* 32x32 32-bit */
+    { TILER_MEM_PAGED, TILER_PAGE, TILER_PAGE, 1 },     /* 1 page */
+};
+
+/* reserved area record */
+struct _EmuArea {
+    enum tiler_fmt fmt;     /* TILFMT_NONE if the record is unused */
+    struct tiler_emu_area area;
+};
+
+/* slot owners: 0 if free, otherwise index + 1 of the area record */
+static uint16_t map[TILER_HEIGHT][TILER_WIDTH];
+
+static struct _EmuArea *areas = NULL;
+static int max_areas = 0;
+static int num_areas = 0;
+static uint32_t used_slots[TILFMT_MAX + 1];
+static uint32_t failed = 0;
+
+#define AREAS_GROW_BY 64
+
+static const struct tiler_emu_allocator *allocator = &tiler_emu_split_fit;
+static pthread_mutex_t emu_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns the rightmost reserved column within a slot area.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param map    Slot map
+ * @param x      Left slot
+ * @param y      Top slot
+ * @param w      Width in slots
+ * @param h      Height in slots
+ *
+ * @return rightmost reserved column, or -1 if the area is free.
+ */
+static int busy_col(const uint16_t *map, int x, int y, int w, int h)
+{
+    int bx = x - 1, ix, iy;
+    for (iy = y; iy < y + h; iy++)
+    {
+        for (ix = x + w - 1; ix > bx; ix--)
+        {
+            if (map[iy * TILER_WIDTH + ix])
+            {
+                bx = ix;
+                break;
+            }
+        }
+    }
+    return bx < x ? -1 : bx;
+}
+
+static int first_fit_2d(const uint16_t *map, uint16_t w, uint16_t h,
+                        uint16_t align, struct tiler_emu_area *area)
+{
+    int x, y;
+    for (y = 0; y + h <= TILER_HEIGHT; y++)
+    {
+        for (x = 0; x + w <= TILER_WIDTH; )
+        {
+            int bx = busy_col(map, x, y, w, h);
+            if (bx < 0)
+            {
+                area->x = x;
+                area->y = y;
+                area->w = w;
+                area->h = h;
+                area->slots = w * h;
+                return 0;
+            }
+            /* skip to the first aligned column past the reserved slot */
+            x = (bx + align) / align * align;
+        }
+    }
+    return -1;
+}
+
+static int first_fit_1d(const uint16_t *map, uint32_t slots,
+                        struct tiler_emu_area *area)
+{
+    uint32_t ix, run = 0;
+    for (ix = 0; ix < TILER_EMU_SLOTS; ix++)
+    {
+        run = map[ix] ? 0 : run + 1;
+        if (run == slots)
+        {
+            ix -= slots - 1;
+            area->x = ix % TILER_WIDTH;
+            area->y = ix / TILER_WIDTH;
+            area->w = area->h = 0;
+            area->slots = slots;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int last_fit_1d(const uint16_t *map, uint32_t slots,
+                       struct tiler_emu_area *area)
+{
+    uint32_t ix, run = 0;
+    for (ix = TILER_EMU_SLOTS; ix--; )
+    {
+        run = map[ix] ? 0 : run + 1;
+        if (run == slots)
+        {
+            area->x = ix % TILER_WIDTH;
+            area->y = ix / TILER_WIDTH;
+            area->w = area->h = 0;
+            area->slots = slots;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const struct tiler_emu_allocator tiler_emu_first_fit = {
+    "first-fit", first_fit_2d, first_fit_1d
+};
+
+const struct tiler_emu_allocator tiler_emu_split_fit = {
+    "split-fit", first_fit_2d, last_fit_1d
+};
+
+/**
+ * Marks the slots of an area with an owner.  Must be called
+ * with emu_mutex held.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param area   Slot area
+ * @param owner  Owner (0 to free the slots)
+ */
+static void mark_area(const struct tiler_emu_area *area, uint16_t owner)
+{
+    uint32_t ix, iy;
+    if (area->h)
+    {
+        for (iy = area->y; iy < area->y + area->h; iy++)
+            for (ix = area->x; ix < area->x + area->w; ix++)
+                map[iy][ix] = owner;
+    }
+    else
+    {
+        uint16_t *slot = &map[area->y][area->x];
+        for (ix = 0; ix < area->slots; ix++)
+            slot[ix] = owner;
+    }
+}
+
+/**
+ * Reserves a container area for a block format.  Must be called
+ * with emu_mutex held.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param fmt    Block format
+ * @param w      Width in slots (number of slots for 1D)
+ * @param h      Height in slots (0 for 1D)
+ * @param align  Column alignment in slots (2D only)
+ * @param area   Pointer to the area to fill out
+ *
+ * @return 0 on success, non-0 error value on failure.
+ */
+static int reserve_area(enum tiler_fmt fmt, uint32_t w, uint16_t h,
+                        uint16_t align, struct tiler_emu_area *area)
+{
+    int id, res;
+
+    if (fmt == TILFMT_PAGE)
+        res = w > TILER_EMU_SLOTS ||
+              allocator->find_1d(&map[0][0], w, area);
+    else
+        res = w > TILER_WIDTH || h > TILER_HEIGHT ||
+              allocator->find_2d(&map[0][0], w, h, align, area);
+    if (res)
+    {
+        failed++;
+        return MEMMGR_ERR_GENERIC;
+    }
+
+    /* find an unused record */
+    for (id = 0; id < max_areas && areas[id].fmt != TILFMT_NONE; id++);
+    if (id == max_areas)
+    {
+        struct _EmuArea *grown = realloc(areas, (max_areas + AREAS_GROW_BY) *
+                                         sizeof(*areas));
+        if (NOT_P(grown,!=,NULL)) return MEMMGR_ERR_GENERIC;
+        areas = grown;
+        for (max_areas += AREAS_GROW_BY; id < max_areas; id++)
+            areas[id].fmt = TILFMT_NONE;
+        id -= AREAS_GROW_BY;
+    }
+
+    areas[id].fmt = fmt;
+    areas[id].area = *area;
+    mark_area(area, id + 1);
+    used_slots[fmt] += area->slots;
+    num_areas++;
+    return MEMMGR_ERR_NONE;
+}
+
+/**
+ * Returns the area record for a system space address.  Must be
+ * called with emu_mutex held.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param ssptr  System space address
+ *
+ * @return pointer to the area record, or NULL if ssptr is not
+ *         within a reserved area of the matching format.
+ */
+static struct _EmuArea *find_area(uint32_t ssptr)
+{
+    enum tiler_fmt fmt;
+    int x, y;
+
+    if (ssptr < TILER_MEM_8BIT || ssptr >= TILER_MEM_END) return NULL;
+
+    fmt = (ssptr < TILER_MEM_16BIT ? TILFMT_8BIT :
+           ssptr < TILER_MEM_32BIT ? TILFMT_16BIT :
+           ssptr < TILER_MEM_PAGED ? TILFMT_32BIT : TILFMT_PAGE);
+    ssptr -= views[fmt].base;
+    if (fmt == TILFMT_PAGE)
+    {
+        x = (ssptr / TILER_PAGE) % TILER_WIDTH;
+        y = (ssptr / TILER_PAGE) / TILER_WIDTH;
+    }
+    else
+    {
+        x = (ssptr % views[fmt].stride) / views[fmt].slot_w;
+        y = (ssptr / views[fmt].stride) / views[fmt].slot_h;
+    }
+
+    if (!map[y][x] || areas[map[y][x] - 1].fmt != fmt) return NULL;
+    return areas + map[y][x] - 1;
+}
+
+int tiler_emu_alloc(struct tiler_block_info *blk)
+{
+    struct tiler_emu_area area;
+    const struct _EmuView *view;
+    int res;
+
+    if (NOT_I(blk->fmt,>=,TILFMT_8BIT) ||
+        NOT_I(blk->fmt,<=,TILFMT_PAGE)) return MEMMGR_ERR_GENERIC;
+    view = views + blk->fmt;
+
+    pthread_mutex_lock(&emu_mutex);
+    if (blk->fmt == TILFMT_PAGE)
+    {
+        res = reserve_area(TILFMT_PAGE,
+                           (blk->offs + blk->dim.len + TILER_PAGE - 1) / TILER_PAGE,
+                           0, 1, &area);
+        if (!res)
+        {
+            blk->ssptr = view->base + blk->offs +
+                         (area.y * TILER_WIDTH + area.x) * TILER_PAGE;
+        }
+    }
+    else
+    {
+        /* 2D blocks are placed at the requested (default page) alignment */
+        uint32_t bpp = blk->fmt == TILFMT_8BIT ? 1 : blk->fmt == TILFMT_16BIT ? 2 : 4;
+        uint32_t width = blk->offs + blk->dim.area.width * bpp;
+        uint32_t align = (blk->align ? blk->align : TILER_PAGE) / view->slot_w;
+
+        res = reserve_area(blk->fmt,
+                           (width + view->slot_w - 1) / view->slot_w,
+                           (blk->dim.area.height + view->slot_h - 1) / view->slot_h,
+                           align ? align : 1, &area);
+        if (!res)
+        {
+            blk->ssptr = view->base + blk->offs +
+                         area.y * view->slot_h * view->stride +
+                         area.x * view->slot_w;
+            blk->stride = ROUND_UP_TO2POW(blk->dim.area.width * bpp, TILER_PAGE);
+        }
+    }
+    pthread_mutex_unlock(&emu_mutex);
+    return res;
+}
+
+int tiler_emu_map(struct tiler_block_info *blk)
+{
+    struct tiler_emu_area area;
+    int res;
+
+    if (NOT_I(blk->fmt,==,TILFMT_PAGE) ||
+        NOT_P(blk->ptr,!=,NULL) ||
+        NOT_I(blk->dim.len,>,0)) return MEMMGR_ERR_GENERIC;
+
+    pthread_mutex_lock(&emu_mutex);
+    res = reserve_area(TILFMT_PAGE,
+                       (((uintptr_t) blk->ptr & (TILER_PAGE - 1)) + blk->dim.len +
+                        TILER_PAGE - 1) / TILER_PAGE, 0, 1, &area);
+    if (!res)
+    {
+        blk->ssptr = TILER_MEM_PAGED + ((uintptr_t) blk->ptr & (TILER_PAGE - 1)) +
+                     (area.y * TILER_WIDTH + area.x) * TILER_PAGE;
+    }
+    pthread_mutex_unlock(&emu_mutex);
+    return res;
+}
+
+int tiler_emu_free(struct tiler_block_info *blk)
+{
+    struct _EmuArea *a;
+    int res = MEMMGR_ERR_GENERIC;
+
+    pthread_mutex_lock(&emu_mutex);
+    a = find_area(blk->ssptr);
+    if (A_P(a,!=,NULL))
+    {
+        mark_area(&a->area, 0);
+        used_slots[a->fmt] -= a->area.slots;
+        a->fmt = TILFMT_NONE;
+        num_areas--;
+        res = MEMMGR_ERR_NONE;
+    }
+
+    /* release the records with the last area */
+    if (!num_areas)
+    {
+        FREE(areas);
+        max_areas = 0;
+    }
+    pthread_mutex_unlock(&emu_mutex);
+    return res;
+}
+
+enum tiler_fmt tiler_emu_get_fmt(uint32_t ssptr)
+{
+    struct _EmuArea *a;
+    enum tiler_fmt fmt;
+
+    if (!ssptr) return TILFMT_INVALID;
+
+    pthread_mutex_lock(&emu_mutex);
+    a = find_area(ssptr);
+    fmt = a ? a->fmt : TILFMT_NONE;
+    pthread_mutex_unlock(&emu_mutex);
+    return fmt;
+}
+
+int tiler_emu_set_allocator(const struct tiler_emu_allocator *alloc)
+{
+    int res = MEMMGR_ERR_GENERIC;
+
+    pthread_mutex_lock(&emu_mutex);
+    if (A_P(alloc,!=,NULL) && !NOT_I(num_areas,==,0))
+    {
+        allocator = alloc;
+        failed = 0;
+        res = MEMMGR_ERR_NONE;
+    }
+    pthread_mutex_unlock(&emu_mutex);
+    return res;
+}
+
+void tiler_emu_get_stats(struct tiler_emu_stats *stats)
+{
+    uint16_t heights[TILER_WIDTH], stack[TILER_WIDTH + 1];
+    uint32_t run = 0, free_slots;
+    int ix, iy, fmt;
+
+    ZERO(*stats);
+    pthread_mutex_lock(&emu_mutex);
+
+    stats->allocator = allocator->name;
+    stats->total_slots = TILER_EMU_SLOTS;
+    stats->num_areas = num_areas;
+    stats->failed = failed;
+    for (fmt = 0; fmt <= TILFMT_MAX; fmt++)
+    {
+        stats->used_by_fmt[fmt] = used_slots[fmt];
+        stats->used_slots += used_slots[fmt];
+    }
+
+    /* longest free raster run */
+    for (ix = 0; ix < TILER_EMU_SLOTS; ix++)
+    {
+        run = (&map[0][0])[ix] ? 0 : run + 1;
+        if (run > stats->largest_free_1d)
+            stats->largest_free_1d = run;
+    }
+
+    /* largest free rectangle: largest rectangle under the histogram
+       of free column heights, for each row */
+    memset(heights, 0, sizeof(heights));
+    for (iy = 0; iy < TILER_HEIGHT; iy++)
+    {
+        int top = 0;
+        for (ix = 0; ix < TILER_WIDTH; ix++)
+            heights[ix] = map[iy][ix] ? 0 : heights[ix] + 1;
+
+        for (ix = 0; ix <= TILER_WIDTH; ix++)
+        {
+            uint16_t h = ix < TILER_WIDTH ? heights[ix] : 0;
+            while (top && heights[stack[top - 1]] >= h)
+            {
+                uint16_t bh = heights[stack[--top]];
+                uint16_t bw = top ? ix - stack[top - 1] - 1 : ix;
+                if ((uint32_t) bw * bh > stats->largest_free_2d)
+                {
+                    stats->largest_free_2d = (uint32_t) bw * bh;
+                    stats->largest_free_2d_w = bw;
+                    stats->largest_free_2d_h = bh;
+                }
+            }
+            stack[top++] = ix;
+        }
+    }
+    pthread_mutex_unlock(&emu_mutex);
+
+    free_slots = stats->total_slots - stats->used_slots;
+    if (free_slots)
+        stats->fragmentation = 100 - 100 * stats->largest_free_2d / free_slots;
+}
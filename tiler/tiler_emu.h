@@ -0,0 +1,184 @@
+/*
+ *  tiler_emu.h
+ *
+ *  User space TILER container emulator for STUB_TILER builds.
+ *
+ *  Copyright (C) 2009-2011 Texas Instruments, Inc.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _TILER_EMU_H_
+#define _TILER_EMU_H_
+
+#include <stdint.h>
+#include <tiler.h>
+
+/*
+ * The emulated container is the TILER_WIDTH x TILER_HEIGHT grid of
+ * 4KB slots that the 8-, 16- and 32-bit and page mode views share.
+ * A slot is 64x64 pixels in 8-bit mode, 64x32 pixels in 16-bit mode,
+ * 32x32 pixels in 32-bit mode and one page in page mode.  2D blocks
+ * occupy rectangular slot areas; 1D blocks occupy runs of slots in
+ * raster order.  Block ssptrs are returned in the real TILER address
+ * map with the TILER_STRIDE_* geometry.
+ */
+#define TILER_EMU_SLOTS (TILER_WIDTH * TILER_HEIGHT)
+
+/* slot area of a block */
+struct tiler_emu_area {
+    uint16_t x, y;          /* top-left slot (first slot for 1D areas) */
+    uint16_t w, h;          /* size in slots (h is 0 for 1D areas) */
+    uint32_t slots;         /* number of slots in the area */
+};
+
+/**
+ * Area allocator.  The allocators only search the slot map, the
+ * container does the bookkeeping, so allocation policies can be
+ * swapped and compared on the same workload.
+ *
+ * The slot map has TILER_HEIGHT rows of TILER_WIDTH entries, and
+ * an entry is 0 if the slot is free.
+ */
+struct tiler_emu_allocator {
+    const char *name;
+
+    /**
+     * Finds a free area of w x h slots whose left edge is a
+     * multiple of align slots.
+     *
+     * @return 0 on success (area is filled out), non-0 if no
+     *         such area is available.
+     */
+    int (*find_2d)(const uint16_t *map, uint16_t w, uint16_t h,
+                   uint16_t align, struct tiler_emu_area *area);
+
+    /**
+     * Finds a run of slots free slots in raster order.
+     *
+     * @return 0 on success (area is filled out), non-0 if no
+     *         such run is available.
+     */
+    int (*find_1d)(const uint16_t *map, uint32_t slots,
+                   struct tiler_emu_area *area);
+};
+
+/* places 2D and 1D areas at the first fitting position */
+extern const struct tiler_emu_allocator tiler_emu_first_fit;
+
+/* places 2D areas from the top-left and 1D areas from the end of the
+   container to keep them apart (default, mirrors the kernel driver) */
+extern const struct tiler_emu_allocator tiler_emu_split_fit;
+
+/* container occupancy and fragmentation */
+struct tiler_emu_stats {
+    const char *allocator;      /* name of the area allocator */
+    uint32_t total_slots;       /* slots in the container */
+    uint32_t used_slots;        /* slots reserved by blocks */
+    uint32_t used_by_fmt[TILFMT_MAX + 1]; /* used slots per format */
+    uint32_t num_areas;         /* number of reserved areas */
+    uint32_t largest_free_1d;   /* slots in the longest free 1D run */
+    uint32_t largest_free_2d;   /* slots in the largest free rectangle */
+    uint16_t largest_free_2d_w; /* ... and its dimensions */
+    uint16_t largest_free_2d_h;
+    uint32_t fragmentation;     /* % of free slots outside the largest
+                                   free rectangle */
+    uint32_t failed;            /* reservations that did not fit */
+};
+
+/**
+ * Reserves a container area for a block and fills out its
+ * ssptr (and stride for 2D blocks).  Emulates TILIOC_GBLK.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param blk    Pointer to the block info
+ *
+ * @return 0 on success, non-0 error value on failure.
+ */
+int tiler_emu_alloc(struct tiler_block_info *blk);
+
+/**
+ * Reserves a 1D container area for mapping the page aligned
+ * user buffer at blk->ptr and fills out its ssptr.  Emulates
+ * TILIOC_MBLK.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param blk    Pointer to the block info
+ *
+ * @return 0 on success, non-0 error value on failure.
+ */
+int tiler_emu_map(struct tiler_block_info *blk);
+
+/**
+ * Releases the container area of an allocated or mapped block.
+ * Emulates TILIOC_FBLK and TILIOC_UMBLK.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param blk    Pointer to the block info
+ *
+ * @return 0 on success, non-0 error value on failure.
+ */
+int tiler_emu_free(struct tiler_block_info *blk);
+
+/**
+ * Returns the format of a reserved container address.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param ssptr  System space address
+ *
+ * @return the block format, TILFMT_NONE if ssptr is not within
+ *         a reserved area, or TILFMT_INVALID if ssptr is 0.
+ */
+enum tiler_fmt tiler_emu_get_fmt(uint32_t ssptr);
+
+/**
+ * Selects the area allocator.  This is only possible while the
+ * container is empty.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param allocator  Area allocator
+ *
+ * @return 0 on success, non-0 error value on failure.
+ */
+int tiler_emu_set_allocator(const struct tiler_emu_allocator *allocator);
+
+/**
+ * Returns the container occupancy and fragmentation.
+ *
+ * @author a0194118 (9/7/2009)
+ *
+ * @param stats  Pointer to the statistics to fill out
+ */
+void tiler_emu_get_stats(struct tiler_emu_stats *stats);
+
+#endif
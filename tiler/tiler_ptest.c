@@ -636,7 +636,7 @@ int param_test(int argc, char **argv)
             if (buf.type == ptr_alloced)
             {
                 dump_slot(&buf, "==(alloc)=>");
-                buf.ptr = (int) alloc_buf(n, (MemAllocBlock *) buf.blocks, val);
+                buf.ptr = (int) (uintptr_t) alloc_buf(n, (MemAllocBlock *) buf.blocks, val);
                 dump_slot(&buf, "<=(alloc)==");
             }
             else
@@ -668,7 +668,7 @@ int param_test(int argc, char **argv)
                 if (NOT_I(buf.type,==,ptr_alloced)) break;
                 dump_slot(&buf, "==(free)=>");
                 res = free_buf(buf.num_blocks, (MemAllocBlock *) buf.blocks,
-                         buf.val, (void *) buf.ptr);
+                         buf.val, (void *) (uintptr_t) buf.ptr);
                 P("<=(free)==: %d", res);
                 break;
             case 'F':
@@ -697,7 +697,7 @@ int param_test(int argc, char **argv)
         {
             dump_slot(slots + ix, "==(free)=>");
             int res_free = free_buf(slots[ix].num_blocks, (MemAllocBlock *) slots[ix].blocks,
-                                    slots[ix].val, (void *) slots[ix].ptr);
+                                    slots[ix].val, (void *) (uintptr_t) slots[ix].ptr);
             P("<=(free)==: %d", res_free);
             ERR_ADD(res, res_free);
         }